@@ -66,6 +66,7 @@
 #include "windef.h"
 #include "winbase.h"
 #include "winerror.h"
+#include "winternl.h"
 #include "fdi.h"
 #include "cabinet.h"
 
@@ -1935,6 +1936,31 @@ static int LZXfdi_decomp(int inlen, int outlen, fdi_decomp_state *decomp_state)
  * is also where we jump to additional cabinets in the case of split
  * cab's, and provide (some of) the NEXT_CABINET notification semantics.
  */
+/***********************************************************************
+ *		fdi_init_decompressor (internal)
+ *
+ * Selects and initializes the decompressor for a folder compression type.
+ */
+static int fdi_init_decompressor(cab_UWORD comptype, fdi_decomp_state *decomp_state)
+{
+  switch (comptype & cffoldCOMPTYPE_MASK) {
+  case cffoldCOMPTYPE_NONE:
+    CAB(decompress) = NONEfdi_decomp;
+    return DECR_OK;
+  case cffoldCOMPTYPE_MSZIP:
+    CAB(decompress) = ZIPfdi_decomp;
+    return DECR_OK;
+  case cffoldCOMPTYPE_QUANTUM:
+    CAB(decompress) = QTMfdi_decomp;
+    return QTMfdi_init((comptype >> 8) & 0x1f, (comptype >> 4) & 0xF, decomp_state);
+  case cffoldCOMPTYPE_LZX:
+    CAB(decompress) = LZXfdi_decomp;
+    return LZXfdi_init((comptype >> 8) & 0x1f, decomp_state);
+  default:
+    return DECR_DATAFORMAT;
+  }
+}
+
 static int fdi_decomp(const struct fdi_file *fi, int savemode, fdi_decomp_state *decomp_state,
   char *pszCabPath, PFNFDINOTIFY pfnfdin, void *pvUser)
 {
@@ -2251,6 +2277,248 @@ static void free_decompression_mem(FDI_Int *fdi, fdi_decomp_state *decomp_state)
   }
 }
 
+/*
+ * Folders are compressed independently from each other, so while the
+ * files of a folder are handed out, the following folders of the cabinet
+ * are decompressed to memory by the thread pool.  Only the worker threads
+ * run the decompressors; the compressed data is read and the output is
+ * written on the calling thread, through the user callbacks, in the usual
+ * order.
+ */
+
+#define FDI_MAX_LOOKAHEAD    8                 /* folders decompressed ahead     */
+#define FDI_MAX_PREFETCH     (128 << 20)       /* uncompressed bytes held in jobs */
+
+struct fdi_job {
+  struct fdi_folder *folder;
+  HANDLE done;                         /* signaled once decompressed     */
+  int err;                             /* DECR_* result of the worker    */
+  cab_UBYTE *in;                       /* data blocks with their headers */
+  cab_ULONG inlen;
+  cab_UBYTE *out;                      /* uncompressed folder            */
+  cab_ULONG outlen;
+  FDI_Int fdi;                         /* allocator for the worker       */
+  ERF erf;
+  fdi_decomp_state *decomp_state;
+};
+
+struct fdi_prefetch {
+  unsigned int count;                  /* number of folders              */
+  unsigned int lookahead;              /* folders decompressed ahead     */
+  unsigned int first;                  /* first folder that may have a job */
+  cab_ULONG pending;                   /* bytes held by the jobs         */
+  struct fdi_folder **folders;
+  struct fdi_job **jobs;
+  BOOL *queued;                        /* already tried to prefetch      */
+};
+
+static void * CDECL fdi_heap_alloc(ULONG cb)
+{
+  return HeapAlloc(GetProcessHeap(), 0, cb);
+}
+
+static void CDECL fdi_heap_free(void *pv)
+{
+  HeapFree(GetProcessHeap(), 0, pv);
+}
+
+static DWORD CALLBACK fdi_job_proc(void *arg)
+{
+  struct fdi_job *job = arg;
+  fdi_decomp_state *decomp_state = job->decomp_state;
+  cab_UBYTE *data = job->in, *end = job->in + job->inlen;
+  cab_UWORD len, outlen;
+  cab_ULONG cksum, pos = 0;
+  int err = DECR_OK;
+
+  while (!err && data < end) {
+    len = EndGetI16(data+cfdata_CompressedSize);
+    outlen = EndGetI16(data+cfdata_UncompressedSize);
+    cksum = EndGetI32(data+cfdata_CheckSum);
+
+    if (cksum && cksum != checksum(data+4, 4, checksum(data+cfdata_SIZEOF, len, 0)))
+      err = DECR_CHECKSUM;
+    else if (!outlen || outlen > job->outlen - pos)
+      err = DECR_ILLEGALDATA;
+    else {
+      memcpy(CAB(inbuf), data+cfdata_SIZEOF, len);
+      CAB(inbuf)[len+1] = CAB(inbuf)[len+2] = 0;
+      if (!(err = CAB(decompress)(len, outlen, decomp_state))) {
+        memcpy(job->out + pos, CAB(outbuf), outlen);
+        pos += outlen;
+      }
+    }
+    data += cfdata_SIZEOF + len;
+  }
+
+  job->err = err;
+  SetEvent(job->done);
+  return 0;
+}
+
+static void fdi_free_job(struct fdi_prefetch *pf, unsigned int index)
+{
+  struct fdi_job *job = pf->jobs[index];
+
+  if (!job) return;
+  pf->jobs[index] = NULL;
+
+  if (job->done) {
+    WaitForSingleObject(job->done, INFINITE);
+    CloseHandle(job->done);
+  }
+  if (job->decomp_state) {
+    free_decompression_temps(&job->fdi, job->folder, job->decomp_state);
+    HeapFree(GetProcessHeap(), 0, job->decomp_state);
+  }
+  pf->pending -= job->outlen;
+  HeapFree(GetProcessHeap(), 0, job->in);
+  HeapFree(GetProcessHeap(), 0, job->out);
+  HeapFree(GetProcessHeap(), 0, job);
+}
+
+/* reads the data blocks of a folder and queues their decompression */
+static void fdi_queue_job(FDI_Int *fdi, fdi_decomp_state *decomp_state,
+  struct fdi_prefetch *pf, unsigned int index)
+{
+  struct fdi_folder *fol = pf->folders[index];
+  struct fdi_job *job;
+  cab_UBYTE *data;
+  cab_ULONG size = 0;
+  LONG pos;
+  UINT len;
+  int i;
+
+  pf->queued[index] = TRUE;
+  if (!(job = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*job)))) return;
+  job->folder = fol;
+  pf->jobs[index] = job;
+
+  /* the sequential decompressor expects the file pointer to be left alone */
+  if ((pos = fdi->seek(CAB(cabhf), 0, SEEK_CUR)) == -1) goto failed;
+  if (fdi->seek(CAB(cabhf), fol->offset, SEEK_SET) == -1) goto failed;
+
+  for (i = 0; i < fol->num_blocks; i++) {
+    if (size - job->inlen < cfdata_SIZEOF + CAB_INPUTMAX) {
+      size = max(2 * size, 16 * (cfdata_SIZEOF + CAB_INPUTMAX));
+      data = job->in ? HeapReAlloc(GetProcessHeap(), 0, job->in, size) : HeapAlloc(GetProcessHeap(), 0, size);
+      if (!data) break;
+      job->in = data;
+    }
+    data = job->in + job->inlen;
+
+    if (fdi->read(CAB(cabhf), data, cfdata_SIZEOF) != cfdata_SIZEOF) break;
+    if (fdi->seek(CAB(cabhf), CAB(mii).block_resv, SEEK_CUR) == -1) break;
+    len = EndGetI16(data+cfdata_CompressedSize);
+    if (len > CAB_INPUTMAX) break;
+    if (fdi->read(CAB(cabhf), data+cfdata_SIZEOF, len) != len) break;
+
+    job->inlen += cfdata_SIZEOF + len;
+    job->outlen += EndGetI16(data+cfdata_UncompressedSize);
+  }
+
+  fdi->seek(CAB(cabhf), pos, SEEK_SET);
+  pf->pending += job->outlen;
+
+  /* let the sequential decompressor deal with anything unusual */
+  if (i < fol->num_blocks || !job->outlen || pf->pending > FDI_MAX_PREFETCH) goto failed;
+
+  job->fdi.magic = FDI_INT_MAGIC;
+  job->fdi.alloc = fdi_heap_alloc;
+  job->fdi.free = fdi_heap_free;
+  job->fdi.perf = &job->erf;
+
+  if (!(job->out = HeapAlloc(GetProcessHeap(), 0, job->outlen))) goto failed;
+  if (!(job->decomp_state = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(fdi_decomp_state))))
+    goto failed;
+  job->decomp_state->fdi = &job->fdi;
+  if (fdi_init_decompressor(fol->comp_type, job->decomp_state)) goto failed;
+
+  if (!(job->done = CreateEventW(NULL, TRUE, FALSE, NULL))) goto failed;
+  if (!QueueUserWorkItem(fdi_job_proc, job, WT_EXECUTELONGFUNCTION)) {
+    CloseHandle(job->done);
+    job->done = NULL;
+    goto failed;
+  }
+
+  TRACE("decompressing folder %u (%u bytes) in the background\n", index, job->outlen);
+  return;
+
+failed:
+  fdi_free_job(pf, index);
+}
+
+static void fdi_free_prefetch(struct fdi_prefetch *pf)
+{
+  unsigned int i;
+
+  for (i = 0; i < pf->count; i++) fdi_free_job(pf, i);
+  HeapFree(GetProcessHeap(), 0, pf->folders);
+  HeapFree(GetProcessHeap(), 0, pf->jobs);
+  HeapFree(GetProcessHeap(), 0, pf->queued);
+  memset(pf, 0, sizeof(*pf));
+}
+
+static void fdi_init_prefetch(FDI_Int *fdi, fdi_decomp_state *decomp_state,
+  struct fdi_prefetch *pf, unsigned int folders)
+{
+  struct fdi_folder *fol;
+  struct fdi_file *file;
+  SYSTEM_INFO si;
+  unsigned int i;
+
+  memset(pf, 0, sizeof(*pf));
+
+  GetSystemInfo(&si);
+  if (si.dwNumberOfProcessors < 2 || folders < 2) return;
+
+  /* thread pool threads can't start while we hold the loader lock, and
+   * we would wait for them forever */
+  if (RtlIsCriticalSectionLockedByThread(NtCurrentTeb()->Peb->LoaderLock)) return;
+
+  /* split folders need the other cabinets, leave them to the sequential path */
+  for (file = CAB(firstfile); file; file = file->next)
+    if (file->index >= cffileCONTINUED_FROM_PREV) return;
+
+  pf->folders = HeapAlloc(GetProcessHeap(), 0, folders * sizeof(*pf->folders));
+  pf->jobs = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, folders * sizeof(*pf->jobs));
+  pf->queued = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, folders * sizeof(*pf->queued));
+  if (!pf->folders || !pf->jobs || !pf->queued) {
+    fdi_free_prefetch(pf);
+    return;
+  }
+
+  for (i = 0, fol = CAB(firstfol); i < folders && fol; i++, fol = fol->next)
+    pf->folders[i] = fol;
+  pf->count = i;
+  pf->lookahead = min(si.dwNumberOfProcessors, FDI_MAX_LOOKAHEAD);
+}
+
+/* queues the folders following the one of the file, and returns the job
+ * holding the file data if it was decompressed in the background */
+static struct fdi_job *fdi_prefetch(FDI_Int *fdi, fdi_decomp_state *decomp_state,
+  struct fdi_prefetch *pf, const struct fdi_file *file)
+{
+  unsigned int i, index = file->index;
+  struct fdi_job *job;
+
+  if (index >= pf->count) return NULL;
+
+  for (; pf->first < index; pf->first++) fdi_free_job(pf, pf->first);
+  for (i = index + 1; i < pf->count && i <= index + pf->lookahead; i++)
+    if (!pf->queued[i]) fdi_queue_job(fdi, decomp_state, pf, i);
+
+  if (!(job = pf->jobs[index])) return NULL;
+
+  WaitForSingleObject(job->done, INFINITE);
+  if (job->err || file->offset > job->outlen || file->length > job->outlen - file->offset) {
+    WARN("background decompression of folder %u failed: %d\n", index, job->err);
+    fdi_free_job(pf, index);
+    return NULL;
+  }
+  return job;
+}
+
 /***********************************************************************
  *		FDICopy (CABINET.22)
  *
@@ -2435,6 +2703,8 @@ BOOL __cdecl FDICopy(
   struct fdi_folder *fol = NULL, *linkfol = NULL; 
   struct fdi_file   *file = NULL, *linkfile = NULL;
   fdi_decomp_state *decomp_state;
+  struct fdi_prefetch prefetch;
+  struct fdi_job *job;
   FDI_Int *fdi = get_fdi_ptr( hfdi );
 
   TRACE("(hfdi == ^%p, pszCabinet == %s, pszCabPath == %s, flags == %x, "
@@ -2449,6 +2719,7 @@ BOOL __cdecl FDICopy(
       return FALSE;
   }
   ZeroMemory(decomp_state, sizeof(fdi_decomp_state));
+  memset(&prefetch, 0, sizeof(prefetch));
 
   pathlen = pszCabPath ? strlen(pszCabPath) : 0;
   filenamelen = pszCabinet ? strlen(pszCabinet) : 0;
@@ -2567,6 +2838,8 @@ BOOL __cdecl FDICopy(
     linkfile = file;
   }
 
+  fdi_init_prefetch(fdi, decomp_state, &prefetch, fdici.cFolders);
+
   for (file = CAB(firstfile); (file); file = file->next) {
 
     /*
@@ -2671,6 +2944,17 @@ BOOL __cdecl FDICopy(
 
       TRACE("Extracting file %s as requested by callee.\n", debugstr_a(file->filename));
 
+      if (prefetch.count && (job = fdi_prefetch(fdi, decomp_state, &prefetch, file))) {
+        cab_ULONG done, len;
+
+        for (done = 0; done < file->length; done += len) {
+          len = min(file->length - done, CAB_BLOCKMAX);
+          fdi->write(filehf, job->out + file->offset + done, len);
+        }
+        fol = CAB(current);
+        goto close_file;
+      }
+
       /* set up decomp_state */
       CAB(fdi) = fdi;
       CAB(filehf) = filehf;
@@ -2702,24 +2986,7 @@ BOOL __cdecl FDICopy(
         CAB(outlen) = 0;
 
         /* initialize the new decompressor */
-        switch (ct1) {
-        case cffoldCOMPTYPE_NONE:
-          CAB(decompress) = NONEfdi_decomp;
-          break;
-        case cffoldCOMPTYPE_MSZIP:
-          CAB(decompress) = ZIPfdi_decomp;
-          break;
-        case cffoldCOMPTYPE_QUANTUM:
-          CAB(decompress) = QTMfdi_decomp;
-          err = QTMfdi_init((comptype >> 8) & 0x1f, (comptype >> 4) & 0xF, decomp_state);
-          break;
-        case cffoldCOMPTYPE_LZX:
-          CAB(decompress) = LZXfdi_decomp;
-          err = LZXfdi_init((comptype >> 8) & 0x1f, decomp_state);
-          break;
-        default:
-          err = DECR_DATAFORMAT;
-        }
+        err = fdi_init_decompressor(comptype, decomp_state);
       }
 
       CAB(current) = fol;
@@ -2757,6 +3024,7 @@ BOOL __cdecl FDICopy(
       err = fdi_decomp(file, 1, decomp_state, pszCabPath, pfnfdin, pvUser);
       if (err) CAB(current) = NULL; else CAB(offset) += file->length;
 
+      close_file:
       /* fdintCLOSE_FILE_INFO notification */
       ZeroMemory(&fdin, sizeof(FDINOTIFICATION));
       fdin.pv = pvUser;
@@ -2786,6 +3054,7 @@ BOOL __cdecl FDICopy(
     }
   }
 
+  fdi_free_prefetch(&prefetch);
   if (fol) free_decompression_temps(fdi, fol, decomp_state);
   free_decompression_mem(fdi, decomp_state);
  
@@ -2793,6 +3062,7 @@ BOOL __cdecl FDICopy(
 
   bail_and_fail: /* here we free ram before error returns */
 
+  fdi_free_prefetch(&prefetch);
   if (fol) free_decompression_temps(fdi, fol, decomp_state);
 
   if (filehf) fdi->close(filehf);
@@ -949,6 +949,156 @@ static void test_FDICopy(void)
     FDIDestroy(hfdi);
 }
 
+#define FOLDER_FILES 12
+
+struct folder_file
+{
+    char *data;
+    ULONG size, pos;
+};
+
+static int folder_next;
+
+static ULONG folder_file_size(int index)
+{
+    return 150000 + index * 7919;
+}
+
+static void fill_folder_file(char *data, ULONG size, int index)
+{
+    static const char words[][8] = { "cabinet", "folder", "block", "mszip", "data", "wine" };
+    ULONG seed = index + 1, i = 0;
+
+    while (i < size)
+    {
+        const char *word;
+
+        seed = seed * 1103515245 + 12345;
+        word = words[(seed >> 16) % ARRAY_SIZE(words)];
+        while (*word && i < size) data[i++] = *word++;
+        if (i < size) data[i++] = (seed >> 24) & 0x7f;
+    }
+}
+
+static UINT CDECL fdi_folder_write(INT_PTR hf, void *pv, UINT cb)
+{
+    struct folder_file *file = (struct folder_file *)hf;
+
+    ok(file->pos + cb <= file->size, "write past end, pos %u, cb %u, size %u\n", file->pos, cb, file->size);
+    if (file->pos + cb > file->size) return 0;
+    memcpy(file->data + file->pos, pv, cb);
+    file->pos += cb;
+    return cb;
+}
+
+static INT_PTR CDECL fdi_folder_notify(FDINOTIFICATIONTYPE fdint, FDINOTIFICATION *info)
+{
+    struct folder_file *file;
+    char expected[MAX_PATH];
+    char *data;
+    BOOL match;
+
+    switch (fdint)
+    {
+    case fdintCOPY_FILE:
+        sprintf(expected, "fold%d.dat", folder_next);
+        ok(!strcmp(info->psz1, expected), "expected %s, got %s\n", expected, info->psz1);
+        ok(info->cb == folder_file_size(folder_next), "expected %u, got %u\n",
+           folder_file_size(folder_next), info->cb);
+
+        file = HeapAlloc(GetProcessHeap(), 0, sizeof(*file));
+        file->data = HeapAlloc(GetProcessHeap(), 0, info->cb);
+        file->size = info->cb;
+        file->pos = 0;
+        return (INT_PTR)file;
+
+    case fdintCLOSE_FILE_INFO:
+        sprintf(expected, "fold%d.dat", folder_next);
+        ok(!strcmp(info->psz1, expected), "expected %s, got %s\n", expected, info->psz1);
+
+        file = (struct folder_file *)info->hf;
+        ok(file->pos == file->size, "%s: got %u of %u bytes\n", info->psz1, file->pos, file->size);
+
+        data = HeapAlloc(GetProcessHeap(), 0, file->size);
+        fill_folder_file(data, file->size, folder_next);
+        match = !memcmp(data, file->data, file->size);
+        ok(match, "%s: data mismatch\n", info->psz1);
+        HeapFree(GetProcessHeap(), 0, data);
+
+        HeapFree(GetProcessHeap(), 0, file->data);
+        HeapFree(GetProcessHeap(), 0, file);
+        folder_next++;
+        return TRUE;
+
+    default:
+        return 0;
+    }
+}
+
+static void test_FDICopy_folders(void)
+{
+    CCAB cabParams;
+    HFDI hfdi;
+    HFCI hfci;
+    ERF erf;
+    BOOL ret;
+    char name[] = "extract.cab";
+    char file[MAX_PATH], path[MAX_PATH + 1];
+    DWORD written;
+    HANDLE handle;
+    char *data;
+    int i;
+
+    /* one folder per file, so that each folder can be decompressed on its own */
+    set_cab_parameters(&cabParams);
+
+    hfci = FCICreate(&erf, file_placed, mem_alloc, mem_free, fci_open,
+                     fci_read, fci_write, fci_close, fci_seek,
+                     fci_delete, get_temp_file, &cabParams, NULL);
+    ok(hfci != NULL, "Failed to create an FCI context\n");
+
+    for (i = 0; i < FOLDER_FILES; i++)
+    {
+        sprintf(file, "fold%d.dat", i);
+        data = HeapAlloc(GetProcessHeap(), 0, folder_file_size(i));
+        fill_folder_file(data, folder_file_size(i), i);
+        handle = CreateFileA(file, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+        ok(handle != INVALID_HANDLE_VALUE, "Failure to open file %s\n", file);
+        WriteFile(handle, data, folder_file_size(i), &written, NULL);
+        CloseHandle(handle);
+        HeapFree(GetProcessHeap(), 0, data);
+
+        add_file(hfci, file);
+        ret = FCIFlushFolder(hfci, get_next_cabinet, progress);
+        ok(ret, "Failed to flush the folder\n");
+    }
+
+    ret = FCIFlushCabinet(hfci, FALSE, get_next_cabinet, progress);
+    ok(ret, "Failed to flush the cabinet\n");
+    FCIDestroy(hfci);
+
+    for (i = 0; i < FOLDER_FILES; i++)
+    {
+        sprintf(file, "fold%d.dat", i);
+        DeleteFileA(file);
+    }
+
+    lstrcpyA(path, CURR_DIR);
+    lstrcatA(path, "\\");
+
+    hfdi = FDICreate(fdi_alloc, fdi_free, fdi_open, fdi_read,
+                     fdi_folder_write, fdi_close, fdi_seek, cpuUNKNOWN, &erf);
+    ok(hfdi != NULL, "FDICreate error %d\n", erf.erfOper);
+
+    folder_next = 0;
+    ret = FDICopy(hfdi, name, path, 0, fdi_folder_notify, NULL, 0);
+    ok(ret, "FDICopy error %d\n", erf.erfOper);
+    ok(folder_next == FOLDER_FILES, "expected %d files, got %d\n", FOLDER_FILES, folder_next);
+
+    FDIDestroy(hfdi);
+    DeleteFileA(name);
+}
+
 
 START_TEST(fdi)
 {
@@ -956,4 +1106,5 @@ START_TEST(fdi)
     test_FDIDestroy();
     test_FDIIsCabinet();
     test_FDICopy();
+    test_FDICopy_folders();
 }
@@ -526,6 +526,39 @@ struct d3d11_immediate_context
     struct wined3d_private_store private_store;
 };
 
+/* ID3D11DeviceContext - deferred context */
+struct d3d11_deferred_mapping
+{
+    struct list entry;
+    struct wined3d_resource *resource;
+    unsigned int subresource_idx;
+    void *data;
+};
+
+struct d3d11_deferred_context
+{
+    ID3D11DeviceContext1 ID3D11DeviceContext1_iface;
+    LONG refcount;
+
+    struct wined3d_private_store private_store;
+    struct wined3d_deferred_context *wined3d_context;
+    struct list mappings;
+    UINT flags;
+    ID3D11Device2 *device;
+};
+
+/* ID3D11CommandList */
+struct d3d11_command_list
+{
+    ID3D11CommandList ID3D11CommandList_iface;
+    LONG refcount;
+
+    struct wined3d_private_store private_store;
+    struct wined3d_command_list *wined3d_list;
+    UINT context_flags;
+    ID3D11Device2 *device;
+};
+
 /* ID3D11Device, ID3D10Device1 */
 struct d3d_device
 {
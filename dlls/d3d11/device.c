@@ -32,6 +32,137 @@ static const struct wined3d_parent_ops d3d_null_wined3d_parent_ops =
     d3d_null_wined3d_object_destroyed,
 };
 
+/* ID3D11CommandList methods */
+
+static inline struct d3d11_command_list *impl_from_ID3D11CommandList(ID3D11CommandList *iface)
+{
+    return CONTAINING_RECORD(iface, struct d3d11_command_list, ID3D11CommandList_iface);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_QueryInterface(ID3D11CommandList *iface,
+        REFIID riid, void **out)
+{
+    TRACE("iface %p, riid %s, out %p.\n", iface, debugstr_guid(riid), out);
+
+    if (IsEqualGUID(riid, &IID_ID3D11CommandList)
+            || IsEqualGUID(riid, &IID_ID3D11DeviceChild)
+            || IsEqualGUID(riid, &IID_IUnknown))
+    {
+        ID3D11CommandList_AddRef(iface);
+        *out = iface;
+        return S_OK;
+    }
+
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(riid));
+    *out = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_command_list_AddRef(ID3D11CommandList *iface)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+    ULONG refcount = InterlockedIncrement(&list->refcount);
+
+    TRACE("%p increasing refcount to %u.\n", list, refcount);
+
+    return refcount;
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_command_list_Release(ID3D11CommandList *iface)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+    ULONG refcount = InterlockedDecrement(&list->refcount);
+
+    TRACE("%p decreasing refcount to %u.\n", list, refcount);
+
+    if (!refcount)
+    {
+        ID3D11Device2 *device = list->device;
+
+        wined3d_mutex_lock();
+        wined3d_command_list_decref(list->wined3d_list);
+        wined3d_mutex_unlock();
+        wined3d_private_store_cleanup(&list->private_store);
+        heap_free(list);
+
+        ID3D11Device2_Release(device);
+    }
+
+    return refcount;
+}
+
+static void STDMETHODCALLTYPE d3d11_command_list_GetDevice(ID3D11CommandList *iface, ID3D11Device **device)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+
+    TRACE("iface %p, device %p.\n", iface, device);
+
+    *device = (ID3D11Device *)list->device;
+    ID3D11Device_AddRef(*device);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_GetPrivateData(ID3D11CommandList *iface, REFGUID guid,
+        UINT *data_size, void *data)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+
+    TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_get_private_data(&list->private_store, guid, data_size, data);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_SetPrivateData(ID3D11CommandList *iface, REFGUID guid,
+        UINT data_size, const void *data)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+
+    TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
+
+    return d3d_set_private_data(&list->private_store, guid, data_size, data);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_command_list_SetPrivateDataInterface(ID3D11CommandList *iface,
+        REFGUID guid, const IUnknown *data)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+
+    TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
+
+    return d3d_set_private_data_interface(&list->private_store, guid, data);
+}
+
+static UINT STDMETHODCALLTYPE d3d11_command_list_GetContextFlags(ID3D11CommandList *iface)
+{
+    struct d3d11_command_list *list = impl_from_ID3D11CommandList(iface);
+
+    TRACE("iface %p.\n", iface);
+
+    return list->context_flags;
+}
+
+static const struct ID3D11CommandListVtbl d3d11_command_list_vtbl =
+{
+    /* IUnknown methods */
+    d3d11_command_list_QueryInterface,
+    d3d11_command_list_AddRef,
+    d3d11_command_list_Release,
+    /* ID3D11DeviceChild methods */
+    d3d11_command_list_GetDevice,
+    d3d11_command_list_GetPrivateData,
+    d3d11_command_list_SetPrivateData,
+    d3d11_command_list_SetPrivateDataInterface,
+    /* ID3D11CommandList methods */
+    d3d11_command_list_GetContextFlags,
+};
+
+static struct d3d11_command_list *unsafe_impl_from_ID3D11CommandList(ID3D11CommandList *iface)
+{
+    if (!iface)
+        return NULL;
+    assert(iface->lpVtbl == &d3d11_command_list_vtbl);
+    return impl_from_ID3D11CommandList(iface);
+}
+
 /* ID3D11DeviceContext - immediate context methods */
 
 static inline struct d3d11_immediate_context *impl_from_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
@@ -1204,7 +1335,19 @@ static void STDMETHODCALLTYPE d3d11_immediate_context_ResolveSubresource(ID3D11D
 static void STDMETHODCALLTYPE d3d11_immediate_context_ExecuteCommandList(ID3D11DeviceContext1 *iface,
         ID3D11CommandList *command_list, BOOL restore_state)
 {
-    FIXME("iface %p, command_list %p, restore_state %#x stub!\n", iface, command_list, restore_state);
+    struct d3d_device *device = device_from_immediate_ID3D11DeviceContext1(iface);
+    struct d3d11_command_list *list = unsafe_impl_from_ID3D11CommandList(command_list);
+
+    TRACE("iface %p, command_list %p, restore_state %#x.\n", iface, command_list, restore_state);
+
+    wined3d_mutex_lock();
+    wined3d_device_execute_command_list(device->wined3d_device, list->wined3d_list);
+    wined3d_mutex_unlock();
+
+    /* Executing a wined3d command list always restores the state it found;
+     * without restore_state the context is reset to its default state. */
+    if (!restore_state)
+        ID3D11DeviceContext1_ClearState(iface);
 }
 
 static void STDMETHODCALLTYPE d3d11_immediate_context_HSSetShaderResources(ID3D11DeviceContext1 *iface,
@@ -2793,162 +2936,2139 @@ static void d3d11_immediate_context_destroy(struct d3d11_immediate_context *cont
     wined3d_private_store_cleanup(&context->private_store);
 }
 
-/* ID3D11Device methods */
+/* ID3D11DeviceContext - deferred context methods
+ *
+ * Deferred contexts record into a wined3d command list. Recording only
+ * touches state owned by the context, so it doesn't take the wined3d mutex;
+ * that's only needed when objects shared with the immediate context may be
+ * destroyed. */
 
-static HRESULT STDMETHODCALLTYPE d3d11_device_QueryInterface(ID3D11Device2 *iface, REFIID riid, void **out)
+static inline struct d3d11_deferred_context *impl_from_deferred_ID3D11DeviceContext1(ID3D11DeviceContext1 *iface)
 {
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    return IUnknown_QueryInterface(device->outer_unk, riid, out);
+    return CONTAINING_RECORD(iface, struct d3d11_deferred_context, ID3D11DeviceContext1_iface);
 }
 
-static ULONG STDMETHODCALLTYPE d3d11_device_AddRef(ID3D11Device2 *iface)
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_QueryInterface(ID3D11DeviceContext1 *iface,
+        REFIID riid, void **out)
 {
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    return IUnknown_AddRef(device->outer_unk);
-}
+    TRACE("iface %p, riid %s, out %p.\n", iface, debugstr_guid(riid), out);
 
-static ULONG STDMETHODCALLTYPE d3d11_device_Release(ID3D11Device2 *iface)
-{
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    return IUnknown_Release(device->outer_unk);
+    if (IsEqualGUID(riid, &IID_ID3D11DeviceContext1)
+            || IsEqualGUID(riid, &IID_ID3D11DeviceContext)
+            || IsEqualGUID(riid, &IID_ID3D11DeviceChild)
+            || IsEqualGUID(riid, &IID_IUnknown))
+    {
+        ID3D11DeviceContext1_AddRef(iface);
+        *out = iface;
+        return S_OK;
+    }
+
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(riid));
+    *out = NULL;
+    return E_NOINTERFACE;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_device_CreateBuffer(ID3D11Device2 *iface, const D3D11_BUFFER_DESC *desc,
-        const D3D11_SUBRESOURCE_DATA *data, ID3D11Buffer **buffer)
+static ULONG STDMETHODCALLTYPE d3d11_deferred_context_AddRef(ID3D11DeviceContext1 *iface)
 {
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    struct d3d_buffer *object;
-    HRESULT hr;
-
-    TRACE("iface %p, desc %p, data %p, buffer %p.\n", iface, desc, data, buffer);
-
-    if (FAILED(hr = d3d_buffer_create(device, desc, data, &object)))
-        return hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    ULONG refcount = InterlockedIncrement(&context->refcount);
 
-    *buffer = &object->ID3D11Buffer_iface;
+    TRACE("%p increasing refcount to %u.\n", context, refcount);
 
-    return S_OK;
+    return refcount;
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_device_CreateTexture1D(ID3D11Device2 *iface,
-        const D3D11_TEXTURE1D_DESC *desc, const D3D11_SUBRESOURCE_DATA *data, ID3D11Texture1D **texture)
+static ULONG STDMETHODCALLTYPE d3d11_deferred_context_Release(ID3D11DeviceContext1 *iface)
 {
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    struct d3d_texture1d *object;
-    HRESULT hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    ULONG refcount = InterlockedDecrement(&context->refcount);
 
-    TRACE("iface %p, desc %p, data %p, texture %p.\n", iface, desc, data, texture);
+    TRACE("%p decreasing refcount to %u.\n", context, refcount);
 
-    if (FAILED(hr = d3d_texture1d_create(device, desc, data, &object)))
-        return hr;
+    if (!refcount)
+    {
+        ID3D11Device2 *device = context->device;
+        struct d3d11_deferred_mapping *mapping, *next;
 
-    *texture = &object->ID3D11Texture1D_iface;
+        LIST_FOR_EACH_ENTRY_SAFE(mapping, next, &context->mappings, struct d3d11_deferred_mapping, entry)
+        {
+            heap_free(mapping->data);
+            heap_free(mapping);
+        }
 
-    return S_OK;
-}
+        wined3d_mutex_lock();
+        wined3d_deferred_context_destroy(context->wined3d_context);
+        wined3d_mutex_unlock();
+        wined3d_private_store_cleanup(&context->private_store);
+        heap_free(context);
 
-static HRESULT STDMETHODCALLTYPE d3d11_device_CreateTexture2D(ID3D11Device2 *iface,
-        const D3D11_TEXTURE2D_DESC *desc, const D3D11_SUBRESOURCE_DATA *data, ID3D11Texture2D **texture)
-{
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    struct d3d_texture2d *object;
-    HRESULT hr;
+        ID3D11Device2_Release(device);
+    }
 
-    TRACE("iface %p, desc %p, data %p, texture %p.\n", iface, desc, data, texture);
+    return refcount;
+}
 
-    if (FAILED(hr = d3d_texture2d_create(device, desc, data, &object)))
-        return hr;
+static void d3d11_deferred_context_set_constant_buffers(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int i;
 
-    *texture = &object->ID3D11Texture2D_iface;
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
 
-    return S_OK;
+        wined3d_deferred_context_set_constant_buffer(context->wined3d_context, type, start_slot + i,
+                buffer ? buffer->wined3d_buffer : NULL);
+    }
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_device_CreateTexture3D(ID3D11Device2 *iface,
-        const D3D11_TEXTURE3D_DESC *desc, const D3D11_SUBRESOURCE_DATA *data, ID3D11Texture3D **texture)
+static void d3d11_deferred_context_set_shader_resources(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
 {
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    struct d3d_texture3d *object;
-    HRESULT hr;
-
-    TRACE("iface %p, desc %p, data %p, texture %p.\n", iface, desc, data, texture);
-
-    if (FAILED(hr = d3d_texture3d_create(device, desc, data, &object)))
-        return hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int i;
 
-    *texture = &object->ID3D11Texture3D_iface;
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d_shader_resource_view *view = unsafe_impl_from_ID3D11ShaderResourceView(views[i]);
 
-    return S_OK;
+        wined3d_deferred_context_set_shader_resource_view(context->wined3d_context, type, start_slot + i,
+                view ? view->wined3d_view : NULL);
+    }
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_device_CreateShaderResourceView(ID3D11Device2 *iface,
-        ID3D11Resource *resource, const D3D11_SHADER_RESOURCE_VIEW_DESC *desc, ID3D11ShaderResourceView **view)
+static void d3d11_deferred_context_set_samplers(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
 {
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    struct d3d_shader_resource_view *object;
-    HRESULT hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int i;
 
-    TRACE("iface %p, resource %p, desc %p, view %p.\n", iface, resource, desc, view);
+    for (i = 0; i < sampler_count; ++i)
+    {
+        struct d3d_sampler_state *sampler = unsafe_impl_from_ID3D11SamplerState(samplers[i]);
 
-    if (!resource)
-        return E_INVALIDARG;
+        wined3d_deferred_context_set_sampler(context->wined3d_context, type, start_slot + i,
+                sampler ? sampler->wined3d_sampler : NULL);
+    }
+}
 
-    if (FAILED(hr = d3d_shader_resource_view_create(device, resource, desc, &object)))
-        return hr;
+static void d3d11_deferred_context_set_shader(ID3D11DeviceContext1 *iface,
+        enum wined3d_shader_type type, struct wined3d_shader *shader, ID3D11ClassInstance *const *class_instances)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    *view = &object->ID3D11ShaderResourceView_iface;
+    if (class_instances)
+        FIXME("Dynamic linking is not implemented yet.\n");
 
-    return S_OK;
+    wined3d_deferred_context_set_shader(context->wined3d_context, type, shader);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_device_CreateUnorderedAccessView(ID3D11Device2 *iface,
-        ID3D11Resource *resource, const D3D11_UNORDERED_ACCESS_VIEW_DESC *desc, ID3D11UnorderedAccessView **view)
+static void STDMETHODCALLTYPE d3d11_deferred_context_GetDevice(ID3D11DeviceContext1 *iface, ID3D11Device **device)
 {
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    struct d3d11_unordered_access_view *object;
-    HRESULT hr;
-
-    TRACE("iface %p, resource %p, desc %p, view %p.\n", iface, resource, desc, view);
-
-    if (FAILED(hr = d3d11_unordered_access_view_create(device, resource, desc, &object)))
-        return hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    *view = &object->ID3D11UnorderedAccessView_iface;
+    TRACE("iface %p, device %p.\n", iface, device);
 
-    return S_OK;
+    *device = (ID3D11Device *)context->device;
+    ID3D11Device_AddRef(*device);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_device_CreateRenderTargetView(ID3D11Device2 *iface,
-        ID3D11Resource *resource, const D3D11_RENDER_TARGET_VIEW_DESC *desc, ID3D11RenderTargetView **view)
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_GetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+        UINT *data_size, void *data)
 {
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    struct d3d_rendertarget_view *object;
-    HRESULT hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, resource %p, desc %p, view %p.\n", iface, resource, desc, view);
+    TRACE("iface %p, guid %s, data_size %p, data %p.\n", iface, debugstr_guid(guid), data_size, data);
 
-    if (!resource)
-        return E_INVALIDARG;
+    return d3d_get_private_data(&context->private_store, guid, data_size, data);
+}
 
-    if (FAILED(hr = d3d_rendertarget_view_create(device, resource, desc, &object)))
-        return hr;
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_SetPrivateData(ID3D11DeviceContext1 *iface, REFGUID guid,
+        UINT data_size, const void *data)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    *view = &object->ID3D11RenderTargetView_iface;
+    TRACE("iface %p, guid %s, data_size %u, data %p.\n", iface, debugstr_guid(guid), data_size, data);
 
-    return S_OK;
+    return d3d_set_private_data(&context->private_store, guid, data_size, data);
 }
 
-static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDepthStencilView(ID3D11Device2 *iface,
-        ID3D11Resource *resource, const D3D11_DEPTH_STENCIL_VIEW_DESC *desc, ID3D11DepthStencilView **view)
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_SetPrivateDataInterface(ID3D11DeviceContext1 *iface,
+        REFGUID guid, const IUnknown *data)
 {
-    struct d3d_device *device = impl_from_ID3D11Device2(iface);
-    struct d3d_depthstencil_view *object;
-    HRESULT hr;
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
 
-    TRACE("iface %p, resource %p, desc %p, view %p.\n", iface, resource, desc, view);
+    TRACE("iface %p, guid %s, data %p.\n", iface, debugstr_guid(guid), data);
 
-    if (FAILED(hr = d3d_depthstencil_view_create(device, resource, desc, &object)))
-        return hr;
+    return d3d_set_private_data_interface(&context->private_store, guid, data);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot, view_count, views);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11PixelShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_pixel_shader *ps = unsafe_impl_from_ID3D11PixelShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_PIXEL,
+            ps ? ps->wined3d_shader : NULL, class_instances);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot, sampler_count, samplers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11VertexShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_vertex_shader *vs = unsafe_impl_from_ID3D11VertexShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_VERTEX,
+            vs ? vs->wined3d_shader : NULL, class_instances);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawIndexed(ID3D11DeviceContext1 *iface,
+        UINT index_count, UINT start_index_location, INT base_vertex_location)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, index_count %u, start_index_location %u, base_vertex_location %d.\n",
+            iface, index_count, start_index_location, base_vertex_location);
+
+    wined3d_deferred_context_draw(context->wined3d_context, base_vertex_location,
+            start_index_location, index_count, 0, 0, TRUE);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_Draw(ID3D11DeviceContext1 *iface,
+        UINT vertex_count, UINT start_vertex_location)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, vertex_count %u, start_vertex_location %u.\n",
+            iface, vertex_count, start_vertex_location);
+
+    wined3d_deferred_context_draw(context->wined3d_context, 0, start_vertex_location, vertex_count, 0, 0, FALSE);
+}
+
+static struct d3d11_deferred_mapping *d3d11_deferred_context_find_mapping(struct d3d11_deferred_context *context,
+        struct wined3d_resource *resource, UINT subresource_idx)
+{
+    struct d3d11_deferred_mapping *mapping;
+
+    LIST_FOR_EACH_ENTRY(mapping, &context->mappings, struct d3d11_deferred_mapping, entry)
+    {
+        if (mapping->resource == resource && mapping->subresource_idx == subresource_idx)
+            return mapping;
+    }
+
+    return NULL;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_Map(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
+        UINT subresource_idx, D3D11_MAP map_type, UINT map_flags, D3D11_MAPPED_SUBRESOURCE *mapped_subresource)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_mapping *mapping;
+    struct wined3d_resource_desc desc;
+    struct wined3d_resource *wined3d_resource;
+
+    TRACE("iface %p, resource %p, subresource_idx %u, map_type %u, map_flags %#x, mapped_subresource %p.\n",
+            iface, resource, subresource_idx, map_type, map_flags, mapped_subresource);
+
+    if (map_flags)
+        FIXME("Ignoring map_flags %#x.\n", map_flags);
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+    wined3d_resource_get_desc(wined3d_resource, &desc);
+
+    /* Discard maps of buffers are recorded as an update of the whole
+     * buffer when the resource is unmapped. */
+    if (map_type != D3D11_MAP_WRITE_DISCARD || desc.resource_type != WINED3D_RTYPE_BUFFER)
+    {
+        FIXME("Unhandled map type %#x for resource type %#x.\n", map_type, desc.resource_type);
+        return E_NOTIMPL;
+    }
+
+    if (d3d11_deferred_context_find_mapping(context, wined3d_resource, subresource_idx))
+    {
+        WARN("Resource %p, subresource %u is already mapped.\n", resource, subresource_idx);
+        return E_INVALIDARG;
+    }
+
+    if (!(mapping = heap_alloc(sizeof(*mapping))))
+        return E_OUTOFMEMORY;
+    if (!(mapping->data = heap_alloc(desc.size)))
+    {
+        heap_free(mapping);
+        return E_OUTOFMEMORY;
+    }
+    mapping->resource = wined3d_resource;
+    mapping->subresource_idx = subresource_idx;
+    list_add_tail(&context->mappings, &mapping->entry);
+
+    mapped_subresource->pData = mapping->data;
+    mapped_subresource->RowPitch = desc.size;
+    mapped_subresource->DepthPitch = desc.size;
+
+    return S_OK;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_Unmap(ID3D11DeviceContext1 *iface, ID3D11Resource *resource,
+        UINT subresource_idx)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_deferred_mapping *mapping;
+    struct wined3d_resource *wined3d_resource;
+
+    TRACE("iface %p, resource %p, subresource_idx %u.\n", iface, resource, subresource_idx);
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+    if (!(mapping = d3d11_deferred_context_find_mapping(context, wined3d_resource, subresource_idx)))
+    {
+        WARN("Resource %p, subresource %u is not mapped.\n", resource, subresource_idx);
+        return;
+    }
+
+    wined3d_deferred_context_update_sub_resource(context->wined3d_context, wined3d_resource,
+            subresource_idx, NULL, mapping->data, 0, 0);
+
+    list_remove(&mapping->entry);
+    heap_free(mapping->data);
+    heap_free(mapping);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_PIXEL, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetInputLayout(ID3D11DeviceContext1 *iface,
+        ID3D11InputLayout *input_layout)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d_input_layout *layout = unsafe_impl_from_ID3D11InputLayout(input_layout);
+
+    TRACE("iface %p, input_layout %p.\n", iface, input_layout);
+
+    wined3d_deferred_context_set_vertex_declaration(context->wined3d_context,
+            layout ? layout->wined3d_decl : NULL);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetVertexBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers, const UINT *strides, const UINT *offsets)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p.\n",
+            iface, start_slot, buffer_count, buffers, strides, offsets);
+
+    for (i = 0; i < buffer_count; ++i)
+    {
+        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+
+        wined3d_deferred_context_set_stream_source(context->wined3d_context, start_slot + i,
+                buffer ? buffer->wined3d_buffer : NULL, offsets[i], strides[i]);
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetIndexBuffer(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, DXGI_FORMAT format, UINT offset)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d_buffer *buffer_impl = unsafe_impl_from_ID3D11Buffer(buffer);
+
+    TRACE("iface %p, buffer %p, format %s, offset %u.\n",
+            iface, buffer, debug_dxgi_format(format), offset);
+
+    wined3d_deferred_context_set_index_buffer(context->wined3d_context,
+            buffer_impl ? buffer_impl->wined3d_buffer : NULL,
+            wined3dformat_from_dxgi_format(format), offset);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawIndexedInstanced(ID3D11DeviceContext1 *iface,
+        UINT instance_index_count, UINT instance_count, UINT start_index_location, INT base_vertex_location,
+        UINT start_instance_location)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, instance_index_count %u, instance_count %u, start_index_location %u, "
+            "base_vertex_location %d, start_instance_location %u.\n",
+            iface, instance_index_count, instance_count, start_index_location,
+            base_vertex_location, start_instance_location);
+
+    wined3d_deferred_context_draw(context->wined3d_context, base_vertex_location, start_index_location,
+            instance_index_count, start_instance_location, instance_count, TRUE);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawInstanced(ID3D11DeviceContext1 *iface,
+        UINT instance_vertex_count, UINT instance_count, UINT start_vertex_location, UINT start_instance_location)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, instance_vertex_count %u, instance_count %u, start_vertex_location %u, "
+            "start_instance_location %u.\n",
+            iface, instance_vertex_count, instance_count, start_vertex_location,
+            start_instance_location);
+
+    wined3d_deferred_context_draw(context->wined3d_context, 0, start_vertex_location,
+            instance_vertex_count, start_instance_location, instance_count, FALSE);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11GeometryShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d_geometry_shader *gs = unsafe_impl_from_ID3D11GeometryShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_GEOMETRY,
+            gs ? gs->wined3d_shader : NULL, class_instances);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_IASetPrimitiveTopology(ID3D11DeviceContext1 *iface,
+        D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    enum wined3d_primitive_type primitive_type;
+    unsigned int patch_vertex_count;
+
+    TRACE("iface %p, topology %#x.\n", iface, topology);
+
+    wined3d_primitive_type_from_d3d11_primitive_topology(topology, &primitive_type, &patch_vertex_count);
+
+    wined3d_deferred_context_set_primitive_type(context->wined3d_context, primitive_type, patch_vertex_count);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot, view_count, views);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_VERTEX, start_slot, sampler_count, samplers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_Begin(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous)
+{
+    FIXME("iface %p, asynchronous %p stub!\n", iface, asynchronous);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_End(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous)
+{
+    FIXME("iface %p, asynchronous %p stub!\n", iface, asynchronous);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_GetData(ID3D11DeviceContext1 *iface,
+        ID3D11Asynchronous *asynchronous, void *data, UINT data_size, UINT data_flags)
+{
+    FIXME("iface %p, asynchronous %p, data %p, data_size %u, data_flags %u stub!\n",
+            iface, asynchronous, data, data_size, data_flags);
+
+    return E_NOTIMPL;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_SetPredication(ID3D11DeviceContext1 *iface,
+        ID3D11Predicate *predicate, BOOL value)
+{
+    FIXME("iface %p, predicate %p, value %#x stub!\n", iface, predicate, value);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
+            view_count, views);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_GEOMETRY, start_slot,
+            sampler_count, samplers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetRenderTargets(ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView *const *render_target_views,
+        ID3D11DepthStencilView *depth_stencil_view)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d_depthstencil_view *dsv;
+    unsigned int i;
+
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view);
+
+    for (i = 0; i < render_target_view_count; ++i)
+    {
+        struct d3d_rendertarget_view *rtv = unsafe_impl_from_ID3D11RenderTargetView(render_target_views[i]);
+        wined3d_deferred_context_set_rendertarget_view(context->wined3d_context, i,
+                rtv ? rtv->wined3d_view : NULL);
+    }
+    for (; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+    {
+        wined3d_deferred_context_set_rendertarget_view(context->wined3d_context, i, NULL);
+    }
+
+    dsv = unsafe_impl_from_ID3D11DepthStencilView(depth_stencil_view);
+    wined3d_deferred_context_set_depth_stencil_view(context->wined3d_context, dsv ? dsv->wined3d_view : NULL);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetRenderTargetsAndUnorderedAccessViews(
+        ID3D11DeviceContext1 *iface, UINT render_target_view_count,
+        ID3D11RenderTargetView *const *render_target_views, ID3D11DepthStencilView *depth_stencil_view,
+        UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
+        ID3D11UnorderedAccessView *const *unordered_access_views, const UINT *initial_counts)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
+            "unordered_access_view_start_slot %u, unordered_access_view_count %u, unordered_access_views %p, "
+            "initial_counts %p.\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view,
+            unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views,
+            initial_counts);
+
+    if (render_target_view_count != D3D11_KEEP_RENDER_TARGETS_AND_DEPTH_STENCIL)
+    {
+        d3d11_deferred_context_OMSetRenderTargets(iface, render_target_view_count, render_target_views,
+                depth_stencil_view);
+    }
+
+    if (unordered_access_view_count != D3D11_KEEP_UNORDERED_ACCESS_VIEWS)
+    {
+        for (i = 0; i < unordered_access_view_start_slot; ++i)
+        {
+            wined3d_deferred_context_set_unordered_access_view(context->wined3d_context, i, NULL, ~0u);
+        }
+        for (i = 0; i < unordered_access_view_count; ++i)
+        {
+            struct d3d11_unordered_access_view *view
+                    = unsafe_impl_from_ID3D11UnorderedAccessView(unordered_access_views[i]);
+
+            wined3d_deferred_context_set_unordered_access_view(context->wined3d_context,
+                    unordered_access_view_start_slot + i,
+                    view ? view->wined3d_view : NULL, initial_counts ? initial_counts[i] : ~0u);
+        }
+        for (; unordered_access_view_start_slot + i < D3D11_PS_CS_UAV_REGISTER_COUNT; ++i)
+        {
+            wined3d_deferred_context_set_unordered_access_view(context->wined3d_context,
+                    unordered_access_view_start_slot + i, NULL, ~0u);
+        }
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetBlendState(ID3D11DeviceContext1 *iface,
+        ID3D11BlendState *blend_state, const float blend_factor[4], UINT sample_mask)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    static const float default_blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    struct wined3d_deferred_context *wined3d_context = context->wined3d_context;
+    struct d3d_blend_state *blend_state_impl;
+    const D3D11_BLEND_DESC *desc;
+
+    TRACE("iface %p, blend_state %p, blend_factor %s, sample_mask 0x%08x.\n",
+            iface, blend_state, debug_float4(blend_factor), sample_mask);
+
+    if (!blend_factor)
+        blend_factor = default_blend_factor;
+
+    wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_MULTISAMPLEMASK, sample_mask);
+    if (!(blend_state_impl = unsafe_impl_from_ID3D11BlendState(blend_state)))
+    {
+        wined3d_deferred_context_set_blend_state(wined3d_context, NULL,
+                (const struct wined3d_color *)blend_factor);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_ALPHABLENDENABLE, FALSE);
+        wined3d_deferred_context_set_render_state(wined3d_context,
+                WINED3D_RS_COLORWRITEENABLE, D3D11_COLOR_WRITE_ENABLE_ALL);
+        wined3d_deferred_context_set_render_state(wined3d_context,
+                WINED3D_RS_COLORWRITEENABLE1, D3D11_COLOR_WRITE_ENABLE_ALL);
+        wined3d_deferred_context_set_render_state(wined3d_context,
+                WINED3D_RS_COLORWRITEENABLE2, D3D11_COLOR_WRITE_ENABLE_ALL);
+        wined3d_deferred_context_set_render_state(wined3d_context,
+                WINED3D_RS_COLORWRITEENABLE3, D3D11_COLOR_WRITE_ENABLE_ALL);
+        return;
+    }
+
+    wined3d_deferred_context_set_blend_state(wined3d_context, blend_state_impl->wined3d_state,
+            (const struct wined3d_color *)blend_factor);
+    desc = &blend_state_impl->desc;
+    wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_ALPHABLENDENABLE,
+            desc->RenderTarget[0].BlendEnable);
+    if (desc->RenderTarget[0].BlendEnable)
+    {
+        const D3D11_RENDER_TARGET_BLEND_DESC *d = &desc->RenderTarget[0];
+
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_SRCBLEND, d->SrcBlend);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_DESTBLEND, d->DestBlend);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_BLENDOP, d->BlendOp);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_SEPARATEALPHABLENDENABLE, TRUE);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_SRCBLENDALPHA, d->SrcBlendAlpha);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_DESTBLENDALPHA, d->DestBlendAlpha);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_BLENDOPALPHA, d->BlendOpAlpha);
+    }
+    wined3d_deferred_context_set_render_state(wined3d_context,
+            WINED3D_RS_COLORWRITEENABLE, desc->RenderTarget[0].RenderTargetWriteMask);
+    wined3d_deferred_context_set_render_state(wined3d_context,
+            WINED3D_RS_COLORWRITEENABLE1, desc->RenderTarget[1].RenderTargetWriteMask);
+    wined3d_deferred_context_set_render_state(wined3d_context,
+            WINED3D_RS_COLORWRITEENABLE2, desc->RenderTarget[2].RenderTargetWriteMask);
+    wined3d_deferred_context_set_render_state(wined3d_context,
+            WINED3D_RS_COLORWRITEENABLE3, desc->RenderTarget[3].RenderTargetWriteMask);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMSetDepthStencilState(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilState *depth_stencil_state, UINT stencil_ref)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct wined3d_deferred_context *wined3d_context = context->wined3d_context;
+    struct d3d_depthstencil_state *state_impl;
+    const D3D11_DEPTH_STENCILOP_DESC *front, *back;
+    const D3D11_DEPTH_STENCIL_DESC *desc;
+
+    TRACE("iface %p, depth_stencil_state %p, stencil_ref %u.\n",
+            iface, depth_stencil_state, stencil_ref);
+
+    if (!(state_impl = unsafe_impl_from_ID3D11DepthStencilState(depth_stencil_state)))
+    {
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_ZENABLE, TRUE);
+        wined3d_deferred_context_set_render_state(wined3d_context,
+                WINED3D_RS_ZWRITEENABLE, D3D11_DEPTH_WRITE_MASK_ALL);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_ZFUNC, WINED3D_CMP_LESS);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_STENCILENABLE, FALSE);
+        return;
+    }
+
+    desc = &state_impl->desc;
+
+    front = &desc->FrontFace;
+    back = &desc->BackFace;
+
+    wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_ZENABLE, desc->DepthEnable);
+    if (desc->DepthEnable)
+    {
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_ZWRITEENABLE, desc->DepthWriteMask);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_ZFUNC, desc->DepthFunc);
+    }
+
+    wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_STENCILENABLE, desc->StencilEnable);
+    if (desc->StencilEnable)
+    {
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_STENCILMASK, desc->StencilReadMask);
+        wined3d_deferred_context_set_render_state(wined3d_context,
+                WINED3D_RS_STENCILWRITEMASK, desc->StencilWriteMask);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_STENCILREF, stencil_ref);
+
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_STENCILFAIL, front->StencilFailOp);
+        wined3d_deferred_context_set_render_state(wined3d_context,
+                WINED3D_RS_STENCILZFAIL, front->StencilDepthFailOp);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_STENCILPASS, front->StencilPassOp);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_STENCILFUNC, front->StencilFunc);
+        if (front->StencilFailOp != back->StencilFailOp
+                || front->StencilDepthFailOp != back->StencilDepthFailOp
+                || front->StencilPassOp != back->StencilPassOp
+                || front->StencilFunc != back->StencilFunc)
+        {
+            wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_TWOSIDEDSTENCILMODE, TRUE);
+            wined3d_deferred_context_set_render_state(wined3d_context,
+                    WINED3D_RS_BACK_STENCILFAIL, back->StencilFailOp);
+            wined3d_deferred_context_set_render_state(wined3d_context,
+                    WINED3D_RS_BACK_STENCILZFAIL, back->StencilDepthFailOp);
+            wined3d_deferred_context_set_render_state(wined3d_context,
+                    WINED3D_RS_BACK_STENCILPASS, back->StencilPassOp);
+            wined3d_deferred_context_set_render_state(wined3d_context,
+                    WINED3D_RS_BACK_STENCILFUNC, back->StencilFunc);
+        }
+        else
+        {
+            wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_TWOSIDEDSTENCILMODE, FALSE);
+        }
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_SOSetTargets(ID3D11DeviceContext1 *iface, UINT buffer_count,
+        ID3D11Buffer *const *buffers, const UINT *offsets)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int count, i;
+
+    TRACE("iface %p, buffer_count %u, buffers %p, offsets %p.\n", iface, buffer_count, buffers, offsets);
+
+    count = min(buffer_count, D3D11_SO_BUFFER_SLOT_COUNT);
+    for (i = 0; i < count; ++i)
+    {
+        struct d3d_buffer *buffer = unsafe_impl_from_ID3D11Buffer(buffers[i]);
+
+        wined3d_deferred_context_set_stream_output(context->wined3d_context, i,
+                buffer ? buffer->wined3d_buffer : NULL, offsets ? offsets[i] : 0);
+    }
+    for (; i < D3D11_SO_BUFFER_SLOT_COUNT; ++i)
+    {
+        wined3d_deferred_context_set_stream_output(context->wined3d_context, i, NULL, 0);
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawAuto(ID3D11DeviceContext1 *iface)
+{
+    FIXME("iface %p stub!\n", iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawIndexedInstancedIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
+{
+    FIXME("iface %p, buffer %p, offset %u stub!\n", iface, buffer, offset);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DrawInstancedIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
+{
+    FIXME("iface %p, buffer %p, offset %u stub!\n", iface, buffer, offset);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_Dispatch(ID3D11DeviceContext1 *iface,
+        UINT thread_group_count_x, UINT thread_group_count_y, UINT thread_group_count_z)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, thread_group_count_x %u, thread_group_count_y %u, thread_group_count_z %u.\n",
+            iface, thread_group_count_x, thread_group_count_y, thread_group_count_z);
+
+    wined3d_deferred_context_dispatch(context->wined3d_context,
+            thread_group_count_x, thread_group_count_y, thread_group_count_z);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DispatchIndirect(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *buffer, UINT offset)
+{
+    FIXME("iface %p, buffer %p, offset %u stub!\n", iface, buffer, offset);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetState(ID3D11DeviceContext1 *iface,
+        ID3D11RasterizerState *rasterizer_state)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct wined3d_deferred_context *wined3d_context = context->wined3d_context;
+    struct d3d_rasterizer_state *rasterizer_state_impl;
+    const D3D11_RASTERIZER_DESC *desc;
+    union
+    {
+        DWORD d;
+        float f;
+    } scale_bias, const_bias;
+
+    TRACE("iface %p, rasterizer_state %p.\n", iface, rasterizer_state);
+
+    if (!(rasterizer_state_impl = unsafe_impl_from_ID3D11RasterizerState(rasterizer_state)))
+    {
+        wined3d_deferred_context_set_rasterizer_state(wined3d_context, NULL);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_FILLMODE, WINED3D_FILL_SOLID);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_CULLMODE, WINED3D_CULL_BACK);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_SLOPESCALEDEPTHBIAS, 0);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_DEPTHBIAS, 0);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_SCISSORTESTENABLE, FALSE);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_MULTISAMPLEANTIALIAS, FALSE);
+        wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_ANTIALIASEDLINEENABLE, FALSE);
+        return;
+    }
+
+    wined3d_deferred_context_set_rasterizer_state(wined3d_context, rasterizer_state_impl->wined3d_state);
+
+    desc = &rasterizer_state_impl->desc;
+    wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_FILLMODE, desc->FillMode);
+    wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_CULLMODE, desc->CullMode);
+    scale_bias.f = desc->SlopeScaledDepthBias;
+    const_bias.f = desc->DepthBias;
+    wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_SLOPESCALEDEPTHBIAS, scale_bias.d);
+    wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_DEPTHBIAS, const_bias.d);
+    wined3d_deferred_context_set_render_state(wined3d_context, WINED3D_RS_SCISSORTESTENABLE, desc->ScissorEnable);
+    wined3d_deferred_context_set_render_state(wined3d_context,
+            WINED3D_RS_MULTISAMPLEANTIALIAS, desc->MultisampleEnable);
+    wined3d_deferred_context_set_render_state(wined3d_context,
+            WINED3D_RS_ANTIALIASEDLINEENABLE, desc->AntialiasedLineEnable);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetViewports(ID3D11DeviceContext1 *iface,
+        UINT viewport_count, const D3D11_VIEWPORT *viewports)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct wined3d_viewport wined3d_vp[WINED3D_MAX_VIEWPORTS];
+    unsigned int i;
+
+    TRACE("iface %p, viewport_count %u, viewports %p.\n", iface, viewport_count, viewports);
+
+    if (viewport_count > ARRAY_SIZE(wined3d_vp))
+        return;
+
+    for (i = 0; i < viewport_count; ++i)
+    {
+        wined3d_vp[i].x = viewports[i].TopLeftX;
+        wined3d_vp[i].y = viewports[i].TopLeftY;
+        wined3d_vp[i].width = viewports[i].Width;
+        wined3d_vp[i].height = viewports[i].Height;
+        wined3d_vp[i].min_z = viewports[i].MinDepth;
+        wined3d_vp[i].max_z = viewports[i].MaxDepth;
+    }
+
+    wined3d_deferred_context_set_viewports(context->wined3d_context, viewport_count, wined3d_vp);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSSetScissorRects(ID3D11DeviceContext1 *iface,
+        UINT rect_count, const D3D11_RECT *rects)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p, rect_count %u, rects %p.\n", iface, rect_count, rects);
+
+    if (rect_count > WINED3D_MAX_VIEWPORTS)
+        return;
+
+    wined3d_deferred_context_set_scissor_rects(context->wined3d_context, rect_count, rects);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopySubresourceRegion(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
+        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+    struct wined3d_box wined3d_src_box;
+
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
+            "src_resource %p, src_subresource_idx %u, src_box %p.\n",
+            iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
+            src_resource, src_subresource_idx, src_box);
+
+    if (src_box)
+        wined3d_box_set(&wined3d_src_box, src_box->left, src_box->top,
+                src_box->right, src_box->bottom, src_box->front, src_box->back);
+
+    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
+    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
+    wined3d_deferred_context_copy_sub_resource_region(context->wined3d_context,
+            wined3d_dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
+            wined3d_src_resource, src_subresource_idx, src_box ? &wined3d_src_box : NULL);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopyResource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, ID3D11Resource *src_resource)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_dst_resource, *wined3d_src_resource;
+
+    TRACE("iface %p, dst_resource %p, src_resource %p.\n", iface, dst_resource, src_resource);
+
+    wined3d_dst_resource = wined3d_resource_from_d3d11_resource(dst_resource);
+    wined3d_src_resource = wined3d_resource_from_d3d11_resource(src_resource);
+    wined3d_deferred_context_copy_resource(context->wined3d_context, wined3d_dst_resource, wined3d_src_resource);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_UpdateSubresource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box,
+        const void *data, UINT row_pitch, UINT depth_pitch)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct wined3d_resource *wined3d_resource;
+    struct wined3d_box wined3d_box;
+
+    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u.\n",
+            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch);
+
+    if (box)
+        wined3d_box_set(&wined3d_box, box->left, box->top, box->right, box->bottom, box->front, box->back);
+
+    wined3d_resource = wined3d_resource_from_d3d11_resource(resource);
+    wined3d_deferred_context_update_sub_resource(context->wined3d_context, wined3d_resource,
+            subresource_idx, box ? &wined3d_box : NULL, data, row_pitch, depth_pitch);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopyStructureCount(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer *dst_buffer, UINT dst_offset, ID3D11UnorderedAccessView *src_view)
+{
+    FIXME("iface %p, dst_buffer %p, dst_offset %u, src_view %p stub!\n", iface, dst_buffer, dst_offset, src_view);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearRenderTargetView(ID3D11DeviceContext1 *iface,
+        ID3D11RenderTargetView *render_target_view, const float color_rgba[4])
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d_rendertarget_view *view = unsafe_impl_from_ID3D11RenderTargetView(render_target_view);
+    const struct wined3d_color color = {color_rgba[0], color_rgba[1], color_rgba[2], color_rgba[3]};
+    HRESULT hr;
+
+    TRACE("iface %p, render_target_view %p, color_rgba %s.\n",
+            iface, render_target_view, debug_float4(color_rgba));
+
+    if (!view)
+        return;
+
+    if (FAILED(hr = wined3d_deferred_context_clear_rendertarget_view(context->wined3d_context,
+            view->wined3d_view, NULL, WINED3DCLEAR_TARGET, &color, 0.0f, 0)))
+        ERR("Failed to clear view, hr %#x.\n", hr);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearUnorderedAccessViewUint(ID3D11DeviceContext1 *iface,
+        ID3D11UnorderedAccessView *unordered_access_view, const UINT values[4])
+{
+    FIXME("iface %p, unordered_access_view %p, values %p stub!\n", iface, unordered_access_view, values);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearUnorderedAccessViewFloat(ID3D11DeviceContext1 *iface,
+        ID3D11UnorderedAccessView *unordered_access_view, const float values[4])
+{
+    FIXME("iface %p, unordered_access_view %p, values %s stub!\n",
+            iface, unordered_access_view, debug_float4(values));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearDepthStencilView(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilView *depth_stencil_view, UINT flags, FLOAT depth, UINT8 stencil)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d_depthstencil_view *view = unsafe_impl_from_ID3D11DepthStencilView(depth_stencil_view);
+    DWORD wined3d_flags;
+    HRESULT hr;
+
+    TRACE("iface %p, depth_stencil_view %p, flags %#x, depth %.8e, stencil %u.\n",
+            iface, depth_stencil_view, flags, depth, stencil);
+
+    if (!view)
+        return;
+
+    wined3d_flags = wined3d_clear_flags_from_d3d11_clear_flags(flags);
+
+    if (FAILED(hr = wined3d_deferred_context_clear_rendertarget_view(context->wined3d_context,
+            view->wined3d_view, NULL, wined3d_flags, NULL, depth, stencil)))
+        ERR("Failed to clear view, hr %#x.\n", hr);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GenerateMips(ID3D11DeviceContext1 *iface,
+        ID3D11ShaderResourceView *view)
+{
+    FIXME("iface %p, view %p stub!\n", iface, view);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_SetResourceMinLOD(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, FLOAT min_lod)
+{
+    FIXME("iface %p, resource %p, min_lod %f stub!\n", iface, resource, min_lod);
+}
+
+static FLOAT STDMETHODCALLTYPE d3d11_deferred_context_GetResourceMinLOD(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource)
+{
+    FIXME("iface %p, resource %p stub!\n", iface, resource);
+
+    return 0.0f;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_ResolveSubresource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx,
+        ID3D11Resource *src_resource, UINT src_subresource_idx,
+        DXGI_FORMAT format)
+{
+    FIXME("iface %p, dst_resource %p, dst_subresource_idx %u, src_resource %p, src_subresource_idx %u, format %#x stub!\n",
+            iface, dst_resource, dst_subresource_idx, src_resource, src_subresource_idx, format);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_ExecuteCommandList(ID3D11DeviceContext1 *iface,
+        ID3D11CommandList *command_list, BOOL restore_state)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_command_list *list = unsafe_impl_from_ID3D11CommandList(command_list);
+
+    TRACE("iface %p, command_list %p, restore_state %#x.\n", iface, command_list, restore_state);
+
+    wined3d_deferred_context_execute_command_list(context->wined3d_context, list->wined3d_list);
+
+    /* Same as on the immediate context. */
+    if (!restore_state)
+        ID3D11DeviceContext1_ClearState(iface);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_HULL, start_slot, view_count, views);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11HullShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d11_hull_shader *hs = unsafe_impl_from_ID3D11HullShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_HULL,
+            hs ? hs->wined3d_shader : NULL, class_instances);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_HULL, start_slot, sampler_count, samplers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_HULL, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot, view_count, views);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11DomainShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d11_domain_shader *ds = unsafe_impl_from_ID3D11DomainShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_DOMAIN,
+            ds ? ds->wined3d_shader : NULL, class_instances);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot, sampler_count, samplers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_DOMAIN, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView *const *views)
+{
+    TRACE("iface %p, start_slot %u, view_count %u, views %p.\n",
+            iface, start_slot, view_count, views);
+
+    d3d11_deferred_context_set_shader_resources(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
+            view_count, views);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11UnorderedAccessView *const *views, const UINT *initial_counts)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    unsigned int i;
+
+    TRACE("iface %p, start_slot %u, view_count %u, views %p, initial_counts %p.\n",
+            iface, start_slot, view_count, views, initial_counts);
+
+    for (i = 0; i < view_count; ++i)
+    {
+        struct d3d11_unordered_access_view *view = unsafe_impl_from_ID3D11UnorderedAccessView(views[i]);
+
+        wined3d_deferred_context_set_cs_uav(context->wined3d_context, start_slot + i,
+                view ? view->wined3d_view : NULL, initial_counts ? initial_counts[i] : ~0u);
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetShader(ID3D11DeviceContext1 *iface,
+        ID3D11ComputeShader *shader, ID3D11ClassInstance *const *class_instances, UINT class_instance_count)
+{
+    struct d3d11_compute_shader *cs = unsafe_impl_from_ID3D11ComputeShader(shader);
+
+    TRACE("iface %p, shader %p, class_instances %p, class_instance_count %u.\n",
+            iface, shader, class_instances, class_instance_count);
+
+    d3d11_deferred_context_set_shader(iface, WINED3D_SHADER_TYPE_COMPUTE,
+            cs ? cs->wined3d_shader : NULL, class_instances);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState *const *samplers)
+{
+    TRACE("iface %p, start_slot %u, sampler_count %u, samplers %p.\n",
+            iface, start_slot, sampler_count, samplers);
+
+    d3d11_deferred_context_set_samplers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
+            sampler_count, samplers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer *const *buffers)
+{
+    TRACE("iface %p, start_slot %u, buffer_count %u, buffers %p.\n",
+            iface, start_slot, buffer_count, buffers);
+
+    d3d11_deferred_context_set_constant_buffers(iface, WINED3D_SHADER_TYPE_COMPUTE, start_slot,
+            buffer_count, buffers);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p stub!\n", iface, start_slot, buffer_count, buffers);
+
+    if (buffers)
+        memset(buffers, 0, buffer_count * sizeof(*buffers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    FIXME("iface %p, start_slot %u, view_count %u, views %p stub!\n", iface, start_slot, view_count, views);
+
+    if (views)
+        memset(views, 0, view_count * sizeof(*views));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11PixelShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    FIXME("iface %p, shader %p, class_instances %p, class_instance_count %p stub!\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (shader)
+        *shader = NULL;
+    if (class_instance_count)
+        *class_instance_count = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    FIXME("iface %p, start_slot %u, sampler_count %u, samplers %p stub!\n", iface, start_slot, sampler_count, samplers);
+
+    if (samplers)
+        memset(samplers, 0, sampler_count * sizeof(*samplers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11VertexShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    FIXME("iface %p, shader %p, class_instances %p, class_instance_count %p stub!\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (shader)
+        *shader = NULL;
+    if (class_instance_count)
+        *class_instance_count = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p stub!\n", iface, start_slot, buffer_count, buffers);
+
+    if (buffers)
+        memset(buffers, 0, buffer_count * sizeof(*buffers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetInputLayout(ID3D11DeviceContext1 *iface,
+        ID3D11InputLayout **input_layout)
+{
+    FIXME("iface %p, input_layout %p stub!\n", iface, input_layout);
+
+    if (input_layout)
+        *input_layout = NULL;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetVertexBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *strides, UINT *offsets)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, strides %p, offsets %p stub!\n",
+            iface, start_slot, buffer_count, buffers, strides, offsets);
+
+    if (buffers)
+        memset(buffers, 0, buffer_count * sizeof(*buffers));
+    if (strides)
+        memset(strides, 0, buffer_count * sizeof(*strides));
+    if (offsets)
+        memset(offsets, 0, buffer_count * sizeof(*offsets));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetIndexBuffer(ID3D11DeviceContext1 *iface,
+        ID3D11Buffer **buffer, DXGI_FORMAT *format, UINT *offset)
+{
+    FIXME("iface %p, buffer %p, format %p, offset %p stub!\n", iface, buffer, format, offset);
+
+    if (buffer)
+        *buffer = NULL;
+    if (format)
+        *format = DXGI_FORMAT_UNKNOWN;
+    if (offset)
+        *offset = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p stub!\n", iface, start_slot, buffer_count, buffers);
+
+    if (buffers)
+        memset(buffers, 0, buffer_count * sizeof(*buffers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11GeometryShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    FIXME("iface %p, shader %p, class_instances %p, class_instance_count %p stub!\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (shader)
+        *shader = NULL;
+    if (class_instance_count)
+        *class_instance_count = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_IAGetPrimitiveTopology(ID3D11DeviceContext1 *iface,
+        D3D11_PRIMITIVE_TOPOLOGY *topology)
+{
+    FIXME("iface %p, topology %p stub!\n", iface, topology);
+
+    if (topology)
+        *topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    FIXME("iface %p, start_slot %u, view_count %u, views %p stub!\n", iface, start_slot, view_count, views);
+
+    if (views)
+        memset(views, 0, view_count * sizeof(*views));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    FIXME("iface %p, start_slot %u, sampler_count %u, samplers %p stub!\n", iface, start_slot, sampler_count, samplers);
+
+    if (samplers)
+        memset(samplers, 0, sampler_count * sizeof(*samplers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GetPredication(ID3D11DeviceContext1 *iface,
+        ID3D11Predicate **predicate, BOOL *value)
+{
+    FIXME("iface %p, predicate %p, value %p stub!\n", iface, predicate, value);
+
+    if (predicate)
+        *predicate = NULL;
+    if (value)
+        *value = FALSE;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    FIXME("iface %p, start_slot %u, view_count %u, views %p stub!\n", iface, start_slot, view_count, views);
+
+    if (views)
+        memset(views, 0, view_count * sizeof(*views));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    FIXME("iface %p, start_slot %u, sampler_count %u, samplers %p stub!\n", iface, start_slot, sampler_count, samplers);
+
+    if (samplers)
+        memset(samplers, 0, sampler_count * sizeof(*samplers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetRenderTargets(ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
+        ID3D11DepthStencilView **depth_stencil_view)
+{
+    FIXME("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p stub!\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view);
+
+    if (render_target_views)
+        memset(render_target_views, 0, render_target_view_count * sizeof(*render_target_views));
+    if (depth_stencil_view)
+        *depth_stencil_view = NULL;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetRenderTargetsAndUnorderedAccessViews(
+        ID3D11DeviceContext1 *iface,
+        UINT render_target_view_count, ID3D11RenderTargetView **render_target_views,
+        ID3D11DepthStencilView **depth_stencil_view,
+        UINT unordered_access_view_start_slot, UINT unordered_access_view_count,
+        ID3D11UnorderedAccessView **unordered_access_views)
+{
+    FIXME("iface %p, render_target_view_count %u, render_target_views %p, depth_stencil_view %p, "
+            "unordered_access_view_start_slot %u, unordered_access_view_count %u, "
+            "unordered_access_views %p stub!\n",
+            iface, render_target_view_count, render_target_views, depth_stencil_view,
+            unordered_access_view_start_slot, unordered_access_view_count, unordered_access_views);
+
+    if (render_target_views)
+        memset(render_target_views, 0, render_target_view_count * sizeof(*render_target_views));
+    if (depth_stencil_view)
+        *depth_stencil_view = NULL;
+    if (unordered_access_views)
+        memset(unordered_access_views, 0, unordered_access_view_count * sizeof(*unordered_access_views));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetBlendState(ID3D11DeviceContext1 *iface,
+        ID3D11BlendState **blend_state, FLOAT blend_factor[4], UINT *sample_mask)
+{
+    FIXME("iface %p, blend_state %p, blend_factor %p, sample_mask %p stub!\n",
+            iface, blend_state, blend_factor, sample_mask);
+
+    if (blend_state)
+        *blend_state = NULL;
+    if (blend_factor)
+        memset(blend_factor, 0, 4 * sizeof(*blend_factor));
+    if (sample_mask)
+        *sample_mask = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_OMGetDepthStencilState(ID3D11DeviceContext1 *iface,
+        ID3D11DepthStencilState **depth_stencil_state, UINT *stencil_ref)
+{
+    FIXME("iface %p, depth_stencil_state %p, stencil_ref %p stub!\n", iface, depth_stencil_state, stencil_ref);
+
+    if (depth_stencil_state)
+        *depth_stencil_state = NULL;
+    if (stencil_ref)
+        *stencil_ref = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_SOGetTargets(ID3D11DeviceContext1 *iface,
+        UINT buffer_count, ID3D11Buffer **buffers)
+{
+    FIXME("iface %p, buffer_count %u, buffers %p stub!\n", iface, buffer_count, buffers);
+
+    if (buffers)
+        memset(buffers, 0, buffer_count * sizeof(*buffers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSGetState(ID3D11DeviceContext1 *iface,
+        ID3D11RasterizerState **rasterizer_state)
+{
+    FIXME("iface %p, rasterizer_state %p stub!\n", iface, rasterizer_state);
+
+    if (rasterizer_state)
+        *rasterizer_state = NULL;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSGetViewports(ID3D11DeviceContext1 *iface,
+        UINT *viewport_count, D3D11_VIEWPORT *viewports)
+{
+    FIXME("iface %p, viewport_count %p, viewports %p stub!\n", iface, viewport_count, viewports);
+
+    if (viewport_count)
+        *viewport_count = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_RSGetScissorRects(ID3D11DeviceContext1 *iface,
+        UINT *rect_count, D3D11_RECT *rects)
+{
+    FIXME("iface %p, rect_count %p, rects %p stub!\n", iface, rect_count, rects);
+
+    if (rect_count)
+        *rect_count = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    FIXME("iface %p, start_slot %u, view_count %u, views %p stub!\n", iface, start_slot, view_count, views);
+
+    if (views)
+        memset(views, 0, view_count * sizeof(*views));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11HullShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    FIXME("iface %p, shader %p, class_instances %p, class_instance_count %p stub!\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (shader)
+        *shader = NULL;
+    if (class_instance_count)
+        *class_instance_count = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    FIXME("iface %p, start_slot %u, sampler_count %u, samplers %p stub!\n", iface, start_slot, sampler_count, samplers);
+
+    if (samplers)
+        memset(samplers, 0, sampler_count * sizeof(*samplers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p stub!\n", iface, start_slot, buffer_count, buffers);
+
+    if (buffers)
+        memset(buffers, 0, buffer_count * sizeof(*buffers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    FIXME("iface %p, start_slot %u, view_count %u, views %p stub!\n", iface, start_slot, view_count, views);
+
+    if (views)
+        memset(views, 0, view_count * sizeof(*views));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11DomainShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    FIXME("iface %p, shader %p, class_instances %p, class_instance_count %p stub!\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (shader)
+        *shader = NULL;
+    if (class_instance_count)
+        *class_instance_count = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    FIXME("iface %p, start_slot %u, sampler_count %u, samplers %p stub!\n", iface, start_slot, sampler_count, samplers);
+
+    if (samplers)
+        memset(samplers, 0, sampler_count * sizeof(*samplers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p stub!\n", iface, start_slot, buffer_count, buffers);
+
+    if (buffers)
+        memset(buffers, 0, buffer_count * sizeof(*buffers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetShaderResources(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11ShaderResourceView **views)
+{
+    FIXME("iface %p, start_slot %u, view_count %u, views %p stub!\n", iface, start_slot, view_count, views);
+
+    if (views)
+        memset(views, 0, view_count * sizeof(*views));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetUnorderedAccessViews(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT view_count, ID3D11UnorderedAccessView **views)
+{
+    FIXME("iface %p, start_slot %u, view_count %u, views %p stub!\n", iface, start_slot, view_count, views);
+
+    if (views)
+        memset(views, 0, view_count * sizeof(*views));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetShader(ID3D11DeviceContext1 *iface,
+        ID3D11ComputeShader **shader, ID3D11ClassInstance **class_instances, UINT *class_instance_count)
+{
+    FIXME("iface %p, shader %p, class_instances %p, class_instance_count %p stub!\n",
+            iface, shader, class_instances, class_instance_count);
+
+    if (shader)
+        *shader = NULL;
+    if (class_instance_count)
+        *class_instance_count = 0;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetSamplers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT sampler_count, ID3D11SamplerState **samplers)
+{
+    FIXME("iface %p, start_slot %u, sampler_count %u, samplers %p stub!\n", iface, start_slot, sampler_count, samplers);
+
+    if (samplers)
+        memset(samplers, 0, sampler_count * sizeof(*samplers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetConstantBuffers(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p stub!\n", iface, start_slot, buffer_count, buffers);
+
+    if (buffers)
+        memset(buffers, 0, buffer_count * sizeof(*buffers));
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearState(ID3D11DeviceContext1 *iface)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct wined3d_deferred_context *wined3d_context = context->wined3d_context;
+    static const float blend_factor[] = {1.0f, 1.0f, 1.0f, 1.0f};
+    unsigned int i, j;
+
+    TRACE("iface %p.\n", iface);
+
+    for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
+    {
+        wined3d_deferred_context_set_shader(wined3d_context, i, NULL);
+        for (j = 0; j < D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT; ++j)
+            wined3d_deferred_context_set_sampler(wined3d_context, i, j, NULL);
+        for (j = 0; j < D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT; ++j)
+            wined3d_deferred_context_set_shader_resource_view(wined3d_context, i, j, NULL);
+        for (j = 0; j < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; ++j)
+            wined3d_deferred_context_set_constant_buffer(wined3d_context, i, j, NULL);
+    }
+    for (i = 0; i < D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT; ++i)
+    {
+        wined3d_deferred_context_set_stream_source(wined3d_context, i, NULL, 0, 0);
+    }
+    wined3d_deferred_context_set_index_buffer(wined3d_context, NULL, WINED3DFMT_UNKNOWN, 0);
+    wined3d_deferred_context_set_vertex_declaration(wined3d_context, NULL);
+    wined3d_deferred_context_set_primitive_type(wined3d_context, WINED3D_PT_UNDEFINED, 0);
+    for (i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+    {
+        wined3d_deferred_context_set_rendertarget_view(wined3d_context, i, NULL);
+    }
+    wined3d_deferred_context_set_depth_stencil_view(wined3d_context, NULL);
+    for (i = 0; i < D3D11_PS_CS_UAV_REGISTER_COUNT; ++i)
+    {
+        wined3d_deferred_context_set_unordered_access_view(wined3d_context, i, NULL, ~0u);
+        wined3d_deferred_context_set_cs_uav(wined3d_context, i, NULL, ~0u);
+    }
+    d3d11_deferred_context_OMSetDepthStencilState(iface, NULL, 0);
+    d3d11_deferred_context_OMSetBlendState(iface, NULL, blend_factor, D3D11_DEFAULT_SAMPLE_MASK);
+    d3d11_deferred_context_RSSetViewports(iface, 0, NULL);
+    d3d11_deferred_context_RSSetScissorRects(iface, 0, NULL);
+    d3d11_deferred_context_RSSetState(iface, NULL);
+    for (i = 0; i < D3D11_SO_BUFFER_SLOT_COUNT; ++i)
+    {
+        wined3d_deferred_context_set_stream_output(wined3d_context, i, NULL, 0);
+    }
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_Flush(ID3D11DeviceContext1 *iface)
+{
+    FIXME("iface %p stub!\n", iface);
+}
+
+static D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE d3d11_deferred_context_GetType(ID3D11DeviceContext1 *iface)
+{
+    TRACE("iface %p.\n", iface);
+
+    return D3D11_DEVICE_CONTEXT_DEFERRED;
+}
+
+static UINT STDMETHODCALLTYPE d3d11_deferred_context_GetContextFlags(ID3D11DeviceContext1 *iface)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+
+    TRACE("iface %p.\n", iface);
+
+    return context->flags;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_deferred_context_FinishCommandList(ID3D11DeviceContext1 *iface,
+        BOOL restore, ID3D11CommandList **command_list)
+{
+    struct d3d11_deferred_context *context = impl_from_deferred_ID3D11DeviceContext1(iface);
+    struct d3d11_command_list *object;
+    HRESULT hr;
+
+    TRACE("iface %p, restore %#x, command_list %p.\n", iface, restore, command_list);
+
+    if (!(object = heap_alloc_zero(sizeof(*object))))
+        return E_OUTOFMEMORY;
+
+    /* Dropping a failed command list releases its references through the
+     * immediate command stream. */
+    wined3d_mutex_lock();
+    hr = wined3d_deferred_context_record_command_list(context->wined3d_context,
+            restore, &object->wined3d_list);
+    wined3d_mutex_unlock();
+    if (FAILED(hr))
+    {
+        WARN("Failed to record command list, hr %#x.\n", hr);
+        heap_free(object);
+        return hr;
+    }
+
+    object->ID3D11CommandList_iface.lpVtbl = &d3d11_command_list_vtbl;
+    object->refcount = 1;
+    object->context_flags = context->flags;
+    wined3d_private_store_init(&object->private_store);
+    object->device = context->device;
+    ID3D11Device2_AddRef(object->device);
+
+    TRACE("Created command list %p.\n", object);
+    *command_list = &object->ID3D11CommandList_iface;
+
+    return S_OK;
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CopySubresourceRegion1(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *dst_resource, UINT dst_subresource_idx, UINT dst_x, UINT dst_y, UINT dst_z,
+        ID3D11Resource *src_resource, UINT src_subresource_idx, const D3D11_BOX *src_box, UINT flags)
+{
+    TRACE("iface %p, dst_resource %p, dst_subresource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
+            "src_resource %p, src_subresource_idx %u, src_box %p, flags %#x.\n",
+            iface, dst_resource, dst_subresource_idx, dst_x, dst_y, dst_z,
+            src_resource, src_subresource_idx, src_box, flags);
+
+    if (flags)
+        FIXME("Ignoring flags %#x.\n", flags);
+
+    d3d11_deferred_context_CopySubresourceRegion(iface, dst_resource, dst_subresource_idx,
+            dst_x, dst_y, dst_z, src_resource, src_subresource_idx, src_box);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_UpdateSubresource1(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource, UINT subresource_idx, const D3D11_BOX *box, const void *data,
+        UINT row_pitch, UINT depth_pitch, UINT flags)
+{
+    TRACE("iface %p, resource %p, subresource_idx %u, box %p, data %p, row_pitch %u, depth_pitch %u, flags %#x.\n",
+            iface, resource, subresource_idx, box, data, row_pitch, depth_pitch, flags);
+
+    if (flags)
+        FIXME("Ignoring flags %#x.\n", flags);
+
+    d3d11_deferred_context_UpdateSubresource(iface, resource, subresource_idx, box, data, row_pitch, depth_pitch);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DiscardResource(ID3D11DeviceContext1 *iface,
+        ID3D11Resource *resource)
+{
+    FIXME("iface %p, resource %p stub!\n", iface, resource);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DiscardView(ID3D11DeviceContext1 *iface, ID3D11View *view)
+{
+    FIXME("iface %p, view %p stub!\n", iface, view);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSSetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer * const *buffers, const UINT *first_constant,
+        const UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_VSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_HSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_GSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_PSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_CSGetConstantBuffers1(ID3D11DeviceContext1 *iface,
+        UINT start_slot, UINT buffer_count, ID3D11Buffer **buffers, UINT *first_constant, UINT *num_constants)
+{
+    FIXME("iface %p, start_slot %u, buffer_count %u, buffers %p, first_constant %p, num_constants %p stub!\n",
+            iface, start_slot, buffer_count, buffers, first_constant, num_constants);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_SwapDeviceContextState(ID3D11DeviceContext1 *iface,
+        ID3DDeviceContextState *state, ID3DDeviceContextState **prev_state)
+{
+    FIXME("iface %p, state %p, prev_state %p stub!\n", iface, state, prev_state);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_ClearView(ID3D11DeviceContext1 *iface, ID3D11View *view,
+        const FLOAT color[4], const D3D11_RECT *rect, UINT num_rects)
+{
+    FIXME("iface %p, view %p, color %p, rect %p, num_rects %u stub!\n", iface, view, color, rect, num_rects);
+}
+
+static void STDMETHODCALLTYPE d3d11_deferred_context_DiscardView1(ID3D11DeviceContext1 *iface, ID3D11View *view,
+        const D3D11_RECT *rects, UINT num_rects)
+{
+    FIXME("iface %p, view %p, rects %p, num_rects %u stub!\n", iface, view, rects, num_rects);
+}
+
+static const struct ID3D11DeviceContext1Vtbl d3d11_deferred_context_vtbl =
+{
+    /* IUnknown methods */
+    d3d11_deferred_context_QueryInterface,
+    d3d11_deferred_context_AddRef,
+    d3d11_deferred_context_Release,
+    /* ID3D11DeviceChild methods */
+    d3d11_deferred_context_GetDevice,
+    d3d11_deferred_context_GetPrivateData,
+    d3d11_deferred_context_SetPrivateData,
+    d3d11_deferred_context_SetPrivateDataInterface,
+    /* ID3D11DeviceContext methods */
+    d3d11_deferred_context_VSSetConstantBuffers,
+    d3d11_deferred_context_PSSetShaderResources,
+    d3d11_deferred_context_PSSetShader,
+    d3d11_deferred_context_PSSetSamplers,
+    d3d11_deferred_context_VSSetShader,
+    d3d11_deferred_context_DrawIndexed,
+    d3d11_deferred_context_Draw,
+    d3d11_deferred_context_Map,
+    d3d11_deferred_context_Unmap,
+    d3d11_deferred_context_PSSetConstantBuffers,
+    d3d11_deferred_context_IASetInputLayout,
+    d3d11_deferred_context_IASetVertexBuffers,
+    d3d11_deferred_context_IASetIndexBuffer,
+    d3d11_deferred_context_DrawIndexedInstanced,
+    d3d11_deferred_context_DrawInstanced,
+    d3d11_deferred_context_GSSetConstantBuffers,
+    d3d11_deferred_context_GSSetShader,
+    d3d11_deferred_context_IASetPrimitiveTopology,
+    d3d11_deferred_context_VSSetShaderResources,
+    d3d11_deferred_context_VSSetSamplers,
+    d3d11_deferred_context_Begin,
+    d3d11_deferred_context_End,
+    d3d11_deferred_context_GetData,
+    d3d11_deferred_context_SetPredication,
+    d3d11_deferred_context_GSSetShaderResources,
+    d3d11_deferred_context_GSSetSamplers,
+    d3d11_deferred_context_OMSetRenderTargets,
+    d3d11_deferred_context_OMSetRenderTargetsAndUnorderedAccessViews,
+    d3d11_deferred_context_OMSetBlendState,
+    d3d11_deferred_context_OMSetDepthStencilState,
+    d3d11_deferred_context_SOSetTargets,
+    d3d11_deferred_context_DrawAuto,
+    d3d11_deferred_context_DrawIndexedInstancedIndirect,
+    d3d11_deferred_context_DrawInstancedIndirect,
+    d3d11_deferred_context_Dispatch,
+    d3d11_deferred_context_DispatchIndirect,
+    d3d11_deferred_context_RSSetState,
+    d3d11_deferred_context_RSSetViewports,
+    d3d11_deferred_context_RSSetScissorRects,
+    d3d11_deferred_context_CopySubresourceRegion,
+    d3d11_deferred_context_CopyResource,
+    d3d11_deferred_context_UpdateSubresource,
+    d3d11_deferred_context_CopyStructureCount,
+    d3d11_deferred_context_ClearRenderTargetView,
+    d3d11_deferred_context_ClearUnorderedAccessViewUint,
+    d3d11_deferred_context_ClearUnorderedAccessViewFloat,
+    d3d11_deferred_context_ClearDepthStencilView,
+    d3d11_deferred_context_GenerateMips,
+    d3d11_deferred_context_SetResourceMinLOD,
+    d3d11_deferred_context_GetResourceMinLOD,
+    d3d11_deferred_context_ResolveSubresource,
+    d3d11_deferred_context_ExecuteCommandList,
+    d3d11_deferred_context_HSSetShaderResources,
+    d3d11_deferred_context_HSSetShader,
+    d3d11_deferred_context_HSSetSamplers,
+    d3d11_deferred_context_HSSetConstantBuffers,
+    d3d11_deferred_context_DSSetShaderResources,
+    d3d11_deferred_context_DSSetShader,
+    d3d11_deferred_context_DSSetSamplers,
+    d3d11_deferred_context_DSSetConstantBuffers,
+    d3d11_deferred_context_CSSetShaderResources,
+    d3d11_deferred_context_CSSetUnorderedAccessViews,
+    d3d11_deferred_context_CSSetShader,
+    d3d11_deferred_context_CSSetSamplers,
+    d3d11_deferred_context_CSSetConstantBuffers,
+    d3d11_deferred_context_VSGetConstantBuffers,
+    d3d11_deferred_context_PSGetShaderResources,
+    d3d11_deferred_context_PSGetShader,
+    d3d11_deferred_context_PSGetSamplers,
+    d3d11_deferred_context_VSGetShader,
+    d3d11_deferred_context_PSGetConstantBuffers,
+    d3d11_deferred_context_IAGetInputLayout,
+    d3d11_deferred_context_IAGetVertexBuffers,
+    d3d11_deferred_context_IAGetIndexBuffer,
+    d3d11_deferred_context_GSGetConstantBuffers,
+    d3d11_deferred_context_GSGetShader,
+    d3d11_deferred_context_IAGetPrimitiveTopology,
+    d3d11_deferred_context_VSGetShaderResources,
+    d3d11_deferred_context_VSGetSamplers,
+    d3d11_deferred_context_GetPredication,
+    d3d11_deferred_context_GSGetShaderResources,
+    d3d11_deferred_context_GSGetSamplers,
+    d3d11_deferred_context_OMGetRenderTargets,
+    d3d11_deferred_context_OMGetRenderTargetsAndUnorderedAccessViews,
+    d3d11_deferred_context_OMGetBlendState,
+    d3d11_deferred_context_OMGetDepthStencilState,
+    d3d11_deferred_context_SOGetTargets,
+    d3d11_deferred_context_RSGetState,
+    d3d11_deferred_context_RSGetViewports,
+    d3d11_deferred_context_RSGetScissorRects,
+    d3d11_deferred_context_HSGetShaderResources,
+    d3d11_deferred_context_HSGetShader,
+    d3d11_deferred_context_HSGetSamplers,
+    d3d11_deferred_context_HSGetConstantBuffers,
+    d3d11_deferred_context_DSGetShaderResources,
+    d3d11_deferred_context_DSGetShader,
+    d3d11_deferred_context_DSGetSamplers,
+    d3d11_deferred_context_DSGetConstantBuffers,
+    d3d11_deferred_context_CSGetShaderResources,
+    d3d11_deferred_context_CSGetUnorderedAccessViews,
+    d3d11_deferred_context_CSGetShader,
+    d3d11_deferred_context_CSGetSamplers,
+    d3d11_deferred_context_CSGetConstantBuffers,
+    d3d11_deferred_context_ClearState,
+    d3d11_deferred_context_Flush,
+    d3d11_deferred_context_GetType,
+    d3d11_deferred_context_GetContextFlags,
+    d3d11_deferred_context_FinishCommandList,
+    /* ID3D11DeviceContext1 methods */
+    d3d11_deferred_context_CopySubresourceRegion1,
+    d3d11_deferred_context_UpdateSubresource1,
+    d3d11_deferred_context_DiscardResource,
+    d3d11_deferred_context_DiscardView,
+    d3d11_deferred_context_VSSetConstantBuffers1,
+    d3d11_deferred_context_HSSetConstantBuffers1,
+    d3d11_deferred_context_DSSetConstantBuffers1,
+    d3d11_deferred_context_GSSetConstantBuffers1,
+    d3d11_deferred_context_PSSetConstantBuffers1,
+    d3d11_deferred_context_CSSetConstantBuffers1,
+    d3d11_deferred_context_VSGetConstantBuffers1,
+    d3d11_deferred_context_HSGetConstantBuffers1,
+    d3d11_deferred_context_DSGetConstantBuffers1,
+    d3d11_deferred_context_GSGetConstantBuffers1,
+    d3d11_deferred_context_PSGetConstantBuffers1,
+    d3d11_deferred_context_CSGetConstantBuffers1,
+    d3d11_deferred_context_SwapDeviceContextState,
+    d3d11_deferred_context_ClearView,
+    d3d11_deferred_context_DiscardView1,
+};
+
+static HRESULT d3d11_deferred_context_create(struct d3d_device *device, UINT flags,
+        struct d3d11_deferred_context **context)
+{
+    struct d3d11_deferred_context *object;
+    HRESULT hr;
+
+    if (flags)
+        FIXME("Ignoring flags %#x.\n", flags);
+
+    if (!(object = heap_alloc_zero(sizeof(*object))))
+        return E_OUTOFMEMORY;
+
+    wined3d_mutex_lock();
+    hr = wined3d_deferred_context_create(device->wined3d_device, &object->wined3d_context);
+    wined3d_mutex_unlock();
+    if (FAILED(hr))
+    {
+        WARN("Failed to create wined3d deferred context, hr %#x.\n", hr);
+        heap_free(object);
+        return hr;
+    }
+
+    object->ID3D11DeviceContext1_iface.lpVtbl = &d3d11_deferred_context_vtbl;
+    object->refcount = 1;
+    object->flags = flags;
+    list_init(&object->mappings);
+    wined3d_private_store_init(&object->private_store);
+    object->device = &device->ID3D11Device2_iface;
+    ID3D11Device2_AddRef(object->device);
+
+    TRACE("Created deferred context %p.\n", object);
+    *context = object;
+
+    return S_OK;
+}
+
+/* ID3D11Device methods */
+
+static HRESULT STDMETHODCALLTYPE d3d11_device_QueryInterface(ID3D11Device2 *iface, REFIID riid, void **out)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    return IUnknown_QueryInterface(device->outer_unk, riid, out);
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_device_AddRef(ID3D11Device2 *iface)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    return IUnknown_AddRef(device->outer_unk);
+}
+
+static ULONG STDMETHODCALLTYPE d3d11_device_Release(ID3D11Device2 *iface)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    return IUnknown_Release(device->outer_unk);
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_device_CreateBuffer(ID3D11Device2 *iface, const D3D11_BUFFER_DESC *desc,
+        const D3D11_SUBRESOURCE_DATA *data, ID3D11Buffer **buffer)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d_buffer *object;
+    HRESULT hr;
+
+    TRACE("iface %p, desc %p, data %p, buffer %p.\n", iface, desc, data, buffer);
+
+    if (FAILED(hr = d3d_buffer_create(device, desc, data, &object)))
+        return hr;
+
+    *buffer = &object->ID3D11Buffer_iface;
+
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_device_CreateTexture1D(ID3D11Device2 *iface,
+        const D3D11_TEXTURE1D_DESC *desc, const D3D11_SUBRESOURCE_DATA *data, ID3D11Texture1D **texture)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d_texture1d *object;
+    HRESULT hr;
+
+    TRACE("iface %p, desc %p, data %p, texture %p.\n", iface, desc, data, texture);
+
+    if (FAILED(hr = d3d_texture1d_create(device, desc, data, &object)))
+        return hr;
+
+    *texture = &object->ID3D11Texture1D_iface;
+
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_device_CreateTexture2D(ID3D11Device2 *iface,
+        const D3D11_TEXTURE2D_DESC *desc, const D3D11_SUBRESOURCE_DATA *data, ID3D11Texture2D **texture)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d_texture2d *object;
+    HRESULT hr;
+
+    TRACE("iface %p, desc %p, data %p, texture %p.\n", iface, desc, data, texture);
+
+    if (FAILED(hr = d3d_texture2d_create(device, desc, data, &object)))
+        return hr;
+
+    *texture = &object->ID3D11Texture2D_iface;
+
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_device_CreateTexture3D(ID3D11Device2 *iface,
+        const D3D11_TEXTURE3D_DESC *desc, const D3D11_SUBRESOURCE_DATA *data, ID3D11Texture3D **texture)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d_texture3d *object;
+    HRESULT hr;
+
+    TRACE("iface %p, desc %p, data %p, texture %p.\n", iface, desc, data, texture);
+
+    if (FAILED(hr = d3d_texture3d_create(device, desc, data, &object)))
+        return hr;
+
+    *texture = &object->ID3D11Texture3D_iface;
+
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_device_CreateShaderResourceView(ID3D11Device2 *iface,
+        ID3D11Resource *resource, const D3D11_SHADER_RESOURCE_VIEW_DESC *desc, ID3D11ShaderResourceView **view)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d_shader_resource_view *object;
+    HRESULT hr;
+
+    TRACE("iface %p, resource %p, desc %p, view %p.\n", iface, resource, desc, view);
+
+    if (!resource)
+        return E_INVALIDARG;
+
+    if (FAILED(hr = d3d_shader_resource_view_create(device, resource, desc, &object)))
+        return hr;
+
+    *view = &object->ID3D11ShaderResourceView_iface;
+
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_device_CreateUnorderedAccessView(ID3D11Device2 *iface,
+        ID3D11Resource *resource, const D3D11_UNORDERED_ACCESS_VIEW_DESC *desc, ID3D11UnorderedAccessView **view)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d11_unordered_access_view *object;
+    HRESULT hr;
+
+    TRACE("iface %p, resource %p, desc %p, view %p.\n", iface, resource, desc, view);
+
+    if (FAILED(hr = d3d11_unordered_access_view_create(device, resource, desc, &object)))
+        return hr;
+
+    *view = &object->ID3D11UnorderedAccessView_iface;
+
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_device_CreateRenderTargetView(ID3D11Device2 *iface,
+        ID3D11Resource *resource, const D3D11_RENDER_TARGET_VIEW_DESC *desc, ID3D11RenderTargetView **view)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d_rendertarget_view *object;
+    HRESULT hr;
+
+    TRACE("iface %p, resource %p, desc %p, view %p.\n", iface, resource, desc, view);
+
+    if (!resource)
+        return E_INVALIDARG;
+
+    if (FAILED(hr = d3d_rendertarget_view_create(device, resource, desc, &object)))
+        return hr;
+
+    *view = &object->ID3D11RenderTargetView_iface;
+
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDepthStencilView(ID3D11Device2 *iface,
+        ID3D11Resource *resource, const D3D11_DEPTH_STENCIL_VIEW_DESC *desc, ID3D11DepthStencilView **view)
+{
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d_depthstencil_view *object;
+    HRESULT hr;
+
+    TRACE("iface %p, resource %p, desc %p, view %p.\n", iface, resource, desc, view);
+
+    if (FAILED(hr = d3d_depthstencil_view_create(device, resource, desc, &object)))
+        return hr;
 
     *view = &object->ID3D11DepthStencilView_iface;
 
@@ -3272,9 +5392,18 @@ static HRESULT STDMETHODCALLTYPE d3d11_device_CreateCounter(ID3D11Device2 *iface
 static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDeferredContext(ID3D11Device2 *iface, UINT flags,
         ID3D11DeviceContext **context)
 {
-    FIXME("iface %p, flags %#x, context %p stub!\n", iface, flags, context);
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d11_deferred_context *object;
+    HRESULT hr;
 
-    return E_NOTIMPL;
+    TRACE("iface %p, flags %#x, context %p.\n", iface, flags, context);
+
+    if (FAILED(hr = d3d11_deferred_context_create(device, flags, &object)))
+        return hr;
+
+    *context = (ID3D11DeviceContext *)&object->ID3D11DeviceContext1_iface;
+
+    return S_OK;
 }
 
 static HRESULT STDMETHODCALLTYPE d3d11_device_OpenSharedResource(ID3D11Device2 *iface, HANDLE resource, REFIID riid,
@@ -3656,9 +5785,18 @@ static void STDMETHODCALLTYPE d3d11_device_GetImmediateContext1(ID3D11Device2 *i
 static HRESULT STDMETHODCALLTYPE d3d11_device_CreateDeferredContext1(ID3D11Device2 *iface, UINT flags,
         ID3D11DeviceContext1 **context)
 {
-    FIXME("iface %p, flags %#x, context %p stub!\n", iface, flags, context);
+    struct d3d_device *device = impl_from_ID3D11Device2(iface);
+    struct d3d11_deferred_context *object;
+    HRESULT hr;
 
-    return E_NOTIMPL;
+    TRACE("iface %p, flags %#x, context %p.\n", iface, flags, context);
+
+    if (FAILED(hr = d3d11_deferred_context_create(device, flags, &object)))
+        return hr;
+
+    *context = &object->ID3D11DeviceContext1_iface;
+
+    return S_OK;
 }
 
 static HRESULT STDMETHODCALLTYPE d3d11_device_CreateBlendState1(ID3D11Device2 *iface,
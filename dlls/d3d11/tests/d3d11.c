@@ -29148,6 +29148,147 @@ static void test_standard_pattern(void)
     release_test_context(&test_context);
 }
 
+static void test_deferred_context(void)
+{
+    static const struct vec4 green_quad = {0.0f, 1.0f, 0.0f, 1.0f};
+    static const struct vec4 blue_quad = {0.0f, 0.0f, 1.0f, 1.0f};
+    static const float green[] = {0.0f, 1.0f, 0.0f, 1.0f};
+    static const float red[] = {1.0f, 0.0f, 0.0f, 1.0f};
+    static const DWORD buffer_data[] = {0x01010101, 0x02020202, 0x03030303, 0x04040404};
+    ID3D11DeviceContext *immediate, *deferred;
+    struct d3d11_test_context test_context;
+    ID3D11RenderTargetView *rtv, *texture_rtv;
+    D3D11_TEXTURE2D_DESC texture_desc;
+    ID3D11Texture2D *texture;
+    ID3D11CommandList *list, *nested_list;
+    struct resource_readback rb;
+    ID3D11Buffer *buffer;
+    ID3D11Device *device;
+    unsigned int i;
+    HRESULT hr;
+
+    if (!init_test_context(&test_context, NULL))
+        return;
+    device = test_context.device;
+    immediate = test_context.immediate_context;
+
+    hr = ID3D11Device_CreateDeferredContext(device, 0, &deferred);
+    if (hr == E_NOTIMPL || hr == DXGI_ERROR_INVALID_CALL)
+    {
+        skip("Deferred contexts are not supported.\n");
+        release_test_context(&test_context);
+        return;
+    }
+    ok(hr == S_OK, "Failed to create deferred context, hr %#x.\n", hr);
+    ok(ID3D11DeviceContext_GetType(deferred) == D3D11_DEVICE_CONTEXT_DEFERRED,
+            "Got unexpected context type %#x.\n", ID3D11DeviceContext_GetType(deferred));
+
+    buffer = create_buffer(device, 0, sizeof(buffer_data), NULL);
+
+    ID3D11Texture2D_GetDesc(test_context.backbuffer, &texture_desc);
+    texture_desc.Usage = D3D11_USAGE_DEFAULT;
+    texture_desc.BindFlags = D3D11_BIND_RENDER_TARGET;
+    texture_desc.CPUAccessFlags = 0;
+    texture_desc.MiscFlags = 0;
+    hr = ID3D11Device_CreateTexture2D(device, &texture_desc, NULL, &texture);
+    ok(hr == S_OK, "Failed to create texture, hr %#x.\n", hr);
+    hr = ID3D11Device_CreateRenderTargetView(device, (ID3D11Resource *)texture, NULL, &texture_rtv);
+    ok(hr == S_OK, "Failed to create render target view, hr %#x.\n", hr);
+
+    ID3D11DeviceContext_ClearRenderTargetView(deferred, test_context.backbuffer_rtv, green);
+    ID3D11DeviceContext_UpdateSubresource(deferred, (ID3D11Resource *)buffer, 0, NULL, buffer_data, 0, 0);
+    ID3D11DeviceContext_OMSetRenderTargets(deferred, 1, &test_context.backbuffer_rtv, NULL);
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, FALSE, &list);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+
+    /* Nothing is executed while recording. */
+    ID3D11DeviceContext_ClearRenderTargetView(immediate, test_context.backbuffer_rtv, red);
+    check_texture_color(test_context.backbuffer, 0xff0000ff, 1);
+
+    ID3D11DeviceContext_ClearRenderTargetView(immediate, texture_rtv, red);
+    ID3D11DeviceContext_OMSetRenderTargets(immediate, 1, &texture_rtv, NULL);
+    ID3D11DeviceContext_ExecuteCommandList(immediate, list, TRUE);
+    check_texture_color(test_context.backbuffer, 0xff00ff00, 1);
+    get_buffer_readback(buffer, &rb);
+    for (i = 0; i < ARRAY_SIZE(buffer_data); ++i)
+    {
+        DWORD data = get_readback_color(&rb, i, 0, 0);
+        ok(data == buffer_data[i], "Got unexpected data 0x%08x at %u.\n", data, i);
+    }
+    release_resource_readback(&rb);
+
+    /* The immediate context state is restored, and used for rendering. */
+    ID3D11DeviceContext_OMGetRenderTargets(immediate, 1, &rtv, NULL);
+    ok(rtv == texture_rtv, "Got unexpected render target view %p.\n", rtv);
+    if (rtv)
+        ID3D11RenderTargetView_Release(rtv);
+    draw_color_quad(&test_context, &blue_quad);
+    check_texture_color(texture, 0xffff0000, 1);
+    check_texture_color(test_context.backbuffer, 0xff00ff00, 1);
+
+    /* Command lists can be executed more than once. */
+    ID3D11DeviceContext_ClearRenderTargetView(immediate, test_context.backbuffer_rtv, red);
+    ID3D11DeviceContext_ExecuteCommandList(immediate, list, FALSE);
+    check_texture_color(test_context.backbuffer, 0xff00ff00, 1);
+
+    /* Without restore_state, the immediate context state is cleared. */
+    ID3D11DeviceContext_OMGetRenderTargets(immediate, 1, &rtv, NULL);
+    ok(!rtv, "Got unexpected render target view %p.\n", rtv);
+    ID3D11CommandList_Release(list);
+
+    /* The deferred context state is reset by FinishCommandList(). */
+    ID3D11DeviceContext_ClearRenderTargetView(immediate, test_context.backbuffer_rtv, red);
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, FALSE, &list);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+    ID3D11DeviceContext_ExecuteCommandList(immediate, list, FALSE);
+    check_texture_color(test_context.backbuffer, 0xff0000ff, 1);
+    ID3D11CommandList_Release(list);
+
+    /* With restore set, the deferred context state is kept for the next
+     * command list. The test context helpers draw through the deferred
+     * context here. */
+    ID3D11DeviceContext_OMSetRenderTargets(deferred, 1, &test_context.backbuffer_rtv, NULL);
+    set_viewport(deferred, 0.0f, 0.0f, 640.0f, 480.0f, 0.0f, 1.0f);
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, TRUE, &list);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+    ID3D11CommandList_Release(list);
+
+    test_context.immediate_context = deferred;
+    draw_color_quad(&test_context, &green_quad);
+    test_context.immediate_context = immediate;
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, FALSE, &list);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+
+    ID3D11DeviceContext_OMSetRenderTargets(immediate, 0, NULL, NULL);
+    ID3D11DeviceContext_ClearRenderTargetView(immediate, test_context.backbuffer_rtv, red);
+    ID3D11DeviceContext_ExecuteCommandList(immediate, list, FALSE);
+    check_texture_color(test_context.backbuffer, 0xff00ff00, 1);
+    ID3D11CommandList_Release(list);
+
+    /* Command lists can be executed from deferred contexts. */
+    ID3D11DeviceContext_ClearRenderTargetView(deferred, texture_rtv, green);
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, FALSE, &nested_list);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+    ID3D11DeviceContext_ClearRenderTargetView(deferred, test_context.backbuffer_rtv, green);
+    ID3D11DeviceContext_ExecuteCommandList(deferred, nested_list, FALSE);
+    hr = ID3D11DeviceContext_FinishCommandList(deferred, FALSE, &list);
+    ok(hr == S_OK, "Failed to finish command list, hr %#x.\n", hr);
+    ID3D11CommandList_Release(nested_list);
+
+    ID3D11DeviceContext_ClearRenderTargetView(immediate, test_context.backbuffer_rtv, red);
+    ID3D11DeviceContext_ClearRenderTargetView(immediate, texture_rtv, red);
+    ID3D11DeviceContext_ExecuteCommandList(immediate, list, FALSE);
+    check_texture_color(test_context.backbuffer, 0xff00ff00, 1);
+    check_texture_color(texture, 0xff00ff00, 1);
+    ID3D11CommandList_Release(list);
+
+    ID3D11RenderTargetView_Release(texture_rtv);
+    ID3D11Texture2D_Release(texture);
+    ID3D11Buffer_Release(buffer);
+    ID3D11DeviceContext_Release(deferred);
+    release_test_context(&test_context);
+}
+
 START_TEST(d3d11)
 {
     unsigned int argc, i;
@@ -29303,6 +29444,7 @@ START_TEST(d3d11)
     queue_test(test_staging_buffers);
     queue_test(test_render_a8);
     queue_test(test_standard_pattern);
+    queue_test(test_deferred_context);
 
     run_queued_tests();
 }
@@ -24211,6 +24211,97 @@ done:
     DestroyWindow(window);
 }
 
+static void test_dynamic_buffer_streaming(void)
+{
+    unsigned int i, j, quad_count, offset;
+    IDirect3DVertexBuffer9 *buffer;
+    IDirect3DDevice9 *device;
+    IDirect3D9 *d3d;
+    D3DCOLOR colour;
+    ULONG refcount;
+    HWND window;
+    HRESULT hr;
+
+    struct quad
+    {
+        struct
+        {
+            struct vec3 position;
+            DWORD diffuse;
+        } strip[4];
+    }
+    *quads;
+
+    static const DWORD colours[] =
+    {
+        0xffff0000, 0xff00ff00, 0xff0000ff, 0xffffff00, 0xffff00ff, 0xff00ffff, 0xffffffff,
+    };
+
+    window = create_window();
+    ok(!!window, "Failed to create a window.\n");
+
+    d3d = Direct3DCreate9(D3D_SDK_VERSION);
+    ok(!!d3d, "Failed to create a D3D object.\n");
+    if (!(device = create_device(d3d, window, window, TRUE)))
+    {
+        skip("Failed to create a D3D device, skipping tests.\n");
+        IDirect3D9_Release(d3d);
+        DestroyWindow(window);
+        return;
+    }
+
+    quad_count = 4;
+    hr = IDirect3DDevice9_CreateVertexBuffer(device, quad_count * sizeof(*quads),
+            D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY, 0, D3DPOOL_DEFAULT, &buffer, NULL);
+    ok(SUCCEEDED(hr), "Failed to create vertex buffer, hr %#x.\n", hr);
+
+    hr = IDirect3DDevice9_SetRenderState(device, D3DRS_LIGHTING, FALSE);
+    ok(SUCCEEDED(hr), "Failed to set render state, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetFVF(device, D3DFVF_XYZ | D3DFVF_DIFFUSE);
+    ok(SUCCEEDED(hr), "Failed to set FVF, hr %#x.\n", hr);
+    hr = IDirect3DDevice9_SetStreamSource(device, 0, buffer, 0, sizeof(*quads->strip));
+    ok(SUCCEEDED(hr), "Failed to set stream source, hr %#x.\n", hr);
+
+    /* Stream full screen quads the way applications usually do: append with
+     * NOOVERWRITE, and DISCARD once the buffer is full. Every draw has to see
+     * the data written for it, and none of the data written after it. */
+    for (i = 0; i < 4 * quad_count; ++i)
+    {
+        offset = i % quad_count;
+        hr = IDirect3DVertexBuffer9_Lock(buffer, offset * sizeof(*quads), sizeof(*quads),
+                (void **)&quads, offset ? D3DLOCK_NOOVERWRITE : D3DLOCK_DISCARD);
+        ok(SUCCEEDED(hr), "Failed to lock vertex buffer, hr %#x.\n", hr);
+        quads->strip[0].position.x = -1.0f; quads->strip[0].position.y = -1.0f;
+        quads->strip[1].position.x = -1.0f; quads->strip[1].position.y =  1.0f;
+        quads->strip[2].position.x =  1.0f; quads->strip[2].position.y = -1.0f;
+        quads->strip[3].position.x =  1.0f; quads->strip[3].position.y =  1.0f;
+        for (j = 0; j < ARRAY_SIZE(quads->strip); ++j)
+        {
+            quads->strip[j].position.z = 0.0f;
+            quads->strip[j].diffuse = colours[i % ARRAY_SIZE(colours)];
+        }
+        hr = IDirect3DVertexBuffer9_Unlock(buffer);
+        ok(SUCCEEDED(hr), "Failed to unlock vertex buffer, hr %#x.\n", hr);
+
+        hr = IDirect3DDevice9_BeginScene(device);
+        ok(SUCCEEDED(hr), "Failed to begin scene, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_DrawPrimitive(device, D3DPT_TRIANGLESTRIP, offset * ARRAY_SIZE(quads->strip), 2);
+        ok(SUCCEEDED(hr), "Failed to draw, hr %#x.\n", hr);
+        hr = IDirect3DDevice9_EndScene(device);
+        ok(SUCCEEDED(hr), "Failed to end scene, hr %#x.\n", hr);
+
+        colour = getPixelColor(device, 320, 240);
+        ok(color_match(colour, colours[i % ARRAY_SIZE(colours)], 1),
+                "Draw %u: got unexpected colour 0x%08x.\n", i, colour);
+    }
+
+    IDirect3DVertexBuffer9_Release(buffer);
+    refcount = IDirect3DDevice9_Release(device);
+    ok(!refcount, "Device has %u references left.\n", refcount);
+    IDirect3D9_Release(d3d);
+    DestroyWindow(window);
+}
+
 static void test_color_vertex(void)
 {
     IDirect3DDevice9 *device;
@@ -24671,6 +24762,7 @@ START_TEST(visual)
     test_mvp_software_vertex_shaders();
     test_null_format();
     test_map_synchronisation();
+    test_dynamic_buffer_streaming();
     test_color_vertex();
     test_sysmem_draw();
 }
@@ -229,6 +229,24 @@ struct rop_codes
     DWORD a1, a2, x1, x2;
 };
 
+/* vectorized row helpers, they return the number of pixels they handled */
+struct simd_funcs
+{
+    const char *name;
+    int                      (* rop_32)(DWORD *ptr, int len, DWORD and, DWORD xor);
+    int                      (* rop_16)(WORD *ptr, int len, WORD and, WORD xor);
+    int                (* rop_codes_32)(DWORD *dst, const DWORD *src, int len, const struct rop_codes *codes);
+    int                (* rop_codes_16)(WORD *dst, const WORD *src, int len, const struct rop_codes *codes);
+    int                  (* blend_argb)(DWORD *dst, const DWORD *src, int len, DWORD alpha);
+    int            (* blend_argb_alpha)(DWORD *dst, const DWORD *src, int len, DWORD alpha);
+    int   (* blend_argb_constant_alpha)(DWORD *dst, const DWORD *src, int len, DWORD alpha);
+    int     (* blend_argb_no_src_alpha)(DWORD *dst, const DWORD *src, int len, DWORD alpha);
+    int                  (* glyph_8888)(DWORD *dst, const BYTE *glyph, int len, DWORD text_pixel);
+    int         (* convert_555_to_8888)(DWORD *dst, const WORD *src, int len);
+};
+
+extern const struct simd_funcs *simd_funcs DECLSPEC_HIDDEN;
+
 #define OVERLAP_LEFT  0x01  /* dest starts left of source */
 #define OVERLAP_RIGHT 0x02  /* dest starts right of source */
 #define OVERLAP_ABOVE 0x04  /* dest starts above source */
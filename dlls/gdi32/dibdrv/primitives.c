@@ -174,7 +174,10 @@ static inline void do_rop_codes_mask_8(BYTE *dst, BYTE src, struct rop_codes *co
 
 static inline void do_rop_codes_line_16(WORD *dst, const WORD *src, struct rop_codes *codes, int len)
 {
-    for (; len > 0; len--, src++, dst++) do_rop_codes_16( dst, *src, codes );
+    int done = simd_funcs->rop_codes_16( dst, src, len, codes );
+
+    for (src += done, dst += done, len -= done; len > 0; len--, src++, dst++)
+        do_rop_codes_16( dst, *src, codes );
 }
 
 static inline void do_rop_codes_line_rev_16(WORD *dst, const WORD *src, struct rop_codes *codes, int len)
@@ -276,8 +279,11 @@ static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD a
         start = get_pixel_ptr_32(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
+            {
+                x = rc->left + simd_funcs->rop_32( start, rc->right - rc->left, and, xor );
+                for(ptr = start + x - rc->left; x < rc->right; x++)
                     do_rop_32(ptr++, and, xor);
+            }
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
                 memset_32( start, xor, rc->right - rc->left );
@@ -427,8 +433,11 @@ static void solid_rects_16(const dib_info *dib, int num, const RECT *rc, DWORD a
         start = get_pixel_ptr_16(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 2)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
+            {
+                x = rc->left + simd_funcs->rop_16( start, rc->right - rc->left, and, xor );
+                for(ptr = start + x - rc->left; x < rc->right; x++)
                     do_rop_16(ptr++, and, xor);
+            }
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 2)
                 memset_16( start, xor, rc->right - rc->left );
@@ -1334,25 +1343,6 @@ static void pattern_rects_null(const dib_info *dib, int num, const RECT *rc, con
     return;
 }
 
-static inline void copy_rect_bits_32( DWORD *dst_start, const DWORD *src_start, const SIZE *size,
-                                      int dst_stride, int src_stride, int rop2 )
-{
-    const DWORD *src;
-    DWORD *dst;
-    int x, y;
-
-#define LOOP( op )                                                                     \
-    for (y = 0; y < size->cy; y++, dst_start += dst_stride, src_start += src_stride)   \
-        for (x = 0, src = src_start, dst = dst_start; x < size->cx; x++, src++, dst++) \
-            op;
-
-    switch (rop2)
-    {
-        ROPS_WITHOUT_COPY( dst[0], src[0] )
-    }
-#undef LOOP
-}
-
 static inline void copy_rect_bits_rev_32( DWORD *dst_start, const DWORD *src_start, const SIZE *size,
                                           int dst_stride, int src_stride, int rop2 )
 {
@@ -1379,7 +1369,8 @@ static void copy_rect_32(const dib_info *dst, const RECT *rc,
                          const dib_info *src, const POINT *origin, int rop2, int overlap)
 {
     DWORD *dst_start, *src_start;
-    int y, dst_stride, src_stride;
+    int x, y, dst_stride, src_stride;
+    struct rop_codes codes;
     SIZE size;
 
     if (overlap & OVERLAP_BELOW)
@@ -1408,9 +1399,17 @@ static void copy_rect_32(const dib_info *dst, const RECT *rc,
     size.cy = rc->bottom - rc->top;
 
     if (overlap & OVERLAP_RIGHT)
+    {
         copy_rect_bits_rev_32( dst_start, src_start, &size, dst_stride, src_stride, rop2 );
-    else
-        copy_rect_bits_32( dst_start, src_start, &size, dst_stride, src_stride, rop2 );
+        return;
+    }
+
+    get_rop_codes( rop2, &codes );
+    for (y = 0; y < size.cy; y++, dst_start += dst_stride, src_start += src_stride)
+    {
+        x = simd_funcs->rop_codes_32( dst_start, src_start, size.cx, &codes );
+        for (; x < size.cx; x++) do_rop_codes_32( dst_start + x, src_start[x], &codes );
+    }
 }
 
 static void copy_rect_24(const dib_info *dst, const RECT *rc,
@@ -2310,9 +2309,10 @@ static void convert_to_8888(dib_info *dst, const dib_info *src, const RECT *src_
         {
             for(y = src_rect->top; y < src_rect->bottom; y++)
             {
-                dst_pixel = dst_start;
-                src_pixel = src_start;
-                for(x = src_rect->left; x < src_rect->right; x++)
+                x = simd_funcs->convert_555_to_8888( dst_start, src_start, src_rect->right - src_rect->left );
+                dst_pixel = dst_start + x;
+                src_pixel = src_start + x;
+                for(x += src_rect->left; x < src_rect->right; x++)
                 {
                     src_val = *src_pixel++;
                     *dst_pixel++ = ((src_val << 9) & 0xf80000) | ((src_val << 4) & 0x070000) |
@@ -4656,27 +4656,31 @@ static void blend_rect_8888(const dib_info *dst, const RECT *rc,
 {
     DWORD *src_ptr = get_pixel_ptr_32( src, origin->x, origin->y );
     DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
-    int x, y;
+    int x, y, end, width = rc->right - rc->left;
+
+    /* the vectorized helpers may stop early, finish at least a few pixels before retrying */
+#define LOOP( simd, op ) \
+    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4) \
+        for (x = 0; x < width; ) \
+            for (x += simd( dst_ptr + x, src_ptr + x, width - x, blend.SourceConstantAlpha ), \
+                 end = min( x + 16, width ); x < end; x++) \
+                dst_ptr[x] = op;
 
     if (blend.AlphaFormat & AC_SRC_ALPHA)
     {
 	if (blend.SourceConstantAlpha == 255)
-	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-		for (x = 0; x < rc->right - rc->left; x++)
-		    dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
+            LOOP( simd_funcs->blend_argb, blend_argb( dst_ptr[x], src_ptr[x] ))
         else
-	    for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-		for (x = 0; x < rc->right - rc->left; x++)
-		    dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+            LOOP( simd_funcs->blend_argb_alpha,
+                  blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha ))
     }
     else if (src->compression == BI_RGB)
-	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-	    for (x = 0; x < rc->right - rc->left; x++)
-		dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+        LOOP( simd_funcs->blend_argb_constant_alpha,
+              blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha ))
     else
-	for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-	    for (x = 0; x < rc->right - rc->left; x++)
-		dst_ptr[x] = blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+        LOOP( simd_funcs->blend_argb_no_src_alpha,
+              blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha ))
+#undef LOOP
 }
 
 static void blend_rect_32(const dib_info *dst, const RECT *rc,
@@ -6071,15 +6075,20 @@ static void draw_glyph_8888( const dib_info *dib, const RECT *rect, const dib_in
 {
     DWORD *dst_ptr = get_pixel_ptr_32( dib, rect->left, rect->top );
     const BYTE *glyph_ptr = get_pixel_ptr_8( glyph, origin->x, origin->y );
-    int x, y;
+    int x, y, end, width = rect->right - rect->left;
 
     for (y = rect->top; y < rect->bottom; y++)
     {
-        for (x = 0; x < rect->right - rect->left; x++)
+        for (x = 0; x < width; )
         {
-            if (glyph_ptr[x] <= 1) continue;
-            if (glyph_ptr[x] >= 16) { dst_ptr[x] = text_pixel; continue; }
-            dst_ptr[x] = aa_rgb( dst_ptr[x] >> 16, dst_ptr[x] >> 8, dst_ptr[x], text_pixel, ranges + glyph_ptr[x] );
+            /* skip and fill the runs outside of the glyph edges */
+            x += simd_funcs->glyph_8888( dst_ptr + x, glyph_ptr + x, width - x, text_pixel );
+            for (end = min( x + 16, width ); x < end; x++)
+            {
+                if (glyph_ptr[x] <= 1) continue;
+                if (glyph_ptr[x] >= 16) { dst_ptr[x] = text_pixel; continue; }
+                dst_ptr[x] = aa_rgb( dst_ptr[x] >> 16, dst_ptr[x] >> 8, dst_ptr[x], text_pixel, ranges + glyph_ptr[x] );
+            }
         }
         dst_ptr += dib->stride / 4;
         glyph_ptr += glyph->stride;
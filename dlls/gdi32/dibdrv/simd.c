@@ -0,0 +1,572 @@
+/*
+ * DIB driver vectorized row helpers.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "config.h"
+
+#include "gdi_private.h"
+#include "dibdrv.h"
+
+#include "wine/debug.h"
+
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || defined(__clang__))
+#include <immintrin.h>
+#define HAVE_X86_SIMD
+#endif
+
+WINE_DEFAULT_DEBUG_CHANNEL(dib);
+
+/* The helpers below process the start of a row and return the number of
+ * pixels they handled. They stop early when they reach a group of pixels
+ * they can't handle exactly, so callers always finish the row with the
+ * generic code, which keeps the output bit-identical. */
+
+static int rop_32_none( DWORD *ptr, int len, DWORD and, DWORD xor )
+{
+    return 0;
+}
+
+static int rop_16_none( WORD *ptr, int len, WORD and, WORD xor )
+{
+    return 0;
+}
+
+static int rop_codes_32_none( DWORD *dst, const DWORD *src, int len, const struct rop_codes *codes )
+{
+    return 0;
+}
+
+static int rop_codes_16_none( WORD *dst, const WORD *src, int len, const struct rop_codes *codes )
+{
+    return 0;
+}
+
+static int blend_argb_none( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    return 0;
+}
+
+static int glyph_8888_none( DWORD *dst, const BYTE *glyph, int len, DWORD text_pixel )
+{
+    return 0;
+}
+
+static int convert_555_to_8888_none( DWORD *dst, const WORD *src, int len )
+{
+    return 0;
+}
+
+static const struct simd_funcs simd_none =
+{
+    "none",
+    rop_32_none,
+    rop_16_none,
+    rop_codes_32_none,
+    rop_codes_16_none,
+    blend_argb_none,
+    blend_argb_none,
+    blend_argb_none,
+    blend_argb_none,
+    glyph_8888_none,
+    convert_555_to_8888_none
+};
+
+const struct simd_funcs *simd_funcs = &simd_none;
+
+#ifdef HAVE_X86_SIMD
+
+#ifdef __i386__
+/* the Win32 ABI only guarantees 4-byte stack alignment */
+#define SSE2_FUNC __attribute__((target("sse2"), force_align_arg_pointer))
+#define AVX2_FUNC __attribute__((target("avx2"), force_align_arg_pointer))
+#else
+#define SSE2_FUNC __attribute__((target("sse2")))
+#define AVX2_FUNC __attribute__((target("avx2")))
+#endif
+
+/* SSE2 */
+
+static inline SSE2_FUNC __m128i div255_sse2( __m128i v )
+{
+    /* exact (v + 127) / 255 for v <= 255 * 255 */
+    v = _mm_add_epi16( v, _mm_set1_epi16( 127 ));
+    return _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( v, _mm_set1_epi16( 1 )), _mm_srli_epi16( v, 8 )), 8 );
+}
+
+static inline SSE2_FUNC __m128i broadcast_alpha_sse2( __m128i v )
+{
+    v = _mm_shufflelo_epi16( v, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    return _mm_shufflehi_epi16( v, _MM_SHUFFLE( 3, 3, 3, 3 ));
+}
+
+static SSE2_FUNC int rop_32_sse2( DWORD *ptr, int len, DWORD and, DWORD xor )
+{
+    __m128i vand = _mm_set1_epi32( and ), vxor = _mm_set1_epi32( xor );
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        __m128i v = _mm_loadu_si128( (__m128i *)(ptr + x) );
+        _mm_storeu_si128( (__m128i *)(ptr + x), _mm_xor_si128( _mm_and_si128( v, vand ), vxor ));
+    }
+    return x;
+}
+
+static SSE2_FUNC int rop_16_sse2( WORD *ptr, int len, WORD and, WORD xor )
+{
+    __m128i vand = _mm_set1_epi16( and ), vxor = _mm_set1_epi16( xor );
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        __m128i v = _mm_loadu_si128( (__m128i *)(ptr + x) );
+        _mm_storeu_si128( (__m128i *)(ptr + x), _mm_xor_si128( _mm_and_si128( v, vand ), vxor ));
+    }
+    return x;
+}
+
+static inline SSE2_FUNC __m128i rop_codes_sse2( __m128i d, __m128i s, __m128i a1, __m128i a2,
+                                                __m128i x1, __m128i x2 )
+{
+    __m128i and = _mm_xor_si128( _mm_and_si128( s, a1 ), a2 );
+    __m128i xor = _mm_xor_si128( _mm_and_si128( s, x1 ), x2 );
+    return _mm_xor_si128( _mm_and_si128( d, and ), xor );
+}
+
+static SSE2_FUNC int rop_codes_32_sse2( DWORD *dst, const DWORD *src, int len, const struct rop_codes *codes )
+{
+    __m128i a1 = _mm_set1_epi32( codes->a1 ), a2 = _mm_set1_epi32( codes->a2 );
+    __m128i x1 = _mm_set1_epi32( codes->x1 ), x2 = _mm_set1_epi32( codes->x2 );
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        __m128i s = _mm_loadu_si128( (const __m128i *)(src + x) );
+        __m128i d = _mm_loadu_si128( (__m128i *)(dst + x) );
+        _mm_storeu_si128( (__m128i *)(dst + x), rop_codes_sse2( d, s, a1, a2, x1, x2 ));
+    }
+    return x;
+}
+
+static SSE2_FUNC int rop_codes_16_sse2( WORD *dst, const WORD *src, int len, const struct rop_codes *codes )
+{
+    __m128i a1 = _mm_set1_epi16( codes->a1 ), a2 = _mm_set1_epi16( codes->a2 );
+    __m128i x1 = _mm_set1_epi16( codes->x1 ), x2 = _mm_set1_epi16( codes->x2 );
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        __m128i s = _mm_loadu_si128( (const __m128i *)(src + x) );
+        __m128i d = _mm_loadu_si128( (__m128i *)(dst + x) );
+        _mm_storeu_si128( (__m128i *)(dst + x), rop_codes_sse2( d, s, a1, a2, x1, x2 ));
+    }
+    return x;
+}
+
+/* src + dst * (255 - src_alpha) / 255, on two pixels unpacked to 16-bit channels */
+static inline SSE2_FUNC __m128i blend_premultiplied_sse2( __m128i d, __m128i s )
+{
+    __m128i inv = _mm_sub_epi16( _mm_set1_epi16( 255 ), broadcast_alpha_sse2( s ));
+    return _mm_add_epi16( s, div255_sse2( _mm_mullo_epi16( d, inv )));
+}
+
+/* the generic code doesn't saturate, results above 255 spill into the next channel */
+static inline SSE2_FUNC int overflows_sse2( __m128i lo, __m128i hi )
+{
+    __m128i max = _mm_set1_epi16( 255 );
+    return _mm_movemask_epi8( _mm_or_si128( _mm_cmpgt_epi16( lo, max ), _mm_cmpgt_epi16( hi, max )));
+}
+
+static SSE2_FUNC int blend_argb_sse2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    __m128i zero = _mm_setzero_si128();
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        __m128i s = _mm_loadu_si128( (const __m128i *)(src + x) );
+        __m128i d = _mm_loadu_si128( (__m128i *)(dst + x) );
+        __m128i lo = blend_premultiplied_sse2( _mm_unpacklo_epi8( d, zero ), _mm_unpacklo_epi8( s, zero ));
+        __m128i hi = blend_premultiplied_sse2( _mm_unpackhi_epi8( d, zero ), _mm_unpackhi_epi8( s, zero ));
+
+        if (overflows_sse2( lo, hi )) break;
+        _mm_storeu_si128( (__m128i *)(dst + x), _mm_packus_epi16( lo, hi ));
+    }
+    return x;
+}
+
+static SSE2_FUNC int blend_argb_alpha_sse2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    __m128i zero = _mm_setzero_si128(), valpha = _mm_set1_epi16( alpha );
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        __m128i s = _mm_loadu_si128( (const __m128i *)(src + x) );
+        __m128i d = _mm_loadu_si128( (__m128i *)(dst + x) );
+        __m128i s_lo = div255_sse2( _mm_mullo_epi16( _mm_unpacklo_epi8( s, zero ), valpha ));
+        __m128i s_hi = div255_sse2( _mm_mullo_epi16( _mm_unpackhi_epi8( s, zero ), valpha ));
+        __m128i lo = blend_premultiplied_sse2( _mm_unpacklo_epi8( d, zero ), s_lo );
+        __m128i hi = blend_premultiplied_sse2( _mm_unpackhi_epi8( d, zero ), s_hi );
+
+        if (overflows_sse2( lo, hi )) break;
+        _mm_storeu_si128( (__m128i *)(dst + x), _mm_packus_epi16( lo, hi ));
+    }
+    return x;
+}
+
+/* (src * alpha + dst * (255 - alpha) + 127) / 255 for all four channels */
+static inline SSE2_FUNC __m128i blend_constant_sse2( __m128i d, __m128i s, DWORD alpha )
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i valpha = _mm_set1_epi16( alpha ), vinv = _mm_set1_epi16( 255 - alpha );
+    __m128i lo = _mm_add_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( s, zero ), valpha ),
+                                _mm_mullo_epi16( _mm_unpacklo_epi8( d, zero ), vinv ));
+    __m128i hi = _mm_add_epi16( _mm_mullo_epi16( _mm_unpackhi_epi8( s, zero ), valpha ),
+                                _mm_mullo_epi16( _mm_unpackhi_epi8( d, zero ), vinv ));
+    return _mm_packus_epi16( div255_sse2( lo ), div255_sse2( hi ));
+}
+
+static SSE2_FUNC int blend_argb_constant_alpha_sse2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        __m128i s = _mm_loadu_si128( (const __m128i *)(src + x) );
+        __m128i d = _mm_loadu_si128( (__m128i *)(dst + x) );
+        _mm_storeu_si128( (__m128i *)(dst + x), blend_constant_sse2( d, s, alpha ));
+    }
+    return x;
+}
+
+static SSE2_FUNC int blend_argb_no_src_alpha_sse2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    __m128i opaque = _mm_set1_epi32( 0xff000000 );
+    int x;
+
+    for (x = 0; x + 4 <= len; x += 4)
+    {
+        __m128i s = _mm_or_si128( _mm_loadu_si128( (const __m128i *)(src + x) ), opaque );
+        __m128i d = _mm_loadu_si128( (__m128i *)(dst + x) );
+        _mm_storeu_si128( (__m128i *)(dst + x), blend_constant_sse2( d, s, alpha ));
+    }
+    return x;
+}
+
+/* skip fully transparent runs and fill fully opaque ones, 16 pixels at a time */
+static SSE2_FUNC int glyph_8888_sse2( DWORD *dst, const BYTE *glyph, int len, DWORD text_pixel )
+{
+    __m128i one = _mm_set1_epi8( 1 ), sixteen = _mm_set1_epi8( 16 ), text = _mm_set1_epi32( text_pixel );
+    int x;
+
+    for (x = 0; x + 16 <= len; x += 16)
+    {
+        __m128i g = _mm_loadu_si128( (const __m128i *)(glyph + x) );
+
+        if (_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_min_epu8( g, one ), g )) == 0xffff) continue;
+        if (_mm_movemask_epi8( _mm_cmpeq_epi8( _mm_max_epu8( g, sixteen ), g )) != 0xffff) break;
+        _mm_storeu_si128( (__m128i *)(dst + x), text );
+        _mm_storeu_si128( (__m128i *)(dst + x + 4), text );
+        _mm_storeu_si128( (__m128i *)(dst + x + 8), text );
+        _mm_storeu_si128( (__m128i *)(dst + x + 12), text );
+    }
+    return x;
+}
+
+static inline SSE2_FUNC __m128i expand_555_sse2( __m128i v )
+{
+    return _mm_or_si128(
+        _mm_or_si128( _mm_or_si128( _mm_and_si128( _mm_slli_epi32( v, 9 ), _mm_set1_epi32( 0xf80000 )),
+                                    _mm_and_si128( _mm_slli_epi32( v, 4 ), _mm_set1_epi32( 0x070000 ))),
+                      _mm_or_si128( _mm_and_si128( _mm_slli_epi32( v, 6 ), _mm_set1_epi32( 0x00f800 )),
+                                    _mm_and_si128( _mm_slli_epi32( v, 1 ), _mm_set1_epi32( 0x000700 )))),
+        _mm_or_si128( _mm_and_si128( _mm_slli_epi32( v, 3 ), _mm_set1_epi32( 0x0000f8 )),
+                      _mm_and_si128( _mm_srli_epi32( v, 2 ), _mm_set1_epi32( 0x000007 ))));
+}
+
+static SSE2_FUNC int convert_555_to_8888_sse2( DWORD *dst, const WORD *src, int len )
+{
+    __m128i zero = _mm_setzero_si128();
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        __m128i v = _mm_loadu_si128( (const __m128i *)(src + x) );
+        _mm_storeu_si128( (__m128i *)(dst + x), expand_555_sse2( _mm_unpacklo_epi16( v, zero )));
+        _mm_storeu_si128( (__m128i *)(dst + x + 4), expand_555_sse2( _mm_unpackhi_epi16( v, zero )));
+    }
+    return x;
+}
+
+static const struct simd_funcs simd_sse2 =
+{
+    "sse2",
+    rop_32_sse2,
+    rop_16_sse2,
+    rop_codes_32_sse2,
+    rop_codes_16_sse2,
+    blend_argb_sse2,
+    blend_argb_alpha_sse2,
+    blend_argb_constant_alpha_sse2,
+    blend_argb_no_src_alpha_sse2,
+    glyph_8888_sse2,
+    convert_555_to_8888_sse2
+};
+
+/* AVX2, same algorithms on twice the width; unpack and pack work within
+ * 128-bit lanes so pixel order is preserved */
+
+static inline AVX2_FUNC __m256i div255_avx2( __m256i v )
+{
+    v = _mm256_add_epi16( v, _mm256_set1_epi16( 127 ));
+    return _mm256_srli_epi16( _mm256_add_epi16( _mm256_add_epi16( v, _mm256_set1_epi16( 1 )),
+                                                _mm256_srli_epi16( v, 8 )), 8 );
+}
+
+static inline AVX2_FUNC __m256i broadcast_alpha_avx2( __m256i v )
+{
+    v = _mm256_shufflelo_epi16( v, _MM_SHUFFLE( 3, 3, 3, 3 ));
+    return _mm256_shufflehi_epi16( v, _MM_SHUFFLE( 3, 3, 3, 3 ));
+}
+
+static AVX2_FUNC int rop_32_avx2( DWORD *ptr, int len, DWORD and, DWORD xor )
+{
+    __m256i vand = _mm256_set1_epi32( and ), vxor = _mm256_set1_epi32( xor );
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        __m256i v = _mm256_loadu_si256( (__m256i *)(ptr + x) );
+        _mm256_storeu_si256( (__m256i *)(ptr + x), _mm256_xor_si256( _mm256_and_si256( v, vand ), vxor ));
+    }
+    return x;
+}
+
+static AVX2_FUNC int rop_16_avx2( WORD *ptr, int len, WORD and, WORD xor )
+{
+    __m256i vand = _mm256_set1_epi16( and ), vxor = _mm256_set1_epi16( xor );
+    int x;
+
+    for (x = 0; x + 16 <= len; x += 16)
+    {
+        __m256i v = _mm256_loadu_si256( (__m256i *)(ptr + x) );
+        _mm256_storeu_si256( (__m256i *)(ptr + x), _mm256_xor_si256( _mm256_and_si256( v, vand ), vxor ));
+    }
+    return x;
+}
+
+static inline AVX2_FUNC __m256i rop_codes_avx2( __m256i d, __m256i s, __m256i a1, __m256i a2,
+                                                __m256i x1, __m256i x2 )
+{
+    __m256i and = _mm256_xor_si256( _mm256_and_si256( s, a1 ), a2 );
+    __m256i xor = _mm256_xor_si256( _mm256_and_si256( s, x1 ), x2 );
+    return _mm256_xor_si256( _mm256_and_si256( d, and ), xor );
+}
+
+static AVX2_FUNC int rop_codes_32_avx2( DWORD *dst, const DWORD *src, int len, const struct rop_codes *codes )
+{
+    __m256i a1 = _mm256_set1_epi32( codes->a1 ), a2 = _mm256_set1_epi32( codes->a2 );
+    __m256i x1 = _mm256_set1_epi32( codes->x1 ), x2 = _mm256_set1_epi32( codes->x2 );
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        __m256i s = _mm256_loadu_si256( (const __m256i *)(src + x) );
+        __m256i d = _mm256_loadu_si256( (__m256i *)(dst + x) );
+        _mm256_storeu_si256( (__m256i *)(dst + x), rop_codes_avx2( d, s, a1, a2, x1, x2 ));
+    }
+    return x;
+}
+
+static AVX2_FUNC int rop_codes_16_avx2( WORD *dst, const WORD *src, int len, const struct rop_codes *codes )
+{
+    __m256i a1 = _mm256_set1_epi16( codes->a1 ), a2 = _mm256_set1_epi16( codes->a2 );
+    __m256i x1 = _mm256_set1_epi16( codes->x1 ), x2 = _mm256_set1_epi16( codes->x2 );
+    int x;
+
+    for (x = 0; x + 16 <= len; x += 16)
+    {
+        __m256i s = _mm256_loadu_si256( (const __m256i *)(src + x) );
+        __m256i d = _mm256_loadu_si256( (__m256i *)(dst + x) );
+        _mm256_storeu_si256( (__m256i *)(dst + x), rop_codes_avx2( d, s, a1, a2, x1, x2 ));
+    }
+    return x;
+}
+
+static inline AVX2_FUNC __m256i blend_premultiplied_avx2( __m256i d, __m256i s )
+{
+    __m256i inv = _mm256_sub_epi16( _mm256_set1_epi16( 255 ), broadcast_alpha_avx2( s ));
+    return _mm256_add_epi16( s, div255_avx2( _mm256_mullo_epi16( d, inv )));
+}
+
+static inline AVX2_FUNC int overflows_avx2( __m256i lo, __m256i hi )
+{
+    __m256i max = _mm256_set1_epi16( 255 );
+    return _mm256_movemask_epi8( _mm256_or_si256( _mm256_cmpgt_epi16( lo, max ), _mm256_cmpgt_epi16( hi, max )));
+}
+
+static AVX2_FUNC int blend_argb_avx2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    __m256i zero = _mm256_setzero_si256();
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        __m256i s = _mm256_loadu_si256( (const __m256i *)(src + x) );
+        __m256i d = _mm256_loadu_si256( (__m256i *)(dst + x) );
+        __m256i lo = blend_premultiplied_avx2( _mm256_unpacklo_epi8( d, zero ), _mm256_unpacklo_epi8( s, zero ));
+        __m256i hi = blend_premultiplied_avx2( _mm256_unpackhi_epi8( d, zero ), _mm256_unpackhi_epi8( s, zero ));
+
+        if (overflows_avx2( lo, hi )) break;
+        _mm256_storeu_si256( (__m256i *)(dst + x), _mm256_packus_epi16( lo, hi ));
+    }
+    return x;
+}
+
+static AVX2_FUNC int blend_argb_alpha_avx2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    __m256i zero = _mm256_setzero_si256(), valpha = _mm256_set1_epi16( alpha );
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        __m256i s = _mm256_loadu_si256( (const __m256i *)(src + x) );
+        __m256i d = _mm256_loadu_si256( (__m256i *)(dst + x) );
+        __m256i s_lo = div255_avx2( _mm256_mullo_epi16( _mm256_unpacklo_epi8( s, zero ), valpha ));
+        __m256i s_hi = div255_avx2( _mm256_mullo_epi16( _mm256_unpackhi_epi8( s, zero ), valpha ));
+        __m256i lo = blend_premultiplied_avx2( _mm256_unpacklo_epi8( d, zero ), s_lo );
+        __m256i hi = blend_premultiplied_avx2( _mm256_unpackhi_epi8( d, zero ), s_hi );
+
+        if (overflows_avx2( lo, hi )) break;
+        _mm256_storeu_si256( (__m256i *)(dst + x), _mm256_packus_epi16( lo, hi ));
+    }
+    return x;
+}
+
+static inline AVX2_FUNC __m256i blend_constant_avx2( __m256i d, __m256i s, DWORD alpha )
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i valpha = _mm256_set1_epi16( alpha ), vinv = _mm256_set1_epi16( 255 - alpha );
+    __m256i lo = _mm256_add_epi16( _mm256_mullo_epi16( _mm256_unpacklo_epi8( s, zero ), valpha ),
+                                   _mm256_mullo_epi16( _mm256_unpacklo_epi8( d, zero ), vinv ));
+    __m256i hi = _mm256_add_epi16( _mm256_mullo_epi16( _mm256_unpackhi_epi8( s, zero ), valpha ),
+                                   _mm256_mullo_epi16( _mm256_unpackhi_epi8( d, zero ), vinv ));
+    return _mm256_packus_epi16( div255_avx2( lo ), div255_avx2( hi ));
+}
+
+static AVX2_FUNC int blend_argb_constant_alpha_avx2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        __m256i s = _mm256_loadu_si256( (const __m256i *)(src + x) );
+        __m256i d = _mm256_loadu_si256( (__m256i *)(dst + x) );
+        _mm256_storeu_si256( (__m256i *)(dst + x), blend_constant_avx2( d, s, alpha ));
+    }
+    return x;
+}
+
+static AVX2_FUNC int blend_argb_no_src_alpha_avx2( DWORD *dst, const DWORD *src, int len, DWORD alpha )
+{
+    __m256i opaque = _mm256_set1_epi32( 0xff000000 );
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        __m256i s = _mm256_or_si256( _mm256_loadu_si256( (const __m256i *)(src + x) ), opaque );
+        __m256i d = _mm256_loadu_si256( (__m256i *)(dst + x) );
+        _mm256_storeu_si256( (__m256i *)(dst + x), blend_constant_avx2( d, s, alpha ));
+    }
+    return x;
+}
+
+static AVX2_FUNC int glyph_8888_avx2( DWORD *dst, const BYTE *glyph, int len, DWORD text_pixel )
+{
+    __m256i one = _mm256_set1_epi8( 1 ), sixteen = _mm256_set1_epi8( 16 ), text = _mm256_set1_epi32( text_pixel );
+    int x;
+
+    for (x = 0; x + 32 <= len; x += 32)
+    {
+        __m256i g = _mm256_loadu_si256( (const __m256i *)(glyph + x) );
+
+        if (_mm256_movemask_epi8( _mm256_cmpeq_epi8( _mm256_min_epu8( g, one ), g )) == -1) continue;
+        if (_mm256_movemask_epi8( _mm256_cmpeq_epi8( _mm256_max_epu8( g, sixteen ), g )) != -1) break;
+        _mm256_storeu_si256( (__m256i *)(dst + x), text );
+        _mm256_storeu_si256( (__m256i *)(dst + x + 8), text );
+        _mm256_storeu_si256( (__m256i *)(dst + x + 16), text );
+        _mm256_storeu_si256( (__m256i *)(dst + x + 24), text );
+    }
+    return x;
+}
+
+static inline AVX2_FUNC __m256i expand_555_avx2( __m256i v )
+{
+    return _mm256_or_si256(
+        _mm256_or_si256( _mm256_or_si256( _mm256_and_si256( _mm256_slli_epi32( v, 9 ), _mm256_set1_epi32( 0xf80000 )),
+                                          _mm256_and_si256( _mm256_slli_epi32( v, 4 ), _mm256_set1_epi32( 0x070000 ))),
+                         _mm256_or_si256( _mm256_and_si256( _mm256_slli_epi32( v, 6 ), _mm256_set1_epi32( 0x00f800 )),
+                                          _mm256_and_si256( _mm256_slli_epi32( v, 1 ), _mm256_set1_epi32( 0x000700 )))),
+        _mm256_or_si256( _mm256_and_si256( _mm256_slli_epi32( v, 3 ), _mm256_set1_epi32( 0x0000f8 )),
+                         _mm256_and_si256( _mm256_srli_epi32( v, 2 ), _mm256_set1_epi32( 0x000007 ))));
+}
+
+static AVX2_FUNC int convert_555_to_8888_avx2( DWORD *dst, const WORD *src, int len )
+{
+    int x;
+
+    for (x = 0; x + 8 <= len; x += 8)
+    {
+        __m256i v = _mm256_cvtepu16_epi32( _mm_loadu_si128( (const __m128i *)(src + x) ));
+        _mm256_storeu_si256( (__m256i *)(dst + x), expand_555_avx2( v ));
+    }
+    return x;
+}
+
+static const struct simd_funcs simd_avx2 =
+{
+    "avx2",
+    rop_32_avx2,
+    rop_16_avx2,
+    rop_codes_32_avx2,
+    rop_codes_16_avx2,
+    blend_argb_avx2,
+    blend_argb_alpha_avx2,
+    blend_argb_constant_alpha_avx2,
+    blend_argb_no_src_alpha_avx2,
+    glyph_8888_avx2,
+    convert_555_to_8888_avx2
+};
+
+#endif  /* HAVE_X86_SIMD */
+
+/***********************************************************************
+ *           init_simd_funcs
+ *
+ * Select the row helpers for the host CPU.
+ */
+void init_simd_funcs(void)
+{
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports( "avx2" )) simd_funcs = &simd_avx2;
+    else if (__builtin_cpu_supports( "sse2" )) simd_funcs = &simd_sse2;
+#endif
+    TRACE( "using %s row helpers\n", simd_funcs->name );
+}
@@ -344,6 +344,19 @@ static HRESULT push_instr_uint(compiler_ctx_t *ctx, jsop_t op, unsigned arg)
     return S_OK;
 }
 
+static HRESULT push_instr_uint_uint(compiler_ctx_t *ctx, jsop_t op, unsigned arg1, unsigned arg2)
+{
+    unsigned instr;
+
+    instr = push_instr(ctx, op);
+    if(!instr)
+        return E_OUTOFMEMORY;
+
+    instr_ptr(ctx, instr)->u.arg[0].uint = arg1;
+    instr_ptr(ctx, instr)->u.arg[1].uint = arg2;
+    return S_OK;
+}
+
 static HRESULT compile_binary_expression(compiler_ctx_t *ctx, binary_expression_t *expr, jsop_t op)
 {
     HRESULT hres;
@@ -472,7 +485,7 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_uint(ctx, OP_memberid, flags);
+        hres = push_instr_uint_uint(ctx, OP_memberid, flags, FALSE);
         break;
     }
     case EXPR_MEMBER: {
@@ -487,7 +500,8 @@ static HRESULT compile_memberid_expression(compiler_ctx_t *ctx, expression_t *ex
         if(FAILED(hres))
             return hres;
 
-        hres = push_instr_uint(ctx, OP_memberid, flags);
+        /* constant name, the lookup may be cached */
+        hres = push_instr_uint_uint(ctx, OP_memberid, flags, TRUE);
         break;
     }
     DEFAULT_UNREACHABLE;
@@ -2236,6 +2250,7 @@ void release_bytecode(bytecode_t *code)
     heap_pool_free(&code->heap);
     heap_free(code->bstr_pool);
     heap_free(code->str_pool);
+    heap_free(code->prop_caches);
     heap_free(code->instrs);
     heap_free(code);
 }
@@ -2489,6 +2504,11 @@ HRESULT compile_script(script_ctx_t *ctx, const WCHAR *code, const WCHAR *args,
     hres = compile_function(&compiler, compiler.parser->source, NULL, from_eval, &compiler.code->global_code);
     heap_pool_free(&compiler.heap);
     parser_release(compiler.parser);
+    if(SUCCEEDED(hres)) {
+        compiler.code->prop_caches = heap_alloc_zero(compiler.code_off * sizeof(*compiler.code->prop_caches));
+        if(!compiler.code->prop_caches)
+            hres = E_OUTOFMEMORY;
+    }
     if(FAILED(hres)) {
         release_bytecode(compiler.code);
         return hres;
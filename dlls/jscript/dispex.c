@@ -161,6 +161,108 @@ static inline HRESULT resize_props(jsdisp_t *This)
     return S_OK;
 }
 
+/*
+ * Shapes describe the sequence of property names allocated in an object's props array.
+ * Each shape is reached from its parent by appending a single name, so all objects
+ * that allocated the same names in the same order share a shape and, with it, the
+ * name to DISPID mapping. Props are never removed from the array (deleted ones only
+ * change their type), so a shape stays valid for the object's whole lifetime.
+ *
+ * Objects with many properties are usually used as hash maps and would only bloat
+ * the transition table, so they drop out of shape tracking (shape == NULL).
+ */
+#define SHAPE_TABLE_SIZE 1024
+#define SHAPE_MAX_CNT    16384
+#define SHAPE_MAX_PROPS  128
+
+struct _dispex_shape_t {
+    dispex_shape_t *parent;
+    dispex_shape_t *next;
+    unsigned id;
+    unsigned hash;
+    WCHAR *name;
+};
+
+static LONG last_shape_id;
+
+static dispex_shape_t *alloc_shape(script_ctx_t *ctx, dispex_shape_t *parent, const WCHAR *name, unsigned hash)
+{
+    dispex_shape_t *shape;
+
+    if(ctx->shape_cnt >= SHAPE_MAX_CNT)
+        return NULL;
+
+    shape = heap_alloc(sizeof(*shape));
+    if(!shape)
+        return NULL;
+
+    shape->name = NULL;
+    if(name && !(shape->name = heap_strdupW(name))) {
+        heap_free(shape);
+        return NULL;
+    }
+
+    shape->parent = parent;
+    shape->next = NULL;
+    shape->id = InterlockedIncrement(&last_shape_id);
+    shape->hash = hash;
+    ctx->shape_cnt++;
+    return shape;
+}
+
+static dispex_shape_t *get_root_shape(script_ctx_t *ctx)
+{
+    if(!ctx->shapes && !(ctx->shapes = heap_alloc_zero(SHAPE_TABLE_SIZE * sizeof(*ctx->shapes))))
+        return NULL;
+    if(!ctx->root_shape)
+        ctx->root_shape = alloc_shape(ctx, NULL, NULL, 0);
+
+    return ctx->root_shape;
+}
+
+static dispex_shape_t *shape_transition(script_ctx_t *ctx, dispex_shape_t *shape, const WCHAR *name, unsigned hash)
+{
+    dispex_shape_t *iter, *ret;
+    unsigned bucket;
+
+    bucket = ((shape->id ^ hash) * GOLDEN_RATIO) & (SHAPE_TABLE_SIZE-1);
+    for(iter = ctx->shapes[bucket]; iter; iter = iter->next) {
+        if(iter->parent == shape && iter->hash == hash && !strcmpW(iter->name, name))
+            return iter;
+    }
+
+    ret = alloc_shape(ctx, shape, name, hash);
+    if(!ret)
+        return NULL;
+
+    ret->next = ctx->shapes[bucket];
+    ctx->shapes[bucket] = ret;
+    return ret;
+}
+
+void release_shapes(script_ctx_t *ctx)
+{
+    dispex_shape_t *iter, *next;
+    unsigned i;
+
+    if(!ctx->shapes)
+        return;
+
+    for(i = 0; i < SHAPE_TABLE_SIZE; i++) {
+        for(iter = ctx->shapes[i]; iter; iter = next) {
+            next = iter->next;
+            heap_free(iter->name);
+            heap_free(iter);
+        }
+    }
+
+    heap_free(ctx->root_shape);
+    heap_free(ctx->shapes);
+    ctx->root_shape = NULL;
+    ctx->shapes = NULL;
+    ctx->shape_cnt = 0;
+}
+
 static inline dispex_prop_t* alloc_prop(jsdisp_t *This, const WCHAR *name, prop_type_t type, DWORD flags)
 {
     dispex_prop_t *prop;
@@ -180,6 +282,10 @@ static inline dispex_prop_t* alloc_prop(jsdisp_t *This, const WCHAR *name, prop_
     bucket = get_props_idx(This, prop->hash);
     prop->bucket_next = This->props[bucket].bucket_head;
     This->props[bucket].bucket_head = This->prop_cnt++;
+
+    if(This->shape)
+        This->shape = This->prop_cnt <= SHAPE_MAX_PROPS
+            ? shape_transition(This->ctx, This->shape, name, prop->hash) : NULL;
     return prop;
 }
 
@@ -963,6 +1069,7 @@ HRESULT init_dispex(jsdisp_t *dispex, script_ctx_t *ctx, const builtin_info_t *b
 
     script_addref(ctx);
     dispex->ctx = ctx;
+    dispex->shape = get_root_shape(ctx);
 
     return S_OK;
 }
@@ -1107,6 +1214,27 @@ HRESULT jsdisp_get_id(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, DISPID *
     return DISP_E_UNKNOWNNAME;
 }
 
+HRESULT jsdisp_get_id_cached(jsdisp_t *jsdisp, const WCHAR *name, DWORD flags, prop_cache_t *cache, DISPID *id)
+{
+    HRESULT hres;
+
+    if(!cache)
+        return jsdisp_get_id(jsdisp, name, flags, id);
+
+    if(jsdisp->shape && jsdisp->shape->id == cache->shape_id
+       && jsdisp->props[cache->id].type != PROP_DELETED) {
+        *id = cache->id;
+        return S_OK;
+    }
+
+    hres = jsdisp_get_id(jsdisp, name, flags, id);
+    if(SUCCEEDED(hres) && jsdisp->shape) {
+        cache->shape_id = jsdisp->shape->id;
+        cache->id = *id;
+    }
+    return hres;
+}
+
 HRESULT jsdisp_call_value(jsdisp_t *jsfunc, IDispatch *jsthis, WORD flags, unsigned argc, jsval_t *argv, jsval_t *r)
 {
     HRESULT hres;
@@ -439,7 +439,8 @@ void scope_release(scope_chain_t *scope)
     heap_free(scope);
 }
 
-static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr, DWORD flags, DISPID *id)
+static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name, BSTR name_bstr, DWORD flags,
+        prop_cache_t *cache, DISPID *id)
 {
     IDispatchEx *dispex;
     jsdisp_t *jsdisp;
@@ -448,7 +449,7 @@ static HRESULT disp_get_id(script_ctx_t *ctx, IDispatch *disp, const WCHAR *name
 
     jsdisp = iface_to_jsdisp(disp);
     if(jsdisp) {
-        hres = jsdisp_get_id(jsdisp, name, flags, id);
+        hres = jsdisp_get_id_cached(jsdisp, name, flags, cache, id);
         jsdisp_release(jsdisp);
         return hres;
     }
@@ -602,7 +603,7 @@ static BOOL lookup_global_members(script_ctx_t *ctx, BSTR identifier, exprval_t
 
     for(item = ctx->named_items; item; item = item->next) {
         if(item->flags & SCRIPTITEM_GLOBALMEMBERS) {
-            hres = disp_get_id(ctx, item->disp, identifier, identifier, 0, &id);
+            hres = disp_get_id(ctx, item->disp, identifier, identifier, 0, NULL, &id);
             if(SUCCEEDED(hres)) {
                 if(ret)
                     exprval_set_disp_ref(ret, item->disp, id);
@@ -625,7 +626,7 @@ local_ref_t *lookup_local(const function_code_t *function, const WCHAR *identifi
 }
 
 /* ECMA-262 3rd Edition    10.1.4 */
-static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *ret)
+static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, prop_cache_t *cache, exprval_t *ret)
 {
     scope_chain_t *scope;
     named_item_t *item;
@@ -655,9 +656,9 @@ static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *re
                 }
             }
             if(scope->jsobj)
-                hres = jsdisp_get_id(scope->jsobj, identifier, fdexNameImplicit, &id);
+                hres = jsdisp_get_id_cached(scope->jsobj, identifier, fdexNameImplicit, cache, &id);
             else
-                hres = disp_get_id(ctx, scope->obj, identifier, identifier, fdexNameImplicit, &id);
+                hres = disp_get_id(ctx, scope->obj, identifier, identifier, fdexNameImplicit, NULL, &id);
             if(SUCCEEDED(hres)) {
                 exprval_set_disp_ref(ret, scope->obj, id);
                 return S_OK;
@@ -665,7 +666,7 @@ static HRESULT identifier_eval(script_ctx_t *ctx, BSTR identifier, exprval_t *re
         }
     }
 
-    hres = jsdisp_get_id(ctx->global, identifier, 0, &id);
+    hres = jsdisp_get_id_cached(ctx->global, identifier, 0, cache, &id);
     if(SUCCEEDED(hres)) {
         exprval_set_disp_ref(ret, to_disp(ctx->global), id);
         return S_OK;
@@ -726,6 +727,12 @@ static inline unsigned get_op_int(script_ctx_t *ctx, int i)
     return frame->bytecode->instrs[frame->ip].u.arg[i].lng;
 }
 
+static inline prop_cache_t *get_op_cache(script_ctx_t *ctx)
+{
+    call_frame_t *frame = ctx->call_ctx;
+    return frame->bytecode->prop_caches + frame->ip;
+}
+
 static inline jsstr_t *get_op_str(script_ctx_t *ctx, int i)
 {
     call_frame_t *frame = ctx->call_ctx;
@@ -1041,7 +1048,7 @@ static HRESULT interp_array(script_ctx_t *ctx)
         return hres;
     }
 
-    hres = disp_get_id(ctx, obj, name, NULL, 0, &id);
+    hres = disp_get_id(ctx, obj, name, NULL, 0, NULL, &id);
     jsstr_release(name_str);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx, obj, id, &v);
@@ -1071,7 +1078,7 @@ static HRESULT interp_member(script_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx, obj, arg, arg, 0, &id);
+    hres = disp_get_id(ctx, obj, arg, arg, 0, get_op_cache(ctx), &id);
     if(SUCCEEDED(hres)) {
         hres = disp_propget(ctx, obj, id, &v);
     }else if(hres == DISP_E_UNKNOWNNAME) {
@@ -1089,6 +1096,7 @@ static HRESULT interp_member(script_ctx_t *ctx)
 static HRESULT interp_memberid(script_ctx_t *ctx)
 {
     const unsigned arg = get_op_uint(ctx, 0);
+    const BOOL cacheable = get_op_uint(ctx, 1);
     jsval_t objv, namev;
     const WCHAR *name;
     jsstr_t *name_str;
@@ -1113,7 +1121,7 @@ static HRESULT interp_memberid(script_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(ctx, obj, name, NULL, arg, &id);
+    hres = disp_get_id(ctx, obj, name, NULL, arg, cacheable ? get_op_cache(ctx) : NULL, &id);
     jsstr_release(name_str);
     if(SUCCEEDED(hres)) {
         ref.type = EXPRVAL_IDREF;
@@ -1227,7 +1235,7 @@ static HRESULT interp_identifier_ref(script_ctx_t *ctx, BSTR identifier, unsigne
     exprval_t exprval;
     HRESULT hres;
 
-    hres = identifier_eval(ctx, identifier, &exprval);
+    hres = identifier_eval(ctx, identifier, get_op_cache(ctx), &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -1256,7 +1264,7 @@ static HRESULT identifier_value(script_ctx_t *ctx, BSTR identifier)
     jsval_t v;
     HRESULT hres;
 
-    hres = identifier_eval(ctx, identifier, &exprval);
+    hres = identifier_eval(ctx, identifier, get_op_cache(ctx), &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -1668,7 +1676,7 @@ static HRESULT interp_in(script_ctx_t *ctx)
         return hres;
     }
 
-    hres = disp_get_id(ctx, get_object(obj), str, NULL, 0, &id);
+    hres = disp_get_id(ctx, get_object(obj), str, NULL, 0, NULL, &id);
     IDispatch_Release(get_object(obj));
     jsstr_release(jsstr);
     if(SUCCEEDED(hres))
@@ -1876,7 +1884,7 @@ static HRESULT interp_delete_ident(script_ctx_t *ctx)
 
     TRACE("%s\n", debugstr_w(arg));
 
-    hres = identifier_eval(ctx, arg, &exprval);
+    hres = identifier_eval(ctx, arg, get_op_cache(ctx), &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -1987,7 +1995,7 @@ static HRESULT interp_typeofident(script_ctx_t *ctx)
 
     TRACE("%s\n", debugstr_w(arg));
 
-    hres = identifier_eval(ctx, arg, &exprval);
+    hres = identifier_eval(ctx, arg, get_op_cache(ctx), &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -2839,7 +2847,7 @@ static HRESULT bind_event_target(script_ctx_t *ctx, function_code_t *func, jsdis
     jsval_t v;
     HRESULT hres;
 
-    hres = identifier_eval(ctx, func->event_target, &exprval);
+    hres = identifier_eval(ctx, func->event_target, NULL, &exprval);
     if(FAILED(hres))
         return hres;
 
@@ -56,7 +56,7 @@
     X(lt,         1, 0,0)                  \
     X(lteq,       1, 0,0)                  \
     X(member,     1, ARG_BSTR,   0)        \
-    X(memberid,   1, ARG_UINT,   0)        \
+    X(memberid,   1, ARG_UINT,   ARG_UINT) \
     X(minus,      1, 0,0)                  \
     X(mod,        1, 0,0)                  \
     X(mul,        1, 0,0)                  \
@@ -171,6 +171,7 @@ typedef struct _bytecode_t {
     LONG ref;
 
     instr_t *instrs;
+    prop_cache_t *prop_caches; /* one per instruction */
     heap_pool_t heap;
 
     function_code_t global_code;
@@ -50,6 +50,7 @@ typedef struct _jsval_t jsval_t;
 typedef struct _jsstr_t jsstr_t;
 typedef struct _script_ctx_t script_ctx_t;
 typedef struct _dispex_prop_t dispex_prop_t;
+typedef struct _dispex_shape_t dispex_shape_t;
 typedef struct _property_desc_t property_desc_t;
 
 typedef struct {
@@ -229,6 +230,7 @@ struct jsdisp_t {
     DWORD buf_size;
     DWORD prop_cnt;
     dispex_prop_t *props;
+    dispex_shape_t *shape;
     script_ctx_t *ctx;
 
     jsdisp_t *prototype;
@@ -272,6 +274,16 @@ void jsdisp_release(jsdisp_t*) DECLSPEC_HIDDEN;
 
 #endif
 
+/*
+ * Property lookup cache of a single bytecode instruction. Objects sharing a shape
+ * have the same property names at the same DISPIDs, so a (shape, DISPID) pair
+ * remembered from a previous lookup stays valid for any object of that shape.
+ */
+typedef struct {
+    unsigned shape_id;
+    DISPID id;
+} prop_cache_t;
+
 HRESULT create_dispex(script_ctx_t*,const builtin_info_t*,jsdisp_t*,jsdisp_t**) DECLSPEC_HIDDEN;
 HRESULT init_dispex(jsdisp_t*,script_ctx_t*,const builtin_info_t*,jsdisp_t*) DECLSPEC_HIDDEN;
 HRESULT init_dispex_from_constr(jsdisp_t*,script_ctx_t*,const builtin_info_t*,jsdisp_t*) DECLSPEC_HIDDEN;
@@ -290,6 +302,8 @@ HRESULT jsdisp_propput_idx(jsdisp_t*,DWORD,jsval_t) DECLSPEC_HIDDEN;
 HRESULT jsdisp_propget_name(jsdisp_t*,LPCWSTR,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_idx(jsdisp_t*,DWORD,jsval_t*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_get_id(jsdisp_t*,const WCHAR*,DWORD,DISPID*) DECLSPEC_HIDDEN;
+HRESULT jsdisp_get_id_cached(jsdisp_t*,const WCHAR*,DWORD,prop_cache_t*,DISPID*) DECLSPEC_HIDDEN;
+void release_shapes(script_ctx_t*) DECLSPEC_HIDDEN;
 HRESULT disp_delete(IDispatch*,DISPID,BOOL*) DECLSPEC_HIDDEN;
 HRESULT disp_delete_name(script_ctx_t*,IDispatch*,jsstr_t*,BOOL*) DECLSPEC_HIDDEN;
 HRESULT jsdisp_delete_idx(jsdisp_t*,DWORD) DECLSPEC_HIDDEN;
@@ -431,6 +445,10 @@ struct _script_ctx_t {
     DWORD last_match_index;
     DWORD last_match_length;
 
+    dispex_shape_t *root_shape;
+    dispex_shape_t **shapes;
+    unsigned shape_cnt;
+
     jsdisp_t *global;
     jsdisp_t *function_constr;
     jsdisp_t *array_constr;
@@ -0,0 +1,111 @@
+/*
+ * Property access and method call micro benchmarks.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+var ITERATIONS = 200000;
+
+function check(v, expected, name) {
+    if(v !== expected)
+        throw name + ": got " + v + ", expected " + expected;
+}
+
+function Point(x, y) {
+    this.x = x;
+    this.y = y;
+}
+
+Point.prototype.norm1 = function() {
+    return this.x + this.y;
+};
+
+Point.prototype.add = function(p) {
+    this.x += p.x;
+    this.y += p.y;
+    return this;
+};
+
+/* monomorphic own property reads */
+function benchOwnGet() {
+    var p = new Point(1, 2), sum = 0, i;
+
+    for(i = 0; i < ITERATIONS; i++)
+        sum += p.x + p.y;
+    return sum;
+}
+
+/* own property writes */
+function benchOwnSet() {
+    var p = new Point(0, 0), i;
+
+    for(i = 0; i < ITERATIONS; i++) {
+        p.x = i;
+        p.y = p.x;
+    }
+    return p.x + p.y;
+}
+
+/* methods looked up through the prototype */
+function benchMethodCall() {
+    var p = new Point(1, 1), d = new Point(0, 1), sum = 0, i;
+
+    for(i = 0; i < ITERATIONS; i++)
+        sum += p.add(d).norm1() & 1;
+    return sum;
+}
+
+/* several object layouts seen by the same instructions */
+function benchPolymorphic() {
+    var objs = [new Point(1, 2), {x: 1, y: 2}, {y: 2, x: 1}, {x: 1, y: 2, z: 3}], sum = 0, o, i;
+
+    for(i = 0; i < ITERATIONS; i++) {
+        o = objs[i & 3];
+        sum += o.x + o.y;
+    }
+    return sum;
+}
+
+/* global variable and function lookups */
+var globalCounter = 0;
+
+function globalInc() {
+    globalCounter++;
+}
+
+function benchGlobal() {
+    var i;
+
+    globalCounter = 0;
+    for(i = 0; i < ITERATIONS; i++)
+        globalInc();
+    return globalCounter;
+}
+
+/* built-in properties and methods */
+function benchBuiltin() {
+    var s = "property", a = [1, 2, 3], sum = 0, i;
+
+    for(i = 0; i < ITERATIONS; i++)
+        sum += s.length + a.length + Math.abs(-1);
+    return sum;
+}
+
+check(benchOwnGet(), 3 * ITERATIONS, "benchOwnGet");
+check(benchOwnSet(), 2 * (ITERATIONS - 1), "benchOwnSet");
+check(benchMethodCall(), ITERATIONS / 2, "benchMethodCall");
+check(benchPolymorphic(), 3 * ITERATIONS, "benchPolymorphic");
+check(benchGlobal(), ITERATIONS, "benchGlobal");
+check(benchBuiltin(), 12 * ITERATIONS, "benchBuiltin");
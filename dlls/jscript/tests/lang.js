@@ -1832,6 +1832,64 @@ ok(tmp, "tmp = " + tmp);
     ok(x === undefined, "x = " + x);
 })();
 
+/* property lookup caches must follow changes of the object layout */
+(function() {
+    function Point(x, y) { this.x = x; this.y = y; }
+    function getX(o) { return o.x; }
+    function setX(o, v) { o.x = v; }
+    var objs, i, proto = {x: "proto"}, o;
+
+    Point.prototype.z = "z";
+    objs = [new Point(1, 2), new Point(3, 4), {y: 5, x: 6}, {x: 7}, {}];
+    for(i = 0; i < 10; i++) {
+        ok(getX(objs[0]) === 1, "getX(objs[0]) = " + getX(objs[0]));
+        ok(getX(objs[1]) === 3, "getX(objs[1]) = " + getX(objs[1]));
+        ok(getX(objs[2]) === 6, "getX(objs[2]) = " + getX(objs[2]));
+        ok(getX(objs[3]) === 7, "getX(objs[3]) = " + getX(objs[3]));
+        ok(getX(objs[4]) === undefined, "getX(objs[4]) = " + getX(objs[4]));
+        ok(objs[i % 2].z === "z", "objs[" + (i % 2) + "].z = " + objs[i % 2].z);
+    }
+
+    for(i = 0; i < 4; i++)
+        setX(objs[i], i * 10);
+    for(i = 0; i < 4; i++)
+        ok(getX(objs[i]) === i * 10, "getX(objs[" + i + "]) = " + getX(objs[i]));
+
+    delete objs[0].x;
+    ok(getX(objs[0]) === undefined, "getX(objs[0]) after delete = " + getX(objs[0]));
+    ok(getX(objs[1]) === 10, "getX(objs[1]) after delete = " + getX(objs[1]));
+    Point.prototype.x = "px";
+    ok(getX(objs[0]) === "px", "getX(objs[0]) from prototype = " + getX(objs[0]));
+    setX(objs[0], 1);
+    ok(getX(objs[0]) === 1, "getX(objs[0]) after set = " + getX(objs[0]));
+    delete Point.prototype.x;
+
+    function Derived() {}
+    Derived.prototype = proto;
+    o = new Derived();
+    for(i = 0; i < 3; i++)
+        ok(getX(o) === "proto", "getX(o) = " + getX(o));
+    delete proto.x;
+    ok(getX(o) === undefined, "getX(o) after prototype delete = " + getX(o));
+
+    for(i = 0; i < 4; i++) {
+        o = i % 2 ? {x: "with"} : {};
+        with(o)
+            tmp = typeof(x) === "string" ? x : "local";
+        ok(tmp === (i % 2 ? "with" : "local"), "tmp = " + tmp);
+    }
+    var x;
+})();
+
+function cachedGlobal() { return typeof(icGlobal) === "undefined" ? undefined : icGlobal; }
+ok(cachedGlobal() === undefined, "cachedGlobal() = " + cachedGlobal());
+icGlobal = 1;
+ok(cachedGlobal() === 1, "cachedGlobal() = " + cachedGlobal());
+icGlobal = 2;
+ok(cachedGlobal() === 2, "cachedGlobal() = " + cachedGlobal());
+delete icGlobal;
+ok(cachedGlobal() === undefined, "cachedGlobal() after delete = " + cachedGlobal());
+
 var get, set;
 
 /* NoNewline rule parser tests */
@@ -2901,6 +2901,7 @@ static void run_benchmarks(void)
     run_benchmark("dna.js");
     run_benchmark("base64.js");
     run_benchmark("validateinput.js");
+    run_benchmark("propaccess.js");
 }
 
 static BOOL check_jscript(void)
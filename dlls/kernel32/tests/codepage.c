@@ -1290,6 +1290,61 @@ static void test_dbcs_to_widechar(void)
     }
 }
 
+static void test_long_strings(void)
+{
+    static const UINT cps[] = { 1252, CP_UTF8 };
+    char str[128], buf[128];
+    WCHAR strW[100], bufW[100];
+    int i, j, len, ret;
+
+    /* long ASCII runs with a non-ASCII char crossing the 16-char block boundaries */
+    for (i = 0; i < ARRAY_SIZE(strW); i++) strW[i] = 'a' + i % 26;
+    strW[37] = 0xe4;
+
+    for (i = 0; i < ARRAY_SIZE(cps); i++)
+    {
+        for (j = len = 0; j < ARRAY_SIZE(strW); j++)
+        {
+            if (strW[j] < 0x80) str[len++] = strW[j];
+            else if (cps[i] == CP_UTF8)
+            {
+                str[len++] = (char)0xc3;
+                str[len++] = (char)0xa4;
+            }
+            else str[len++] = (char)0xe4;
+        }
+
+        ret = MultiByteToWideChar(cps[i], 0, str, len, NULL, 0);
+        ok(ret == ARRAY_SIZE(strW), "%u: returned %d\n", cps[i], ret);
+        memset(bufW, 0, sizeof(bufW));
+        ret = MultiByteToWideChar(cps[i], 0, str, len, bufW, ARRAY_SIZE(bufW));
+        ok(ret == ARRAY_SIZE(strW), "%u: returned %d\n", cps[i], ret);
+        ok(!memcmp(bufW, strW, sizeof(strW)), "%u: wrong conversion %s\n", cps[i],
+           wine_dbgstr_wn(bufW, ARRAY_SIZE(bufW)));
+
+        SetLastError(0xdeadbeef);
+        memset(bufW, 0, sizeof(bufW));
+        ret = MultiByteToWideChar(cps[i], 0, str, len, bufW, 70);
+        ok(!ret, "%u: returned %d\n", cps[i], ret);
+        ok(GetLastError() == ERROR_INSUFFICIENT_BUFFER, "%u: wrong error %u\n", cps[i], GetLastError());
+        ok(!bufW[70], "%u: buffer overflow %04x\n", cps[i], bufW[70]);
+
+        ret = WideCharToMultiByte(cps[i], 0, strW, ARRAY_SIZE(strW), NULL, 0, NULL, NULL);
+        ok(ret == len, "%u: returned %d\n", cps[i], ret);
+        memset(buf, 0, sizeof(buf));
+        ret = WideCharToMultiByte(cps[i], 0, strW, ARRAY_SIZE(strW), buf, sizeof(buf), NULL, NULL);
+        ok(ret == len, "%u: returned %d\n", cps[i], ret);
+        ok(!memcmp(buf, str, len), "%u: wrong conversion %s\n", cps[i], buf);
+
+        SetLastError(0xdeadbeef);
+        memset(buf, 0, sizeof(buf));
+        ret = WideCharToMultiByte(cps[i], 0, strW, ARRAY_SIZE(strW), buf, 70, NULL, NULL);
+        ok(!ret, "%u: returned %d\n", cps[i], ret);
+        ok(GetLastError() == ERROR_INSUFFICIENT_BUFFER, "%u: wrong error %u\n", cps[i], GetLastError());
+        ok(!buf[70], "%u: buffer overflow %02x\n", cps[i], buf[70]);
+    }
+}
+
 START_TEST(codepage)
 {
     BOOL bUsedDefaultChar;
@@ -1312,4 +1367,5 @@ START_TEST(codepage)
     test_threadcp();
 
     test_dbcs_to_widechar();
+    test_long_strings();
 }
@@ -4591,6 +4591,150 @@ static BOOL is_access_compatible(unsigned obj_access, unsigned desired_access)
     return (obj_access & desired_access) == desired_access;
 }
 
+static void test_overlapped_completion_port(void)
+{
+    static const DWORD count = 64, block = 4096;
+    char temp_path[MAX_PATH], filename[MAX_PATH];
+    OVERLAPPED *ovl, *povl;
+    HANDLE hfile, port;
+    ULONG_PTR key;
+    DWORD i, j, size;
+    char *buf;
+    BOOL ret;
+
+    GetTempPathA( MAX_PATH, temp_path );
+    ret = GetTempFileNameA( temp_path, "ovl", 0, filename );
+    ok( ret != 0, "GetTempFileNameA error %d\n", GetLastError() );
+
+    hfile = CreateFileA( filename, GENERIC_READ | GENERIC_WRITE, 0, 0, CREATE_ALWAYS,
+                         FILE_FLAG_OVERLAPPED | FILE_FLAG_DELETE_ON_CLOSE, 0 );
+    ok( hfile != INVALID_HANDLE_VALUE, "CreateFile failed err %u\n", GetLastError() );
+    if (hfile == INVALID_HANDLE_VALUE) return;
+
+    port = CreateIoCompletionPort( hfile, NULL, 123, 0 );
+    ok( port != NULL, "CreateIoCompletionPort failed err %u\n", GetLastError() );
+
+    ovl = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, count * sizeof(*ovl) );
+    buf = HeapAlloc( GetProcessHeap(), 0, count * block );
+
+    /* queue all the writes before collecting any completion */
+    for (i = 0; i < count; i++)
+    {
+        memset( buf + i * block, 'a' + i % 26, block );
+        ovl[i].Offset = i * block;
+        SetLastError( 0xdeadbeef );
+        ret = WriteFile( hfile, buf + i * block, block, NULL, &ovl[i] );
+        ok( ret || GetLastError() == ERROR_IO_PENDING, "%u: WriteFile failed err %u\n", i, GetLastError() );
+    }
+    for (i = 0; i < count; i++)
+    {
+        povl = NULL;
+        ret = GetQueuedCompletionStatus( port, &size, &key, &povl, 5000 );
+        ok( ret, "GetQueuedCompletionStatus failed err %u\n", GetLastError() );
+        if (!ret) break;
+        ok( key == 123, "wrong key %lu\n", key );
+        ok( size == block, "wrong size %u\n", size );
+        ok( povl >= ovl && povl < ovl + count, "wrong ovl %p\n", povl );
+    }
+
+    memset( buf, 0, count * block );
+    memset( ovl, 0, count * sizeof(*ovl) );
+    for (i = 0; i < count; i++)
+    {
+        ovl[i].Offset = (count - 1 - i) * block;
+        SetLastError( 0xdeadbeef );
+        ret = ReadFile( hfile, buf + (count - 1 - i) * block, block, NULL, &ovl[i] );
+        ok( ret || GetLastError() == ERROR_IO_PENDING, "%u: ReadFile failed err %u\n", i, GetLastError() );
+    }
+    for (i = 0; i < count; i++)
+    {
+        povl = NULL;
+        ret = GetQueuedCompletionStatus( port, &size, &key, &povl, 5000 );
+        ok( ret, "GetQueuedCompletionStatus failed err %u\n", GetLastError() );
+        if (!ret) break;
+        ok( size == block, "wrong size %u\n", size );
+    }
+    for (i = 0; i < count; i++)
+    {
+        ret = GetOverlappedResult( hfile, &ovl[i], &size, FALSE );
+        ok( ret, "%u: GetOverlappedResult failed err %u\n", i, GetLastError() );
+        for (j = 0; j < block; j++) if (buf[i * block + j] != 'a' + i % 26) break;
+        ok( j == block, "%u: wrong data at %u\n", i, j );
+    }
+
+    HeapFree( GetProcessHeap(), 0, buf );
+    HeapFree( GetProcessHeap(), 0, ovl );
+    CloseHandle( hfile );
+    CloseHandle( port );
+}
+
+static void test_overlapped_read_result(void)
+{
+    static const DWORD block = 65536;
+    char temp_path[MAX_PATH], filename[MAX_PATH];
+    OVERLAPPED ovl;
+    HANDLE hfile, event;
+    DWORD i, j, size;
+    char *buf;
+    BOOL ret;
+
+    GetTempPathA( MAX_PATH, temp_path );
+    ret = GetTempFileNameA( temp_path, "ovl", 0, filename );
+    ok( ret != 0, "GetTempFileNameA error %d\n", GetLastError() );
+
+    hfile = CreateFileA( filename, GENERIC_READ | GENERIC_WRITE, 0, 0, CREATE_ALWAYS,
+                         FILE_FLAG_OVERLAPPED | FILE_FLAG_DELETE_ON_CLOSE, 0 );
+    ok( hfile != INVALID_HANDLE_VALUE, "CreateFile failed err %u\n", GetLastError() );
+    if (hfile == INVALID_HANDLE_VALUE) return;
+
+    buf = HeapAlloc( GetProcessHeap(), 0, 4 * block );
+    for (i = 0; i < 4 * block; i++) buf[i] = i / 7;
+    memset( &ovl, 0, sizeof(ovl) );
+    ret = WriteFile( hfile, buf, 4 * block, NULL, &ovl );
+    ok( ret || GetLastError() == ERROR_IO_PENDING, "WriteFile failed err %u\n", GetLastError() );
+    ret = GetOverlappedResult( hfile, &ovl, &size, TRUE );
+    ok( ret, "GetOverlappedResult failed err %u\n", GetLastError() );
+    ok( size == 4 * block, "wrong size %u\n", size );
+
+    event = CreateEventA( NULL, TRUE, FALSE, NULL );
+
+    /* with and without an event, the result must only be reported once the read is done */
+    for (i = 0; i < 4; i++)
+    {
+        memset( buf, 0xcc, block );
+        memset( &ovl, 0, sizeof(ovl) );
+        ovl.Offset = i * block;
+        ovl.hEvent = (i & 1) ? event : NULL;
+        SetLastError( 0xdeadbeef );
+        ret = ReadFile( hfile, buf, block, NULL, &ovl );
+        ok( ret || GetLastError() == ERROR_IO_PENDING, "%u: ReadFile failed err %u\n", i, GetLastError() );
+        size = 0;
+        ret = GetOverlappedResult( hfile, &ovl, &size, TRUE );
+        ok( ret, "%u: GetOverlappedResult failed err %u\n", i, GetLastError() );
+        ok( size == block, "%u: wrong size %u\n", i, size );
+        ok( ovl.InternalHigh == block, "%u: wrong InternalHigh %lu\n", i, ovl.InternalHigh );
+        for (j = 0; j < block; j++) if (buf[j] != (char)((i * block + j) / 7)) break;
+        ok( j == block, "%u: wrong data at %u\n", i, j );
+        if (ovl.hEvent) ok( !WaitForSingleObject( event, 0 ), "%u: event not signaled\n", i );
+    }
+
+    /* a cancelled read either completes or reports the cancellation */
+    memset( &ovl, 0, sizeof(ovl) );
+    ovl.hEvent = event;
+    ret = ReadFile( hfile, buf, 4 * block, NULL, &ovl );
+    ok( ret || GetLastError() == ERROR_IO_PENDING, "ReadFile failed err %u\n", GetLastError() );
+    CancelIo( hfile );
+    size = 0;
+    SetLastError( 0xdeadbeef );
+    ret = GetOverlappedResult( hfile, &ovl, &size, TRUE );
+    ok( (ret && size == 4 * block) || (!ret && GetLastError() == ERROR_OPERATION_ABORTED),
+        "GetOverlappedResult returned %d size %u err %u\n", ret, size, GetLastError() );
+
+    CloseHandle( event );
+    HeapFree( GetProcessHeap(), 0, buf );
+    CloseHandle( hfile );
+}
+
 static void test_file_access(void)
 {
     static const struct
@@ -5188,6 +5332,8 @@ START_TEST(file)
     test_OpenFileById();
     test_SetFileValidData();
     test_WriteFileGather();
+    test_overlapped_completion_port();
+    test_overlapped_read_result();
     test_file_access();
     test_GetFinalPathNameByHandleA();
     test_GetFinalPathNameByHandleW();
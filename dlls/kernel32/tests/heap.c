@@ -39,6 +39,7 @@
 #define HEAP_VALIDATE_PARAMS  0x40000000
 
 static BOOL (WINAPI *pHeapQueryInformation)(HANDLE, HEAP_INFORMATION_CLASS, PVOID, SIZE_T, PSIZE_T);
+static BOOL (WINAPI *pHeapSetInformation)(HANDLE, HEAP_INFORMATION_CLASS, PVOID, SIZE_T);
 static BOOL (WINAPI *pGetPhysicallyInstalledSystemMemory)(ULONGLONG *);
 static ULONG (WINAPI *pRtlGetNtGlobalFlags)(void);
 
@@ -892,6 +893,145 @@ static void test_HeapQueryInformation(void)
     ok(info == 0 || info == 1 || info == 2, "expected 0, 1 or 2, got %u\n", info);
 }
 
+struct alloc_stress
+{
+    HANDLE heap;
+    LONG   failures;
+};
+
+static DWORD WINAPI alloc_stress_thread( void *arg )
+{
+    struct alloc_stress *stress = arg;
+    BYTE *blocks[64];
+    LONG i;
+    UINT j;
+
+    for (i = 0; i < 200; i++)
+    {
+        for (j = 0; j < ARRAY_SIZE(blocks); j++)
+        {
+            SIZE_T size = 8 + (j * 40) % 1000;
+            if (!(blocks[j] = HeapAlloc( stress->heap, 0, size ))) InterlockedIncrement( &stress->failures );
+            else blocks[j][size - 1] = j;
+        }
+        for (j = 0; j < ARRAY_SIZE(blocks); j++)
+        {
+            SIZE_T size = 8 + (j * 40) % 1000;
+            if (!blocks[j]) continue;
+            if (blocks[j][size - 1] != j) InterlockedIncrement( &stress->failures );
+            if (!HeapFree( stress->heap, 0, blocks[j] )) InterlockedIncrement( &stress->failures );
+        }
+    }
+    return 0;
+}
+
+/* allocate and free blocks of various sizes from several threads at once */
+static void test_alloc_stress( HANDLE heap, const char *name )
+{
+    static const unsigned int thread_counts[] = { 1, 4, 8 };
+    struct alloc_stress stress;
+    HANDLE threads[8];
+    unsigned int i, j;
+    DWORD ret;
+
+    for (i = 0; i < ARRAY_SIZE(thread_counts); i++)
+    {
+        stress.heap = heap;
+        stress.failures = 0;
+
+        for (j = 0; j < thread_counts[i]; j++)
+            threads[j] = CreateThread( NULL, 0, alloc_stress_thread, &stress, 0, NULL );
+        ret = WaitForMultipleObjects( thread_counts[i], threads, TRUE, 60000 );
+        ok( ret == WAIT_OBJECT_0, "WaitForMultipleObjects returned %u\n", ret );
+        for (j = 0; j < thread_counts[i]; j++) CloseHandle( threads[j] );
+
+        ok( !stress.failures, "%s heap, %u threads: %d failures\n", name, thread_counts[i], stress.failures );
+        ok( HeapValidate( heap, 0, NULL ), "%s heap, %u threads: heap is corrupted\n", name, thread_counts[i] );
+    }
+}
+
+static void test_low_fragmentation_heap(void)
+{
+    HANDLE heap, heap2;
+    ULONG info;
+    BYTE *p, *ptrs[100];
+    BOOL ret;
+    SIZE_T size, i;
+
+    pHeapSetInformation = (void *)GetProcAddress(GetModuleHandleA("kernel32.dll"), "HeapSetInformation");
+    if (!pHeapSetInformation || !pHeapQueryInformation)
+    {
+        win_skip("HeapSetInformation is not available\n");
+        return;
+    }
+
+    heap = HeapCreate( 0, 0, 0 );
+    ok( heap != NULL, "HeapCreate failed\n" );
+    test_alloc_stress( heap, "standard" );
+
+    info = 2;
+    ret = pHeapSetInformation( heap, HeapCompatibilityInformation, &info, sizeof(info) );
+    ok( ret, "HeapSetInformation error %u\n", GetLastError() );
+    info = 0xdeadbeef;
+    ret = pHeapQueryInformation( heap, HeapCompatibilityInformation, &info, sizeof(info), NULL );
+    ok( ret, "HeapQueryInformation error %u\n", GetLastError() );
+    ok( info == 2, "expected 2, got %u\n", info );
+
+    /* blocks from the front end behave like regular ones */
+    for (i = 0; i < 100; i++)
+    {
+        p = HeapAlloc( heap, HEAP_ZERO_MEMORY, 100 );
+        ok( p != NULL, "HeapAlloc failed\n" );
+        ok( !p[0] && !p[99], "block not zeroed\n" );
+        size = HeapSize( heap, 0, p );
+        ok( size == 100, "got size %lu\n", size );
+        memset( p, 0xcc, 100 );
+        p = HeapReAlloc( heap, 0, p, 200 );
+        ok( p != NULL, "HeapReAlloc failed\n" );
+        ok( p[99] == 0xcc, "got %#x\n", p[99] );
+        size = HeapSize( heap, 0, p );
+        ok( size == 200, "got size %lu\n", size );
+        ret = HeapFree( heap, 0, p );
+        ok( ret, "HeapFree failed\n" );
+    }
+    ok( HeapValidate( heap, 0, NULL ), "heap is corrupted\n" );
+
+    test_alloc_stress( heap, "low-fragmentation" );
+    ok( HeapValidate( heap, 0, NULL ), "heap is corrupted\n" );
+
+    /* blocks of another heap are not recycled by the front end */
+    heap2 = HeapCreate( 0, 0, 0 );
+    ok( heap2 != NULL, "HeapCreate failed\n" );
+    info = 2;
+    ret = pHeapSetInformation( heap2, HeapCompatibilityInformation, &info, sizeof(info) );
+    ok( ret, "HeapSetInformation error %u\n", GetLastError() );
+    p = HeapAlloc( heap2, 0, 100 );
+    ok( p != NULL, "HeapAlloc failed\n" );
+    ret = HeapFree( heap, 0, p );
+    ok( !ret || broken(ret), "HeapFree succeeded for a block of another heap\n" );
+    for (i = 0; i < 100; i++)
+    {
+        ptrs[i] = HeapAlloc( heap, 0, 100 );
+        ok( ptrs[i] != NULL, "HeapAlloc failed\n" );
+        ok( ptrs[i] != p, "got block %p of the other heap\n", p );
+    }
+    for (i = 0; i < 100; i++) HeapFree( heap, 0, ptrs[i] );
+    ok( HeapValidate( heap2, 0, p ), "block of the other heap is corrupted\n" );
+    ret = HeapFree( heap2, 0, p );
+    ok( ret, "HeapFree failed\n" );
+    ok( HeapValidate( heap, 0, NULL ), "heap is corrupted\n" );
+    ok( HeapValidate( heap2, 0, NULL ), "heap is corrupted\n" );
+    HeapDestroy( heap2 );
+    HeapDestroy( heap );
+
+    heap = HeapCreate( HEAP_NO_SERIALIZE, 0, 0 );
+    ok( heap != NULL, "HeapCreate failed\n" );
+    info = 2;
+    ret = pHeapSetInformation( heap, HeapCompatibilityInformation, &info, sizeof(info) );
+    ok( !ret, "HeapSetInformation succeeded on a HEAP_NO_SERIALIZE heap\n" );
+    HeapDestroy( heap );
+}
+
 static void test_heap_checks( DWORD flags )
 {
     BYTE old, *p, *p2;
@@ -1245,6 +1385,7 @@ START_TEST(heap)
     test_sized_HeapReAlloc((1 << 20), 1);
 
     test_HeapQueryInformation();
+    test_low_fragmentation_heap();
     test_GetPhysicallyInstalledSystemMemory();
 
     if (pRtlGetNtGlobalFlags)
@@ -1377,6 +1377,57 @@ static void test_filenames(void)
     DeleteFileA( long_path );
 }
 
+static void test_module_lookup(void)
+{
+    IMAGE_NT_HEADERS nt_header = nt_header_template;
+    char (*dll_names)[MAX_PATH], buffer[MAX_PATH];
+    HMODULE *mods, mod;
+    int i, count = 50;
+
+    nt_header.FileHeader.NumberOfSections = 1;
+    nt_header.FileHeader.SizeOfOptionalHeader = sizeof(IMAGE_OPTIONAL_HEADER);
+
+    nt_header.OptionalHeader.SectionAlignment = page_size;
+    nt_header.OptionalHeader.DllCharacteristics = IMAGE_DLLCHARACTERISTICS_NX_COMPAT;
+    nt_header.OptionalHeader.FileAlignment = page_size;
+    nt_header.OptionalHeader.SizeOfHeaders = sizeof(dos_header) + sizeof(nt_header) + sizeof(IMAGE_SECTION_HEADER);
+    nt_header.OptionalHeader.SizeOfImage = sizeof(dos_header) + sizeof(nt_header) + sizeof(IMAGE_SECTION_HEADER) + page_size;
+
+    dll_names = HeapAlloc( GetProcessHeap(), 0, count * sizeof(*dll_names) );
+    mods = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, count * sizeof(*mods) );
+    for (i = 0; i < count; i++) create_test_dll( &dos_header, sizeof(dos_header), &nt_header, dll_names[i] );
+
+    for (i = 0; i < count; i++)
+    {
+        mods[i] = LoadLibraryA( dll_names[i] );
+        ok( mods[i] != NULL, "%d: loading failed err %u\n", i, GetLastError() );
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (!mods[i]) continue;
+        mod = GetModuleHandleA( dll_names[i] );
+        ok( mod == mods[i], "%d: wrong module %p / %p\n", i, mod, mods[i] );
+        mod = GetModuleHandleA( strrchr( dll_names[i], '\\' ) + 1 );
+        ok( mod == mods[i], "%d: wrong module %p / %p\n", i, mod, mods[i] );
+        GetModuleFileNameA( mods[i], buffer, MAX_PATH );
+        ok( !lstrcmpiA( buffer, dll_names[i] ), "%d: got wrong path %s / %s\n", i, buffer, dll_names[i] );
+    }
+
+    for (i = count - 1; i >= 0; i--)
+    {
+        if (mods[i])
+        {
+            FreeLibrary( mods[i] );
+            mod = GetModuleHandleA( dll_names[i] );
+            ok( !mod, "%d: module %p still loaded\n", i, mod );
+        }
+        DeleteFileA( dll_names[i] );
+    }
+    HeapFree( GetProcessHeap(), 0, mods );
+    HeapFree( GetProcessHeap(), 0, dll_names );
+}
+
 static void test_FakeDLL(void)
 {
 #if defined(__i386__) || defined(__x86_64__)
@@ -3818,4 +3869,5 @@ START_TEST(loader)
     test_import_resolution();
     test_ExitProcess();
     test_InMemoryOrderModuleList();
+    test_module_lookup();
 }
@@ -2636,6 +2636,108 @@ static void test_apc_deadlock(void)
     CloseHandle(pi.hProcess);
 }
 
+struct contention_params
+{
+    HANDLE handle;
+    int type;
+    BOOL alertable;
+    LONG *owner;
+    LONG errors;
+};
+
+static DWORD WINAPI contention_thread(void *arg)
+{
+    struct contention_params *params = arg;
+    LONG id = GetCurrentThreadId();
+    DWORD ret;
+    int i;
+
+    for (i = 0; i < 2000; i++)
+    {
+        ret = WaitForSingleObjectEx(params->handle, INFINITE, params->alertable);
+        ok(ret == WAIT_OBJECT_0, "WaitForSingleObjectEx returned %u\n", ret);
+        if (InterlockedExchange(params->owner, id)) params->errors++;
+        Sleep(0);
+        if (InterlockedExchange(params->owner, 0) != id) params->errors++;
+        switch (params->type)
+        {
+        case 0: ReleaseMutex(params->handle); break;
+        case 1: ReleaseSemaphore(params->handle, 1, NULL); break;
+        case 2: SetEvent(params->handle); break;
+        }
+    }
+    return 0;
+}
+
+static void test_wait_contention(void)
+{
+    struct contention_params params[4];
+    HANDLE objects[3], threads[4];
+    LONG owner;
+    int i, j;
+
+    /* alertable waits go through the server while the others may be done in-process;
+     * an object must never be acquired by both at the same time */
+    objects[0] = CreateMutexA(NULL, FALSE, NULL);
+    objects[1] = CreateSemaphoreA(NULL, 1, 1, NULL);
+    objects[2] = CreateEventA(NULL, FALSE, TRUE, NULL);
+
+    for (i = 0; i < ARRAY_SIZE(objects); i++)
+    {
+        owner = 0;
+        for (j = 0; j < ARRAY_SIZE(params); j++)
+        {
+            params[j].handle = objects[i];
+            params[j].type = i;
+            params[j].alertable = j & 1;
+            params[j].owner = &owner;
+            params[j].errors = 0;
+            threads[j] = CreateThread(NULL, 0, contention_thread, &params[j], 0, NULL);
+        }
+        WaitForMultipleObjects(ARRAY_SIZE(threads), threads, TRUE, INFINITE);
+        for (j = 0; j < ARRAY_SIZE(params); j++)
+        {
+            ok(!params[j].errors, "object %d thread %d: acquired %d times while owned\n",
+               i, j, params[j].errors);
+            CloseHandle(threads[j]);
+        }
+        CloseHandle(objects[i]);
+    }
+}
+
+static DWORD WINAPI pulse_thread(void *arg)
+{
+    return WaitForSingleObjectEx(arg, INFINITE, TRUE);
+}
+
+static void test_pulse_event(void)
+{
+    HANDLE event, thread;
+    DWORD ret, code;
+    int manual, i;
+
+    for (manual = 0; manual < 2; manual++)
+    {
+        event = CreateEventA(NULL, manual, FALSE, NULL);
+        thread = CreateThread(NULL, 0, pulse_thread, event, 0, NULL);
+
+        /* a pulse only wakes the threads that are already waiting */
+        for (i = 0; i < 100; i++)
+        {
+            PulseEvent(event);
+            if (!(ret = WaitForSingleObject(thread, 10))) break;
+        }
+        ok(ret == WAIT_OBJECT_0, "%d: thread not woken up\n", manual);
+        GetExitCodeThread(thread, &code);
+        ok(code == WAIT_OBJECT_0, "%d: wait returned %u\n", manual, code);
+        ret = WaitForSingleObject(event, 0);
+        ok(ret == WAIT_TIMEOUT, "%d: event still signaled\n", manual);
+
+        CloseHandle(thread);
+        CloseHandle(event);
+    }
+}
+
 START_TEST(sync)
 {
     char **argv;
@@ -2694,4 +2796,6 @@ START_TEST(sync)
     test_srwlock_example();
     test_alertable_wait();
     test_apc_deadlock();
+    test_wait_contention();
+    test_pulse_event();
 }
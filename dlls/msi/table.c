@@ -39,7 +39,8 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(msidb);
 
-#define MSITABLE_HASH_TABLE_SIZE 37
+#define MSITABLE_HASH_TABLE_MIN_SIZE 64
+#define MSITABLE_KEY_INDEX_MIN_SIZE  64
 
 typedef struct tagMSICOLUMNHASHENTRY
 {
@@ -58,6 +59,7 @@ typedef struct tagMSICOLUMNINFO
     INT     ref_count;
     BOOL    temporary;
     MSICOLUMNHASHENTRY **hash_table;
+    UINT    hash_size;
 } MSICOLUMNINFO;
 
 struct tagMSITABLE
@@ -68,6 +70,8 @@ struct tagMSITABLE
     struct list entry;
     MSICOLUMNINFO *colinfo;
     UINT col_count;
+    UINT *key_index;      /* open addressing hash of the primary keys, row + 1 per slot */
+    UINT key_index_size;  /* number of slots, a power of two */
     MSICONDITION persistent;
     INT ref_count;
     WCHAR name[1];
@@ -369,6 +373,13 @@ static void msi_free_colinfo( MSICOLUMNINFO *colinfo, UINT count )
     for (i = 0; i < count; i++) msi_free( colinfo[i].hash_table );
 }
 
+static void free_key_index( MSITABLE *table )
+{
+    msi_free( table->key_index );
+    table->key_index = NULL;
+    table->key_index_size = 0;
+}
+
 static void free_table( MSITABLE *table )
 {
     UINT i;
@@ -378,6 +389,7 @@ static void free_table( MSITABLE *table )
     msi_free( table->data_persistent );
     msi_free_colinfo( table->colinfo, table->col_count );
     msi_free( table->colinfo );
+    msi_free( table->key_index );
     msi_free( table );
 }
 
@@ -603,6 +615,8 @@ static UINT get_table( MSIDATABASE *db, LPCWSTR name, MSITABLE **table_ret )
     table->data_persistent = NULL;
     table->colinfo = NULL;
     table->col_count = 0;
+    table->key_index = NULL;
+    table->key_index_size = 0;
     table->persistent = MSICONDITION_TRUE;
     lstrcpyW( table->name, name );
 
@@ -741,6 +755,8 @@ UINT msi_create_table( MSIDATABASE *db, LPCWSTR name, column_info *col_info,
     table->data_persistent = NULL;
     table->colinfo = NULL;
     table->col_count = 0;
+    table->key_index = NULL;
+    table->key_index_size = 0;
     table->persistent = persistent;
     lstrcpyW( table->name, name );
 
@@ -949,6 +965,7 @@ static void msi_update_table_columns( MSIDATABASE *db, LPCWSTR name )
 
     if (!(table = find_cached_table( db, name ))) return;
     old_count = table->col_count;
+    free_key_index( table );
     msi_free_colinfo( table->colinfo, table->col_count );
     msi_free( table->colinfo );
     table->colinfo = NULL;
@@ -1165,6 +1182,139 @@ static UINT TABLE_fetch_stream( struct tagMSIVIEW *view, UINT row, UINT col, ISt
     return r;
 }
 
+static inline UINT hash_key_value( UINT hash, UINT value )
+{
+    hash = (hash ^ value) * 0x9e3779b1;
+    return hash ^ (hash >> 15);
+}
+
+/* hash of the primary key columns of a row, as stored in the table */
+static UINT key_index_row_hash( MSITABLEVIEW *tv, UINT row )
+{
+    UINT i, x, hash = 0;
+
+    for (i = 0; i < tv->num_cols; i++)
+    {
+        if (~tv->columns[i].type & MSITYPE_KEY)
+            continue;
+
+        if (TABLE_fetch_int( &tv->view, row, i + 1, &x ) != ERROR_SUCCESS)
+            x = 0;
+        hash = hash_key_value( hash, x );
+    }
+    return hash;
+}
+
+/* hash of the primary key columns of a row converted by msi_record_to_row */
+static UINT key_index_data_hash( const MSITABLEVIEW *tv, const UINT *data )
+{
+    UINT i, hash = 0;
+
+    for (i = 0; i < tv->num_cols; i++)
+    {
+        if (~tv->columns[i].type & MSITYPE_KEY)
+            continue;
+
+        hash = hash_key_value( hash, data[i] );
+    }
+    return hash;
+}
+
+static void key_index_add( MSITABLE *table, UINT hash, UINT row )
+{
+    UINT mask = table->key_index_size - 1, i = hash & mask;
+
+    while (table->key_index[i])
+        i = (i + 1) & mask;
+    table->key_index[i] = row + 1;
+}
+
+static BOOL build_key_index( MSITABLEVIEW *tv )
+{
+    MSITABLE *table = tv->table;
+    UINT i, size = MSITABLE_KEY_INDEX_MIN_SIZE;
+
+    free_key_index( table );
+
+    for (i = 0; i < tv->num_cols; i++)
+        if (tv->columns[i].type & MSITYPE_KEY) break;
+    if (i == tv->num_cols)
+        return FALSE;
+
+    while (size < table->row_count * 2)
+        size <<= 1;
+
+    if (!(table->key_index = msi_alloc_zero( size * sizeof(UINT) )))
+        return FALSE;
+    table->key_index_size = size;
+
+    for (i = 0; i < table->row_count; i++)
+        key_index_add( table, key_index_row_hash( tv, i ), i );
+
+    TRACE("built key index of %u slots for %u rows of %s\n", size, table->row_count,
+          debugstr_w(table->name));
+    return TRUE;
+}
+
+/* called once a new row has been inserted at position row */
+static void key_index_insert_row( MSITABLEVIEW *tv, UINT row )
+{
+    MSITABLE *table = tv->table;
+    UINT i;
+
+    if (!table->key_index)
+        return;
+
+    if (table->row_count * 2 > table->key_index_size)
+    {
+        build_key_index( tv );
+        return;
+    }
+
+    for (i = 0; i < table->key_index_size; i++)
+        if (table->key_index[i] > row) table->key_index[i]++;
+
+    key_index_add( table, key_index_row_hash( tv, row ), row );
+}
+
+/* called before the row at position row is removed from the table */
+static void key_index_delete_row( MSITABLEVIEW *tv, UINT row )
+{
+    MSITABLE *table = tv->table;
+    UINT mask, i, j, k;
+
+    if (!table->key_index)
+        return;
+
+    mask = table->key_index_size - 1;
+    i = key_index_row_hash( tv, row ) & mask;
+    while (table->key_index[i] != row + 1)
+    {
+        if (!table->key_index[i])
+        {
+            ERR("row %u missing from the key index of %s\n", row, debugstr_w(table->name));
+            free_key_index( table );
+            return;
+        }
+        i = (i + 1) & mask;
+    }
+
+    /* close the gap, moving back entries whose probe sequence crosses it */
+    for (j = (i + 1) & mask; table->key_index[j]; j = (j + 1) & mask)
+    {
+        k = key_index_row_hash( tv, table->key_index[j] - 1 ) & mask;
+        if ((j > i && (k <= i || k > j)) || (j < i && k <= i && k > j))
+        {
+            table->key_index[i] = table->key_index[j];
+            i = j;
+        }
+    }
+    table->key_index[i] = 0;
+
+    for (i = 0; i < table->key_index_size; i++)
+        if (table->key_index[i] > row + 1) table->key_index[i]--;
+}
+
 static UINT TABLE_set_int( MSITABLEVIEW *tv, UINT row, UINT col, UINT val )
 {
     UINT offset, n, i;
@@ -1185,9 +1335,6 @@ static UINT TABLE_set_int( MSITABLEVIEW *tv, UINT row, UINT col, UINT val )
         return ERROR_FUNCTION_FAILED;
     }
 
-    msi_free( tv->columns[col-1].hash_table );
-    tv->columns[col-1].hash_table = NULL;
-
     n = bytes_per_column( tv->db, &tv->columns[col - 1], LONG_STR_BYTES );
     if ( n != 2 && n != 3 && n != 4 )
     {
@@ -1196,6 +1343,14 @@ static UINT TABLE_set_int( MSITABLEVIEW *tv, UINT row, UINT col, UINT val )
     }
 
     offset = tv->columns[col-1].offset;
+    if (read_table_int( tv->table->data, row, offset, n ) == val)
+        return ERROR_SUCCESS;
+
+    msi_free( tv->columns[col-1].hash_table );
+    tv->columns[col-1].hash_table = NULL;
+    if (tv->columns[col-1].type & MSITYPE_KEY)
+        free_key_index( tv->table );
+
     for ( i = 0; i < n; i++ )
         tv->table->data[row][offset + i] = (val >> i * 8) & 0xff;
 
@@ -1645,7 +1800,7 @@ static int find_insert_index( MSITABLEVIEW *tv, MSIRECORD *rec )
 static UINT TABLE_insert_row( struct tagMSIVIEW *view, MSIRECORD *rec, UINT row, BOOL temporary )
 {
     MSITABLEVIEW *tv = (MSITABLEVIEW*)view;
-    UINT i, r;
+    UINT i, r, *key_index;
 
     TRACE("%p %p %s\n", tv, rec, temporary ? "TRUE" : "FALSE" );
 
@@ -1662,6 +1817,17 @@ static UINT TABLE_insert_row( struct tagMSIVIEW *view, MSIRECORD *rec, UINT row,
     if( r != ERROR_SUCCESS )
         return r;
 
+    /* reset the hash tables */
+    for (i = 0; i < tv->num_cols; i++)
+    {
+        msi_free( tv->columns[i].hash_table );
+        tv->columns[i].hash_table = NULL;
+    }
+
+    /* the key index is updated once the new row has been filled in */
+    key_index = tv->table->key_index;
+    tv->table->key_index = NULL;
+
     /* shift the rows to make room for the new row */
     for (i = tv->table->row_count - 1; i > row; i--)
     {
@@ -1672,7 +1838,14 @@ static UINT TABLE_insert_row( struct tagMSIVIEW *view, MSIRECORD *rec, UINT row,
 
     /* Re-set the persistence flag */
     tv->table->data_persistent[row] = !temporary;
-    return TABLE_set_row( view, row, rec, (1<<tv->num_cols) - 1 );
+    r = TABLE_set_row( view, row, rec, (1<<tv->num_cols) - 1 );
+
+    tv->table->key_index = key_index;
+    if (r == ERROR_SUCCESS)
+        key_index_insert_row( tv, row );
+    else
+        free_key_index( tv->table );
+    return r;
 }
 
 static UINT TABLE_delete_row( struct tagMSIVIEW *view, UINT row )
@@ -1692,6 +1865,8 @@ static UINT TABLE_delete_row( struct tagMSIVIEW *view, UINT row )
     if ( row >= num_rows )
         return ERROR_FUNCTION_FAILED;
 
+    key_index_delete_row( tv, row );
+
     num_rows = tv->table->row_count;
     tv->table->row_count--;
 
@@ -1891,7 +2066,7 @@ static UINT TABLE_find_matching_rows( struct tagMSIVIEW *view, UINT col,
 
     if( !tv->columns[col-1].hash_table )
     {
-        UINT i;
+        UINT i, size = MSITABLE_HASH_TABLE_MIN_SIZE;
         UINT num_rows = tv->table->row_count;
         MSICOLUMNHASHENTRY **hash_table;
         MSICOLUMNHASHENTRY *new_entry;
@@ -1903,42 +2078,43 @@ static UINT TABLE_find_matching_rows( struct tagMSIVIEW *view, UINT col,
             return ERROR_FUNCTION_FAILED;
         }
 
+        while (size < num_rows)
+            size <<= 1;
+
         /* allocate contiguous memory for the table and its entries so we
          * don't have to do an expensive cleanup */
-        hash_table = msi_alloc(MSITABLE_HASH_TABLE_SIZE * sizeof(MSICOLUMNHASHENTRY*) +
+        hash_table = msi_alloc(size * sizeof(MSICOLUMNHASHENTRY*) +
             num_rows * sizeof(MSICOLUMNHASHENTRY));
         if (!hash_table)
             return ERROR_OUTOFMEMORY;
 
-        memset(hash_table, 0, MSITABLE_HASH_TABLE_SIZE * sizeof(MSICOLUMNHASHENTRY*));
+        memset(hash_table, 0, size * sizeof(MSICOLUMNHASHENTRY*));
         tv->columns[col-1].hash_table = hash_table;
+        tv->columns[col-1].hash_size = size;
 
-        new_entry = (MSICOLUMNHASHENTRY *)(hash_table + MSITABLE_HASH_TABLE_SIZE);
+        new_entry = (MSICOLUMNHASHENTRY *)(hash_table + size);
 
-        for (i = 0; i < num_rows; i++, new_entry++)
+        /* insert backwards so that each chain lists its rows in order */
+        for (i = num_rows; i > 0; i--, new_entry++)
         {
-            UINT row_value;
+            UINT row_value, bucket;
 
-            if (view->ops->fetch_int( view, i, col, &row_value ) != ERROR_SUCCESS)
+            if (view->ops->fetch_int( view, i - 1, col, &row_value ) != ERROR_SUCCESS)
                 continue;
 
-            new_entry->next = NULL;
+            bucket = hash_key_value( 0, row_value ) & (size - 1);
+            new_entry->next = hash_table[bucket];
             new_entry->value = row_value;
-            new_entry->row = i;
-            if (hash_table[row_value % MSITABLE_HASH_TABLE_SIZE])
-            {
-                MSICOLUMNHASHENTRY *prev_entry = hash_table[row_value % MSITABLE_HASH_TABLE_SIZE];
-                while (prev_entry->next)
-                    prev_entry = prev_entry->next;
-                prev_entry->next = new_entry;
-            }
-            else
-                hash_table[row_value % MSITABLE_HASH_TABLE_SIZE] = new_entry;
+            new_entry->row = i - 1;
+            hash_table[bucket] = new_entry;
         }
     }
 
     if( !*handle )
-        entry = tv->columns[col-1].hash_table[val % MSITABLE_HASH_TABLE_SIZE];
+    {
+        UINT size = tv->columns[col-1].hash_size;
+        entry = tv->columns[col-1].hash_table[hash_key_value( 0, val ) & (size - 1)];
+    }
     else
         entry = (*handle)->next;
 
@@ -2502,13 +2678,31 @@ static UINT msi_table_find_row( MSITABLEVIEW *tv, MSIRECORD *rec, UINT *row, UIN
     data = msi_record_to_row( tv, rec );
     if( !data )
         return r;
-    for( i = 0; i < tv->table->row_count; i++ )
+
+    if (tv->table->key_index || build_key_index( tv ))
     {
-        r = msi_row_matches( tv, i, data, column );
-        if( r == ERROR_SUCCESS )
+        UINT mask = tv->table->key_index_size - 1;
+
+        for (i = key_index_data_hash( tv, data ) & mask; tv->table->key_index[i]; i = (i + 1) & mask)
         {
-            *row = i;
-            break;
+            r = msi_row_matches( tv, tv->table->key_index[i] - 1, data, column );
+            if (r == ERROR_SUCCESS)
+            {
+                *row = tv->table->key_index[i] - 1;
+                break;
+            }
+        }
+    }
+    else
+    {
+        for( i = 0; i < tv->table->row_count; i++ )
+        {
+            r = msi_row_matches( tv, i, data, column );
+            if( r == ERROR_SUCCESS )
+            {
+                *row = i;
+                break;
+            }
         }
     }
     msi_free( data );
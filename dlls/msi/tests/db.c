@@ -9739,6 +9739,131 @@ static void test_primary_keys(void)
     DeleteFileA(msifile);
 }
 
+static void test_large_tables(void)
+{
+    UINT rows = 2000;
+    MSIHANDLE hdb, hview, hrec, hparam;
+    UINT r, i, k, count, attributes;
+    char name[32], buf[32];
+    DWORD size;
+
+    hdb = create_db();
+    ok( hdb, "failed to create db\n" );
+    create_component_table( hdb );
+    create_feature_components_table( hdb );
+
+    /* insert the components in scrambled order */
+    hparam = MsiCreateRecord( 2 );
+    r = MsiDatabaseOpenViewA( hdb, "INSERT INTO `Component` (`Component`, `ComponentId`, `Directory_`, "
+                              "`Attributes`, `Condition`, `KeyPath`) VALUES (?, '', 'TARGETDIR', ?, '', '')", &hview );
+    ok( r == ERROR_SUCCESS, "failed to open view: %u\n", r );
+    for (i = 0; i < rows; i++)
+    {
+        k = (i * 7919) % rows;
+        sprintf( name, "comp%u", k );
+        MsiRecordSetStringA( hparam, 1, name );
+        MsiRecordSetInteger( hparam, 2, k % 4 );
+        r = MsiViewExecute( hview, hparam );
+        if (r != ERROR_SUCCESS) break;
+    }
+    ok( r == ERROR_SUCCESS, "failed to insert row %u: %u\n", i, r );
+    MsiViewClose( hview );
+    MsiCloseHandle( hview );
+
+    r = MsiDatabaseOpenViewA( hdb, "INSERT INTO `FeatureComponents` (`Feature_`, `Component_`) VALUES (?, ?)", &hview );
+    ok( r == ERROR_SUCCESS, "failed to open view: %u\n", r );
+    for (i = 0; i < rows; i++)
+    {
+        sprintf( name, "feat%u", i % 10 );
+        MsiRecordSetStringA( hparam, 1, name );
+        sprintf( name, "comp%u", i );
+        MsiRecordSetStringA( hparam, 2, name );
+        r = MsiViewExecute( hview, hparam );
+        if (r != ERROR_SUCCESS) break;
+    }
+    ok( r == ERROR_SUCCESS, "failed to insert row %u: %u\n", i, r );
+    MsiViewClose( hview );
+    MsiCloseHandle( hview );
+
+    /* primary keys must stay unique */
+    r = run_query( hdb, 0, "INSERT INTO `Component` (`Component`, `ComponentId`, `Directory_`, "
+                   "`Attributes`, `Condition`, `KeyPath`) VALUES ('comp1', '', 'TARGETDIR', 0, '', '')" );
+    ok( r == ERROR_FUNCTION_FAILED, "got %u\n", r );
+
+    /* lookups by primary key */
+    r = MsiDatabaseOpenViewA( hdb, "SELECT `Attributes` FROM `Component` WHERE `Component` = ?", &hview );
+    ok( r == ERROR_SUCCESS, "failed to open view: %u\n", r );
+    for (i = 0; i < rows; i += 7)
+    {
+        sprintf( name, "comp%u", i );
+        MsiRecordSetStringA( hparam, 1, name );
+        r = MsiViewExecute( hview, hparam );
+        ok( r == ERROR_SUCCESS, "failed to execute view: %u\n", r );
+        r = MsiViewFetch( hview, &hrec );
+        ok( r == ERROR_SUCCESS, "failed to fetch %s: %u\n", name, r );
+        if (r != ERROR_SUCCESS) break;
+        attributes = MsiRecordGetInteger( hrec, 1 );
+        ok( attributes == i % 4, "%s: expected %u, got %u\n", name, i % 4, attributes );
+        MsiCloseHandle( hrec );
+        r = MsiViewFetch( hview, &hrec );
+        ok( r == ERROR_NO_MORE_ITEMS, "expected ERROR_NO_MORE_ITEMS, got %u\n", r );
+        MsiViewClose( hview );
+    }
+
+    MsiRecordSetStringA( hparam, 1, "notacomponent" );
+    r = MsiViewExecute( hview, hparam );
+    ok( r == ERROR_SUCCESS, "failed to execute view: %u\n", r );
+    r = MsiViewFetch( hview, &hrec );
+    ok( r == ERROR_NO_MORE_ITEMS, "expected ERROR_NO_MORE_ITEMS, got %u\n", r );
+    MsiViewClose( hview );
+    MsiCloseHandle( hview );
+
+    /* equality join between the two tables */
+    r = MsiDatabaseOpenViewA( hdb, "SELECT `Component`.`Component`, `Attributes` FROM `FeatureComponents`, `Component` "
+                              "WHERE `Feature_` = 'feat3' AND `Component_` = `Component`.`Component`", &hview );
+    ok( r == ERROR_SUCCESS, "failed to open view: %u\n", r );
+    r = MsiViewExecute( hview, 0 );
+    ok( r == ERROR_SUCCESS, "failed to execute view: %u\n", r );
+    count = 0;
+    while (MsiViewFetch( hview, &hrec ) == ERROR_SUCCESS)
+    {
+        size = sizeof(buf);
+        r = MsiRecordGetStringA( hrec, 1, buf, &size );
+        ok( r == ERROR_SUCCESS, "failed to get string: %u\n", r );
+        k = atoi( buf + 4 );
+        ok( k % 10 == 3, "unexpected component %s\n", buf );
+        attributes = MsiRecordGetInteger( hrec, 2 );
+        ok( attributes == k % 4, "%s: expected %u, got %u\n", buf, k % 4, attributes );
+        MsiCloseHandle( hrec );
+        count++;
+    }
+    ok( count == rows / 10, "expected %u rows, got %u\n", rows / 10, count );
+    MsiViewClose( hview );
+    MsiCloseHandle( hview );
+
+    /* the index follows deletions and insertions */
+    r = run_query( hdb, 0, "DELETE FROM `Component` WHERE `Component` = 'comp5'" );
+    ok( r == ERROR_SUCCESS, "failed to delete row: %u\n", r );
+    r = do_query( hdb, "SELECT * FROM `Component` WHERE `Component` = 'comp5'", &hrec );
+    ok( r == ERROR_NO_MORE_ITEMS, "expected ERROR_NO_MORE_ITEMS, got %u\n", r );
+    r = do_query( hdb, "SELECT `Attributes` FROM `Component` WHERE `Component` = 'comp6'", &hrec );
+    ok( r == ERROR_SUCCESS, "failed to find comp6: %u\n", r );
+    ok( MsiRecordGetInteger( hrec, 1 ) == 2, "got %d\n", MsiRecordGetInteger( hrec, 1 ) );
+    MsiCloseHandle( hrec );
+
+    r = run_query( hdb, 0, "INSERT INTO `Component` (`Component`, `ComponentId`, `Directory_`, "
+                   "`Attributes`, `Condition`, `KeyPath`) VALUES ('comp5', '', 'TARGETDIR', 3, '', '')" );
+    ok( r == ERROR_SUCCESS, "failed to insert row: %u\n", r );
+    r = do_query( hdb, "SELECT `Attributes` FROM `Component` WHERE `Component` = 'comp5'", &hrec );
+    ok( r == ERROR_SUCCESS, "failed to find comp5: %u\n", r );
+    ok( MsiRecordGetInteger( hrec, 1 ) == 3, "got %d\n", MsiRecordGetInteger( hrec, 1 ) );
+    MsiCloseHandle( hrec );
+
+    MsiCloseHandle( hparam );
+    MsiCloseHandle( hdb );
+    DeleteFileA( msifile );
+}
+
 START_TEST(db)
 {
     test_msidatabase();
@@ -9795,4 +9920,5 @@ START_TEST(db)
     test_embedded_nulls();
     test_select_column_names();
     test_primary_keys();
+    test_large_tables();
 }
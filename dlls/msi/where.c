@@ -52,6 +52,9 @@ typedef struct tagJOINTABLE
     UINT col_count;
     UINT row_count;
     UINT table_index;
+    struct expr *lookup_column; /* column of this table compared for equality */
+    struct expr *lookup_value;  /* what it is compared to */
+    UINT lookup_rec_index;      /* record field for a wildcard lookup_value */
 } JOINTABLE;
 
 typedef struct tagMSIORDERINFO
@@ -599,15 +602,100 @@ static UINT WHERE_evaluate( MSIWHEREVIEW *wv, const UINT rows[],
     return ERROR_SUCCESS;
 }
 
+/* returns the raw value to look up in the lookup column of the table, ERROR_NO_MORE_ITEMS
+ * if no row can match, or ERROR_FUNCTION_FAILED if all the rows have to be checked */
+static UINT get_lookup_value( MSIWHEREVIEW *wv, const JOINTABLE *table, MSIRECORD *record,
+                              const UINT rows[], UINT *value )
+{
+    const struct expr *column = table->lookup_column, *expr = table->lookup_value;
+    const WCHAR *str = NULL;
+    UINT r;
+
+    if (!column)
+        return ERROR_FUNCTION_FAILED;
+
+    switch (expr->type)
+    {
+    case EXPR_COL_NUMBER:
+    case EXPR_COL_NUMBER32:
+        return expr_fetch_value( &expr->u.column, rows, value );
+
+    case EXPR_COL_NUMBER_STRING:
+        r = expr_fetch_value( &expr->u.column, rows, value );
+        if (r != ERROR_SUCCESS)
+            return r;
+        str = msi_string_lookup( wv->db->strings, *value, NULL );
+        /* empty strings compare equal to null ones */
+        return (str && *str) ? ERROR_SUCCESS : ERROR_FUNCTION_FAILED;
+
+    case EXPR_UVAL:
+        *value = expr->u.uval;
+        break;
+
+    case EXPR_SVAL:
+        str = expr->u.sval;
+        break;
+
+    case EXPR_WILDCARD:
+        if (!record)
+            return ERROR_FUNCTION_FAILED;
+        if (column->type == EXPR_COL_NUMBER_STRING)
+            str = MSI_RecordGetString( record, table->lookup_rec_index );
+        else
+            *value = MSI_RecordGetInteger( record, table->lookup_rec_index );
+        break;
+
+    default:
+        return ERROR_FUNCTION_FAILED;
+    }
+
+    if (column->type == EXPR_COL_NUMBER_STRING)
+    {
+        if (!str || !*str)
+            return ERROR_FUNCTION_FAILED;
+        if (msi_string2id( wv->db->strings, str, -1, value ) != ERROR_SUCCESS)
+            return ERROR_NO_MORE_ITEMS;
+    }
+    else if (column->type == EXPR_COL_NUMBER32)
+        *value += 0x80000000;
+    else
+        *value += 0x8000;
+
+    return ERROR_SUCCESS;
+}
+
 static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, JOINTABLE **tables,
                              UINT table_rows[] )
 {
-    UINT r = ERROR_FUNCTION_FAILED;
+    JOINTABLE *table = *tables;
+    UINT *row = &table_rows[table->table_index];
+    UINT r, col = 0, value, next = ERROR_FUNCTION_FAILED;
+    MSIITERHANDLE handle = NULL;
+    BOOL lookup = FALSE;
     INT val;
 
-    for (table_rows[(*tables)->table_index] = 0;
-         table_rows[(*tables)->table_index] < (*tables)->row_count;
-         table_rows[(*tables)->table_index]++)
+    if (!table->row_count)
+        return ERROR_FUNCTION_FAILED;
+
+    r = get_lookup_value( wv, table, record, table_rows, &value );
+    if (r == ERROR_NO_MORE_ITEMS)
+        return ERROR_SUCCESS;
+
+    if (r == ERROR_SUCCESS)
+    {
+        col = table->lookup_column->u.column.parsed.column;
+        next = table->view->ops->find_matching_rows( table->view, col, value, row, &handle );
+        lookup = (next == ERROR_SUCCESS || next == ERROR_NO_MORE_ITEMS);
+    }
+    if (!lookup)
+    {
+        *row = 0;
+        next = ERROR_SUCCESS;
+    }
+
+    r = ERROR_SUCCESS;
+
+    while (next == ERROR_SUCCESS)
     {
         val = 0;
         wv->rec_index = 0;
@@ -629,8 +717,13 @@ static UINT check_condition( MSIWHEREVIEW *wv, MSIRECORD *record, JOINTABLE **ta
                 add_row (wv, table_rows);
             }
         }
+
+        if (lookup)
+            next = table->view->ops->find_matching_rows( table->view, col, value, row, &handle );
+        else if (++*row >= table->row_count)
+            next = ERROR_NO_MORE_ITEMS;
     }
-    table_rows[(*tables)->table_index] = INVALID_ROW_INDEX;
+    *row = INVALID_ROW_INDEX;
     return r;
 }
 
@@ -738,6 +831,101 @@ static UINT reorder_check( const struct expr *expr, JOINTABLE **ordered_tables,
     }
 }
 
+static UINT count_wildcards( const struct expr *expr )
+{
+    switch (expr->type)
+    {
+    case EXPR_WILDCARD:
+        return 1;
+    case EXPR_COMPLEX:
+    case EXPR_STRCMP:
+        return count_wildcards( expr->u.expr.left ) + count_wildcards( expr->u.expr.right );
+    default:
+        return 0;
+    }
+}
+
+static BOOL is_column_of( const struct expr *expr, const JOINTABLE *table )
+{
+    return (expr->type == EXPR_COL_NUMBER || expr->type == EXPR_COL_NUMBER32 ||
+            expr->type == EXPR_COL_NUMBER_STRING) && expr->u.column.parsed.table == table;
+}
+
+/* checks if column (from tables[level]) = value can be used to look up rows,
+ * given that the rows of the tables before it are already known */
+static BOOL is_lookup( const struct expr *column, const struct expr *value, JOINTABLE **tables, UINT level )
+{
+    UINT i, type;
+
+    if (!is_column_of( column, tables[level] ))
+        return FALSE;
+
+    /* streams can't be looked up by value */
+    if (tables[level]->view->ops->get_column_info( tables[level]->view, column->u.column.parsed.column,
+                                                   NULL, &type, NULL, NULL ) != ERROR_SUCCESS ||
+        MSITYPE_IS_BINARY(type))
+        return FALSE;
+
+    switch (value->type)
+    {
+    case EXPR_UVAL:
+        return column->type != EXPR_COL_NUMBER_STRING;
+    case EXPR_SVAL:
+        return column->type == EXPR_COL_NUMBER_STRING;
+    case EXPR_WILDCARD:
+        return TRUE;
+    default:
+        if (value->type != column->type)
+            return FALSE;
+        for (i = 0; i < level; i++)
+            if (is_column_of( value, tables[i] )) return TRUE;
+        return FALSE;
+    }
+}
+
+/* looks for an equality in the top level conjunctions of the condition
+ * that allows finding the matching rows of tables[level] through a hash lookup */
+static void find_lookup( struct expr *cond, JOINTABLE **tables, UINT level, UINT *rec_index )
+{
+    JOINTABLE *table = tables[level];
+
+    switch (cond->type)
+    {
+    case EXPR_COMPLEX:
+        if (cond->u.expr.op == OP_AND)
+        {
+            find_lookup( cond->u.expr.left, tables, level, rec_index );
+            find_lookup( cond->u.expr.right, tables, level, rec_index );
+            return;
+        }
+        if (cond->u.expr.left->type == EXPR_COL_NUMBER_STRING ||
+            cond->u.expr.right->type == EXPR_COL_NUMBER_STRING)
+            break;
+        /* fall through */
+    case EXPR_STRCMP:
+        if (cond->u.expr.op != OP_EQ || table->lookup_column)
+            break;
+
+        /* one side is a column, so a wildcard is the next one evaluated */
+        if (is_lookup( cond->u.expr.left, cond->u.expr.right, tables, level ))
+        {
+            table->lookup_column = cond->u.expr.left;
+            table->lookup_value = cond->u.expr.right;
+            table->lookup_rec_index = *rec_index + 1;
+        }
+        else if (is_lookup( cond->u.expr.right, cond->u.expr.left, tables, level ))
+        {
+            table->lookup_column = cond->u.expr.right;
+            table->lookup_value = cond->u.expr.left;
+            table->lookup_rec_index = *rec_index + 1;
+        }
+        break;
+    default:
+        break;
+    }
+    *rec_index += count_wildcards( cond );
+}
+
 /* reorders the tablelist in a way to evaluate the condition as fast as possible */
 static JOINTABLE **ordertables( MSIWHEREVIEW *wv )
 {
@@ -800,6 +988,15 @@ static UINT WHERE_execute( struct tagMSIVIEW *view, MSIRECORD *record )
 
     ordered_tables = ordertables( wv );
 
+    for (i = 0; ordered_tables[i]; i++)
+    {
+        UINT rec_index = 0;
+
+        ordered_tables[i]->lookup_column = NULL;
+        if (wv->cond)
+            find_lookup( wv->cond, ordered_tables, i, &rec_index );
+    }
+
     rows = msi_alloc( wv->table_count * sizeof(*rows) );
     for (i = 0; i < wv->table_count; i++)
         rows[i] = INVALID_ROW_INDEX;
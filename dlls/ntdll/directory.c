@@ -91,6 +91,9 @@
 #ifdef HAVE_SYS_STATFS_H
 #include <sys/statfs.h>
 #endif
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#endif
 #include <time.h>
 #ifdef HAVE_UNISTD_H
 # include <unistd.h>
@@ -112,6 +115,7 @@
 #include "wine/exception.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(file);
+WINE_DECLARE_DEBUG_CHANNEL(dirindex);
 
 /* just in case... */
 #undef VFAT_IOCTL_READDIR_BOTH
@@ -2209,6 +2213,329 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event,
 }
 
 
+/* case-insensitive index of the names in a directory, to avoid scanning big directories */
+
+#define DIR_INDEX_MAX_DIRS    256
+#define DIR_INDEX_MAX_MEMORY  (32 * 1024 * 1024)
+
+struct dir_index_entry
+{
+    struct dir_index_entry *next;
+    unsigned int            hash;
+    unsigned int            len;        /* length of the case-folded name */
+    const char             *unix_name;
+    WCHAR                   name[1];    /* case-folded name, followed by the Unix name */
+};
+
+struct dir_index
+{
+    struct list              entry;     /* entry in the LRU list */
+    dev_t                    dev;       /* directory identity */
+    ino_t                    ino;
+    time_t                   mtime;     /* directory modification time when the index was built */
+    long                     mtime_nsec;
+    int                      wd;        /* inotify watch descriptor, or -1 */
+    BOOL                     valid;
+    unsigned int             size;      /* memory used by the index */
+    unsigned int             count;     /* number of names */
+    unsigned int             hash_size; /* size of the hash table, a power of 2 */
+    struct dir_index_entry **hash;
+};
+
+static struct list dir_index_list = LIST_INIT( dir_index_list );
+static unsigned int dir_index_count;
+static unsigned int dir_index_memory;
+static unsigned int dir_index_lookups, dir_index_hits, dir_index_builds;
+static int dir_index_notify_fd = -1;  /* -2 if inotify is not available */
+
+static RTL_CRITICAL_SECTION dir_index_section;
+static RTL_CRITICAL_SECTION_DEBUG dir_index_critsect_debug =
+{
+    0, 0, &dir_index_section,
+    { &dir_index_critsect_debug.ProcessLocksList, &dir_index_critsect_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": dir_index_section") }
+};
+static RTL_CRITICAL_SECTION dir_index_section = { &dir_index_critsect_debug, -1, 0, 0, 0, 0 };
+
+static inline long get_mtime_nsec( const struct stat *st )
+{
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    return st->st_mtim.tv_nsec;
+#elif defined(HAVE_STRUCT_STAT_ST_MTIMESPEC)
+    return st->st_mtimespec.tv_nsec;
+#else
+    return 0;
+#endif
+}
+
+/* hash a case-folded name */
+static inline unsigned int hash_folded_name( const WCHAR *name, unsigned int len )
+{
+    unsigned int i, hash = 0;
+
+    for (i = 0; i < len; i++) hash = hash * 65599 + name[i];
+    return hash;
+}
+
+/* free a directory index; dir_index_section must be held */
+static void free_dir_index( struct dir_index *index )
+{
+    struct dir_index_entry *entry, *next;
+    unsigned int i;
+
+    for (i = 0; i < index->hash_size; i++)
+    {
+        for (entry = index->hash[i]; entry; entry = next)
+        {
+            next = entry->next;
+            RtlFreeHeap( GetProcessHeap(), 0, entry );
+        }
+    }
+#ifdef HAVE_SYS_INOTIFY_H
+    if (index->wd != -1) inotify_rm_watch( dir_index_notify_fd, index->wd );
+#endif
+    list_remove( &index->entry );
+    dir_index_count--;
+    dir_index_memory -= index->size;
+    RtlFreeHeap( GetProcessHeap(), 0, index->hash );
+    RtlFreeHeap( GetProcessHeap(), 0, index );
+}
+
+/* find the index of a directory; dir_index_section must be held */
+static struct dir_index *get_dir_index( const struct stat *st )
+{
+    struct dir_index *index;
+
+    LIST_FOR_EACH_ENTRY( index, &dir_index_list, struct dir_index, entry )
+        if (index->dev == st->st_dev && index->ino == st->st_ino) return index;
+    return NULL;
+}
+
+/* add an inotify watch on a directory; dir_index_section must be held */
+static int watch_dir_index( const char *unix_name )
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    if (dir_index_notify_fd == -1)
+    {
+        if ((dir_index_notify_fd = inotify_init()) != -1)
+        {
+            fcntl( dir_index_notify_fd, F_SETFD, FD_CLOEXEC );
+            fcntl( dir_index_notify_fd, F_SETFL, O_NONBLOCK );
+        }
+        else dir_index_notify_fd = -2;
+    }
+    if (dir_index_notify_fd >= 0)
+        return inotify_add_watch( dir_index_notify_fd, unix_name,
+                                  IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                  IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR );
+#endif
+    return -1;
+}
+
+/* invalidate the indexes of the directories that changed; dir_index_section must be held */
+static void process_dir_index_events(void)
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    char buffer[4096];
+    struct dir_index *index;
+    ssize_t size;
+    size_t pos;
+
+    if (dir_index_notify_fd < 0) return;
+
+    while ((size = read( dir_index_notify_fd, buffer, sizeof(buffer) )) > 0)
+    {
+        for (pos = 0; pos + sizeof(struct inotify_event) <= size; )
+        {
+            const struct inotify_event *event = (const struct inotify_event *)(buffer + pos);
+
+            LIST_FOR_EACH_ENTRY( index, &dir_index_list, struct dir_index, entry )
+            {
+                if (index->wd != event->wd) continue;
+                index->valid = FALSE;
+                if (event->mask & IN_IGNORED) index->wd = -1;
+                break;
+            }
+            pos += sizeof(*event) + event->len;
+        }
+    }
+#endif
+}
+
+/* add a name to a directory index, growing the hash table as needed */
+static BOOL add_dir_index_entry( struct dir_index *index, const WCHAR *name, unsigned int len,
+                                 const char *unix_name )
+{
+    struct dir_index_entry *entry, **next;
+    unsigned int i, hash, size, unix_len = strlen( unix_name ) + 1;
+
+    if (index->count >= index->hash_size)
+    {
+        unsigned int new_size = index->hash_size ? index->hash_size * 2 : 64;
+        struct dir_index_entry **new_hash;
+
+        if (!(new_hash = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, new_size * sizeof(*new_hash) )))
+            return FALSE;
+        /* preserve the order of the chains so that the first entry read stays first */
+        for (i = 0; i < index->hash_size; i++)
+        {
+            while ((entry = index->hash[i]))
+            {
+                index->hash[i] = entry->next;
+                for (next = &new_hash[entry->hash & (new_size - 1)]; *next; next = &(*next)->next) ;
+                entry->next = NULL;
+                *next = entry;
+            }
+        }
+        index->size += (new_size - index->hash_size) * sizeof(*new_hash);
+        RtlFreeHeap( GetProcessHeap(), 0, index->hash );
+        index->hash = new_hash;
+        index->hash_size = new_size;
+    }
+
+    hash = hash_folded_name( name, len );
+    for (next = &index->hash[hash & (index->hash_size - 1)]; *next; next = &(*next)->next)
+    {
+        /* keep the first one if several names differ only by case */
+        if ((*next)->hash == hash && (*next)->len == len && !memcmp( (*next)->name, name, len * sizeof(WCHAR) ))
+            return TRUE;
+    }
+
+    size = FIELD_OFFSET( struct dir_index_entry, name[len] ) + unix_len;
+    if (!(entry = RtlAllocateHeap( GetProcessHeap(), 0, size ))) return FALSE;
+    entry->next = NULL;
+    entry->hash = hash;
+    entry->len = len;
+    memcpy( entry->name, name, len * sizeof(WCHAR) );
+    entry->unix_name = (char *)&entry->name[len];
+    memcpy( (char *)entry->unix_name, unix_name, unix_len );
+    *next = entry;
+    index->count++;
+    index->size += size;
+    return TRUE;
+}
+
+/* build the index of a directory; dir_index_section must be held */
+static struct dir_index *build_dir_index( const char *unix_name, const struct stat *st )
+{
+    WCHAR buffer[MAX_DIR_ENTRY_LEN];
+    struct dir_index *index;
+    struct dirent *de;
+    DIR *dir;
+    int i, len;
+
+    if (!(index = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*index) ))) return NULL;
+    index->dev = st->st_dev;
+    index->ino = st->st_ino;
+    index->mtime = st->st_mtime;
+    index->mtime_nsec = get_mtime_nsec( st );
+    index->size = sizeof(*index);
+    index->valid = TRUE;
+    /* start watching before reading the directory so that no change is missed */
+    index->wd = watch_dir_index( unix_name );
+    list_add_head( &dir_index_list, &index->entry );
+    dir_index_count++;
+
+    if (!(dir = opendir( unix_name ))) goto failed;
+    while ((de = readdir( dir )))
+    {
+        len = ntdll_umbstowcs( 0, de->d_name, strlen(de->d_name), buffer, MAX_DIR_ENTRY_LEN );
+        if (len <= 0) continue;
+        for (i = 0; i < len; i++) buffer[i] = tolowerW( buffer[i] );
+        if (!add_dir_index_entry( index, buffer, len, de->d_name ) ||
+            index->size > DIR_INDEX_MAX_MEMORY / 4)
+        {
+            closedir( dir );
+            goto failed;
+        }
+    }
+    closedir( dir );
+
+    /* without inotify, a directory modified in the last second could change again
+     * without its mtime changing, so only use the index for this lookup */
+    if (index->wd == -1 && time( NULL ) - index->mtime <= 1) index->valid = FALSE;
+
+    dir_index_memory += index->size;
+    while (dir_index_count > DIR_INDEX_MAX_DIRS || dir_index_memory > DIR_INDEX_MAX_MEMORY)
+        free_dir_index( LIST_ENTRY( list_tail( &dir_index_list ), struct dir_index, entry ));
+
+    dir_index_builds++;
+    TRACE_(dirindex)( "indexed %s: %u names, %u bytes, watch %d\n",
+                      debugstr_a(unix_name), index->count, index->size, index->wd );
+    return index;
+
+failed:
+    index->size = 0;  /* not accounted yet */
+    free_dir_index( index );
+    return NULL;
+}
+
+/***********************************************************************
+ *           find_file_in_dir_index
+ *
+ * Find a file through the case-insensitive index of its directory.
+ * unix_name contains the directory name, the file found is appended at pos.
+ * Returns 1 if found, 0 if the file doesn't exist, -1 if the index can't be used.
+ */
+static int find_file_in_dir_index( char *unix_name, int pos, const WCHAR *name, int length )
+{
+    WCHAR folded[MAX_DIR_ENTRY_LEN];
+    struct dir_index_entry *entry;
+    struct dir_index *index;
+    struct stat st;
+    unsigned int hash;
+    int i, ret = 0;
+
+    if (length > MAX_DIR_ENTRY_LEN || stat( unix_name, &st ) == -1) return -1;
+    for (i = 0; i < length; i++) folded[i] = tolowerW( name[i] );
+    hash = hash_folded_name( folded, length );
+
+    RtlEnterCriticalSection( &dir_index_section );
+
+    process_dir_index_events();
+    dir_index_lookups++;
+
+    if ((index = get_dir_index( &st )))
+    {
+        if (index->valid && index->mtime == st.st_mtime && index->mtime_nsec == get_mtime_nsec( &st ))
+        {
+            dir_index_hits++;
+            list_remove( &index->entry );
+            list_add_head( &dir_index_list, &index->entry );
+        }
+        else
+        {
+            free_dir_index( index );
+            index = NULL;
+        }
+    }
+
+    if (!index && !(index = build_dir_index( unix_name, &st )))
+    {
+        RtlLeaveCriticalSection( &dir_index_section );
+        return -1;
+    }
+
+    for (entry = index->hash[hash & (index->hash_size - 1)]; entry; entry = entry->next)
+    {
+        if (entry->hash != hash || entry->len != length) continue;
+        if (memcmp( entry->name, folded, length * sizeof(WCHAR) )) continue;
+        unix_name[pos - 1] = '/';
+        strcpy( unix_name + pos, entry->unix_name );
+        ret = 1;
+        break;
+    }
+    if (!index->valid) free_dir_index( index );
+
+    if (!(dir_index_lookups % 1024))
+        TRACE_(dirindex)( "%u lookups, %u hits, %u builds, %u dirs, %u bytes\n", dir_index_lookups,
+                          dir_index_hits, dir_index_builds, dir_index_count, dir_index_memory );
+
+    RtlLeaveCriticalSection( &dir_index_section );
+    return ret;
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -2260,6 +2587,18 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
 
     if (!is_name_8_dot_3 && !get_dir_case_sensitivity( unix_name )) goto not_found;
 
+    /* try the directory index, only names that may be mangled short names
+     * of other files still require a full scan */
+
+    switch (find_file_in_dir_index( unix_name, pos, name, length ))
+    {
+    case 1:
+        goto success;
+    case 0:
+        if (!is_name_8_dot_3 || !memchrW( name, '~', length )) goto not_found;
+        break;
+    }
+
     /* now look for it through the directory */
 
 #ifdef VFAT_IOCTL_READDIR_BOTH
@@ -0,0 +1,593 @@
+/*
+ * eventfd-based synchronization objects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "config.h"
+#include "wine/port.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_POLL_H
+# include <poll.h>
+#endif
+#ifdef HAVE_SYS_POLL_H
+# include <sys/poll.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#include "windef.h"
+#include "winternl.h"
+#include "wine/library.h"
+#include "wine/server.h"
+#include "wine/debug.h"
+#include "ntdll_misc.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(esync);
+
+/* Events, semaphores and mutexes created by a server running with WINEESYNC
+ * set carry an eventfd and a slot in a shared state file (see server/esync.c).
+ * Waiting on and signaling them is then done entirely in-process; anything
+ * that can't be handled that way (alertable waits, other object types) falls
+ * back to the server, which keeps working on the same shared state. */
+
+struct esync_obj
+{
+    enum esync_type     type;
+    int                 fd;
+    struct esync_state *state;
+};
+
+union esync_cache_entry
+{
+    LONG64 data;
+    struct
+    {
+        int          fd;
+        unsigned int type : 3;
+        unsigned int wait : 1;      /* handle has SYNCHRONIZE access */
+        unsigned int modify : 1;    /* handle has the object-specific modify access */
+        unsigned int valid : 1;
+        unsigned int shm_idx : 26;
+    } s;
+};
+
+C_ASSERT( sizeof(union esync_cache_entry) == sizeof(LONG64) );
+
+#define ESYNC_CACHE_BLOCK_SIZE  (65536 / sizeof(union esync_cache_entry))
+#define ESYNC_CACHE_ENTRIES     128
+
+static union esync_cache_entry *esync_cache[ESYNC_CACHE_ENTRIES];
+static struct esync_state *shm_states;
+
+static RTL_CRITICAL_SECTION esync_section;
+static RTL_CRITICAL_SECTION_DEBUG critsect_debug =
+{
+    0, 0, &esync_section,
+    { &critsect_debug.ProcessLocksList, &critsect_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": esync_section") }
+};
+static RTL_CRITICAL_SECTION esync_section = { &critsect_debug, -1, 0, 0, 0, 0 };
+
+/* atomically exchange a 64-bit value */
+static inline LONG64 interlocked_xchg64( LONG64 *dest, LONG64 val )
+{
+#ifdef _WIN64
+    return (LONG64)interlocked_xchg_ptr( (void **)dest, (void *)val );
+#else
+    LONG64 tmp = *dest;
+    while (interlocked_cmpxchg64( dest, val, tmp ) != tmp) tmp = *dest;
+    return tmp;
+#endif
+}
+
+int do_esync(void)
+{
+#ifdef HAVE_SYS_EVENTFD_H
+    static int enabled = -1;
+
+    if (enabled == -1)
+    {
+        const char *env = getenv( "WINEESYNC" );
+        enabled = env && atoi( env );
+    }
+    return enabled;
+#else
+    return 0;
+#endif
+}
+
+static inline unsigned int handle_to_index( HANDLE handle, unsigned int *entry )
+{
+    unsigned int idx = (wine_server_obj_handle(handle) >> 2) - 1;
+    *entry = idx / ESYNC_CACHE_BLOCK_SIZE;
+    return idx % ESYNC_CACHE_BLOCK_SIZE;
+}
+
+/* map the server shared state file; caller must hold esync_section */
+static BOOL map_shm_states(void)
+{
+    const char *dir = wine_get_server_dir();
+    char *path;
+    void *ptr;
+    int fd;
+
+    if (shm_states) return TRUE;
+    if (!(path = RtlAllocateHeap( GetProcessHeap(), 0, strlen(dir) + sizeof("/esync") ))) return FALSE;
+    strcpy( path, dir );
+    strcat( path, "/esync" );
+    fd = open( path, O_RDWR );
+    RtlFreeHeap( GetProcessHeap(), 0, path );
+    if (fd == -1)
+    {
+        ERR( "cannot open the esync state file, is the server running with WINEESYNC?\n" );
+        return FALSE;
+    }
+    ptr = mmap( NULL, ESYNC_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if (ptr == MAP_FAILED) return FALSE;
+    shm_states = ptr;
+    return TRUE;
+}
+
+/* add an entry to the cache; caller must hold esync_section */
+static BOOL add_to_cache( HANDLE handle, union esync_cache_entry cache )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+
+    if (entry >= ESYNC_CACHE_ENTRIES) return FALSE;
+
+    if (!esync_cache[entry])
+    {
+        void *ptr = wine_anon_mmap( NULL, ESYNC_CACHE_BLOCK_SIZE * sizeof(union esync_cache_entry),
+                                    PROT_READ | PROT_WRITE, 0 );
+        if (ptr == MAP_FAILED) return FALSE;
+        esync_cache[entry] = ptr;
+    }
+    interlocked_xchg64( &esync_cache[entry][idx].data, cache.data );
+    return TRUE;
+}
+
+static inline BOOL get_cached_entry( HANDLE handle, union esync_cache_entry *cache )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+
+    if (entry >= ESYNC_CACHE_ENTRIES || !esync_cache[entry]) return FALSE;
+    cache->data = interlocked_cmpxchg64( &esync_cache[entry][idx].data, 0, 0 );
+    return cache->s.valid;
+}
+
+/* retrieve the cache entry of a handle, asking the server if needed */
+static union esync_cache_entry get_cache_entry( HANDLE handle )
+{
+    union esync_cache_entry cache;
+    obj_handle_t fd_handle;
+    sigset_t sigset, fd_sigset;
+    int fd;
+
+    if (get_cached_entry( handle, &cache )) return cache;
+
+    server_enter_uninterrupted_section( &esync_section, &sigset );
+    if (!get_cached_entry( handle, &cache ))
+    {
+        cache.data = 0;
+        /* the fd comes through the shared fd socket, like all other received fds */
+        server_enter_fd_cache_section( &fd_sigset );
+        SERVER_START_REQ( get_esync_fd )
+        {
+            req->handle = wine_server_obj_handle( handle );
+            if (!wine_server_call( req ))
+            {
+                cache.s.valid = 1;
+                if (reply->type != ESYNC_NONE && (fd = receive_fd( &fd_handle )) != -1)
+                {
+                    assert( wine_server_ptr_handle(fd_handle) == handle );
+                    if (map_shm_states())
+                    {
+                        cache.s.fd = fd;
+                        cache.s.type = reply->type;
+                        cache.s.shm_idx = reply->shm_idx;
+                        cache.s.wait = !!(reply->access & SYNCHRONIZE);
+                        if (reply->type == ESYNC_SEMAPHORE)
+                            cache.s.modify = !!(reply->access & SEMAPHORE_MODIFY_STATE);
+                        else
+                            cache.s.modify = !!(reply->access & EVENT_MODIFY_STATE);
+                    }
+                    else close( fd );
+                }
+                /* don't cache pseudo-handles or handles beyond the cache range */
+                if (!add_to_cache( handle, cache ) && cache.s.type != ESYNC_NONE)
+                {
+                    close( cache.s.fd );
+                    cache.data = 0;
+                }
+            }
+        }
+        SERVER_END_REQ;
+        server_leave_fd_cache_section( &fd_sigset );
+    }
+    server_leave_uninterrupted_section( &esync_section, &sigset );
+    return cache;
+}
+
+static BOOL get_object( HANDLE handle, struct esync_obj *obj, BOOL *wait, BOOL *modify )
+{
+    union esync_cache_entry cache = get_cache_entry( handle );
+
+    if (!cache.s.valid || cache.s.type == ESYNC_NONE) return FALSE;
+    obj->type  = cache.s.type;
+    obj->fd    = cache.s.fd;
+    obj->state = &shm_states[cache.s.shm_idx];
+    if (wait) *wait = cache.s.wait;
+    if (modify) *modify = cache.s.modify;
+    return TRUE;
+}
+
+/***********************************************************************
+ *           esync_close
+ *
+ * Remove a handle from the cache when it gets closed.
+ */
+void esync_close( HANDLE handle )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    union esync_cache_entry cache;
+
+    if (entry >= ESYNC_CACHE_ENTRIES || !esync_cache[entry]) return;
+    cache.data = interlocked_xchg64( &esync_cache[entry][idx].data, 0 );
+    if (cache.s.valid && cache.s.type != ESYNC_NONE) close( cache.s.fd );
+}
+
+static inline int get_thread_id(void)
+{
+    return HandleToULong( NtCurrentTeb()->ClientId.UniqueThread );
+}
+
+static void wake( struct esync_obj *obj, unsigned int count )
+{
+    ULONG64 value = count;
+
+    if (write( obj->fd, &value, sizeof(value) ) == -1)
+        ERR( "write failed: %s\n", strerror( errno ));
+}
+
+/* take one wakeup off the eventfd without blocking; returns FALSE if there was none */
+static BOOL consume( struct esync_obj *obj )
+{
+    ULONG64 value;
+
+    return read( obj->fd, &value, sizeof(value) ) != -1;
+}
+
+static BOOL is_signaled( struct esync_obj *obj, int tid )
+{
+    if (obj->type == ESYNC_MUTEX) return !obj->state->value || obj->state->value == tid;
+    return obj->state->value > 0;
+}
+
+/* try to grab an object; *wakeup is set if the grab took a wakeup from the eventfd */
+static BOOL try_grab( struct esync_obj *obj, int tid, BOOL *abandoned, BOOL *wakeup )
+{
+    struct esync_state *state = obj->state;
+    int value;
+
+    *abandoned = FALSE;
+    *wakeup = FALSE;
+    switch (obj->type)
+    {
+    case ESYNC_SEMAPHORE:
+        for (value = state->value; value > 0; value = state->value)
+            if (interlocked_cmpxchg( &state->value, value - 1, value ) == value) break;
+        if (value <= 0) return FALSE;
+        break;
+    case ESYNC_AUTO_EVENT:
+        if (interlocked_cmpxchg( &state->value, 0, 1 ) != 1) return FALSE;
+        break;
+    case ESYNC_MANUAL_EVENT:
+        return state->value != 0;
+    case ESYNC_MUTEX:
+        if (state->value == tid)
+        {
+            state->count++;
+            return TRUE;
+        }
+        if (interlocked_cmpxchg( &state->value, tid, 0 )) return FALSE;
+        state->count = 1;
+        *abandoned = interlocked_xchg( &state->abandoned, 0 );
+        break;
+    default:
+        assert( 0 );
+        return FALSE;
+    }
+    *wakeup = TRUE;
+    return TRUE;
+}
+
+/* Grab an object without blocking. The eventfd is only written after the state is
+ * published, so a grab racing with it may find no wakeup to consume, and the late
+ * one is left behind. It is dropped here when the object can't be grabbed; the
+ * state is checked again afterwards in case the wakeup was a new one. */
+static BOOL grab( struct esync_obj *obj, int tid, BOOL *abandoned )
+{
+    BOOL wakeup;
+
+    if (try_grab( obj, tid, abandoned, &wakeup ))
+    {
+        if (wakeup) consume( obj );
+        return TRUE;
+    }
+    if (!consume( obj ) || !try_grab( obj, tid, abandoned, &wakeup )) return FALSE;
+    if (!wakeup) wake( obj, 1 );  /* the object keeps its wakeup */
+    return TRUE;
+}
+
+/* same as grab() for objects that are only checked */
+static BOOL check_signaled( struct esync_obj *obj, int tid )
+{
+    if (is_signaled( obj, tid )) return TRUE;
+    if (!consume( obj ) || !is_signaled( obj, tid )) return FALSE;
+    wake( obj, 1 );
+    return TRUE;
+}
+
+/* give back an object grabbed during a failed wait-all attempt */
+static void ungrab( struct esync_obj *obj, BOOL abandoned )
+{
+    struct esync_state *state = obj->state;
+
+    switch (obj->type)
+    {
+    case ESYNC_SEMAPHORE:
+        interlocked_xchg_add( &state->value, 1 );
+        wake( obj, 1 );
+        break;
+    case ESYNC_AUTO_EVENT:
+        if (!interlocked_xchg( &state->value, 1 )) wake( obj, 1 );
+        break;
+    case ESYNC_MUTEX:
+        if (--state->count) break;
+        if (abandoned) state->abandoned = 1;
+        state->value = 0;
+        wake( obj, 1 );
+        break;
+    default:
+        break;
+    }
+}
+
+/***********************************************************************
+ *           esync_wait_objects
+ *
+ * Wait in-process on esync objects. Returns STATUS_NOT_IMPLEMENTED if the
+ * wait has to be done by the server.
+ */
+NTSTATUS esync_wait_objects( DWORD count, const HANDLE *handles, BOOLEAN wait_any,
+                             BOOLEAN alertable, const LARGE_INTEGER *timeout )
+{
+    struct esync_obj objs[MAXIMUM_WAIT_OBJECTS];
+    struct pollfd fds[MAXIMUM_WAIT_OBJECTS];
+    BOOL abandoned[MAXIMUM_WAIT_OBJECTS];
+    LARGE_INTEGER now;
+    timeout_t end = TIMEOUT_INFINITE;
+    int tid = get_thread_id();
+    DWORD i, j, nb_fds;
+    BOOL wait;
+
+    if (!do_esync() || alertable) return STATUS_NOT_IMPLEMENTED;
+    if (!count || count > MAXIMUM_WAIT_OBJECTS) return STATUS_NOT_IMPLEMENTED;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!get_object( handles[i], &objs[i], &wait, NULL ) || !wait) return STATUS_NOT_IMPLEMENTED;
+    }
+
+    if (timeout && timeout->QuadPart != TIMEOUT_INFINITE)
+    {
+        end = timeout->QuadPart;
+        if (end < 0)
+        {
+            NtQuerySystemTime( &now );
+            end = now.QuadPart - end;
+        }
+    }
+
+    TRACE( "%u objects, wait_any %u, end %s\n", count, wait_any, wine_dbgstr_longlong( end ) );
+
+    for (;;)
+    {
+        int ms = -1;
+
+        nb_fds = 0;
+        if (wait_any)
+        {
+            for (i = 0; i < count; i++)
+            {
+                if (grab( &objs[i], tid, &abandoned[i] ))
+                    return (abandoned[i] ? STATUS_ABANDONED_WAIT_0 : STATUS_WAIT_0) + i;
+                fds[nb_fds].fd = objs[i].fd;
+                fds[nb_fds].events = POLLIN;
+                nb_fds++;
+            }
+        }
+        else
+        {
+            /* only poll on the objects that are not signaled, to avoid spinning on the others */
+            for (i = 0; i < count; i++)
+            {
+                if (check_signaled( &objs[i], tid )) continue;
+                fds[nb_fds].fd = objs[i].fd;
+                fds[nb_fds].events = POLLIN;
+                nb_fds++;
+            }
+            if (!nb_fds)
+            {
+                BOOL any_abandoned = FALSE;
+
+                for (i = 0; i < count; i++)
+                {
+                    if (!grab( &objs[i], tid, &abandoned[i] )) break;
+                    any_abandoned |= abandoned[i];
+                }
+                if (i == count) return any_abandoned ? STATUS_ABANDONED_WAIT_0 : STATUS_WAIT_0;
+                for (j = 0; j < i; j++) ungrab( &objs[j], abandoned[j] );
+                /* someone got ahead of us, wait for that one object */
+                fds[nb_fds].fd = objs[i].fd;
+                fds[nb_fds].events = POLLIN;
+                nb_fds++;
+            }
+        }
+
+        if (end != TIMEOUT_INFINITE)
+        {
+            NtQuerySystemTime( &now );
+            if (now.QuadPart >= end) return STATUS_TIMEOUT;
+            ms = (end - now.QuadPart + 9999) / 10000;
+        }
+
+        if (poll( fds, nb_fds, ms ) == -1 && errno != EINTR)
+        {
+            ERR( "poll failed: %s\n", strerror( errno ));
+            return STATUS_NOT_IMPLEMENTED;
+        }
+    }
+}
+
+/***********************************************************************
+ *           esync_set_event
+ */
+NTSTATUS esync_set_event( HANDLE handle )
+{
+    struct esync_obj obj;
+    BOOL modify;
+
+    if (!do_esync()) return STATUS_NOT_IMPLEMENTED;
+    if (!get_object( handle, &obj, NULL, &modify ) || !modify) return STATUS_NOT_IMPLEMENTED;
+    if (obj.type != ESYNC_AUTO_EVENT && obj.type != ESYNC_MANUAL_EVENT) return STATUS_OBJECT_TYPE_MISMATCH;
+
+    if (!interlocked_xchg( &obj.state->value, 1 )) wake( &obj, 1 );
+    return STATUS_SUCCESS;
+}
+
+/***********************************************************************
+ *           esync_reset_event
+ */
+NTSTATUS esync_reset_event( HANDLE handle )
+{
+    struct esync_obj obj;
+    BOOL modify;
+
+    if (!do_esync()) return STATUS_NOT_IMPLEMENTED;
+    if (!get_object( handle, &obj, NULL, &modify ) || !modify) return STATUS_NOT_IMPLEMENTED;
+    if (obj.type != ESYNC_AUTO_EVENT && obj.type != ESYNC_MANUAL_EVENT) return STATUS_OBJECT_TYPE_MISMATCH;
+
+    if (interlocked_xchg( &obj.state->value, 0 )) consume( &obj );
+    return STATUS_SUCCESS;
+}
+
+/***********************************************************************
+ *           esync_release_semaphore
+ */
+NTSTATUS esync_release_semaphore( HANDLE handle, ULONG count, ULONG *prev )
+{
+    struct esync_obj obj;
+    unsigned int value, tmp;
+    BOOL modify;
+
+    if (!do_esync()) return STATUS_NOT_IMPLEMENTED;
+    if (!get_object( handle, &obj, NULL, &modify ) || !modify) return STATUS_NOT_IMPLEMENTED;
+    if (obj.type != ESYNC_SEMAPHORE) return STATUS_OBJECT_TYPE_MISMATCH;
+
+    for (value = obj.state->value;; value = tmp)
+    {
+        if (value + count < value || value + count > obj.state->count)
+            return STATUS_SEMAPHORE_LIMIT_EXCEEDED;
+        if ((tmp = interlocked_cmpxchg( &obj.state->value, value + count, value )) == value) break;
+    }
+    if (prev) *prev = value;
+    if (count) wake( &obj, count );
+    return STATUS_SUCCESS;
+}
+
+/***********************************************************************
+ *           esync_release_mutex
+ *
+ * Returns the previous recursion count in prev.
+ */
+NTSTATUS esync_release_mutex( HANDLE handle, unsigned int *prev )
+{
+    struct esync_obj obj;
+
+    if (!do_esync()) return STATUS_NOT_IMPLEMENTED;
+    if (!get_object( handle, &obj, NULL, NULL )) return STATUS_NOT_IMPLEMENTED;
+    if (obj.type != ESYNC_MUTEX) return STATUS_OBJECT_TYPE_MISMATCH;
+
+    if (obj.state->value != get_thread_id()) return STATUS_MUTANT_NOT_OWNED;
+    *prev = obj.state->count;
+    if (!--obj.state->count)
+    {
+        obj.state->value = 0;
+        wake( &obj, 1 );
+    }
+    return STATUS_SUCCESS;
+}
+
+/***********************************************************************
+ *           esync_signal_and_wait
+ */
+NTSTATUS esync_signal_and_wait( HANDLE signal, HANDLE wait, BOOLEAN alertable,
+                                const LARGE_INTEGER *timeout )
+{
+    struct esync_obj obj;
+    unsigned int prev;
+    NTSTATUS ret;
+    BOOL can_wait;
+
+    if (!do_esync() || alertable) return STATUS_NOT_IMPLEMENTED;
+    if (!get_object( wait, &obj, &can_wait, NULL ) || !can_wait) return STATUS_NOT_IMPLEMENTED;
+    if (!get_object( signal, &obj, NULL, NULL )) return STATUS_NOT_IMPLEMENTED;
+
+    switch (obj.type)
+    {
+    case ESYNC_SEMAPHORE:
+        ret = esync_release_semaphore( signal, 1, NULL );
+        break;
+    case ESYNC_AUTO_EVENT:
+    case ESYNC_MANUAL_EVENT:
+        ret = esync_set_event( signal );
+        break;
+    case ESYNC_MUTEX:
+        ret = esync_release_mutex( signal, &prev );
+        break;
+    default:
+        return STATUS_NOT_IMPLEMENTED;
+    }
+    if (ret) return ret;
+    return esync_wait_objects( 1, &wait, TRUE, FALSE, timeout );
+}
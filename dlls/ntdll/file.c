@@ -227,6 +227,7 @@ static NTSTATUS FILE_CreateFile( PHANDLE handle, ACCESS_MASK access, POBJECT_ATT
         OBJECT_ATTRIBUTES unix_attr = *attr;
         data_size_t len;
         struct object_attributes *objattr;
+        sigset_t sigset;
 
         unix_attr.ObjectName = &empty_string;  /* we send the unix name instead */
         if ((io->u.Status = alloc_object_attributes( &unix_attr, &objattr, &len )))
@@ -235,6 +236,8 @@ static NTSTATUS FILE_CreateFile( PHANDLE handle, ACCESS_MASK access, POBJECT_ATT
             return io->u.Status;
         }
 
+        /* the server sends the unix fd along with the reply so that it can be cached right away */
+        server_enter_fd_cache_section( &sigset );
         SERVER_START_REQ( create_file )
         {
             req->access     = access;
@@ -246,8 +249,11 @@ static NTSTATUS FILE_CreateFile( PHANDLE handle, ACCESS_MASK access, POBJECT_ATT
             wine_server_add_data( req, unix_name.Buffer, unix_name.Length );
             io->u.Status = wine_server_call( req );
             *handle = wine_server_ptr_handle( reply->handle );
+            if (!io->u.Status && reply->fd_type != FD_TYPE_INVALID)
+                server_receive_cached_fd( *handle, reply->fd_type, reply->fd_access, reply->fd_options );
         }
         SERVER_END_REQ;
+        server_leave_fd_cache_section( &sigset );
 
         /* BEGIN CODEWEAVERS HACK */
         if (created)
@@ -907,6 +913,14 @@ NTSTATUS WINAPI rpc_NtReadFile(HANDLE hFile, HANDLE hEvent,
 
         if (offset && offset->QuadPart != FILE_USE_FILE_POINTER_POSITION)
         {
+            if (async_read && !apc &&
+                uring_submit_rw( hFile, unix_handle, hEvent, io_status, cvalue,
+                                 buffer, length, offset->QuadPart, FALSE ) == STATUS_PENDING)
+            {
+                status = STATUS_PENDING;
+                goto err;
+            }
+
             /* async I/O doesn't make sense on regular files */
             while ((result = virtual_locked_pread( unix_handle, buffer, length, offset->QuadPart )) == -1)
             {
@@ -1323,6 +1337,14 @@ NTSTATUS WINAPI NtWriteFile(HANDLE hFile, HANDLE hEvent,
                 goto done;
             }
 
+            if (async_write && !apc &&
+                uring_submit_rw( hFile, unix_handle, hEvent, io_status, cvalue,
+                                 (void *)buffer, length, off, TRUE ) == STATUS_PENDING)
+            {
+                status = STATUS_PENDING;
+                goto err;
+            }
+
             /* async I/O doesn't make sense on regular files */
             while ((result = pwrite( unix_handle, buffer, length, off )) == -1)
             {
@@ -3598,8 +3620,12 @@ NTSTATUS WINAPI NtDeleteFile( POBJECT_ATTRIBUTES ObjectAttributes )
  */
 NTSTATUS WINAPI NtCancelIoFileEx( HANDLE hFile, PIO_STATUS_BLOCK iosb, PIO_STATUS_BLOCK io_status )
 {
+    unsigned int count;
+
     TRACE("%p %p %p\n", hFile, iosb, io_status );
 
+    count = uring_cancel( hFile, iosb, FALSE );
+
     SERVER_START_REQ( cancel_async )
     {
         req->handle      = wine_server_obj_handle( hFile );
@@ -3609,6 +3635,7 @@ NTSTATUS WINAPI NtCancelIoFileEx( HANDLE hFile, PIO_STATUS_BLOCK iosb, PIO_STATU
     }
     SERVER_END_REQ;
 
+    if (count && io_status->u.Status == STATUS_NOT_FOUND) io_status->u.Status = STATUS_SUCCESS;
     return io_status->u.Status;
 }
 
@@ -3619,8 +3646,12 @@ NTSTATUS WINAPI NtCancelIoFileEx( HANDLE hFile, PIO_STATUS_BLOCK iosb, PIO_STATU
  */
 NTSTATUS WINAPI NtCancelIoFile( HANDLE hFile, PIO_STATUS_BLOCK io_status )
 {
+    unsigned int count;
+
     TRACE("%p %p\n", hFile, io_status );
 
+    count = uring_cancel( hFile, NULL, TRUE );
+
     SERVER_START_REQ( cancel_async )
     {
         req->handle      = wine_server_obj_handle( hFile );
@@ -3630,6 +3661,7 @@ NTSTATUS WINAPI NtCancelIoFile( HANDLE hFile, PIO_STATUS_BLOCK io_status )
     }
     SERVER_END_REQ;
 
+    if (count && io_status->u.Status == STATUS_NOT_FOUND) io_status->u.Status = STATUS_SUCCESS;
     return io_status->u.Status;
 }
 
@@ -83,6 +83,7 @@ typedef struct
 /* Value for arena 'magic' field */
 #define ARENA_INUSE_MAGIC      0x455355
 #define ARENA_PENDING_MAGIC    0xbedead
+#define ARENA_LFH_MAGIC        0x48464c
 #define ARENA_FREE_MAGIC       0x45455246
 #define ARENA_LARGE_MAGIC      0x6752614c
 
@@ -148,6 +149,59 @@ typedef struct tagSUBHEAP
 
 #define SUBHEAP_MAGIC    ((DWORD)('S' | ('U'<<8) | ('B'<<16) | ('H'<<24)))
 
+/* Low-fragmentation front end
+ *
+ * Small blocks freed to a heap with the LFH enabled are kept in per-size
+ * bins instead of being returned to the free lists, and handed out again
+ * without taking the heap critical section. The bins are grouped in slots;
+ * a thread claims a slot with an interlocked exchange, starting from one
+ * derived from its thread id, and moves on to the next one if it is busy,
+ * so threads never wait on each other. Cached blocks stay in-use arenas
+ * of the backing sub-heaps, marked with ARENA_LFH_MAGIC; bins are
+ * refilled and trimmed in batches under the heap critical section.
+ * Since freeing doesn't take the critical section either, the committed
+ * ranges of the sub-heaps are published in the front end, protected by a
+ * sequence count, and a block is only cached after checking that it lies
+ * in one of them; anything else goes through the validating path.
+ */
+
+/* largest arena size handled by the front end */
+#define HEAP_LFH_MAX_SIZE      ROUND_SIZE(0x800)
+#define HEAP_LFH_NB_BINS       ((HEAP_LFH_MAX_SIZE - HEAP_MIN_DATA_SIZE) / ALIGNMENT + 1)
+#define HEAP_LFH_NB_SLOTS      16
+/* amount of memory cached in a single bin, within the depth limits below */
+#define HEAP_LFH_BIN_BYTES     0x2000
+#define HEAP_LFH_MIN_DEPTH     8
+#define HEAP_LFH_MAX_DEPTH     64
+/* number of sub-heaps whose blocks can be cached */
+#define HEAP_LFH_NB_RANGES     32
+
+struct lfh_bin
+{
+    ARENA_INUSE     *head;          /* cached blocks, linked through their data */
+    ULONG            count;         /* number of cached blocks */
+};
+
+struct lfh_slot
+{
+    LONG             busy;          /* set while a thread is using the slot */
+    struct lfh_bin   bins[HEAP_LFH_NB_BINS];
+};
+
+struct lfh_range
+{
+    const char      *start;         /* first arena of the sub-heap */
+    const char      *end;           /* end of the committed memory */
+};
+
+struct lfh
+{
+    LONG             seq;           /* odd while the ranges are being updated */
+    unsigned int     nb_ranges;
+    struct lfh_range ranges[HEAP_LFH_NB_RANGES];
+    struct lfh_slot  slots[HEAP_LFH_NB_SLOTS];
+};
+
 typedef struct tagHEAP
 {
     DWORD_PTR        unknown1[2];
@@ -164,6 +218,7 @@ typedef struct tagHEAP
     ARENA_INUSE    **pending_free;  /* Ring buffer for pending free requests */
     RTL_CRITICAL_SECTION critSection; /* Critical section for serialization */
     FREE_LIST_ENTRY *freeList;      /* Free lists */
+    struct lfh      *lfh;           /* Low-fragmentation front end, if enabled */
 } HEAP;
 
 #define HEAP_MAGIC       ((DWORD)('H' | ('E'<<8) | ('A'<<16) | ('P'<<24)))
@@ -296,7 +351,8 @@ static void subheap_notify_free_all(SUBHEAP const *subheap)
         {
             ARENA_INUSE const *pArena = (ARENA_INUSE const *)ptr;
             if (pArena->magic == ARENA_INUSE_MAGIC) notify_free(pArena + 1);
-            else if (pArena->magic != ARENA_PENDING_MAGIC) ERR("bad inuse_magic @%p\n", pArena);
+            else if (pArena->magic != ARENA_PENDING_MAGIC && pArena->magic != ARENA_LFH_MAGIC)
+                ERR("bad inuse_magic @%p\n", pArena);
             ptr += sizeof(*pArena) + (pArena->size & ARENA_SIZE_MASK);
         }
     }
@@ -515,6 +571,32 @@ static SUBHEAP *HEAP_FindSubHeap(
 }
 
 
+/***********************************************************************
+ *           lfh_update_ranges
+ *
+ * Publish the committed ranges of the sub-heaps to the front end.
+ * The heap critical section must be held.
+ */
+static void lfh_update_ranges( HEAP *heap )
+{
+    struct lfh *lfh = heap->lfh;
+    SUBHEAP *subheap;
+    unsigned int i = 0;
+
+    if (!lfh) return;
+    interlocked_xchg_add( &lfh->seq, 1 );
+    LIST_FOR_EACH_ENTRY( subheap, &heap->subheap_list, SUBHEAP, entry )
+    {
+        if (i == HEAP_LFH_NB_RANGES) break;
+        lfh->ranges[i].start = (const char *)subheap->base + subheap->headerSize;
+        lfh->ranges[i].end   = (const char *)subheap->base + subheap->commitSize;
+        i++;
+    }
+    lfh->nb_ranges = i;
+    interlocked_xchg_add( &lfh->seq, 1 );
+}
+
+
 /***********************************************************************
  *           HEAP_Commit
  *
@@ -537,6 +619,7 @@ static inline BOOL HEAP_Commit( SUBHEAP *subheap, ARENA_INUSE *pArena, SIZE_T da
         return FALSE;
     }
     subheap->commitSize += size;
+    lfh_update_ranges( subheap->heap );
     return TRUE;
 }
 
@@ -559,13 +642,18 @@ static inline BOOL HEAP_Decommit( SUBHEAP *subheap, void *ptr )
     decommit_size = subheap->commitSize - size;
     addr = (char *)subheap->base + size;
 
+    /* shrink the front end ranges before the memory goes away */
+    subheap->commitSize = size;
+    lfh_update_ranges( subheap->heap );
+
     if (NtFreeVirtualMemory( NtCurrentProcess(), &addr, &decommit_size, MEM_DECOMMIT ))
     {
         WARN("Could not decommit %08lx bytes at %p for heap %p\n",
              decommit_size, (char *)subheap->base + size, subheap->heap );
+        subheap->commitSize += decommit_size;
+        lfh_update_ranges( subheap->heap );
         return FALSE;
     }
-    subheap->commitSize -= decommit_size;
     return TRUE;
 }
 
@@ -680,6 +768,7 @@ static void HEAP_MakeInUseBlockFree( SUBHEAP *subheap, ARENA_INUSE *pArena )
         list_remove( &pFree->entry );
         /* Remove the subheap from the list */
         list_remove( &subheap->entry );
+        lfh_update_ranges( subheap->heap );
         /* Free the memory */
         subheap->magic = 0;
         NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
@@ -916,6 +1005,7 @@ static SUBHEAP *HEAP_CreateSubHeap( HEAP *heap, LPVOID address, DWORD flags,
         subheap->magic      = SUBHEAP_MAGIC;
         subheap->headerSize = ROUND_SIZE( sizeof(SUBHEAP) );
         list_add_head( &heap->subheap_list, &subheap->entry );
+        lfh_update_ranges( heap );
     }
     else
     {
@@ -1214,7 +1304,8 @@ static BOOL HEAP_ValidateInUseArena( const SUBHEAP *subheap, const ARENA_INUSE *
     }
 
     /* Check magic number */
-    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC)
+    if (pArena->magic != ARENA_INUSE_MAGIC && pArena->magic != ARENA_PENDING_MAGIC &&
+        pArena->magic != ARENA_LFH_MAGIC)
     {
         if (quiet == NOISY) {
             ERR("Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, pArena->magic, pArena );
@@ -1429,7 +1520,7 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
         ret = HEAP_ValidateInUseArena( subheap, arena, QUIET );
     else if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET)
         WARN( "Heap %p: unaligned arena pointer %p\n", subheap->heap, arena );
-    else if (arena->magic == ARENA_PENDING_MAGIC)
+    else if (arena->magic == ARENA_PENDING_MAGIC || arena->magic == ARENA_LFH_MAGIC)
         WARN( "Heap %p: block %p used after free\n", subheap->heap, arena + 1 );
     else if (arena->magic != ARENA_INUSE_MAGIC)
         WARN( "Heap %p: invalid in-use arena magic %08x for %p\n", subheap->heap, arena->magic, arena );
@@ -1447,6 +1538,262 @@ static BOOL validate_block_pointer( HEAP *heap, SUBHEAP **ret_subheap, const ARE
 }
 
 
+/***********************************************************************
+ *           HEAP_AllocateArena
+ *
+ * Carve an in-use arena of at least the given size out of the free lists,
+ * growing the heap if needed. The heap must be locked.
+ */
+static ARENA_INUSE *HEAP_AllocateArena( HEAP *heap, SIZE_T rounded_size )
+{
+    ARENA_FREE *pArena;
+    ARENA_INUSE *pInUse;
+    SUBHEAP *subheap;
+
+    if (!(pArena = HEAP_FindFreeBlock( heap, rounded_size, &subheap ))) return NULL;
+
+    /* Remove the arena from the free list */
+
+    list_remove( &pArena->entry );
+
+    /* Build the in-use arena */
+
+    pInUse = (ARENA_INUSE *)pArena;
+
+    /* in-use arena is smaller than free arena,
+     * so we have to add the difference to the size */
+    pInUse->size  = (pInUse->size & ~ARENA_FLAG_FREE) + sizeof(ARENA_FREE) - sizeof(ARENA_INUSE);
+    pInUse->magic = ARENA_INUSE_MAGIC;
+
+    /* Shrink the block */
+
+    HEAP_ShrinkBlock( subheap, pInUse, rounded_size );
+    return pInUse;
+}
+
+
+/* index of the front end bin holding arenas of a given size */
+static inline unsigned int lfh_bin_index( SIZE_T size )
+{
+    return (size - HEAP_MIN_DATA_SIZE) / ALIGNMENT;
+}
+
+/* number of blocks a bin may cache before it is trimmed */
+static inline ULONG lfh_bin_depth( SIZE_T size )
+{
+    ULONG depth = HEAP_LFH_BIN_BYTES / size;
+    return min( max( depth, HEAP_LFH_MIN_DEPTH ), HEAP_LFH_MAX_DEPTH );
+}
+
+static inline ARENA_INUSE *lfh_bin_pop( struct lfh_bin *bin )
+{
+    ARENA_INUSE *arena = bin->head;
+
+    if (arena)
+    {
+        bin->head = *(ARENA_INUSE **)(arena + 1);
+        bin->count--;
+    }
+    return arena;
+}
+
+static inline void lfh_bin_push( struct lfh_bin *bin, ARENA_INUSE *arena )
+{
+    *(ARENA_INUSE **)(arena + 1) = bin->head;
+    bin->head = arena;
+    bin->count++;
+}
+
+/* claim a slot for the current thread, or return NULL if all of them are busy */
+static struct lfh_slot *lfh_enter_slot( struct lfh *lfh )
+{
+    unsigned int i, start = HandleToULong( NtCurrentTeb()->ClientId.UniqueThread ) / 4;
+
+    for (i = 0; i < HEAP_LFH_NB_SLOTS; i++)
+    {
+        struct lfh_slot *slot = &lfh->slots[(start + i) % HEAP_LFH_NB_SLOTS];
+        if (!slot->busy && !interlocked_cmpxchg( &slot->busy, 1, 0 )) return slot;
+    }
+    return NULL;
+}
+
+static inline void lfh_leave_slot( struct lfh_slot *slot )
+{
+    interlocked_xchg( &slot->busy, 0 );
+}
+
+/* move a batch of arenas of the given size from the free lists into an empty bin */
+static void lfh_refill_bin( HEAP *heap, struct lfh_bin *bin, SIZE_T size )
+{
+    ULONG count = lfh_bin_depth( size ) / 2;
+    ARENA_INUSE *arena;
+
+    RtlEnterCriticalSection( &heap->critSection );
+    while (count--)
+    {
+        if (!(arena = HEAP_AllocateArena( heap, size ))) break;
+        arena->magic = ARENA_LFH_MAGIC;
+        lfh_bin_push( bin, arena );
+    }
+    RtlLeaveCriticalSection( &heap->critSection );
+}
+
+/* return a batch of cached arenas from a bin to the free lists */
+static void lfh_trim_bin( HEAP *heap, struct lfh_bin *bin, ULONG count )
+{
+    ARENA_INUSE *arena;
+    SUBHEAP *subheap;
+
+    RtlEnterCriticalSection( &heap->critSection );
+    while (count-- && (arena = lfh_bin_pop( bin )))
+    {
+        arena->magic = ARENA_INUSE_MAGIC;
+        if (validate_block_pointer( heap, &subheap, arena ) && subheap)
+            HEAP_MakeInUseBlockFree( subheap, arena );
+        else
+            WARN( "Heap %p: leaking block %p freed to the wrong heap\n", heap, arena + 1 );
+    }
+    RtlLeaveCriticalSection( &heap->critSection );
+}
+
+/* return all the cached arenas of idle slots to the free lists, when running out of space */
+static BOOL lfh_flush( HEAP *heap )
+{
+    unsigned int i, j;
+    BOOL ret = FALSE;
+
+    for (i = 0; i < HEAP_LFH_NB_SLOTS; i++)
+    {
+        struct lfh_slot *slot = &heap->lfh->slots[i];
+
+        if (interlocked_cmpxchg( &slot->busy, 1, 0 )) continue;
+        for (j = 0; j < HEAP_LFH_NB_BINS; j++)
+        {
+            if (!slot->bins[j].count) continue;
+            lfh_trim_bin( heap, &slot->bins[j], slot->bins[j].count );
+            ret = TRUE;
+        }
+        lfh_leave_slot( slot );
+    }
+    return ret;
+}
+
+/***********************************************************************
+ *           lfh_allocate
+ *
+ * Allocate a block from the low-fragmentation front end.
+ * Returns NULL if the regular allocation path should be used instead.
+ */
+static ARENA_INUSE *lfh_allocate( HEAP *heap, DWORD flags, SIZE_T size, SIZE_T rounded_size )
+{
+    struct lfh_slot *slot;
+    struct lfh_bin *bin;
+    ARENA_INUSE *arena;
+
+    if (!(slot = lfh_enter_slot( heap->lfh ))) return NULL;
+
+    bin = &slot->bins[lfh_bin_index( rounded_size )];
+    if (!bin->head) lfh_refill_bin( heap, bin, rounded_size );
+    arena = lfh_bin_pop( bin );
+
+    lfh_leave_slot( slot );
+    if (!arena) return NULL;
+
+    arena->magic = ARENA_INUSE_MAGIC;
+    arena->unused_bytes = (arena->size & ARENA_SIZE_MASK) - size;
+    notify_alloc( arena + 1, size, flags & HEAP_ZERO_MEMORY );
+    initialize_block( arena + 1, size, arena->unused_bytes, flags );
+    return arena;
+}
+
+/* check that an arena header and the cache link following it lie in the
+ * committed memory of one of the heap sub-heaps */
+static BOOL lfh_owns_arena( struct lfh *lfh, const ARENA_INUSE *arena )
+{
+    const char *start = (const char *)arena, *end = (const char *)(arena + 1) + sizeof(ARENA_INUSE *);
+    LONG seq = __atomic_load_n( &lfh->seq, __ATOMIC_ACQUIRE );
+    unsigned int i, count;
+    BOOL ret = FALSE;
+
+    if (seq & 1) return FALSE;
+    count = min( lfh->nb_ranges, HEAP_LFH_NB_RANGES );
+    for (i = 0; i < count; i++)
+    {
+        if (start < lfh->ranges[i].start || end > lfh->ranges[i].end) continue;
+        ret = TRUE;
+        break;
+    }
+    __atomic_thread_fence( __ATOMIC_ACQUIRE );
+    return ret && __atomic_load_n( &lfh->seq, __ATOMIC_RELAXED ) == seq;
+}
+
+/***********************************************************************
+ *           lfh_free
+ *
+ * Cache a block in the low-fragmentation front end.
+ * Returns FALSE if the regular free path should be used instead.
+ */
+static BOOL lfh_free( HEAP *heap, ARENA_INUSE *arena )
+{
+    struct lfh_slot *slot;
+    struct lfh_bin *bin;
+    SIZE_T size;
+    ULONG depth;
+
+    /* anything that doesn't look like a small in-use arena of this heap,
+     * including invalid pointers, blocks of other heaps and large blocks,
+     * goes through full validation; the arena header is only read once
+     * it is known to be in committed memory of the heap */
+    if ((ULONG_PTR)arena % ALIGNMENT != ARENA_OFFSET) return FALSE;
+    if (!lfh_owns_arena( heap->lfh, arena )) return FALSE;
+    if (arena->magic != ARENA_INUSE_MAGIC || (arena->size & ARENA_FLAG_FREE)) return FALSE;
+    size = arena->size & ARENA_SIZE_MASK;
+    if (size < HEAP_MIN_DATA_SIZE || size > HEAP_LFH_MAX_SIZE) return FALSE;
+
+    if (!(slot = lfh_enter_slot( heap->lfh ))) return FALSE;
+
+    notify_free( arena + 1 );
+    arena->magic = ARENA_LFH_MAGIC;
+    bin = &slot->bins[lfh_bin_index( size )];
+    lfh_bin_push( bin, arena );
+    depth = lfh_bin_depth( size );
+    if (bin->count > depth) lfh_trim_bin( heap, bin, depth / 2 );
+
+    lfh_leave_slot( slot );
+    return TRUE;
+}
+
+/***********************************************************************
+ *           lfh_enable
+ */
+static NTSTATUS lfh_enable( HEAP *heap )
+{
+    SIZE_T size = sizeof(struct lfh);
+    void *ptr = NULL;
+
+    if (heap->lfh) return STATUS_SUCCESS;
+
+    /* the front end can't honor serialization or debugging flags */
+    if ((heap->flags & (HEAP_NO_SERIALIZE | HEAP_VALIDATE | HEAP_TAIL_CHECKING_ENABLED |
+                        HEAP_FREE_CHECKING_ENABLED)) || heap->pending_free)
+        return STATUS_UNSUCCESSFUL;
+
+    if (NtAllocateVirtualMemory( NtCurrentProcess(), &ptr, 4, &size, MEM_COMMIT, PAGE_READWRITE ))
+        return STATUS_NO_MEMORY;
+    if (interlocked_cmpxchg_ptr( (void **)&heap->lfh, ptr, NULL ))
+    {
+        size = 0;
+        NtFreeVirtualMemory( NtCurrentProcess(), &ptr, &size, MEM_RELEASE );
+        return STATUS_SUCCESS;
+    }
+    RtlEnterCriticalSection( &heap->critSection );
+    lfh_update_ranges( heap );
+    RtlLeaveCriticalSection( &heap->critSection );
+    TRACE( "enabled low-fragmentation front end for heap %p\n", heap );
+    return STATUS_SUCCESS;
+}
+
+
 /***********************************************************************
  *           heap_set_debug_flags
  */
@@ -1638,6 +1985,12 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE heap )
         addr = heapPtr->pending_free;
         NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
     }
+    if (heapPtr->lfh)
+    {
+        size = 0;
+        addr = heapPtr->lfh;
+        NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
+    }
     size = 0;
     addr = heapPtr->subheap.base;
     NtFreeVirtualMemory( NtCurrentProcess(), &addr, &size, MEM_RELEASE );
@@ -1664,9 +2017,7 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE heap )
  */
 void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_T size )
 {
-    ARENA_FREE *pArena;
     ARENA_INUSE *pInUse;
-    SUBHEAP *subheap;
     HEAP *heapPtr = HEAP_GetPtr( heap );
     SIZE_T rounded_size;
 
@@ -1683,6 +2034,13 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
     }
     if (rounded_size < HEAP_MIN_DATA_SIZE) rounded_size = HEAP_MIN_DATA_SIZE;
 
+    if (heapPtr->lfh && rounded_size <= HEAP_LFH_MAX_SIZE &&
+        (pInUse = lfh_allocate( heapPtr, flags, size, rounded_size )))
+    {
+        TRACE("(%p,%08x,%08lx): returning %p\n", heap, flags, size, pInUse + 1 );
+        return pInUse + 1;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     if (rounded_size >= HEAP_MIN_LARGE_BLOCK_SIZE && (flags & HEAP_GROWABLE))
@@ -1696,7 +2054,9 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
 
     /* Locate a suitable free block */
 
-    if (!(pArena = HEAP_FindFreeBlock( heapPtr, rounded_size, &subheap )))
+    if (!(pInUse = HEAP_AllocateArena( heapPtr, rounded_size )) && heapPtr->lfh && lfh_flush( heapPtr ))
+        pInUse = HEAP_AllocateArena( heapPtr, rounded_size );
+    if (!pInUse)
     {
         TRACE("(%p,%08x,%08lx): returning NULL\n",
                   heap, flags, size  );
@@ -1705,22 +2065,6 @@ void * WINAPI DECLSPEC_HOTPATCH RtlAllocateHeap( HANDLE heap, ULONG flags, SIZE_
         return NULL;
     }
 
-    /* Remove the arena from the free list */
-
-    list_remove( &pArena->entry );
-
-    /* Build the in-use arena */
-
-    pInUse = (ARENA_INUSE *)pArena;
-
-    /* in-use arena is smaller than free arena,
-     * so we have to add the difference to the size */
-    pInUse->size  = (pInUse->size & ~ARENA_FLAG_FREE) + sizeof(ARENA_FREE) - sizeof(ARENA_INUSE);
-    pInUse->magic = ARENA_INUSE_MAGIC;
-
-    /* Shrink the block */
-
-    HEAP_ShrinkBlock( subheap, pInUse, rounded_size );
     pInUse->unused_bytes = (pInUse->size & ARENA_SIZE_MASK) - size;
 
     notify_alloc( pInUse + 1, size, flags & HEAP_ZERO_MEMORY );
@@ -1766,6 +2110,13 @@ BOOLEAN WINAPI DECLSPEC_HOTPATCH RtlFreeHeap( HANDLE heap, ULONG flags, void *pt
 
     flags &= HEAP_NO_SERIALIZE;
     flags |= heapPtr->flags;
+
+    if (heapPtr->lfh && lfh_free( heapPtr, (ARENA_INUSE *)ptr - 1 ))
+    {
+        TRACE("(%p,%08x,%p): returning TRUE\n", heap, flags, ptr );
+        return TRUE;
+    }
+
     if (!(flags & HEAP_NO_SERIALIZE)) RtlEnterCriticalSection( &heapPtr->critSection );
 
     /* Inform valgrind we are trying to free memory, so it can throw up an error message */
@@ -2133,7 +2484,8 @@ NTSTATUS WINAPI RtlWalkHeap( HANDLE heap, PVOID entry_ptr )
         }
 
         if (((ARENA_INUSE *)ptr - 1)->magic == ARENA_INUSE_MAGIC ||
-            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC)
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_PENDING_MAGIC ||
+            ((ARENA_INUSE *)ptr - 1)->magic == ARENA_LFH_MAGIC)
         {
             ARENA_INUSE *pArena = (ARENA_INUSE *)ptr - 1;
             ptr += pArena->size & ARENA_SIZE_MASK;
@@ -2246,6 +2598,8 @@ ULONG WINAPI RtlGetProcessHeaps( ULONG count, HANDLE *heaps )
 NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class,
                                          PVOID info, SIZE_T size_in, PSIZE_T size_out)
 {
+    HEAP *heapPtr;
+
     switch (info_class)
     {
     case HeapCompatibilityInformation:
@@ -2254,7 +2608,8 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
         if (size_in < sizeof(ULONG))
             return STATUS_BUFFER_TOO_SMALL;
 
-        *(ULONG *)info = 0; /* standard heap */
+        if (!(heapPtr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+        *(ULONG *)info = heapPtr->lfh ? 2 : 0; /* low-fragmentation or standard heap */
         return STATUS_SUCCESS;
 
     default:
@@ -2268,6 +2623,22 @@ NTSTATUS WINAPI RtlQueryHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS inf
  */
 NTSTATUS WINAPI RtlSetHeapInformation( HANDLE heap, HEAP_INFORMATION_CLASS info_class, PVOID info, SIZE_T size)
 {
-    FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
-    return STATUS_SUCCESS;
+    HEAP *heapPtr;
+
+    switch (info_class)
+    {
+    case HeapCompatibilityInformation:
+        if (size < sizeof(ULONG) || *(ULONG *)info != 2)
+        {
+            /* the low-fragmentation heap can be enabled, but not disabled again */
+            FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
+            return STATUS_SUCCESS;
+        }
+        if (!(heapPtr = HEAP_GetPtr( heap ))) return STATUS_INVALID_HANDLE;
+        return lfh_enable( heapPtr );
+
+    default:
+        FIXME("%p %d %p %ld stub\n", heap, info_class, info, size);
+        return STATUS_SUCCESS;
+    }
 }
@@ -23,10 +23,14 @@
 #include "wine/port.h"
 
 #include <assert.h>
+#include <fcntl.h>
 #include <stdarg.h>
 #ifdef HAVE_SYS_MMAN_H
 # include <sys/mman.h>
 #endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -107,6 +111,9 @@ typedef struct _wine_modref
     int                   alloc_deps;
     int                   nDeps;
     struct _wine_modref **deps;
+    struct _wine_modref  *base_hash_next;      /* next module in base_hash_table chain */
+    struct _wine_modref  *basename_hash_next;  /* next module in basename_hash_table chain */
+    struct _wine_modref  *fullname_hash_next;  /* next module in fullname_hash_table chain */
 } WINE_MODREF;
 
 /* info about the current builtin dll load */
@@ -139,6 +146,20 @@ static WINE_MODREF *cached_modref;
 static WINE_MODREF *current_modref;
 static WINE_MODREF *last_failed_modref;
 
+/* hash tables of the loaded modules, indexed by base address, base name and full name */
+#define MODULE_HASH_SIZE 128
+static WINE_MODREF *base_hash_table[MODULE_HASH_SIZE];
+static WINE_MODREF *basename_hash_table[MODULE_HASH_SIZE];
+static WINE_MODREF *fullname_hash_table[MODULE_HASH_SIZE];
+
+/* import resolution cache, shared between all the processes of a prefix
+ * each slot holds a 32-bit key tag and the index of the export name in the
+ * exporting module's name table; entries are only hints and always verified */
+#define IMPORT_CACHE_SLOTS  (1 << 16)
+#define IMPORT_CACHE_PROBES 4
+static ULONG64 *import_cache;
+static int import_cache_state;  /* 0 = not initialized, 1 = mapped, -1 = unavailable */
+
 static NTSTATUS load_dll( LPCWSTR load_path, LPCWSTR libname, DWORD flags, WINE_MODREF** pwm );
 static NTSTATUS process_attach( WINE_MODREF *wm, LPVOID lpReserved );
 static FARPROC find_ordinal_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports,
@@ -380,6 +401,71 @@ static void call_ldr_notifications( ULONG reason, LDR_MODULE *module )
     }
 }
 
+static inline unsigned int hash_module_base( HMODULE module )
+{
+    /* modules are aligned on 64k boundaries */
+    return ((ULONG_PTR)module >> 16) % MODULE_HASH_SIZE;
+}
+
+static unsigned int hash_module_name( LPCWSTR name )
+{
+    unsigned int hash = 0;
+
+    while (*name) hash = hash * 65599 + tolowerW( *name++ );
+    return hash % MODULE_HASH_SIZE;
+}
+
+
+/*************************************************************************
+ *		add_module_to_hash
+ *
+ * Add a module to the lookup hash tables. Modules are appended to the
+ * chains, so that lookups by base name find them in load order.
+ * The loader_section must be locked while calling this function.
+ */
+static void add_module_to_hash( WINE_MODREF *wm )
+{
+    WINE_MODREF **next;
+
+    next = &base_hash_table[hash_module_base( wm->ldr.BaseAddress )];
+    while (*next) next = &(*next)->base_hash_next;
+    *next = wm;
+
+    next = &basename_hash_table[hash_module_name( wm->ldr.BaseDllName.Buffer )];
+    while (*next) next = &(*next)->basename_hash_next;
+    *next = wm;
+
+    next = &fullname_hash_table[hash_module_name( wm->ldr.FullDllName.Buffer )];
+    while (*next) next = &(*next)->fullname_hash_next;
+    *next = wm;
+}
+
+
+/*************************************************************************
+ *		remove_module_from_hash
+ *
+ * The loader_section must be locked while calling this function.
+ */
+static void remove_module_from_hash( WINE_MODREF *wm )
+{
+    WINE_MODREF **next;
+
+    next = &base_hash_table[hash_module_base( wm->ldr.BaseAddress )];
+    while (*next && *next != wm) next = &(*next)->base_hash_next;
+    if (*next) *next = wm->base_hash_next;
+
+    next = &basename_hash_table[hash_module_name( wm->ldr.BaseDllName.Buffer )];
+    while (*next && *next != wm) next = &(*next)->basename_hash_next;
+    if (*next) *next = wm->basename_hash_next;
+
+    next = &fullname_hash_table[hash_module_name( wm->ldr.FullDllName.Buffer )];
+    while (*next && *next != wm) next = &(*next)->fullname_hash_next;
+    if (*next) *next = wm->fullname_hash_next;
+
+    wm->base_hash_next = wm->basename_hash_next = wm->fullname_hash_next = NULL;
+}
+
+
 /*************************************************************************
  *		get_modref
  *
@@ -388,18 +474,12 @@ static void call_ldr_notifications( ULONG reason, LDR_MODULE *module )
  */
 static WINE_MODREF *get_modref( HMODULE hmod )
 {
-    PLIST_ENTRY mark, entry;
-    PLDR_MODULE mod;
+    WINE_MODREF *wm;
 
     if (cached_modref && cached_modref->ldr.BaseAddress == hmod) return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InMemoryOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
-    {
-        mod = CONTAINING_RECORD(entry, LDR_MODULE, InMemoryOrderModuleList);
-        if (mod->BaseAddress == hmod)
-            return cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
-    }
+    for (wm = base_hash_table[hash_module_base( hmod )]; wm; wm = wm->base_hash_next)
+        if (wm->ldr.BaseAddress == hmod) return cached_modref = wm;
     return NULL;
 }
 
@@ -412,21 +492,13 @@ static WINE_MODREF *get_modref( HMODULE hmod )
  */
 static WINE_MODREF *find_basename_module( LPCWSTR name )
 {
-    PLIST_ENTRY mark, entry;
+    WINE_MODREF *wm;
 
     if (cached_modref && !strcmpiW( name, cached_modref->ldr.BaseDllName.Buffer ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
-    {
-        LDR_MODULE *mod = CONTAINING_RECORD(entry, LDR_MODULE, InLoadOrderModuleList);
-        if (!strcmpiW( name, mod->BaseDllName.Buffer ))
-        {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
-            return cached_modref;
-        }
-    }
+    for (wm = basename_hash_table[hash_module_name( name )]; wm; wm = wm->basename_hash_next)
+        if (!strcmpiW( name, wm->ldr.BaseDllName.Buffer )) return cached_modref = wm;
     return NULL;
 }
 
@@ -439,21 +511,13 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
  */
 static WINE_MODREF *find_fullname_module( LPCWSTR name )
 {
-    PLIST_ENTRY mark, entry;
+    WINE_MODREF *wm;
 
     if (cached_modref && !strcmpiW( name, cached_modref->ldr.FullDllName.Buffer ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
-    {
-        LDR_MODULE *mod = CONTAINING_RECORD(entry, LDR_MODULE, InLoadOrderModuleList);
-        if (!strcmpiW( name, mod->FullDllName.Buffer ))
-        {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
-            return cached_modref;
-        }
-    }
+    for (wm = fullname_hash_table[hash_module_name( name )]; wm; wm = wm->fullname_hash_next)
+        if (!strcmpiW( name, wm->ldr.FullDllName.Buffer )) return cached_modref = wm;
     return NULL;
 }
 
@@ -609,6 +673,113 @@ static FARPROC find_ordinal_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY
 }
 
 
+/*************************************************************************
+ *		map_import_cache
+ *
+ * Map the shared import resolution cache file from the server directory.
+ * The loader_section must be locked while calling this function.
+ */
+static BOOL map_import_cache(void)
+{
+    static const char name[] = "/import-cache";
+    const char *dir;
+    struct stat st;
+    char *path;
+    void *ptr;
+    int fd;
+
+    if (import_cache_state) return import_cache_state > 0;
+    import_cache_state = -1;
+
+    if (!(dir = wine_get_server_dir())) return FALSE;
+    if (!(path = RtlAllocateHeap( GetProcessHeap(), 0, strlen(dir) + sizeof(name) ))) return FALSE;
+    strcpy( path, dir );
+    strcat( path, name );
+    fd = open( path, O_RDWR | O_CREAT, 0600 );
+    RtlFreeHeap( GetProcessHeap(), 0, path );
+    if (fd == -1) return FALSE;
+
+    if (fstat( fd, &st ) == -1 ||
+        (st.st_size < IMPORT_CACHE_SLOTS * sizeof(*import_cache) &&
+         ftruncate( fd, IMPORT_CACHE_SLOTS * sizeof(*import_cache) ) == -1))
+    {
+        close( fd );
+        return FALSE;
+    }
+    ptr = mmap( NULL, IMPORT_CACHE_SLOTS * sizeof(*import_cache), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if (ptr == MAP_FAILED) return FALSE;
+
+    TRACE( "mapped import cache at %p\n", ptr );
+    import_cache = ptr;
+    import_cache_state = 1;
+    return TRUE;
+}
+
+
+/*************************************************************************
+ *		hash_import_name
+ *
+ * Compute the import cache key of an export name. The key covers the identity
+ * of the exporting image, so that a rebuilt or different dll uses other slots.
+ */
+static unsigned int hash_import_name( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports, const char *name )
+{
+    const IMAGE_NT_HEADERS *nt = RtlImageNtHeader( module );
+    const char *dll_name = exports->Name ? get_rva( module, exports->Name ) : "";
+    unsigned int hash = 0x811c9dc5;
+
+    hash = (hash ^ nt->FileHeader.TimeDateStamp) * 0x01000193;
+    hash = (hash ^ nt->OptionalHeader.SizeOfImage) * 0x01000193;
+    hash = (hash ^ exports->NumberOfNames) * 0x01000193;
+    while (*dll_name) hash = (hash ^ (unsigned char)*dll_name++) * 0x01000193;
+    hash = (hash ^ '!') * 0x01000193;
+    while (*name) hash = (hash ^ (unsigned char)*name++) * 0x01000193;
+    return hash;
+}
+
+
+/*************************************************************************
+ *		get_cached_import
+ *
+ * Return the cached name index of an export, or -1 if not found.
+ */
+static int get_cached_import( unsigned int hash )
+{
+    unsigned int i, tag = hash | 1;
+
+    for (i = 0; i < IMPORT_CACHE_PROBES; i++)
+    {
+        ULONG64 slot = import_cache[(hash + i) % IMPORT_CACHE_SLOTS];
+        if (!slot) break;
+        if ((unsigned int)(slot >> 32) == tag) return (unsigned int)slot;
+    }
+    return -1;
+}
+
+
+/*************************************************************************
+ *		set_cached_import
+ */
+static void set_cached_import( unsigned int hash, int pos )
+{
+    unsigned int i, tag = hash | 1;
+    ULONG64 *slot = &import_cache[hash % IMPORT_CACHE_SLOTS];
+
+    for (i = 0; i < IMPORT_CACHE_PROBES; i++)
+    {
+        ULONG64 *ptr = &import_cache[(hash + i) % IMPORT_CACHE_SLOTS];
+        if (!*ptr || (unsigned int)(*ptr >> 32) == tag)
+        {
+            slot = ptr;
+            break;
+        }
+    }
+    /* concurrent writers may clobber each other, that's harmless since entries are verified */
+    *slot = ((ULONG64)tag << 32) | (unsigned int)pos;
+}
+
+
 /*************************************************************************
  *		find_named_export
  *
@@ -621,6 +792,7 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
     const WORD *ordinals = get_rva( module, exports->AddressOfNameOrdinals );
     const DWORD *names = get_rva( module, exports->AddressOfNames );
     int min = 0, max = exports->NumberOfNames - 1;
+    unsigned int hash = 0;
 
     /* first check the hint */
     if (hint >= 0 && hint <= max)
@@ -630,13 +802,29 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
             return find_ordinal_export( module, exports, exp_size, ordinals[hint], load_path );
     }
 
+    /* then the import cache */
+    if (max >= 0 && map_import_cache())
+    {
+        hash = hash_import_name( module, exports, name );
+        hint = get_cached_import( hash );
+        if (hint >= 0 && hint <= max)
+        {
+            char *ename = get_rva( module, names[hint] );
+            if (!strcmp( ename, name ))
+                return find_ordinal_export( module, exports, exp_size, ordinals[hint], load_path );
+        }
+    }
+
     /* then do a binary search */
     while (min <= max)
     {
         int res, pos = (min + max) / 2;
         char *ename = get_rva( module, names[pos] );
         if (!(res = strcmp( ename, name )))
+        {
+            if (import_cache) set_cached_import( hash, pos );
             return find_ordinal_export( module, exports, exp_size, ordinals[pos], load_path );
+        }
         if (res > 0) max = pos - 1;
         else min = pos + 1;
     }
@@ -1099,6 +1287,7 @@ static WINE_MODREF *alloc_module( HMODULE hModule, LPCWSTR filename )
                    &wm->ldr.InLoadOrderModuleList);
     InsertTailList(&NtCurrentTeb()->Peb->LdrData->InMemoryOrderModuleList,
                    &wm->ldr.InMemoryOrderModuleList);
+    add_module_to_hash( wm );
     /* wait until init is called for inserting into InInitializationOrderModuleList */
 
     if (!(nt->OptionalHeader.DllCharacteristics & IMAGE_DLLCHARACTERISTICS_NX_COMPAT))
@@ -1773,6 +1962,7 @@ static void load_builtin_callback( void *module, const char *filename )
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+            remove_module_from_hash( wm );
             /* FIXME: free the modref */
             builtin_load_info->status = STATUS_DLL_NOT_FOUND;
             return;
@@ -2078,6 +2268,7 @@ static NTSTATUS load_native_dll( LPCWSTR load_path, LPCWSTR name, HANDLE file,
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
             RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+            remove_module_from_hash( wm );
 
             /* FIXME: there are several more dangling references
              * left. Including dlls loaded by this dll before the
@@ -3094,6 +3285,7 @@ static void free_modref( WINE_MODREF *wm )
 {
     RemoveEntryList(&wm->ldr.InLoadOrderModuleList);
     RemoveEntryList(&wm->ldr.InMemoryOrderModuleList);
+    remove_module_from_hash( wm );
     if (wm->ldr.InInitializationOrderModuleList.Flink)
         RemoveEntryList(&wm->ldr.InInitializationOrderModuleList);
 
@@ -98,15 +98,38 @@ extern unsigned int server_select( const select_op_t *select_op, data_size_t siz
                                    UINT flags, const LARGE_INTEGER *timeout ) DECLSPEC_HIDDEN;
 extern unsigned int server_queue_process_apc( HANDLE process, const apc_call_t *call, apc_result_t *result ) DECLSPEC_HIDDEN;
 extern int server_remove_fd_from_cache( HANDLE handle ) DECLSPEC_HIDDEN;
+extern void server_enter_fd_cache_section( sigset_t *sigset ) DECLSPEC_HIDDEN;
+extern void server_leave_fd_cache_section( sigset_t *sigset ) DECLSPEC_HIDDEN;
+extern void server_receive_cached_fd( HANDLE handle, enum server_fd_type type,
+                                      unsigned int access, unsigned int options ) DECLSPEC_HIDDEN;
 extern int server_get_unix_fd( HANDLE handle, unsigned int access, int *unix_fd,
                                int *needs_close, enum server_fd_type *type, unsigned int *options ) DECLSPEC_HIDDEN;
 extern int server_pipe( int fd[2] ) DECLSPEC_HIDDEN;
+extern int receive_fd( obj_handle_t *handle ) DECLSPEC_HIDDEN;
 extern NTSTATUS alloc_object_attributes( const OBJECT_ATTRIBUTES *attr, struct object_attributes **ret,
                                          data_size_t *ret_len ) DECLSPEC_HIDDEN;
 extern NTSTATUS validate_open_object_attributes( const OBJECT_ATTRIBUTES *attr ) DECLSPEC_HIDDEN;
 extern int wait_select_reply( void *cookie ) DECLSPEC_HIDDEN;
 extern BOOL invoke_apc( const apc_call_t *call, apc_result_t *result ) DECLSPEC_HIDDEN;
 
+/* esync support */
+extern int do_esync(void) DECLSPEC_HIDDEN;
+extern void esync_close( HANDLE handle ) DECLSPEC_HIDDEN;
+extern NTSTATUS esync_wait_objects( DWORD count, const HANDLE *handles, BOOLEAN wait_any,
+                                    BOOLEAN alertable, const LARGE_INTEGER *timeout ) DECLSPEC_HIDDEN;
+extern NTSTATUS esync_signal_and_wait( HANDLE signal, HANDLE wait, BOOLEAN alertable,
+                                       const LARGE_INTEGER *timeout ) DECLSPEC_HIDDEN;
+extern NTSTATUS esync_set_event( HANDLE handle ) DECLSPEC_HIDDEN;
+extern NTSTATUS esync_reset_event( HANDLE handle ) DECLSPEC_HIDDEN;
+extern NTSTATUS esync_release_semaphore( HANDLE handle, ULONG count, ULONG *prev ) DECLSPEC_HIDDEN;
+extern NTSTATUS esync_release_mutex( HANDLE handle, unsigned int *prev ) DECLSPEC_HIDDEN;
+
+/* io_uring support */
+extern int do_uring(void) DECLSPEC_HIDDEN;
+extern NTSTATUS uring_submit_rw( HANDLE handle, int fd, HANDLE event, IO_STATUS_BLOCK *io, ULONG_PTR cvalue,
+                                 void *buffer, ULONG length, off_t offset, BOOL write ) DECLSPEC_HIDDEN;
+extern unsigned int uring_cancel( HANDLE handle, IO_STATUS_BLOCK *io, BOOL only_thread ) DECLSPEC_HIDDEN;
+
 /* module handling */
 extern LIST_ENTRY tls_links DECLSPEC_HIDDEN;
 extern FARPROC RELAY_GetProcAddress( HMODULE module, const IMAGE_EXPORT_DIRECTORY *exports,
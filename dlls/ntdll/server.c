@@ -750,7 +750,7 @@ void CDECL wine_server_send_fd( int fd )
  *
  * Receive a file descriptor passed from the server.
  */
-static int receive_fd( obj_handle_t *handle )
+int receive_fd( obj_handle_t *handle )
 {
     struct iovec vec;
     struct msghdr msghdr;
@@ -825,9 +825,16 @@ C_ASSERT( sizeof(union fd_cache_entry) == sizeof(LONG64) );
 #define FD_CACHE_BLOCK_SIZE  (65536 / sizeof(union fd_cache_entry))
 #define FD_CACHE_ENTRIES     128
 
+/* Entries are read and updated with atomic operations only; blocks are never freed once
+ * published, so lookups never need fd_cache_section. The section only serializes the
+ * transfer of fds over the shared fd socket. */
 static union fd_cache_entry *fd_cache[FD_CACHE_ENTRIES];
 static union fd_cache_entry fd_cache_initial_block[FD_CACHE_BLOCK_SIZE];
 
+/* only counted with +server, to keep the lookup free of shared writes */
+static LONG fd_cache_hits;
+static LONG fd_cache_misses;
+
 static inline unsigned int handle_to_index( HANDLE handle, unsigned int *entry )
 {
     unsigned int idx = (wine_server_obj_handle(handle) >> 2) - 1;
@@ -837,15 +844,42 @@ static inline unsigned int handle_to_index( HANDLE handle, unsigned int *entry )
 
 
 /***********************************************************************
- *           add_fd_to_cache
+ *           get_fd_cache_block
  *
- * Caller must hold fd_cache_section.
+ * Return the block of entries for a cache index, allocating it if needed.
+ */
+static union fd_cache_entry *get_fd_cache_block( unsigned int entry )
+{
+    union fd_cache_entry *block;
+    void *ptr;
+
+    if ((block = fd_cache[entry])) return block;
+
+    if (!entry) ptr = fd_cache_initial_block;
+    else
+    {
+        ptr = wine_anon_mmap( NULL, FD_CACHE_BLOCK_SIZE * sizeof(union fd_cache_entry),
+                              PROT_READ | PROT_WRITE, 0 );
+        if (ptr == MAP_FAILED) return NULL;
+    }
+    /* another thread may have published a block in the meantime */
+    if ((block = interlocked_cmpxchg_ptr( (void **)&fd_cache[entry], ptr, NULL )))
+    {
+        if (entry) munmap( ptr, FD_CACHE_BLOCK_SIZE * sizeof(union fd_cache_entry) );
+        return block;
+    }
+    return ptr;
+}
+
+
+/***********************************************************************
+ *           add_fd_to_cache
  */
 static BOOL add_fd_to_cache( HANDLE handle, int fd, enum server_fd_type type,
                             unsigned int access, unsigned int options )
 {
     unsigned int entry, idx = handle_to_index( handle, &entry );
-    union fd_cache_entry cache;
+    union fd_cache_entry cache, *block;
 
     if (entry >= FD_CACHE_ENTRIES)
     {
@@ -853,26 +887,14 @@ static BOOL add_fd_to_cache( HANDLE handle, int fd, enum server_fd_type type,
         return FALSE;
     }
 
-    if (!fd_cache[entry])  /* do we need to allocate a new block of entries? */
-    {
-        if (!entry) fd_cache[0] = fd_cache_initial_block;
-        else
-        {
-            void *ptr = wine_anon_mmap( NULL, FD_CACHE_BLOCK_SIZE * sizeof(union fd_cache_entry),
-                                        PROT_READ | PROT_WRITE, 0 );
-            if (ptr == MAP_FAILED) return FALSE;
-            fd_cache[entry] = ptr;
-        }
-    }
+    if (!(block = get_fd_cache_block( entry ))) return FALSE;
 
     /* store fd+1 so that 0 can be used as the unset value */
     cache.s.fd = fd + 1;
     cache.s.type = type;
     cache.s.access = access;
     cache.s.options = options;
-    cache.data = interlocked_xchg64( &fd_cache[entry][idx].data, cache.data );
-    assert( !cache.s.fd );
-    return TRUE;
+    return !interlocked_cmpxchg64( &block[idx].data, cache.data, 0 );
 }
 
 
@@ -920,6 +942,44 @@ int server_remove_fd_from_cache( HANDLE handle )
 }
 
 
+/***********************************************************************
+ *           server_enter_fd_cache_section
+ *
+ * Must be held around any request whose reply comes with an fd.
+ */
+void server_enter_fd_cache_section( sigset_t *sigset )
+{
+    server_enter_uninterrupted_section( &fd_cache_section, sigset );
+}
+
+
+/***********************************************************************
+ *           server_leave_fd_cache_section
+ */
+void server_leave_fd_cache_section( sigset_t *sigset )
+{
+    server_leave_uninterrupted_section( &fd_cache_section, sigset );
+}
+
+
+/***********************************************************************
+ *           server_receive_cached_fd
+ *
+ * Receive the fd the server sent along with a newly opened handle and
+ * add it to the cache. Caller must hold fd_cache_section.
+ */
+void server_receive_cached_fd( HANDLE handle, enum server_fd_type type,
+                               unsigned int access, unsigned int options )
+{
+    obj_handle_t fd_handle;
+    int fd;
+
+    if ((fd = receive_fd( &fd_handle )) == -1) return;
+    assert( wine_server_ptr_handle(fd_handle) == handle );
+    if (!add_fd_to_cache( handle, fd, type, access, options )) close( fd );
+}
+
+
 /***********************************************************************
  *           server_get_unix_fd
  *
@@ -938,12 +998,20 @@ int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
     wanted_access &= FILE_READ_DATA | FILE_WRITE_DATA | FILE_APPEND_DATA;
 
     ret = get_cached_fd( handle, &fd, type, &access, options );
-    if (ret != STATUS_INVALID_HANDLE) goto done;
+    if (ret != STATUS_INVALID_HANDLE)
+    {
+        if (TRACE_ON(server)) interlocked_xchg_add( &fd_cache_hits, 1 );
+        goto done;
+    }
 
     server_enter_uninterrupted_section( &fd_cache_section, &sigset );
     ret = get_cached_fd( handle, &fd, type, &access, options );
     if (ret == STATUS_INVALID_HANDLE)
     {
+        if (TRACE_ON(server))
+            TRACE( "cache miss for %p, %d hits %d misses\n", handle, fd_cache_hits,
+                   interlocked_xchg_add( &fd_cache_misses, 1 ) + 1 );
+
         SERVER_START_REQ( get_handle_fd )
         {
             req->handle = wine_server_obj_handle( handle );
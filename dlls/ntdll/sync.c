@@ -26,6 +26,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <signal.h>
 #ifdef HAVE_SYS_TIME_H
 # include <sys/time.h>
@@ -42,6 +43,9 @@
 #ifdef HAVE_SCHED_H
 # include <sched.h>
 #endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
 #include <string.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -270,6 +274,10 @@ NTSTATUS WINAPI NtQuerySemaphore( HANDLE handle, SEMAPHORE_INFORMATION_CLASS cla
 NTSTATUS WINAPI NtReleaseSemaphore( HANDLE handle, ULONG count, PULONG previous )
 {
     NTSTATUS ret;
+
+    if ((ret = esync_release_semaphore( handle, count, previous )) != STATUS_NOT_IMPLEMENTED)
+        return ret;
+
     SERVER_START_REQ( release_semaphore )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -350,6 +358,8 @@ NTSTATUS WINAPI NtSetEvent( HANDLE handle, PULONG NumberOfThreadsReleased )
 
     /* FIXME: set NumberOfThreadsReleased */
 
+    if ((ret = esync_set_event( handle )) != STATUS_NOT_IMPLEMENTED) return ret;
+
     SERVER_START_REQ( event_op )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -370,6 +380,8 @@ NTSTATUS WINAPI NtResetEvent( HANDLE handle, PULONG NumberOfThreadsReleased )
     /* resetting an event can't release any thread... */
     if (NumberOfThreadsReleased) *NumberOfThreadsReleased = 0;
 
+    if ((ret = esync_reset_event( handle )) != STATUS_NOT_IMPLEMENTED) return ret;
+
     SERVER_START_REQ( event_op )
     {
         req->handle = wine_server_obj_handle( handle );
@@ -513,6 +525,13 @@ NTSTATUS WINAPI NtOpenMutant( HANDLE *handle, ACCESS_MASK access, const OBJECT_A
 NTSTATUS WINAPI NtReleaseMutant( IN HANDLE handle, OUT PLONG prev_count OPTIONAL)
 {
     NTSTATUS    status;
+    unsigned int prev;
+
+    if ((status = esync_release_mutex( handle, &prev )) != STATUS_NOT_IMPLEMENTED)
+    {
+        if (!status && prev_count) *prev_count = 1 - prev;
+        return status;
+    }
 
     SERVER_START_REQ( release_mutex )
     {
@@ -1026,9 +1045,13 @@ static NTSTATUS wait_objects( DWORD count, const HANDLE *handles,
 {
     select_op_t select_op;
     UINT i, flags = SELECT_INTERRUPTIBLE;
+    NTSTATUS ret;
 
     if (!count || count > MAXIMUM_WAIT_OBJECTS) return STATUS_INVALID_PARAMETER_1;
 
+    ret = esync_wait_objects( count, handles, wait_any, alertable, timeout );
+    if (ret != STATUS_NOT_IMPLEMENTED) return ret;
+
     if (alertable) flags |= SELECT_ALERTABLE;
     select_op.wait.op = wait_any ? SELECT_WAIT : SELECT_WAIT_ALL;
     for (i = 0; i < count; i++) select_op.wait.handles[i] = wine_server_obj_handle( handles[i] );
@@ -1065,8 +1088,13 @@ NTSTATUS WINAPI NtSignalAndWaitForSingleObject( HANDLE hSignalObject, HANDLE hWa
     select_op_t select_op;
     UINT flags = SELECT_INTERRUPTIBLE;
 
+    NTSTATUS ret;
+
     if (!hSignalObject) return STATUS_INVALID_HANDLE;
 
+    ret = esync_signal_and_wait( hSignalObject, hWaitObject, alertable, timeout );
+    if (ret != STATUS_NOT_IMPLEMENTED) return ret;
+
     if (alertable) flags |= SELECT_ALERTABLE;
     select_op.signal_and_wait.op = SELECT_SIGNAL_AND_WAIT;
     select_op.signal_and_wait.wait = wine_server_obj_handle( hWaitObject );
@@ -1603,6 +1631,425 @@ DWORD WINAPI RtlRunOnceExecuteOnce( RTL_RUN_ONCE *once, PRTL_RUN_ONCE_INIT_FN fu
 }
 
 
+#ifdef __linux__
+
+/* Futex-based fast paths
+ *
+ * SRW locks, condition variables and RtlWaitOnAddress only ever synchronize
+ * threads of the current process, so on Linux they can block directly on a
+ * private futex instead of going through the process keyed event, which
+ * costs a server round trip for every contended wait and wake. The keyed
+ * event implementation below is used when futexes are not available.
+ */
+
+static int wait_op = 128; /*FUTEX_WAIT|FUTEX_PRIVATE_FLAG*/
+static int wake_op = 129; /*FUTEX_WAKE|FUTEX_PRIVATE_FLAG*/
+
+#define FUTEX_WAIT_BITSET 9
+#define FUTEX_WAKE_BITSET 10
+
+#define TICKSPERSEC 10000000
+
+static inline int futex_wait( const int *addr, int val, struct timespec *timeout )
+{
+    return syscall( __NR_futex, addr, wait_op, val, timeout, 0, 0 );
+}
+
+static inline int futex_wake( const int *addr, int val )
+{
+    return syscall( __NR_futex, addr, wake_op, val, NULL, 0, 0 );
+}
+
+/* wait_op is FUTEX_WAIT (0) with the private flag, so it can be used to build the bitset ops */
+
+static inline int futex_wait_bitset( const int *addr, int val, int mask )
+{
+    return syscall( __NR_futex, addr, wait_op | FUTEX_WAIT_BITSET, val, NULL, 0, mask );
+}
+
+static inline int futex_wake_bitset( const int *addr, int val, int mask )
+{
+    return syscall( __NR_futex, addr, wait_op | FUTEX_WAKE_BITSET, val, NULL, 0, mask );
+}
+
+static inline int use_futexes(void)
+{
+    static int supported = -1;
+
+    if (supported == -1)
+    {
+        futex_wait( &supported, 10, NULL );
+        if (errno == ENOSYS)
+        {
+            wait_op = 0; /*FUTEX_WAIT*/
+            wake_op = 1; /*FUTEX_WAKE*/
+            futex_wait( &supported, 10, NULL );
+        }
+        supported = (errno != ENOSYS);
+    }
+    return supported;
+}
+
+/* convert an NT timeout to the relative timespec expected by FUTEX_WAIT */
+static void timespec_from_timeout( struct timespec *timespec, const LARGE_INTEGER *timeout )
+{
+    LARGE_INTEGER now;
+    LONGLONG diff;
+
+    if (timeout->QuadPart > 0)
+    {
+        NtQuerySystemTime( &now );
+        diff = timeout->QuadPart - now.QuadPart;
+    }
+    else
+        diff = -timeout->QuadPart;
+
+    if (diff < 0) diff = 0;
+    timespec->tv_sec  = diff / TICKSPERSEC;
+    timespec->tv_nsec = (diff % TICKSPERSEC) * 100;
+}
+
+static inline int futex_wait_timeout( const int *addr, int val, const LARGE_INTEGER *timeout )
+{
+    struct timespec timespec;
+
+    if (!timeout || timeout->QuadPart == TIMEOUT_INFINITE) return futex_wait( addr, val, NULL );
+    timespec_from_timeout( &timespec, timeout );
+    return futex_wait( addr, val, &timespec );
+}
+
+/* Futex-based SRW lock layout:
+ *
+ * 32 31            16 15 14            0
+ *  ________________ _____________________
+ * | X| #exclusive  | S|   #shared       |
+ *  ¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯
+ * X is set while the lock is owned exclusively, #exclusive counts the threads
+ * waiting for exclusive access, S is set when threads are waiting for shared
+ * access and #shared counts the current shared owners. Exclusive waiters are
+ * preferred: no new shared owner is admitted while #exclusive is non-zero.
+ * Waiters of each kind sleep on the lock word itself, told apart by the
+ * futex bitset so that a release only wakes the kind of thread it admits.
+ */
+
+#define SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT     0x80000000
+#define SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK 0x7fff0000
+#define SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_INC  0x00010000
+#define SRWLOCK_FUTEX_SHARED_WAITERS_BIT     0x00008000
+#define SRWLOCK_FUTEX_SHARED_OWNERS_MASK     0x00007fff
+#define SRWLOCK_FUTEX_SHARED_OWNERS_INC      0x00000001
+
+#define SRWLOCK_FUTEX_BITSET_EXCLUSIVE  1
+#define SRWLOCK_FUTEX_BITSET_SHARED     2
+
+static NTSTATUS fast_try_acquire_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    int old;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        old = *(int *)lock;
+        if ((old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) || (old & SRWLOCK_FUTEX_SHARED_OWNERS_MASK))
+            return STATUS_TIMEOUT;
+    } while (interlocked_cmpxchg( (int *)lock, old | SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT, old ) != old);
+
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_acquire_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    int old, new;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    /* fast path for an uncontended lock */
+    if (!interlocked_cmpxchg( (int *)lock, SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT, 0 ))
+        return STATUS_SUCCESS;
+
+    do
+    {
+        old = *(int *)lock;
+        new = old + SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_INC;
+        if (!(new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)) RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+    } while (interlocked_cmpxchg( (int *)lock, new, old ) != old);
+
+    for (;;)
+    {
+        do
+        {
+            old = *(int *)lock;
+            if (!(old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) && !(old & SRWLOCK_FUTEX_SHARED_OWNERS_MASK))
+                new = (old | SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) - SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_INC;
+            else
+                new = old;
+        } while (interlocked_cmpxchg( (int *)lock, new, old ) != old);
+
+        if (new != old) return STATUS_SUCCESS;
+        futex_wait_bitset( (int *)lock, new, SRWLOCK_FUTEX_BITSET_EXCLUSIVE );
+    }
+}
+
+static NTSTATUS fast_try_acquire_srw_shared( RTL_SRWLOCK *lock )
+{
+    int old, new;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        old = *(int *)lock;
+        if ((old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) || (old & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK))
+            return STATUS_TIMEOUT;
+        new = old + SRWLOCK_FUTEX_SHARED_OWNERS_INC;
+        if (!(new & SRWLOCK_FUTEX_SHARED_OWNERS_MASK)) RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+    } while (interlocked_cmpxchg( (int *)lock, new, old ) != old);
+
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_acquire_srw_shared( RTL_SRWLOCK *lock )
+{
+    int old, new;
+    BOOL wait;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    for (;;)
+    {
+        do
+        {
+            old = *(int *)lock;
+            if (!(old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) && !(old & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK))
+            {
+                new = old + SRWLOCK_FUTEX_SHARED_OWNERS_INC;
+                if (!(new & SRWLOCK_FUTEX_SHARED_OWNERS_MASK)) RtlRaiseStatus( STATUS_RESOURCE_NOT_OWNED );
+                wait = FALSE;
+            }
+            else
+            {
+                new = old | SRWLOCK_FUTEX_SHARED_WAITERS_BIT;
+                wait = TRUE;
+            }
+        } while (interlocked_cmpxchg( (int *)lock, new, old ) != old);
+
+        if (!wait) return STATUS_SUCCESS;
+        futex_wait_bitset( (int *)lock, new, SRWLOCK_FUTEX_BITSET_SHARED );
+    }
+}
+
+static NTSTATUS fast_release_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    int old, new;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        old = *(int *)lock;
+        if (!(old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT))
+        {
+            ERR( "Lock %p is not owned exclusive! (%#x)\n", lock, old );
+            return STATUS_RESOURCE_NOT_OWNED;
+        }
+        new = old & ~SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT;
+        if (!(new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK))
+            new &= ~SRWLOCK_FUTEX_SHARED_WAITERS_BIT;
+    } while (interlocked_cmpxchg( (int *)lock, new, old ) != old);
+
+    if (new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK)
+        futex_wake_bitset( (int *)lock, 1, SRWLOCK_FUTEX_BITSET_EXCLUSIVE );
+    else if (old & SRWLOCK_FUTEX_SHARED_WAITERS_BIT)
+        futex_wake_bitset( (int *)lock, INT_MAX, SRWLOCK_FUTEX_BITSET_SHARED );
+
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_release_srw_shared( RTL_SRWLOCK *lock )
+{
+    int old, new;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        old = *(int *)lock;
+        if ((old & SRWLOCK_FUTEX_EXCLUSIVE_LOCK_BIT) || !(old & SRWLOCK_FUTEX_SHARED_OWNERS_MASK))
+        {
+            ERR( "Lock %p is not owned shared! (%#x)\n", lock, old );
+            return STATUS_RESOURCE_NOT_OWNED;
+        }
+        new = old - SRWLOCK_FUTEX_SHARED_OWNERS_INC;
+    } while (interlocked_cmpxchg( (int *)lock, new, old ) != old);
+
+    /* only the last shared owner needs to let an exclusive waiter in */
+    if (!(new & SRWLOCK_FUTEX_SHARED_OWNERS_MASK) && (new & SRWLOCK_FUTEX_EXCLUSIVE_WAITERS_MASK))
+        futex_wake_bitset( (int *)lock, 1, SRWLOCK_FUTEX_BITSET_EXCLUSIVE );
+
+    return STATUS_SUCCESS;
+}
+
+/* Futex-based condition variables use the variable as a sequence number,
+ * bumped by 2 on every wake. Bit 0 is set by sleepers so that wakes can skip
+ * the syscall when nobody is waiting; only WakeAll may clear it, since a
+ * single wake cannot know whether other sleepers remain. */
+
+static NTSTATUS fast_wait_cv( RTL_CONDITION_VARIABLE *variable, int val, const LARGE_INTEGER *timeout )
+{
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    if (futex_wait_timeout( (int *)&variable->Ptr, val, timeout ) == -1 && errno == ETIMEDOUT)
+        return STATUS_TIMEOUT;
+    return STATUS_SUCCESS;
+}
+
+static inline int fast_prepare_wait_cv( RTL_CONDITION_VARIABLE *variable )
+{
+    int val = *(int *)&variable->Ptr;
+
+    while (!(val & 1))
+    {
+        int tmp = interlocked_cmpxchg( (int *)&variable->Ptr, val | 1, val );
+        if (tmp == val) return val | 1;
+        val = tmp;
+    }
+    return val;
+}
+
+static NTSTATUS fast_wake_cv( RTL_CONDITION_VARIABLE *variable, int count )
+{
+    int old, new;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    do
+    {
+        old = *(int *)&variable->Ptr;
+        if (!(old & 1)) return STATUS_SUCCESS;
+        new = old + 2;
+        if (count == INT_MAX) new &= ~1;
+    } while (interlocked_cmpxchg( (int *)&variable->Ptr, new, old ) != old);
+
+    futex_wake( (int *)&variable->Ptr, count );
+    return STATUS_SUCCESS;
+}
+
+/* RtlWaitOnAddress can be used on any address and size, so waiters sleep on
+ * a futex taken from a small hashed table of buckets. Waking an address bumps
+ * its bucket and wakes every thread sleeping on it; waiters of other
+ * addresses hashing to the same bucket see a spurious wakeup, which callers
+ * of RtlWaitOnAddress have to handle anyway. */
+
+static int addr_futex_table[256];
+
+static inline int *hash_addr( const void *addr )
+{
+    ULONG_PTR val = (ULONG_PTR)addr;
+
+    return &addr_futex_table[(val >> 2) & 255];
+}
+
+static BOOL compare_addr( const void *addr, const void *cmp, SIZE_T size );
+
+static NTSTATUS fast_wait_addr( const void *addr, const void *cmp, SIZE_T size,
+                                const LARGE_INTEGER *timeout )
+{
+    int *futex;
+    int val;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    futex = hash_addr( addr );
+
+    /* read the bucket before comparing, so that a wake racing with the
+     * comparison changes it and makes the futex wait return immediately */
+    val = interlocked_cmpxchg( futex, 0, 0 );
+    if (!compare_addr( addr, cmp, size )) return STATUS_SUCCESS;
+
+    if (futex_wait_timeout( futex, val, timeout ) == -1 && errno == ETIMEDOUT)
+        return STATUS_TIMEOUT;
+    return STATUS_SUCCESS;
+}
+
+static NTSTATUS fast_wake_addr( const void *addr )
+{
+    int *futex;
+
+    if (!use_futexes()) return STATUS_NOT_IMPLEMENTED;
+
+    futex = hash_addr( addr );
+    interlocked_xchg_add( futex, 1 );
+    futex_wake( futex, INT_MAX );
+    return STATUS_SUCCESS;
+}
+
+#else
+
+static inline int use_futexes(void)
+{
+    return 0;
+}
+
+static NTSTATUS fast_try_acquire_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_acquire_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_try_acquire_srw_shared( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_acquire_srw_shared( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_release_srw_exclusive( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_release_srw_shared( RTL_SRWLOCK *lock )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_wait_cv( RTL_CONDITION_VARIABLE *variable, int val, const LARGE_INTEGER *timeout )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static inline int fast_prepare_wait_cv( RTL_CONDITION_VARIABLE *variable )
+{
+    return 0;
+}
+
+static NTSTATUS fast_wake_cv( RTL_CONDITION_VARIABLE *variable, int count )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_wait_addr( const void *addr, const void *cmp, SIZE_T size,
+                                const LARGE_INTEGER *timeout )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static NTSTATUS fast_wake_addr( const void *addr )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+#endif
+
+
 /* SRW locks implementation
  *
  * The memory layout used by the lock is:
@@ -1730,9 +2177,10 @@ static inline void srwlock_leave_shared( RTL_SRWLOCK *lock, unsigned int val )
  * NOTES
  *  Please note that SRWLocks do not keep track of the owner of a lock.
  *  It doesn't make any difference which thread for example unlocks an
- *  SRWLock (see corresponding tests). This implementation uses two
- *  keyed events (one for the exclusive waiters and one for the shared
- *  waiters) and is limited to 2^15-1 waiting threads.
+ *  SRWLock (see corresponding tests). On Linux waiters block on a futex
+ *  on the lock itself, otherwise this implementation uses two keyed
+ *  events (one for the exclusive waiters and one for the shared
+ *  waiters). Both are limited to 2^15-1 waiting threads.
  */
 void WINAPI RtlInitializeSRWLock( RTL_SRWLOCK *lock )
 {
@@ -1749,6 +2197,9 @@ void WINAPI RtlInitializeSRWLock( RTL_SRWLOCK *lock )
  */
 void WINAPI RtlAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 {
+    if (fast_acquire_srw_exclusive( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     if (srwlock_lock_exclusive( (unsigned int *)&lock->Ptr, SRWLOCK_RES_EXCLUSIVE ))
         NtWaitForKeyedEvent( 0, srwlock_key_exclusive(lock), FALSE, NULL );
 }
@@ -1763,6 +2214,10 @@ void WINAPI RtlAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 void WINAPI RtlAcquireSRWLockShared( RTL_SRWLOCK *lock )
 {
     unsigned int val, tmp;
+
+    if (fast_acquire_srw_shared( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     /* Acquires a shared lock. If it's currently not possible to add elements to
      * the shared queue, then request exclusive access instead. */
     for (val = *(unsigned int *)&lock->Ptr;; val = tmp)
@@ -1793,6 +2248,9 @@ void WINAPI RtlAcquireSRWLockShared( RTL_SRWLOCK *lock )
  */
 void WINAPI RtlReleaseSRWLockExclusive( RTL_SRWLOCK *lock )
 {
+    if (fast_release_srw_exclusive( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     srwlock_leave_exclusive( lock, srwlock_unlock_exclusive( (unsigned int *)&lock->Ptr,
                              - SRWLOCK_RES_EXCLUSIVE ) - SRWLOCK_RES_EXCLUSIVE );
 }
@@ -1802,6 +2260,9 @@ void WINAPI RtlReleaseSRWLockExclusive( RTL_SRWLOCK *lock )
  */
 void WINAPI RtlReleaseSRWLockShared( RTL_SRWLOCK *lock )
 {
+    if (fast_release_srw_shared( lock ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     srwlock_leave_shared( lock, srwlock_lock_exclusive( (unsigned int *)&lock->Ptr,
                           - SRWLOCK_RES_SHARED ) - SRWLOCK_RES_SHARED );
 }
@@ -1815,6 +2276,11 @@ void WINAPI RtlReleaseSRWLockShared( RTL_SRWLOCK *lock )
  */
 BOOLEAN WINAPI RtlTryAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 {
+    NTSTATUS ret;
+
+    if ((ret = fast_try_acquire_srw_exclusive( lock )) != STATUS_NOT_IMPLEMENTED)
+        return (ret == STATUS_SUCCESS);
+
     return interlocked_cmpxchg( (int *)&lock->Ptr, SRWLOCK_MASK_IN_EXCLUSIVE |
                                 SRWLOCK_RES_EXCLUSIVE, 0 ) == 0;
 }
@@ -1825,6 +2291,11 @@ BOOLEAN WINAPI RtlTryAcquireSRWLockExclusive( RTL_SRWLOCK *lock )
 BOOLEAN WINAPI RtlTryAcquireSRWLockShared( RTL_SRWLOCK *lock )
 {
     unsigned int val, tmp;
+    NTSTATUS ret;
+
+    if ((ret = fast_try_acquire_srw_shared( lock )) != STATUS_NOT_IMPLEMENTED)
+        return (ret == STATUS_SUCCESS);
+
     for (val = *(unsigned int *)&lock->Ptr;; val = tmp)
     {
         if (val & SRWLOCK_MASK_EXCLUSIVE_QUEUE)
@@ -1868,6 +2339,9 @@ void WINAPI RtlInitializeConditionVariable( RTL_CONDITION_VARIABLE *variable )
  */
 void WINAPI RtlWakeConditionVariable( RTL_CONDITION_VARIABLE *variable )
 {
+    if (fast_wake_cv( variable, 1 ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     if (interlocked_dec_if_nonzero( (int *)&variable->Ptr ))
         NtReleaseKeyedEvent( 0, &variable->Ptr, FALSE, NULL );
 }
@@ -1879,7 +2353,12 @@ void WINAPI RtlWakeConditionVariable( RTL_CONDITION_VARIABLE *variable )
  */
 void WINAPI RtlWakeAllConditionVariable( RTL_CONDITION_VARIABLE *variable )
 {
-    int val = interlocked_xchg( (int *)&variable->Ptr, 0 );
+    int val;
+
+    if (fast_wake_cv( variable, INT_MAX ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
+    val = interlocked_xchg( (int *)&variable->Ptr, 0 );
     while (val-- > 0)
         NtReleaseKeyedEvent( 0, &variable->Ptr, FALSE, NULL );
 }
@@ -1903,9 +2382,18 @@ NTSTATUS WINAPI RtlSleepConditionVariableCS( RTL_CONDITION_VARIABLE *variable, R
                                              const LARGE_INTEGER *timeout )
 {
     NTSTATUS status;
-    interlocked_xchg_add( (int *)&variable->Ptr, 1 );
+    int val = 0;
+
+    if (use_futexes())
+        val = fast_prepare_wait_cv( variable );
+    else
+        interlocked_xchg_add( (int *)&variable->Ptr, 1 );
+
     RtlLeaveCriticalSection( crit );
 
+    if ((status = fast_wait_cv( variable, val, timeout )) != STATUS_NOT_IMPLEMENTED)
+        goto done;
+
     status = NtWaitForKeyedEvent( 0, &variable->Ptr, FALSE, timeout );
     if (status != STATUS_SUCCESS)
     {
@@ -1913,6 +2401,7 @@ NTSTATUS WINAPI RtlSleepConditionVariableCS( RTL_CONDITION_VARIABLE *variable, R
             status = NtWaitForKeyedEvent( 0, &variable->Ptr, FALSE, NULL );
     }
 
+done:
     RtlEnterCriticalSection( crit );
     return status;
 }
@@ -1940,13 +2429,21 @@ NTSTATUS WINAPI RtlSleepConditionVariableSRW( RTL_CONDITION_VARIABLE *variable,
                                               const LARGE_INTEGER *timeout, ULONG flags )
 {
     NTSTATUS status;
-    interlocked_xchg_add( (int *)&variable->Ptr, 1 );
+    int val = 0;
+
+    if (use_futexes())
+        val = fast_prepare_wait_cv( variable );
+    else
+        interlocked_xchg_add( (int *)&variable->Ptr, 1 );
 
     if (flags & RTL_CONDITION_VARIABLE_LOCKMODE_SHARED)
         RtlReleaseSRWLockShared( lock );
     else
         RtlReleaseSRWLockExclusive( lock );
 
+    if ((status = fast_wait_cv( variable, val, timeout )) != STATUS_NOT_IMPLEMENTED)
+        goto done;
+
     status = NtWaitForKeyedEvent( 0, &variable->Ptr, FALSE, timeout );
     if (status != STATUS_SUCCESS)
     {
@@ -1954,6 +2451,7 @@ NTSTATUS WINAPI RtlSleepConditionVariableSRW( RTL_CONDITION_VARIABLE *variable,
             status = NtWaitForKeyedEvent( 0, &variable->Ptr, FALSE, NULL );
     }
 
+done:
     if (flags & RTL_CONDITION_VARIABLE_LOCKMODE_SHARED)
         RtlAcquireSRWLockShared( lock );
     else
@@ -2005,6 +2503,9 @@ NTSTATUS WINAPI RtlWaitOnAddress( const void *addr, const void *cmp, SIZE_T size
     if (size != 1 && size != 2 && size != 4 && size != 8)
         return STATUS_INVALID_PARAMETER;
 
+    if ((ret = fast_wait_addr( addr, cmp, size, timeout )) != STATUS_NOT_IMPLEMENTED)
+        return ret;
+
     select_op.keyed_event.op     = SELECT_KEYED_EVENT_WAIT;
     select_op.keyed_event.handle = wine_server_obj_handle( keyed_event );
     select_op.keyed_event.key    = wine_server_client_ptr( addr );
@@ -2059,6 +2560,9 @@ NTSTATUS WINAPI RtlWaitOnAddress( const void *addr, const void *cmp, SIZE_T size
  */
 void WINAPI RtlWakeAddressAll( const void *addr )
 {
+    if (fast_wake_addr( addr ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     RtlEnterCriticalSection( &addr_section );
     while (NtReleaseKeyedEvent( 0, addr, 0, &zero_timeout ) == STATUS_SUCCESS) {}
     RtlLeaveCriticalSection( &addr_section );
@@ -2069,6 +2573,9 @@ void WINAPI RtlWakeAddressAll( const void *addr )
  */
 void WINAPI RtlWakeAddressSingle( const void *addr )
 {
+    if (fast_wake_addr( addr ) != STATUS_NOT_IMPLEMENTED)
+        return;
+
     RtlEnterCriticalSection( &addr_section );
     NtReleaseKeyedEvent( 0, addr, 0, &zero_timeout );
     RtlLeaveCriticalSection( &addr_section );
@@ -74,6 +74,10 @@ static NTSTATUS (WINAPI *pNtQuerySystemTime)( LARGE_INTEGER * );
 static NTSTATUS (WINAPI *pRtlWaitOnAddress)( const void *, const void *, SIZE_T, const LARGE_INTEGER * );
 static void     (WINAPI *pRtlWakeAddressAll)( const void * );
 static void     (WINAPI *pRtlWakeAddressSingle)( const void * );
+static void     (WINAPI *pRtlAcquireSRWLockExclusive)( RTL_SRWLOCK * );
+static void     (WINAPI *pRtlAcquireSRWLockShared)( RTL_SRWLOCK * );
+static void     (WINAPI *pRtlReleaseSRWLockExclusive)( RTL_SRWLOCK * );
+static void     (WINAPI *pRtlReleaseSRWLockShared)( RTL_SRWLOCK * );
 
 #define KEYEDEVENT_WAIT       0x0001
 #define KEYEDEVENT_WAKE       0x0002
@@ -2141,6 +2145,162 @@ static void test_wait_on_address(void)
     ok(address == 0, "got %s\n", wine_dbgstr_longlong(address));
 }
 
+static LONG wait_address;
+
+static DWORD WINAPI wake_address_thread( void *arg )
+{
+    Sleep( 50 );
+    InterlockedExchange( &wait_address, 1 );
+    pRtlWakeAddressSingle( &wait_address );
+    return 0;
+}
+
+static void test_wake_address_thread(void)
+{
+    LONG compare = 0;
+    NTSTATUS status;
+    HANDLE thread;
+    DWORD ret;
+
+    if (!pRtlWaitOnAddress)
+    {
+        win_skip("RtlWaitOnAddress not supported, skipping test\n");
+        return;
+    }
+
+    wait_address = 0;
+    thread = CreateThread( NULL, 0, wake_address_thread, NULL, 0, NULL );
+    while (wait_address == compare)
+    {
+        status = pRtlWaitOnAddress( &wait_address, &compare, sizeof(compare), NULL );
+        ok( !status, "got 0x%08x\n", status );
+    }
+    ok( wait_address == 1, "got %d\n", wait_address );
+    ret = WaitForSingleObject( thread, 1000 );
+    ok( !ret, "WaitForSingleObject returned %u\n", ret );
+    CloseHandle( thread );
+}
+
+struct srwlock_contention
+{
+    RTL_SRWLOCK lock;
+    LONG iterations;
+    LONG counter;
+    LONG exclusive;
+    LONG errors;
+};
+
+static DWORD WINAPI srwlock_contention_thread( void *arg )
+{
+    struct srwlock_contention *info = arg;
+    LONG i;
+
+    for (i = 0; i < info->iterations; i++)
+    {
+        if (i % 4)
+        {
+            pRtlAcquireSRWLockExclusive( &info->lock );
+            if (InterlockedIncrement( &info->exclusive ) != 1) InterlockedIncrement( &info->errors );
+            info->counter++;
+            InterlockedDecrement( &info->exclusive );
+            pRtlReleaseSRWLockExclusive( &info->lock );
+        }
+        else
+        {
+            pRtlAcquireSRWLockShared( &info->lock );
+            if (info->exclusive) InterlockedIncrement( &info->errors );
+            pRtlReleaseSRWLockShared( &info->lock );
+        }
+    }
+    return 0;
+}
+
+static void test_srwlock_contention(void)
+{
+    struct srwlock_contention info;
+    HANDLE threads[4];
+    DWORD ret;
+    LONG expect;
+    int i;
+
+    if (!pRtlAcquireSRWLockExclusive)
+    {
+        win_skip("SRW locks not supported, skipping test\n");
+        return;
+    }
+
+    memset( &info, 0, sizeof(info) );
+    info.iterations = 20000;
+
+    for (i = 0; i < ARRAY_SIZE(threads); i++)
+        threads[i] = CreateThread( NULL, 0, srwlock_contention_thread, &info, 0, NULL );
+    ret = WaitForMultipleObjects( ARRAY_SIZE(threads), threads, TRUE, 60000 );
+    ok( !ret, "WaitForMultipleObjects returned %u\n", ret );
+    for (i = 0; i < ARRAY_SIZE(threads); i++) CloseHandle( threads[i] );
+
+    expect = ARRAY_SIZE(threads) * (info.iterations - (info.iterations + 3) / 4);
+    ok( info.counter == expect, "got counter %d, expected %d\n", info.counter, expect );
+    ok( !info.errors, "got %d errors\n", info.errors );
+}
+
+struct server_stress
+{
+    LONG iterations;
+    LONG errors;
+};
+
+static DWORD WINAPI server_stress_thread( void *arg )
+{
+    static const WCHAR keyW[] = {'\\','R','e','g','i','s','t','r','y','\\',
+                                 'M','a','c','h','i','n','e','\\','S','o','f','t','w','a','r','e',0};
+    struct server_stress *info = arg;
+    OBJECT_ATTRIBUTES attr;
+    UNICODE_STRING str;
+    char buffer[1024];
+    NTSTATUS status;
+    HANDLE key;
+    ULONG len;
+    LONG i;
+
+    pRtlInitUnicodeString( &str, keyW );
+    InitializeObjectAttributes( &attr, &str, OBJ_CASE_INSENSITIVE, 0, NULL );
+
+    for (i = 0; i < info->iterations; i++)
+    {
+        status = pNtOpenKey( &key, KEY_READ, &attr );
+        if (status)
+        {
+            InterlockedIncrement( &info->errors );
+            continue;
+        }
+        status = pNtQueryObject( key, ObjectNameInformation, buffer, sizeof(buffer), &len );
+        if (status || lstrcmpiW( ((UNICODE_STRING *)buffer)->Buffer, keyW ))
+            InterlockedIncrement( &info->errors );
+        pNtClose( key );
+    }
+    return 0;
+}
+
+/* drive the server from several threads at once */
+static void test_server_stress(void)
+{
+    struct server_stress info;
+    HANDLE threads[4];
+    DWORD ret;
+    int i;
+
+    memset( &info, 0, sizeof(info) );
+    info.iterations = 2000;
+
+    for (i = 0; i < ARRAY_SIZE(threads); i++)
+        threads[i] = CreateThread( NULL, 0, server_stress_thread, &info, 0, NULL );
+    ret = WaitForMultipleObjects( ARRAY_SIZE(threads), threads, TRUE, 60000 );
+    ok( !ret, "WaitForMultipleObjects returned %u\n", ret );
+    for (i = 0; i < ARRAY_SIZE(threads); i++) CloseHandle( threads[i] );
+
+    ok( !info.errors, "got %d errors\n", info.errors );
+}
+
 START_TEST(om)
 {
     HMODULE hntdll = GetModuleHandleA("ntdll.dll");
@@ -2198,6 +2358,10 @@ START_TEST(om)
     pRtlWaitOnAddress       =  (void *)GetProcAddress(hntdll, "RtlWaitOnAddress");
     pRtlWakeAddressAll      =  (void *)GetProcAddress(hntdll, "RtlWakeAddressAll");
     pRtlWakeAddressSingle   =  (void *)GetProcAddress(hntdll, "RtlWakeAddressSingle");
+    pRtlAcquireSRWLockExclusive = (void *)GetProcAddress(hntdll, "RtlAcquireSRWLockExclusive");
+    pRtlAcquireSRWLockShared    = (void *)GetProcAddress(hntdll, "RtlAcquireSRWLockShared");
+    pRtlReleaseSRWLockExclusive = (void *)GetProcAddress(hntdll, "RtlReleaseSRWLockExclusive");
+    pRtlReleaseSRWLockShared    = (void *)GetProcAddress(hntdll, "RtlReleaseSRWLockShared");
 
     test_case_sensitive();
     test_namespace_pipe();
@@ -2212,4 +2376,7 @@ START_TEST(om)
     test_keyed_events();
     test_null_device();
     test_wait_on_address();
+    test_wake_address_thread();
+    test_srwlock_contention();
+    test_server_stress();
 }
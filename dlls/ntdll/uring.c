@@ -0,0 +1,453 @@
+/*
+ * io_uring-based overlapped file I/O
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "config.h"
+#include "wine/port.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#ifdef HAVE_SYS_UIO_H
+# include <sys/uio.h>
+#endif
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#ifdef HAVE_LINUX_IO_URING_H
+# include <linux/io_uring.h>
+#endif
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#define NONAMELESSUNION
+#include "windef.h"
+#include "winternl.h"
+#include "wine/debug.h"
+#include "wine/list.h"
+#include "wine/server.h"
+#include "ntdll_misc.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(uring);
+
+#if defined(HAVE_LINUX_IO_URING_H) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+
+/* When WINEIOURING is set, overlapped reads and writes on regular files are
+ * submitted to an io_uring instead of being performed synchronously in
+ * NtReadFile/NtWriteFile. A dedicated thread reaps the completions and fills
+ * the IO_STATUS_BLOCK, signals the event and posts to the completion port.
+ * The completion port is looked up at submit time, since the file handle may
+ * be gone by the time the request completes. Anything that doesn't fit (APC
+ * callbacks, no event or completion port to report the result, full ring, no
+ * kernel support) goes through the normal path. */
+
+#define URING_ENTRIES 256
+
+struct uring_request
+{
+    struct list      entry;    /* entry in the pending list */
+    HANDLE           handle;   /* only used to find the requests to cancel */
+    DWORD            tid;      /* thread that submitted the request */
+    HANDLE           event;
+    IO_STATUS_BLOCK *io;
+    HANDLE           port;     /* private handle to the completion port */
+    ULONG_PTR        ckey;
+    ULONG_PTR        cvalue;
+    int              fd;       /* private fd, closed on completion */
+    BOOL             write;
+    struct iovec     iov;
+    off_t            offset;
+};
+
+static int uring_fd = -1;
+static unsigned int *sq_head, *sq_tail, *sq_mask, *sq_array;
+static unsigned int *cq_head, *cq_tail, *cq_mask;
+static unsigned int sq_entries, cq_entries;
+static struct io_uring_sqe *sqes;
+static struct io_uring_cqe *cqes;
+static LONG inflight;
+static struct list pending_requests = LIST_INIT( pending_requests );
+static int uring_state;      /* 0: not initialized, 1: starting, 2: running, -1: unavailable */
+
+static RTL_CRITICAL_SECTION uring_section;
+static RTL_CRITICAL_SECTION_DEBUG critsect_debug =
+{
+    0, 0, &uring_section,
+    { &critsect_debug.ProcessLocksList, &critsect_debug.ProcessLocksList },
+      0, 0, { (DWORD_PTR)(__FILE__ ": uring_section") }
+};
+static RTL_CRITICAL_SECTION uring_section = { &critsect_debug, -1, 0, 0, 0, 0 };
+
+int do_uring(void)
+{
+    static int enabled = -1;
+
+    if (enabled == -1)
+    {
+        const char *env = getenv( "WINEIOURING" );
+        enabled = env && atoi( env );
+    }
+    return enabled;
+}
+
+static inline int io_uring_enter( int fd, unsigned int to_submit, unsigned int min_complete,
+                                  unsigned int flags )
+{
+    return syscall( __NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0 );
+}
+
+/* perform the operation synchronously, used when the kernel couldn't do it for us */
+static int uring_sync_rw( struct uring_request *req )
+{
+    int ret;
+
+    do
+    {
+        if (req->write) ret = pwrite( req->fd, req->iov.iov_base, req->iov.iov_len, req->offset );
+        else ret = virtual_locked_pread( req->fd, req->iov.iov_base, req->iov.iov_len, req->offset );
+    } while (ret == -1 && errno == EINTR);
+    return ret == -1 ? -errno : ret;
+}
+
+static void uring_complete( struct uring_request *req, int res )
+{
+    NTSTATUS status;
+    ULONG total = 0;
+
+    if (res == -EFAULT || res == -EAGAIN || res == -EINTR) res = uring_sync_rw( req );
+
+    if (res >= 0)
+    {
+        total = res;
+        status = (total || req->write || !req->iov.iov_len) ? STATUS_SUCCESS : STATUS_END_OF_FILE;
+    }
+    else if (res == -ECANCELED) status = STATUS_CANCELLED;
+    else if (res == -EFAULT && req->write) status = STATUS_INVALID_USER_BUFFER;
+    else
+    {
+        errno = -res;
+        status = FILE_GetNtStatus();
+    }
+
+    TRACE( "%p %s %u bytes at %s: %08x\n", req->handle, req->write ? "write" : "read",
+           total, wine_dbgstr_longlong( req->offset ), status );
+
+    RtlEnterCriticalSection( &uring_section );
+    list_remove( &req->entry );
+    RtlLeaveCriticalSection( &uring_section );
+
+    req->io->Information = total;
+    __atomic_store_n( &req->io->u.Status, status, __ATOMIC_RELEASE );
+    if (req->event) NtSetEvent( req->event, NULL );
+    if (req->port)
+    {
+        NtSetIoCompletion( req->port, req->ckey, req->cvalue, status, total );
+        NtClose( req->port );
+    }
+
+    close( req->fd );
+    RtlFreeHeap( GetProcessHeap(), 0, req );
+    interlocked_xchg_add( &inflight, -1 );
+}
+
+static void CALLBACK uring_thread_proc( void *param )
+{
+    unsigned int head, tail;
+
+    uring_state = 2;
+    TRACE( "started\n" );
+
+    for (;;)
+    {
+        if (io_uring_enter( uring_fd, 0, 1, IORING_ENTER_GETEVENTS ) == -1 && errno != EINTR)
+        {
+            ERR( "io_uring_enter failed: %s\n", strerror( errno ));
+            break;
+        }
+
+        head = *cq_head;
+        tail = __atomic_load_n( cq_tail, __ATOMIC_ACQUIRE );
+        while (head != tail)
+        {
+            struct io_uring_cqe *cqe = &cqes[head & *cq_mask];
+            struct uring_request *req = (struct uring_request *)(ULONG_PTR)cqe->user_data;
+            int res = cqe->res;
+
+            __atomic_store_n( cq_head, ++head, __ATOMIC_RELEASE );
+            if (req) uring_complete( req, res );
+            else interlocked_xchg_add( &inflight, -1 );  /* cancel request */
+        }
+    }
+
+    /* requests still in flight will never complete */
+    uring_state = -1;
+    RtlExitUserThread( 0 );
+}
+
+/* queue a submission entry and submit it; caller must hold uring_section */
+static BOOL submit_sqe( const struct io_uring_sqe *entry )
+{
+    unsigned int tail = *sq_tail, idx = tail & *sq_mask;
+    int ret;
+
+    sqes[idx] = *entry;
+    sq_array[idx] = idx;
+    __atomic_store_n( sq_tail, tail + 1, __ATOMIC_RELEASE );
+
+    while ((ret = io_uring_enter( uring_fd, 1, 0, 0 )) == -1 && errno == EINTR);
+    if (ret == 1) return TRUE;
+
+    /* the kernel didn't consume the entry, take it back */
+    __atomic_store_n( sq_tail, tail, __ATOMIC_RELEASE );
+    WARN( "submission failed: %s\n", ret == -1 ? strerror( errno ) : "ring full" );
+    return FALSE;
+}
+
+/* create the ring and start the completion thread; caller must hold uring_section */
+static void init_uring(void)
+{
+    struct io_uring_params params;
+    size_t sq_size, cq_size;
+    char *sq_ring, *cq_ring;
+    HANDLE thread;
+    NTSTATUS status;
+
+    uring_state = -1;
+
+    memset( &params, 0, sizeof(params) );
+    if ((uring_fd = syscall( __NR_io_uring_setup, URING_ENTRIES, &params )) == -1)
+    {
+        WARN( "io_uring not available: %s\n", strerror( errno ));
+        return;
+    }
+    fcntl( uring_fd, F_SETFD, FD_CLOEXEC );
+
+    sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) sq_size = cq_size = max( sq_size, cq_size );
+
+    sq_ring = mmap( NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    uring_fd, IORING_OFF_SQ_RING );
+    if (sq_ring == MAP_FAILED) goto failed;
+    if (params.features & IORING_FEAT_SINGLE_MMAP) cq_ring = sq_ring;
+    else
+    {
+        cq_ring = mmap( NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        uring_fd, IORING_OFF_CQ_RING );
+        if (cq_ring == MAP_FAILED) goto failed;
+    }
+    sqes = mmap( NULL, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, uring_fd, IORING_OFF_SQES );
+    if (sqes == MAP_FAILED) goto failed;
+
+    sq_head  = (unsigned int *)(sq_ring + params.sq_off.head);
+    sq_tail  = (unsigned int *)(sq_ring + params.sq_off.tail);
+    sq_mask  = (unsigned int *)(sq_ring + params.sq_off.ring_mask);
+    sq_array = (unsigned int *)(sq_ring + params.sq_off.array);
+    cq_head  = (unsigned int *)(cq_ring + params.cq_off.head);
+    cq_tail  = (unsigned int *)(cq_ring + params.cq_off.tail);
+    cq_mask  = (unsigned int *)(cq_ring + params.cq_off.ring_mask);
+    cqes     = (struct io_uring_cqe *)(cq_ring + params.cq_off.cqes);
+    sq_entries = params.sq_entries;
+    cq_entries = params.cq_entries;
+
+    /* requests are only submitted once the thread is running, so that
+     * a DllMain waiting on a read doesn't deadlock on its attach */
+    status = RtlCreateUserThread( GetCurrentProcess(), NULL, FALSE, NULL, 0, 0,
+                                  uring_thread_proc, NULL, &thread, NULL );
+    if (status)
+    {
+        ERR( "failed to create completion thread: %08x\n", status );
+        goto failed;
+    }
+    NtClose( thread );
+    uring_state = 1;
+    TRACE( "ring with %u/%u entries\n", sq_entries, cq_entries );
+    return;
+
+failed:
+    WARN( "failed to set up io_uring: %s\n", strerror( errno ));
+    close( uring_fd );
+    uring_fd = -1;
+}
+
+/***********************************************************************
+ *           uring_submit_rw
+ *
+ * Submit an overlapped read or write at an explicit offset of a regular file.
+ * Returns STATUS_PENDING if the request was queued, in which case the fd is
+ * left to the caller; STATUS_NOT_IMPLEMENTED if the caller should perform the
+ * operation itself.
+ */
+NTSTATUS uring_submit_rw( HANDLE handle, int fd, HANDLE event, IO_STATUS_BLOCK *io, ULONG_PTR cvalue,
+                          void *buffer, ULONG length, off_t offset, BOOL write )
+{
+    struct uring_request *req;
+    struct io_uring_sqe sqe;
+    HANDLE port = 0;
+    ULONG_PTR ckey = 0;
+    BOOL ret;
+
+    if (!do_uring() || uring_state < 0) return STATUS_NOT_IMPLEMENTED;
+
+    if (uring_state != 2)
+    {
+        RtlEnterCriticalSection( &uring_section );
+        if (!uring_state) init_uring();
+        RtlLeaveCriticalSection( &uring_section );
+        if (uring_state != 2) return STATUS_NOT_IMPLEMENTED;
+    }
+
+    if (cvalue)
+    {
+        SERVER_START_REQ( get_fd_completion )
+        {
+            req->handle = wine_server_obj_handle( handle );
+            if (!wine_server_call( req ))
+            {
+                port = wine_server_ptr_handle( reply->port );
+                ckey = reply->ckey;
+            }
+        }
+        SERVER_END_REQ;
+    }
+
+    /* without an event or a completion port, the caller can only wait on the file
+     * handle, which is always signaled for regular files */
+    if (!event && !port) return STATUS_NOT_IMPLEMENTED;
+
+    /* never let completions overflow the ring */
+    if (interlocked_xchg_add( &inflight, 1 ) >= cq_entries) goto fallback;
+
+    if (!(req = RtlAllocateHeap( GetProcessHeap(), 0, sizeof(*req) ))) goto fallback;
+    if ((req->fd = dup( fd )) == -1)
+    {
+        RtlFreeHeap( GetProcessHeap(), 0, req );
+        goto fallback;
+    }
+    req->handle       = handle;
+    req->tid          = GetCurrentThreadId();
+    req->event        = event;
+    req->io           = io;
+    req->port         = port;
+    req->ckey         = ckey;
+    req->cvalue       = cvalue;
+    req->write        = write;
+    req->iov.iov_base = buffer;
+    req->iov.iov_len  = length;
+    req->offset       = offset;
+
+    if (event) NtResetEvent( event, NULL );
+
+    memset( &sqe, 0, sizeof(sqe) );
+    sqe.opcode    = write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe.fd        = req->fd;
+    sqe.addr      = (ULONG_PTR)&req->iov;
+    sqe.len       = 1;
+    sqe.off       = offset;
+    sqe.user_data = (ULONG_PTR)req;
+
+    RtlEnterCriticalSection( &uring_section );
+    if ((ret = submit_sqe( &sqe ))) list_add_tail( &pending_requests, &req->entry );
+    RtlLeaveCriticalSection( &uring_section );
+
+    if (!ret)
+    {
+        close( req->fd );
+        RtlFreeHeap( GetProcessHeap(), 0, req );
+        goto fallback;
+    }
+
+    TRACE( "%p %s %u bytes at %s\n", handle, write ? "write" : "read",
+           length, wine_dbgstr_longlong( offset ));
+    return STATUS_PENDING;
+
+fallback:
+    interlocked_xchg_add( &inflight, -1 );
+    if (port) NtClose( port );
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+/***********************************************************************
+ *           uring_cancel
+ *
+ * Request the cancellation of the pending requests of a file handle, either
+ * the ones of the current thread or the one using the given IO_STATUS_BLOCK.
+ * Returns the number of requests found; they still complete through the
+ * normal path, with STATUS_CANCELLED if the kernel could abort them.
+ */
+unsigned int uring_cancel( HANDLE handle, IO_STATUS_BLOCK *io, BOOL only_thread )
+{
+    struct uring_request *req;
+    struct io_uring_sqe sqe;
+    DWORD tid = GetCurrentThreadId();
+    unsigned int count = 0;
+
+    if (uring_state != 2) return 0;
+
+    RtlEnterCriticalSection( &uring_section );
+    LIST_FOR_EACH_ENTRY( req, &pending_requests, struct uring_request, entry )
+    {
+        if (req->handle != handle) continue;
+        if (io && req->io != io) continue;
+        if (only_thread && req->tid != tid) continue;
+        count++;
+
+        if (interlocked_xchg_add( &inflight, 1 ) >= cq_entries)
+        {
+            interlocked_xchg_add( &inflight, -1 );
+            continue;
+        }
+        memset( &sqe, 0, sizeof(sqe) );
+        sqe.opcode = IORING_OP_ASYNC_CANCEL;
+        sqe.addr   = (ULONG_PTR)req;
+        if (!submit_sqe( &sqe )) interlocked_xchg_add( &inflight, -1 );
+    }
+    RtlLeaveCriticalSection( &uring_section );
+
+    TRACE( "%p %p: %u requests\n", handle, io, count );
+    return count;
+}
+
+#else  /* HAVE_LINUX_IO_URING_H */
+
+int do_uring(void)
+{
+    return 0;
+}
+
+NTSTATUS uring_submit_rw( HANDLE handle, int fd, HANDLE event, IO_STATUS_BLOCK *io, ULONG_PTR cvalue,
+                          void *buffer, ULONG length, off_t offset, BOOL write )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+unsigned int uring_cancel( HANDLE handle, IO_STATUS_BLOCK *io, BOOL only_thread )
+{
+    return 0;
+}
+
+#endif  /* HAVE_LINUX_IO_URING_H */
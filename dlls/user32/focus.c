@@ -339,8 +339,11 @@ BOOL WINAPI SetForegroundWindow( HWND hwnd )
  */
 HWND WINAPI GetActiveWindow(void)
 {
+    struct input_shared_state input;
     HWND ret = 0;
 
+    if (get_shared_input_state( &input )) return wine_server_ptr_handle( input.active );
+
     SERVER_START_REQ( get_thread_input )
     {
         req->tid = GetCurrentThreadId();
@@ -356,8 +359,11 @@ HWND WINAPI GetActiveWindow(void)
  */
 HWND WINAPI GetFocus(void)
 {
+    struct input_shared_state input;
     HWND ret = 0;
 
+    if (get_shared_input_state( &input )) return wine_server_ptr_handle( input.focus );
+
     SERVER_START_REQ( get_thread_input )
     {
         req->tid = GetCurrentThreadId();
@@ -373,8 +379,11 @@ HWND WINAPI GetFocus(void)
  */
 HWND WINAPI GetForegroundWindow(void)
 {
+    struct desktop_shared_state desktop;
     HWND ret = 0;
 
+    if (get_shared_desktop_state( &desktop )) return wine_server_ptr_handle( desktop.foreground );
+
     SERVER_START_REQ( get_thread_input )
     {
         req->tid = 0;
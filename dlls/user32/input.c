@@ -249,22 +249,32 @@ void WINAPI mouse_event( DWORD dwFlags, DWORD dx, DWORD dy,
  */
 BOOL WINAPI DECLSPEC_HOTPATCH GetCursorPos( POINT *pt )
 {
+    struct desktop_shared_state desktop;
     BOOL ret;
     DWORD last_change;
     UINT dpi;
 
     if (!pt) return FALSE;
 
-    SERVER_START_REQ( set_cursor )
+    if ((ret = get_shared_desktop_state( &desktop )))
     {
-        if ((ret = !wine_server_call( req )))
+        pt->x = desktop.cursor_x;
+        pt->y = desktop.cursor_y;
+        last_change = desktop.cursor_change;
+    }
+    else
+    {
+        SERVER_START_REQ( set_cursor )
         {
-            pt->x = reply->new_x;
-            pt->y = reply->new_y;
-            last_change = reply->last_change;
+            if ((ret = !wine_server_call( req )))
+            {
+                pt->x = reply->new_x;
+                pt->y = reply->new_y;
+                last_change = reply->last_change;
+            }
         }
+        SERVER_END_REQ;
     }
-    SERVER_END_REQ;
 
     /* query new position from graphics driver if we haven't updated recently */
     if (ret && GetTickCount() - last_change > 100) ret = USER_Driver->pGetCursorPos( pt );
@@ -365,8 +375,11 @@ BOOL WINAPI DECLSPEC_HOTPATCH ReleaseCapture(void)
  */
 HWND WINAPI GetCapture(void)
 {
+    struct input_shared_state input;
     HWND ret = 0;
 
+    if (get_shared_input_state( &input )) return wine_server_ptr_handle( input.capture );
+
     SERVER_START_REQ( get_thread_input )
     {
         req->tid = GetCurrentThreadId();
@@ -393,6 +406,7 @@ static void check_for_events( UINT flags )
 SHORT WINAPI DECLSPEC_HOTPATCH GetAsyncKeyState( INT key )
 {
     struct user_key_state_info *key_state_info = get_user_thread_info()->key_state;
+    struct desktop_shared_state desktop;
     INT counter = global_key_state_counter;
     BYTE prev_key_state;
     SHORT ret;
@@ -403,6 +417,10 @@ SHORT WINAPI DECLSPEC_HOTPATCH GetAsyncKeyState( INT key )
 
     if ((ret = USER_Driver->pGetAsyncKeyState( key )) == -1)
     {
+        /* the server only needs to be called to reset the pressed-since-last-call bit */
+        if (get_shared_desktop_state( &desktop ) && !(desktop.keystate[key] & 0x40))
+            return (desktop.keystate[key] & 0x80) ? 0x8000 : 0;
+
         if (key_state_info &&
             !(key_state_info->state[key] & 0xc0) &&
             key_state_info->counter == counter &&
@@ -455,6 +473,7 @@ SHORT WINAPI DECLSPEC_HOTPATCH GetAsyncKeyState( INT key )
  */
 DWORD WINAPI GetQueueStatus( UINT flags )
 {
+    struct queue_shared_state queue;
     DWORD ret;
 
     if (flags & ~(QS_ALLINPUT | QS_ALLPOSTMESSAGE | QS_SMRESULT))
@@ -465,6 +484,10 @@ DWORD WINAPI GetQueueStatus( UINT flags )
 
     check_for_events( flags );
 
+    /* nothing to clear on the server side if none of the changed bits are set */
+    if (get_shared_queue_state( &queue ) && !(queue.changed_bits & flags))
+        return MAKELONG( 0, queue.wake_bits & flags );
+
     SERVER_START_REQ( get_queue_status )
     {
         req->clear_bits = flags;
@@ -481,10 +504,13 @@ DWORD WINAPI GetQueueStatus( UINT flags )
  */
 BOOL WINAPI GetInputState(void)
 {
+    struct queue_shared_state queue;
     DWORD ret;
 
     check_for_events( QS_INPUT );
 
+    if (get_shared_queue_state( &queue )) return queue.wake_bits & (QS_KEY | QS_MOUSEBUTTON);
+
     SERVER_START_REQ( get_queue_status )
     {
         req->clear_bits = 0;
@@ -553,8 +579,16 @@ BOOL WINAPI AttachThreadInput( DWORD from, DWORD to, BOOL attach )
  */
 SHORT WINAPI DECLSPEC_HOTPATCH GetKeyState(INT vkey)
 {
+    struct input_shared_state input;
     SHORT retval = 0;
 
+    if (get_shared_input_state( &input ))
+    {
+        retval = (signed char)input.keystate[vkey & 0xff];
+        TRACE("key (0x%x) -> %x\n", vkey, retval);
+        return retval;
+    }
+
     SERVER_START_REQ( get_key_state )
     {
         req->tid = GetCurrentThreadId();
@@ -572,10 +606,17 @@ SHORT WINAPI DECLSPEC_HOTPATCH GetKeyState(INT vkey)
  */
 BOOL WINAPI DECLSPEC_HOTPATCH GetKeyboardState( LPBYTE state )
 {
+    struct input_shared_state input;
     BOOL ret;
 
     TRACE("(%p)\n", state);
 
+    if (get_shared_input_state( &input ))
+    {
+        memcpy( state, input.keystate, 256 );
+        return TRUE;
+    }
+
     memset( state, 0, 256 );
     SERVER_START_REQ( get_key_state )
     {
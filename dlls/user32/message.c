@@ -2752,15 +2752,28 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
     struct user_thread_info *thread_info = get_user_thread_info();
     INPUT_MESSAGE_SOURCE prev_source = thread_info->msg_source;
     struct received_message_info info, *old_info;
+    struct user_shared_info *shared_info;
+    struct queue_shared_state queue;
     unsigned int hw_id = 0;  /* id of previous hardware message */
+    unsigned int filter = (flags >> 16) ? (flags >> 16) : QS_ALLINPUT;
     void *buffer;
     size_t buffer_size = 256;
 
-    if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size ))) return FALSE;
-
     if (!first && !last) last = ~0;
     if (hwnd == HWND_BROADCAST) hwnd = HWND_TOPMOST;
 
+    /* don't bother the server if the queue is empty, but still call it once in a
+     * while so that it keeps track of the thread retrieving its messages */
+    if (hwnd != (HWND)-1 && get_shared_queue_state( &queue ) &&
+        (shared_info = thread_info->shared_info) &&
+        GetTickCount() - shared_info->last_get_msg < 1000 &&
+        !queue.surface_flush &&
+        !(queue.wake_bits & (filter | QS_SENDMESSAGE)) &&
+        !(queue.changed_bits & filter))
+        return FALSE;
+
+    if (!(buffer = HeapAlloc( GetProcessHeap(), 0, buffer_size ))) return FALSE;
+
     for (;;)
     {
         NTSTATUS res;
@@ -2797,6 +2810,13 @@ static BOOL peek_message( MSG *msg, HWND hwnd, UINT first, UINT last, UINT flags
         }
         SERVER_END_REQ;
 
+        if ((shared_info = thread_info->shared_info))
+        {
+            shared_info->last_get_msg = GetTickCount();
+            /* the server has created the queue by now */
+            if (!shared_info->queue_idx) invalidate_shared_state();
+        }
+
         if (res)
         {
             HeapFree( GetProcessHeap(), 0, buffer );
@@ -3017,6 +3037,7 @@ static HANDLE get_server_queue_handle(void)
         SERVER_END_REQ;
         thread_info->server_queue = ret;
         if (!ret) ERR( "Cannot get server thread queue\n" );
+        invalidate_shared_state();
     }
     return ret;
 }
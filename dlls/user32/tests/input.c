@@ -2507,6 +2507,95 @@ static void test_GetKeyState(void)
     CloseHandle(semaphores[1]);
 }
 
+static DWORD WINAPI shared_state_thread(void *arg)
+{
+    HANDLE *semaphores = arg;
+    DWORD result;
+    POINT pt;
+    SHORT state;
+
+    ReleaseSemaphore(semaphores[0], 1, NULL);
+    result = WaitForSingleObject(semaphores[1], 1000);
+    ok(result == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", result);
+
+    GetCursorPos(&pt);
+    ok(pt.x == 100 && pt.y == 200, "wrong cursor pos %d,%d\n", pt.x, pt.y);
+    state = GetAsyncKeyState('X');
+    ok(state & 0x8000, "expected that highest bit is set, got %x\n", state);
+    SetCursorPos(150, 250);
+
+    ReleaseSemaphore(semaphores[0], 1, NULL);
+    result = WaitForSingleObject(semaphores[1], 1000);
+    ok(result == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", result);
+
+    GetCursorPos(&pt);
+    ok(pt.x == 120 && pt.y == 220, "wrong cursor pos %d,%d\n", pt.x, pt.y);
+    state = GetAsyncKeyState('X');
+    ok(!(state & 0x8000), "expected that highest bit is unset, got %x\n", state);
+
+    return 0;
+}
+
+/* state changed by a thread must be seen right away by the others, and by the thread itself */
+static void test_shared_state(void)
+{
+    BYTE keystate[256];
+    HANDLE semaphores[2];
+    HANDLE thread;
+    DWORD result;
+    POINT pt;
+    HWND hwnd;
+    int i;
+
+    semaphores[0] = CreateSemaphoreA(NULL, 0, 1, NULL);
+    ok(semaphores[0] != NULL, "CreateSemaphoreA failed %u\n", GetLastError());
+    semaphores[1] = CreateSemaphoreA(NULL, 0, 1, NULL);
+    ok(semaphores[1] != NULL, "CreateSemaphoreA failed %u\n", GetLastError());
+
+    hwnd = CreateWindowA("static", "Title", WS_OVERLAPPEDWINDOW | WS_VISIBLE,
+                         10, 10, 200, 200, NULL, NULL, NULL, NULL);
+    ok(hwnd != NULL, "CreateWindowA failed %u\n", GetLastError());
+    SetForegroundWindow(hwnd);
+    SetFocus(hwnd);
+
+    thread = CreateThread(NULL, 0, shared_state_thread, semaphores, 0, NULL);
+    ok(thread != NULL, "CreateThread failed %u\n", GetLastError());
+    result = WaitForSingleObject(semaphores[0], 1000);
+    ok(result == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", result);
+
+    SetCursorPos(100, 200);
+    GetCursorPos(&pt);
+    ok(pt.x == 100 && pt.y == 200, "wrong cursor pos %d,%d\n", pt.x, pt.y);
+    keybd_event('X', 0, 0, 0);
+
+    ReleaseSemaphore(semaphores[1], 1, NULL);
+    result = WaitForSingleObject(semaphores[0], 1000);
+    ok(result == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", result);
+
+    GetCursorPos(&pt);
+    ok(pt.x == 150 && pt.y == 250, "wrong cursor pos %d,%d\n", pt.x, pt.y);
+    SetCursorPos(120, 220);
+    keybd_event('X', 0, KEYEVENTF_KEYUP, 0);
+
+    ReleaseSemaphore(semaphores[1], 1, NULL);
+    result = WaitForSingleObject(thread, 1000);
+    ok(result == WAIT_OBJECT_0, "WaitForSingleObject returned %u\n", result);
+    CloseHandle(thread);
+
+    GetKeyboardState(keystate);
+    for (i = 0; i < 4; i++)
+    {
+        keystate['Y'] = (i & 1) ? 0 : 0x80;
+        SetKeyboardState(keystate);
+        result = GetKeyState('Y');
+        ok(((result & 0x8000) != 0) == !(i & 1), "%d: wrong key state %x\n", i, result);
+    }
+
+    DestroyWindow(hwnd);
+    CloseHandle(semaphores[0]);
+    CloseHandle(semaphores[1]);
+}
+
 static void test_OemKeyScan(void)
 {
     DWORD ret, expect, vkey, scan;
@@ -2696,6 +2785,7 @@ START_TEST(input)
     test_key_names();
     test_attach_input();
     test_GetKeyState();
+    test_shared_state();
     test_OemKeyScan();
 
     if(pGetMouseMovePointsEx)
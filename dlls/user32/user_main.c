@@ -379,6 +379,7 @@ static void thread_detach(void)
     HeapFree( GetProcessHeap(), 0, thread_info->wmchar_data );
     HeapFree( GetProcessHeap(), 0, thread_info->key_state );
     HeapFree( GetProcessHeap(), 0, thread_info->rawinput );
+    HeapFree( GetProcessHeap(), 0, thread_info->shared_info );
 
     exiting_thread_id = 0;
 }
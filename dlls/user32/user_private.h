@@ -189,6 +189,7 @@ struct user_thread_info
     HWND                          top_window;             /* Desktop window */
     HWND                          msg_window;             /* HWND_MESSAGE parent window */
     RAWINPUT                     *rawinput;
+    struct user_shared_info      *shared_info;            /* Indices of the server shared state */
 };
 
 C_ASSERT( sizeof(struct user_thread_info) <= sizeof(((TEB *)0)->Win32ClientInfo) );
@@ -197,6 +198,14 @@ extern INT global_key_state_counter DECLSPEC_HIDDEN;
 extern BOOL (WINAPI *imm_register_window)(HWND) DECLSPEC_HIDDEN;
 extern void (WINAPI *imm_unregister_window)(HWND) DECLSPEC_HIDDEN;
 
+struct user_shared_info
+{
+    BOOL                          valid;                  /* Indices have been retrieved */
+    unsigned int                  desktop_idx;            /* Index of the desktop state */
+    unsigned int                  queue_idx;              /* Index of the queue state */
+    DWORD                         last_get_msg;           /* Time of the last get_message call */
+};
+
 struct user_key_state_info
 {
     UINT                          time;                   /* Time of last key state refresh */
@@ -225,6 +234,9 @@ extern HMODULE user32_module DECLSPEC_HIDDEN;
 
 struct dce;
 struct tagWND;
+struct desktop_shared_state;
+struct input_shared_state;
+struct queue_shared_state;
 
 extern void CLIPBOARD_ReleaseOwner( HWND hwnd ) DECLSPEC_HIDDEN;
 extern BOOL FOCUS_MouseActivate( HWND hwnd ) DECLSPEC_HIDDEN;
@@ -254,6 +266,10 @@ extern HBRUSH SYSCOLOR_Get55AABrush(void) DECLSPEC_HIDDEN;
 extern void SYSPARAMS_Init(void) DECLSPEC_HIDDEN;
 extern void USER_CheckNotLock(void) DECLSPEC_HIDDEN;
 extern BOOL USER_IsExitingThread( DWORD tid ) DECLSPEC_HIDDEN;
+extern void invalidate_shared_state(void) DECLSPEC_HIDDEN;
+extern BOOL get_shared_desktop_state( struct desktop_shared_state *state ) DECLSPEC_HIDDEN;
+extern BOOL get_shared_queue_state( struct queue_shared_state *state ) DECLSPEC_HIDDEN;
+extern BOOL get_shared_input_state( struct input_shared_state *state ) DECLSPEC_HIDDEN;
 
 extern BOOL USER_SetWindowPos( WINDOWPOS * winpos, int parent_x, int parent_y ) DECLSPEC_HIDDEN;
 
@@ -22,6 +22,7 @@
 #define WIN32_NO_STATUS
 
 #include <stdarg.h>
+#include <string.h>
 #include "windef.h"
 #include "winbase.h"
 #include "winnls.h"
@@ -37,6 +38,14 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(winstation);
 
+static const struct user_shared_state *shared_states;  /* read-only view of the server state section */
+
+#ifdef __GNUC__
+# define shared_state_barrier() __sync_synchronize()
+#else
+# define shared_state_barrier() do { } while (0)
+#endif
+
 
 /* callback for enumeration functions */
 struct enum_proc_lparam
@@ -429,6 +438,7 @@ BOOL WINAPI SetThreadDesktop( HDESK handle )
         thread_info->top_window = 0;
         thread_info->msg_window = 0;
         if (key_state_info) key_state_info->time = 0;
+        invalidate_shared_state();
     }
     return ret;
 }
@@ -693,3 +703,148 @@ BOOL WINAPI SetUserObjectSecurity( HANDLE handle, PSECURITY_INFORMATION info,
     FIXME( "(%p,%p,%p),stub!\n", handle, info, sid );
     return TRUE;
 }
+
+
+/***********************************************************************
+ *           map_shared_states
+ *
+ * Map the desktop and message queue state published by the server.
+ */
+static const struct user_shared_state *map_shared_states(void)
+{
+    static BOOL failed;
+    HANDLE handle = 0;
+    void *ptr;
+
+    if (shared_states || failed) return shared_states;
+
+    SERVER_START_REQ( get_user_shared_mapping )
+    {
+        if (!wine_server_call( req )) handle = wine_server_ptr_handle( reply->handle );
+    }
+    SERVER_END_REQ;
+    if (!handle)
+    {
+        WARN( "cannot get the server user state section\n" );
+        failed = TRUE;
+        return NULL;
+    }
+    ptr = MapViewOfFile( handle, FILE_MAP_READ, 0, 0, USER_SHM_SIZE );
+    CloseHandle( handle );
+    if (!ptr)
+    {
+        failed = TRUE;
+        return NULL;
+    }
+    if (InterlockedCompareExchangePointer( (void **)&shared_states, ptr, NULL ))
+        UnmapViewOfFile( ptr );  /* another thread mapped it first */
+    return shared_states;
+}
+
+
+/***********************************************************************
+ *           get_shared_info
+ */
+static struct user_shared_info *get_shared_info(void)
+{
+    struct user_thread_info *thread_info = get_user_thread_info();
+    struct user_shared_info *info = thread_info->shared_info;
+
+    if (!info)
+    {
+        if (!(info = HeapAlloc( GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*info) ))) return NULL;
+        thread_info->shared_info = info;
+    }
+    if (!info->valid)
+    {
+        SERVER_START_REQ( get_shared_state )
+        {
+            if (!wine_server_call( req ))
+            {
+                info->desktop_idx = reply->desktop_idx;
+                info->queue_idx   = reply->queue_idx;
+            }
+        }
+        SERVER_END_REQ;
+        info->valid = TRUE;
+    }
+    return info;
+}
+
+
+/***********************************************************************
+ *           invalidate_shared_state
+ *
+ * Retrieve the state indices again on next use, after the thread desktop
+ * has changed or a message queue may have been created.
+ */
+void invalidate_shared_state(void)
+{
+    struct user_shared_info *info = get_user_thread_info()->shared_info;
+
+    if (info) info->valid = FALSE;
+}
+
+
+/***********************************************************************
+ *           read_shared_state
+ *
+ * Copy a consistent snapshot of a shared state. The server increments the
+ * sequence number before and after each update; if we keep racing with it
+ * the caller falls back to a server call.
+ */
+static BOOL read_shared_state( unsigned int idx, unsigned int id, void *data, size_t size )
+{
+    const struct user_shared_state *state;
+    unsigned int seq, state_id, tries;
+
+    if (!idx || idx >= USER_SHM_SIZE / sizeof(*state) || !map_shared_states()) return FALSE;
+    state = &shared_states[idx];
+
+    for (tries = 0; tries < 16; tries++)
+    {
+        seq = *(volatile const unsigned int *)&state->seq;
+        if (seq & 1) continue;
+        shared_state_barrier();
+        state_id = state->id;
+        memcpy( data, &state->u, size );
+        shared_state_barrier();
+        if (*(volatile const unsigned int *)&state->seq == seq)
+            return state_id && (!id || state_id == id);
+    }
+    return FALSE;
+}
+
+
+/***********************************************************************
+ *           get_shared_desktop_state
+ */
+BOOL get_shared_desktop_state( struct desktop_shared_state *state )
+{
+    struct user_shared_info *info = get_shared_info();
+
+    return info && read_shared_state( info->desktop_idx, 0, state, sizeof(*state) );
+}
+
+
+/***********************************************************************
+ *           get_shared_queue_state
+ */
+BOOL get_shared_queue_state( struct queue_shared_state *state )
+{
+    struct user_shared_info *info = get_shared_info();
+
+    return info && read_shared_state( info->queue_idx, 0, state, sizeof(*state) );
+}
+
+
+/***********************************************************************
+ *           get_shared_input_state
+ */
+BOOL get_shared_input_state( struct input_shared_state *state )
+{
+    struct queue_shared_state queue;
+
+    if (!get_shared_queue_state( &queue )) return FALSE;
+    return read_shared_state( queue.input_idx, queue.input_id, state, sizeof(*state) );
+}
@@ -1324,6 +1324,126 @@ static HRESULT fill_array_desc(compile_ctx_t *ctx, dim_decl_t *dim_decl, array_d
     return S_OK;
 }
 
+static HRESULT lookup_var_ref(compile_ctx_t *ctx, function_t *func, const WCHAR *name, unsigned *ref)
+{
+    dynamic_var_t *var, **new_refs;
+    unsigned i;
+
+    /* The function name is its return value for assignments, keep it dynamic. */
+    if((func->type == FUNC_FUNCTION || func->type == FUNC_PROPGET || func->type == FUNC_DEFGET)
+            && !strcmpiW(name, func->name))
+        return S_FALSE;
+
+    if(func->type != FUNC_GLOBAL) {
+        for(i=0; i < func->var_cnt; i++) {
+            if(!strcmpiW(func->vars[i].name, name)) {
+                *ref = MAKE_VAR_REF(VAR_REF_LOCAL, i);
+                return S_OK;
+            }
+        }
+
+        for(i=0; i < func->arg_cnt; i++) {
+            if(!strcmpiW(func->args[i].name, name)) {
+                *ref = MAKE_VAR_REF(VAR_REF_ARG, i);
+                return S_OK;
+            }
+        }
+
+        return S_FALSE;
+    }
+
+    /*
+     * Variables declared by Dim in global code are looked up first and can't collide
+     * with other script identifiers, so we can bind them here. Everything else may
+     * be defined by later scripts or host objects and is looked up at run time.
+     */
+    for(var = ctx->global_vars; var; var = var->next) {
+        if(!strcmpiW(var->name, name))
+            break;
+    }
+    if(!var)
+        return S_FALSE;
+
+    for(i=0; i < ctx->code->global_ref_cnt; i++) {
+        if(ctx->code->global_refs[i] == var) {
+            *ref = MAKE_VAR_REF(VAR_REF_GLOBAL, i);
+            return S_OK;
+        }
+    }
+
+    new_refs = heap_realloc(ctx->code->global_refs, (ctx->code->global_ref_cnt+1) * sizeof(*new_refs));
+    if(!new_refs)
+        return E_OUTOFMEMORY;
+
+    ctx->code->global_refs = new_refs;
+    new_refs[ctx->code->global_ref_cnt] = var;
+    *ref = MAKE_VAR_REF(VAR_REF_GLOBAL, ctx->code->global_ref_cnt++);
+    return S_OK;
+}
+
+static HRESULT resolve_var_refs(compile_ctx_t *ctx, function_t *func)
+{
+    instr_t *instr, *end = ctx->code->instrs + ctx->instr_cnt;
+    unsigned ref;
+    BSTR name;
+    HRESULT hres;
+
+    for(instr = ctx->code->instrs + func->code_off; instr < end; instr++) {
+        switch(instr->op) {
+        case OP_icall:
+        case OP_assign_ident:
+        case OP_set_ident:
+        case OP_incc:
+            name = instr->arg1.bstr;
+            break;
+        case OP_step:
+            name = instr->arg2.bstr;
+            break;
+        default:
+            continue;
+        }
+
+        if(instr->op == OP_set_ident && instr->arg2.uint)
+            continue;
+
+        hres = lookup_var_ref(ctx, func, name, &ref);
+        if(FAILED(hres))
+            return hres;
+        if(hres == S_FALSE)
+            continue;
+
+        switch(instr->op) {
+        case OP_icall:
+            instr->op = OP_var;
+            instr->arg1.uint = ref;
+            break;
+        case OP_assign_ident:
+            instr->op = OP_assign_var;
+            instr->arg1.uint = ref;
+            break;
+        case OP_set_ident:
+            instr->op = OP_set_var;
+            instr->arg1.uint = ref;
+            break;
+        case OP_step:
+            instr->op = OP_step_var;
+            instr->arg2.uint = ref;
+            break;
+        case OP_incc:
+            /* OP_incc is always followed by a jump back to the loop's OP_step. */
+            assert(instr+1 < end && instr[1].op == OP_jmp);
+            instr->op = OP_next_var;
+            instr->arg1.uint = instr[1].arg1.uint;
+            instr->arg2.uint = ref;
+            break;
+        default:
+            assert(0);
+        }
+    }
+
+    return S_OK;
+}
+
 static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *func)
 {
     HRESULT hres;
@@ -1417,6 +1537,10 @@ static HRESULT compile_func(compile_ctx_t *ctx, statement_t *stat, function_t *f
         }
     }
 
+    hres = resolve_var_refs(ctx, func);
+    if(FAILED(hres))
+        return hres;
+
     if(func->array_cnt) {
         unsigned array_id = 0;
         dim_decl_t *dim_decl;
@@ -1746,10 +1870,18 @@ void release_vbscode(vbscode_t *code)
     for(i=0; i < code->bstr_cnt; i++)
         SysFreeString(code->bstr_pool[i]);
 
+    for(i=0; i < code->member_cache_cnt; i++) {
+        if(code->member_caches[i].typeinfo)
+            ITypeInfo_Release(code->member_caches[i].typeinfo);
+    }
+
     if(code->context)
         IDispatch_Release(code->context);
     heap_pool_free(&code->heap);
 
+    heap_free(code->member_caches);
+    heap_free(code->global_refs);
+
     heap_free(code->bstr_pool);
     heap_free(code->source);
     heap_free(code->instrs);
@@ -1850,6 +1982,13 @@ HRESULT compile_script(script_ctx_t *script, const WCHAR *src, const WCHAR *deli
         }
     }
 
+    code->member_caches = heap_alloc_zero(ctx.instr_cnt * sizeof(*code->member_caches));
+    if(!code->member_caches) {
+        release_compiler(&ctx);
+        return E_OUTOFMEMORY;
+    }
+    code->member_cache_cnt = ctx.instr_cnt;
+
     hres = check_script_collisions(&ctx, script);
     if(FAILED(hres)) {
         release_compiler(&ctx);
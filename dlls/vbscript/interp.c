@@ -514,64 +514,73 @@ static HRESULT array_access(exec_ctx_t *ctx, SAFEARRAY *array, DISPPARAMS *dp, V
     return hres;
 }
 
-static HRESULT do_icall(exec_ctx_t *ctx, VARIANT *res)
+static HRESULT var_call(exec_ctx_t *ctx, VARIANT *var, unsigned arg_cnt, VARIANT *res)
 {
-    BSTR identifier = ctx->instr->arg1.bstr;
-    const unsigned arg_cnt = ctx->instr->arg2.uint;
     DISPPARAMS dp;
-    ref_t ref;
+    VARIANT *v;
     HRESULT hres;
 
-    hres = lookup_identifier(ctx, identifier, VBDISP_CALLGET, &ref);
-    if(FAILED(hres))
-        return hres;
+    if(!res) {
+        FIXME("REF_VAR no res\n");
+        return E_NOTIMPL;
+    }
 
-    switch(ref.type) {
-    case REF_VAR:
-    case REF_CONST: {
-        VARIANT *v;
+    v = V_VT(var) == (VT_VARIANT|VT_BYREF) ? V_VARIANTREF(var) : var;
 
-        if(!res) {
-            FIXME("REF_VAR no res\n");
+    if(arg_cnt) {
+        SAFEARRAY *array = NULL;
+
+        switch(V_VT(v)) {
+        case VT_ARRAY|VT_BYREF|VT_VARIANT:
+            array = *V_ARRAYREF(var);
+            break;
+        case VT_ARRAY|VT_VARIANT:
+            array = V_ARRAY(var);
+            break;
+        case VT_DISPATCH:
+            vbstack_to_dp(ctx, arg_cnt, FALSE, &dp);
+            hres = disp_call(ctx->script, V_DISPATCH(v), DISPID_VALUE, &dp, res);
+            if(FAILED(hres))
+                return hres;
+            break;
+        default:
+            FIXME("arguments not implemented\n");
             return E_NOTIMPL;
         }
 
-        v = V_VT(ref.u.v) == (VT_VARIANT|VT_BYREF) ? V_VARIANTREF(ref.u.v) : ref.u.v;
+        if(!array)
+            return S_OK;
 
-        if(arg_cnt) {
-            SAFEARRAY *array = NULL;
+        vbstack_to_dp(ctx, arg_cnt, FALSE, &dp);
+        hres = array_access(ctx, array, &dp, &v);
+        if(FAILED(hres))
+            return hres;
+    }
 
-            switch(V_VT(v)) {
-            case VT_ARRAY|VT_BYREF|VT_VARIANT:
-                array = *V_ARRAYREF(ref.u.v);
-                break;
-            case VT_ARRAY|VT_VARIANT:
-                array = V_ARRAY(ref.u.v);
-                break;
-            case VT_DISPATCH:
-                vbstack_to_dp(ctx, arg_cnt, FALSE, &dp);
-                hres = disp_call(ctx->script, V_DISPATCH(v), DISPID_VALUE, &dp, res);
-                if(FAILED(hres))
-                    return hres;
-                break;
-            default:
-                FIXME("arguments not implemented\n");
-                return E_NOTIMPL;
-            }
+    V_VT(res) = VT_BYREF|VT_VARIANT;
+    V_BYREF(res) = v;
+    return S_OK;
+}
 
-            if(!array)
-                break;
+static HRESULT do_icall(exec_ctx_t *ctx, VARIANT *res)
+{
+    BSTR identifier = ctx->instr->arg1.bstr;
+    const unsigned arg_cnt = ctx->instr->arg2.uint;
+    DISPPARAMS dp;
+    ref_t ref;
+    HRESULT hres;
 
-            vbstack_to_dp(ctx, arg_cnt, FALSE, &dp);
-            hres = array_access(ctx, array, &dp, &v);
-            if(FAILED(hres))
-                return hres;
-        }
+    hres = lookup_identifier(ctx, identifier, VBDISP_CALLGET, &ref);
+    if(FAILED(hres))
+        return hres;
 
-        V_VT(res) = VT_BYREF|VT_VARIANT;
-        V_BYREF(res) = v;
+    switch(ref.type) {
+    case REF_VAR:
+    case REF_CONST:
+        hres = var_call(ctx, ref.u.v, arg_cnt, res);
+        if(FAILED(hres))
+            return hres;
         break;
-    }
     case REF_DISP:
         vbstack_to_dp(ctx, arg_cnt, FALSE, &dp);
         hres = disp_call(ctx->script, ref.u.d.disp, ref.u.d.id, &dp, res);
@@ -634,6 +643,41 @@ static HRESULT interp_icallv(exec_ctx_t *ctx)
     return do_icall(ctx, NULL);
 }
 
+static inline VARIANT *get_var_ref(exec_ctx_t *ctx, unsigned ref)
+{
+    switch(VAR_REF_KIND(ref)) {
+    case VAR_REF_LOCAL:
+        return ctx->vars + VAR_REF_INDEX(ref);
+    case VAR_REF_ARG:
+        return ctx->args + VAR_REF_INDEX(ref);
+    default:
+        assert(VAR_REF_KIND(ref) == VAR_REF_GLOBAL);
+        return &ctx->code->global_refs[VAR_REF_INDEX(ref)]->v;
+    }
+}
+
+static HRESULT interp_var(exec_ctx_t *ctx)
+{
+    const unsigned ref = ctx->instr->arg1.uint;
+    const unsigned arg_cnt = ctx->instr->arg2.uint;
+    VARIANT v;
+    HRESULT hres;
+
+    TRACE("%x\n", ref);
+
+    hres = var_call(ctx, get_var_ref(ctx, ref), arg_cnt, &v);
+    if(FAILED(hres))
+        return hres;
+
+    stack_popn(ctx, arg_cnt);
+    return stack_push(ctx, &v);
+}
+
+static inline member_cache_t *get_member_cache(exec_ctx_t *ctx)
+{
+    return ctx->code->member_caches + (ctx->instr - ctx->code->instrs);
+}
+
 static HRESULT do_mcall(exec_ctx_t *ctx, VARIANT *res)
 {
     const BSTR identifier = ctx->instr->arg1.bstr;
@@ -654,7 +698,7 @@ static HRESULT do_mcall(exec_ctx_t *ctx, VARIANT *res)
 
     vbstack_to_dp(ctx, arg_cnt, FALSE, &dp);
 
-    hres = disp_get_id(obj, identifier, VBDISP_CALLGET, FALSE, &id);
+    hres = disp_get_id_cached(ctx->script, obj, identifier, VBDISP_CALLGET, get_member_cache(ctx), &id);
     if(SUCCEEDED(hres))
         hres = disp_call(ctx->script, obj, id, &dp, res);
     IDispatch_Release(obj);
@@ -708,58 +752,62 @@ static HRESULT assign_value(exec_ctx_t *ctx, VARIANT *dst, VARIANT *src, WORD fl
     return S_OK;
 }
 
-static HRESULT assign_ident(exec_ctx_t *ctx, BSTR name, WORD flags, DISPPARAMS *dp)
+static HRESULT assign_var(exec_ctx_t *ctx, VARIANT *v, WORD flags, DISPPARAMS *dp)
 {
-    ref_t ref;
     HRESULT hres;
 
-    hres = lookup_identifier(ctx, name, VBDISP_LET, &ref);
-    if(FAILED(hres))
-        return hres;
+    if(V_VT(v) == (VT_VARIANT|VT_BYREF))
+        v = V_VARIANTREF(v);
 
-    switch(ref.type) {
-    case REF_VAR: {
-        VARIANT *v = ref.u.v;
+    if(arg_cnt(dp)) {
+        SAFEARRAY *array;
 
-        if(V_VT(v) == (VT_VARIANT|VT_BYREF))
-            v = V_VARIANTREF(v);
+        if(!(V_VT(v) & VT_ARRAY)) {
+            FIXME("array assign on type %d\n", V_VT(v));
+            return E_FAIL;
+        }
 
-        if(arg_cnt(dp)) {
-            SAFEARRAY *array;
+        switch(V_VT(v)) {
+        case VT_ARRAY|VT_BYREF|VT_VARIANT:
+            array = *V_ARRAYREF(v);
+            break;
+        case VT_ARRAY|VT_VARIANT:
+            array = V_ARRAY(v);
+            break;
+        default:
+            FIXME("Unsupported array type %x\n", V_VT(v));
+            return E_NOTIMPL;
+        }
 
-            if(!(V_VT(v) & VT_ARRAY)) {
-                FIXME("array assign on type %d\n", V_VT(v));
-                return E_FAIL;
-            }
+        if(!array) {
+            FIXME("null array\n");
+            return E_FAIL;
+        }
 
-            switch(V_VT(v)) {
-            case VT_ARRAY|VT_BYREF|VT_VARIANT:
-                array = *V_ARRAYREF(v);
-                break;
-            case VT_ARRAY|VT_VARIANT:
-                array = V_ARRAY(v);
-                break;
-            default:
-                FIXME("Unsupported array type %x\n", V_VT(v));
-                return E_NOTIMPL;
-            }
+        hres = array_access(ctx, array, dp, &v);
+        if(FAILED(hres))
+            return hres;
+    }else if(V_VT(v) == (VT_ARRAY|VT_BYREF|VT_VARIANT)) {
+        FIXME("non-array assign\n");
+        return E_NOTIMPL;
+    }
 
-            if(!array) {
-                FIXME("null array\n");
-                return E_FAIL;
-            }
+    return assign_value(ctx, v, dp->rgvarg, flags);
+}
 
-            hres = array_access(ctx, array, dp, &v);
-            if(FAILED(hres))
-                return hres;
-        }else if(V_VT(v) == (VT_ARRAY|VT_BYREF|VT_VARIANT)) {
-            FIXME("non-array assign\n");
-            return E_NOTIMPL;
-        }
+static HRESULT assign_ident(exec_ctx_t *ctx, BSTR name, WORD flags, DISPPARAMS *dp)
+{
+    ref_t ref;
+    HRESULT hres;
 
-        hres = assign_value(ctx, v, dp->rgvarg, flags);
+    hres = lookup_identifier(ctx, name, VBDISP_LET, &ref);
+    if(FAILED(hres))
+        return hres;
+
+    switch(ref.type) {
+    case REF_VAR:
+        hres = assign_var(ctx, ref.u.v, flags, dp);
         break;
-    }
     case REF_DISP:
         hres = disp_propput(ctx->script, ref.u.d.disp, ref.u.d.id, flags, dp);
         break;
@@ -839,6 +887,47 @@ static HRESULT interp_set_ident(exec_ctx_t *ctx)
     return S_OK;
 }
 
+static HRESULT interp_assign_var(exec_ctx_t *ctx)
+{
+    const unsigned ref = ctx->instr->arg1.uint;
+    const unsigned arg_cnt = ctx->instr->arg2.uint;
+    DISPPARAMS dp;
+    HRESULT hres;
+
+    TRACE("%x\n", ref);
+
+    vbstack_to_dp(ctx, arg_cnt, TRUE, &dp);
+    hres = assign_var(ctx, get_var_ref(ctx, ref), DISPATCH_PROPERTYPUT, &dp);
+    if(FAILED(hres))
+        return hres;
+
+    stack_popn(ctx, arg_cnt+1);
+    return S_OK;
+}
+
+static HRESULT interp_set_var(exec_ctx_t *ctx)
+{
+    const unsigned ref = ctx->instr->arg1.uint;
+    DISPPARAMS dp;
+    HRESULT hres;
+
+    TRACE("%x\n", ref);
+
+    assert(!ctx->instr->arg2.uint);
+
+    hres = stack_assume_disp(ctx, 0, NULL);
+    if(FAILED(hres))
+        return hres;
+
+    vbstack_to_dp(ctx, 0, TRUE, &dp);
+    hres = assign_var(ctx, get_var_ref(ctx, ref), DISPATCH_PROPERTYPUTREF, &dp);
+    if(FAILED(hres))
+        return hres;
+
+    stack_popn(ctx, 1);
+    return S_OK;
+}
+
 static HRESULT interp_assign_member(exec_ctx_t *ctx)
 {
     BSTR identifier = ctx->instr->arg1.bstr;
@@ -859,7 +948,7 @@ static HRESULT interp_assign_member(exec_ctx_t *ctx)
         return E_FAIL;
     }
 
-    hres = disp_get_id(obj, identifier, VBDISP_LET, FALSE, &id);
+    hres = disp_get_id_cached(ctx->script, obj, identifier, VBDISP_LET, get_member_cache(ctx), &id);
     if(SUCCEEDED(hres)) {
         vbstack_to_dp(ctx, arg_cnt, TRUE, &dp);
         hres = disp_propput(ctx->script, obj, id, DISPATCH_PROPERTYPUT, &dp);
@@ -900,7 +989,7 @@ static HRESULT interp_set_member(exec_ctx_t *ctx)
     if(FAILED(hres))
         return hres;
 
-    hres = disp_get_id(obj, identifier, VBDISP_SET, FALSE, &id);
+    hres = disp_get_id_cached(ctx->script, obj, identifier, VBDISP_SET, get_member_cache(ctx), &id);
     if(SUCCEEDED(hres)) {
         vbstack_to_dp(ctx, arg_cnt, TRUE, &dp);
         hres = disp_propput(ctx->script, obj, id, DISPATCH_PROPERTYPUTREF, &dp);
@@ -1060,16 +1149,12 @@ static HRESULT interp_dim(exec_ctx_t *ctx)
     return S_OK;
 }
 
-static HRESULT interp_step(exec_ctx_t *ctx)
+static HRESULT do_step(exec_ctx_t *ctx, VARIANT *v)
 {
-    const BSTR ident = ctx->instr->arg2.bstr;
     BOOL gteq_zero;
     VARIANT zero;
-    ref_t ref;
     HRESULT hres;
 
-    TRACE("%s\n", debugstr_w(ident));
-
     V_VT(&zero) = VT_I2;
     V_I2(&zero) = 0;
     hres = VarCmp(stack_top(ctx, 0), &zero, ctx->script->lcid, 0);
@@ -1078,16 +1163,7 @@ static HRESULT interp_step(exec_ctx_t *ctx)
 
     gteq_zero = hres == VARCMP_GT || hres == VARCMP_EQ;
 
-    hres = lookup_identifier(ctx, ident, VBDISP_ANY, &ref);
-    if(FAILED(hres))
-        return hres;
-
-    if(ref.type != REF_VAR) {
-        FIXME("%s is not REF_VAR\n", debugstr_w(ident));
-        return E_FAIL;
-    }
-
-    hres = VarCmp(ref.u.v, stack_top(ctx, 1), ctx->script->lcid, 0);
+    hres = VarCmp(v, stack_top(ctx, 1), ctx->script->lcid, 0);
     if(FAILED(hres))
         return hres;
 
@@ -1100,6 +1176,35 @@ static HRESULT interp_step(exec_ctx_t *ctx)
     return S_OK;
 }
 
+static HRESULT interp_step(exec_ctx_t *ctx)
+{
+    const BSTR ident = ctx->instr->arg2.bstr;
+    ref_t ref;
+    HRESULT hres;
+
+    TRACE("%s\n", debugstr_w(ident));
+
+    hres = lookup_identifier(ctx, ident, VBDISP_ANY, &ref);
+    if(FAILED(hres))
+        return hres;
+
+    if(ref.type != REF_VAR) {
+        FIXME("%s is not REF_VAR\n", debugstr_w(ident));
+        return E_FAIL;
+    }
+
+    return do_step(ctx, ref.u.v);
+}
+
+static HRESULT interp_step_var(exec_ctx_t *ctx)
+{
+    const unsigned ref = ctx->instr->arg2.uint;
+
+    TRACE("%x\n", ref);
+
+    return do_step(ctx, get_var_ref(ctx, ref));
+}
+
 static HRESULT interp_newenum(exec_ctx_t *ctx)
 {
     variant_val_t v;
@@ -1974,10 +2079,23 @@ static HRESULT interp_neg(exec_ctx_t *ctx)
     return stack_push(ctx, &v);
 }
 
+static HRESULT do_incc(exec_ctx_t *ctx, VARIANT *var)
+{
+    VARIANT v;
+    HRESULT hres;
+
+    hres = VarAdd(stack_top(ctx, 0), var, &v);
+    if(FAILED(hres))
+        return hres;
+
+    VariantClear(var);
+    *var = v;
+    return S_OK;
+}
+
 static HRESULT interp_incc(exec_ctx_t *ctx)
 {
     const BSTR ident = ctx->instr->arg1.bstr;
-    VARIANT v;
     ref_t ref;
     HRESULT hres;
 
@@ -1992,13 +2110,26 @@ static HRESULT interp_incc(exec_ctx_t *ctx)
         return E_FAIL;
     }
 
-    hres = VarAdd(stack_top(ctx, 0), ref.u.v, &v);
+    return do_incc(ctx, ref.u.v);
+}
+
+/* Fused OP_incc, OP_jmp and OP_step ending a For loop on a bound variable. */
+static HRESULT interp_next_var(exec_ctx_t *ctx)
+{
+    const unsigned step_instr = ctx->instr->arg1.uint;
+    VARIANT *var = get_var_ref(ctx, ctx->instr->arg2.uint);
+    HRESULT hres;
+
+    TRACE("%u\n", step_instr);
+
+    hres = do_incc(ctx, var);
     if(FAILED(hres))
         return hres;
 
-    VariantClear(ref.u.v);
-    *ref.u.v = v;
-    return S_OK;
+    /* Errors in the test unwind from the OP_step_var, like in the unfused sequence. */
+    instr_jmp(ctx, step_instr);
+    assert(ctx->instr->op == OP_step_var);
+    return do_step(ctx, var);
 }
 
 static HRESULT interp_catch(exec_ctx_t *ctx)
@@ -1012,6 +1012,78 @@ HRESULT disp_get_id(IDispatch *disp, BSTR name, vbdisp_invoke_type_t invoke_type
     return hres;
 }
 
+/*
+ * Like disp_get_id, but remembers the result in the instruction's cache. Script class
+ * members are keyed by the class description, plain IDispatch objects by their type
+ * info. IDispatchEx objects may add members at any time and are never cached.
+ */
+HRESULT disp_get_id_cached(script_ctx_t *ctx, IDispatch *disp, BSTR name, vbdisp_invoke_type_t invoke_type,
+        member_cache_t *cache, DISPID *id)
+{
+    ITypeInfo *typeinfo;
+    IDispatchEx *dispex;
+    vbdisp_t *vbdisp;
+    DISPID typeinfo_id;
+    HRESULT hres;
+
+    vbdisp = unsafe_impl_from_IDispatch(disp);
+    if(vbdisp) {
+        if(vbdisp->desc && cache->desc == vbdisp->desc) {
+            *id = cache->id;
+            return S_OK;
+        }
+
+        hres = vbdisp_get_id(vbdisp, name, invoke_type, FALSE, id);
+        if(SUCCEEDED(hres) && vbdisp->desc) {
+            if(cache->typeinfo) {
+                ITypeInfo_Release(cache->typeinfo);
+                cache->typeinfo = NULL;
+            }
+            cache->desc = vbdisp->desc;
+            cache->id = *id;
+        }
+        return hres;
+    }
+
+    hres = IDispatch_QueryInterface(disp, &IID_IDispatchEx, (void**)&dispex);
+    if(SUCCEEDED(hres)) {
+        hres = IDispatchEx_GetDispID(dispex, name, fdexNameCaseInsensitive, id);
+        IDispatchEx_Release(dispex);
+        return hres;
+    }
+
+    hres = IDispatch_GetTypeInfo(disp, 0, ctx->lcid, &typeinfo);
+    if(FAILED(hres))
+        typeinfo = NULL;
+
+    if(typeinfo && cache->typeinfo == typeinfo) {
+        ITypeInfo_Release(typeinfo);
+        *id = cache->id;
+        return S_OK;
+    }
+
+    TRACE("using IDispatch\n");
+    hres = IDispatch_GetIDsOfNames(disp, &IID_NULL, &name, 1, 0, id);
+    if(FAILED(hres) || !typeinfo) {
+        if(typeinfo)
+            ITypeInfo_Release(typeinfo);
+        return hres;
+    }
+
+    /* Only trust the type info if it agrees with the object. */
+    if(SUCCEEDED(ITypeInfo_GetIDsOfNames(typeinfo, &name, 1, &typeinfo_id)) && typeinfo_id == *id) {
+        if(cache->typeinfo)
+            ITypeInfo_Release(cache->typeinfo);
+        cache->typeinfo = typeinfo;
+        cache->desc = NULL;
+        cache->id = *id;
+    }else {
+        ITypeInfo_Release(typeinfo);
+    }
+
+    return hres;
+}
+
 #define RPC_E_SERVER_UNAVAILABLE 0x800706ba
 
 HRESULT map_hres(HRESULT hres)
@@ -146,8 +146,16 @@ typedef struct {
     script_ctx_t *ctx;
 } ScriptDisp;
 
+/* DISPID cache of a single member access instruction */
+typedef struct {
+    const class_desc_t *desc;
+    ITypeInfo *typeinfo;
+    DISPID id;
+} member_cache_t;
+
 HRESULT create_vbdisp(const class_desc_t*,vbdisp_t**) DECLSPEC_HIDDEN;
 HRESULT disp_get_id(IDispatch*,BSTR,vbdisp_invoke_type_t,BOOL,DISPID*) DECLSPEC_HIDDEN;
+HRESULT disp_get_id_cached(script_ctx_t*,IDispatch*,BSTR,vbdisp_invoke_type_t,member_cache_t*,DISPID*) DECLSPEC_HIDDEN;
 HRESULT vbdisp_get_id(vbdisp_t*,BSTR,vbdisp_invoke_type_t,BOOL,DISPID*) DECLSPEC_HIDDEN;
 HRESULT disp_call(script_ctx_t*,IDispatch*,DISPID,DISPPARAMS*,VARIANT*) DECLSPEC_HIDDEN;
 HRESULT disp_propput(script_ctx_t*,IDispatch*,DISPID,WORD,DISPPARAMS*) DECLSPEC_HIDDEN;
@@ -226,6 +234,7 @@ typedef enum {
     X(and,            1, 0,           0)          \
     X(assign_ident,   1, ARG_BSTR,    ARG_UINT)   \
     X(assign_member,  1, ARG_BSTR,    ARG_UINT)   \
+    X(assign_var,     1, ARG_UINT,    ARG_UINT)   \
     X(bool,           1, ARG_INT,     0)          \
     X(catch,          1, ARG_ADDR,    ARG_UINT)    \
     X(case,           0, ARG_ADDR,    0)          \
@@ -264,6 +273,7 @@ typedef enum {
     X(nequal,         1, 0,           0)          \
     X(new,            1, ARG_STR,     0)          \
     X(newenum,        1, 0,           0)          \
+    X(next_var,       0, ARG_ADDR,    ARG_UINT)   \
     X(not,            1, 0,           0)          \
     X(nothing,        1, 0,           0)          \
     X(null,           1, 0,           0)          \
@@ -272,12 +282,15 @@ typedef enum {
     X(ret,            0, 0,           0)          \
     X(set_ident,      1, ARG_BSTR,    ARG_UINT)   \
     X(set_member,     1, ARG_BSTR,    ARG_UINT)   \
+    X(set_var,        1, ARG_UINT,    ARG_UINT)   \
     X(short,          1, ARG_INT,     0)          \
     X(step,           0, ARG_ADDR,    ARG_BSTR)   \
+    X(step_var,       0, ARG_ADDR,    ARG_UINT)   \
     X(stop,           1, 0,           0)          \
     X(string,         1, ARG_STR,     0)          \
     X(sub,            1, 0,           0)          \
     X(val,            1, 0,           0)          \
+    X(var,            1, ARG_UINT,    ARG_UINT)   \
     X(xor,            1, 0,           0)
 
 typedef enum {
@@ -350,9 +363,27 @@ struct _vbscode_t {
     unsigned bstr_cnt;
     heap_pool_t heap;
 
+    dynamic_var_t **global_refs;
+    unsigned global_ref_cnt;
+    member_cache_t *member_caches;
+    unsigned member_cache_cnt;
+
     struct list entry;
 };
 
+/*
+ * Variables bound at compile time (see resolve_var_refs) are referenced by the *_var
+ * instructions with an index tagged with its kind: function locals and arguments index
+ * the frame's arrays, globals index the global_refs table of the code.
+ */
+#define VAR_REF_LOCAL   0
+#define VAR_REF_ARG     1
+#define VAR_REF_GLOBAL  2
+
+#define MAKE_VAR_REF(kind,idx) (((idx) << 2) | (kind))
+#define VAR_REF_KIND(ref)      ((ref) & 3)
+#define VAR_REF_INDEX(ref)     ((ref) >> 2)
+
 void release_vbscode(vbscode_t*) DECLSPEC_HIDDEN;
 HRESULT compile_script(script_ctx_t*,const WCHAR*,const WCHAR*,vbscode_t**) DECLSPEC_HIDDEN;
 HRESULT exec_script(script_ctx_t*,function_t*,vbdisp_t*,DISPPARAMS*,VARIANT*) DECLSPEC_HIDDEN;
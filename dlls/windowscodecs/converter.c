@@ -32,6 +32,12 @@
 
 #include "wine/debug.h"
 
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || defined(__clang__))
+#include <immintrin.h>
+#define HAVE_X86_SIMD
+#endif
+
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
 struct FormatConverter;
@@ -129,6 +135,368 @@ static void to_sRGB(BYTE *bgr)
 }
 #endif
 
+/* 8-bit sRGB encoding of linear values in [0, 1]. The mapping is monotonic,
+ * so it is stored as the smallest input producing each level, plus a coarse
+ * bucket table giving a starting level that is at most a few steps off. */
+#define SRGB_BUCKETS 1024
+
+static float srgb_thresholds[256];
+static BYTE srgb_buckets[SRGB_BUCKETS + 1];
+
+static inline BYTE to_sRGB_byte_exact(float f)
+{
+    return (BYTE)floorf(to_sRGB_component(f) * 255.0f + 0.51f);
+}
+
+static void init_sRGB_tables(void)
+{
+    UINT i, v;
+
+    for (v = 1; v < 256; v++)
+    {
+        UINT lo = 0, hi = 0x3f800000; /* 1.0f */
+        union { UINT i; float f; } u;
+
+        while (lo < hi)
+        {
+            u.i = lo + (hi - lo) / 2;
+            if (to_sRGB_byte_exact(u.f) >= v) hi = u.i;
+            else lo = u.i + 1;
+        }
+        u.i = lo;
+        srgb_thresholds[v] = u.f;
+    }
+
+    for (i = 0; i <= SRGB_BUCKETS; i++)
+        srgb_buckets[i] = to_sRGB_byte_exact(i / (float)SRGB_BUCKETS);
+}
+
+static inline BYTE to_sRGB_byte(float f)
+{
+    BYTE v;
+
+    if (!(f >= 0.0f && f <= 1.0f)) return to_sRGB_byte_exact(f);
+
+    v = srgb_buckets[(UINT)(f * SRGB_BUCKETS)];
+    while (v < 255 && f >= srgb_thresholds[v + 1]) v++;
+    return v;
+}
+
+struct convert_funcs
+{
+    void (*premultiply)(BYTE *row, UINT count);
+    void (*unpremultiply)(BYTE *row, UINT count);
+    void (*bgr24_to_bgra)(BYTE *dst, const BYTE *src, UINT count);
+    void (*rgba64_to_bgra)(BYTE *dst, const BYTE *src, UINT count);
+};
+
+static const struct convert_funcs *convert_funcs;
+static INIT_ONCE convert_init_once = INIT_ONCE_STATIC_INIT;
+
+static void premultiply_row(BYTE *row, UINT count)
+{
+    UINT i;
+
+    for (i = 0; i < count; i++, row += 4)
+    {
+        BYTE alpha = row[3];
+        if (alpha != 255)
+        {
+            row[0] = row[0] * alpha / 255;
+            row[1] = row[1] * alpha / 255;
+            row[2] = row[2] * alpha / 255;
+        }
+    }
+}
+
+static void unpremultiply_row(BYTE *row, UINT count)
+{
+    UINT i;
+
+    for (i = 0; i < count; i++, row += 4)
+    {
+        BYTE alpha = row[3];
+        if (alpha != 0 && alpha != 255)
+        {
+            row[0] = row[0] * 255 / alpha;
+            row[1] = row[1] * 255 / alpha;
+            row[2] = row[2] * 255 / alpha;
+        }
+    }
+}
+
+static void bgr24_to_bgra_row(BYTE *dst, const BYTE *src, UINT count)
+{
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT i;
+
+    for (i = 0; i < count; i++, src += 3)
+        *dstpixel++ = 0xff000000 | src[2] << 16 | src[1] << 8 | src[0];
+}
+
+static void rgba64_to_bgra_row(BYTE *dst, const BYTE *src, UINT count)
+{
+    DWORD *dstpixel = (DWORD *)dst;
+    UINT i;
+
+    for (i = 0; i < count; i++, src += 8)
+        *dstpixel++ = src[6] << 24 | src[0] << 16 | src[2] << 8 | src[4];
+}
+
+static const struct convert_funcs convert_funcs_c =
+{
+    premultiply_row,
+    unpremultiply_row,
+    bgr24_to_bgra_row,
+    rgba64_to_bgra_row,
+};
+
+#ifdef HAVE_X86_SIMD
+
+#ifdef __i386__
+/* the Win32 ABI only guarantees 4-byte stack alignment */
+#define SSE2_FUNC __attribute__((target("sse2"), force_align_arg_pointer))
+#define AVX2_FUNC __attribute__((target("avx2"), force_align_arg_pointer))
+#else
+#define SSE2_FUNC __attribute__((target("sse2")))
+#define AVX2_FUNC __attribute__((target("avx2")))
+#endif
+
+/* c * alpha / 255 for each colour word, using (t + 1 + (t >> 8)) >> 8 which
+ * is exact for all t <= 255 * 255; the alpha words are restored by the caller */
+static SSE2_FUNC inline __m128i premultiply_words_sse2(__m128i px)
+{
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, 0xff), 0xff);
+    __m128i t = _mm_mullo_epi16(px, alpha);
+
+    t = _mm_add_epi16(t, _mm_add_epi16(_mm_srli_epi16(t, 8), _mm_set1_epi16(1)));
+    return _mm_srli_epi16(t, 8);
+}
+
+static SSE2_FUNC void premultiply_row_sse2(BYTE *row, UINT count)
+{
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000), zero = _mm_setzero_si128();
+    UINT i;
+
+    for (i = 0; i + 4 <= count; i += 4, row += 16)
+    {
+        __m128i px = _mm_loadu_si128((const __m128i *)row), lo, hi;
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_or_si128(px, _mm_set1_epi32(0x00ffffff)),
+                                              _mm_set1_epi32(-1))) == 0xffff)
+            continue;
+
+        lo = premultiply_words_sse2(_mm_unpacklo_epi8(px, zero));
+        hi = premultiply_words_sse2(_mm_unpackhi_epi8(px, zero));
+        lo = _mm_packus_epi16(lo, hi);
+        px = _mm_or_si128(_mm_and_si128(px, alpha_mask), _mm_andnot_si128(alpha_mask, lo));
+        _mm_storeu_si128((__m128i *)row, px);
+    }
+    premultiply_row(row, count - i);
+}
+
+/* c * 255 / alpha for the four channels of one pixel; the float division is
+ * exact after truncation since c * 255 < 2^24, and the low byte is kept to
+ * match the integer code for invalid input (c > alpha) */
+static SSE2_FUNC inline __m128i unpremultiply_pixel_sse2(__m128i px)
+{
+    __m128 alpha = _mm_cvtepi32_ps(_mm_shuffle_epi32(px, 0xff));
+    __m128 c = _mm_mul_ps(_mm_cvtepi32_ps(px), _mm_set1_ps(255.0f));
+
+    alpha = _mm_max_ps(alpha, _mm_set1_ps(1.0f));
+    return _mm_and_si128(_mm_cvttps_epi32(_mm_div_ps(c, alpha)), _mm_set1_epi32(0xff));
+}
+
+static SSE2_FUNC void unpremultiply_row_sse2(BYTE *row, UINT count)
+{
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000), zero = _mm_setzero_si128();
+    UINT i;
+
+    for (i = 0; i + 4 <= count; i += 4, row += 16)
+    {
+        __m128i px = _mm_loadu_si128((const __m128i *)row), alpha, keep, lo, hi;
+
+        alpha = _mm_srli_epi32(px, 24);
+        keep = _mm_or_si128(_mm_cmpeq_epi32(alpha, zero), _mm_cmpeq_epi32(alpha, _mm_set1_epi32(0xff)));
+        if (_mm_movemask_epi8(keep) == 0xffff)
+            continue;
+
+        lo = _mm_unpacklo_epi8(px, zero);
+        hi = _mm_unpackhi_epi8(px, zero);
+        lo = _mm_packs_epi32(unpremultiply_pixel_sse2(_mm_unpacklo_epi16(lo, zero)),
+                             unpremultiply_pixel_sse2(_mm_unpackhi_epi16(lo, zero)));
+        hi = _mm_packs_epi32(unpremultiply_pixel_sse2(_mm_unpacklo_epi16(hi, zero)),
+                             unpremultiply_pixel_sse2(_mm_unpackhi_epi16(hi, zero)));
+        lo = _mm_packus_epi16(lo, hi);
+
+        keep = _mm_or_si128(keep, alpha_mask);
+        px = _mm_or_si128(_mm_and_si128(keep, px), _mm_andnot_si128(keep, lo));
+        _mm_storeu_si128((__m128i *)row, px);
+    }
+    unpremultiply_row(row, count - i);
+}
+
+static SSE2_FUNC void rgba64_to_bgra_row_sse2(BYTE *dst, const BYTE *src, UINT count)
+{
+    const __m128i low_bytes = _mm_set1_epi16(0xff);
+    UINT i;
+
+    for (i = 0; i + 4 <= count; i += 4, src += 32, dst += 16)
+    {
+        __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i *)src), low_bytes);
+        __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i *)(src + 16)), low_bytes);
+
+        /* swap red and blue */
+        a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, 0xc6), 0xc6);
+        b = _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, 0xc6), 0xc6);
+        _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(a, b));
+    }
+    rgba64_to_bgra_row(dst, src, count - i);
+}
+
+static const struct convert_funcs convert_funcs_sse2 =
+{
+    premultiply_row_sse2,
+    unpremultiply_row_sse2,
+    bgr24_to_bgra_row,
+    rgba64_to_bgra_row_sse2,
+};
+
+static AVX2_FUNC inline __m256i premultiply_words_avx2(__m256i px)
+{
+    __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(px, 0xff), 0xff);
+    __m256i t = _mm256_mullo_epi16(px, alpha);
+
+    t = _mm256_add_epi16(t, _mm256_add_epi16(_mm256_srli_epi16(t, 8), _mm256_set1_epi16(1)));
+    return _mm256_srli_epi16(t, 8);
+}
+
+static AVX2_FUNC void premultiply_row_avx2(BYTE *row, UINT count)
+{
+    const __m256i alpha_mask = _mm256_set1_epi32(0xff000000), zero = _mm256_setzero_si256();
+    UINT i;
+
+    for (i = 0; i + 8 <= count; i += 8, row += 32)
+    {
+        __m256i px = _mm256_loadu_si256((const __m256i *)row), lo, hi;
+
+        if (_mm256_testc_si256(px, alpha_mask))
+            continue;
+
+        lo = premultiply_words_avx2(_mm256_unpacklo_epi8(px, zero));
+        hi = premultiply_words_avx2(_mm256_unpackhi_epi8(px, zero));
+        px = _mm256_blendv_epi8(_mm256_packus_epi16(lo, hi), px, alpha_mask);
+        _mm256_storeu_si256((__m256i *)row, px);
+    }
+    premultiply_row_sse2(row, count - i);
+}
+
+static AVX2_FUNC inline __m256i unpremultiply_pixels_avx2(__m256i px)
+{
+    __m256 alpha = _mm256_cvtepi32_ps(_mm256_shuffle_epi32(px, 0xff));
+    __m256 c = _mm256_mul_ps(_mm256_cvtepi32_ps(px), _mm256_set1_ps(255.0f));
+
+    alpha = _mm256_max_ps(alpha, _mm256_set1_ps(1.0f));
+    return _mm256_and_si256(_mm256_cvttps_epi32(_mm256_div_ps(c, alpha)), _mm256_set1_epi32(0xff));
+}
+
+static AVX2_FUNC void unpremultiply_row_avx2(BYTE *row, UINT count)
+{
+    const __m256i alpha_mask = _mm256_set1_epi32(0xff000000), zero = _mm256_setzero_si256();
+    UINT i;
+
+    for (i = 0; i + 8 <= count; i += 8, row += 32)
+    {
+        __m256i px = _mm256_loadu_si256((const __m256i *)row), alpha, keep, lo, hi;
+
+        alpha = _mm256_srli_epi32(px, 24);
+        keep = _mm256_or_si256(_mm256_cmpeq_epi32(alpha, zero),
+                               _mm256_cmpeq_epi32(alpha, _mm256_set1_epi32(0xff)));
+        if (_mm256_movemask_epi8(keep) == -1)
+            continue;
+
+        lo = _mm256_unpacklo_epi8(px, zero);
+        hi = _mm256_unpackhi_epi8(px, zero);
+        lo = _mm256_packs_epi32(unpremultiply_pixels_avx2(_mm256_unpacklo_epi16(lo, zero)),
+                                unpremultiply_pixels_avx2(_mm256_unpackhi_epi16(lo, zero)));
+        hi = _mm256_packs_epi32(unpremultiply_pixels_avx2(_mm256_unpacklo_epi16(hi, zero)),
+                                unpremultiply_pixels_avx2(_mm256_unpackhi_epi16(hi, zero)));
+        lo = _mm256_packus_epi16(lo, hi);
+
+        keep = _mm256_or_si256(keep, alpha_mask);
+        _mm256_storeu_si256((__m256i *)row, _mm256_blendv_epi8(lo, px, keep));
+    }
+    unpremultiply_row_sse2(row, count - i);
+}
+
+static AVX2_FUNC void bgr24_to_bgra_row_avx2(BYTE *dst, const BYTE *src, UINT count)
+{
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                             0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32(0xff000000);
+    UINT i;
+
+    /* each lane loads 16 bytes for 4 pixels, so stay 2 pixels clear of the end */
+    for (i = 0; i + 10 <= count; i += 8, src += 24, dst += 32)
+    {
+        __m256i px = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)src)),
+                                             _mm_loadu_si128((const __m128i *)(src + 12)), 1);
+
+        px = _mm256_or_si256(_mm256_shuffle_epi8(px, shuffle), alpha);
+        _mm256_storeu_si256((__m256i *)dst, px);
+    }
+    bgr24_to_bgra_row(dst, src, count - i);
+}
+
+static AVX2_FUNC void rgba64_to_bgra_row_avx2(BYTE *dst, const BYTE *src, UINT count)
+{
+    const __m256i low_bytes = _mm256_set1_epi16(0xff);
+    UINT i;
+
+    for (i = 0; i + 8 <= count; i += 8, src += 64, dst += 32)
+    {
+        __m256i a = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)src), low_bytes);
+        __m256i b = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(src + 32)), low_bytes);
+
+        a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(a, 0xc6), 0xc6);
+        b = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(b, 0xc6), 0xc6);
+        /* packus works within 128-bit lanes, put the quadwords back in order */
+        a = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+        _mm256_storeu_si256((__m256i *)dst, a);
+    }
+    rgba64_to_bgra_row_sse2(dst, src, count - i);
+}
+
+static const struct convert_funcs convert_funcs_avx2 =
+{
+    premultiply_row_avx2,
+    unpremultiply_row_avx2,
+    bgr24_to_bgra_row_avx2,
+    rgba64_to_bgra_row_avx2,
+};
+
+#endif /* HAVE_X86_SIMD */
+
+static BOOL WINAPI init_convert_funcs(INIT_ONCE *once, void *param, void **context)
+{
+    init_sRGB_tables();
+
+    convert_funcs = &convert_funcs_c;
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        convert_funcs = &convert_funcs_avx2;
+    else if (__builtin_cpu_supports("sse2"))
+        convert_funcs = &convert_funcs_sse2;
+#endif
+    return TRUE;
+}
+
+static inline float bgr_to_gray(const BYTE *bgr)
+{
+    return (bgr[2] * 0.2126f + bgr[1] * 0.7152f + bgr[0] * 0.0722f) / 255.0f;
+}
+
 static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter *iface)
 {
     return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
@@ -615,13 +983,11 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         if (prc)
         {
             HRESULT res;
-            INT x, y;
+            INT y;
             BYTE *srcdata;
             UINT srcstride, srcdatasize;
             const BYTE *srcrow;
-            const BYTE *srcpixel;
             BYTE *dstrow;
-            BYTE *dstpixel;
 
             srcstride = 3 * prc->Width;
             srcdatasize = srcstride * prc->Height;
@@ -636,14 +1002,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
                 srcrow = srcdata;
                 dstrow = pbBuffer;
                 for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
+                    convert_funcs->bgr24_to_bgra(dstrow, srcrow, prc->Width);
                     srcrow += srcstride;
                     dstrow += cbStride;
                 }
@@ -713,8 +1072,11 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
 
             /* set all alpha values to 255 */
             for (y=0; y<prc->Height; y++)
+            {
+                DWORD *pixel = (DWORD *)(pbBuffer + cbStride * y);
                 for (x=0; x<prc->Width; x++)
-                    pbBuffer[cbStride*y+4*x+3] = 0xff;
+                    pixel[x] |= 0xff000000;
+            }
         }
         return S_OK;
     case format_32bppBGRA:
@@ -725,22 +1087,13 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         if (prc)
         {
             HRESULT res;
-            INT x, y;
+            INT y;
 
             res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
             for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 0 && alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
-                    }
-                }
+                convert_funcs->unpremultiply(pbBuffer + cbStride * y, prc->Width);
         }
         return S_OK;
     case format_48bppRGB:
@@ -791,13 +1144,11 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         if (prc)
         {
             HRESULT res;
-            INT x, y;
+            INT y;
             BYTE *srcdata;
             UINT srcstride, srcdatasize;
             const BYTE *srcrow;
-            const BYTE *srcpixel;
             BYTE *dstrow;
-            DWORD *dstpixel;
 
             srcstride = 8 * prc->Width;
             srcdatasize = srcstride * prc->Height;
@@ -812,16 +1163,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
                 srcrow = srcdata;
                 dstrow = pbBuffer;
                 for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue, alpha;
-                        red = *srcpixel++; srcpixel++;
-                        green = *srcpixel++; srcpixel++;
-                        blue = *srcpixel++; srcpixel++;
-                        alpha = *srcpixel++; srcpixel++;
-                        *dstpixel++=alpha<<24|red<<16|green<<8|blue;
-                    }
+                    convert_funcs->rgba64_to_bgra(dstrow, srcrow, prc->Width);
                     srcrow += srcstride;
                     dstrow += cbStride;
                 }
@@ -885,23 +1227,28 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
         if (prc)
             return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
+    case format_BlackWhite:
+    case format_2bppGray:
+    case format_4bppGray:
+    case format_8bppGray:
+    case format_16bppGray:
+    case format_16bppBGR555:
+    case format_16bppBGR565:
+    case format_24bppBGR:
+    case format_24bppRGB:
+    case format_32bppBGR:
+    case format_48bppRGB:
+    case format_32bppCMYK:
+        /* always opaque, premultiplying would not change anything */
+        return copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
     default:
         hr = copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
         {
-            INT x, y;
+            INT y;
 
             for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * alpha / 255;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * alpha / 255;
-                    }
-                }
+                convert_funcs->premultiply(pbBuffer + cbStride * y, prc->Width);
         }
         return hr;
     }
@@ -996,7 +1343,7 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
 
                     for (x = 0; x < prc->Width; x++)
                     {
-                        BYTE gray = (BYTE)floorf(to_sRGB_component(gray_float[x]) * 255.0f + 0.51f);
+                        BYTE gray = to_sRGB_byte(gray_float[x]);
                         *bgr++ = gray;
                         *bgr++ = gray;
                         *bgr++ = gray;
@@ -1124,7 +1471,7 @@ static HRESULT copypixels_to_32bppGrayFloat(struct FormatConverter *This, const
             BYTE *bgr = p;
             for (x = 0; x < prc->Width; x++)
             {
-                float gray = (bgr[2] * 0.2126f + bgr[1] * 0.7152f + bgr[0] * 0.0722f) / 255.0f;
+                float gray = bgr_to_gray(bgr);
                 *(float *)bgr = gray;
                 bgr += 4;
             }
@@ -1139,7 +1486,7 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
 {
     HRESULT hr;
     BYTE *srcdata;
-    UINT srcstride, srcdatasize;
+    UINT srcstride, srcdatasize, bpp;
 
     if (source_format == format_8bppGray)
     {
@@ -1173,7 +1520,7 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
                     BYTE *dstpixel = dst;
 
                     for (x=0; x < prc->Width; x++)
-                        *dstpixel++ = (BYTE)floorf(to_sRGB_component(*srcpixel++) * 255.0f + 0.51f);
+                        *dstpixel++ = to_sRGB_byte(*srcpixel++);
 
                     src += srcstride;
                     dst += cbStride;
@@ -1186,14 +1533,40 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
         return hr;
     }
 
-    srcstride = 3 * prc->Width;
+    if (!prc)
+        return copypixels_to_24bppBGR(This, NULL, 0, 0, NULL, source_format);
+
+    /* 24bppBGR and the 32bpp BGR formats are read directly, everything else
+     * goes through 24bppBGR first */
+    switch (source_format)
+    {
+    case format_24bppBGR:
+        bpp = 3;
+        break;
+    case format_32bppBGR:
+    case format_32bppBGRA:
+    case format_32bppPBGRA:
+        bpp = 4;
+        break;
+    default:
+        bpp = 0;
+        break;
+    }
+
+    srcstride = (bpp ? bpp : 3) * prc->Width;
     srcdatasize = srcstride * prc->Height;
 
     srcdata = HeapAlloc(GetProcessHeap(), 0, srcdatasize);
     if (!srcdata) return E_OUTOFMEMORY;
 
-    hr = copypixels_to_24bppBGR(This, prc, srcstride, srcdatasize, srcdata, source_format);
-    if (SUCCEEDED(hr) && prc)
+    if (bpp)
+        hr = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+    else
+    {
+        hr = copypixels_to_24bppBGR(This, prc, srcstride, srcdatasize, srcdata, source_format);
+        bpp = 3;
+    }
+    if (SUCCEEDED(hr))
     {
         INT x, y;
         BYTE *src = srcdata, *dst = pbBuffer;
@@ -1204,11 +1577,8 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
 
             for (x = 0; x < prc->Width; x++)
             {
-                float gray = (bgr[2] * 0.2126f + bgr[1] * 0.7152f + bgr[0] * 0.0722f) / 255.0f;
-
-                gray = to_sRGB_component(gray) * 255.0f;
-                dst[x] = (BYTE)floorf(gray + 0.51f);
-                bgr += 3;
+                dst[x] = to_sRGB_byte(bgr_to_gray(bgr));
+                bgr += bpp;
             }
             src += srcstride;
             dst += cbStride;
@@ -1427,6 +1797,8 @@ static HRESULT WINAPI FormatConverter_Initialize(IWICFormatConverter *iface,
 
     if (dstinfo->copy_function)
     {
+        InitOnceExecuteOnce(&convert_init_once, init_convert_funcs, NULL, NULL);
+
         IWICBitmapSource_AddRef(pISource);
         This->src_format = srcinfo;
         This->dst_format = dstinfo;
@@ -147,6 +147,7 @@ typedef struct {
     IWICBitmapDecoder IWICBitmapDecoder_iface;
     IWICBitmapFrameDecode IWICBitmapFrameDecode_iface;
     IWICMetadataBlockReader IWICMetadataBlockReader_iface;
+    IWICBitmapSourceTransform IWICBitmapSourceTransform_iface;
     LONG ref;
     BOOL initialized;
     BOOL cinfo_initialized;
@@ -156,6 +157,8 @@ typedef struct {
     struct jpeg_source_mgr source_mgr;
     BYTE source_buffer[1024];
     BYTE *image_data;
+    BYTE *scaled_data; /* image decoded at 1/scaled_denom of the full size */
+    UINT scaled_denom;
     CRITICAL_SECTION lock;
 } JpegDecoder;
 
@@ -179,6 +182,11 @@ static inline JpegDecoder *impl_from_IWICMetadataBlockReader(IWICMetadataBlockRe
     return CONTAINING_RECORD(iface, JpegDecoder, IWICMetadataBlockReader_iface);
 }
 
+static inline JpegDecoder *impl_from_IWICBitmapSourceTransform(IWICBitmapSourceTransform *iface)
+{
+    return CONTAINING_RECORD(iface, JpegDecoder, IWICBitmapSourceTransform_iface);
+}
+
 static HRESULT WINAPI JpegDecoder_QueryInterface(IWICBitmapDecoder *iface, REFIID iid,
     void **ppv)
 {
@@ -226,6 +234,7 @@ static ULONG WINAPI JpegDecoder_Release(IWICBitmapDecoder *iface)
         if (This->cinfo_initialized) pjpeg_destroy_decompress(&This->cinfo);
         if (This->stream) IStream_Release(This->stream);
         HeapFree(GetProcessHeap(), 0, This->image_data);
+        HeapFree(GetProcessHeap(), 0, This->scaled_data);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -500,6 +509,10 @@ static HRESULT WINAPI JpegDecoder_Frame_QueryInterface(IWICBitmapFrameDecode *if
     {
         *ppv = &This->IWICBitmapFrameDecode_iface;
     }
+    else if (IsEqualIID(&IID_IWICBitmapSourceTransform, iid))
+    {
+        *ppv = &This->IWICBitmapSourceTransform_iface;
+    }
     else
     {
         *ppv = NULL;
@@ -586,6 +599,29 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPalette(IWICBitmapFrameDecode *iface
     return E_NOTIMPL;
 }
 
+/* Converts the scanlines decoded since first_scanline to the WIC layout. */
+static void fixup_scanlines(struct jpeg_decompress_struct *cinfo, UINT bpp, BYTE *data,
+    UINT stride, UINT first_scanline)
+{
+    if (bpp == 24)
+    {
+        /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
+        reverse_bgr8(3, data + stride * first_scanline,
+            cinfo->output_width, cinfo->output_scanline - first_scanline,
+            stride);
+    }
+
+    if (cinfo->out_color_space == JCS_CMYK && cinfo->saw_Adobe_marker)
+    {
+        DWORD *pDwordData = (DWORD*) (data + stride * first_scanline);
+        DWORD *pDwordDataEnd = (DWORD*) (data + cinfo->output_scanline * stride);
+
+        /* Adobe JPEG's have inverted CMYK data. */
+        while(pDwordData < pDwordDataEnd)
+            *pDwordData++ ^= 0xffffffff;
+    }
+}
+
 static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -664,24 +700,7 @@ static HRESULT WINAPI JpegDecoder_Frame_CopyPixels(IWICBitmapFrameDecode *iface,
             return E_FAIL;
         }
 
-        if (bpp == 24)
-        {
-            /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
-            reverse_bgr8(3, This->image_data + stride * first_scanline,
-                This->cinfo.output_width, This->cinfo.output_scanline - first_scanline,
-                stride);
-        }
-
-        if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
-        {
-            DWORD *pDwordData = (DWORD*) (This->image_data + stride * first_scanline);
-            DWORD *pDwordDataEnd = (DWORD*) (This->image_data + This->cinfo.output_scanline * stride);
-
-            /* Adobe JPEG's have inverted CMYK data. */
-            while(pDwordData < pDwordDataEnd)
-                *pDwordData++ ^= 0xffffffff;
-        }
-
+        fixup_scanlines(&This->cinfo, bpp, This->image_data, stride, first_scanline);
     }
 
     LeaveCriticalSection(&This->lock);
@@ -732,6 +751,317 @@ static const IWICBitmapFrameDecodeVtbl JpegDecoder_Frame_Vtbl = {
     JpegDecoder_Frame_GetThumbnail
 };
 
+static HRESULT WINAPI JpegDecoder_Transform_QueryInterface(IWICBitmapSourceTransform *iface, REFIID iid,
+    void **ppv)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    return IWICBitmapFrameDecode_QueryInterface(&This->IWICBitmapFrameDecode_iface, iid, ppv);
+}
+
+static ULONG WINAPI JpegDecoder_Transform_AddRef(IWICBitmapSourceTransform *iface)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    return IWICBitmapDecoder_AddRef(&This->IWICBitmapDecoder_iface);
+}
+
+static ULONG WINAPI JpegDecoder_Transform_Release(IWICBitmapSourceTransform *iface)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    return IWICBitmapDecoder_Release(&This->IWICBitmapDecoder_iface);
+}
+
+/* libjpeg can scale by 1/2, 1/4 and 1/8 while decoding, using a smaller
+ * inverse DCT; pick the smallest scale that is at least the requested size. */
+static UINT get_scale_denom(JpegDecoder *This, UINT width, UINT height)
+{
+    UINT denom;
+
+    for (denom = 8; denom > 1; denom /= 2)
+    {
+        if ((This->cinfo.image_width + denom - 1) / denom >= width &&
+            (This->cinfo.image_height + denom - 1) / denom >= height)
+            break;
+    }
+
+    return denom;
+}
+
+struct scaled_source
+{
+    struct jpeg_source_mgr source_mgr;
+    IStream *stream;
+    BYTE buffer[4096];
+};
+
+static jpeg_boolean scaled_source_fill_input_buffer(j_decompress_ptr cinfo)
+{
+    struct scaled_source *source = (struct scaled_source *)cinfo->src;
+    HRESULT hr;
+    ULONG bytesread;
+
+    hr = IStream_Read(source->stream, source->buffer, sizeof(source->buffer), &bytesread);
+
+    if (FAILED(hr) || bytesread == 0)
+        return FALSE;
+
+    source->source_mgr.next_input_byte = source->buffer;
+    source->source_mgr.bytes_in_buffer = bytesread;
+    return TRUE;
+}
+
+static void scaled_source_skip_input_data(j_decompress_ptr cinfo, long num_bytes)
+{
+    struct scaled_source *source = (struct scaled_source *)cinfo->src;
+    LARGE_INTEGER seek;
+
+    if (num_bytes > source->source_mgr.bytes_in_buffer)
+    {
+        seek.QuadPart = num_bytes - source->source_mgr.bytes_in_buffer;
+        IStream_Seek(source->stream, seek, STREAM_SEEK_CUR, NULL);
+        source->source_mgr.bytes_in_buffer = 0;
+    }
+    else if (num_bytes > 0)
+    {
+        source->source_mgr.next_input_byte += num_bytes;
+        source->source_mgr.bytes_in_buffer -= num_bytes;
+    }
+}
+
+/* Decodes the whole image at 1/denom of its size into This->scaled_data,
+ * with a second decompressor so that the progress of the full size decode
+ * is kept. Called with the decoder lock held. */
+static HRESULT decode_scaled(JpegDecoder *This, UINT denom, UINT bpp)
+{
+    struct jpeg_decompress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+    struct scaled_source *source;
+    UINT width, height, stride;
+    ULARGE_INTEGER position;
+    LARGE_INTEGER seek;
+    jmp_buf jmpbuf;
+    BYTE *data;
+    HRESULT hr;
+
+    width = (This->cinfo.image_width + denom - 1) / denom;
+    height = (This->cinfo.image_height + denom - 1) / denom;
+    stride = (bpp * width + 7) / 8;
+
+    seek.QuadPart = 0;
+    hr = IStream_Seek(This->stream, seek, STREAM_SEEK_CUR, &position);
+    if (FAILED(hr)) return hr;
+
+    source = HeapAlloc(GetProcessHeap(), 0, sizeof(*source));
+    data = HeapAlloc(GetProcessHeap(), 0, stride * height);
+    if (!source || !data)
+    {
+        HeapFree(GetProcessHeap(), 0, source);
+        HeapFree(GetProcessHeap(), 0, data);
+        return E_OUTOFMEMORY;
+    }
+
+    memset(&cinfo, 0, sizeof(cinfo));
+    pjpeg_std_error(&jerr);
+    jerr.error_exit = error_exit_fn;
+    jerr.emit_message = emit_message_fn;
+    cinfo.err = &jerr;
+    cinfo.client_data = jmpbuf;
+
+    if (setjmp(jmpbuf))
+    {
+        pjpeg_destroy_decompress(&cinfo);
+        HeapFree(GetProcessHeap(), 0, source);
+        HeapFree(GetProcessHeap(), 0, data);
+        seek.QuadPart = position.QuadPart;
+        IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+        return E_FAIL;
+    }
+
+    pjpeg_CreateDecompress(&cinfo, JPEG_LIB_VERSION, sizeof(struct jpeg_decompress_struct));
+
+    source->stream = This->stream;
+    source->source_mgr.bytes_in_buffer = 0;
+    source->source_mgr.init_source = source_mgr_init_source;
+    source->source_mgr.fill_input_buffer = scaled_source_fill_input_buffer;
+    source->source_mgr.skip_input_data = scaled_source_skip_input_data;
+    source->source_mgr.resync_to_restart = pjpeg_resync_to_restart;
+    source->source_mgr.term_source = source_mgr_term_source;
+    cinfo.src = &source->source_mgr;
+
+    seek.QuadPart = 0;
+    IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+
+    hr = E_FAIL;
+    if (pjpeg_read_header(&cinfo, TRUE) == JPEG_HEADER_OK)
+    {
+        cinfo.out_color_space = This->cinfo.out_color_space;
+        cinfo.scale_num = 1;
+        cinfo.scale_denom = denom;
+
+        if (pjpeg_start_decompress(&cinfo) &&
+            cinfo.output_width == width && cinfo.output_height == height)
+        {
+            hr = S_OK;
+            while (cinfo.output_scanline < cinfo.output_height)
+            {
+                UINT first_scanline = cinfo.output_scanline;
+                UINT max_rows, i;
+                JSAMPROW out_rows[4];
+
+                max_rows = min(cinfo.output_height - first_scanline, 4);
+                for (i = 0; i < max_rows; i++)
+                    out_rows[i] = data + stride * (first_scanline + i);
+
+                if (!pjpeg_read_scanlines(&cinfo, out_rows, max_rows))
+                {
+                    ERR("read_scanlines failed\n");
+                    hr = E_FAIL;
+                    break;
+                }
+
+                fixup_scanlines(&cinfo, bpp, data, stride, first_scanline);
+            }
+        }
+        else
+            ERR("failed to start a 1/%u scaled decode\n", denom);
+    }
+
+    pjpeg_destroy_decompress(&cinfo);
+    HeapFree(GetProcessHeap(), 0, source);
+
+    seek.QuadPart = position.QuadPart;
+    IStream_Seek(This->stream, seek, STREAM_SEEK_SET, NULL);
+
+    if (FAILED(hr))
+    {
+        HeapFree(GetProcessHeap(), 0, data);
+        return hr;
+    }
+
+    HeapFree(GetProcessHeap(), 0, This->scaled_data);
+    This->scaled_data = data;
+    This->scaled_denom = denom;
+    return S_OK;
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_CopyPixels(IWICBitmapSourceTransform *iface,
+    const WICRect *prc, UINT width, UINT height, WICPixelFormatGUID *format,
+    WICBitmapTransformOptions transform, UINT stride, UINT size, BYTE *buffer)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    UINT denom, bpp, scaled_width, scaled_height;
+    WICPixelFormatGUID native_format;
+    WICRect rect;
+    HRESULT hr;
+
+    TRACE("(%p,%s,%u,%u,%s,%u,%u,%u,%p)\n", iface, debug_wic_rect(prc), width, height,
+        debugstr_guid(format), transform, stride, size, buffer);
+
+    if (transform != WICBitmapTransformRotate0)
+    {
+        FIXME("unsupported transform %#x\n", transform);
+        return WINCODEC_ERR_UNSUPPORTEDOPERATION;
+    }
+
+    IWICBitmapFrameDecode_GetPixelFormat(&This->IWICBitmapFrameDecode_iface, &native_format);
+    if (format && !IsEqualGUID(format, &native_format))
+    {
+        FIXME("unsupported format %s\n", debugstr_guid(format));
+        return WINCODEC_ERR_UNSUPPORTEDPIXELFORMAT;
+    }
+
+    denom = get_scale_denom(This, width, height);
+    scaled_width = (This->cinfo.image_width + denom - 1) / denom;
+    scaled_height = (This->cinfo.image_height + denom - 1) / denom;
+    if (width != scaled_width || height != scaled_height)
+    {
+        WARN("unsupported size %ux%u\n", width, height);
+        return E_INVALIDARG;
+    }
+
+    if (denom == 1)
+        return IWICBitmapFrameDecode_CopyPixels(&This->IWICBitmapFrameDecode_iface, prc, stride, size, buffer);
+
+    if (!prc)
+    {
+        rect.X = 0;
+        rect.Y = 0;
+        rect.Width = width;
+        rect.Height = height;
+        prc = &rect;
+    }
+    else if (prc->X < 0 || prc->Y < 0 || prc->X + prc->Width > width || prc->Y + prc->Height > height)
+        return E_INVALIDARG;
+
+    if (This->cinfo.out_color_space == JCS_GRAYSCALE) bpp = 8;
+    else if (This->cinfo.out_color_space == JCS_CMYK) bpp = 32;
+    else bpp = 24;
+
+    EnterCriticalSection(&This->lock);
+
+    hr = S_OK;
+    if (This->scaled_denom != denom)
+        hr = decode_scaled(This, denom, bpp);
+
+    if (SUCCEEDED(hr))
+        hr = copy_pixels(bpp, This->scaled_data, width, height, (bpp * width + 7) / 8,
+            prc, stride, size, buffer);
+
+    LeaveCriticalSection(&This->lock);
+
+    return hr;
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_GetClosestSize(IWICBitmapSourceTransform *iface,
+    UINT *width, UINT *height)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+    UINT denom;
+
+    TRACE("(%p,%p,%p)\n", iface, width, height);
+
+    if (!width || !height) return E_INVALIDARG;
+
+    denom = get_scale_denom(This, *width, *height);
+    *width = (This->cinfo.image_width + denom - 1) / denom;
+    *height = (This->cinfo.image_height + denom - 1) / denom;
+
+    TRACE("<-- %ux%u\n", *width, *height);
+    return S_OK;
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_GetClosestPixelFormat(IWICBitmapSourceTransform *iface,
+    WICPixelFormatGUID *format)
+{
+    JpegDecoder *This = impl_from_IWICBitmapSourceTransform(iface);
+
+    TRACE("(%p,%p)\n", iface, format);
+
+    if (!format) return E_INVALIDARG;
+
+    return IWICBitmapFrameDecode_GetPixelFormat(&This->IWICBitmapFrameDecode_iface, format);
+}
+
+static HRESULT WINAPI JpegDecoder_Transform_DoesSupportTransform(IWICBitmapSourceTransform *iface,
+    WICBitmapTransformOptions transform, BOOL *supported)
+{
+    TRACE("(%p,%u,%p)\n", iface, transform, supported);
+
+    if (!supported) return E_INVALIDARG;
+
+    *supported = transform == WICBitmapTransformRotate0;
+    return S_OK;
+}
+
+static const IWICBitmapSourceTransformVtbl JpegDecoder_Transform_Vtbl = {
+    JpegDecoder_Transform_QueryInterface,
+    JpegDecoder_Transform_AddRef,
+    JpegDecoder_Transform_Release,
+    JpegDecoder_Transform_CopyPixels,
+    JpegDecoder_Transform_GetClosestSize,
+    JpegDecoder_Transform_GetClosestPixelFormat,
+    JpegDecoder_Transform_DoesSupportTransform
+};
+
 static HRESULT WINAPI JpegDecoder_Block_QueryInterface(IWICMetadataBlockReader *iface, REFIID iid,
     void **ppv)
 {
@@ -820,11 +1150,14 @@ HRESULT JpegDecoder_CreateInstance(REFIID iid, void** ppv)
     This->IWICBitmapDecoder_iface.lpVtbl = &JpegDecoder_Vtbl;
     This->IWICBitmapFrameDecode_iface.lpVtbl = &JpegDecoder_Frame_Vtbl;
     This->IWICMetadataBlockReader_iface.lpVtbl = &JpegDecoder_Block_Vtbl;
+    This->IWICBitmapSourceTransform_iface.lpVtbl = &JpegDecoder_Transform_Vtbl;
     This->ref = 1;
     This->initialized = FALSE;
     This->cinfo_initialized = FALSE;
     This->stream = NULL;
     This->image_data = NULL;
+    This->scaled_data = NULL;
+    This->scaled_denom = 0;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": JpegDecoder.lock");
 
@@ -19,6 +19,7 @@
 #include "config.h"
 
 #include <stdarg.h>
+#include <math.h>
 
 #define COBJMACROS
 
@@ -30,8 +31,26 @@
 
 #include "wine/debug.h"
 
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || defined(__clang__))
+#include <immintrin.h>
+#define HAVE_X86_SIMD
+#endif
+
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+#define FILTER_BITS 14
+#define FILTER_ONE (1 << FILTER_BITS)
+
+/* Resampling filter along one axis. Destination pixel i is the weighted sum
+ * of the taps source pixels starting at first[i], weights are fixed point
+ * with FILTER_BITS fractional bits and add up to FILTER_ONE. */
+struct scaler_filter {
+    UINT taps;
+    UINT *first;
+    SHORT *weights;
+};
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -42,6 +61,14 @@ typedef struct BitmapScaler {
     UINT bpp;
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    /* state of the interpolating modes */
+    struct scaler_filter *filter_x, *filter_y;
+    void (*fn_scale_row_x)(const struct scaler_filter*,UINT,const BYTE*,BYTE*,UINT);
+    void (*fn_scale_row_y)(const SHORT*,UINT,const BYTE**,BYTE*,UINT);
+    BYTE *src_line; /* one source scanline */
+    BYTE *rows; /* ring of horizontally scaled source scanlines */
+    INT *row_index; /* source scanline held in each ring slot, or -1 */
+    UINT row_count;
     CRITICAL_SECTION lock; /* must be held when initialized */
 } BitmapScaler;
 
@@ -50,6 +77,8 @@ static inline BitmapScaler *impl_from_IWICBitmapScaler(IWICBitmapScaler *iface)
     return CONTAINING_RECORD(iface, BitmapScaler, IWICBitmapScaler_iface);
 }
 
+static void Filter_Release(BitmapScaler *This);
+
 static HRESULT WINAPI BitmapScaler_QueryInterface(IWICBitmapScaler *iface, REFIID iid,
     void **ppv)
 {
@@ -96,6 +125,7 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        Filter_Release(This);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -193,6 +223,486 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+static double filter_linear(double x)
+{
+    x = fabs(x);
+    return x < 1.0 ? 1.0 - x : 0.0;
+}
+
+static double filter_cubic(double x)
+{
+    /* Keys cubic convolution, a = -0.5 */
+    x = fabs(x);
+    if (x < 1.0) return (1.5 * x - 2.5) * x * x + 1.0;
+    if (x < 2.0) return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+}
+
+static struct scaler_filter *create_filter(WICBitmapInterpolationMode mode, UINT src_len, UINT dst_len)
+{
+    double scale = (double)src_len / dst_len, fscale = max(scale, 1.0);
+    double support, center, lo = 0.0, hi = 0.0, sum, *w;
+    struct scaler_filter *filter;
+    INT start, end, i;
+    UINT d, taps;
+
+    switch (mode)
+    {
+    case WICBitmapInterpolationModeLinear:
+        support = fscale;
+        break;
+    case WICBitmapInterpolationModeCubic:
+        support = 2.0 * fscale;
+        break;
+    default:
+        /* Fant: source area covered by the destination pixel */
+        support = scale / 2.0;
+        break;
+    }
+
+    taps = min((UINT)ceil(support) * 2 + 1, src_len);
+
+    filter = HeapAlloc(GetProcessHeap(), 0, sizeof(*filter) + dst_len * sizeof(UINT) +
+                       dst_len * taps * sizeof(SHORT));
+    w = HeapAlloc(GetProcessHeap(), 0, taps * sizeof(double));
+    if (!filter || !w)
+    {
+        HeapFree(GetProcessHeap(), 0, filter);
+        HeapFree(GetProcessHeap(), 0, w);
+        return NULL;
+    }
+
+    filter->taps = taps;
+    filter->first = (UINT *)(filter + 1);
+    filter->weights = (SHORT *)(filter->first + dst_len);
+
+    for (d = 0; d < dst_len; d++)
+    {
+        SHORT *weights = filter->weights + d * taps;
+        INT total = 0, max_i = 0;
+
+        center = (d + 0.5) * scale;
+        if (mode == WICBitmapInterpolationModeFant)
+        {
+            lo = d * scale;
+            hi = (d + 1) * scale;
+            start = floor(lo);
+            end = ceil(hi);
+        }
+        else
+        {
+            start = floor(center - support + 0.5);
+            end = floor(center + support + 0.5);
+        }
+        start = max(start, 0);
+        end = min(end, (INT)src_len);
+        end = min(end, start + (INT)taps);
+
+        sum = 0.0;
+        for (i = start; i < end; i++)
+        {
+            switch (mode)
+            {
+            case WICBitmapInterpolationModeLinear:
+                w[i - start] = filter_linear((i + 0.5 - center) / fscale);
+                break;
+            case WICBitmapInterpolationModeCubic:
+                w[i - start] = filter_cubic((i + 0.5 - center) / fscale);
+                break;
+            default:
+                w[i - start] = min(i + 1.0, hi) - max((double)i, lo);
+                break;
+            }
+            sum += w[i - start];
+        }
+
+        if (end <= start || sum <= 0.0)
+        {
+            /* can't happen with the filters above, fall back to the nearest pixel */
+            start = min((INT)center, (INT)src_len - 1);
+            end = start + 1;
+            w[0] = sum = 1.0;
+        }
+
+        /* keep the window inside the source so that all taps can be read */
+        filter->first[d] = min((UINT)start, src_len - taps);
+        memset(weights, 0, taps * sizeof(SHORT));
+        for (i = start; i < end; i++)
+        {
+            SHORT *weight = &weights[i - filter->first[d]];
+
+            *weight = floor(w[i - start] / sum * FILTER_ONE + 0.5);
+            total += *weight;
+            if (*weight > weights[max_i]) max_i = weight - weights;
+        }
+        /* rounding errors go to the largest tap, so flat areas stay flat */
+        weights[max_i] += FILTER_ONE - total;
+    }
+
+    HeapFree(GetProcessHeap(), 0, w);
+    return filter;
+}
+
+static inline BYTE filter_result(INT sum)
+{
+    sum = (sum + FILTER_ONE / 2) >> FILTER_BITS;
+    return sum < 0 ? 0 : sum > 255 ? 255 : sum;
+}
+
+static void scale_row_x(const struct scaler_filter *filter, UINT channels,
+    const BYTE *src, BYTE *dst, UINT dst_width)
+{
+    UINT d, c, i, taps = filter->taps;
+
+    for (d = 0; d < dst_width; d++)
+    {
+        const SHORT *weights = filter->weights + d * taps;
+        const BYTE *pixel = src + filter->first[d] * channels;
+
+        for (c = 0; c < channels; c++)
+        {
+            INT sum = 0;
+
+            for (i = 0; i < taps; i++)
+                sum += weights[i] * pixel[i * channels + c];
+            *dst++ = filter_result(sum);
+        }
+    }
+}
+
+static void scale_row_y_part(const SHORT *weights, UINT taps, const BYTE **rows, BYTE *dst, UINT x, UINT len)
+{
+    UINT i;
+
+    for (; x < len; x++)
+    {
+        INT sum = 0;
+
+        for (i = 0; i < taps; i++)
+            sum += weights[i] * rows[i][x];
+        dst[x] = filter_result(sum);
+    }
+}
+
+static void scale_row_y(const SHORT *weights, UINT taps, const BYTE **rows, BYTE *dst, UINT len)
+{
+    scale_row_y_part(weights, taps, rows, dst, 0, len);
+}
+
+#ifdef HAVE_X86_SIMD
+
+#ifdef __i386__
+/* the Win32 ABI only guarantees 4-byte stack alignment */
+#define SSE2_FUNC __attribute__((target("sse2"), force_align_arg_pointer))
+#define AVX2_FUNC __attribute__((target("avx2"), force_align_arg_pointer))
+#else
+#define SSE2_FUNC __attribute__((target("sse2")))
+#define AVX2_FUNC __attribute__((target("avx2")))
+#endif
+
+/* two 16-bit weights, as expected by the pmaddwd based loops below */
+static inline INT weight_pair(const SHORT *weights, UINT i, UINT taps)
+{
+    return (USHORT)weights[i] | (i + 1 < taps ? (UINT)(USHORT)weights[i + 1] << 16 : 0);
+}
+
+static inline INT load_pixel(const BYTE *p)
+{
+    INT ret;
+    memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+
+static inline void store_pixel(BYTE *p, INT v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static SSE2_FUNC void scale_row_x_sse2(const struct scaler_filter *filter, UINT channels,
+    const BYTE *src, BYTE *dst, UINT dst_width)
+{
+    const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi32(FILTER_ONE / 2);
+    UINT d, i, taps = filter->taps;
+
+    if (channels != 4)
+    {
+        scale_row_x(filter, channels, src, dst, dst_width);
+        return;
+    }
+
+    for (d = 0; d < dst_width; d++)
+    {
+        const SHORT *weights = filter->weights + d * taps;
+        const BYTE *pixel = src + filter->first[d] * 4;
+        __m128i acc = round, p;
+
+        for (i = 0; i + 1 < taps; i += 2)
+        {
+            /* a0 a1 a2 a3 b0 b1 b2 b3 -> a0 b0 a1 b1 a2 b2 a3 b3 */
+            p = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(pixel + i * 4)), zero);
+            p = _mm_unpacklo_epi16(p, _mm_srli_si128(p, 8));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(p, _mm_set1_epi32(weight_pair(weights, i, taps))));
+        }
+        if (i < taps)
+        {
+            p = _mm_unpacklo_epi8(_mm_cvtsi32_si128(load_pixel(pixel + i * 4)), zero);
+            p = _mm_unpacklo_epi16(p, zero);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(p, _mm_set1_epi32(weight_pair(weights, i, taps))));
+        }
+
+        acc = _mm_srai_epi32(acc, FILTER_BITS);
+        acc = _mm_packs_epi32(acc, acc);
+        store_pixel(dst + d * 4, _mm_cvtsi128_si32(_mm_packus_epi16(acc, acc)));
+    }
+}
+
+static SSE2_FUNC void scale_row_y_part_sse2(const SHORT *weights, UINT taps, const BYTE **rows,
+    BYTE *dst, UINT x, UINT len)
+{
+    const __m128i zero = _mm_setzero_si128(), round = _mm_set1_epi32(FILTER_ONE / 2);
+    UINT i;
+
+    for (; x + 16 <= len; x += 16)
+    {
+        __m128i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+
+        for (i = 0; i < taps; i += 2)
+        {
+            __m128i w = _mm_set1_epi32(weight_pair(weights, i, taps));
+            __m128i a = _mm_loadu_si128((const __m128i *)(rows[i] + x));
+            __m128i b = i + 1 < taps ? _mm_loadu_si128((const __m128i *)(rows[i + 1] + x)) : zero;
+            __m128i lo = _mm_unpacklo_epi8(a, b), hi = _mm_unpackhi_epi8(a, b);
+
+            acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+            acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+            acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+            acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+        }
+
+        acc0 = _mm_packs_epi32(_mm_srai_epi32(acc0, FILTER_BITS), _mm_srai_epi32(acc1, FILTER_BITS));
+        acc2 = _mm_packs_epi32(_mm_srai_epi32(acc2, FILTER_BITS), _mm_srai_epi32(acc3, FILTER_BITS));
+        _mm_storeu_si128((__m128i *)(dst + x), _mm_packus_epi16(acc0, acc2));
+    }
+
+    scale_row_y_part(weights, taps, rows, dst, x, len);
+}
+
+static SSE2_FUNC void scale_row_y_sse2(const SHORT *weights, UINT taps, const BYTE **rows, BYTE *dst, UINT len)
+{
+    scale_row_y_part_sse2(weights, taps, rows, dst, 0, len);
+}
+
+static AVX2_FUNC void scale_row_x_avx2(const struct scaler_filter *filter, UINT channels,
+    const BYTE *src, BYTE *dst, UINT dst_width)
+{
+    const __m256i round = _mm256_set1_epi32(FILTER_ONE / 2);
+    UINT d, i, taps = filter->taps;
+
+    if (channels != 4)
+    {
+        scale_row_x(filter, channels, src, dst, dst_width);
+        return;
+    }
+
+    /* two destination pixels at a time, one in each 128-bit lane */
+    for (d = 0; d + 2 <= dst_width; d += 2)
+    {
+        const SHORT *weights0 = filter->weights + d * taps, *weights1 = weights0 + taps;
+        const BYTE *pixel0 = src + filter->first[d] * 4, *pixel1 = src + filter->first[d + 1] * 4;
+        __m256i acc = round, p;
+        __m128i pixels, res;
+        INT w0, w1;
+
+        for (i = 0; i < taps; i += 2)
+        {
+            /* the last odd tap is paired with a zero weight */
+            if (i + 1 < taps)
+                pixels = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)(pixel0 + i * 4)),
+                                            _mm_loadl_epi64((const __m128i *)(pixel1 + i * 4)));
+            else
+                pixels = _mm_unpacklo_epi64(_mm_cvtsi32_si128(load_pixel(pixel0 + i * 4)),
+                                            _mm_cvtsi32_si128(load_pixel(pixel1 + i * 4)));
+            p = _mm256_cvtepu8_epi16(pixels);
+            p = _mm256_unpacklo_epi16(p, _mm256_srli_si256(p, 8));
+            w0 = weight_pair(weights0, i, taps);
+            w1 = weight_pair(weights1, i, taps);
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(p, _mm256_setr_epi32(w0, w0, w0, w0, w1, w1, w1, w1)));
+        }
+
+        acc = _mm256_srai_epi32(acc, FILTER_BITS);
+        acc = _mm256_packs_epi32(acc, acc);
+        acc = _mm256_packus_epi16(acc, acc);
+        store_pixel(dst + d * 4, _mm_cvtsi128_si32(_mm256_castsi256_si128(acc)));
+        res = _mm256_extracti128_si256(acc, 1);
+        store_pixel(dst + d * 4 + 4, _mm_cvtsi128_si32(res));
+    }
+
+    if (d < dst_width)
+    {
+        struct scaler_filter last = { taps, filter->first + d, filter->weights + d * taps };
+        scale_row_x_sse2(&last, channels, src, dst + d * 4, dst_width - d);
+    }
+}
+
+static AVX2_FUNC void scale_row_y_avx2(const SHORT *weights, UINT taps, const BYTE **rows, BYTE *dst, UINT len)
+{
+    const __m256i zero = _mm256_setzero_si256(), round = _mm256_set1_epi32(FILTER_ONE / 2);
+    UINT x, i;
+
+    /* the unpacks work within 128-bit lanes, the packs at the end restore the order */
+    for (x = 0; x + 32 <= len; x += 32)
+    {
+        __m256i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+
+        for (i = 0; i < taps; i += 2)
+        {
+            __m256i w = _mm256_set1_epi32(weight_pair(weights, i, taps));
+            __m256i a = _mm256_loadu_si256((const __m256i *)(rows[i] + x));
+            __m256i b = i + 1 < taps ? _mm256_loadu_si256((const __m256i *)(rows[i + 1] + x)) : zero;
+            __m256i lo = _mm256_unpacklo_epi8(a, b), hi = _mm256_unpackhi_epi8(a, b);
+
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(_mm256_unpacklo_epi8(lo, zero), w));
+            acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(_mm256_unpackhi_epi8(lo, zero), w));
+            acc2 = _mm256_add_epi32(acc2, _mm256_madd_epi16(_mm256_unpacklo_epi8(hi, zero), w));
+            acc3 = _mm256_add_epi32(acc3, _mm256_madd_epi16(_mm256_unpackhi_epi8(hi, zero), w));
+        }
+
+        acc0 = _mm256_packs_epi32(_mm256_srai_epi32(acc0, FILTER_BITS), _mm256_srai_epi32(acc1, FILTER_BITS));
+        acc2 = _mm256_packs_epi32(_mm256_srai_epi32(acc2, FILTER_BITS), _mm256_srai_epi32(acc3, FILTER_BITS));
+        _mm256_storeu_si256((__m256i *)(dst + x), _mm256_packus_epi16(acc0, acc2));
+    }
+
+    scale_row_y_part_sse2(weights, taps, rows, dst, x, len);
+}
+
+#endif /* HAVE_X86_SIMD */
+
+static BOOL is_8bpc_format(const WICPixelFormatGUID *format)
+{
+    static const WICPixelFormatGUID * const formats[] =
+    {
+        &GUID_WICPixelFormat8bppGray,
+        &GUID_WICPixelFormat24bppBGR,
+        &GUID_WICPixelFormat24bppRGB,
+        &GUID_WICPixelFormat32bppBGR,
+        &GUID_WICPixelFormat32bppBGRA,
+        &GUID_WICPixelFormat32bppPBGRA,
+        &GUID_WICPixelFormat32bppRGB,
+        &GUID_WICPixelFormat32bppRGBA,
+        &GUID_WICPixelFormat32bppPRGBA,
+    };
+    UINT i;
+
+    for (i = 0; i < ARRAY_SIZE(formats); i++)
+        if (IsEqualGUID(format, formats[i])) return TRUE;
+    return FALSE;
+}
+
+static void Filter_Release(BitmapScaler *This)
+{
+    HeapFree(GetProcessHeap(), 0, This->filter_x);
+    HeapFree(GetProcessHeap(), 0, This->filter_y);
+    HeapFree(GetProcessHeap(), 0, This->src_line);
+    HeapFree(GetProcessHeap(), 0, This->rows);
+    HeapFree(GetProcessHeap(), 0, This->row_index);
+    This->filter_x = This->filter_y = NULL;
+    This->src_line = This->rows = NULL;
+    This->row_index = NULL;
+}
+
+static HRESULT Filter_Initialize(BitmapScaler *This)
+{
+    UINT channels = This->bpp / 8, i;
+
+    This->filter_x = create_filter(This->mode, This->src_width, This->width);
+    This->filter_y = create_filter(This->mode, This->src_height, This->height);
+    if (!This->filter_x || !This->filter_y)
+        return E_OUTOFMEMORY;
+
+    /* the scanlines needed by one destination row are consecutive, so a ring
+     * of that size lets top-down copies read each source scanline once */
+    This->row_count = This->filter_y->taps;
+    This->src_line = HeapAlloc(GetProcessHeap(), 0, This->src_width * channels);
+    This->rows = HeapAlloc(GetProcessHeap(), 0, This->row_count * This->width * channels);
+    This->row_index = HeapAlloc(GetProcessHeap(), 0, This->row_count * sizeof(INT));
+    if (!This->src_line || !This->rows || !This->row_index)
+        return E_OUTOFMEMORY;
+
+    for (i = 0; i < This->row_count; i++)
+        This->row_index[i] = -1;
+
+    This->fn_scale_row_x = scale_row_x;
+    This->fn_scale_row_y = scale_row_y;
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        This->fn_scale_row_x = scale_row_x_avx2;
+        This->fn_scale_row_y = scale_row_y_avx2;
+    }
+    else if (__builtin_cpu_supports("sse2"))
+    {
+        This->fn_scale_row_x = scale_row_x_sse2;
+        This->fn_scale_row_y = scale_row_y_sse2;
+    }
+#endif
+
+    return S_OK;
+}
+
+static HRESULT Filter_GetScaledRow(BitmapScaler *This, UINT src_y, const BYTE **row)
+{
+    UINT channels = This->bpp / 8, slot = src_y % This->row_count;
+    BYTE *dst = This->rows + slot * This->width * channels;
+
+    if (This->row_index[slot] != src_y)
+    {
+        WICRect rc = { 0, src_y, This->src_width, 1 };
+        HRESULT hr;
+
+        This->row_index[slot] = -1;
+        hr = IWICBitmapSource_CopyPixels(This->source, &rc, This->src_width * channels,
+            This->src_width * channels, This->src_line);
+        if (FAILED(hr)) return hr;
+
+        This->fn_scale_row_x(This->filter_x, channels, This->src_line, dst, This->width);
+        This->row_index[slot] = src_y;
+    }
+
+    *row = dst;
+    return S_OK;
+}
+
+static HRESULT Filter_CopyPixels(BitmapScaler *This, const WICRect *dest_rect,
+    UINT stride, BYTE *buffer)
+{
+    UINT channels = This->bpp / 8, taps = This->filter_y->taps, y, i;
+    const BYTE *rows[256], **row_ptrs = rows;
+    HRESULT hr = S_OK;
+
+    if (taps > ARRAY_SIZE(rows) &&
+        !(row_ptrs = HeapAlloc(GetProcessHeap(), 0, taps * sizeof(*row_ptrs))))
+        return E_OUTOFMEMORY;
+
+    for (y = 0; y < dest_rect->Height && SUCCEEDED(hr); y++)
+    {
+        UINT dst_y = dest_rect->Y + y;
+        UINT first = This->filter_y->first[dst_y];
+
+        for (i = 0; i < taps && SUCCEEDED(hr); i++)
+            hr = Filter_GetScaledRow(This, first + i, &row_ptrs[i]);
+        if (FAILED(hr)) break;
+
+        for (i = 0; i < taps; i++)
+            row_ptrs[i] += dest_rect->X * channels;
+        This->fn_scale_row_y(This->filter_y->weights + dst_y * taps, taps, row_ptrs,
+            buffer + stride * y, dest_rect->Width * channels);
+    }
+
+    if (row_ptrs != rows) HeapFree(GetProcessHeap(), 0, row_ptrs);
+    return hr;
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -247,6 +757,12 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
         goto end;
     }
 
+    if (This->filter_y)
+    {
+        hr = Filter_CopyPixels(This, &dest_rect, cbStride, pbBuffer);
+        goto end;
+    }
+
     /* MSDN recommends calling CopyPixels once for each scanline from top to
      * bottom, and claims codecs optimize for this. Ideally, when called in this
      * way, we should avoid requesting a scanline from the source more than
@@ -341,6 +857,29 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+            if (is_8bpc_format(&src_pixelformat))
+            {
+                IWICBitmapSource_AddRef(pISource);
+                This->source = pISource;
+            }
+            else
+            {
+                hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
+                    pISource, &This->source);
+                This->bpp = 32;
+            }
+            if (SUCCEEDED(hr))
+                hr = Filter_Initialize(This);
+            if (FAILED(hr))
+            {
+                Filter_Release(This);
+                if (This->source) IWICBitmapSource_Release(This->source);
+                This->source = NULL;
+            }
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
@@ -396,6 +935,10 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    This->filter_x = This->filter_y = NULL;
+    This->src_line = This->rows = NULL;
+    This->row_index = NULL;
+    This->row_count = 0;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
 
@@ -1245,6 +1245,113 @@ static void test_bitmap_scaler(void)
     IWICBitmap_Release(bitmap);
 }
 
+static IWICBitmapScaler *create_scaler(IWICBitmap *bitmap, UINT width, UINT height,
+    WICBitmapInterpolationMode mode)
+{
+    IWICBitmapScaler *scaler;
+    HRESULT hr;
+
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "Failed to create bitmap scaler, hr %#x.\n", hr);
+
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, width, height, mode);
+    ok(hr == S_OK, "Failed to initialize bitmap scaler, mode %u, hr %#x.\n", mode, hr);
+
+    return scaler;
+}
+
+static void test_bitmap_scaler_modes(void)
+{
+    static const WICBitmapInterpolationMode modes[] =
+    {
+        WICBitmapInterpolationModeNearestNeighbor,
+        WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic,
+        WICBitmapInterpolationModeFant,
+    };
+    static const struct
+    {
+        UINT width, height;
+    }
+    sizes[] = { {7, 5}, {16, 12}, {33, 29}, {3, 40} };
+    DWORD flat[16 * 12], full[40 * 40], row[40];
+    BYTE gradient[4] = { 0, 80, 160, 240 }, line[16];
+    WICPixelFormatGUID format;
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    UINT i, j, x, y;
+    HRESULT hr;
+
+    for (i = 0; i < ARRAY_SIZE(flat); i++)
+        flat[i] = 0x80402010;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 16, 12, &GUID_WICPixelFormat32bppBGRA,
+        16 * 4, sizeof(flat), (BYTE *)flat, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(modes); i++)
+    {
+        for (j = 0; j < ARRAY_SIZE(sizes); j++)
+        {
+            UINT width = sizes[j].width, height = sizes[j].height;
+
+            scaler = create_scaler(bitmap, width, height, modes[i]);
+
+            hr = IWICBitmapScaler_GetPixelFormat(scaler, &format);
+            ok(hr == S_OK, "Failed to get pixel format, hr %#x.\n", hr);
+            ok(IsEqualGUID(&format, &GUID_WICPixelFormat32bppBGRA), "Unexpected pixel format %s.\n",
+                wine_dbgstr_guid(&format));
+
+            /* Filters must preserve flat areas. */
+            memset(full, 0, sizeof(full));
+            hr = IWICBitmapScaler_CopyPixels(scaler, NULL, width * 4, sizeof(full), (BYTE *)full);
+            ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+            for (y = 0; y < height; y++)
+                for (x = 0; x < width; x++)
+                    ok(full[y * width + x] == 0x80402010, "mode %u, %ux%u: got %08x at %u,%u.\n",
+                        modes[i], width, height, full[y * width + x], x, y);
+
+            /* Partial rows must match the full copy. */
+            for (y = 0; y < height; y++)
+            {
+                WICRect rc = { width / 2, y, width - width / 2, 1 };
+
+                memset(row, 0, sizeof(row));
+                hr = IWICBitmapScaler_CopyPixels(scaler, &rc, sizeof(row), sizeof(row), (BYTE *)row);
+                ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+                ok(!memcmp(row, full + y * width + width / 2, rc.Width * 4),
+                    "mode %u, %ux%u: row %u differs.\n", modes[i], width, height, y);
+            }
+
+            IWICBitmapScaler_Release(scaler);
+        }
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 4, 1, &GUID_WICPixelFormat8bppGray,
+        4, sizeof(gradient), gradient, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#x.\n", hr);
+
+    /* Interpolated ramps stay monotonic, cubic ones may overshoot at the ends. */
+    for (i = 1; i < ARRAY_SIZE(modes); i++)
+    {
+        scaler = create_scaler(bitmap, 16, 1, modes[i]);
+
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 16, sizeof(line), line);
+        ok(hr == S_OK, "Failed to copy pixels, hr %#x.\n", hr);
+        for (x = 1; x < 16; x++)
+            ok(line[x] >= line[x - 1], "mode %u: %u at %u after %u.\n", modes[i], line[x], x, line[x - 1]);
+        if (modes[i] != WICBitmapInterpolationModeCubic)
+            ok(line[15] <= 240, "mode %u: got %u.\n", modes[i], line[15]);
+        ok(line[7] > 0 && line[8] < 240, "mode %u: got %u, %u.\n", modes[i], line[7], line[8]);
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+}
+
 START_TEST(bitmap)
 {
     HRESULT hr;
@@ -1262,6 +1369,7 @@ START_TEST(bitmap)
     test_CreateBitmapFromHBITMAP();
     test_clipper();
     test_bitmap_scaler();
+    test_bitmap_scaler_modes();
 
     IWICImagingFactory_Release(factory);
 
@@ -19,6 +19,7 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 
 #define COBJMACROS
@@ -461,6 +462,168 @@ static void test_default_converter(void)
     DeleteTestBitmap(src_obj);
 }
 
+static BYTE *convert_bits(const struct bitmap_data *src, const WICPixelFormatGUID *format, UINT bpp)
+{
+    UINT stride = (src->width * bpp + 7) / 8, size = stride * src->height;
+    BitmapTestSrc *src_obj;
+    IWICBitmapSource *dst_bitmap;
+    BYTE *bits;
+    HRESULT hr;
+
+    CreateTestBitmap(src, &src_obj);
+
+    hr = WICConvertBitmapSource(format, &src_obj->IWICBitmapSource_iface, &dst_bitmap);
+    ok(hr == S_OK, "WICConvertBitmapSource failed, hr %#x\n", hr);
+    if (FAILED(hr))
+    {
+        DeleteTestBitmap(src_obj);
+        return NULL;
+    }
+
+    bits = HeapAlloc(GetProcessHeap(), 0, size);
+    hr = IWICBitmapSource_CopyPixels(dst_bitmap, NULL, stride, size, bits);
+    ok(hr == S_OK, "CopyPixels failed, hr %#x\n", hr);
+
+    IWICBitmapSource_Release(dst_bitmap);
+    DeleteTestBitmap(src_obj);
+    return bits;
+}
+
+static void test_premultiplied_conversion(void)
+{
+    struct bitmap_data data = { &GUID_WICPixelFormat32bppBGRA, 32, NULL, 256, 256, 96.0, 96.0 };
+    BYTE *bits, *converted;
+    UINT c, a, i;
+
+    /* every colour value against every alpha value, with a different
+     * colour in each channel to catch mixed up lanes */
+    bits = HeapAlloc(GetProcessHeap(), 0, 256 * 256 * 4);
+    for (a = 0; a < 256; a++)
+        for (c = 0; c < 256; c++)
+        {
+            BYTE *pixel = bits + (a * 256 + c) * 4;
+            pixel[0] = c;
+            pixel[1] = c ^ 0x5a;
+            pixel[2] = 255 - c;
+            pixel[3] = a;
+        }
+    data.bits = bits;
+
+    converted = convert_bits(&data, &GUID_WICPixelFormat32bppPBGRA, 32);
+    for (i = 0; converted && i < 256 * 256 * 4; i++)
+    {
+        BYTE alpha = bits[i | 3], expect = (i & 3) == 3 || alpha == 255 ? bits[i] : bits[i] * alpha / 255;
+        ok(converted[i] == expect || broken(abs(converted[i] - expect) <= 1),
+           "BGRA -> PBGRA: pixel %u channel %u: got %u, expected %u\n", i / 4, i & 3, converted[i], expect);
+        if (converted[i] != expect) break;
+    }
+    HeapFree(GetProcessHeap(), 0, converted);
+
+    /* only channels not exceeding alpha are valid premultiplied data */
+    data.format = &GUID_WICPixelFormat32bppPBGRA;
+    converted = convert_bits(&data, &GUID_WICPixelFormat32bppBGRA, 32);
+    for (i = 0; converted && i < 256 * 256 * 4; i++)
+    {
+        BYTE alpha = bits[i | 3], expect;
+
+        if ((i & 3) != 3 && bits[i] > alpha) continue;
+        expect = (i & 3) == 3 || alpha == 0 || alpha == 255 ? bits[i] : bits[i] * 255 / alpha;
+        ok(converted[i] == expect || broken(abs(converted[i] - expect) <= 1),
+           "PBGRA -> BGRA: pixel %u channel %u: got %u, expected %u\n", i / 4, i & 3, converted[i], expect);
+        if (converted[i] != expect) break;
+    }
+    HeapFree(GetProcessHeap(), 0, converted);
+
+    /* opaque sources are not changed by premultiplication */
+    data.format = &GUID_WICPixelFormat24bppBGR;
+    data.bpp = 24;
+    converted = convert_bits(&data, &GUID_WICPixelFormat32bppPBGRA, 32);
+    for (i = 0; converted && i < 256 * 256; i++)
+    {
+        const BYTE *src = bits + i * 3;
+        DWORD expect = 0xff000000 | src[2] << 16 | src[1] << 8 | src[0];
+        ok(((DWORD *)converted)[i] == expect, "24bppBGR -> PBGRA: pixel %u: got %08x, expected %08x\n",
+           i, ((DWORD *)converted)[i], expect);
+        if (((DWORD *)converted)[i] != expect) break;
+    }
+    HeapFree(GetProcessHeap(), 0, converted);
+
+    HeapFree(GetProcessHeap(), 0, bits);
+}
+
+static inline float to_sRGB_component(float f)
+{
+    if (f <= 0.0031308f) return 12.92f * f;
+    return 1.055f * powf(f, 1.0f/2.4f) - 0.055f;
+}
+
+static BYTE expected_gray(float gray)
+{
+    return floorf(to_sRGB_component(gray) * 255.0f + 0.51f);
+}
+
+static void test_gray_conversion(void)
+{
+    static const struct
+    {
+        const WICPixelFormatGUID *format;
+        UINT bpp;
+        const char *name;
+    }
+    formats[] =
+    {
+        { &GUID_WICPixelFormat24bppBGR, 24, "24bppBGR" },
+        { &GUID_WICPixelFormat32bppBGR, 32, "32bppBGR" },
+        { &GUID_WICPixelFormat32bppBGRA, 32, "32bppBGRA" },
+    };
+    struct bitmap_data data = { NULL, 0, NULL, 256, 256, 96.0, 96.0 };
+    BYTE *bits, *converted;
+    float *gray_float;
+    UINT i, j;
+
+    bits = HeapAlloc(GetProcessHeap(), 0, 256 * 256 * 4);
+    for (i = 0; i < 256 * 256 * 4; i++)
+        bits[i] = (i & 3) == 3 ? 255 : i * 7 + i / 1021;
+    data.bits = bits;
+
+    /* the float math may run with x87 precision on i386, allow the last bit
+     * to differ */
+    for (j = 0; j < ARRAY_SIZE(formats); j++)
+    {
+        UINT step = formats[j].bpp / 8;
+
+        data.format = formats[j].format;
+        data.bpp = formats[j].bpp;
+        converted = convert_bits(&data, &GUID_WICPixelFormat8bppGray, 8);
+        for (i = 0; converted && i < 256 * 256; i++)
+        {
+            const BYTE *bgr = bits + i * step;
+            BYTE expect = expected_gray((bgr[2] * 0.2126f + bgr[1] * 0.7152f + bgr[0] * 0.0722f) / 255.0f);
+            ok(abs(converted[i] - expect) <= 1, "%s -> 8bppGray: pixel %u: got %u, expected %u\n",
+               formats[j].name, i, converted[i], expect);
+            if (abs(converted[i] - expect) > 1) break;
+        }
+        HeapFree(GetProcessHeap(), 0, converted);
+    }
+
+    gray_float = (float *)bits;
+    for (i = 0; i < 256 * 256; i++)
+        gray_float[i] = i / 65535.0f;
+    data.format = &GUID_WICPixelFormat32bppGrayFloat;
+    data.bpp = 32;
+    converted = convert_bits(&data, &GUID_WICPixelFormat8bppGray, 8);
+    for (i = 0; converted && i < 256 * 256; i++)
+    {
+        BYTE expect = expected_gray(gray_float[i]);
+        ok(abs(converted[i] - expect) <= 1, "32bppGrayFloat -> 8bppGray: pixel %u: got %u, expected %u\n",
+           i, converted[i], expect);
+        if (abs(converted[i] - expect) > 1) break;
+    }
+    HeapFree(GetProcessHeap(), 0, converted);
+
+    HeapFree(GetProcessHeap(), 0, bits);
+}
+
 typedef struct property_opt_test_data
 {
     LPCOLESTR name;
@@ -1484,6 +1647,8 @@ START_TEST(converter)
     test_conversion(&testdata_32bppGrayFloat, &testdata_24bppBGR_gray, "32bppGrayFloat -> 24bppBGR gray", FALSE);
     test_conversion(&testdata_32bppGrayFloat, &testdata_8bppGray, "32bppGrayFloat -> 8bppGray", FALSE);
 
+    test_premultiplied_conversion();
+    test_gray_conversion();
     test_invalid_conversion();
     test_default_converter();
 
@@ -134,12 +134,166 @@ static void test_decode_adobe_cmyk(void)
     IWICBitmapDecoder_Release(decoder);
 }
 
+static IStream *encode_24bpp_jpeg(UINT width, UINT height, const BYTE *bits)
+{
+    WICPixelFormatGUID format = GUID_WICPixelFormat24bppBGR;
+    IWICBitmapEncoder *encoder;
+    IWICBitmapFrameEncode *frame;
+    IStream *stream;
+    HRESULT hr;
+
+    hr = CreateStreamOnHGlobal(NULL, TRUE, &stream);
+    ok(hr == S_OK, "CreateStreamOnHGlobal failed, hr=%x\n", hr);
+
+    hr = CoCreateInstance(&CLSID_WICJpegEncoder, NULL, CLSCTX_INPROC_SERVER,
+        &IID_IWICBitmapEncoder, (void **)&encoder);
+    ok(hr == S_OK, "CoCreateInstance failed, hr=%x\n", hr);
+    hr = IWICBitmapEncoder_Initialize(encoder, stream, WICBitmapEncoderNoCache);
+    ok(hr == S_OK, "Initialize failed, hr=%x\n", hr);
+    hr = IWICBitmapEncoder_CreateNewFrame(encoder, &frame, NULL);
+    ok(hr == S_OK, "CreateNewFrame failed, hr=%x\n", hr);
+    hr = IWICBitmapFrameEncode_Initialize(frame, NULL);
+    ok(hr == S_OK, "Initialize failed, hr=%x\n", hr);
+    hr = IWICBitmapFrameEncode_SetSize(frame, width, height);
+    ok(hr == S_OK, "SetSize failed, hr=%x\n", hr);
+    hr = IWICBitmapFrameEncode_SetPixelFormat(frame, &format);
+    ok(hr == S_OK, "SetPixelFormat failed, hr=%x\n", hr);
+    hr = IWICBitmapFrameEncode_WritePixels(frame, height, width * 3, width * height * 3, (BYTE *)bits);
+    ok(hr == S_OK, "WritePixels failed, hr=%x\n", hr);
+    hr = IWICBitmapFrameEncode_Commit(frame);
+    ok(hr == S_OK, "Commit failed, hr=%x\n", hr);
+    hr = IWICBitmapEncoder_Commit(encoder);
+    ok(hr == S_OK, "Commit failed, hr=%x\n", hr);
+
+    IWICBitmapFrameEncode_Release(frame);
+    IWICBitmapEncoder_Release(encoder);
+    return stream;
+}
+
+static IWICBitmapFrameDecode *decode_jpeg(IStream *stream)
+{
+    IWICBitmapDecoder *decoder;
+    IWICBitmapFrameDecode *frame = NULL;
+    HRESULT hr;
+
+    hr = CoCreateInstance(&CLSID_WICJpegDecoder, NULL, CLSCTX_INPROC_SERVER,
+        &IID_IWICBitmapDecoder, (void **)&decoder);
+    ok(hr == S_OK, "CoCreateInstance failed, hr=%x\n", hr);
+    hr = IWICBitmapDecoder_Initialize(decoder, stream, WICDecodeMetadataCacheOnDemand);
+    ok(hr == S_OK, "Initialize failed, hr=%x\n", hr);
+    hr = IWICBitmapDecoder_GetFrame(decoder, 0, &frame);
+    ok(hr == S_OK, "GetFrame failed, hr=%x\n", hr);
+
+    IWICBitmapDecoder_Release(decoder);
+    return frame;
+}
+
+static void test_source_transform(void)
+{
+    UINT width = 512, height = 384, x, y, i, scaled_width, scaled_height, max_diff = 0;
+    IWICBitmapSourceTransform *transform;
+    IWICBitmapFrameDecode *frame;
+    WICPixelFormatGUID format;
+    BYTE *bits, *full, *scaled;
+    BOOL supported;
+    IStream *stream;
+    HRESULT hr;
+
+    bits = HeapAlloc(GetProcessHeap(), 0, width * height * 3);
+    full = HeapAlloc(GetProcessHeap(), 0, width * height * 3);
+    scaled = HeapAlloc(GetProcessHeap(), 0, width * height * 3);
+    for (y = 0; y < height; y++)
+        for (x = 0; x < width; x++)
+        {
+            bits[(y * width + x) * 3] = x / 2;
+            bits[(y * width + x) * 3 + 1] = y * 2 / 3;
+            bits[(y * width + x) * 3 + 2] = (x + y) / 4;
+        }
+
+    stream = encode_24bpp_jpeg(width, height, bits);
+    frame = decode_jpeg(stream);
+
+    hr = IWICBitmapFrameDecode_QueryInterface(frame, &IID_IWICBitmapSourceTransform, (void **)&transform);
+    ok(hr == S_OK, "QueryInterface failed, hr=%x\n", hr);
+    if (FAILED(hr))
+    {
+        IWICBitmapFrameDecode_Release(frame);
+        IStream_Release(stream);
+        goto done;
+    }
+
+    hr = IWICBitmapSourceTransform_DoesSupportTransform(transform, WICBitmapTransformRotate0, &supported);
+    ok(hr == S_OK, "DoesSupportTransform failed, hr=%x\n", hr);
+    ok(supported, "expected Rotate0 to be supported\n");
+
+    hr = IWICBitmapSourceTransform_GetClosestPixelFormat(transform, &format);
+    ok(hr == S_OK, "GetClosestPixelFormat failed, hr=%x\n", hr);
+    ok(IsEqualGUID(&format, &GUID_WICPixelFormat24bppBGR), "unexpected pixel format %s\n", wine_dbgstr_guid(&format));
+
+    scaled_width = 100;
+    scaled_height = 70;
+    hr = IWICBitmapSourceTransform_GetClosestSize(transform, &scaled_width, &scaled_height);
+    ok(hr == S_OK, "GetClosestSize failed, hr=%x\n", hr);
+    ok(scaled_width == 128 && scaled_height == 96, "got %ux%u\n", scaled_width, scaled_height);
+
+    scaled_width = 64;
+    scaled_height = 48;
+    hr = IWICBitmapSourceTransform_GetClosestSize(transform, &scaled_width, &scaled_height);
+    ok(hr == S_OK, "GetClosestSize failed, hr=%x\n", hr);
+    ok(scaled_width == 64 && scaled_height == 48, "got %ux%u\n", scaled_width, scaled_height);
+
+    hr = IWICBitmapFrameDecode_CopyPixels(frame, NULL, width * 3, width * height * 3, full);
+    ok(hr == S_OK, "CopyPixels failed, hr=%x\n", hr);
+
+    hr = IWICBitmapSourceTransform_CopyPixels(transform, NULL, scaled_width, scaled_height, &format,
+        WICBitmapTransformRotate0, scaled_width * 3, scaled_width * scaled_height * 3, scaled);
+    ok(hr == S_OK, "CopyPixels failed, hr=%x\n", hr);
+
+    /* each scaled pixel is the DC coefficient of an 8x8 block */
+    for (y = 0; hr == S_OK && y < scaled_height; y++)
+        for (x = 0; x < scaled_width; x++)
+            for (i = 0; i < 3; i++)
+            {
+                UINT sum = 0, xx, yy, diff;
+
+                for (yy = y * 8; yy < y * 8 + 8; yy++)
+                    for (xx = x * 8; xx < x * 8 + 8; xx++)
+                        sum += full[(yy * width + xx) * 3 + i];
+                diff = abs((int)scaled[(y * scaled_width + x) * 3 + i] - (int)((sum + 32) / 64));
+                max_diff = max(max_diff, diff);
+            }
+    ok(max_diff <= 4, "scaled image differs by up to %u\n", max_diff);
+
+    /* a rectangle of the scaled image */
+    if (hr == S_OK)
+    {
+        WICRect rc = { 10, 20, 30, 5 };
+        BYTE *row = full;
+
+        hr = IWICBitmapSourceTransform_CopyPixels(transform, &rc, scaled_width, scaled_height, NULL,
+            WICBitmapTransformRotate0, rc.Width * 3, rc.Width * rc.Height * 3, row);
+        ok(hr == S_OK, "CopyPixels failed, hr=%x\n", hr);
+        for (y = 0; y < rc.Height; y++)
+            ok(!memcmp(row + y * rc.Width * 3, scaled + ((rc.Y + y) * scaled_width + rc.X) * 3, rc.Width * 3),
+               "row %u doesn't match\n", y);
+    }
+
+    IWICBitmapSourceTransform_Release(transform);
+    IWICBitmapFrameDecode_Release(frame);
+    IStream_Release(stream);
+
+done:
+    HeapFree(GetProcessHeap(), 0, bits);
+    HeapFree(GetProcessHeap(), 0, full);
+    HeapFree(GetProcessHeap(), 0, scaled);
+}
 
 START_TEST(jpegformat)
 {
     CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
 
     test_decode_adobe_cmyk();
+    test_source_transform();
 
     CoUninitialize();
 }
@@ -609,6 +609,95 @@ static void test_tiff_24bpp(void)
     IWICBitmapDecoder_Release(decoder);
 }
 
+static IStream *encode_24bpp_tiff(UINT width, UINT height, const BYTE *bits)
+{
+    WICPixelFormatGUID format = GUID_WICPixelFormat24bppBGR;
+    IWICBitmapEncoder *encoder;
+    IWICBitmapFrameEncode *frame;
+    IStream *stream;
+    HRESULT hr;
+
+    hr = CreateStreamOnHGlobal(NULL, TRUE, &stream);
+    ok(hr == S_OK, "CreateStreamOnHGlobal error %#x\n", hr);
+
+    hr = IWICImagingFactory_CreateEncoder(factory, &GUID_ContainerFormatTiff, NULL, &encoder);
+    ok(hr == S_OK, "CreateEncoder error %#x\n", hr);
+    hr = IWICBitmapEncoder_Initialize(encoder, stream, WICBitmapEncoderNoCache);
+    ok(hr == S_OK, "Initialize error %#x\n", hr);
+    hr = IWICBitmapEncoder_CreateNewFrame(encoder, &frame, NULL);
+    ok(hr == S_OK, "CreateNewFrame error %#x\n", hr);
+    hr = IWICBitmapFrameEncode_Initialize(frame, NULL);
+    ok(hr == S_OK, "Initialize error %#x\n", hr);
+    hr = IWICBitmapFrameEncode_SetSize(frame, width, height);
+    ok(hr == S_OK, "SetSize error %#x\n", hr);
+    hr = IWICBitmapFrameEncode_SetPixelFormat(frame, &format);
+    ok(hr == S_OK, "SetPixelFormat error %#x\n", hr);
+    ok(IsEqualGUID(&format, &GUID_WICPixelFormat24bppBGR), "got wrong format %s\n", wine_dbgstr_guid(&format));
+    hr = IWICBitmapFrameEncode_WritePixels(frame, height, width * 3, width * height * 3, (BYTE *)bits);
+    ok(hr == S_OK, "WritePixels error %#x\n", hr);
+    hr = IWICBitmapFrameEncode_Commit(frame);
+    ok(hr == S_OK, "Commit error %#x\n", hr);
+    hr = IWICBitmapEncoder_Commit(encoder);
+    ok(hr == S_OK, "Commit error %#x\n", hr);
+
+    IWICBitmapFrameEncode_Release(frame);
+    IWICBitmapEncoder_Release(encoder);
+    return stream;
+}
+
+static void test_tiff_strips(void)
+{
+    static const WICRect rects[] =
+    {
+        { 0, 0, 1024, 768 },
+        { 3, 101, 700, 450 },
+        { 1000, 0, 24, 768 },
+        { 0, 767, 1024, 1 },
+    };
+    UINT width = 1024, height = 768, i, y;
+    IWICBitmapDecoder *decoder;
+    IWICBitmapFrameDecode *frame;
+    BYTE *bits, *data;
+    IStream *stream;
+    HRESULT hr;
+
+    /* the encoder splits this into many strips, which are decoded
+     * concurrently on multi-CPU machines */
+    bits = HeapAlloc(GetProcessHeap(), 0, width * height * 3);
+    data = HeapAlloc(GetProcessHeap(), 0, width * height * 3);
+    for (i = 0; i < width * height * 3; i++)
+        bits[i] = i * 7 + i / 1021;
+
+    stream = encode_24bpp_tiff(width, height, bits);
+    hr = IWICImagingFactory_CreateDecoderFromStream(factory, stream, NULL, 0, &decoder);
+    ok(hr == S_OK, "CreateDecoderFromStream error %#x\n", hr);
+    hr = IWICBitmapDecoder_GetFrame(decoder, 0, &frame);
+    ok(hr == S_OK, "GetFrame error %#x\n", hr);
+
+    for (i = 0; i < ARRAY_SIZE(rects); i++)
+    {
+        const WICRect *rc = &rects[i];
+
+        memset(data, 0xcc, width * height * 3);
+        hr = IWICBitmapFrameDecode_CopyPixels(frame, rc, rc->Width * 3, rc->Width * rc->Height * 3, data);
+        ok(hr == S_OK, "%u: CopyPixels error %#x\n", i, hr);
+
+        for (y = 0; y < rc->Height; y++)
+        {
+            const BYTE *expect = bits + (rc->Y + y) * width * 3 + rc->X * 3;
+            if (memcmp(data + y * rc->Width * 3, expect, rc->Width * 3))
+                break;
+        }
+        ok(y == rc->Height, "%u: row %u doesn't match\n", i, y);
+    }
+
+    IWICBitmapFrameDecode_Release(frame);
+    IWICBitmapDecoder_Release(decoder);
+    IStream_Release(stream);
+    HeapFree(GetProcessHeap(), 0, bits);
+    HeapFree(GetProcessHeap(), 0, data);
+}
+
 START_TEST(tiffformat)
 {
     HRESULT hr;
@@ -625,6 +714,7 @@ START_TEST(tiffformat)
     test_tiff_8bpp_alpha();
     test_tiff_resolution();
     test_tiff_24bpp();
+    test_tiff_strips();
 
     IWICImagingFactory_Release(factory);
     CoUninitialize();
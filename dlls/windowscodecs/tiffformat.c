@@ -222,13 +222,32 @@ static TIFF* tiff_open_stream(IStream *stream, const char *mode)
         (void *)tiff_stream_size, (void *)tiff_stream_map, (void *)tiff_stream_unmap);
 }
 
+#define TIFF_MAX_WORKERS 8
+
+/* A private libtiff handle used to decode tiles on another thread. All
+ * handles share the decoder's stream and serialize their reads on io_lock,
+ * each one keeping its own position. */
+struct tiff_worker
+{
+    IStream *stream;
+    CRITICAL_SECTION *io_lock;
+    ULONGLONG pos;
+    TIFF *tiff;
+    UINT dir;
+    BYTE *tile;
+    UINT tile_size;
+};
+
 typedef struct {
     IWICBitmapDecoder IWICBitmapDecoder_iface;
     LONG ref;
     IStream *stream;
     CRITICAL_SECTION lock; /* Must be held when tiff is used or initialized is set */
+    CRITICAL_SECTION io_lock; /* Must be held when a worker accesses the stream */
     TIFF *tiff;
     BOOL initialized;
+    struct tiff_worker *workers[TIFF_MAX_WORKERS];
+    UINT worker_count;
 } TiffDecoder;
 
 typedef struct {
@@ -264,6 +283,94 @@ typedef struct {
 static const IWICBitmapFrameDecodeVtbl TiffFrameDecode_Vtbl;
 static const IWICMetadataBlockReaderVtbl TiffFrameDecode_BlockVtbl;
 
+static tsize_t tiff_worker_read(thandle_t client_data, tdata_t data, tsize_t size)
+{
+    struct tiff_worker *worker = client_data;
+    LARGE_INTEGER move;
+    ULONG bytes_read = 0;
+    HRESULT hr;
+
+    EnterCriticalSection(worker->io_lock);
+    move.QuadPart = worker->pos;
+    hr = IStream_Seek(worker->stream, move, STREAM_SEEK_SET, NULL);
+    if (SUCCEEDED(hr)) hr = IStream_Read(worker->stream, data, size, &bytes_read);
+    if (FAILED(hr)) bytes_read = 0;
+    worker->pos += bytes_read;
+    LeaveCriticalSection(worker->io_lock);
+
+    return bytes_read;
+}
+
+static tsize_t tiff_worker_write(thandle_t client_data, tdata_t data, tsize_t size)
+{
+    /* Worker handles are read-only. */
+    return 0;
+}
+
+static toff_t tiff_worker_size(thandle_t client_data)
+{
+    struct tiff_worker *worker = client_data;
+    toff_t size;
+
+    EnterCriticalSection(worker->io_lock);
+    size = tiff_stream_size(worker->stream);
+    LeaveCriticalSection(worker->io_lock);
+
+    return size;
+}
+
+static toff_t tiff_worker_seek(thandle_t client_data, toff_t offset, int whence)
+{
+    struct tiff_worker *worker = client_data;
+
+    switch (whence)
+    {
+        case SEEK_SET:
+            worker->pos = offset;
+            break;
+        case SEEK_CUR:
+            worker->pos += offset;
+            break;
+        case SEEK_END:
+            worker->pos = tiff_worker_size(client_data) + offset;
+            break;
+        default:
+            ERR("unknown whence value %i\n", whence);
+            return -1;
+    }
+
+    return worker->pos;
+}
+
+static struct tiff_worker *tiff_worker_create(TiffDecoder *decoder)
+{
+    struct tiff_worker *worker;
+
+    worker = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, sizeof(*worker));
+    if (!worker) return NULL;
+
+    worker->stream = decoder->stream;
+    worker->io_lock = &decoder->io_lock;
+    worker->dir = ~0u;
+    worker->tiff = pTIFFClientOpen("<IStream object>", "r", worker, tiff_worker_read,
+        tiff_worker_write, (void *)tiff_worker_seek, tiff_stream_close,
+        (void *)tiff_worker_size, (void *)tiff_stream_map, (void *)tiff_stream_unmap);
+    if (!worker->tiff)
+    {
+        HeapFree(GetProcessHeap(), 0, worker);
+        return NULL;
+    }
+
+    return worker;
+}
+
+static void tiff_worker_destroy(struct tiff_worker *worker)
+{
+    pTIFFClose(worker->tiff);
+    HeapFree(GetProcessHeap(), 0, worker->tile);
+    HeapFree(GetProcessHeap(), 0, worker);
+}
+
 static inline TiffDecoder *impl_from_IWICBitmapDecoder(IWICBitmapDecoder *iface)
 {
     return CONTAINING_RECORD(iface, TiffDecoder, IWICBitmapDecoder_iface);
@@ -604,10 +711,16 @@ static ULONG WINAPI TiffDecoder_Release(IWICBitmapDecoder *iface)
 
     if (ref == 0)
     {
+        UINT i;
+
+        for (i = 0; i < This->worker_count; i++)
+            tiff_worker_destroy(This->workers[i]);
         if (This->tiff) pTIFFClose(This->tiff);
         if (This->stream) IStream_Release(This->stream);
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
+        This->io_lock.DebugInfo->Spare[0] = 0;
+        DeleteCriticalSection(&This->io_lock);
         HeapFree(GetProcessHeap(), 0, This);
     }
 
@@ -963,42 +1076,34 @@ static HRESULT WINAPI TiffFrameDecode_CopyPalette(IWICBitmapFrameDecode *iface,
     return IWICPalette_InitializeCustom(pIPalette, colors, color_count);
 }
 
-static HRESULT TiffFrameDecode_ReadTile(TiffFrameDecode *This, UINT tile_x, UINT tile_y)
+static HRESULT tiff_decode_tile(TIFF *tiff, const tiff_decode_info *info, UINT tile_x, UINT tile_y, BYTE *buffer)
 {
     HRESULT hr=S_OK;
     tsize_t ret;
     int swap_bytes;
 
-    swap_bytes = pTIFFIsByteSwapped(This->parent->tiff);
+    swap_bytes = pTIFFIsByteSwapped(tiff);
 
-    ret = pTIFFSetDirectory(This->parent->tiff, This->index);
+    if (info->tiled)
+    {
+        ret = pTIFFReadEncodedTile(tiff, tile_x + tile_y * info->tiles_across, buffer, info->tile_size);
+    }
+    else
+    {
+        ret = pTIFFReadEncodedStrip(tiff, tile_y, buffer, info->tile_size);
+    }
 
     if (ret == -1)
         hr = E_FAIL;
 
-    if (hr == S_OK)
-    {
-        if (This->decode_info.tiled)
-        {
-            ret = pTIFFReadEncodedTile(This->parent->tiff, tile_x + tile_y * This->decode_info.tiles_across, This->cached_tile, This->decode_info.tile_size);
-        }
-        else
-        {
-            ret = pTIFFReadEncodedStrip(This->parent->tiff, tile_y, This->cached_tile, This->decode_info.tile_size);
-        }
-
-        if (ret == -1)
-            hr = E_FAIL;
-    }
-
     /* 8bpp grayscale with extra alpha */
-    if (hr == S_OK && This->decode_info.source_bpp == 16 && This->decode_info.samples == 2 && This->decode_info.bpp == 32)
+    if (hr == S_OK && info->source_bpp == 16 && info->samples == 2 && info->bpp == 32)
     {
         BYTE *src;
-        DWORD *dst, count = This->decode_info.tile_width * This->decode_info.tile_height;
+        DWORD *dst, count = info->tile_width * info->tile_height;
 
-        src = This->cached_tile + This->decode_info.tile_width * This->decode_info.tile_height * 2 - 2;
-        dst = (DWORD *)(This->cached_tile + This->decode_info.tile_size - 4);
+        src = buffer + info->tile_width * info->tile_height * 2 - 2;
+        dst = (DWORD *)(buffer + info->tile_size - 4);
 
         while (count--)
         {
@@ -1007,30 +1112,30 @@ static HRESULT TiffFrameDecode_ReadTile(TiffFrameDecode *This, UINT tile_x, UINT
         }
     }
 
-    if (hr == S_OK && This->decode_info.reverse_bgr)
+    if (hr == S_OK && info->reverse_bgr)
     {
-        if (This->decode_info.bps == 8)
+        if (info->bps == 8)
         {
-            UINT sample_count = This->decode_info.samples;
+            UINT sample_count = info->samples;
 
-            reverse_bgr8(sample_count, This->cached_tile, This->decode_info.tile_width,
-                This->decode_info.tile_height, This->decode_info.tile_width * sample_count);
+            reverse_bgr8(sample_count, buffer, info->tile_width,
+                info->tile_height, info->tile_width * sample_count);
         }
     }
 
-    if (hr == S_OK && swap_bytes && This->decode_info.bps > 8)
+    if (hr == S_OK && swap_bytes && info->bps > 8)
     {
         UINT row, i, samples_per_row;
         BYTE *sample, temp;
 
-        samples_per_row = This->decode_info.tile_width * This->decode_info.samples;
+        samples_per_row = info->tile_width * info->samples;
 
-        switch(This->decode_info.bps)
+        switch(info->bps)
         {
         case 16:
-            for (row=0; row<This->decode_info.tile_height; row++)
+            for (row=0; row<info->tile_height; row++)
             {
-                sample = This->cached_tile + row * This->decode_info.tile_stride;
+                sample = buffer + row * info->tile_stride;
                 for (i=0; i<samples_per_row; i++)
                 {
                     temp = sample[1];
@@ -1041,27 +1146,43 @@ static HRESULT TiffFrameDecode_ReadTile(TiffFrameDecode *This, UINT tile_x, UINT
             }
             break;
         default:
-            ERR("unhandled bps for byte swap %u\n", This->decode_info.bps);
+            ERR("unhandled bps for byte swap %u\n", info->bps);
             return E_FAIL;
         }
     }
 
-    if (hr == S_OK && This->decode_info.invert_grayscale)
+    if (hr == S_OK && info->invert_grayscale)
     {
         BYTE *byte, *end;
 
-        if (This->decode_info.samples != 1)
+        if (info->samples != 1)
         {
-            ERR("cannot invert grayscale image with %u samples\n", This->decode_info.samples);
+            ERR("cannot invert grayscale image with %u samples\n", info->samples);
             return E_FAIL;
         }
 
-        end = This->cached_tile+This->decode_info.tile_size;
+        end = buffer+info->tile_size;
 
-        for (byte = This->cached_tile; byte != end; byte++)
+        for (byte = buffer; byte != end; byte++)
             *byte = ~(*byte);
     }
 
+    return hr;
+}
+
+static HRESULT TiffFrameDecode_ReadTile(TiffFrameDecode *This, UINT tile_x, UINT tile_y)
+{
+    HRESULT hr=S_OK;
+    tsize_t ret;
+
+    ret = pTIFFSetDirectory(This->parent->tiff, This->index);
+
+    if (ret == -1)
+        hr = E_FAIL;
+
+    if (hr == S_OK)
+        hr = tiff_decode_tile(This->parent->tiff, &This->decode_info, tile_x, tile_y, This->cached_tile);
+
     if (hr == S_OK)
     {
         This->cached_tile_x = tile_x;
@@ -1071,15 +1192,195 @@ static HRESULT TiffFrameDecode_ReadTile(TiffFrameDecode *This, UINT tile_x, UINT
     return hr;
 }
 
+/* Copies the part of a decoded tile that intersects prc to the output buffer. */
+static HRESULT tiff_copy_tile(const tiff_decode_info *info, const BYTE *tile, UINT tile_x, UINT tile_y,
+    const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
+{
+    WICRect rc;
+    BYTE *dst_tilepos;
+
+    if (prc->X < tile_x * info->tile_width)
+        rc.X = 0;
+    else
+        rc.X = prc->X - tile_x * info->tile_width;
+
+    if (prc->Y < tile_y * info->tile_height)
+        rc.Y = 0;
+    else
+        rc.Y = prc->Y - tile_y * info->tile_height;
+
+    if (prc->X+prc->Width > (tile_x+1) * info->tile_width)
+        rc.Width = info->tile_width - rc.X;
+    else if (prc->X < tile_x * info->tile_width)
+        rc.Width = prc->Width + prc->X - tile_x * info->tile_width;
+    else
+        rc.Width = prc->Width;
+
+    if (prc->Y+prc->Height > (tile_y+1) * info->tile_height)
+        rc.Height = info->tile_height - rc.Y;
+    else if (prc->Y < tile_y * info->tile_height)
+        rc.Height = prc->Height + prc->Y - tile_y * info->tile_height;
+    else
+        rc.Height = prc->Height;
+
+    dst_tilepos = pbBuffer + (cbStride * ((rc.Y + tile_y * info->tile_height) - prc->Y)) +
+        ((info->bpp * ((rc.X + tile_x * info->tile_width) - prc->X) + 7) / 8);
+
+    return copy_pixels(info->bpp, tile, info->tile_width, info->tile_height, info->tile_stride,
+        &rc, cbStride, cbBufferSize, dst_tilepos);
+}
+
+/* One share of a parallel CopyPixels: every tile_y_step-th row of tiles,
+ * starting at first_tile_y. Whole rows of tiles go to the same job so that
+ * no two jobs write to the same output byte. */
+struct tiff_decode_job
+{
+    const tiff_decode_info *info;
+    struct tiff_worker *worker;
+    const WICRect *prc;
+    UINT cbStride, cbBufferSize;
+    BYTE *pbBuffer;
+    UINT min_tile_x, max_tile_x;
+    UINT first_tile_y, max_tile_y, tile_y_step;
+    HANDLE done;
+    HRESULT hr;
+};
+
+static void tiff_decode_tiles(struct tiff_decode_job *job)
+{
+    UINT tile_x, tile_y;
+    HRESULT hr = S_OK;
+
+    for (tile_y = job->first_tile_y; tile_y <= job->max_tile_y && SUCCEEDED(hr); tile_y += job->tile_y_step)
+    {
+        for (tile_x = job->min_tile_x; tile_x <= job->max_tile_x && SUCCEEDED(hr); tile_x++)
+        {
+            hr = tiff_decode_tile(job->worker->tiff, job->info, tile_x, tile_y, job->worker->tile);
+            if (SUCCEEDED(hr))
+                hr = tiff_copy_tile(job->info, job->worker->tile, tile_x, tile_y,
+                    job->prc, job->cbStride, job->cbBufferSize, job->pbBuffer);
+        }
+    }
+
+    job->hr = hr;
+}
+
+static DWORD CALLBACK tiff_decode_job_proc(void *arg)
+{
+    struct tiff_decode_job *job = arg;
+
+    tiff_decode_tiles(job);
+    SetEvent(job->done);
+    return 0;
+}
+
+/* Makes sure that a worker is positioned on the frame's directory and can
+ * hold a decoded tile. */
+static BOOL tiff_worker_prepare(struct tiff_worker *worker, TiffFrameDecode *frame)
+{
+    if (worker->dir != frame->index)
+    {
+        worker->dir = ~0u;
+        if (!pTIFFSetDirectory(worker->tiff, frame->index)) return FALSE;
+        worker->dir = frame->index;
+    }
+
+    if (worker->tile_size < frame->decode_info.tile_size)
+    {
+        HeapFree(GetProcessHeap(), 0, worker->tile);
+        worker->tile_size = 0;
+        if (!(worker->tile = HeapAlloc(GetProcessHeap(), 0, frame->decode_info.tile_size))) return FALSE;
+        worker->tile_size = frame->decode_info.tile_size;
+    }
+
+    return TRUE;
+}
+
+/* Decodes the tiles intersecting prc on up to one thread per CPU, each with
+ * its own libtiff handle. Returns S_FALSE if the image is too small to be
+ * worth it or the workers can't be set up, and the caller has to decode
+ * the tiles itself. Called with the decoder lock held. */
+static HRESULT TiffFrameDecode_CopyPixelsParallel(TiffFrameDecode *This, const WICRect *prc,
+    UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, UINT min_tile_x, UINT max_tile_x,
+    UINT min_tile_y, UINT max_tile_y)
+{
+    struct tiff_decode_job jobs[TIFF_MAX_WORKERS];
+    TiffDecoder *decoder = This->parent;
+    UINT count, i;
+    SYSTEM_INFO si;
+    HRESULT hr = S_OK;
+
+    if ((ULONGLONG)prc->Width * prc->Height < 256 * 256)
+        return S_FALSE;
+
+    GetSystemInfo(&si);
+    count = min(min(si.dwNumberOfProcessors, max_tile_y - min_tile_y + 1), TIFF_MAX_WORKERS);
+    if (count < 2) return S_FALSE;
+
+    while (decoder->worker_count < count)
+    {
+        struct tiff_worker *worker = tiff_worker_create(decoder);
+        if (!worker) break;
+        decoder->workers[decoder->worker_count++] = worker;
+    }
+
+    for (i = 0; i < count && i < decoder->worker_count; i++)
+        if (!tiff_worker_prepare(decoder->workers[i], This)) break;
+    count = i;
+    if (count < 2) return S_FALSE;
+
+    TRACE("decoding tiles %u-%u,%u-%u with %u workers\n", min_tile_x, max_tile_x, min_tile_y, max_tile_y, count);
+
+    for (i = 0; i < count; i++)
+    {
+        jobs[i].info = &This->decode_info;
+        jobs[i].worker = decoder->workers[i];
+        jobs[i].prc = prc;
+        jobs[i].cbStride = cbStride;
+        jobs[i].cbBufferSize = cbBufferSize;
+        jobs[i].pbBuffer = pbBuffer;
+        jobs[i].min_tile_x = min_tile_x;
+        jobs[i].max_tile_x = max_tile_x;
+        jobs[i].first_tile_y = min_tile_y + i;
+        jobs[i].max_tile_y = max_tile_y;
+        jobs[i].tile_y_step = count;
+        jobs[i].done = NULL;
+        jobs[i].hr = S_OK;
+    }
+
+    for (i = 1; i < count; i++)
+    {
+        if ((jobs[i].done = CreateEventW(NULL, TRUE, FALSE, NULL)) &&
+            QueueUserWorkItem(tiff_decode_job_proc, &jobs[i], WT_EXECUTELONGFUNCTION))
+            continue;
+
+        if (jobs[i].done) CloseHandle(jobs[i].done);
+        jobs[i].done = NULL;
+        tiff_decode_tiles(&jobs[i]);
+    }
+
+    tiff_decode_tiles(&jobs[0]);
+
+    for (i = 0; i < count; i++)
+    {
+        if (jobs[i].done)
+        {
+            WaitForSingleObject(jobs[i].done, INFINITE);
+            CloseHandle(jobs[i].done);
+        }
+        if (FAILED(jobs[i].hr) && SUCCEEDED(hr)) hr = jobs[i].hr;
+    }
+
+    return hr;
+}
+
 static HRESULT WINAPI TiffFrameDecode_CopyPixels(IWICBitmapFrameDecode *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
     TiffFrameDecode *This = impl_from_IWICBitmapFrameDecode(iface);
     UINT min_tile_x, max_tile_x, min_tile_y, max_tile_y;
     UINT tile_x, tile_y;
-    WICRect rc;
     HRESULT hr=S_OK;
-    BYTE *dst_tilepos;
     UINT bytesperrow;
     WICRect rect;
 
@@ -1115,6 +1416,16 @@ static HRESULT WINAPI TiffFrameDecode_CopyPixels(IWICBitmapFrameDecode *iface,
 
     EnterCriticalSection(&This->parent->lock);
 
+    hr = TiffFrameDecode_CopyPixelsParallel(This, prc, cbStride, cbBufferSize, pbBuffer,
+        min_tile_x, max_tile_x, min_tile_y, max_tile_y);
+    if (hr != S_FALSE)
+    {
+        LeaveCriticalSection(&This->parent->lock);
+        TRACE("<-- 0x%x\n", hr);
+        return hr;
+    }
+    hr = S_OK;
+
     for (tile_x=min_tile_x; tile_x <= max_tile_x; tile_x++)
     {
         for (tile_y=min_tile_y; tile_y <= max_tile_y; tile_y++)
@@ -1126,36 +1437,8 @@ static HRESULT WINAPI TiffFrameDecode_CopyPixels(IWICBitmapFrameDecode *iface,
 
             if (SUCCEEDED(hr))
             {
-                if (prc->X < tile_x * This->decode_info.tile_width)
-                    rc.X = 0;
-                else
-                    rc.X = prc->X - tile_x * This->decode_info.tile_width;
-
-                if (prc->Y < tile_y * This->decode_info.tile_height)
-                    rc.Y = 0;
-                else
-                    rc.Y = prc->Y - tile_y * This->decode_info.tile_height;
-
-                if (prc->X+prc->Width > (tile_x+1) * This->decode_info.tile_width)
-                    rc.Width = This->decode_info.tile_width - rc.X;
-                else if (prc->X < tile_x * This->decode_info.tile_width)
-                    rc.Width = prc->Width + prc->X - tile_x * This->decode_info.tile_width;
-                else
-                    rc.Width = prc->Width;
-
-                if (prc->Y+prc->Height > (tile_y+1) * This->decode_info.tile_height)
-                    rc.Height = This->decode_info.tile_height - rc.Y;
-                else if (prc->Y < tile_y * This->decode_info.tile_height)
-                    rc.Height = prc->Height + prc->Y - tile_y * This->decode_info.tile_height;
-                else
-                    rc.Height = prc->Height;
-
-                dst_tilepos = pbBuffer + (cbStride * ((rc.Y + tile_y * This->decode_info.tile_height) - prc->Y)) +
-                    ((This->decode_info.bpp * ((rc.X + tile_x * This->decode_info.tile_width) - prc->X) + 7) / 8);
-
-                hr = copy_pixels(This->decode_info.bpp, This->cached_tile,
-                    This->decode_info.tile_width, This->decode_info.tile_height, This->decode_info.tile_stride,
-                    &rc, cbStride, cbBufferSize, dst_tilepos);
+                hr = tiff_copy_tile(&This->decode_info, This->cached_tile, tile_x, tile_y,
+                    prc, cbStride, cbBufferSize, pbBuffer);
             }
 
             if (FAILED(hr))
@@ -1388,8 +1671,11 @@ HRESULT TiffDecoder_CreateInstance(REFIID iid, void** ppv)
     This->stream = NULL;
     InitializeCriticalSection(&This->lock);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": TiffDecoder.lock");
+    InitializeCriticalSection(&This->io_lock);
+    This->io_lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": TiffDecoder.io_lock");
     This->tiff = NULL;
     This->initialized = FALSE;
+    This->worker_count = 0;
 
     ret = IWICBitmapDecoder_QueryInterface(&This->IWICBitmapDecoder_iface, iid, ppv);
     IWICBitmapDecoder_Release(&This->IWICBitmapDecoder_iface);
@@ -28,6 +28,7 @@
 #include "wined3d_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 
 #define WINED3D_BUFFER_HASDESC      0x01    /* A vertex description has been found. */
 #define WINED3D_BUFFER_USE_BO       0x02    /* Use a buffer object for this buffer. */
@@ -138,52 +139,75 @@ static void wined3d_buffer_gl_bind(struct wined3d_buffer_gl *buffer_gl, struct w
     context_bind_bo(context, buffer_gl->buffer_type_hint, buffer_gl->buffer_object);
 }
 
+/* The stream source state handler might have read the memory of the
+ * vertex buffer already and got the memory in the vbo which is not valid any
+ * longer. Dirtify the stream source to force a reload. This happens only once
+ * per changed vertexbuffer and should occur rather rarely. */
+static void wined3d_buffer_invalidate_bindings(struct wined3d_buffer *buffer)
+{
+    struct wined3d_resource *resource = &buffer->resource;
+
+    if (!resource->bind_count)
+        return;
+
+    if (resource->bind_flags & WINED3D_BIND_VERTEX_BUFFER)
+        device_invalidate_state(resource->device, STATE_STREAMSRC);
+    if (resource->bind_flags & WINED3D_BIND_INDEX_BUFFER)
+        device_invalidate_state(resource->device, STATE_INDEXBUFFER);
+    if (resource->bind_flags & WINED3D_BIND_CONSTANT_BUFFER)
+    {
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_VERTEX));
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_HULL));
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_DOMAIN));
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_GEOMETRY));
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_PIXEL));
+        device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_COMPUTE));
+    }
+}
+
 /* Context activation is done by the caller. */
 static void wined3d_buffer_gl_destroy_buffer_object(struct wined3d_buffer_gl *buffer_gl,
         struct wined3d_context *context)
 {
     struct wined3d_resource *resource = &buffer_gl->b.resource;
     const struct wined3d_gl_info *gl_info = context->gl_info;
+    unsigned int i;
 
     if (!buffer_gl->buffer_object)
         return;
 
-    /* The stream source state handler might have read the memory of the
-     * vertex buffer already and got the memory in the vbo which is not
-     * valid any longer. Dirtify the stream source to force a reload. This
-     * happens only once per changed vertexbuffer and should occur rather
-     * rarely. */
-    if (resource->bind_count)
-    {
-        if (resource->bind_flags & WINED3D_BIND_VERTEX_BUFFER)
-            device_invalidate_state(resource->device, STATE_STREAMSRC);
-        if (resource->bind_flags & WINED3D_BIND_INDEX_BUFFER)
-            device_invalidate_state(resource->device, STATE_INDEXBUFFER);
-        if (resource->bind_flags & WINED3D_BIND_CONSTANT_BUFFER)
+    wined3d_buffer_invalidate_bindings(&buffer_gl->b);
+    if (resource->bind_count && resource->bind_flags & WINED3D_BIND_STREAM_OUTPUT)
+    {
+        device_invalidate_state(resource->device, STATE_STREAM_OUTPUT);
+        if (context->transform_feedback_active)
         {
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_VERTEX));
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_HULL));
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_DOMAIN));
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_GEOMETRY));
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_PIXEL));
-            device_invalidate_state(resource->device, STATE_CONSTANT_BUFFER(WINED3D_SHADER_TYPE_COMPUTE));
+            /* We have to make sure that transform feedback is not active
+             * when deleting a potentially bound transform feedback buffer.
+             * This may happen when the device is being destroyed. */
+            WARN("Deleting buffer object for buffer %p, disabling transform feedback.\n", buffer_gl);
+            context_end_transform_feedback(context);
         }
-        if (resource->bind_flags & WINED3D_BIND_STREAM_OUTPUT)
+    }
+
+    if (buffer_gl->storage_count)
+    {
+        InterlockedExchange(&buffer_gl->client_storage_count, 0);
+        for (i = 0; i < buffer_gl->storage_count; ++i)
         {
-            device_invalidate_state(resource->device, STATE_STREAM_OUTPUT);
-            if (context->transform_feedback_active)
-            {
-                /* We have to make sure that transform feedback is not active
-                 * when deleting a potentially bound transform feedback buffer.
-                 * This may happen when the device is being destroyed. */
-                WARN("Deleting buffer object for buffer %p, disabling transform feedback.\n", buffer_gl);
-                context_end_transform_feedback(context);
-            }
+            GL_EXTCALL(glDeleteBuffers(1, &buffer_gl->storage[i].id));
+            wined3d_fence_destroy(buffer_gl->storage[i].fence);
         }
+        checkGLcall("glDeleteBuffers");
     }
-
-    GL_EXTCALL(glDeleteBuffers(1, &buffer_gl->buffer_object));
-    checkGLcall("glDeleteBuffers");
+    else
+    {
+        GL_EXTCALL(glDeleteBuffers(1, &buffer_gl->buffer_object));
+        checkGLcall("glDeleteBuffers");
+    }
+    heap_free(buffer_gl->storage);
+    buffer_gl->storage = NULL;
+    buffer_gl->storage_count = 0;
     buffer_gl->buffer_object = 0;
 
     if (buffer_gl->b.fence)
@@ -194,6 +218,172 @@ static void wined3d_buffer_gl_destroy_buffer_object(struct wined3d_buffer_gl *bu
     buffer_gl->b.flags &= ~WINED3D_BUFFER_APPLESYNC;
 }
 
+/* Dynamic, write-only vertex and index buffers that never need conversion
+ * are streamed through a small ring of persistently mapped buffer objects.
+ * Applications write into the mapping directly, and DISCARD maps rename the
+ * buffer to a storage the GPU is done with instead of synchronising. */
+static BOOL wined3d_buffer_gl_use_persistent_storage(const struct wined3d_buffer_gl *buffer_gl,
+        const struct wined3d_context *context)
+{
+    const struct wined3d_resource *resource = &buffer_gl->b.resource;
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+
+    /* Persistent mappings stay around for the lifetime of the buffer, which
+     * would exhaust the address space of 32-bit processes. */
+    if (sizeof(void *) < sizeof(UINT64))
+        return FALSE;
+    if (!gl_info->supported[ARB_BUFFER_STORAGE] || !gl_info->supported[ARB_SYNC])
+        return FALSE;
+    if (!(resource->usage & WINED3DUSAGE_DYNAMIC) || !(resource->access & WINED3D_RESOURCE_ACCESS_MAP_W))
+        return FALSE;
+    if (buffer_gl->b.flags & WINED3D_BUFFER_PIN_SYSMEM
+            || cxgames_hacks.allow_glmapbuffer == WINED3D_MAPBUF_NEVER)
+        return FALSE;
+    if (resource->bind_flags & ~(WINED3D_BIND_VERTEX_BUFFER | WINED3D_BIND_INDEX_BUFFER))
+        return FALSE;
+    /* Vertex buffers that may need fixups are converted in place, which
+     * doesn't mix with handing out the buffer object memory. */
+    if (resource->bind_flags & WINED3D_BIND_VERTEX_BUFFER && (!context->d3d_info->xyzrhw
+            || (!gl_info->supported[ARB_VERTEX_ARRAY_BGRA] && !context->d3d_info->ffp_generic_attributes)))
+        return FALSE;
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static BOOL wined3d_buffer_gl_add_storage(struct wined3d_buffer_gl *buffer_gl, struct wined3d_context *context)
+{
+    static const GLbitfield map_flags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT
+            | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+    struct wined3d_buffer_gl_storage *storage;
+    unsigned int count = buffer_gl->storage_count;
+    GLenum error;
+
+    storage = &buffer_gl->storage[count];
+    memset(storage, 0, sizeof(*storage));
+
+    if (FAILED(wined3d_fence_create(buffer_gl->b.resource.device, &storage->fence)))
+        return FALSE;
+
+    while (gl_info->gl_ops.gl.p_glGetError() != GL_NO_ERROR);
+
+    GL_EXTCALL(glGenBuffers(1, &storage->id));
+    context_bind_bo(context, buffer_gl->buffer_type_hint, storage->id);
+    GL_EXTCALL(glBufferStorage(buffer_gl->buffer_type_hint, buffer_gl->b.resource.size, NULL,
+            map_flags | GL_DYNAMIC_STORAGE_BIT));
+    storage->map_ptr = GL_EXTCALL(glMapBufferRange(buffer_gl->buffer_type_hint,
+            0, buffer_gl->b.resource.size, map_flags));
+    if ((error = gl_info->gl_ops.gl.p_glGetError()) != GL_NO_ERROR || !storage->map_ptr
+            || ((DWORD_PTR)storage->map_ptr) & (RESOURCE_ALIGNMENT - 1))
+    {
+        WARN("Failed to create persistent storage, error %s (%#x), pointer %p.\n",
+                debug_glerror(error), error, storage->map_ptr);
+        GL_EXTCALL(glDeleteBuffers(1, &storage->id));
+        wined3d_fence_destroy(storage->fence);
+        memset(storage, 0, sizeof(*storage));
+        return FALSE;
+    }
+
+    TRACE("Created persistent storage %u (%p) for buffer %p.\n", storage->id, storage->map_ptr, buffer_gl);
+    ++buffer_gl->storage_count;
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+static void wined3d_buffer_gl_switch_storage(struct wined3d_buffer_gl *buffer_gl,
+        struct wined3d_context *context, unsigned int storage_idx)
+{
+    struct wined3d_buffer_gl_storage *storage = &buffer_gl->storage[buffer_gl->storage_idx];
+
+    TRACE("buffer_gl %p, storage %u -> %u.\n", buffer_gl, buffer_gl->storage_idx, storage_idx);
+
+    wined3d_fence_issue(storage->fence, buffer_gl->b.resource.device);
+    storage->fenced = TRUE;
+
+    buffer_gl->storage_idx = storage_idx;
+    buffer_gl->buffer_object = buffer_gl->storage[storage_idx].id;
+    wined3d_buffer_invalidate_bindings(&buffer_gl->b);
+
+    /* The new storage is the only up to date location, the application is
+     * going to overwrite it. */
+    wined3d_buffer_validate_location(&buffer_gl->b, WINED3D_LOCATION_BUFFER);
+    wined3d_buffer_invalidate_location(&buffer_gl->b, ~WINED3D_LOCATION_BUFFER);
+}
+
+/* Hand storages the GPU is done with back to the application thread. */
+static void wined3d_buffer_gl_poll_storage(struct wined3d_buffer_gl *buffer_gl)
+{
+    struct wined3d_device *device = buffer_gl->b.resource.device;
+    struct wined3d_buffer_gl_storage *storage;
+    unsigned int i;
+
+    for (i = 0; i < buffer_gl->storage_count; ++i)
+    {
+        storage = &buffer_gl->storage[i];
+        if (!storage->fenced || wined3d_fence_test(storage->fence, device, 0) == WINED3D_FENCE_WAITING)
+            continue;
+        storage->fenced = FALSE;
+        InterlockedExchange(&storage->busy, 0);
+    }
+}
+
+/* Find a storage for a DISCARD map from the CS thread. The application
+ * thread is waiting for us, so the storage state is stable. */
+static unsigned int wined3d_buffer_gl_acquire_storage(struct wined3d_buffer_gl *buffer_gl,
+        struct wined3d_context *context)
+{
+    struct wined3d_device *device = buffer_gl->b.resource.device;
+    unsigned int i, idx, count;
+
+    wined3d_buffer_gl_poll_storage(buffer_gl);
+
+    count = buffer_gl->storage_count;
+    for (i = 1; i < count; ++i)
+    {
+        idx = (buffer_gl->storage_idx + i) % count;
+        if (!buffer_gl->storage[idx].busy)
+            return idx;
+    }
+
+    if (count < WINED3D_BUFFER_GL_STORAGE_COUNT && wined3d_buffer_gl_add_storage(buffer_gl, context))
+        return count;
+
+    TRACE_(d3d_perf)("Waiting for persistent storage of buffer %p.\n", buffer_gl);
+
+    idx = (buffer_gl->storage_idx + 1) % count;
+    if (idx == buffer_gl->storage_idx)
+        wined3d_fence_issue(buffer_gl->storage[idx].fence, device);
+    wined3d_fence_wait(buffer_gl->storage[idx].fence, device);
+    buffer_gl->storage[idx].fenced = FALSE;
+    InterlockedExchange(&buffer_gl->storage[idx].busy, 0);
+
+    return idx;
+}
+
+/* Context activation is done by the caller. */
+static BOOL wined3d_buffer_gl_create_persistent_storage(struct wined3d_buffer_gl *buffer_gl,
+        struct wined3d_context *context)
+{
+    if (!(buffer_gl->storage = heap_calloc(WINED3D_BUFFER_GL_STORAGE_COUNT, sizeof(*buffer_gl->storage))))
+        return FALSE;
+
+    buffer_gl->storage_idx = buffer_gl->client_storage_idx = 0;
+    if (!wined3d_buffer_gl_add_storage(buffer_gl, context))
+    {
+        heap_free(buffer_gl->storage);
+        buffer_gl->storage = NULL;
+        return FALSE;
+    }
+
+    buffer_gl->buffer_object = buffer_gl->storage[0].id;
+    buffer_gl->buffer_object_usage = GL_STREAM_DRAW;
+    buffer_invalidate_bo_range(&buffer_gl->b, 0, 0);
+
+    return TRUE;
+}
+
 /* Context activation is done by the caller. */
 static BOOL wined3d_buffer_gl_create_buffer_object(struct wined3d_buffer_gl *buffer_gl, struct wined3d_context *context)
 {
@@ -201,6 +391,13 @@ static BOOL wined3d_buffer_gl_create_buffer_object(struct wined3d_buffer_gl *buf
     GLenum gl_usage = GL_STATIC_DRAW;
     GLenum error;
 
+    if (wined3d_buffer_gl_use_persistent_storage(buffer_gl, context)
+            && wined3d_buffer_gl_create_persistent_storage(buffer_gl, context))
+    {
+        TRACE("Using persistent storage for wined3d buffer %p.\n", buffer_gl);
+        return TRUE;
+    }
+
     TRACE("Creating an OpenGL buffer object for wined3d buffer %p with usage %s.\n",
             buffer_gl, debug_d3dusage(buffer_gl->b.resource.usage));
 
@@ -1024,6 +1221,49 @@ static HRESULT wined3d_buffer_gl_map(struct wined3d_buffer_gl *buffer_gl,
 
     count = ++buffer_gl->b.resource.map_count;
 
+    if (buffer_gl->storage_count)
+    {
+        struct wined3d_buffer_gl_storage *storage;
+        unsigned int storage_idx;
+
+        context = context_acquire(device, NULL, 0);
+
+        if (count == 1)
+        {
+            if (flags & WINED3D_MAP_DISCARD)
+            {
+                if ((storage_idx = wined3d_buffer_gl_acquire_storage(buffer_gl, context)) != buffer_gl->storage_idx)
+                {
+                    InterlockedExchange(&buffer_gl->storage[buffer_gl->storage_idx].busy, 1);
+                    wined3d_buffer_gl_switch_storage(buffer_gl, context, storage_idx);
+                    buffer_gl->client_storage_idx = storage_idx;
+                }
+            }
+            else
+            {
+                wined3d_buffer_load_location(&buffer_gl->b, context, WINED3D_LOCATION_BUFFER);
+
+                if (!(flags & WINED3D_MAP_NOOVERWRITE))
+                {
+                    storage = &buffer_gl->storage[buffer_gl->storage_idx];
+                    wined3d_fence_issue(storage->fence, device);
+                    wined3d_fence_wait(storage->fence, device);
+                }
+            }
+        }
+
+        if (flags & WINED3D_MAP_WRITE)
+            wined3d_buffer_invalidate_location(&buffer_gl->b, ~WINED3D_LOCATION_BUFFER);
+        InterlockedExchange(&buffer_gl->client_storage_count, buffer_gl->storage_count);
+
+        context_release(context);
+
+        *data = buffer_gl->storage[buffer_gl->storage_idx].map_ptr + offset;
+        TRACE("Returning persistent storage memory at %p.\n", *data);
+
+        return WINED3D_OK;
+    }
+
     if (buffer_gl->buffer_object)
     {
         unsigned int dirty_offset = offset, dirty_size = size;
@@ -1166,6 +1406,10 @@ static void wined3d_buffer_gl_unmap(struct wined3d_buffer_gl *buffer_gl)
         return;
     }
 
+    /* Persistent storage is coherent, there's nothing to flush. */
+    if (buffer_gl->storage_count)
+        return;
+
     if (buffer_gl->b.map_ptr)
     {
         struct wined3d_device *device = buffer_gl->b.resource.device;
@@ -1204,6 +1448,85 @@ static void wined3d_buffer_gl_unmap(struct wined3d_buffer_gl *buffer_gl)
     }
 }
 
+/* Map a buffer with persistent storage directly from the application thread,
+ * without waiting for the CS. Only unsynchronised maps are handled here; a
+ * DISCARD map renames the buffer to a storage the GPU is done with. The CS
+ * switches to that storage when the unmap reaches it. */
+BOOL wined3d_buffer_map_persistent(struct wined3d_buffer *buffer, struct wined3d_map_desc *map_desc,
+        const struct wined3d_box *box, DWORD flags)
+{
+    struct wined3d_buffer_gl *buffer_gl = wined3d_buffer_gl(buffer);
+    unsigned int i, idx, count;
+
+    if (!(count = InterlockedCompareExchange(&buffer_gl->client_storage_count, 0, 0)))
+        return FALSE;
+
+    if (!buffer_gl->client_map_count)
+    {
+        if (buffer->resource.map_count || (flags & WINED3D_MAP_READ)
+                || !(flags & (WINED3D_MAP_DISCARD | WINED3D_MAP_NOOVERWRITE)))
+            return FALSE;
+
+        if (flags & WINED3D_MAP_DISCARD)
+        {
+            for (i = 1; i < count; ++i)
+            {
+                idx = (buffer_gl->client_storage_idx + i) % count;
+                if (!InterlockedCompareExchange(&buffer_gl->storage[idx].busy, 0, 0))
+                    break;
+            }
+            if (i >= count)
+            {
+                TRACE_(d3d_perf)("No idle persistent storage for buffer %p.\n", buffer);
+                return FALSE;
+            }
+
+            InterlockedExchange(&buffer_gl->storage[buffer_gl->client_storage_idx].busy, 1);
+            buffer_gl->client_storage_idx = idx;
+        }
+    }
+
+    ++buffer_gl->client_map_count;
+
+    map_desc->row_pitch = map_desc->slice_pitch = buffer->resource.size;
+    map_desc->data = buffer_gl->storage[buffer_gl->client_storage_idx].map_ptr + (box ? box->left : 0);
+    TRACE("Returning persistent storage memory at %p.\n", map_desc->data);
+
+    return TRUE;
+}
+
+BOOL wined3d_buffer_unmap_persistent(struct wined3d_buffer *buffer)
+{
+    struct wined3d_buffer_gl *buffer_gl = wined3d_buffer_gl(buffer);
+
+    if (!buffer_gl->client_map_count)
+        return FALSE;
+
+    if (!--buffer_gl->client_map_count)
+        wined3d_cs_emit_unmap_persistent(buffer->resource.device->cs, buffer, buffer_gl->client_storage_idx);
+
+    return TRUE;
+}
+
+/* Context activation is done by the caller. */
+void wined3d_buffer_commit_persistent(struct wined3d_buffer *buffer, struct wined3d_context *context,
+        unsigned int storage_idx)
+{
+    struct wined3d_buffer_gl *buffer_gl = wined3d_buffer_gl(buffer);
+
+    /* The buffer object may have been unloaded in the meantime. */
+    if (!buffer_gl->storage_count)
+        return;
+
+    if (storage_idx != buffer_gl->storage_idx)
+        wined3d_buffer_gl_switch_storage(buffer_gl, context, storage_idx);
+    else
+        wined3d_buffer_invalidate_location(buffer, ~WINED3D_LOCATION_BUFFER);
+
+    wined3d_buffer_gl_poll_storage(buffer_gl);
+    InterlockedExchange(&buffer_gl->client_storage_count, buffer_gl->storage_count);
+}
+
 void wined3d_buffer_copy(struct wined3d_buffer *dst_buffer, unsigned int dst_offset,
         struct wined3d_buffer *src_buffer, unsigned int src_offset, unsigned int size)
 {
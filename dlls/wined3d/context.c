@@ -2295,6 +2295,9 @@ BOOL wined3d_adapter_gl_create_context(struct wined3d_context *context,
     }
     if (gl_info->supported[ARB_CLIP_CONTROL])
         GL_EXTCALL(glPointParameteri(GL_POINT_SPRITE_COORD_ORIGIN, GL_LOWER_LEFT));
+    if (wined3d_settings.async_shader_compile != WINED3D_ASYNC_SHADER_DISABLED
+            && gl_info->supported[ARB_PARALLEL_SHADER_COMPILE])
+        GL_EXTCALL(glMaxShaderCompilerThreadsARB(~0u));
 
     /* If this happens to be the first context for the device, dummy textures
      * are not created yet. In that case, they will be created (and bound) by
@@ -4029,6 +4032,9 @@ static BOOL context_apply_draw_state(struct wined3d_context *context,
         device->shader_backend->shader_select(device->shader_priv, context, state);
         context->shader_update_mask &= 1u << WINED3D_SHADER_TYPE_COMPUTE;
     }
+    /* Keep selecting shaders until the program is ready. */
+    if (context->shader_program_pending)
+        context->shader_update_mask |= (1u << WINED3D_SHADER_TYPE_GRAPHICS_COUNT) - 1;
 
     if (context->constant_update_mask)
     {
@@ -4915,6 +4921,29 @@ void draw_primitive(struct wined3d_device *device, const struct wined3d_state *s
         return;
     }
 
+    /* With "wait", the link runs while the rest of the draw state is
+     * applied, and only the draw itself waits for it. */
+    if (context->shader_program_pending && wined3d_settings.async_shader_compile == WINED3D_ASYNC_SHADER_WAIT)
+    {
+        context->shader_program_wait = 1;
+        device->shader_backend->shader_select(device->shader_priv, context, state);
+        context->shader_program_wait = 0;
+        context->shader_update_mask &= 1u << WINED3D_SHADER_TYPE_COMPUTE;
+        if (context->constant_update_mask)
+        {
+            device->shader_backend->shader_load_constants(device->shader_priv, context, state);
+            context->constant_update_mask = 0;
+        }
+    }
+
+    if (context->shader_program_pending)
+    {
+        ++device->shader_compile_stats.skipped_draws;
+        context_release(context);
+        TRACE("Shader program not ready, skipping draw.\n");
+        return;
+    }
+
     if (dsv && state->render_states[WINED3D_RS_ZWRITEENABLE])
     {
         DWORD location = context->render_offscreen ? dsv->resource->draw_binding : WINED3D_LOCATION_DRAWABLE;
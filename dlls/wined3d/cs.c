@@ -21,8 +21,11 @@
 #include "wined3d_private.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_cs);
+WINE_DECLARE_DEBUG_CHANNEL(d3d_perf);
 
 #define WINED3D_INITIAL_CS_SIZE 4096
+#define WINED3D_CS_DEFERRED_SCRATCH_SIZE 4096
 
 enum wined3d_cs_op
 {
@@ -67,12 +70,14 @@ enum wined3d_cs_op
     WINED3D_CS_OP_UNLOAD_RESOURCE,
     WINED3D_CS_OP_MAP,
     WINED3D_CS_OP_UNMAP,
+    WINED3D_CS_OP_UNMAP_PERSISTENT,
     WINED3D_CS_OP_BLT_SUB_RESOURCE,
     WINED3D_CS_OP_UPDATE_SUB_RESOURCE,
     WINED3D_CS_OP_ADD_DIRTY_TEXTURE_REGION,
     WINED3D_CS_OP_CLEAR_UNORDERED_ACCESS_VIEW,
     WINED3D_CS_OP_COPY_UAV_COUNTER,
     WINED3D_CS_OP_GENERATE_MIPMAPS,
+    WINED3D_CS_OP_EXECUTE_COMMAND_LIST,
     WINED3D_CS_OP_STOP,
 };
 
@@ -103,7 +108,7 @@ struct wined3d_cs_clear
     enum wined3d_cs_op opcode;
     DWORD flags;
     unsigned int rt_count;
-    struct wined3d_fb_state *fb;
+    struct wined3d_fb_state fb;
     RECT draw_rect;
     struct wined3d_color color;
     float depth;
@@ -388,6 +393,13 @@ struct wined3d_cs_unmap
     HRESULT *hr;
 };
 
+struct wined3d_cs_unmap_persistent
+{
+    enum wined3d_cs_op opcode;
+    struct wined3d_buffer *buffer;
+    unsigned int storage_idx;
+};
+
 struct wined3d_cs_blt_sub_resource
 {
     enum wined3d_cs_op opcode;
@@ -439,6 +451,12 @@ struct wined3d_cs_generate_mipmaps
     struct wined3d_shader_resource_view *view;
 };
 
+struct wined3d_cs_execute_command_list
+{
+    enum wined3d_cs_op opcode;
+    struct wined3d_command_list *list;
+};
+
 struct wined3d_cs_stop
 {
     enum wined3d_cs_op opcode;
@@ -455,6 +473,36 @@ static inline void wined3d_cs_submit(struct wined3d_cs *cs, enum wined3d_cs_queu
     cs->ops->submit(cs, queue_id);
 }
 
+/* The application side state that commands are emitted against. Recording
+ * command streams track their own copy in "cs->state". */
+static inline const struct wined3d_state *wined3d_cs_get_state(const struct wined3d_cs *cs)
+{
+    return cs->list ? &cs->state : &cs->device->state;
+}
+
+static void wined3d_cs_acquire_resource(struct wined3d_cs *cs, struct wined3d_resource *resource)
+{
+    struct wined3d_command_list *list;
+
+    if (!(list = cs->list))
+    {
+        wined3d_resource_acquire(resource);
+        return;
+    }
+
+    /* The resource is acquired when the command list is executed. */
+    if (!wined3d_array_reserve((void **)&list->resources, &list->resources_size,
+            list->resource_count + 1, sizeof(*list->resources)))
+    {
+        ERR("Failed to record resource %p.\n", resource);
+        list->failed = TRUE;
+        return;
+    }
+
+    wined3d_resource_incref(resource);
+    list->resources[list->resource_count++] = resource;
+}
+
 static const char *debug_cs_op(enum wined3d_cs_op op)
 {
     switch (op)
@@ -501,12 +549,14 @@ static const char *debug_cs_op(enum wined3d_cs_op op)
         WINED3D_TO_STR(WINED3D_CS_OP_UNLOAD_RESOURCE);
         WINED3D_TO_STR(WINED3D_CS_OP_MAP);
         WINED3D_TO_STR(WINED3D_CS_OP_UNMAP);
+        WINED3D_TO_STR(WINED3D_CS_OP_UNMAP_PERSISTENT);
         WINED3D_TO_STR(WINED3D_CS_OP_BLT_SUB_RESOURCE);
         WINED3D_TO_STR(WINED3D_CS_OP_UPDATE_SUB_RESOURCE);
         WINED3D_TO_STR(WINED3D_CS_OP_ADD_DIRTY_TEXTURE_REGION);
         WINED3D_TO_STR(WINED3D_CS_OP_CLEAR_UNORDERED_ACCESS_VIEW);
         WINED3D_TO_STR(WINED3D_CS_OP_COPY_UAV_COUNTER);
         WINED3D_TO_STR(WINED3D_CS_OP_GENERATE_MIPMAPS);
+        WINED3D_TO_STR(WINED3D_CS_OP_EXECUTE_COMMAND_LIST);
         WINED3D_TO_STR(WINED3D_CS_OP_STOP);
 #undef WINED3D_TO_STR
         default:
@@ -520,6 +570,7 @@ static void wined3d_cs_exec_nop(struct wined3d_cs *cs, const void *data)
 
 static void wined3d_cs_exec_present(struct wined3d_cs *cs, const void *data)
 {
+    struct wined3d_shader_compile_stats *stats = &cs->device->shader_compile_stats;
     const struct wined3d_cs_present *op = data;
     struct wined3d_swapchain *swapchain;
     unsigned int i;
@@ -536,6 +587,12 @@ static void wined3d_cs_exec_present(struct wined3d_cs *cs, const void *data)
         wined3d_resource_release(&swapchain->back_buffers[i]->resource);
     }
 
+    if (stats->pending || stats->completed || stats->skipped_draws)
+        TRACE_(d3d_perf)("Shader programs: %u pending, %u completed, %u draws skipped.\n",
+                stats->pending, stats->completed, stats->skipped_draws);
+    stats->completed = 0;
+    stats->skipped_draws = 0;
+
     InterlockedDecrement(&cs->pending_presents);
 }
 
@@ -558,10 +615,10 @@ void wined3d_cs_emit_present(struct wined3d_cs *cs, struct wined3d_swapchain *sw
 
     pending = InterlockedIncrement(&cs->pending_presents);
 
-    wined3d_resource_acquire(&swapchain->front_buffer->resource);
+    wined3d_cs_acquire_resource(cs, &swapchain->front_buffer->resource);
     for (i = 0; i < swapchain->desc.backbuffer_count; ++i)
     {
-        wined3d_resource_acquire(&swapchain->back_buffers[i]->resource);
+        wined3d_cs_acquire_resource(cs, &swapchain->back_buffers[i]->resource);
     }
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
@@ -578,29 +635,30 @@ void wined3d_cs_emit_present(struct wined3d_cs *cs, struct wined3d_swapchain *sw
 static void wined3d_cs_exec_clear(struct wined3d_cs *cs, const void *data)
 {
     const struct wined3d_cs_clear *op = data;
+    const struct wined3d_fb_state *fb = &op->fb;
     struct wined3d_device *device;
     unsigned int i;
 
     device = cs->device;
-    device->blitter->ops->blitter_clear(device->blitter, device, op->rt_count, op->fb,
+    device->blitter->ops->blitter_clear(device->blitter, device, op->rt_count, fb,
             op->rect_count, op->rects, &op->draw_rect, op->flags, &op->color, op->depth, op->stencil);
 
     if (op->flags & WINED3DCLEAR_TARGET)
     {
         for (i = 0; i < op->rt_count; ++i)
         {
-            if (op->fb->render_targets[i])
-                wined3d_resource_release(op->fb->render_targets[i]->resource);
+            if (fb->render_targets[i])
+                wined3d_resource_release(fb->render_targets[i]->resource);
         }
     }
     if (op->flags & (WINED3DCLEAR_ZBUFFER | WINED3DCLEAR_STENCIL))
-        wined3d_resource_release(op->fb->depth_stencil->resource);
+        wined3d_resource_release(fb->depth_stencil->resource);
 }
 
 void wined3d_cs_emit_clear(struct wined3d_cs *cs, DWORD rect_count, const RECT *rects,
         DWORD flags, const struct wined3d_color *color, float depth, DWORD stencil)
 {
-    const struct wined3d_state *state = &cs->device->state;
+    const struct wined3d_state *state = wined3d_cs_get_state(cs);
     const struct wined3d_viewport *vp = &state->viewports[0];
     struct wined3d_rendertarget_view *view;
     struct wined3d_cs_clear *op;
@@ -613,7 +671,7 @@ void wined3d_cs_emit_clear(struct wined3d_cs *cs, DWORD rect_count, const RECT *
     op->opcode = WINED3D_CS_OP_CLEAR;
     op->flags = flags & (WINED3DCLEAR_TARGET | WINED3DCLEAR_ZBUFFER | WINED3DCLEAR_STENCIL);
     op->rt_count = rt_count;
-    op->fb = &cs->fb;
+    op->fb = *state->fb;
     SetRect(&op->draw_rect, vp->x, vp->y, vp->x + vp->width, vp->y + vp->height);
     if (state->render_states[WINED3D_RS_SCISSORTESTENABLE])
         IntersectRect(&op->draw_rect, &op->draw_rect, &state->scissor_rects[0]);
@@ -626,12 +684,12 @@ void wined3d_cs_emit_clear(struct wined3d_cs *cs, DWORD rect_count, const RECT *
     for (i = 0; i < rt_count; ++i)
     {
         if ((view = state->fb->render_targets[i]))
-            wined3d_resource_acquire(view->resource);
+            wined3d_cs_acquire_resource(cs, view->resource);
     }
     if (flags & (WINED3DCLEAR_ZBUFFER | WINED3DCLEAR_STENCIL))
     {
         view = state->fb->depth_stencil;
-        wined3d_resource_acquire(view->resource);
+        wined3d_cs_acquire_resource(cs, view->resource);
     }
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
@@ -641,26 +699,23 @@ void wined3d_cs_emit_clear_rendertarget_view(struct wined3d_cs *cs, struct wined
         const RECT *rect, DWORD flags, const struct wined3d_color *color, float depth, DWORD stencil)
 {
     struct wined3d_cs_clear *op;
-    size_t size;
 
-    size = FIELD_OFFSET(struct wined3d_cs_clear, rects[1]) + sizeof(struct wined3d_fb_state);
-    op = wined3d_cs_require_space(cs, size, WINED3D_CS_QUEUE_DEFAULT);
-    op->fb = (void *)&op->rects[1];
+    op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
 
     op->opcode = WINED3D_CS_OP_CLEAR;
     op->flags = flags & (WINED3DCLEAR_TARGET | WINED3DCLEAR_ZBUFFER | WINED3DCLEAR_STENCIL);
     if (flags & WINED3DCLEAR_TARGET)
     {
         op->rt_count = 1;
-        op->fb->render_targets[0] = view;
-        op->fb->depth_stencil = NULL;
+        op->fb.render_targets[0] = view;
+        op->fb.depth_stencil = NULL;
         op->color = *color;
     }
     else
     {
         op->rt_count = 0;
-        op->fb->render_targets[0] = NULL;
-        op->fb->depth_stencil = view;
+        op->fb.render_targets[0] = NULL;
+        op->fb.depth_stencil = view;
         op->depth = depth;
         op->stencil = stencil;
     }
@@ -668,14 +723,15 @@ void wined3d_cs_emit_clear_rendertarget_view(struct wined3d_cs *cs, struct wined
     op->rect_count = 1;
     op->rects[0] = *rect;
 
-    wined3d_resource_acquire(view->resource);
+    wined3d_cs_acquire_resource(cs, view->resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
     if (flags & WINED3DCLEAR_SYNCHRONOUS)
         wined3d_cs_finish(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
 
-static void acquire_shader_resources(const struct wined3d_state *state, unsigned int shader_mask)
+static void acquire_shader_resources(struct wined3d_cs *cs,
+        const struct wined3d_state *state, unsigned int shader_mask)
 {
     struct wined3d_shader_sampler_map_entry *entry;
     struct wined3d_shader_resource_view *view;
@@ -693,7 +749,7 @@ static void acquire_shader_resources(const struct wined3d_state *state, unsigned
         for (j = 0; j < WINED3D_MAX_CBS; ++j)
         {
             if (state->cb[i][j])
-                wined3d_resource_acquire(&state->cb[i][j]->resource);
+                wined3d_cs_acquire_resource(cs, &state->cb[i][j]->resource);
         }
 
         for (j = 0; j < shader->reg_maps.sampler_map.count; ++j)
@@ -703,7 +759,7 @@ static void acquire_shader_resources(const struct wined3d_state *state, unsigned
             if (!(view = state->shader_resource_view[i][entry->resource_idx]))
                 continue;
 
-            wined3d_resource_acquire(view->resource);
+            wined3d_cs_acquire_resource(cs, view->resource);
         }
     }
 }
@@ -741,7 +797,7 @@ static void release_shader_resources(const struct wined3d_state *state, unsigned
     }
 }
 
-static void acquire_unordered_access_resources(const struct wined3d_shader *shader,
+static void acquire_unordered_access_resources(struct wined3d_cs *cs, const struct wined3d_shader *shader,
         struct wined3d_unordered_access_view * const *views)
 {
     unsigned int i;
@@ -757,7 +813,7 @@ static void acquire_unordered_access_resources(const struct wined3d_shader *shad
         if (!views[i])
             continue;
 
-        wined3d_resource_acquire(views[i]->resource);
+        wined3d_cs_acquire_resource(cs, views[i]->resource);
     }
 }
 
@@ -796,17 +852,17 @@ static void wined3d_cs_exec_dispatch(struct wined3d_cs *cs, const void *data)
             state->unordered_access_view[WINED3D_PIPELINE_COMPUTE]);
 }
 
-static void acquire_compute_pipeline_resources(const struct wined3d_state *state)
+static void acquire_compute_pipeline_resources(struct wined3d_cs *cs, const struct wined3d_state *state)
 {
-    acquire_shader_resources(state, 1u << WINED3D_SHADER_TYPE_COMPUTE);
-    acquire_unordered_access_resources(state->shader[WINED3D_SHADER_TYPE_COMPUTE],
+    acquire_shader_resources(cs, state, 1u << WINED3D_SHADER_TYPE_COMPUTE);
+    acquire_unordered_access_resources(cs, state->shader[WINED3D_SHADER_TYPE_COMPUTE],
             state->unordered_access_view[WINED3D_PIPELINE_COMPUTE]);
 }
 
 void wined3d_cs_emit_dispatch(struct wined3d_cs *cs,
         unsigned int group_count_x, unsigned int group_count_y, unsigned int group_count_z)
 {
-    const struct wined3d_state *state = &cs->device->state;
+    const struct wined3d_state *state = wined3d_cs_get_state(cs);
     struct wined3d_cs_dispatch *op;
 
     op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
@@ -816,7 +872,7 @@ void wined3d_cs_emit_dispatch(struct wined3d_cs *cs,
     op->parameters.u.direct.group_count_y = group_count_y;
     op->parameters.u.direct.group_count_z = group_count_z;
 
-    acquire_compute_pipeline_resources(state);
+    acquire_compute_pipeline_resources(cs, state);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
@@ -824,7 +880,7 @@ void wined3d_cs_emit_dispatch(struct wined3d_cs *cs,
 void wined3d_cs_emit_dispatch_indirect(struct wined3d_cs *cs,
         struct wined3d_buffer *buffer, unsigned int offset)
 {
-    const struct wined3d_state *state = &cs->device->state;
+    const struct wined3d_state *state = wined3d_cs_get_state(cs);
     struct wined3d_cs_dispatch *op;
 
     op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
@@ -833,8 +889,8 @@ void wined3d_cs_emit_dispatch_indirect(struct wined3d_cs *cs,
     op->parameters.u.indirect.buffer = buffer;
     op->parameters.u.indirect.offset = offset;
 
-    acquire_compute_pipeline_resources(state);
-    wined3d_resource_acquire(&buffer->resource);
+    acquire_compute_pipeline_resources(cs, state);
+    wined3d_cs_acquire_resource(cs, &buffer->resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
@@ -927,37 +983,37 @@ static void wined3d_cs_exec_draw(struct wined3d_cs *cs, const void *data)
             state->unordered_access_view[WINED3D_PIPELINE_GRAPHICS]);
 }
 
-static void acquire_graphics_pipeline_resources(const struct wined3d_state *state,
+static void acquire_graphics_pipeline_resources(struct wined3d_cs *cs, const struct wined3d_state *state,
         BOOL indexed, const struct wined3d_d3d_info *d3d_info)
 {
     unsigned int i;
 
     if (indexed)
-        wined3d_resource_acquire(&state->index_buffer->resource);
+        wined3d_cs_acquire_resource(cs, &state->index_buffer->resource);
     for (i = 0; i < ARRAY_SIZE(state->streams); ++i)
     {
         if (state->streams[i].buffer)
-            wined3d_resource_acquire(&state->streams[i].buffer->resource);
+            wined3d_cs_acquire_resource(cs, &state->streams[i].buffer->resource);
     }
     for (i = 0; i < ARRAY_SIZE(state->stream_output); ++i)
     {
         if (state->stream_output[i].buffer)
-            wined3d_resource_acquire(&state->stream_output[i].buffer->resource);
+            wined3d_cs_acquire_resource(cs, &state->stream_output[i].buffer->resource);
     }
     for (i = 0; i < ARRAY_SIZE(state->textures); ++i)
     {
         if (state->textures[i])
-            wined3d_resource_acquire(&state->textures[i]->resource);
+            wined3d_cs_acquire_resource(cs, &state->textures[i]->resource);
     }
     for (i = 0; i < d3d_info->limits.max_rt_count; ++i)
     {
         if (state->fb->render_targets[i])
-            wined3d_resource_acquire(state->fb->render_targets[i]->resource);
+            wined3d_cs_acquire_resource(cs, state->fb->render_targets[i]->resource);
     }
     if (state->fb->depth_stencil)
-        wined3d_resource_acquire(state->fb->depth_stencil->resource);
-    acquire_shader_resources(state, ~(1u << WINED3D_SHADER_TYPE_COMPUTE));
-    acquire_unordered_access_resources(state->shader[WINED3D_SHADER_TYPE_PIXEL],
+        wined3d_cs_acquire_resource(cs, state->fb->depth_stencil->resource);
+    acquire_shader_resources(cs, state, ~(1u << WINED3D_SHADER_TYPE_COMPUTE));
+    acquire_unordered_access_resources(cs, state->shader[WINED3D_SHADER_TYPE_PIXEL],
             state->unordered_access_view[WINED3D_PIPELINE_GRAPHICS]);
 }
 
@@ -966,7 +1022,7 @@ void wined3d_cs_emit_draw(struct wined3d_cs *cs, GLenum primitive_type, unsigned
         unsigned int start_instance, unsigned int instance_count, BOOL indexed)
 {
     const struct wined3d_d3d_info *d3d_info = &cs->device->adapter->d3d_info;
-    const struct wined3d_state *state = &cs->device->state;
+    const struct wined3d_state *state = wined3d_cs_get_state(cs);
     struct wined3d_cs_draw *op;
 
     op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
@@ -981,7 +1037,7 @@ void wined3d_cs_emit_draw(struct wined3d_cs *cs, GLenum primitive_type, unsigned
     op->parameters.u.direct.instance_count = instance_count;
     op->parameters.indexed = indexed;
 
-    acquire_graphics_pipeline_resources(state, indexed, d3d_info);
+    acquire_graphics_pipeline_resources(cs, state, indexed, d3d_info);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
@@ -990,7 +1046,7 @@ void wined3d_cs_emit_draw_indirect(struct wined3d_cs *cs, GLenum primitive_type,
         struct wined3d_buffer *buffer, unsigned int offset, BOOL indexed)
 {
     const struct wined3d_d3d_info *d3d_info = &cs->device->adapter->d3d_info;
-    const struct wined3d_state *state = &cs->device->state;
+    const struct wined3d_state *state = wined3d_cs_get_state(cs);
     struct wined3d_cs_draw *op;
 
     op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
@@ -1002,8 +1058,8 @@ void wined3d_cs_emit_draw_indirect(struct wined3d_cs *cs, GLenum primitive_type,
     op->parameters.u.indirect.offset = offset;
     op->parameters.indexed = indexed;
 
-    acquire_graphics_pipeline_resources(state, indexed, d3d_info);
-    wined3d_resource_acquire(&buffer->resource);
+    acquire_graphics_pipeline_resources(cs, state, indexed, d3d_info);
+    wined3d_cs_acquire_resource(cs, &buffer->resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
@@ -2080,7 +2136,7 @@ void wined3d_cs_emit_preload_resource(struct wined3d_cs *cs, struct wined3d_reso
     op->opcode = WINED3D_CS_OP_PRELOAD_RESOURCE;
     op->resource = resource;
 
-    wined3d_resource_acquire(resource);
+    wined3d_cs_acquire_resource(cs, resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
@@ -2102,7 +2158,7 @@ void wined3d_cs_emit_unload_resource(struct wined3d_cs *cs, struct wined3d_resou
     op->opcode = WINED3D_CS_OP_UNLOAD_RESOURCE;
     op->resource = resource;
 
-    wined3d_resource_acquire(resource);
+    wined3d_cs_acquire_resource(cs, resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
@@ -2168,6 +2224,37 @@ HRESULT wined3d_cs_unmap(struct wined3d_cs *cs, struct wined3d_resource *resourc
     return hr;
 }
 
+static void wined3d_cs_exec_unmap_persistent(struct wined3d_cs *cs, const void *data)
+{
+    const struct wined3d_cs_unmap_persistent *op = data;
+    struct wined3d_buffer *buffer = op->buffer;
+    struct wined3d_context *context;
+
+    context = context_acquire(cs->device, NULL, 0);
+    wined3d_buffer_commit_persistent(buffer, context, op->storage_idx);
+    context_release(context);
+
+    wined3d_resource_release(&buffer->resource);
+}
+
+/* Unlike wined3d_cs_unmap(), this goes through the default queue and doesn't
+ * wait. The data was written to persistently mapped storage by the
+ * application thread; the CS only needs to start using it. */
+void wined3d_cs_emit_unmap_persistent(struct wined3d_cs *cs, struct wined3d_buffer *buffer,
+        unsigned int storage_idx)
+{
+    struct wined3d_cs_unmap_persistent *op;
+
+    op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
+    op->opcode = WINED3D_CS_OP_UNMAP_PERSISTENT;
+    op->buffer = buffer;
+    op->storage_idx = storage_idx;
+
+    wined3d_cs_acquire_resource(cs, &buffer->resource);
+
+    wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
+}
+
 static void wined3d_cs_exec_blt_sub_resource(struct wined3d_cs *cs, const void *data)
 {
     const struct wined3d_cs_blt_sub_resource *op = data;
@@ -2290,9 +2377,9 @@ void wined3d_cs_emit_blt_sub_resource(struct wined3d_cs *cs, struct wined3d_reso
         memset(&op->fx, 0, sizeof(op->fx));
     op->filter = filter;
 
-    wined3d_resource_acquire(dst_resource);
+    wined3d_cs_acquire_resource(cs, dst_resource);
     if (src_resource)
-        wined3d_resource_acquire(src_resource);
+        wined3d_cs_acquire_resource(cs, src_resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
     if (flags & WINED3D_BLT_SYNCHRONOUS)
@@ -2373,7 +2460,7 @@ void wined3d_cs_emit_update_sub_resource(struct wined3d_cs *cs, struct wined3d_r
     op->data.slice_pitch = slice_pitch;
     op->data.data = data;
 
-    wined3d_resource_acquire(resource);
+    wined3d_cs_acquire_resource(cs, resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_MAP);
     /* The data pointer may go away, so we need to wait until it is read.
@@ -2412,7 +2499,7 @@ void wined3d_cs_emit_add_dirty_texture_region(struct wined3d_cs *cs,
     op->texture = texture;
     op->layer = layer;
 
-    wined3d_resource_acquire(&texture->resource);
+    wined3d_cs_acquire_resource(cs, &texture->resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
@@ -2440,7 +2527,7 @@ void wined3d_cs_emit_clear_unordered_access_view_uint(struct wined3d_cs *cs,
     op->view = view;
     op->clear_value = *clear_value;
 
-    wined3d_resource_acquire(view->resource);
+    wined3d_cs_acquire_resource(cs, view->resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
@@ -2469,7 +2556,7 @@ void wined3d_cs_emit_copy_uav_counter(struct wined3d_cs *cs, struct wined3d_buff
     op->offset = offset;
     op->view = uav;
 
-    wined3d_resource_acquire(&dst_buffer->resource);
+    wined3d_cs_acquire_resource(cs, &dst_buffer->resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
@@ -2491,7 +2578,7 @@ void wined3d_cs_emit_generate_mipmaps(struct wined3d_cs *cs, struct wined3d_shad
     op->opcode = WINED3D_CS_OP_GENERATE_MIPMAPS;
     op->view = view;
 
-    wined3d_resource_acquire(view->resource);
+    wined3d_cs_acquire_resource(cs, view->resource);
 
     wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
@@ -2507,6 +2594,8 @@ static void wined3d_cs_emit_stop(struct wined3d_cs *cs)
     wined3d_cs_finish(cs, WINED3D_CS_QUEUE_DEFAULT);
 }
 
+static void wined3d_cs_exec_execute_command_list(struct wined3d_cs *cs, const void *data);
+
 static void (* const wined3d_cs_op_handlers[])(struct wined3d_cs *cs, const void *data) =
 {
     /* WINED3D_CS_OP_NOP                         */ wined3d_cs_exec_nop,
@@ -2550,12 +2639,14 @@ static void (* const wined3d_cs_op_handlers[])(struct wined3d_cs *cs, const void
     /* WINED3D_CS_OP_UNLOAD_RESOURCE             */ wined3d_cs_exec_unload_resource,
     /* WINED3D_CS_OP_MAP                         */ wined3d_cs_exec_map,
     /* WINED3D_CS_OP_UNMAP                       */ wined3d_cs_exec_unmap,
+    /* WINED3D_CS_OP_UNMAP_PERSISTENT            */ wined3d_cs_exec_unmap_persistent,
     /* WINED3D_CS_OP_BLT_SUB_RESOURCE            */ wined3d_cs_exec_blt_sub_resource,
     /* WINED3D_CS_OP_UPDATE_SUB_RESOURCE         */ wined3d_cs_exec_update_sub_resource,
     /* WINED3D_CS_OP_ADD_DIRTY_TEXTURE_REGION    */ wined3d_cs_exec_add_dirty_texture_region,
     /* WINED3D_CS_OP_CLEAR_UNORDERED_ACCESS_VIEW */ wined3d_cs_exec_clear_unordered_access_view,
     /* WINED3D_CS_OP_COPY_UAV_COUNTER            */ wined3d_cs_exec_copy_uav_counter,
     /* WINED3D_CS_OP_GENERATE_MIPMAPS            */ wined3d_cs_exec_generate_mipmaps,
+    /* WINED3D_CS_OP_EXECUTE_COMMAND_LIST        */ wined3d_cs_exec_execute_command_list,
 };
 
 static void *wined3d_cs_st_require_space(struct wined3d_cs *cs, size_t size, enum wined3d_cs_queue_id queue_id)
@@ -2617,6 +2708,58 @@ static const struct wined3d_cs_ops wined3d_cs_st_ops =
     wined3d_cs_st_push_constants,
 };
 
+/* Process wide command stream counters, only collected when the "d3d_cs"
+ * debug channel is enabled. Times are in performance counter ticks. */
+static struct
+{
+    LONG64 packet_count;
+    LONG64 queue_depth_total;
+    LONG64 queue_depth_max;
+    LONG64 finish_count;
+    LONG64 finish_ticks;
+    LONG64 finish_ticks_max;
+    LONG64 spin_ticks;
+    LONG64 wait_count;
+} wined3d_cs_stats;
+
+static void wined3d_cs_stats_add(LONG64 volatile *counter, LONG64 value)
+{
+    LONG64 old;
+
+    do
+    {
+        old = *counter;
+    } while (InterlockedCompareExchange64(counter, old + value, old) != old);
+}
+
+static void wined3d_cs_stats_max(LONG64 volatile *counter, LONG64 value)
+{
+    LONG64 old;
+
+    while ((old = *counter) < value && InterlockedCompareExchange64(counter, value, old) != old);
+}
+
+static void wined3d_cs_dump_stats(const struct wined3d_cs *cs)
+{
+    LONG64 packet_count = wined3d_cs_stats.packet_count;
+    LARGE_INTEGER freq;
+    double ms;
+
+    QueryPerformanceFrequency(&freq);
+    ms = 1000.0 / freq.QuadPart;
+
+    TRACE_(d3d_cs)("%p: %s packets, queue depth %s bytes average, %s maximum.\n", cs,
+            wine_dbgstr_longlong(packet_count),
+            wine_dbgstr_longlong(packet_count ? wined3d_cs_stats.queue_depth_total / packet_count : 0),
+            wine_dbgstr_longlong(wined3d_cs_stats.queue_depth_max));
+    TRACE_(d3d_cs)("%p: %s finishes stalled for %.3f ms, %.3f ms maximum.\n", cs,
+            wine_dbgstr_longlong(wined3d_cs_stats.finish_count),
+            wined3d_cs_stats.finish_ticks * ms, wined3d_cs_stats.finish_ticks_max * ms);
+    TRACE_(d3d_cs)("%p: spun for %.3f ms, waited %s times, spin limit %.3f ms.\n", cs,
+            wined3d_cs_stats.spin_ticks * ms, wine_dbgstr_longlong(wined3d_cs_stats.wait_count),
+            cs->spin_limit * ms);
+}
+
 static BOOL wined3d_cs_queue_is_empty(const struct wined3d_cs *cs, const struct wined3d_cs_queue *queue)
 {
     wined3d_from_cs(cs);
@@ -2633,7 +2776,16 @@ static void wined3d_cs_queue_submit(struct wined3d_cs_queue *queue, struct wined
     InterlockedExchange(&queue->head, (queue->head + packet_size) & (WINED3D_CS_QUEUE_SIZE - 1));
 
     if (InterlockedCompareExchange(&cs->waiting_for_event, FALSE, TRUE))
-        SetEvent(cs->event);
+        RtlWakeAddressSingle(&cs->waiting_for_event);
+
+    if (TRACE_ON(d3d_cs))
+    {
+        LONG depth = (queue->head - *(volatile LONG *)&queue->tail) & (WINED3D_CS_QUEUE_SIZE - 1);
+
+        wined3d_cs_stats_add(&wined3d_cs_stats.packet_count, 1);
+        wined3d_cs_stats_add(&wined3d_cs_stats.queue_depth_total, depth);
+        wined3d_cs_stats_max(&wined3d_cs_stats.queue_depth_max, depth);
+    }
 }
 
 static void wined3d_cs_mt_submit(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
@@ -2715,11 +2867,29 @@ static void *wined3d_cs_mt_require_space(struct wined3d_cs *cs, size_t size, enu
 
 static void wined3d_cs_mt_finish(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
 {
+    LARGE_INTEGER start, end;
+
     if (cs->thread_id == GetCurrentThreadId())
         return wined3d_cs_st_finish(cs, queue_id);
 
+    if (!TRACE_ON(d3d_cs))
+    {
+        while (cs->queue[queue_id].head != *(volatile LONG *)&cs->queue[queue_id].tail)
+            wined3d_pause();
+        return;
+    }
+
+    if (cs->queue[queue_id].head == *(volatile LONG *)&cs->queue[queue_id].tail)
+        return;
+
+    QueryPerformanceCounter(&start);
     while (cs->queue[queue_id].head != *(volatile LONG *)&cs->queue[queue_id].tail)
         wined3d_pause();
+    QueryPerformanceCounter(&end);
+
+    wined3d_cs_stats_add(&wined3d_cs_stats.finish_count, 1);
+    wined3d_cs_stats_add(&wined3d_cs_stats.finish_ticks, end.QuadPart - start.QuadPart);
+    wined3d_cs_stats_max(&wined3d_cs_stats.finish_ticks_max, end.QuadPart - start.QuadPart);
 }
 
 static const struct wined3d_cs_ops wined3d_cs_mt_ops =
@@ -2730,6 +2900,193 @@ static const struct wined3d_cs_ops wined3d_cs_mt_ops =
     wined3d_cs_mt_push_constants,
 };
 
+static void *wined3d_cs_deferred_require_space(struct wined3d_cs *cs,
+        size_t size, enum wined3d_cs_queue_id queue_id)
+{
+    struct wined3d_command_list *list = cs->list;
+    size_t header_size, packet_size;
+    struct wined3d_cs_packet *packet;
+
+    header_size = FIELD_OFFSET(struct wined3d_cs_packet, data[0]);
+    size = (size + header_size - 1) & ~(header_size - 1);
+    packet_size = FIELD_OFFSET(struct wined3d_cs_packet, data[size]);
+    if (!wined3d_array_reserve(&list->data, &list->data_capacity, list->data_size + packet_size, 1))
+    {
+        ERR("Failed to allocate %lu bytes of command list data.\n", (unsigned long)packet_size);
+        list->failed = TRUE;
+
+        /* The packet is written to scratch storage and lost, the command
+         * list is dropped when recording finishes. */
+        if (size > cs->data_size)
+        {
+            void *data;
+
+            if (!(data = heap_realloc(cs->data, size)))
+                return NULL;
+            cs->data = data;
+            cs->data_size = size;
+        }
+        return cs->data;
+    }
+
+    packet = (struct wined3d_cs_packet *)((BYTE *)list->data + list->data_size);
+    packet->size = size;
+    list->data_size += packet_size;
+    return packet->data;
+}
+
+static void wined3d_cs_deferred_submit(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
+{
+}
+
+static void wined3d_cs_deferred_finish(struct wined3d_cs *cs, enum wined3d_cs_queue_id queue_id)
+{
+}
+
+static const struct wined3d_cs_ops wined3d_cs_deferred_ops =
+{
+    wined3d_cs_deferred_require_space,
+    wined3d_cs_deferred_submit,
+    wined3d_cs_deferred_finish,
+    wined3d_cs_mt_push_constants,
+};
+
+static void wined3d_cs_invalidate_all_states(struct wined3d_cs *cs)
+{
+    struct wined3d_device *device = cs->device;
+    unsigned int i;
+    DWORD state;
+
+    for (state = 0; state <= STATE_HIGHEST; ++state)
+    {
+        if (device->StateTable[state].representative)
+            device_invalidate_state(device, state);
+    }
+    for (i = 0; i < device->context_count; ++i)
+        device->contexts[i]->constant_update_mask = ~0u;
+}
+
+/* Drop the bind counts held by the command stream's state. */
+static void wined3d_cs_unbind_state(struct wined3d_state *state)
+{
+    struct wined3d_unordered_access_view *uav;
+    struct wined3d_shader_resource_view *srv;
+    struct wined3d_texture *texture;
+    struct wined3d_buffer *buffer;
+    unsigned int i, j;
+
+    for (i = 0; i < MAX_COMBINED_SAMPLERS; ++i)
+    {
+        if ((texture = state->textures[i]))
+            InterlockedDecrement(&texture->resource.bind_count);
+    }
+
+    for (i = 0; i < WINED3D_MAX_STREAM_OUTPUT_BUFFERS; ++i)
+    {
+        if ((buffer = state->stream_output[i].buffer))
+            InterlockedDecrement(&buffer->resource.bind_count);
+    }
+
+    for (i = 0; i < MAX_STREAMS; ++i)
+    {
+        if ((buffer = state->streams[i].buffer))
+            InterlockedDecrement(&buffer->resource.bind_count);
+    }
+
+    if ((buffer = state->index_buffer))
+        InterlockedDecrement(&buffer->resource.bind_count);
+
+    for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
+    {
+        for (j = 0; j < MAX_CONSTANT_BUFFERS; ++j)
+        {
+            if ((buffer = state->cb[i][j]))
+                InterlockedDecrement(&buffer->resource.bind_count);
+        }
+
+        for (j = 0; j < MAX_SHADER_RESOURCE_VIEWS; ++j)
+        {
+            if ((srv = state->shader_resource_view[i][j]))
+                InterlockedDecrement(&srv->resource->bind_count);
+        }
+    }
+
+    for (i = 0; i < WINED3D_PIPELINE_COUNT; ++i)
+    {
+        for (j = 0; j < MAX_UNORDERED_ACCESS_VIEWS; ++j)
+        {
+            if ((uav = state->unordered_access_view[i][j]))
+                InterlockedDecrement(&uav->resource->bind_count);
+        }
+    }
+}
+
+static void wined3d_cs_exec_execute_command_list(struct wined3d_cs *cs, const void *data)
+{
+    const struct wined3d_cs_execute_command_list *op = data;
+    const struct wined3d_command_list *list = op->list;
+    const struct wined3d_cs_packet *packet;
+    struct wined3d_state *saved_state;
+    struct wined3d_fb_state saved_fb;
+    enum wined3d_cs_op opcode;
+    size_t offset;
+    SIZE_T i;
+
+    /* The state is saved here rather than when the packet is emitted, since
+     * a recorded packet may run more than once. */
+    if (!(saved_state = heap_alloc(sizeof(*saved_state))))
+    {
+        ERR("Failed to allocate state, not executing command list %p.\n", list);
+        for (i = 0; i < list->resource_count; ++i)
+            wined3d_resource_release(list->resources[i]);
+        return;
+    }
+
+    /* Command lists start from the default state, and the state of the
+     * immediate context is restored afterwards. The light lists are moved
+     * back to the same address, so they don't need to be fixed up. */
+    *saved_state = cs->state;
+    saved_fb = cs->fb;
+
+    memset(&cs->state, 0, sizeof(cs->state));
+    memset(&cs->fb, 0, sizeof(cs->fb));
+    state_init(&cs->state, &cs->fb, &cs->device->adapter->d3d_info,
+            WINED3D_STATE_NO_REF | WINED3D_STATE_INIT_DEFAULT);
+    wined3d_cs_invalidate_all_states(cs);
+
+    for (offset = 0; offset < list->data_size; offset += FIELD_OFFSET(struct wined3d_cs_packet, data[packet->size]))
+    {
+        packet = (const struct wined3d_cs_packet *)((const BYTE *)list->data + offset);
+        opcode = *(const enum wined3d_cs_op *)packet->data;
+
+        TRACE("Executing recorded %s.\n", debug_cs_op(opcode));
+        wined3d_cs_op_handlers[opcode](cs, packet->data);
+    }
+
+    wined3d_cs_unbind_state(&cs->state);
+    state_cleanup(&cs->state);
+
+    cs->state = *saved_state;
+    cs->fb = saved_fb;
+    heap_free(saved_state);
+    wined3d_cs_invalidate_all_states(cs);
+}
+
+void wined3d_cs_emit_execute_command_list(struct wined3d_cs *cs, struct wined3d_command_list *list)
+{
+    struct wined3d_cs_execute_command_list *op;
+    SIZE_T i;
+
+    op = wined3d_cs_require_space(cs, sizeof(*op), WINED3D_CS_QUEUE_DEFAULT);
+    op->opcode = WINED3D_CS_OP_EXECUTE_COMMAND_LIST;
+    op->list = list;
+
+    for (i = 0; i < list->resource_count; ++i)
+        wined3d_cs_acquire_resource(cs, list->resources[i]);
+
+    wined3d_cs_submit(cs, WINED3D_CS_QUEUE_DEFAULT);
+}
+
 static void poll_queries(struct wined3d_cs *cs)
 {
     struct wined3d_query *query, *cursor;
@@ -2747,6 +3104,8 @@ static void poll_queries(struct wined3d_cs *cs)
 
 static void wined3d_cs_wait_event(struct wined3d_cs *cs)
 {
+    static const BOOL waiting = TRUE;
+
     InterlockedExchange(&cs->waiting_for_event, TRUE);
 
     /* The main thread might have enqueued a command and blocked on it after
@@ -2754,25 +3113,48 @@ static void wined3d_cs_wait_event(struct wined3d_cs *cs)
      * "waiting_for_event" was set.
      *
      * Likewise, we can race with the main thread when resetting
-     * "waiting_for_event", in which case we would need to call
-     * WaitForSingleObject() because the main thread called SetEvent(). */
+     * "waiting_for_event". RtlWaitOnAddress() returns immediately once the
+     * main thread has reset it, so there's no wakeup left to consume. */
     if (!(wined3d_cs_queue_is_empty(cs, &cs->queue[WINED3D_CS_QUEUE_DEFAULT])
             && wined3d_cs_queue_is_empty(cs, &cs->queue[WINED3D_CS_QUEUE_MAP]))
             && InterlockedCompareExchange(&cs->waiting_for_event, FALSE, TRUE))
         return;
 
-    WaitForSingleObject(cs->event, INFINITE);
+    if (TRACE_ON(d3d_cs))
+        wined3d_cs_stats_add(&wined3d_cs_stats.wait_count, 1);
+
+    while (*(volatile BOOL *)&cs->waiting_for_event)
+        RtlWaitOnAddress(&cs->waiting_for_event, &waiting, sizeof(waiting), NULL);
+}
+
+/* Adjust the spin limit after an idle period of "idle_ticks". Gaps that were
+ * caught while spinning keep the limit at least twice as long as the gap. If
+ * the thread had to sleep but a somewhat longer spin would have caught the
+ * packet, the limit is raised to cover it; long idle periods halve it. */
+static void wined3d_cs_update_spin_limit(struct wined3d_cs *cs, LONGLONG idle_ticks, BOOL waited)
+{
+    if (!waited)
+        cs->spin_limit = max(cs->spin_limit, 2 * idle_ticks);
+    else if (idle_ticks < cs->spin_max)
+        cs->spin_limit = 2 * idle_ticks;
+    else
+        cs->spin_limit /= 2;
+
+    cs->spin_limit = min(max(cs->spin_limit, cs->spin_min), cs->spin_max);
 }
 
 static DWORD WINAPI wined3d_cs_run(void *ctx)
 {
+    LARGE_INTEGER idle_start, now;
     struct wined3d_cs_packet *packet;
+    LONGLONG spin_ticks = 0;
     struct wined3d_cs_queue *queue;
     unsigned int spin_count = 0;
     struct wined3d_cs *cs = ctx;
     enum wined3d_cs_op opcode;
     HMODULE wined3d_module;
     unsigned int poll = 0;
+    BOOL waited = FALSE;
     LONG tail;
 
     TRACE("Started.\n");
@@ -2797,12 +3179,49 @@ static DWORD WINAPI wined3d_cs_run(void *ctx)
             queue = &cs->queue[WINED3D_CS_QUEUE_DEFAULT];
             if (wined3d_cs_queue_is_empty(cs, queue))
             {
-                if (++spin_count >= WINED3D_CS_SPIN_COUNT && list_empty(&cs->query_poll_list))
-                    wined3d_cs_wait_event(cs);
+                if (!spin_count++)
+                {
+                    QueryPerformanceCounter(&idle_start);
+                    waited = FALSE;
+                }
+                else if (!(spin_count % WINED3D_CS_SPIN_CHECK_INTERVAL) && list_empty(&cs->query_poll_list))
+                {
+                    QueryPerformanceCounter(&now);
+                    if (now.QuadPart - idle_start.QuadPart >= cs->spin_limit)
+                    {
+                        if (!waited)
+                            spin_ticks = now.QuadPart - idle_start.QuadPart;
+                        waited = TRUE;
+                        wined3d_cs_wait_event(cs);
+                        continue;
+                    }
+                }
+                wined3d_pause();
                 continue;
             }
         }
-        spin_count = 0;
+
+        if (spin_count)
+        {
+            QueryPerformanceCounter(&now);
+            if (!waited)
+                spin_ticks = now.QuadPart - idle_start.QuadPart;
+            wined3d_cs_update_spin_limit(cs, now.QuadPart - idle_start.QuadPart, waited);
+            spin_count = 0;
+
+            if (TRACE_ON(d3d_cs))
+            {
+                DWORD time = GetTickCount();
+
+                wined3d_cs_stats_add(&wined3d_cs_stats.spin_ticks, spin_ticks);
+                /* every 1.5 seconds */
+                if (time - cs->stats_time > 1500)
+                {
+                    wined3d_cs_dump_stats(cs);
+                    cs->stats_time = time;
+                }
+            }
+        }
 
         tail = queue->tail;
         packet = (struct wined3d_cs_packet *)&queue->data[tail];
@@ -2853,20 +3272,19 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device)
     if (wined3d_settings.cs_multithreaded
             && !RtlIsCriticalSectionLockedByThread(NtCurrentTeb()->Peb->LoaderLock))
     {
+        LARGE_INTEGER freq;
+
         cs->ops = &wined3d_cs_mt_ops;
 
-        if (!(cs->event = CreateEventW(NULL, FALSE, FALSE, NULL)))
-        {
-            ERR("Failed to create command stream event.\n");
-            heap_free(cs->data);
-            goto fail;
-        }
+        QueryPerformanceFrequency(&freq);
+        cs->spin_min = freq.QuadPart * WINED3D_CS_SPIN_MIN_US / 1000000;
+        cs->spin_max = freq.QuadPart * WINED3D_CS_SPIN_MAX_US / 1000000;
+        cs->spin_limit = cs->spin_max;
 
         if (!(GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS,
                 (const WCHAR *)wined3d_cs_run, &cs->wined3d_module)))
         {
             ERR("Failed to get wined3d module handle.\n");
-            CloseHandle(cs->event);
             heap_free(cs->data);
             goto fail;
         }
@@ -2875,7 +3293,6 @@ struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device)
         {
             ERR("Failed to create wined3d command stream thread.\n");
             FreeLibrary(cs->wined3d_module);
-            CloseHandle(cs->event);
             heap_free(cs->data);
             goto fail;
         }
@@ -2895,11 +3312,839 @@ void wined3d_cs_destroy(struct wined3d_cs *cs)
     {
         wined3d_cs_emit_stop(cs);
         CloseHandle(cs->thread);
-        if (!CloseHandle(cs->event))
-            ERR("Closing event failed.\n");
+        if (TRACE_ON(d3d_cs))
+            wined3d_cs_dump_stats(cs);
     }
 
     state_cleanup(&cs->state);
     heap_free(cs->data);
     heap_free(cs);
 }
+
+static struct wined3d_command_list *wined3d_command_list_create(struct wined3d_device *device)
+{
+    struct wined3d_command_list *list;
+
+    if (!(list = heap_alloc_zero(sizeof(*list))))
+        return NULL;
+
+    list->refcount = 1;
+    list->device = device;
+
+    return list;
+}
+
+static void wined3d_command_list_add_object(struct wined3d_command_list *list,
+        enum wined3d_command_list_object_type type, void *object)
+{
+    struct wined3d_command_list_object *entry;
+
+    if (!object)
+        return;
+
+    if (!wined3d_array_reserve((void **)&list->objects, &list->objects_size,
+            list->object_count + 1, sizeof(*list->objects)))
+    {
+        ERR("Failed to record object %p.\n", object);
+        list->failed = TRUE;
+        return;
+    }
+
+    switch (type)
+    {
+        case WINED3D_COMMAND_LIST_OBJECT_BLEND_STATE:
+            wined3d_blend_state_incref(object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_RASTERIZER_STATE:
+            wined3d_rasterizer_state_incref(object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_RENDERTARGET_VIEW:
+            wined3d_rendertarget_view_incref(object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_SAMPLER:
+            wined3d_sampler_incref(object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_SHADER:
+            wined3d_shader_incref(object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_SHADER_RESOURCE_VIEW:
+            wined3d_shader_resource_view_incref(object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_UNORDERED_ACCESS_VIEW:
+            wined3d_unordered_access_view_incref(object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_VERTEX_DECLARATION:
+            wined3d_vertex_declaration_incref(object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_BUFFER:
+            wined3d_buffer_incref(object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_COMMAND_LIST:
+            wined3d_command_list_incref(object);
+            break;
+    }
+
+    entry = &list->objects[list->object_count++];
+    entry->type = type;
+    entry->object = object;
+}
+
+static void wined3d_command_list_object_decref(const struct wined3d_command_list_object *entry)
+{
+    switch (entry->type)
+    {
+        case WINED3D_COMMAND_LIST_OBJECT_BLEND_STATE:
+            wined3d_blend_state_decref(entry->object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_RASTERIZER_STATE:
+            wined3d_rasterizer_state_decref(entry->object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_RENDERTARGET_VIEW:
+            wined3d_rendertarget_view_decref(entry->object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_SAMPLER:
+            wined3d_sampler_decref(entry->object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_SHADER:
+            wined3d_shader_decref(entry->object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_SHADER_RESOURCE_VIEW:
+            wined3d_shader_resource_view_decref(entry->object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_UNORDERED_ACCESS_VIEW:
+            wined3d_unordered_access_view_decref(entry->object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_VERTEX_DECLARATION:
+            wined3d_vertex_declaration_decref(entry->object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_BUFFER:
+            wined3d_buffer_decref(entry->object);
+            break;
+        case WINED3D_COMMAND_LIST_OBJECT_COMMAND_LIST:
+            wined3d_command_list_decref(entry->object);
+            break;
+    }
+}
+
+static void wined3d_command_list_destroy_object(void *object)
+{
+    struct wined3d_command_list *list = object;
+    SIZE_T i;
+
+    for (i = 0; i < list->upload_count; ++i)
+        heap_free(list->uploads[i]);
+    heap_free(list->uploads);
+    heap_free(list->objects);
+    heap_free(list->resources);
+    heap_free(list->data);
+    heap_free(list);
+}
+
+ULONG CDECL wined3d_command_list_incref(struct wined3d_command_list *list)
+{
+    ULONG refcount = InterlockedIncrement(&list->refcount);
+
+    TRACE("%p increasing refcount to %u.\n", list, refcount);
+
+    return refcount;
+}
+
+ULONG CDECL wined3d_command_list_decref(struct wined3d_command_list *list)
+{
+    ULONG refcount = InterlockedDecrement(&list->refcount);
+    struct wined3d_device *device = list->device;
+    SIZE_T i;
+
+    TRACE("%p decreasing refcount to %u.\n", list, refcount);
+
+    if (!refcount)
+    {
+        /* Object destruction goes through the command stream as well, so
+         * the objects outlive any pending execution of the list. */
+        for (i = 0; i < list->object_count; ++i)
+            wined3d_command_list_object_decref(&list->objects[i]);
+        for (i = 0; i < list->resource_count; ++i)
+            wined3d_resource_decref(list->resources[i]);
+        wined3d_cs_destroy_object(device->cs, wined3d_command_list_destroy_object, list);
+    }
+
+    return refcount;
+}
+
+static void wined3d_cs_reset_deferred_state(struct wined3d_cs *cs)
+{
+    state_cleanup(&cs->state);
+    memset(&cs->state, 0, sizeof(cs->state));
+    memset(&cs->fb, 0, sizeof(cs->fb));
+    state_init(&cs->state, &cs->fb, &cs->device->adapter->d3d_info,
+            WINED3D_STATE_NO_REF | WINED3D_STATE_INIT_DEFAULT);
+}
+
+struct wined3d_cs *wined3d_cs_create_deferred(struct wined3d_device *device)
+{
+    const struct wined3d_d3d_info *d3d_info = &device->adapter->d3d_info;
+    struct wined3d_cs *cs;
+
+    /* Recording command streams don't need the queues, they write packets
+     * straight into the command list. */
+    if (!(cs = heap_alloc_zero(FIELD_OFFSET(struct wined3d_cs, queue))))
+        return NULL;
+
+    /* Scratch storage for packets that can't be recorded, large enough for
+     * any packet a deferred context emits. */
+    cs->data_size = WINED3D_CS_DEFERRED_SCRATCH_SIZE;
+    if (!(cs->data = heap_alloc(cs->data_size)))
+    {
+        heap_free(cs);
+        return NULL;
+    }
+
+    if (!(cs->list = wined3d_command_list_create(device)))
+    {
+        heap_free(cs->data);
+        heap_free(cs);
+        return NULL;
+    }
+
+    cs->ops = &wined3d_cs_deferred_ops;
+    cs->device = device;
+
+    state_init(&cs->state, &cs->fb, d3d_info, WINED3D_STATE_NO_REF | WINED3D_STATE_INIT_DEFAULT);
+
+    return cs;
+}
+
+void wined3d_cs_destroy_deferred(struct wined3d_cs *cs)
+{
+    wined3d_command_list_decref(cs->list);
+    state_cleanup(&cs->state);
+    heap_free(cs->data);
+    heap_free(cs);
+}
+
+HRESULT CDECL wined3d_deferred_context_create(struct wined3d_device *device,
+        struct wined3d_deferred_context **context)
+{
+    struct wined3d_deferred_context *object;
+
+    TRACE("device %p, context %p.\n", device, context);
+
+    if (!(object = heap_alloc_zero(sizeof(*object))))
+        return E_OUTOFMEMORY;
+
+    if (!(object->cs = wined3d_cs_create_deferred(device)))
+    {
+        heap_free(object);
+        return E_OUTOFMEMORY;
+    }
+    object->device = device;
+
+    TRACE("Created deferred context %p.\n", object);
+    *context = object;
+
+    return WINED3D_OK;
+}
+
+void CDECL wined3d_deferred_context_destroy(struct wined3d_deferred_context *context)
+{
+    TRACE("context %p.\n", context);
+
+    wined3d_cs_destroy_deferred(context->cs);
+    heap_free(context);
+}
+
+void CDECL wined3d_deferred_context_set_shader(struct wined3d_deferred_context *context,
+        enum wined3d_shader_type type, struct wined3d_shader *shader)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, type %#x, shader %p.\n", context, type, shader);
+
+    if (cs->state.shader[type] == shader)
+        return;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_SHADER, shader);
+    cs->state.shader[type] = shader;
+    wined3d_cs_emit_set_shader(cs, type, shader);
+}
+
+void CDECL wined3d_deferred_context_set_constant_buffer(struct wined3d_deferred_context *context,
+        enum wined3d_shader_type type, unsigned int idx, struct wined3d_buffer *buffer)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, type %#x, idx %u, buffer %p.\n", context, type, idx, buffer);
+
+    if (idx >= MAX_CONSTANT_BUFFERS)
+    {
+        WARN("Invalid constant buffer index %u.\n", idx);
+        return;
+    }
+
+    if (cs->state.cb[type][idx] == buffer)
+        return;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_BUFFER, buffer);
+    cs->state.cb[type][idx] = buffer;
+    wined3d_cs_emit_set_constant_buffer(cs, type, idx, buffer);
+}
+
+void CDECL wined3d_deferred_context_set_shader_resource_view(struct wined3d_deferred_context *context,
+        enum wined3d_shader_type type, unsigned int idx, struct wined3d_shader_resource_view *view)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, type %#x, idx %u, view %p.\n", context, type, idx, view);
+
+    if (idx >= MAX_SHADER_RESOURCE_VIEWS)
+    {
+        WARN("Invalid view index %u.\n", idx);
+        return;
+    }
+
+    if (cs->state.shader_resource_view[type][idx] == view)
+        return;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_SHADER_RESOURCE_VIEW, view);
+    cs->state.shader_resource_view[type][idx] = view;
+    wined3d_cs_emit_set_shader_resource_view(cs, type, idx, view);
+}
+
+void CDECL wined3d_deferred_context_set_sampler(struct wined3d_deferred_context *context,
+        enum wined3d_shader_type type, unsigned int idx, struct wined3d_sampler *sampler)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, type %#x, idx %u, sampler %p.\n", context, type, idx, sampler);
+
+    if (idx >= MAX_SAMPLER_OBJECTS)
+    {
+        WARN("Invalid sampler index %u.\n", idx);
+        return;
+    }
+
+    if (cs->state.sampler[type][idx] == sampler)
+        return;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_SAMPLER, sampler);
+    cs->state.sampler[type][idx] = sampler;
+    wined3d_cs_emit_set_sampler(cs, type, idx, sampler);
+}
+
+static void wined3d_deferred_context_set_pipeline_unordered_access_view(struct wined3d_deferred_context *context,
+        enum wined3d_pipeline pipeline, unsigned int idx, struct wined3d_unordered_access_view *uav,
+        unsigned int initial_count)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    if (idx >= MAX_UNORDERED_ACCESS_VIEWS)
+    {
+        WARN("Invalid UAV index %u.\n", idx);
+        return;
+    }
+
+    if (cs->state.unordered_access_view[pipeline][idx] == uav && initial_count == ~0u)
+        return;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_UNORDERED_ACCESS_VIEW, uav);
+    cs->state.unordered_access_view[pipeline][idx] = uav;
+    wined3d_cs_emit_set_unordered_access_view(cs, pipeline, idx, uav, initial_count);
+}
+
+void CDECL wined3d_deferred_context_set_unordered_access_view(struct wined3d_deferred_context *context,
+        unsigned int idx, struct wined3d_unordered_access_view *uav, unsigned int initial_count)
+{
+    TRACE("context %p, idx %u, uav %p, initial_count %#x.\n", context, idx, uav, initial_count);
+
+    wined3d_deferred_context_set_pipeline_unordered_access_view(context,
+            WINED3D_PIPELINE_GRAPHICS, idx, uav, initial_count);
+}
+
+void CDECL wined3d_deferred_context_set_cs_uav(struct wined3d_deferred_context *context,
+        unsigned int idx, struct wined3d_unordered_access_view *uav, unsigned int initial_count)
+{
+    TRACE("context %p, idx %u, uav %p, initial_count %#x.\n", context, idx, uav, initial_count);
+
+    wined3d_deferred_context_set_pipeline_unordered_access_view(context,
+            WINED3D_PIPELINE_COMPUTE, idx, uav, initial_count);
+}
+
+void CDECL wined3d_deferred_context_set_vertex_declaration(struct wined3d_deferred_context *context,
+        struct wined3d_vertex_declaration *declaration)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, declaration %p.\n", context, declaration);
+
+    if (cs->state.vertex_declaration == declaration)
+        return;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_VERTEX_DECLARATION, declaration);
+    cs->state.vertex_declaration = declaration;
+    wined3d_cs_emit_set_vertex_declaration(cs, declaration);
+}
+
+HRESULT CDECL wined3d_deferred_context_set_stream_source(struct wined3d_deferred_context *context,
+        unsigned int stream_idx, struct wined3d_buffer *buffer, unsigned int offset, unsigned int stride)
+{
+    struct wined3d_cs *cs = context->cs;
+    struct wined3d_stream_state *stream;
+
+    TRACE("context %p, stream_idx %u, buffer %p, offset %u, stride %u.\n",
+            context, stream_idx, buffer, offset, stride);
+
+    if (stream_idx >= MAX_STREAMS)
+    {
+        WARN("Stream index %u out of range.\n", stream_idx);
+        return WINED3DERR_INVALIDCALL;
+    }
+    else if (offset & 0x3)
+    {
+        WARN("Offset %u is not 4 byte aligned.\n", offset);
+        return WINED3DERR_INVALIDCALL;
+    }
+
+    stream = &cs->state.streams[stream_idx];
+    if (stream->buffer == buffer && stream->offset == offset && stream->stride == stride)
+        return WINED3D_OK;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_BUFFER, buffer);
+    stream->buffer = buffer;
+    stream->offset = offset;
+    stream->stride = stride;
+    wined3d_cs_emit_set_stream_source(cs, stream_idx, buffer, offset, stride);
+
+    return WINED3D_OK;
+}
+
+void CDECL wined3d_deferred_context_set_index_buffer(struct wined3d_deferred_context *context,
+        struct wined3d_buffer *buffer, enum wined3d_format_id format_id, unsigned int offset)
+{
+    struct wined3d_cs *cs = context->cs;
+    struct wined3d_state *state = &cs->state;
+
+    TRACE("context %p, buffer %p, format %s, offset %u.\n",
+            context, buffer, debug_d3dformat(format_id), offset);
+
+    if (state->index_buffer == buffer && state->index_format == format_id && state->index_offset == offset)
+        return;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_BUFFER, buffer);
+    state->index_buffer = buffer;
+    state->index_format = format_id;
+    state->index_offset = offset;
+    wined3d_cs_emit_set_index_buffer(cs, buffer, format_id, offset);
+}
+
+void CDECL wined3d_deferred_context_set_stream_output(struct wined3d_deferred_context *context,
+        unsigned int idx, struct wined3d_buffer *buffer, unsigned int offset)
+{
+    struct wined3d_cs *cs = context->cs;
+    struct wined3d_stream_output *stream;
+
+    TRACE("context %p, idx %u, buffer %p, offset %u.\n", context, idx, buffer, offset);
+
+    if (idx >= WINED3D_MAX_STREAM_OUTPUT_BUFFERS)
+    {
+        WARN("Invalid stream output %u.\n", idx);
+        return;
+    }
+
+    stream = &cs->state.stream_output[idx];
+    if (stream->buffer == buffer && stream->offset == offset)
+        return;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_BUFFER, buffer);
+    stream->buffer = buffer;
+    stream->offset = offset;
+    wined3d_cs_emit_set_stream_output(cs, idx, buffer, offset);
+}
+
+void CDECL wined3d_deferred_context_set_primitive_type(struct wined3d_deferred_context *context,
+        enum wined3d_primitive_type primitive_type, unsigned int patch_vertex_count)
+{
+    struct wined3d_state *state = &context->cs->state;
+
+    TRACE("context %p, primitive_type %s, patch_vertex_count %u.\n",
+            context, debug_d3dprimitivetype(primitive_type), patch_vertex_count);
+
+    state->gl_primitive_type = gl_primitive_type_from_d3d(primitive_type);
+    state->gl_patch_vertices = patch_vertex_count;
+}
+
+void CDECL wined3d_deferred_context_set_blend_state(struct wined3d_deferred_context *context,
+        struct wined3d_blend_state *blend_state, const struct wined3d_color *blend_factor)
+{
+    struct wined3d_cs *cs = context->cs;
+    struct wined3d_state *state = &cs->state;
+
+    TRACE("context %p, blend_state %p, blend_factor %s.\n", context, blend_state, debug_color(blend_factor));
+
+    if (state->blend_state == blend_state && !memcmp(blend_factor, &state->blend_factor, sizeof(*blend_factor)))
+        return;
+
+    if (state->blend_state != blend_state)
+        wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_BLEND_STATE, blend_state);
+    state->blend_state = blend_state;
+    state->blend_factor = *blend_factor;
+    wined3d_cs_emit_set_blend_state(cs, blend_state, blend_factor);
+}
+
+void CDECL wined3d_deferred_context_set_rasterizer_state(struct wined3d_deferred_context *context,
+        struct wined3d_rasterizer_state *rasterizer_state)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, rasterizer_state %p.\n", context, rasterizer_state);
+
+    if (cs->state.rasterizer_state == rasterizer_state)
+        return;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_RASTERIZER_STATE, rasterizer_state);
+    cs->state.rasterizer_state = rasterizer_state;
+    wined3d_cs_emit_set_rasterizer_state(cs, rasterizer_state);
+}
+
+void CDECL wined3d_deferred_context_set_render_state(struct wined3d_deferred_context *context,
+        enum wined3d_render_state state, DWORD value)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, state %s (%#x), value %#x.\n", context, debug_d3drenderstate(state), state, value);
+
+    if (state > WINEHIGHEST_RENDER_STATE)
+    {
+        WARN("Unhandled render state %#x.\n", state);
+        return;
+    }
+
+    if (cs->state.render_states[state] == value)
+        return;
+
+    cs->state.render_states[state] = value;
+    wined3d_cs_emit_set_render_state(cs, state, value);
+}
+
+void CDECL wined3d_deferred_context_set_viewports(struct wined3d_deferred_context *context,
+        unsigned int viewport_count, const struct wined3d_viewport *viewports)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, viewport_count %u, viewports %p.\n", context, viewport_count, viewports);
+
+    if (viewport_count > WINED3D_MAX_VIEWPORTS)
+    {
+        WARN("Invalid viewport count %u.\n", viewport_count);
+        return;
+    }
+
+    if (viewport_count)
+        memcpy(cs->state.viewports, viewports, viewport_count * sizeof(*viewports));
+    else
+        memset(cs->state.viewports, 0, sizeof(cs->state.viewports));
+    cs->state.viewport_count = viewport_count;
+    wined3d_cs_emit_set_viewports(cs, viewport_count, viewports);
+}
+
+void CDECL wined3d_deferred_context_set_scissor_rects(struct wined3d_deferred_context *context,
+        unsigned int rect_count, const RECT *rects)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, rect_count %u, rects %p.\n", context, rect_count, rects);
+
+    if (rect_count > WINED3D_MAX_VIEWPORTS)
+    {
+        WARN("Invalid scissor rect count %u.\n", rect_count);
+        return;
+    }
+
+    if (cs->state.scissor_rect_count == rect_count
+            && !memcmp(cs->state.scissor_rects, rects, rect_count * sizeof(*rects)))
+        return;
+
+    if (rect_count)
+        memcpy(cs->state.scissor_rects, rects, rect_count * sizeof(*rects));
+    else
+        memset(cs->state.scissor_rects, 0, sizeof(cs->state.scissor_rects));
+    cs->state.scissor_rect_count = rect_count;
+    wined3d_cs_emit_set_scissor_rects(cs, rect_count, rects);
+}
+
+HRESULT CDECL wined3d_deferred_context_set_rendertarget_view(struct wined3d_deferred_context *context,
+        unsigned int view_idx, struct wined3d_rendertarget_view *view)
+{
+    struct wined3d_cs *cs = context->cs;
+    unsigned int max_rt_count;
+
+    TRACE("context %p, view_idx %u, view %p.\n", context, view_idx, view);
+
+    max_rt_count = context->device->adapter->d3d_info.limits.max_rt_count;
+    if (view_idx >= max_rt_count)
+    {
+        WARN("Only %u render targets are supported.\n", max_rt_count);
+        return WINED3DERR_INVALIDCALL;
+    }
+
+    if (view && !(view->resource->bind_flags & WINED3D_BIND_RENDER_TARGET))
+    {
+        WARN("View resource %p doesn't have render target bind flags.\n", view->resource);
+        return WINED3DERR_INVALIDCALL;
+    }
+
+    if (cs->fb.render_targets[view_idx] == view)
+        return WINED3D_OK;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_RENDERTARGET_VIEW, view);
+    cs->fb.render_targets[view_idx] = view;
+    wined3d_cs_emit_set_rendertarget_view(cs, view_idx, view);
+
+    return WINED3D_OK;
+}
+
+HRESULT CDECL wined3d_deferred_context_set_depth_stencil_view(struct wined3d_deferred_context *context,
+        struct wined3d_rendertarget_view *view)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, view %p.\n", context, view);
+
+    if (view && !(view->resource->bind_flags & WINED3D_BIND_DEPTH_STENCIL))
+    {
+        WARN("View resource %p has incompatible %s bind flags.\n",
+                view->resource, wined3d_debug_bind_flags(view->resource->bind_flags));
+        return WINED3DERR_INVALIDCALL;
+    }
+
+    if (cs->fb.depth_stencil == view)
+        return WINED3D_OK;
+
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_RENDERTARGET_VIEW, view);
+    cs->fb.depth_stencil = view;
+    wined3d_cs_emit_set_depth_stencil_view(cs, view);
+
+    return WINED3D_OK;
+}
+
+/* Set "state" on a deferred context in its default state. Only the state
+ * that differs from the defaults is recorded, and the objects it references
+ * are added to the command list being recorded. */
+static void wined3d_deferred_context_restore_state(struct wined3d_deferred_context *context,
+        const struct wined3d_state *state, const struct wined3d_fb_state *fb)
+{
+    unsigned int i, j, max_rt_count = context->device->adapter->d3d_info.limits.max_rt_count;
+    struct wined3d_cs *cs = context->cs;
+
+    for (i = 0; i < WINED3D_SHADER_TYPE_COUNT; ++i)
+    {
+        wined3d_deferred_context_set_shader(context, i, state->shader[i]);
+        for (j = 0; j < MAX_CONSTANT_BUFFERS; ++j)
+            wined3d_deferred_context_set_constant_buffer(context, i, j, state->cb[i][j]);
+        for (j = 0; j < MAX_SAMPLER_OBJECTS; ++j)
+            wined3d_deferred_context_set_sampler(context, i, j, state->sampler[i][j]);
+        for (j = 0; j < MAX_SHADER_RESOURCE_VIEWS; ++j)
+            wined3d_deferred_context_set_shader_resource_view(context, i, j, state->shader_resource_view[i][j]);
+    }
+    for (i = 0; i < WINED3D_PIPELINE_COUNT; ++i)
+    {
+        for (j = 0; j < MAX_UNORDERED_ACCESS_VIEWS; ++j)
+            wined3d_deferred_context_set_pipeline_unordered_access_view(context,
+                    i, j, state->unordered_access_view[i][j], ~0u);
+    }
+
+    wined3d_deferred_context_set_vertex_declaration(context, state->vertex_declaration);
+    for (i = 0; i < MAX_STREAMS; ++i)
+        wined3d_deferred_context_set_stream_source(context, i, state->streams[i].buffer,
+                state->streams[i].offset, state->streams[i].stride);
+    wined3d_deferred_context_set_index_buffer(context, state->index_buffer, state->index_format, state->index_offset);
+    for (i = 0; i < WINED3D_MAX_STREAM_OUTPUT_BUFFERS; ++i)
+        wined3d_deferred_context_set_stream_output(context, i, state->stream_output[i].buffer,
+                state->stream_output[i].offset);
+    cs->state.gl_primitive_type = state->gl_primitive_type;
+    cs->state.gl_patch_vertices = state->gl_patch_vertices;
+
+    wined3d_deferred_context_set_blend_state(context, state->blend_state, &state->blend_factor);
+    wined3d_deferred_context_set_rasterizer_state(context, state->rasterizer_state);
+    for (i = 0; i <= WINEHIGHEST_RENDER_STATE; ++i)
+        wined3d_deferred_context_set_render_state(context, i, state->render_states[i]);
+    if (state->viewport_count != cs->state.viewport_count
+            || memcmp(state->viewports, cs->state.viewports, sizeof(state->viewports)))
+        wined3d_deferred_context_set_viewports(context, state->viewport_count, state->viewports);
+    wined3d_deferred_context_set_scissor_rects(context, state->scissor_rect_count, state->scissor_rects);
+
+    for (i = 0; i < max_rt_count; ++i)
+        wined3d_deferred_context_set_rendertarget_view(context, i, fb->render_targets[i]);
+    wined3d_deferred_context_set_depth_stencil_view(context, fb->depth_stencil);
+}
+
+HRESULT CDECL wined3d_deferred_context_record_command_list(struct wined3d_deferred_context *context,
+        BOOL restore, struct wined3d_command_list **list)
+{
+    struct wined3d_cs *cs = context->cs;
+    struct wined3d_command_list *object;
+    struct wined3d_state *saved_state = NULL;
+    struct wined3d_fb_state saved_fb;
+
+    TRACE("context %p, restore %#x, list %p.\n", context, restore, list);
+
+    if (!(object = wined3d_command_list_create(context->device)))
+        return E_OUTOFMEMORY;
+
+    /* Command lists are executed from the default state, so the state kept
+     * on the deferred context is recorded again at the start of the next
+     * list. The saved copy doesn't own its light lists, and is never
+     * cleaned up. */
+    if (restore)
+    {
+        if (!(saved_state = heap_alloc(sizeof(*saved_state))))
+        {
+            wined3d_command_list_decref(object);
+            return E_OUTOFMEMORY;
+        }
+        *saved_state = cs->state;
+        saved_fb = cs->fb;
+    }
+
+    *list = cs->list;
+    cs->list = object;
+    wined3d_cs_reset_deferred_state(cs);
+
+    if (saved_state)
+    {
+        wined3d_deferred_context_restore_state(context, saved_state, &saved_fb);
+        heap_free(saved_state);
+    }
+
+    if ((*list)->failed)
+    {
+        WARN("Failed to record command list %p.\n", *list);
+        wined3d_command_list_decref(*list);
+        *list = NULL;
+        return E_OUTOFMEMORY;
+    }
+
+    TRACE("Recorded command list %p, %lu bytes.\n", *list, (unsigned long)(*list)->data_size);
+
+    return WINED3D_OK;
+}
+
+void CDECL wined3d_deferred_context_draw(struct wined3d_deferred_context *context, int base_vertex_idx,
+        unsigned int start_idx, unsigned int index_count, unsigned int start_instance,
+        unsigned int instance_count, BOOL indexed)
+{
+    const struct wined3d_state *state = &context->cs->state;
+
+    TRACE("context %p, base_vertex_idx %d, start_idx %u, index_count %u, "
+            "start_instance %u, instance_count %u, indexed %#x.\n",
+            context, base_vertex_idx, start_idx, index_count, start_instance, instance_count, indexed);
+
+    if (indexed && !state->index_buffer)
+    {
+        WARN("Called without a valid index buffer set.\n");
+        return;
+    }
+
+    wined3d_cs_emit_draw(context->cs, state->gl_primitive_type, state->gl_patch_vertices,
+            base_vertex_idx, start_idx, index_count, start_instance, instance_count, indexed);
+}
+
+void CDECL wined3d_deferred_context_execute_command_list(struct wined3d_deferred_context *context,
+        struct wined3d_command_list *list)
+{
+    struct wined3d_cs *cs = context->cs;
+
+    TRACE("context %p, list %p.\n", context, list);
+
+    /* The nested list runs from the default state and restores the state it
+     * found, like on the immediate context. Its resources are recorded in
+     * the outer list, and acquired when that one is executed. */
+    wined3d_command_list_add_object(cs->list, WINED3D_COMMAND_LIST_OBJECT_COMMAND_LIST, list);
+    wined3d_cs_emit_execute_command_list(cs, list);
+}
+
+void CDECL wined3d_deferred_context_dispatch(struct wined3d_deferred_context *context,
+        unsigned int group_count_x, unsigned int group_count_y, unsigned int group_count_z)
+{
+    TRACE("context %p, group_count_x %u, group_count_y %u, group_count_z %u.\n",
+            context, group_count_x, group_count_y, group_count_z);
+
+    wined3d_cs_emit_dispatch(context->cs, group_count_x, group_count_y, group_count_z);
+}
+
+HRESULT CDECL wined3d_deferred_context_clear_rendertarget_view(struct wined3d_deferred_context *context,
+        struct wined3d_rendertarget_view *view, const RECT *rect, DWORD flags,
+        const struct wined3d_color *color, float depth, DWORD stencil)
+{
+    TRACE("context %p, view %p, rect %s, flags %#x, color %s, depth %.8e, stencil %u.\n",
+            context, view, wine_dbgstr_rect(rect), flags, debug_color(color), depth, stencil);
+
+    wined3d_command_list_add_object(context->cs->list, WINED3D_COMMAND_LIST_OBJECT_RENDERTARGET_VIEW, view);
+    return device_clear_rendertarget_view(context->cs, view, rect, flags, color, depth, stencil);
+}
+
+void CDECL wined3d_deferred_context_copy_resource(struct wined3d_deferred_context *context,
+        struct wined3d_resource *dst_resource, struct wined3d_resource *src_resource)
+{
+    TRACE("context %p, dst_resource %p, src_resource %p.\n", context, dst_resource, src_resource);
+
+    device_copy_resource(context->cs, dst_resource, src_resource);
+}
+
+HRESULT CDECL wined3d_deferred_context_copy_sub_resource_region(struct wined3d_deferred_context *context,
+        struct wined3d_resource *dst_resource, unsigned int dst_sub_resource_idx, unsigned int dst_x,
+        unsigned int dst_y, unsigned int dst_z, struct wined3d_resource *src_resource,
+        unsigned int src_sub_resource_idx, const struct wined3d_box *src_box)
+{
+    TRACE("context %p, dst_resource %p, dst_sub_resource_idx %u, dst_x %u, dst_y %u, dst_z %u, "
+            "src_resource %p, src_sub_resource_idx %u, src_box %s.\n",
+            context, dst_resource, dst_sub_resource_idx, dst_x, dst_y, dst_z,
+            src_resource, src_sub_resource_idx, debug_box(src_box));
+
+    return device_copy_sub_resource_region(context->cs, dst_resource, dst_sub_resource_idx,
+            dst_x, dst_y, dst_z, src_resource, src_sub_resource_idx, src_box);
+}
+
+void CDECL wined3d_deferred_context_update_sub_resource(struct wined3d_deferred_context *context,
+        struct wined3d_resource *resource, unsigned int sub_resource_idx, const struct wined3d_box *box,
+        const void *data, unsigned int row_pitch, unsigned int depth_pitch)
+{
+    struct wined3d_command_list *list = context->cs->list;
+    unsigned int packed_row_pitch, packed_slice_pitch;
+    const struct wined3d_format *format;
+    unsigned int rows, slices;
+    struct wined3d_box b;
+    size_t size;
+    void *copy;
+
+    TRACE("context %p, resource %p, sub_resource_idx %u, box %s, data %p, row_pitch %u, depth_pitch %u.\n",
+            context, resource, sub_resource_idx, debug_box(box), data, row_pitch, depth_pitch);
+
+    if (!device_get_update_box(resource, sub_resource_idx, box, &b))
+        return;
+
+    /* The data needs to stay around until the list is executed. */
+    if (resource->type == WINED3D_RTYPE_BUFFER)
+    {
+        size = b.right - b.left;
+    }
+    else
+    {
+        format = resource->format;
+        wined3d_format_calculate_pitch(format, 1, b.right - b.left, b.bottom - b.top,
+                &packed_row_pitch, &packed_slice_pitch);
+        rows = packed_row_pitch ? packed_slice_pitch / packed_row_pitch : 0;
+        slices = b.back - b.front;
+        size = (slices - 1) * depth_pitch + (rows - 1) * row_pitch + packed_row_pitch;
+    }
+
+    if (!wined3d_array_reserve((void **)&list->uploads, &list->uploads_size,
+            list->upload_count + 1, sizeof(*list->uploads)) || !(copy = heap_alloc(size)))
+    {
+        ERR("Failed to allocate %lu bytes of upload data.\n", (unsigned long)size);
+        return;
+    }
+    memcpy(copy, data, size);
+    list->uploads[list->upload_count++] = copy;
+
+    wined3d_cs_emit_update_sub_resource(context->cs, resource, sub_resource_idx, &b, copy, row_pitch, depth_pitch);
+}
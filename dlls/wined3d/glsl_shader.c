@@ -144,6 +144,8 @@ struct shader_glsl_priv
     struct wine_rb_tree ffp_fragment_shaders;
     BOOL ffp_proj_control;
     BOOL legacy_lighting;
+    BOOL async_compile;
+    struct wined3d_shader_compile_stats *compile_stats;
 };
 
 struct glsl_vs_program
@@ -244,6 +246,17 @@ struct glsl_cs_program
 };
 
 /* Struct to maintain data about a linked GLSL program */
+/* Shaders of a program that is still being linked by the driver. */
+struct glsl_pending_program
+{
+    struct wined3d_shader *vshader;
+    struct wined3d_shader *hshader;
+    struct wined3d_shader *dshader;
+    struct wined3d_shader *gshader;
+    struct wined3d_shader *pshader;
+    BOOL cache_binary;
+};
+
 struct glsl_shader_prog_link
 {
     struct wine_rb_entry program_lookup_entry;
@@ -254,6 +267,7 @@ struct glsl_shader_prog_link
     struct glsl_ps_program ps;
     struct glsl_cs_program cs;
     GLuint id;
+    struct glsl_pending_program *pending;
     DWORD constant_update_mask;
     unsigned int constant_version;
     DWORD clipplanes;
@@ -539,7 +553,12 @@ static void shader_glsl_compile(const struct wined3d_gl_info *gl_info, GLuint sh
     checkGLcall("glCompileShader");
     if (old_fpu_cw != WINED3D_DEFAULT_FPU_CW)
         wined3d_set_fpu_cw(old_fpu_cw);
-    print_glsl_info_log(gl_info, shader, FALSE);
+    /* Querying the info log would wait for the compiler to finish. With
+     * asynchronous compilation, compile errors still show up in the program
+     * info log once the program is ready. */
+    if (wined3d_settings.async_shader_compile == WINED3D_ASYNC_SHADER_DISABLED
+            || !gl_info->supported[ARB_PARALLEL_SHADER_COMPILE] || TRACE_ON(d3d_shader))
+        print_glsl_info_log(gl_info, shader, FALSE);
 }
 
 /* Context activation is done by the caller. */
@@ -612,6 +631,178 @@ void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint pro
     print_glsl_info_log(gl_info, program, TRUE);
 }
 
+struct glsl_attached_shader
+{
+    GLint type;
+    GLuint id;
+};
+
+static int glsl_attached_shader_compare(const void *a, const void *b)
+{
+    const struct glsl_attached_shader *sa = a, *sb = b;
+
+    return sa->type < sb->type ? -1 : sa->type > sb->type ? 1 : 0;
+}
+
+/* Build the on-disk program cache key for "program". The key is the driver
+ * identification followed by the source of each attached shader, in shader
+ * type order. Context activation is done by the caller. */
+static char *shader_glsl_get_program_cache_key(const struct wined3d_gl_info *gl_info,
+        GLuint program, SIZE_T *key_size)
+{
+    static const char *const strings[] = {"vendor", "renderer", "version"};
+    static const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION};
+    struct glsl_attached_shader *shaders;
+    GLint shader_count, length;
+    SIZE_T size, offset;
+    char *key, *new_key;
+    GLuint *ids;
+    const char *str;
+    unsigned int i;
+
+    GL_EXTCALL(glGetProgramiv(program, GL_ATTACHED_SHADERS, &shader_count));
+    if (shader_count <= 0 || !(ids = heap_calloc(shader_count, sizeof(*ids))))
+        return NULL;
+    if (!(shaders = heap_calloc(shader_count, sizeof(*shaders))))
+    {
+        heap_free(ids);
+        return NULL;
+    }
+    GL_EXTCALL(glGetAttachedShaders(program, shader_count, &shader_count, ids));
+    for (i = 0; i < shader_count; ++i)
+    {
+        shaders[i].id = ids[i];
+        GL_EXTCALL(glGetShaderiv(ids[i], GL_SHADER_TYPE, &shaders[i].type));
+    }
+    heap_free(ids);
+    qsort(shaders, shader_count, sizeof(*shaders), glsl_attached_shader_compare);
+
+    size = 0;
+    for (i = 0; i < ARRAY_SIZE(names); ++i)
+    {
+        if (!(str = (const char *)gl_info->gl_ops.gl.p_glGetString(names[i])))
+            str = "";
+        size += strlen(strings[i]) + strlen(str) + 2;
+    }
+    if (!(key = heap_alloc(size)))
+    {
+        heap_free(shaders);
+        return NULL;
+    }
+    for (i = 0, offset = 0; i < ARRAY_SIZE(names); ++i)
+    {
+        if (!(str = (const char *)gl_info->gl_ops.gl.p_glGetString(names[i])))
+            str = "";
+        offset += sprintf(key + offset, "%s %s", strings[i], str) + 1;
+    }
+
+    for (i = 0; i < shader_count; ++i)
+    {
+        GL_EXTCALL(glGetShaderiv(shaders[i].id, GL_SHADER_SOURCE_LENGTH, &length));
+        if (length <= 0 || !(new_key = heap_realloc(key, size + sizeof(shaders[i].type) + length)))
+        {
+            heap_free(key);
+            heap_free(shaders);
+            return NULL;
+        }
+        key = new_key;
+        memcpy(key + size, &shaders[i].type, sizeof(shaders[i].type));
+        size += sizeof(shaders[i].type);
+        GL_EXTCALL(glGetShaderSource(shaders[i].id, length, &length, key + size));
+        size += length;
+    }
+    checkGLcall("get program cache key");
+    heap_free(shaders);
+
+    *key_size = size;
+    return key;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_store_program_binary(const struct wined3d_gl_info *gl_info,
+        GLuint program, const char *key, SIZE_T key_size)
+{
+    GLint status, length;
+    GLsizei written = 0;
+    GLenum format;
+    void *data;
+
+    GL_EXTCALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+    GL_EXTCALL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    checkGLcall("get program binary length");
+    if (!status || length <= 0 || !(data = heap_alloc(length)))
+        return;
+
+    GL_EXTCALL(glGetProgramBinary(program, length, &written, &format, data));
+    checkGLcall("glGetProgramBinary");
+    if (written > 0)
+        wined3d_shader_cache_put(key, key_size, format, data, written);
+    heap_free(data);
+}
+
+/* Add the binary of a program linked by shader_glsl_link_program() with
+ * "async" set to the program cache. Context activation is done by the
+ * caller. */
+static void shader_glsl_cache_program_binary(const struct wined3d_gl_info *gl_info, GLuint program)
+{
+    SIZE_T key_size;
+    char *key;
+
+    if (!(key = shader_glsl_get_program_cache_key(gl_info, program, &key_size)))
+        return;
+    shader_glsl_store_program_binary(gl_info, program, key, key_size);
+    heap_free(key);
+}
+
+/* Link "program", going through the on-disk program cache if possible.
+ * Programs that use state not reflected in the shader sources, like
+ * transform feedback varyings, should not be cached. When "async" is set,
+ * this doesn't wait for the link to finish, and returns TRUE if the program
+ * binary should be passed to shader_glsl_cache_program_binary() once it
+ * has. Context activation is done by the caller. */
+static BOOL shader_glsl_link_program(const struct wined3d_gl_info *gl_info,
+        GLuint program, BOOL cacheable, BOOL async)
+{
+    SIZE_T key_size, data_size;
+    DWORD cached_format;
+    char *key = NULL;
+    GLint status;
+    void *data;
+
+    if (cacheable && gl_info->supported[ARB_GET_PROGRAM_BINARY] && wined3d_shader_cache_enabled())
+        key = shader_glsl_get_program_cache_key(gl_info, program, &key_size);
+
+    if (!key)
+    {
+        GL_EXTCALL(glLinkProgram(program));
+        return FALSE;
+    }
+
+    if (wined3d_shader_cache_get(key, key_size, &cached_format, &data, &data_size))
+    {
+        GL_EXTCALL(glProgramBinary(program, cached_format, data, data_size));
+        heap_free(data);
+        GL_EXTCALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+        checkGLcall("glProgramBinary");
+        if (status)
+        {
+            TRACE("Loaded program %u from the program cache.\n", program);
+            heap_free(key);
+            return FALSE;
+        }
+        WARN("Cached binary for program %u was rejected, relinking.\n", program);
+    }
+
+    GL_EXTCALL(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    GL_EXTCALL(glLinkProgram(program));
+    checkGLcall("glLinkProgram");
+    if (!async)
+        shader_glsl_store_program_binary(gl_info, program, key, key_size);
+    heap_free(key);
+
+    return async;
+}
+
 static BOOL shader_glsl_use_layout_qualifier(const struct wined3d_gl_info *gl_info)
 {
     /* Layout qualifiers were introduced in GLSL 1.40. The Nvidia Legacy GPU
@@ -7083,6 +7274,12 @@ static void delete_glsl_program_entry(struct shader_glsl_priv *priv, const struc
 {
     wine_rb_remove(&priv->program_lookup, &entry->program_lookup_entry);
 
+    if (entry->pending)
+    {
+        heap_free(entry->pending);
+        --priv->compile_stats->pending;
+    }
+
     GL_EXTCALL(glDeleteProgram(entry->id));
     if (entry->vs.id)
         list_remove(&entry->vs.shader_entry);
@@ -10428,6 +10625,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
     TRACE("Created new GLSL shader program %u.\n", program_id);
 
     entry->id = program_id;
+    entry->pending = NULL;
     entry->vs.id = 0;
     entry->hs.id = 0;
     entry->ds.id = 0;
@@ -10446,7 +10644,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
     list_add_head(&shader->linked_programs, &entry->cs.shader_entry);
 
     TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
+    shader_glsl_link_program(gl_info, program_id, TRUE, FALSE);
     shader_glsl_validate_link(gl_info, program_id);
 
     GL_EXTCALL(glUseProgram(program_id));
@@ -10506,13 +10704,208 @@ static void set_glsl_compute_shader_program(const struct wined3d_context *contex
     ctx_data->glsl_program = entry;
 }
 
+/* Context activation is done by the caller. */
+static void shader_glsl_init_program(const struct wined3d_context *context, struct shader_glsl_priv *priv,
+        struct glsl_shader_prog_link *entry, const struct wined3d_shader *vshader,
+        const struct wined3d_shader *hshader, const struct wined3d_shader *dshader,
+        const struct wined3d_shader *gshader, const struct wined3d_shader *pshader)
+{
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+    const struct wined3d_shader *pre_rasterization_shader;
+    GLuint program_id = entry->id;
+    unsigned int i;
+
+    shader_glsl_validate_link(gl_info, program_id);
+
+    shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
+            vshader ? vshader->limits->constant_float : 0);
+    shader_glsl_init_ds_uniform_locations(gl_info, priv, program_id, &entry->ds);
+    shader_glsl_init_gs_uniform_locations(gl_info, priv, program_id, &entry->gs);
+    shader_glsl_init_ps_uniform_locations(gl_info, priv, program_id, &entry->ps,
+            pshader ? pshader->limits->constant_float : 0);
+    checkGLcall("find glsl program uniform locations");
+
+    pre_rasterization_shader = gshader ? gshader : dshader ? dshader : vshader;
+    if (pre_rasterization_shader && pre_rasterization_shader->reg_maps.shader_version.major >= 4)
+    {
+        unsigned int clip_distance_count = wined3d_popcount(pre_rasterization_shader->reg_maps.clip_distance_mask);
+        entry->shader_controlled_clip_distances = 1;
+        entry->clip_distance_mask = (1u << clip_distance_count) - 1;
+    }
+
+    if (needs_legacy_glsl_syntax(gl_info))
+    {
+        if (pshader && pshader->reg_maps.shader_version.major >= 3
+                && pshader->u.ps.declared_in_count > vec4_varyings(3, gl_info))
+        {
+            TRACE("Shader %d needs vertex color clamping disabled.\n", program_id);
+            entry->vs.vertex_color_clamp = GL_FALSE;
+        }
+        else
+        {
+            entry->vs.vertex_color_clamp = GL_FIXED_ONLY_ARB;
+        }
+    }
+    else
+    {
+        /* With core profile we never change vertex_color_clamp from
+         * GL_FIXED_ONLY_MODE (which is also the initial value) so we never call
+         * glClampColorARB(). */
+        entry->vs.vertex_color_clamp = GL_FIXED_ONLY_ARB;
+    }
+
+    /* Set the shader to allow uniform loading on it */
+    GL_EXTCALL(glUseProgram(program_id));
+    checkGLcall("glUseProgram");
+
+    entry->constant_update_mask = 0;
+    if (vshader)
+    {
+        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_F;
+        if (vshader->reg_maps.integer_constants)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_I;
+        if (vshader->reg_maps.boolean_constants)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_B;
+        if (entry->vs.pos_fixup_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
+        if (entry->vs.base_vertex_id_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_BASE_VERTEX_ID;
+
+        shader_glsl_load_program_resources(context, priv, program_id, vshader);
+    }
+    else
+    {
+        entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_MODELVIEW
+                | WINED3D_SHADER_CONST_FFP_PROJ;
+
+        for (i = 1; i < MAX_VERTEX_BLENDS; ++i)
+        {
+            if (entry->vs.modelview_matrix_location[i] != -1)
+            {
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_VERTEXBLEND;
+                break;
+            }
+        }
+
+        for (i = 0; i < MAX_TEXTURES; ++i)
+        {
+            if (entry->vs.texture_matrix_location[i] != -1)
+            {
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_TEXMATRIX;
+                break;
+            }
+        }
+        if (entry->vs.material_ambient_location != -1 || entry->vs.material_diffuse_location != -1
+                || entry->vs.material_specular_location != -1
+                || entry->vs.material_emissive_location != -1
+                || entry->vs.material_shininess_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_MATERIAL;
+        if (entry->vs.light_ambient_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_LIGHTS;
+    }
+    if (entry->vs.clip_planes_location != -1)
+        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_CLIP_PLANES;
+    if (entry->vs.pointsize_min_location != -1)
+        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_POINTSIZE;
+
+    if (hshader)
+        shader_glsl_load_program_resources(context, priv, program_id, hshader);
+
+    if (dshader)
+    {
+        if (entry->ds.pos_fixup_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
+
+        shader_glsl_load_program_resources(context, priv, program_id, dshader);
+    }
+
+    if (gshader)
+    {
+        if (entry->gs.pos_fixup_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
+
+        shader_glsl_load_program_resources(context, priv, program_id, gshader);
+    }
+
+    if (entry->ps.id)
+    {
+        if (pshader)
+        {
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_F;
+            if (pshader->reg_maps.integer_constants)
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_I;
+            if (pshader->reg_maps.boolean_constants)
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_B;
+            if (entry->ps.ycorrection_location != -1)
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_Y_CORR;
+
+            shader_glsl_load_program_resources(context, priv, program_id, pshader);
+            shader_glsl_load_images(gl_info, priv, program_id, &pshader->reg_maps);
+        }
+        else
+        {
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_PS;
+
+            shader_glsl_load_samplers(context, priv, program_id, NULL);
+        }
+
+        for (i = 0; i < MAX_TEXTURES; ++i)
+        {
+            if (entry->ps.bumpenv_mat_location[i] != -1)
+            {
+                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_BUMP_ENV;
+                break;
+            }
+        }
+
+        if (entry->ps.fog_color_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_FOG;
+        if (entry->ps.alpha_test_ref_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_ALPHA_TEST;
+        if (entry->ps.np2_fixup_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_NP2_FIXUP;
+        if (entry->ps.color_key_location != -1)
+            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_COLOR_KEY;
+    }
+}
+
+/* Finish setting up a program linked asynchronously, if the driver is done
+ * linking it or "wait" is set. Context activation is done by the caller. */
+static BOOL shader_glsl_complete_program(const struct wined3d_context *context,
+        struct shader_glsl_priv *priv, struct glsl_shader_prog_link *entry, BOOL wait)
+{
+    const struct wined3d_gl_info *gl_info = context->gl_info;
+    struct glsl_pending_program *pending = entry->pending;
+    GLint status;
+
+    if (!wait)
+    {
+        GL_EXTCALL(glGetProgramiv(entry->id, GL_COMPLETION_STATUS_ARB, &status));
+        if (!status)
+            return FALSE;
+    }
+
+    TRACE("Program %u is ready.\n", entry->id);
+
+    if (pending->cache_binary)
+        shader_glsl_cache_program_binary(gl_info, entry->id);
+    shader_glsl_init_program(context, priv, entry, pending->vshader,
+            pending->hshader, pending->dshader, pending->gshader, pending->pshader);
+
+    entry->pending = NULL;
+    heap_free(pending);
+    --priv->compile_stats->pending;
+    ++priv->compile_stats->completed;
+
+    return TRUE;
+}
+
 /* Context activation is done by the caller. */
 static void set_glsl_shader_program(const struct wined3d_context *context, const struct wined3d_state *state,
         struct shader_glsl_priv *priv, struct glsl_context_data *ctx_data)
 {
     const struct wined3d_d3d_info *d3d_info = context->d3d_info;
     const struct wined3d_gl_info *gl_info = context->gl_info;
-    const struct wined3d_shader *pre_rasterization_shader;
     const struct ps_np2fixup_info *np2fixup_info = NULL;
     struct wined3d_shader *hshader, *dshader, *gshader;
     struct glsl_shader_prog_link *entry = NULL;
@@ -10531,6 +10924,7 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
     WORD old_fpu_cw;
     WORD attribs_map;
     struct wined3d_string_buffer *tmp_name;
+    BOOL cache_binary;
 
     if (!(context->shader_update_mask & (1u << WINED3D_SHADER_TYPE_VERTEX)) && ctx_data->glsl_program)
     {
@@ -10648,6 +11042,7 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
     /* Create the entry */
     entry = heap_alloc(sizeof(*entry));
     entry->id = program_id;
+    entry->pending = NULL;
     entry->vs.id = vs_id;
     entry->hs.id = hs_id;
     entry->ds.id = ds_id;
@@ -10785,163 +11180,30 @@ static void set_glsl_shader_program(const struct wined3d_context *context, const
     if (old_fpu_cw != WINED3D_DEFAULT_FPU_CW)
         wined3d_set_fpu_cw(WINED3D_DEFAULT_FPU_CW);
 
-    GL_EXTCALL(glLinkProgram(program_id));
+    cache_binary = shader_glsl_link_program(gl_info, program_id,
+            !gshader || !gshader->u.gs.so_desc.element_count, priv->async_compile);
 
     if (old_fpu_cw != WINED3D_DEFAULT_FPU_CW)
         wined3d_set_fpu_cw(old_fpu_cw);
 
-    shader_glsl_validate_link(gl_info, program_id);
-
-    shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
-            vshader ? vshader->limits->constant_float : 0);
-    shader_glsl_init_ds_uniform_locations(gl_info, priv, program_id, &entry->ds);
-    shader_glsl_init_gs_uniform_locations(gl_info, priv, program_id, &entry->gs);
-    shader_glsl_init_ps_uniform_locations(gl_info, priv, program_id, &entry->ps,
-            pshader ? pshader->limits->constant_float : 0);
-    checkGLcall("find glsl program uniform locations");
-
-    pre_rasterization_shader = gshader ? gshader : dshader ? dshader : vshader;
-    if (pre_rasterization_shader && pre_rasterization_shader->reg_maps.shader_version.major >= 4)
-    {
-        unsigned int clip_distance_count = wined3d_popcount(pre_rasterization_shader->reg_maps.clip_distance_mask);
-        entry->shader_controlled_clip_distances = 1;
-        entry->clip_distance_mask = (1u << clip_distance_count) - 1;
-    }
-
-    if (needs_legacy_glsl_syntax(gl_info))
-    {
-        if (pshader && pshader->reg_maps.shader_version.major >= 3
-                && pshader->u.ps.declared_in_count > vec4_varyings(3, gl_info))
-        {
-            TRACE("Shader %d needs vertex color clamping disabled.\n", program_id);
-            entry->vs.vertex_color_clamp = GL_FALSE;
-        }
-        else
-        {
-            entry->vs.vertex_color_clamp = GL_FIXED_ONLY_ARB;
-        }
-    }
-    else
-    {
-        /* With core profile we never change vertex_color_clamp from
-         * GL_FIXED_ONLY_MODE (which is also the initial value) so we never call
-         * glClampColorARB(). */
-        entry->vs.vertex_color_clamp = GL_FIXED_ONLY_ARB;
-    }
-
-    /* Set the shader to allow uniform loading on it */
-    GL_EXTCALL(glUseProgram(program_id));
-    checkGLcall("glUseProgram");
-
-    entry->constant_update_mask = 0;
-    if (vshader)
-    {
-        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_F;
-        if (vshader->reg_maps.integer_constants)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_I;
-        if (vshader->reg_maps.boolean_constants)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_B;
-        if (entry->vs.pos_fixup_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
-        if (entry->vs.base_vertex_id_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_BASE_VERTEX_ID;
-
-        shader_glsl_load_program_resources(context, priv, program_id, vshader);
-    }
-    else
-    {
-        entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_MODELVIEW
-                | WINED3D_SHADER_CONST_FFP_PROJ;
-
-        for (i = 1; i < MAX_VERTEX_BLENDS; ++i)
-        {
-            if (entry->vs.modelview_matrix_location[i] != -1)
-            {
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_VERTEXBLEND;
-                break;
-            }
-        }
-
-        for (i = 0; i < MAX_TEXTURES; ++i)
-        {
-            if (entry->vs.texture_matrix_location[i] != -1)
-            {
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_TEXMATRIX;
-                break;
-            }
-        }
-        if (entry->vs.material_ambient_location != -1 || entry->vs.material_diffuse_location != -1
-                || entry->vs.material_specular_location != -1
-                || entry->vs.material_emissive_location != -1
-                || entry->vs.material_shininess_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_MATERIAL;
-        if (entry->vs.light_ambient_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_LIGHTS;
-    }
-    if (entry->vs.clip_planes_location != -1)
-        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_CLIP_PLANES;
-    if (entry->vs.pointsize_min_location != -1)
-        entry->constant_update_mask |= WINED3D_SHADER_CONST_VS_POINTSIZE;
-
-    if (hshader)
-        shader_glsl_load_program_resources(context, priv, program_id, hshader);
-
-    if (dshader)
-    {
-        if (entry->ds.pos_fixup_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
-
-        shader_glsl_load_program_resources(context, priv, program_id, dshader);
-    }
-
-    if (gshader)
-    {
-        if (entry->gs.pos_fixup_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_POS_FIXUP;
-
-        shader_glsl_load_program_resources(context, priv, program_id, gshader);
+    /* With asynchronous compilation, querying anything about the program
+     * would wait for the driver to finish linking it. Defer that until
+     * shader_glsl_select() finds the program ready. */
+    if (priv->async_compile && (entry->pending = heap_alloc(sizeof(*entry->pending))))
+    {
+        entry->pending->vshader = vshader;
+        entry->pending->hshader = hshader;
+        entry->pending->dshader = dshader;
+        entry->pending->gshader = gshader;
+        entry->pending->pshader = pshader;
+        entry->pending->cache_binary = cache_binary;
+        ++priv->compile_stats->pending;
+        return;
     }
+    if (cache_binary)
+        shader_glsl_cache_program_binary(gl_info, program_id);
 
-    if (ps_id)
-    {
-        if (pshader)
-        {
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_F;
-            if (pshader->reg_maps.integer_constants)
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_I;
-            if (pshader->reg_maps.boolean_constants)
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_B;
-            if (entry->ps.ycorrection_location != -1)
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_Y_CORR;
-
-            shader_glsl_load_program_resources(context, priv, program_id, pshader);
-            shader_glsl_load_images(gl_info, priv, program_id, &pshader->reg_maps);
-        }
-        else
-        {
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_PS;
-
-            shader_glsl_load_samplers(context, priv, program_id, NULL);
-        }
-
-        for (i = 0; i < MAX_TEXTURES; ++i)
-        {
-            if (entry->ps.bumpenv_mat_location[i] != -1)
-            {
-                entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_BUMP_ENV;
-                break;
-            }
-        }
-
-        if (entry->ps.fog_color_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_FOG;
-        if (entry->ps.alpha_test_ref_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_ALPHA_TEST;
-        if (entry->ps.np2_fixup_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_PS_NP2_FIXUP;
-        if (entry->ps.color_key_location != -1)
-            entry->constant_update_mask |= WINED3D_SHADER_CONST_FFP_COLOR_KEY;
-    }
+    shader_glsl_init_program(context, priv, entry, vshader, hshader, dshader, gshader, pshader);
 }
 
 static void shader_glsl_precompile(void *shader_priv, struct wined3d_shader *shader)
@@ -10975,6 +11237,15 @@ static void shader_glsl_select(void *shader_priv, struct wined3d_context *contex
     set_glsl_shader_program(context, state, priv, ctx_data);
     glsl_program = ctx_data->glsl_program;
 
+    context->shader_program_pending = 0;
+    if (glsl_program && glsl_program->pending
+            && !shader_glsl_complete_program(context, priv, glsl_program, context->shader_program_wait))
+    {
+        TRACE("Program %u is not ready yet.\n", glsl_program->id);
+        ctx_data->glsl_program = glsl_program = NULL;
+        context->shader_program_pending = 1;
+    }
+
     if (glsl_program)
     {
         program_id = glsl_program->id;
@@ -11340,6 +11611,10 @@ static HRESULT shader_glsl_alloc(struct wined3d_device *device, const struct win
 
     string_buffer_list_init(&priv->string_buffers);
 
+    priv->async_compile = wined3d_settings.async_shader_compile != WINED3D_ASYNC_SHADER_DISABLED
+            && gl_info->supported[ARB_PARALLEL_SHADER_COMPILE];
+    priv->compile_stats = &device->shader_compile_stats;
+
     if (!(vertex_priv = vertex_pipe->vp_alloc(&glsl_shader_backend, priv)))
     {
         ERR("Failed to initialize vertex pipe.\n");
@@ -379,6 +379,11 @@ HRESULT CDECL wined3d_resource_map(struct wined3d_resource *resource, unsigned i
     }
 
     flags = wined3d_resource_sanitise_map_flags(resource, flags);
+
+    if (resource->type == WINED3D_RTYPE_BUFFER && !sub_resource_idx
+            && wined3d_buffer_map_persistent(buffer_from_resource(resource), map_desc, box, flags))
+        return WINED3D_OK;
+
     wined3d_resource_wait_idle(resource);
 
     return wined3d_cs_map(resource->device->cs, resource, sub_resource_idx, map_desc, box, flags);
@@ -388,6 +393,10 @@ HRESULT CDECL wined3d_resource_unmap(struct wined3d_resource *resource, unsigned
 {
     TRACE("resource %p, sub_resource_idx %u.\n", resource, sub_resource_idx);
 
+    if (resource->type == WINED3D_RTYPE_BUFFER && !sub_resource_idx
+            && wined3d_buffer_unmap_persistent(buffer_from_resource(resource)))
+        return WINED3D_OK;
+
     return wined3d_cs_unmap(resource->device->cs, resource, sub_resource_idx);
 }
 
@@ -0,0 +1,532 @@
+/*
+ * On-disk cache of linked shader program binaries
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/*
+ * Each cached program lives in its own file, named after a 64-bit hash of
+ * the lookup key. The file starts with a small versioned header, followed
+ * by the complete key and the program binary. The key is compared in full
+ * on lookup, so hash collisions only cost a cache miss. The key already
+ * contains the driver identification, so a driver update simply results in
+ * misses for the stale entries, which are eventually evicted.
+ *
+ * Entries are kept in least-recently-used order. The file modification time
+ * is updated on every hit, which allows the order to be reconstructed by
+ * the next process using the cache. When adding an entry would make the
+ * cache exceed its size limit, the least recently used entries are deleted.
+ *
+ * Hit and miss counters are reported on the "d3d_progcache" debug channel.
+ */
+
+#include "config.h"
+#include "wine/port.h"
+
+#include <stdio.h>
+
+#include "wined3d_private.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(d3d_progcache);
+
+#define WINED3D_SHADER_CACHE_MAGIC      0x43533357 /* "W3SC" */
+#define WINED3D_SHADER_CACHE_VERSION    1
+
+struct wined3d_shader_cache_header
+{
+    DWORD magic;
+    DWORD version;
+    DWORD key_size;
+    DWORD format;
+    DWORD data_size;
+    DWORD checksum;
+};
+
+struct wined3d_shader_cache_entry
+{
+    struct wine_rb_entry entry;
+    struct list lru_entry;
+    ULONG64 hash;
+    SIZE_T file_size;
+    ULONGLONG access_time;
+};
+
+static struct
+{
+    BOOL initialised;
+    BOOL enabled;
+    char path[MAX_PATH];
+    SIZE_T max_size;
+    SIZE_T total_size;
+    struct wine_rb_tree entries;
+    struct list lru;
+    unsigned int hits, misses, stores, evictions;
+} shader_cache;
+
+static CRITICAL_SECTION shader_cache_cs;
+static CRITICAL_SECTION_DEBUG shader_cache_cs_debug =
+{
+    0, 0, &shader_cache_cs,
+    {&shader_cache_cs_debug.ProcessLocksList,
+    &shader_cache_cs_debug.ProcessLocksList},
+    0, 0, {(DWORD_PTR)(__FILE__ ": shader_cache_cs")}
+};
+static CRITICAL_SECTION shader_cache_cs = {&shader_cache_cs_debug, -1, 0, 0, 0, 0};
+
+static int wined3d_shader_cache_entry_compare(const void *key, const struct wine_rb_entry *entry)
+{
+    const struct wined3d_shader_cache_entry *e = WINE_RB_ENTRY_VALUE(entry,
+            struct wined3d_shader_cache_entry, entry);
+    ULONG64 hash = *(const ULONG64 *)key;
+
+    return hash < e->hash ? -1 : hash > e->hash ? 1 : 0;
+}
+
+/* 64-bit FNV-1a. */
+static ULONG64 wined3d_shader_cache_hash(const void *data, SIZE_T size)
+{
+    const BYTE *p = data;
+    ULONG64 hash = 0xcbf29ce484222325ull;
+    SIZE_T i;
+
+    for (i = 0; i < size; ++i)
+    {
+        hash ^= p[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+static DWORD wined3d_shader_cache_checksum(const void *data, SIZE_T size)
+{
+    ULONG64 hash = wined3d_shader_cache_hash(data, size);
+
+    return (DWORD)(hash ^ (hash >> 32));
+}
+
+static void wined3d_shader_cache_get_file_name(ULONG64 hash, const char *extension, char *name)
+{
+    snprintf(name, MAX_PATH, "%s\\%08x%08x.%s", shader_cache.path,
+            (unsigned int)(hash >> 32), (unsigned int)hash, extension);
+}
+
+static ULONGLONG wined3d_shader_cache_current_time(void)
+{
+    ULARGE_INTEGER time;
+    FILETIME ft;
+
+    GetSystemTimeAsFileTime(&ft);
+    time.u.LowPart = ft.dwLowDateTime;
+    time.u.HighPart = ft.dwHighDateTime;
+
+    return time.QuadPart;
+}
+
+static void wined3d_shader_cache_remove_entry(struct wined3d_shader_cache_entry *entry, BOOL delete_file)
+{
+    char name[MAX_PATH];
+
+    if (delete_file)
+    {
+        wined3d_shader_cache_get_file_name(entry->hash, "bin", name);
+        if (!DeleteFileA(name))
+            WARN("Failed to delete %s, error %u.\n", debugstr_a(name), GetLastError());
+    }
+
+    wine_rb_remove(&shader_cache.entries, &entry->entry);
+    list_remove(&entry->lru_entry);
+    shader_cache.total_size -= entry->file_size;
+    heap_free(entry);
+}
+
+static struct wined3d_shader_cache_entry *wined3d_shader_cache_add_entry(ULONG64 hash,
+        SIZE_T file_size, ULONGLONG access_time)
+{
+    struct wined3d_shader_cache_entry *entry;
+
+    if (!(entry = heap_alloc(sizeof(*entry))))
+        return NULL;
+
+    entry->hash = hash;
+    entry->file_size = file_size;
+    entry->access_time = access_time;
+    if (wine_rb_put(&shader_cache.entries, &entry->hash, &entry->entry) == -1)
+    {
+        heap_free(entry);
+        return NULL;
+    }
+    list_add_tail(&shader_cache.lru, &entry->lru_entry);
+    shader_cache.total_size += file_size;
+
+    return entry;
+}
+
+static void wined3d_shader_cache_evict(SIZE_T required_size)
+{
+    struct wined3d_shader_cache_entry *entry;
+    struct list *head;
+
+    while (shader_cache.total_size + required_size > shader_cache.max_size
+            && (head = list_head(&shader_cache.lru)))
+    {
+        entry = LIST_ENTRY(head, struct wined3d_shader_cache_entry, lru_entry);
+        TRACE("Evicting entry %s, %lu bytes.\n", wine_dbgstr_longlong(entry->hash), entry->file_size);
+        wined3d_shader_cache_remove_entry(entry, TRUE);
+        ++shader_cache.evictions;
+    }
+}
+
+static BOOL wined3d_shader_cache_create_directory(char *path)
+{
+    char *p;
+
+    for (p = path; *p; ++p)
+    {
+        if (*p != '\\' || p == path || p[-1] == ':')
+            continue;
+        *p = 0;
+        CreateDirectoryA(path, NULL);
+        *p = '\\';
+    }
+
+    return CreateDirectoryA(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+}
+
+static int wined3d_shader_cache_entry_time_compare(const void *a, const void *b)
+{
+    const struct wined3d_shader_cache_entry *ea = a, *eb = b;
+
+    return ea->access_time < eb->access_time ? -1 : ea->access_time > eb->access_time ? 1 : 0;
+}
+
+static void wined3d_shader_cache_scan(void)
+{
+    struct wined3d_shader_cache_entry *found = NULL;
+    SIZE_T found_size = 0, found_count = 0, i;
+    char pattern[MAX_PATH], name[MAX_PATH];
+    WIN32_FIND_DATAA data;
+    unsigned int high, low;
+    ULARGE_INTEGER time;
+    HANDLE handle;
+
+    snprintf(pattern, sizeof(pattern), "%s\\*.bin", shader_cache.path);
+    if ((handle = FindFirstFileA(pattern, &data)) == INVALID_HANDLE_VALUE)
+        return;
+
+    do
+    {
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            continue;
+        if (strlen(data.cFileName) != 20 || sscanf(data.cFileName, "%8x%8x.bin", &high, &low) != 2)
+            continue;
+        if (data.nFileSizeHigh)
+        {
+            snprintf(name, sizeof(name), "%s\\%s", shader_cache.path, data.cFileName);
+            DeleteFileA(name);
+            continue;
+        }
+        if (!wined3d_array_reserve((void **)&found, &found_size, found_count + 1, sizeof(*found)))
+            break;
+        time.u.LowPart = data.ftLastWriteTime.dwLowDateTime;
+        time.u.HighPart = data.ftLastWriteTime.dwHighDateTime;
+        found[found_count].hash = ((ULONG64)high << 32) | low;
+        found[found_count].file_size = data.nFileSizeLow;
+        found[found_count].access_time = time.QuadPart;
+        ++found_count;
+    } while (FindNextFileA(handle, &data));
+    FindClose(handle);
+
+    /* Add the entries oldest first, so that the LRU list ends up in the
+     * right order. */
+    qsort(found, found_count, sizeof(*found), wined3d_shader_cache_entry_time_compare);
+    for (i = 0; i < found_count; ++i)
+        wined3d_shader_cache_add_entry(found[i].hash, found[i].file_size, found[i].access_time);
+    heap_free(found);
+
+    TRACE("Found %lu entries, %lu bytes.\n", found_count, shader_cache.total_size);
+
+    /* The limit may have been lowered since the cache was last used. */
+    wined3d_shader_cache_evict(0);
+}
+
+/* Called with the shader cache lock held. */
+static BOOL wined3d_shader_cache_init(void)
+{
+    DWORD len;
+
+    if (shader_cache.initialised)
+        return shader_cache.enabled;
+    shader_cache.initialised = TRUE;
+
+    wine_rb_init(&shader_cache.entries, wined3d_shader_cache_entry_compare);
+    list_init(&shader_cache.lru);
+
+    if (!wined3d_settings.shader_cache_size)
+    {
+        TRACE("Shader cache disabled.\n");
+        return FALSE;
+    }
+    shader_cache.max_size = (SIZE_T)min(wined3d_settings.shader_cache_size, 1024) * 1024 * 1024;
+
+    if (wined3d_settings.shader_cache_path)
+    {
+        if (strlen(wined3d_settings.shader_cache_path) >= sizeof(shader_cache.path) - 32)
+        {
+            WARN("Shader cache path %s is too long.\n", debugstr_a(wined3d_settings.shader_cache_path));
+            return FALSE;
+        }
+        strcpy(shader_cache.path, wined3d_settings.shader_cache_path);
+    }
+    else
+    {
+        len = ExpandEnvironmentStringsA("%LOCALAPPDATA%\\wine\\wined3d_shader_cache",
+                shader_cache.path, sizeof(shader_cache.path) - 32);
+        if (!len || len > sizeof(shader_cache.path) - 32 || shader_cache.path[0] == '%')
+        {
+            WARN("Failed to determine the shader cache path.\n");
+            return FALSE;
+        }
+    }
+    len = strlen(shader_cache.path);
+    while (len && (shader_cache.path[len - 1] == '\\' || shader_cache.path[len - 1] == '/'))
+        shader_cache.path[--len] = 0;
+
+    if (!wined3d_shader_cache_create_directory(shader_cache.path))
+    {
+        WARN("Failed to create shader cache directory %s, error %u.\n",
+                debugstr_a(shader_cache.path), GetLastError());
+        return FALSE;
+    }
+
+    TRACE("Using shader cache %s, limit %lu bytes.\n", debugstr_a(shader_cache.path), shader_cache.max_size);
+    wined3d_shader_cache_scan();
+
+    return shader_cache.enabled = TRUE;
+}
+
+static BOOL wined3d_shader_cache_read(HANDLE file, void *data, DWORD size)
+{
+    DWORD read;
+
+    return ReadFile(file, data, size, &read, NULL) && read == size;
+}
+
+static BOOL wined3d_shader_cache_load(struct wined3d_shader_cache_entry *entry, const void *key, SIZE_T key_size,
+        DWORD *format, void **data, SIZE_T *data_size)
+{
+    struct wined3d_shader_cache_header header;
+    char name[MAX_PATH];
+    FILETIME ft;
+    BOOL ret = FALSE;
+    void *file_key;
+    HANDLE file;
+
+    wined3d_shader_cache_get_file_name(entry->hash, "bin", name);
+    if ((file = CreateFileA(name, GENERIC_READ | FILE_WRITE_ATTRIBUTES,
+            FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL)) == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    if (!wined3d_shader_cache_read(file, &header, sizeof(header)))
+        goto done;
+    if (header.magic != WINED3D_SHADER_CACHE_MAGIC || header.version != WINED3D_SHADER_CACHE_VERSION)
+    {
+        TRACE("Entry %s has an unsupported version.\n", wine_dbgstr_longlong(entry->hash));
+        goto done;
+    }
+    if (header.key_size != key_size || !header.data_size
+            || GetFileSize(file, NULL) != sizeof(header) + header.key_size + header.data_size)
+        goto done;
+
+    if (!(file_key = heap_alloc(key_size)))
+        goto done;
+    if (!wined3d_shader_cache_read(file, file_key, key_size) || memcmp(file_key, key, key_size))
+    {
+        TRACE("Key mismatch for entry %s.\n", wine_dbgstr_longlong(entry->hash));
+        heap_free(file_key);
+        goto done;
+    }
+    heap_free(file_key);
+
+    if (!(*data = heap_alloc(header.data_size)))
+        goto done;
+    if (!wined3d_shader_cache_read(file, *data, header.data_size)
+            || wined3d_shader_cache_checksum(*data, header.data_size) != header.checksum)
+    {
+        WARN("Entry %s is corrupted.\n", wine_dbgstr_longlong(entry->hash));
+        heap_free(*data);
+        *data = NULL;
+        goto done;
+    }
+    *format = header.format;
+    *data_size = header.data_size;
+
+    entry->access_time = wined3d_shader_cache_current_time();
+    ft.dwLowDateTime = (DWORD)entry->access_time;
+    ft.dwHighDateTime = (DWORD)(entry->access_time >> 32);
+    SetFileTime(file, NULL, NULL, &ft);
+    ret = TRUE;
+
+done:
+    CloseHandle(file);
+    return ret;
+}
+
+BOOL wined3d_shader_cache_get(const void *key, SIZE_T key_size, DWORD *format, void **data, SIZE_T *data_size)
+{
+    struct wined3d_shader_cache_entry *entry;
+    struct wine_rb_entry *rb_entry;
+    ULONG64 hash;
+    BOOL ret;
+
+    EnterCriticalSection(&shader_cache_cs);
+
+    if (!wined3d_shader_cache_init())
+    {
+        LeaveCriticalSection(&shader_cache_cs);
+        return FALSE;
+    }
+
+    hash = wined3d_shader_cache_hash(key, key_size);
+    if (!(rb_entry = wine_rb_get(&shader_cache.entries, &hash)))
+    {
+        ret = FALSE;
+    }
+    else
+    {
+        entry = WINE_RB_ENTRY_VALUE(rb_entry, struct wined3d_shader_cache_entry, entry);
+        if ((ret = wined3d_shader_cache_load(entry, key, key_size, format, data, data_size)))
+        {
+            list_remove(&entry->lru_entry);
+            list_add_tail(&shader_cache.lru, &entry->lru_entry);
+        }
+        else
+        {
+            /* Stale or damaged; the caller is going to store a new binary
+             * under the same hash. */
+            wined3d_shader_cache_remove_entry(entry, TRUE);
+        }
+    }
+
+    if (ret)
+        ++shader_cache.hits;
+    else
+        ++shader_cache.misses;
+    TRACE("%s %s, %u hits, %u misses.\n", ret ? "Hit" : "Miss",
+            wine_dbgstr_longlong(hash), shader_cache.hits, shader_cache.misses);
+
+    LeaveCriticalSection(&shader_cache_cs);
+
+    return ret;
+}
+
+void wined3d_shader_cache_put(const void *key, SIZE_T key_size, DWORD format, const void *data, SIZE_T data_size)
+{
+    struct wined3d_shader_cache_header header;
+    char name[MAX_PATH], tmp_name[MAX_PATH];
+    struct wined3d_shader_cache_entry *entry;
+    struct wine_rb_entry *rb_entry;
+    SIZE_T file_size;
+    DWORD written;
+    ULONG64 hash;
+    HANDLE file;
+    BOOL ret;
+
+    EnterCriticalSection(&shader_cache_cs);
+
+    if (!wined3d_shader_cache_init())
+        goto done;
+
+    file_size = sizeof(header) + key_size + data_size;
+    if (key_size > ~0u || data_size > ~0u || file_size > shader_cache.max_size)
+    {
+        TRACE("Not caching %lu bytes.\n", file_size);
+        goto done;
+    }
+
+    hash = wined3d_shader_cache_hash(key, key_size);
+    if ((rb_entry = wine_rb_get(&shader_cache.entries, &hash)))
+        wined3d_shader_cache_remove_entry(WINE_RB_ENTRY_VALUE(rb_entry,
+                struct wined3d_shader_cache_entry, entry), FALSE);
+    wined3d_shader_cache_evict(file_size);
+
+    header.magic = WINED3D_SHADER_CACHE_MAGIC;
+    header.version = WINED3D_SHADER_CACHE_VERSION;
+    header.key_size = key_size;
+    header.format = format;
+    header.data_size = data_size;
+    header.checksum = wined3d_shader_cache_checksum(data, data_size);
+
+    /* Write to a temporary file first, so that other processes never see a
+     * partially written entry. */
+    snprintf(tmp_name, sizeof(tmp_name), "%s\\%08x%08x.%04x.tmp", shader_cache.path,
+            (unsigned int)(hash >> 32), (unsigned int)hash, (unsigned int)GetCurrentProcessId());
+    if ((file = CreateFileA(tmp_name, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL)) == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to create %s, error %u.\n", debugstr_a(tmp_name), GetLastError());
+        goto done;
+    }
+    ret = WriteFile(file, &header, sizeof(header), &written, NULL) && written == sizeof(header)
+            && WriteFile(file, key, key_size, &written, NULL) && written == key_size
+            && WriteFile(file, data, data_size, &written, NULL) && written == data_size;
+    CloseHandle(file);
+
+    wined3d_shader_cache_get_file_name(hash, "bin", name);
+    if (!ret || !MoveFileExA(tmp_name, name, MOVEFILE_REPLACE_EXISTING))
+    {
+        WARN("Failed to write %s, error %u.\n", debugstr_a(name), GetLastError());
+        DeleteFileA(tmp_name);
+        goto done;
+    }
+
+    if ((entry = wined3d_shader_cache_add_entry(hash, file_size, wined3d_shader_cache_current_time())))
+    {
+        ++shader_cache.stores;
+        TRACE("Stored %s, %lu bytes, %u stores, %u evictions.\n", wine_dbgstr_longlong(hash),
+                file_size, shader_cache.stores, shader_cache.evictions);
+    }
+
+done:
+    LeaveCriticalSection(&shader_cache_cs);
+}
+
+BOOL wined3d_shader_cache_enabled(void)
+{
+    BOOL ret;
+
+    EnterCriticalSection(&shader_cache_cs);
+    ret = wined3d_shader_cache_init();
+    LeaveCriticalSection(&shader_cache_cs);
+
+    return ret;
+}
+
+static void wined3d_shader_cache_free_entry(struct wine_rb_entry *entry, void *context)
+{
+    heap_free(WINE_RB_ENTRY_VALUE(entry, struct wined3d_shader_cache_entry, entry));
+}
+
+void wined3d_shader_cache_cleanup(void)
+{
+    if (!shader_cache.initialised)
+        return;
+
+    TRACE("%u hits, %u misses, %u stores, %u evictions.\n", shader_cache.hits,
+            shader_cache.misses, shader_cache.stores, shader_cache.evictions);
+
+    wine_rb_destroy(&shader_cache.entries, wined3d_shader_cache_free_entry, NULL);
+    memset(&shader_cache, 0, sizeof(shader_cache));
+    DeleteCriticalSection(&shader_cache_cs);
+}
@@ -33,6 +33,38 @@
 @ cdecl wined3d_buffer_get_resource(ptr)
 @ cdecl wined3d_buffer_incref(ptr)
 
+@ cdecl wined3d_command_list_decref(ptr)
+@ cdecl wined3d_command_list_incref(ptr)
+
+@ cdecl wined3d_deferred_context_clear_rendertarget_view(ptr ptr ptr long ptr float long)
+@ cdecl wined3d_deferred_context_copy_resource(ptr ptr ptr)
+@ cdecl wined3d_deferred_context_copy_sub_resource_region(ptr ptr long long long long ptr long ptr)
+@ cdecl wined3d_deferred_context_create(ptr ptr)
+@ cdecl wined3d_deferred_context_destroy(ptr)
+@ cdecl wined3d_deferred_context_dispatch(ptr long long long)
+@ cdecl wined3d_deferred_context_draw(ptr long long long long long long)
+@ cdecl wined3d_deferred_context_execute_command_list(ptr ptr)
+@ cdecl wined3d_deferred_context_record_command_list(ptr long ptr)
+@ cdecl wined3d_deferred_context_set_blend_state(ptr ptr ptr)
+@ cdecl wined3d_deferred_context_set_constant_buffer(ptr long long ptr)
+@ cdecl wined3d_deferred_context_set_cs_uav(ptr long ptr long)
+@ cdecl wined3d_deferred_context_set_depth_stencil_view(ptr ptr)
+@ cdecl wined3d_deferred_context_set_index_buffer(ptr ptr long long)
+@ cdecl wined3d_deferred_context_set_primitive_type(ptr long long)
+@ cdecl wined3d_deferred_context_set_rasterizer_state(ptr ptr)
+@ cdecl wined3d_deferred_context_set_render_state(ptr long long)
+@ cdecl wined3d_deferred_context_set_rendertarget_view(ptr long ptr)
+@ cdecl wined3d_deferred_context_set_sampler(ptr long long ptr)
+@ cdecl wined3d_deferred_context_set_scissor_rects(ptr long ptr)
+@ cdecl wined3d_deferred_context_set_shader(ptr long ptr)
+@ cdecl wined3d_deferred_context_set_shader_resource_view(ptr long long ptr)
+@ cdecl wined3d_deferred_context_set_stream_output(ptr long ptr long)
+@ cdecl wined3d_deferred_context_set_stream_source(ptr long ptr long long)
+@ cdecl wined3d_deferred_context_set_unordered_access_view(ptr long ptr long)
+@ cdecl wined3d_deferred_context_set_vertex_declaration(ptr ptr)
+@ cdecl wined3d_deferred_context_set_viewports(ptr long ptr)
+@ cdecl wined3d_deferred_context_update_sub_resource(ptr ptr long ptr ptr long long)
+
 @ cdecl wined3d_device_acquire_focus_window(ptr ptr)
 @ cdecl wined3d_device_begin_scene(ptr)
 @ cdecl wined3d_device_begin_stateblock(ptr)
@@ -55,6 +87,7 @@
 @ cdecl wined3d_device_end_scene(ptr)
 @ cdecl wined3d_device_end_stateblock(ptr ptr)
 @ cdecl wined3d_device_evict_managed_resources(ptr)
+@ cdecl wined3d_device_execute_command_list(ptr ptr)
 @ cdecl wined3d_device_get_available_texture_mem(ptr)
 @ cdecl wined3d_device_get_base_vertex_index(ptr)
 @ cdecl wined3d_device_get_blend_state(ptr ptr)
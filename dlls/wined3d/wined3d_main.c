@@ -90,6 +90,9 @@ struct wined3d_settings wined3d_settings =
     ~0U,            /* No PS shader model limit by default. */
     ~0u,            /* No CS shader model limit by default. */
     FALSE,          /* 3D support enabled by default. */
+    0,              /* No on-disk GLSL program cache by default. */
+    NULL,           /* Default shader cache location. */
+    WINED3D_ASYNC_SHADER_DISABLED, /* Compile shaders synchronously by default. */
 };
 
 /* CXGames hacks, not in the main wined3d configuration settings */
@@ -371,6 +374,30 @@ static BOOL wined3d_dll_init(HINSTANCE hInstDLL)
             TRACE("Disabling 3D support.\n");
             wined3d_settings.no_3d = TRUE;
         }
+        if (!get_config_key_dword(hkey, appkey, "ShaderCacheSize", &wined3d_settings.shader_cache_size))
+            TRACE("Using an on-disk shader cache of up to %u MiB.\n", wined3d_settings.shader_cache_size);
+        if (!get_config_key(hkey, appkey, "ShaderCachePath", buffer, size))
+        {
+            size_t len = strlen(buffer) + 1;
+
+            if (!(wined3d_settings.shader_cache_path = heap_alloc(len)))
+                ERR("Failed to allocate shader cache path memory.\n");
+            else
+                memcpy(wined3d_settings.shader_cache_path, buffer, len);
+        }
+        if (!get_config_key(hkey, appkey, "AsyncShaderCompile", buffer, size))
+        {
+            if (!strcmp(buffer, "skip"))
+            {
+                ERR_(winediag)("Compiling shaders asynchronously, skipping draws until they are ready.\n");
+                wined3d_settings.async_shader_compile = WINED3D_ASYNC_SHADER_SKIP;
+            }
+            else if (!strcmp(buffer, "wait"))
+            {
+                TRACE("Compiling shaders asynchronously, waiting for them before drawing.\n");
+                wined3d_settings.async_shader_compile = WINED3D_ASYNC_SHADER_WAIT;
+            }
+        }
         /* CodeWeavers Hack bug 5501 - Allow registry disabling of OpenGL extensions. */
         if (!get_config_key(hkey, appkey, "DisabledExtensions", buffer, size))
         {
@@ -439,7 +466,9 @@ static BOOL wined3d_dll_destroy(HINSTANCE hInstDLL)
     }
     heap_free(wndproc_table.entries);
 
+    wined3d_shader_cache_cleanup();
     heap_free(wined3d_settings.logo);
+    heap_free(wined3d_settings.shader_cache_path);
     heap_free(cxgames_hacks.disabled_extensions);
     UnregisterClassA(WINED3D_OPENGL_WINDOW_CLASS_NAME, hInstDLL);
 
@@ -384,6 +384,13 @@ static inline void wined3d_pause(void)
 
 /* NOTE: When adding fields to this structure, make sure to update the default
  * values in wined3d_main.c as well. */
+enum wined3d_async_shader_mode
+{
+    WINED3D_ASYNC_SHADER_DISABLED,
+    WINED3D_ASYNC_SHADER_SKIP,
+    WINED3D_ASYNC_SHADER_WAIT,
+};
+
 struct wined3d_settings
 {
     unsigned int cs_multithreaded;
@@ -405,6 +412,9 @@ struct wined3d_settings
     unsigned int max_sm_ps;
     unsigned int max_sm_cs;
     BOOL no_3d;
+    unsigned int shader_cache_size;
+    char *shader_cache_path;
+    enum wined3d_async_shader_mode async_shader_compile;
 };
 
 extern struct wined3d_settings wined3d_settings DECLSPEC_HIDDEN;
@@ -1737,6 +1747,8 @@ struct wined3d_fence
 HRESULT wined3d_fence_create(struct wined3d_device *device, struct wined3d_fence **fence) DECLSPEC_HIDDEN;
 void wined3d_fence_destroy(struct wined3d_fence *fence) DECLSPEC_HIDDEN;
 void wined3d_fence_issue(struct wined3d_fence *fence, const struct wined3d_device *device) DECLSPEC_HIDDEN;
+enum wined3d_fence_result wined3d_fence_test(const struct wined3d_fence *fence,
+        const struct wined3d_device *device, DWORD flags) DECLSPEC_HIDDEN;
 enum wined3d_fence_result wined3d_fence_wait(const struct wined3d_fence *fence,
         const struct wined3d_device *device) DECLSPEC_HIDDEN;
 
@@ -1950,7 +1962,9 @@ struct wined3d_context
     DWORD shader_update_mask : 6; /* WINED3D_SHADER_TYPE_COUNT, 6 */
     DWORD clip_distance_mask : 8; /* MAX_CLIP_DISTANCES, 8 */
     DWORD num_untracked_materials : 2;  /* Max value 2 */
-    DWORD padding : 7;
+    DWORD shader_program_pending : 1;
+    DWORD shader_program_wait : 1;
+    DWORD padding : 5;
 
     DWORD constant_update_mask;
     DWORD numbered_array_mask;
@@ -2994,6 +3008,15 @@ struct wined3d_dummy_textures
 
 #define WINED3D_UNMAPPED_STAGE ~0u
 
+/* Per-frame asynchronous shader compilation statistics. Only accessed from
+ * the CS thread. */
+struct wined3d_shader_compile_stats
+{
+    unsigned int pending;
+    unsigned int completed;
+    unsigned int skipped_draws;
+};
+
 /* Multithreaded flag. Removed from the public header to signal that
  * wined3d_device_create() ignores it. */
 #define WINED3DCREATE_MULTITHREADED 0x00000004
@@ -3045,6 +3068,7 @@ struct wined3d_device
     struct wined3d_swapchain **swapchains;
     UINT swapchain_count;
     unsigned int max_frame_latency;
+    struct wined3d_shader_compile_stats shader_compile_stats;
 
     struct list             resources; /* a linked list to track resources created by the device */
     struct list             shaders;   /* a linked list to track shaders (pixel and vertex)      */
@@ -3083,6 +3107,16 @@ void device_clear_render_targets(struct wined3d_device *device, UINT rt_count, c
         const struct wined3d_color *color, float depth, DWORD stencil) DECLSPEC_HIDDEN;
 BOOL device_context_add(struct wined3d_device *device, struct wined3d_context *context) DECLSPEC_HIDDEN;
 void device_context_remove(struct wined3d_device *device, struct wined3d_context *context) DECLSPEC_HIDDEN;
+HRESULT device_clear_rendertarget_view(struct wined3d_cs *cs, struct wined3d_rendertarget_view *view,
+        const RECT *rect, DWORD flags, const struct wined3d_color *color, float depth, DWORD stencil) DECLSPEC_HIDDEN;
+void device_copy_resource(struct wined3d_cs *cs, struct wined3d_resource *dst_resource,
+        struct wined3d_resource *src_resource) DECLSPEC_HIDDEN;
+HRESULT device_copy_sub_resource_region(struct wined3d_cs *cs, struct wined3d_resource *dst_resource,
+        unsigned int dst_sub_resource_idx, unsigned int dst_x, unsigned int dst_y, unsigned int dst_z,
+        struct wined3d_resource *src_resource, unsigned int src_sub_resource_idx,
+        const struct wined3d_box *src_box) DECLSPEC_HIDDEN;
+BOOL device_get_update_box(struct wined3d_resource *resource, unsigned int sub_resource_idx,
+        const struct wined3d_box *box, struct wined3d_box *out_box) DECLSPEC_HIDDEN;
 HRESULT device_init(struct wined3d_device *device, struct wined3d *wined3d,
         UINT adapter_idx, enum wined3d_device_type device_type, HWND focus_window, DWORD flags,
         BYTE surface_alignment, const enum wined3d_feature_level *levels, unsigned int level_count,
@@ -3640,7 +3674,11 @@ enum wined3d_push_constants
 
 #define WINED3D_CS_QUERY_POLL_INTERVAL  10u
 #define WINED3D_CS_QUEUE_SIZE           0x100000u
-#define WINED3D_CS_SPIN_COUNT           10000000u
+/* Bounds for the time the CS thread spins on an empty queue before going to
+ * sleep. The actual limit adapts to the observed gaps between packets. */
+#define WINED3D_CS_SPIN_MIN_US          20u
+#define WINED3D_CS_SPIN_MAX_US          2000u
+#define WINED3D_CS_SPIN_CHECK_INTERVAL  64u
 
 struct wined3d_cs_queue
 {
@@ -3667,19 +3705,78 @@ struct wined3d_cs
     HANDLE thread;
     DWORD thread_id;
 
-    struct wined3d_cs_queue queue[WINED3D_CS_QUEUE_COUNT];
+    /* The command list being recorded, for deferred contexts. */
+    struct wined3d_command_list *list;
+
     size_t data_size, start, end;
     void *data;
     struct list query_poll_list;
     BOOL queries_flushed;
 
-    HANDLE event;
     BOOL waiting_for_event;
     LONG pending_presents;
+    LONGLONG spin_limit, spin_min, spin_max;
+    DWORD stats_time;
+
+    /* Needs to be last. Recording command streams don't allocate the queues. */
+    struct wined3d_cs_queue queue[WINED3D_CS_QUEUE_COUNT];
+};
+
+enum wined3d_command_list_object_type
+{
+    WINED3D_COMMAND_LIST_OBJECT_BLEND_STATE,
+    WINED3D_COMMAND_LIST_OBJECT_RASTERIZER_STATE,
+    WINED3D_COMMAND_LIST_OBJECT_RENDERTARGET_VIEW,
+    WINED3D_COMMAND_LIST_OBJECT_SAMPLER,
+    WINED3D_COMMAND_LIST_OBJECT_SHADER,
+    WINED3D_COMMAND_LIST_OBJECT_SHADER_RESOURCE_VIEW,
+    WINED3D_COMMAND_LIST_OBJECT_UNORDERED_ACCESS_VIEW,
+    WINED3D_COMMAND_LIST_OBJECT_VERTEX_DECLARATION,
+    WINED3D_COMMAND_LIST_OBJECT_BUFFER,
+    WINED3D_COMMAND_LIST_OBJECT_COMMAND_LIST,
+};
+
+struct wined3d_command_list_object
+{
+    enum wined3d_command_list_object_type type;
+    void *object;
+};
+
+struct wined3d_command_list
+{
+    LONG refcount;
+    struct wined3d_device *device;
+
+    /* Recorded packets, in the same format as the command stream queues. */
+    void *data;
+    SIZE_T data_capacity;
+    size_t data_size;
+
+    /* Every resource acquisition made while recording, so that execution can
+     * repeat them. Each entry holds a resource reference. */
+    struct wined3d_resource **resources;
+    SIZE_T resources_size, resource_count;
+    /* State objects referenced by the recorded packets. */
+    struct wined3d_command_list_object *objects;
+    SIZE_T objects_size, object_count;
+    /* Copies of the data passed to recorded sub-resource updates. */
+    void **uploads;
+    SIZE_T uploads_size, upload_count;
+    /* A resource or object reference couldn't be recorded, so executing the
+     * list would release references it never took. */
+    BOOL failed;
+};
+
+struct wined3d_deferred_context
+{
+    struct wined3d_device *device;
+    struct wined3d_cs *cs;
 };
 
 struct wined3d_cs *wined3d_cs_create(struct wined3d_device *device) DECLSPEC_HIDDEN;
+struct wined3d_cs *wined3d_cs_create_deferred(struct wined3d_device *device) DECLSPEC_HIDDEN;
 void wined3d_cs_destroy(struct wined3d_cs *cs) DECLSPEC_HIDDEN;
+void wined3d_cs_destroy_deferred(struct wined3d_cs *cs) DECLSPEC_HIDDEN;
 void wined3d_cs_destroy_object(struct wined3d_cs *cs,
         void (*callback)(void *object), void *object) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_add_dirty_texture_region(struct wined3d_cs *cs,
@@ -3705,6 +3802,8 @@ void wined3d_cs_emit_draw(struct wined3d_cs *cs, GLenum primitive_type, unsigned
         unsigned int start_instance, unsigned int instance_count, BOOL indexed) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_draw_indirect(struct wined3d_cs *cs, GLenum primitive_type, unsigned int patch_vertex_count,
         struct wined3d_buffer *buffer, unsigned int offset, BOOL indexed) DECLSPEC_HIDDEN;
+void wined3d_cs_emit_execute_command_list(struct wined3d_cs *cs,
+        struct wined3d_command_list *list) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_flush(struct wined3d_cs *cs) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_generate_mipmaps(struct wined3d_cs *cs, struct wined3d_shader_resource_view *view) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_preload_resource(struct wined3d_cs *cs, struct wined3d_resource *resource) DECLSPEC_HIDDEN;
@@ -3762,6 +3861,8 @@ void wined3d_cs_emit_set_vertex_declaration(struct wined3d_cs *cs,
         struct wined3d_vertex_declaration *declaration) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_set_viewports(struct wined3d_cs *cs, unsigned int viewport_count, const struct wined3d_viewport *viewports) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_unload_resource(struct wined3d_cs *cs, struct wined3d_resource *resource) DECLSPEC_HIDDEN;
+void wined3d_cs_emit_unmap_persistent(struct wined3d_cs *cs, struct wined3d_buffer *buffer,
+        unsigned int storage_idx) DECLSPEC_HIDDEN;
 void wined3d_cs_emit_update_sub_resource(struct wined3d_cs *cs, struct wined3d_resource *resource,
         unsigned int sub_resource_idx, const struct wined3d_box *box, const void *data, unsigned int row_pitch,
         unsigned int slice_pitch) DECLSPEC_HIDDEN;
@@ -3847,6 +3948,22 @@ void wined3d_buffer_copy(struct wined3d_buffer *dst_buffer, unsigned int dst_off
         struct wined3d_buffer *src_buffer, unsigned int src_offset, unsigned int size) DECLSPEC_HIDDEN;
 void wined3d_buffer_upload_data(struct wined3d_buffer *buffer, struct wined3d_context *context,
         const struct wined3d_box *box, const void *data) DECLSPEC_HIDDEN;
+BOOL wined3d_buffer_map_persistent(struct wined3d_buffer *buffer, struct wined3d_map_desc *map_desc,
+        const struct wined3d_box *box, DWORD flags) DECLSPEC_HIDDEN;
+BOOL wined3d_buffer_unmap_persistent(struct wined3d_buffer *buffer) DECLSPEC_HIDDEN;
+void wined3d_buffer_commit_persistent(struct wined3d_buffer *buffer, struct wined3d_context *context,
+        unsigned int storage_idx) DECLSPEC_HIDDEN;
+
+#define WINED3D_BUFFER_GL_STORAGE_COUNT 8
+
+struct wined3d_buffer_gl_storage
+{
+    GLuint id;
+    BYTE *map_ptr;
+    struct wined3d_fence *fence;
+    LONG busy;
+    BOOL fenced;
+};
 
 struct wined3d_buffer_gl
 {
@@ -3855,6 +3972,17 @@ struct wined3d_buffer_gl
     GLuint buffer_object;
     GLenum buffer_object_usage;
     GLenum buffer_type_hint;
+
+    /* Ring of persistently mapped buffer objects used for streaming dynamic
+     * buffers. "buffer_object" is always one of these when present. */
+    struct wined3d_buffer_gl_storage *storage;
+    unsigned int storage_count;
+    unsigned int storage_idx;
+    /* Published by the CS once the current storage holds the buffer
+     * contents. The remaining fields are owned by the application thread. */
+    LONG client_storage_count;
+    unsigned int client_storage_idx;
+    unsigned int client_map_count;
 };
 
 static inline struct wined3d_buffer_gl *wined3d_buffer_gl(struct wined3d_buffer *buffer)
@@ -4397,6 +4525,13 @@ struct ps_np2fixup_info {
 void print_glsl_info_log(const struct wined3d_gl_info *gl_info, GLuint id, BOOL program) DECLSPEC_HIDDEN;
 void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint program) DECLSPEC_HIDDEN;
 
+BOOL wined3d_shader_cache_get(const void *key, SIZE_T key_size,
+        DWORD *format, void **data, SIZE_T *data_size) DECLSPEC_HIDDEN;
+void wined3d_shader_cache_put(const void *key, SIZE_T key_size,
+        DWORD format, const void *data, SIZE_T data_size) DECLSPEC_HIDDEN;
+BOOL wined3d_shader_cache_enabled(void) DECLSPEC_HIDDEN;
+void wined3d_shader_cache_cleanup(void) DECLSPEC_HIDDEN;
+
 struct wined3d_palette
 {
     LONG ref;
@@ -1450,7 +1450,9 @@ struct create_file_reply
 {
     struct reply_header __header;
     obj_handle_t handle;
-    char __pad_12[4];
+    int          fd_type;
+    unsigned int fd_access;
+    unsigned int fd_options;
 };
 
 
@@ -5433,6 +5435,21 @@ struct add_fd_completion_reply
 
 
 
+struct get_fd_completion_request
+{
+    struct request_header __header;
+    obj_handle_t   handle;
+};
+struct get_fd_completion_reply
+{
+    struct reply_header __header;
+    obj_handle_t   port;
+    char __pad_12[4];
+    apc_param_t    ckey;
+};
+
+
+
 struct set_fd_completion_mode_request
 {
     struct request_header __header;
@@ -5708,6 +5725,111 @@ struct terminate_job_reply
 };
 
 
+
+struct get_esync_fd_request
+{
+    struct request_header __header;
+    obj_handle_t handle;
+};
+struct get_esync_fd_reply
+{
+    struct reply_header __header;
+    int          type;
+    unsigned int shm_idx;
+    unsigned int access;
+    char __pad_20[4];
+};
+enum esync_type
+{
+    ESYNC_NONE,
+    ESYNC_SEMAPHORE,
+    ESYNC_AUTO_EVENT,
+    ESYNC_MANUAL_EVENT,
+    ESYNC_MUTEX
+};
+
+
+struct esync_state
+{
+    int          value;
+    unsigned int count;
+    int          abandoned;
+    int          __pad;
+};
+#define ESYNC_SHM_SIZE  0x400000
+
+
+
+struct get_shared_state_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_shared_state_reply
+{
+    struct reply_header __header;
+    unsigned int desktop_idx;
+    unsigned int queue_idx;
+};
+
+
+
+struct get_user_shared_mapping_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_user_shared_mapping_reply
+{
+    struct reply_header __header;
+    obj_handle_t handle;
+    char __pad_12[4];
+};
+
+
+struct desktop_shared_state
+{
+    int            cursor_x;
+    int            cursor_y;
+    unsigned int   cursor_change;
+    user_handle_t  foreground;
+    unsigned char  keystate[256];
+};
+
+struct input_shared_state
+{
+    user_handle_t  focus;
+    user_handle_t  capture;
+    user_handle_t  active;
+    unsigned int   __pad;
+    unsigned char  keystate[256];
+};
+
+struct queue_shared_state
+{
+    unsigned int   wake_bits;
+    unsigned int   changed_bits;
+    int            surface_flush;
+    unsigned int   input_idx;
+    unsigned int   input_id;
+    unsigned int   __pad;
+};
+
+
+struct user_shared_state
+{
+    unsigned int   seq;
+    unsigned int   id;
+    union
+    {
+        struct desktop_shared_state desktop;
+        struct input_shared_state   input;
+        struct queue_shared_state   queue;
+    } u;
+};
+#define USER_SHM_SIZE  0x400000
+
+
 enum request
 {
     REQ_new_process,
@@ -5986,6 +6108,7 @@ enum request
     REQ_query_completion,
     REQ_set_completion_info,
     REQ_add_fd_completion,
+    REQ_get_fd_completion,
     REQ_set_fd_completion_mode,
     REQ_set_fd_disp_info,
     REQ_set_fd_name_info,
@@ -6004,6 +6127,9 @@ enum request
     REQ_set_job_limits,
     REQ_set_job_completion_port,
     REQ_terminate_job,
+    REQ_get_esync_fd,
+    REQ_get_shared_state,
+    REQ_get_user_shared_mapping,
     REQ_NB_REQUESTS
 };
 
@@ -6287,6 +6413,7 @@ union generic_request
     struct query_completion_request query_completion_request;
     struct set_completion_info_request set_completion_info_request;
     struct add_fd_completion_request add_fd_completion_request;
+    struct get_fd_completion_request get_fd_completion_request;
     struct set_fd_completion_mode_request set_fd_completion_mode_request;
     struct set_fd_disp_info_request set_fd_disp_info_request;
     struct set_fd_name_info_request set_fd_name_info_request;
@@ -6305,6 +6432,9 @@ union generic_request
     struct set_job_limits_request set_job_limits_request;
     struct set_job_completion_port_request set_job_completion_port_request;
     struct terminate_job_request terminate_job_request;
+    struct get_esync_fd_request get_esync_fd_request;
+    struct get_shared_state_request get_shared_state_request;
+    struct get_user_shared_mapping_request get_user_shared_mapping_request;
 };
 union generic_reply
 {
@@ -6586,6 +6716,7 @@ union generic_reply
     struct query_completion_reply query_completion_reply;
     struct set_completion_info_reply set_completion_info_reply;
     struct add_fd_completion_reply add_fd_completion_reply;
+    struct get_fd_completion_reply get_fd_completion_reply;
     struct set_fd_completion_mode_reply set_fd_completion_mode_reply;
     struct set_fd_disp_info_reply set_fd_disp_info_reply;
     struct set_fd_name_info_reply set_fd_name_info_reply;
@@ -6604,8 +6735,11 @@ union generic_reply
     struct set_job_limits_reply set_job_limits_reply;
     struct set_job_completion_port_reply set_job_completion_port_reply;
     struct terminate_job_reply terminate_job_reply;
+    struct get_esync_fd_reply get_esync_fd_reply;
+    struct get_shared_state_reply get_shared_state_reply;
+    struct get_user_shared_mapping_reply get_user_shared_mapping_reply;
 };
 
-#define SERVER_PROTOCOL_VERSION 572
+#define SERVER_PROTOCOL_VERSION 578
 
 #endif /* __WINE_WINE_SERVER_PROTOCOL_H */
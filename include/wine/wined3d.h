@@ -2113,6 +2113,8 @@ struct wined3d_parent_ops
 
 struct wined3d;
 struct wined3d_buffer;
+struct wined3d_command_list;
+struct wined3d_deferred_context;
 struct wined3d_device;
 struct wined3d_palette;
 struct wined3d_query;
@@ -2222,6 +2224,70 @@ void * __cdecl wined3d_buffer_get_parent(const struct wined3d_buffer *buffer);
 struct wined3d_resource * __cdecl wined3d_buffer_get_resource(struct wined3d_buffer *buffer);
 ULONG __cdecl wined3d_buffer_incref(struct wined3d_buffer *buffer);
 
+ULONG __cdecl wined3d_command_list_decref(struct wined3d_command_list *list);
+ULONG __cdecl wined3d_command_list_incref(struct wined3d_command_list *list);
+
+HRESULT __cdecl wined3d_deferred_context_clear_rendertarget_view(struct wined3d_deferred_context *context,
+        struct wined3d_rendertarget_view *view, const RECT *rect, DWORD flags,
+        const struct wined3d_color *color, float depth, DWORD stencil);
+void __cdecl wined3d_deferred_context_copy_resource(struct wined3d_deferred_context *context,
+        struct wined3d_resource *dst_resource, struct wined3d_resource *src_resource);
+HRESULT __cdecl wined3d_deferred_context_copy_sub_resource_region(struct wined3d_deferred_context *context,
+        struct wined3d_resource *dst_resource, unsigned int dst_sub_resource_idx, unsigned int dst_x,
+        unsigned int dst_y, unsigned int dst_z, struct wined3d_resource *src_resource,
+        unsigned int src_sub_resource_idx, const struct wined3d_box *src_box);
+HRESULT __cdecl wined3d_deferred_context_create(struct wined3d_device *device,
+        struct wined3d_deferred_context **context);
+void __cdecl wined3d_deferred_context_destroy(struct wined3d_deferred_context *context);
+void __cdecl wined3d_deferred_context_dispatch(struct wined3d_deferred_context *context,
+        unsigned int group_count_x, unsigned int group_count_y, unsigned int group_count_z);
+void __cdecl wined3d_deferred_context_draw(struct wined3d_deferred_context *context, int base_vertex_idx,
+        unsigned int start_idx, unsigned int index_count, unsigned int start_instance,
+        unsigned int instance_count, BOOL indexed);
+void __cdecl wined3d_deferred_context_execute_command_list(struct wined3d_deferred_context *context,
+        struct wined3d_command_list *list);
+HRESULT __cdecl wined3d_deferred_context_record_command_list(struct wined3d_deferred_context *context,
+        BOOL restore, struct wined3d_command_list **list);
+void __cdecl wined3d_deferred_context_set_blend_state(struct wined3d_deferred_context *context,
+        struct wined3d_blend_state *blend_state, const struct wined3d_color *blend_factor);
+void __cdecl wined3d_deferred_context_set_constant_buffer(struct wined3d_deferred_context *context,
+        enum wined3d_shader_type type, unsigned int idx, struct wined3d_buffer *buffer);
+void __cdecl wined3d_deferred_context_set_cs_uav(struct wined3d_deferred_context *context,
+        unsigned int idx, struct wined3d_unordered_access_view *uav, unsigned int initial_count);
+HRESULT __cdecl wined3d_deferred_context_set_depth_stencil_view(struct wined3d_deferred_context *context,
+        struct wined3d_rendertarget_view *view);
+void __cdecl wined3d_deferred_context_set_index_buffer(struct wined3d_deferred_context *context,
+        struct wined3d_buffer *buffer, enum wined3d_format_id format_id, unsigned int offset);
+void __cdecl wined3d_deferred_context_set_primitive_type(struct wined3d_deferred_context *context,
+        enum wined3d_primitive_type primitive_type, unsigned int patch_vertex_count);
+void __cdecl wined3d_deferred_context_set_rasterizer_state(struct wined3d_deferred_context *context,
+        struct wined3d_rasterizer_state *rasterizer_state);
+void __cdecl wined3d_deferred_context_set_render_state(struct wined3d_deferred_context *context,
+        enum wined3d_render_state state, DWORD value);
+HRESULT __cdecl wined3d_deferred_context_set_rendertarget_view(struct wined3d_deferred_context *context,
+        unsigned int view_idx, struct wined3d_rendertarget_view *view);
+void __cdecl wined3d_deferred_context_set_sampler(struct wined3d_deferred_context *context,
+        enum wined3d_shader_type type, unsigned int idx, struct wined3d_sampler *sampler);
+void __cdecl wined3d_deferred_context_set_scissor_rects(struct wined3d_deferred_context *context,
+        unsigned int rect_count, const RECT *rects);
+void __cdecl wined3d_deferred_context_set_shader(struct wined3d_deferred_context *context,
+        enum wined3d_shader_type type, struct wined3d_shader *shader);
+void __cdecl wined3d_deferred_context_set_shader_resource_view(struct wined3d_deferred_context *context,
+        enum wined3d_shader_type type, unsigned int idx, struct wined3d_shader_resource_view *view);
+void __cdecl wined3d_deferred_context_set_stream_output(struct wined3d_deferred_context *context,
+        unsigned int idx, struct wined3d_buffer *buffer, unsigned int offset);
+HRESULT __cdecl wined3d_deferred_context_set_stream_source(struct wined3d_deferred_context *context,
+        unsigned int stream_idx, struct wined3d_buffer *buffer, unsigned int offset, unsigned int stride);
+void __cdecl wined3d_deferred_context_set_unordered_access_view(struct wined3d_deferred_context *context,
+        unsigned int idx, struct wined3d_unordered_access_view *uav, unsigned int initial_count);
+void __cdecl wined3d_deferred_context_set_vertex_declaration(struct wined3d_deferred_context *context,
+        struct wined3d_vertex_declaration *declaration);
+void __cdecl wined3d_deferred_context_set_viewports(struct wined3d_deferred_context *context,
+        unsigned int viewport_count, const struct wined3d_viewport *viewports);
+void __cdecl wined3d_deferred_context_update_sub_resource(struct wined3d_deferred_context *context,
+        struct wined3d_resource *resource, unsigned int sub_resource_idx, const struct wined3d_box *box,
+        const void *data, unsigned int row_pitch, unsigned int depth_pitch);
+
 HRESULT __cdecl wined3d_device_acquire_focus_window(struct wined3d_device *device, HWND window);
 HRESULT __cdecl wined3d_device_begin_scene(struct wined3d_device *device);
 HRESULT __cdecl wined3d_device_begin_stateblock(struct wined3d_device *device);
@@ -2262,6 +2328,7 @@ void __cdecl wined3d_device_draw_primitive_instanced_indirect(struct wined3d_dev
 HRESULT __cdecl wined3d_device_end_scene(struct wined3d_device *device);
 HRESULT __cdecl wined3d_device_end_stateblock(struct wined3d_device *device, struct wined3d_stateblock **stateblock);
 void __cdecl wined3d_device_evict_managed_resources(struct wined3d_device *device);
+void __cdecl wined3d_device_execute_command_list(struct wined3d_device *device, struct wined3d_command_list *list);
 UINT __cdecl wined3d_device_get_available_texture_mem(const struct wined3d_device *device);
 INT __cdecl wined3d_device_get_base_vertex_index(const struct wined3d_device *device);
 struct wined3d_blend_state * __cdecl wined3d_device_get_blend_state(const struct wined3d_device *device,
@@ -19,10 +19,34 @@
  */
 
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "wine/unicode.h"
 
 extern unsigned int wine_decompose( WCHAR ch, WCHAR *dst, unsigned int dstlen ) DECLSPEC_HIDDEN;
+extern unsigned int wine_ascii_mbslen( const char *src, unsigned int srclen ) DECLSPEC_HIDDEN;
+extern unsigned int wine_ascii_mbstowcs( const char *src, unsigned int srclen, WCHAR *dst ) DECLSPEC_HIDDEN;
+
+/* check whether the table maps 7-bit ASCII to itself, so that ASCII runs can be widened directly */
+static inline int is_ascii_sbcs_table( const WCHAR *cp2uni )
+{
+#ifdef __SSE2__
+    __m128i index = _mm_setr_epi16( 0, 1, 2, 3, 4, 5, 6, 7 );
+    __m128i diff = _mm_setzero_si128();
+    unsigned int i;
+
+    for (i = 0; i < 0x80; i += 8)
+    {
+        diff = _mm_or_si128( diff, _mm_xor_si128( _mm_loadu_si128( (const __m128i *)(cp2uni + i) ), index ));
+        index = _mm_add_epi16( index, _mm_set1_epi16( 8 ));
+    }
+    return _mm_movemask_epi8( _mm_cmpeq_epi16( diff, _mm_setzero_si128() )) == 0xffff;
+#else
+    return 0;
+#endif
+}
 
 /* check the code whether it is in Unicode Private Use Area (PUA). */
 /* MB_ERR_INVALID_CHARS raises an error converting from 1-byte character to PUA. */
@@ -39,8 +63,19 @@ static inline int check_invalid_chars_sbcs( const struct sbcs_table *table, int
     const WCHAR def_unicode_char = table->info.def_unicode_char;
     const unsigned char def_char = table->uni2cp_low[table->uni2cp_high[def_unicode_char >> 8]
                                                      + (def_unicode_char & 0xff)];
+    /* ASCII chars can only be invalid if the default char is one of them */
+    const int skip_ascii = srclen >= 64 && (def_unicode_char >= 0x80 || def_char == def_unicode_char) &&
+                           is_ascii_sbcs_table( cp2uni );
+    unsigned int run;
+
     while (srclen)
     {
+        if (skip_ascii && *src < 0x80 && (run = wine_ascii_mbslen( (const char *)src, srclen )))
+        {
+            src += run;
+            srclen -= run;
+            continue;
+        }
         if ((cp2uni[*src] == def_unicode_char && *src != def_char) ||
             is_private_use_area_char(cp2uni[*src])) break;
         src++;
@@ -57,6 +92,8 @@ static inline int mbstowcs_sbcs( const struct sbcs_table *table, int flags,
 {
     const WCHAR * const cp2uni = (flags & MB_USEGLYPHCHARS) ? table->cp2uni_glyphs : table->cp2uni;
     int ret = srclen;
+    int ascii;
+    unsigned int run;
 
     if (dstlen < srclen)
     {
@@ -65,8 +102,18 @@ static inline int mbstowcs_sbcs( const struct sbcs_table *table, int flags,
         ret = -1;
     }
 
+    /* checking the table costs about as much as converting a few dozen chars */
+    ascii = srclen >= 64 && is_ascii_sbcs_table( cp2uni );
+
     for (;;)
     {
+        if (ascii && (run = wine_ascii_mbstowcs( (const char *)src, srclen, dst )))
+        {
+            dst += run;
+            src += run;
+            srclen -= run;
+            continue;
+        }
         switch(srclen)
         {
         default:
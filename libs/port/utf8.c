@@ -19,10 +19,17 @@
  */
 
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "wine/unicode.h"
 
 extern WCHAR wine_compose( const WCHAR *str ) DECLSPEC_HIDDEN;
+extern unsigned int wine_ascii_mbslen( const char *src, unsigned int srclen ) DECLSPEC_HIDDEN;
+extern unsigned int wine_ascii_mbstowcs( const char *src, unsigned int srclen, WCHAR *dst ) DECLSPEC_HIDDEN;
+extern unsigned int wine_ascii_wcslen( const WCHAR *src, unsigned int srclen ) DECLSPEC_HIDDEN;
+extern unsigned int wine_ascii_wcstombs( const WCHAR *src, unsigned int srclen, char *dst ) DECLSPEC_HIDDEN;
 
 /* number of following bytes in sequence based on first byte value (for bytes above 0x7f) */
 static const char utf8_length[128] =
@@ -44,6 +51,108 @@ static const unsigned char utf8_mask[4] = { 0x7f, 0x1f, 0x0f, 0x07 };
 static const unsigned int utf8_minval[4] = { 0x0, 0x80, 0x800, 0x10000 };
 
 
+/* The helpers below handle runs of 7-bit ASCII 16 chars at a time. They only
+ * process whole blocks, stop at the first block that contains a non-ASCII
+ * char, and return the number of chars processed, so the caller can resume
+ * its normal per-char loop at that point. */
+
+#ifdef __SSE2__
+
+/* length of the leading 7-bit ASCII run, in whole blocks */
+unsigned int wine_ascii_mbslen( const char *src, unsigned int srclen )
+{
+    unsigned int pos;
+
+    for (pos = 0; pos + 16 <= srclen; pos += 16)
+    {
+        __m128i v = _mm_loadu_si128( (const __m128i *)(src + pos) );
+        if (_mm_movemask_epi8( v )) break;
+    }
+    return pos;
+}
+
+/* widen the leading 7-bit ASCII run of src into dst */
+unsigned int wine_ascii_mbstowcs( const char *src, unsigned int srclen, WCHAR *dst )
+{
+    const __m128i zero = _mm_setzero_si128();
+    unsigned int pos;
+
+    for (pos = 0; pos + 16 <= srclen; pos += 16)
+    {
+        __m128i v = _mm_loadu_si128( (const __m128i *)(src + pos) );
+        if (_mm_movemask_epi8( v )) break;
+        _mm_storeu_si128( (__m128i *)(dst + pos), _mm_unpacklo_epi8( v, zero ));
+        _mm_storeu_si128( (__m128i *)(dst + pos + 8), _mm_unpackhi_epi8( v, zero ));
+    }
+    return pos;
+}
+
+static inline __m128i load_ascii_wcs( const WCHAR *src, BOOL *ascii )
+{
+    const __m128i mask = _mm_set1_epi16( (short)0xff80 );
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_loadu_si128( (const __m128i *)src );
+    __m128i hi = _mm_loadu_si128( (const __m128i *)(src + 8) );
+    __m128i bad = _mm_and_si128( _mm_or_si128( lo, hi ), mask );
+
+    *ascii = (_mm_movemask_epi8( _mm_cmpeq_epi16( bad, zero )) == 0xffff);
+    return _mm_packus_epi16( lo, hi );
+}
+
+/* length of the leading 7-bit ASCII run, in whole blocks */
+unsigned int wine_ascii_wcslen( const WCHAR *src, unsigned int srclen )
+{
+    unsigned int pos;
+    BOOL ascii;
+
+    for (pos = 0; pos + 16 <= srclen; pos += 16)
+    {
+        load_ascii_wcs( src + pos, &ascii );
+        if (!ascii) break;
+    }
+    return pos;
+}
+
+/* narrow the leading 7-bit ASCII run of src into dst */
+unsigned int wine_ascii_wcstombs( const WCHAR *src, unsigned int srclen, char *dst )
+{
+    unsigned int pos;
+    BOOL ascii;
+
+    for (pos = 0; pos + 16 <= srclen; pos += 16)
+    {
+        __m128i v = load_ascii_wcs( src + pos, &ascii );
+        if (!ascii) break;
+        _mm_storeu_si128( (__m128i *)(dst + pos), v );
+    }
+    return pos;
+}
+
+#else  /* __SSE2__ */
+
+unsigned int wine_ascii_mbslen( const char *src, unsigned int srclen )
+{
+    return 0;
+}
+
+unsigned int wine_ascii_mbstowcs( const char *src, unsigned int srclen, WCHAR *dst )
+{
+    return 0;
+}
+
+unsigned int wine_ascii_wcslen( const WCHAR *src, unsigned int srclen )
+{
+    return 0;
+}
+
+unsigned int wine_ascii_wcstombs( const WCHAR *src, unsigned int srclen, char *dst )
+{
+    return 0;
+}
+
+#endif  /* __SSE2__ */
+
+
 /* get the next char value taking surrogates into account */
 static inline unsigned int get_surrogate_value( const WCHAR *src, unsigned int srclen )
 {
@@ -62,12 +171,20 @@ static inline unsigned int get_surrogate_value( const WCHAR *src, unsigned int s
 static inline int get_length_wcs_utf8( int flags, const WCHAR *src, unsigned int srclen )
 {
     int len;
-    unsigned int val;
+    unsigned int val, run;
 
     for (len = 0; srclen; srclen--, src++)
     {
         if (*src < 0x80)  /* 0x00-0x7f: 1 byte */
         {
+            if ((run = wine_ascii_wcslen( src, srclen )))
+            {
+                /* the loop increment accounts for the last char of the run */
+                len += run;
+                src += run - 1;
+                srclen -= run - 1;
+                continue;
+            }
             len++;
             continue;
         }
@@ -104,10 +221,19 @@ int wine_utf8_wcstombs( int flags, const WCHAR *src, int srclen, char *dst, int
     for (len = dstlen; srclen; srclen--, src++)
     {
         WCHAR ch = *src;
-        unsigned int val;
+        unsigned int val, run;
 
         if (ch < 0x80)  /* 0x00-0x7f: 1 byte */
         {
+            if ((run = wine_ascii_wcstombs( src, min( srclen, len ), dst )))
+            {
+                /* the loop increment accounts for the last char of the run */
+                len -= run;
+                dst += run;
+                src += run - 1;
+                srclen -= run - 1;
+                continue;
+            }
             if (!len--) return -1;  /* overflow */
             *dst++ = ch;
             continue;
@@ -199,8 +325,11 @@ static inline int get_length_mbs_utf8_compose( int flags, const char *src, int s
         unsigned char ch = *src++;
         if (ch < 0x80)  /* special fast case for 7-bit ASCII */
         {
-            composed[0] = ch;
-            ret++;
+            unsigned int run = wine_ascii_mbslen( src - 1, srcend - src + 1 );
+            if (run) src += run - 1;
+            else run = 1;
+            composed[0] = src[-1];
+            ret += run;
             continue;
         }
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0xffff)
@@ -241,8 +370,16 @@ static int utf8_mbstowcs_compose( int flags, const char *src, int srclen, WCHAR
         unsigned char ch = *src++;
         if (ch < 0x80)  /* special fast case for 7-bit ASCII */
         {
+            unsigned int run;
+
             if (dst >= dstend) return -1;  /* overflow */
-            *dst++ = composed[0] = ch;
+            if ((run = wine_ascii_mbstowcs( src - 1, min( srcend - src + 1, dstend - dst ), dst )))
+            {
+                src += run - 1;
+                dst += run;
+                composed[0] = dst[-1];
+            }
+            else *dst++ = composed[0] = ch;
             continue;
         }
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0xffff)
@@ -285,7 +422,10 @@ static inline int get_length_mbs_utf8( int flags, const char *src, int srclen )
         unsigned char ch = *src++;
         if (ch < 0x80)  /* special fast case for 7-bit ASCII */
         {
-            ret++;
+            unsigned int run = wine_ascii_mbslen( src - 1, srcend - src + 1 );
+            if (run) src += run - 1;
+            else run = 1;
+            ret += run;
             continue;
         }
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0x10ffff)
@@ -316,7 +456,13 @@ int wine_utf8_mbstowcs( int flags, const char *src, int srclen, WCHAR *dst, int
         unsigned char ch = *src++;
         if (ch < 0x80)  /* special fast case for 7-bit ASCII */
         {
-            *dst++ = ch;
+            unsigned int run = wine_ascii_mbstowcs( src - 1, min( srcend - src + 1, dstend - dst ), dst );
+            if (run)
+            {
+                src += run - 1;
+                dst += run;
+            }
+            else *dst++ = ch;
             continue;
         }
         if ((res = decode_utf8_char( ch, &src, srcend )) <= 0xffff)
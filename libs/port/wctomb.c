@@ -19,10 +19,14 @@
  */
 
 #include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "wine/unicode.h"
 
 extern WCHAR wine_compose( const WCHAR *str ) DECLSPEC_HIDDEN;
+extern unsigned int wine_ascii_wcstombs( const WCHAR *src, unsigned int srclen, char *dst ) DECLSPEC_HIDDEN;
 
 /****************************************************************/
 /* sbcs support */
@@ -36,6 +40,26 @@ static inline int is_valid_sbcs_mapping( const struct sbcs_table *table, int fla
     return 1;
 }
 
+/* check whether the table maps 7-bit ASCII to itself, so that ASCII runs can be narrowed directly */
+static inline int is_ascii_sbcs_table( const struct sbcs_table *table )
+{
+#ifdef __SSE2__
+    const unsigned char *low = table->uni2cp_low + table->uni2cp_high[0];
+    __m128i index = _mm_setr_epi8( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+    __m128i diff = _mm_setzero_si128();
+    unsigned int i;
+
+    for (i = 0; i < 0x80; i += 16)
+    {
+        diff = _mm_or_si128( diff, _mm_xor_si128( _mm_loadu_si128( (const __m128i *)(low + i) ), index ));
+        index = _mm_add_epi8( index, _mm_set1_epi8( 16 ));
+    }
+    return _mm_movemask_epi8( _mm_cmpeq_epi8( diff, _mm_setzero_si128() )) == 0xffff;
+#else
+    return 0;
+#endif
+}
+
 /* query necessary dst length for src string */
 static int get_length_sbcs( const struct sbcs_table *table, int flags,
                             const WCHAR *src, unsigned int srclen, int *used )
@@ -96,6 +120,8 @@ static inline int wcstombs_sbcs( const struct sbcs_table *table,
     const unsigned char  * const uni2cp_low = table->uni2cp_low;
     const unsigned short * const uni2cp_high = table->uni2cp_high;
     int ret = srclen;
+    int ascii;
+    unsigned int run;
 
     if (dstlen < srclen)
     {
@@ -104,8 +130,18 @@ static inline int wcstombs_sbcs( const struct sbcs_table *table,
         ret = -1;
     }
 
+    /* checking the table costs about as much as converting a few dozen chars */
+    ascii = srclen >= 64 && is_ascii_sbcs_table( table );
+
     while (srclen >= 16)
     {
+        if (ascii && (run = wine_ascii_wcstombs( src, srclen, dst )))
+        {
+            src += run;
+            dst += run;
+            srclen -= run;
+            continue;
+        }
         dst[0]  = uni2cp_low[uni2cp_high[src[0]  >> 8] + (src[0]  & 0xff)];
         dst[1]  = uni2cp_low[uni2cp_high[src[1]  >> 8] + (src[1]  & 0xff)];
         dst[2]  = uni2cp_low[uni2cp_high[src[2]  >> 8] + (src[2]  & 0xff)];
@@ -0,0 +1,454 @@
+/*
+ * eventfd-based synchronization objects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/*
+ * When WINEESYNC is set in the environment, events, semaphores and mutexes
+ * keep their state in a shared memory file in the server dir, and each of
+ * them gets an eventfd that is readable while the object is signaled. The
+ * clients can then wait on and signal these objects without a server round
+ * trip. The server remains the owner of the objects: it handles naming,
+ * handles and security, and it still supports waiting on them from the
+ * server side (alertable waits, waits mixed with other object types) by
+ * polling the eventfd while it has waiters.
+ *
+ * The shared state is the authority; the eventfd counter follows it and is
+ * only used for wakeups. A state change is always done on the shared state
+ * first, then the eventfd is written to (or read from) accordingly. Reads
+ * never block: a wakeup that comes in after the read that should have taken
+ * it is dropped by the next failed attempt to grab the object.
+ */
+
+#include "config.h"
+#include "wine/port.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <sys/types.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
+#ifdef HAVE_SYS_EVENTFD_H
+# include <sys/eventfd.h>
+#endif
+#ifdef HAVE_POLL_H
+# include <poll.h>
+#endif
+#include <unistd.h>
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#include "windef.h"
+#include "winternl.h"
+
+#include "file.h"
+#include "handle.h"
+#include "thread.h"
+#include "request.h"
+
+struct esync
+{
+    struct object   *obj;           /* object owning the eventfd */
+    struct fd       *fd;            /* eventfd, polled while there are server-side waiters */
+    enum esync_type  type;          /* object type */
+    unsigned int     shm_idx;       /* index of the shared state */
+    struct list      entry;         /* entry in the mutex list */
+};
+
+static void esync_poll_event( struct fd *fd, int event );
+
+static const struct fd_ops esync_fd_ops =
+{
+    NULL,                        /* get_poll_events */
+    esync_poll_event,            /* poll_event */
+    NULL,                        /* get_fd_type */
+    NULL,                        /* read */
+    NULL,                        /* write */
+    NULL,                        /* flush */
+    NULL,                        /* get_file_info */
+    NULL,                        /* get_volume_info */
+    NULL,                        /* ioctl */
+    NULL,                        /* queue_async */
+    NULL                         /* reselect_async */
+};
+
+#define ESYNC_MAX_SLOTS (ESYNC_SHM_SIZE / sizeof(struct esync_state))
+
+static struct esync_state *shm_states;     /* mapping of the shared state file */
+static unsigned int *free_slots;           /* stack of freed slots */
+static unsigned int nb_free_slots;
+static unsigned int next_slot = 1;         /* slot 0 is never used */
+static struct list esync_mutexes = LIST_INIT( esync_mutexes );
+
+int do_esync(void)
+{
+#ifdef HAVE_SYS_EVENTFD_H
+    static int enabled = -1;
+
+    if (enabled == -1)
+    {
+        const char *env = getenv( "WINEESYNC" );
+        enabled = env && atoi( env );
+    }
+    return enabled;
+#else
+    return 0;
+#endif
+}
+
+/* create the shared state file; must be called from the server dir */
+void esync_init(void)
+{
+    int fd;
+    void *ptr;
+
+    if ((fd = open( "esync", O_CREAT | O_TRUNC | O_RDWR, 0600 )) == -1)
+        fatal_error( "cannot create esync file: %s\n", strerror( errno ));
+    if (ftruncate( fd, ESYNC_SHM_SIZE ) == -1)
+        fatal_error( "cannot grow esync file: %s\n", strerror( errno ));
+    ptr = mmap( NULL, ESYNC_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    if (ptr == MAP_FAILED) fatal_error( "cannot map esync file: %s\n", strerror( errno ));
+    close( fd );
+    shm_states = ptr;
+    if (!(free_slots = mem_alloc( ESYNC_MAX_SLOTS * sizeof(*free_slots) )))
+        fatal_error( "out of memory\n" );
+}
+
+static unsigned int alloc_shm_slot(void)
+{
+    if (nb_free_slots) return free_slots[--nb_free_slots];
+    if (next_slot < ESYNC_MAX_SLOTS) return next_slot++;
+    return 0;
+}
+
+/* create the eventfd and shared state for an object; returns NULL if esync is unavailable */
+struct esync *create_esync( struct object *obj, enum esync_type type, int value, unsigned int count )
+{
+#ifdef HAVE_SYS_EVENTFD_H
+    struct esync *esync;
+    struct esync_state *state;
+    unsigned int initval;
+    int unix_fd;
+
+    if (!shm_states) return NULL;
+    if (!(esync = mem_alloc( sizeof(*esync) ))) return NULL;
+    if (!(esync->shm_idx = alloc_shm_slot()))
+    {
+        free( esync );
+        return NULL;
+    }
+
+    switch (type)
+    {
+    case ESYNC_SEMAPHORE:    initval = value; break;
+    case ESYNC_MUTEX:        initval = !value; break;
+    default:                 initval = !!value; break;
+    }
+
+    if ((unix_fd = eventfd( initval, EFD_CLOEXEC | EFD_NONBLOCK | EFD_SEMAPHORE )) == -1 ||
+        !(esync->fd = create_anonymous_fd( &esync_fd_ops, unix_fd, obj, 0 )))
+    {
+        free_slots[nb_free_slots++] = esync->shm_idx;
+        free( esync );
+        return NULL;
+    }
+
+    esync->obj  = obj;
+    esync->type = type;
+    state = &shm_states[esync->shm_idx];
+    state->value = value;
+    state->count = count;
+    state->abandoned = 0;
+    if (type == ESYNC_MUTEX) list_add_tail( &esync_mutexes, &esync->entry );
+    return esync;
+#else
+    return NULL;
+#endif
+}
+
+void destroy_esync( struct esync *esync )
+{
+    if (!esync) return;
+    if (esync->type == ESYNC_MUTEX) list_remove( &esync->entry );
+    memset( &shm_states[esync->shm_idx], 0, sizeof(struct esync_state) );
+    free_slots[nb_free_slots++] = esync->shm_idx;
+    release_object( esync->fd );
+    free( esync );
+}
+
+struct esync_state *esync_state( struct esync *esync )
+{
+    return &shm_states[esync->shm_idx];
+}
+
+/* post wakeups on the eventfd after the shared state has been made available */
+void esync_wake( struct esync *esync, unsigned int count )
+{
+    unsigned __int64 value = count;
+
+    if (write( get_unix_fd( esync->fd ), &value, sizeof(value) ) == -1)
+        fprintf( stderr, "wineserver: esync write failed: %s\n", strerror( errno ));
+}
+
+/* take one wakeup off the eventfd without blocking; returns 0 if there was none */
+static int esync_consume( struct esync *esync )
+{
+    unsigned __int64 value;
+
+    return read( get_unix_fd( esync->fd ), &value, sizeof(value) ) != -1;
+}
+
+/* start or stop polling the eventfd depending on the server-side waiters */
+static void esync_update_poll( struct esync *esync )
+{
+    set_fd_events( esync->fd, list_empty( &esync->obj->wait_queue ) ? 0 : POLLIN );
+}
+
+static void esync_poll_event( struct fd *fd, int event )
+{
+    struct object *obj = get_fd_user( fd );
+
+    /* stop polling while the object stays signaled, the wait queue gets
+     * rechecked anyway when anything else it depends on changes */
+    set_fd_events( fd, 0 );
+    grab_object( obj );
+    wake_up( obj, 0 );
+    release_object( obj );
+}
+
+int esync_add_queue( struct esync *esync, struct wait_queue_entry *entry )
+{
+    int ret = add_queue( esync->obj, entry );
+    esync_update_poll( esync );
+    return ret;
+}
+
+void esync_remove_queue( struct esync *esync, struct wait_queue_entry *entry )
+{
+    struct object *obj = esync->obj;
+
+    if (entry->esync) esync_release_grab( entry );
+    /* same as remove_queue(), but the object may go away once released */
+    list_remove( &entry->entry );
+    if (list_empty( &obj->wait_queue )) set_fd_events( esync->fd, 0 );
+    release_object( obj );
+}
+
+/* try to grab the object; *wakeup is set if the grab took a wakeup from the eventfd */
+static int esync_try_grab( struct esync *esync, struct thread *thread, int *abandoned, int *wakeup )
+{
+    struct esync_state *state = esync_state( esync );
+    int value;
+
+    *abandoned = 0;
+    *wakeup = 0;
+    switch (esync->type)
+    {
+    case ESYNC_SEMAPHORE:
+        for (value = state->value; value > 0; value = state->value)
+            if (interlocked_cmpxchg( &state->value, value - 1, value ) == value) break;
+        if (value <= 0) return 0;
+        break;
+    case ESYNC_AUTO_EVENT:
+        if (interlocked_cmpxchg( &state->value, 0, 1 ) != 1) return 0;
+        break;
+    case ESYNC_MANUAL_EVENT:
+        return state->value;
+    case ESYNC_MUTEX:
+        if (state->value == thread->id)
+        {
+            state->count++;
+            return 1;
+        }
+        if (interlocked_cmpxchg( &state->value, thread->id, 0 )) return 0;
+        state->count = 1;
+        *abandoned = interlocked_xchg( &state->abandoned, 0 );
+        break;
+    default:
+        assert( 0 );
+        return 0;
+    }
+    *wakeup = 1;
+    return 1;
+}
+
+/* grab the object for a server-side wait; returns 0 if it is not signaled. Clients only
+ * write to the eventfd after publishing the state, so a wakeup can arrive after the
+ * grab that should have consumed it; drop it when the object can't be grabbed, and
+ * check again in case it was a new one. */
+static int esync_grab( struct esync *esync, struct thread *thread, int *abandoned )
+{
+    int wakeup;
+
+    if (esync_try_grab( esync, thread, abandoned, &wakeup ))
+    {
+        if (wakeup) esync_consume( esync );
+        return 1;
+    }
+    if (!esync_consume( esync ) || !esync_try_grab( esync, thread, abandoned, &wakeup )) return 0;
+    if (!wakeup) esync_wake( esync, 1 );  /* the object keeps its wakeup */
+    return 1;
+}
+
+/* give back an object grabbed for a wait that did not complete */
+static void esync_ungrab( struct esync *esync, int abandoned )
+{
+    struct esync_state *state = esync_state( esync );
+
+    switch (esync->type)
+    {
+    case ESYNC_SEMAPHORE:
+        interlocked_xchg_add( &state->value, 1 );
+        esync_wake( esync, 1 );
+        break;
+    case ESYNC_AUTO_EVENT:
+        if (!interlocked_xchg( &state->value, 1 )) esync_wake( esync, 1 );
+        break;
+    case ESYNC_MUTEX:
+        if (--state->count) break;
+        if (abandoned) state->abandoned = 1;
+        state->value = 0;
+        esync_wake( esync, 1 );
+        break;
+    default:
+        break;
+    }
+}
+
+/* clients can grab the object in-process at any time, so checking the state is not
+ * enough: the object is grabbed right away, and the grab is kept in the wait entry
+ * until the wait is satisfied or given back if the wait doesn't complete */
+int esync_signaled( struct esync *esync, struct wait_queue_entry *entry )
+{
+    int abandoned;
+
+    if (entry->esync) return 1;  /* already grabbed by a previous check */
+    if (!esync_grab( esync, get_wait_queue_thread( entry ), &abandoned ))
+    {
+        /* make sure we get woken up when a client signals it */
+        esync_update_poll( esync );
+        return 0;
+    }
+    entry->esync = esync;
+    entry->esync_abandoned = abandoned;
+    return 1;
+}
+
+void esync_satisfied( struct esync *esync, struct wait_queue_entry *entry )
+{
+    assert( entry->esync == esync );
+    if (entry->esync_abandoned) make_wait_abandoned( entry );
+    entry->esync = NULL;
+}
+
+void esync_release_grab( struct wait_queue_entry *entry )
+{
+    esync_ungrab( entry->esync, entry->esync_abandoned );
+    entry->esync = NULL;
+}
+
+void esync_set_event( struct esync *esync )
+{
+    if (!interlocked_xchg( &esync_state( esync )->value, 1 )) esync_wake( esync, 1 );
+}
+
+void esync_reset_event( struct esync *esync )
+{
+    if (interlocked_xchg( &esync_state( esync )->value, 0 )) esync_consume( esync );
+}
+
+/* release a semaphore; returns 0 and sets the error if the maximum would be exceeded */
+int esync_release_semaphore( struct esync *esync, unsigned int count, unsigned int *prev )
+{
+    struct esync_state *state = esync_state( esync );
+    unsigned int value, tmp;
+
+    for (value = state->value;; value = tmp)
+    {
+        if (prev) *prev = value;
+        if (value + count < value || value + count > state->count)
+        {
+            set_error( STATUS_SEMAPHORE_LIMIT_EXCEEDED );
+            return 0;
+        }
+        if ((tmp = interlocked_cmpxchg( &state->value, value + count, value )) == value) break;
+    }
+    if (count) esync_wake( esync, count );
+    return 1;
+}
+
+/* release a mutex owned by the current thread; returns 0 and sets the error if not owned */
+int esync_release_mutex( struct esync *esync, unsigned int *prev )
+{
+    struct esync_state *state = esync_state( esync );
+
+    if (state->value != current->id)
+    {
+        set_error( STATUS_MUTANT_NOT_OWNED );
+        return 0;
+    }
+    if (prev) *prev = state->count;
+    if (!--state->count)
+    {
+        state->value = 0;
+        esync_wake( esync, 1 );
+    }
+    return 1;
+}
+
+/* abandon the esync mutexes owned by a dying thread */
+void esync_abandon_mutexes( struct thread *thread )
+{
+    struct esync *esync;
+
+    LIST_FOR_EACH_ENTRY( esync, &esync_mutexes, struct esync, entry )
+    {
+        struct esync_state *state = esync_state( esync );
+
+        if (state->value != thread->id) continue;
+        state->count = 0;
+        state->abandoned = 1;
+        state->value = 0;
+        esync_wake( esync, 1 );
+    }
+}
+
+/* retrieve the eventfd of an object for in-process waits */
+DECL_HANDLER(get_esync_fd)
+{
+    struct object *obj;
+    struct esync *esync;
+
+    if (!(obj = get_handle_obj( current->process, req->handle, 0, NULL ))) return;
+
+    if ((esync = get_event_esync( obj )) || (esync = get_semaphore_esync( obj )) ||
+        (esync = get_mutex_esync( obj )))
+    {
+        reply->type    = esync->type;
+        reply->shm_idx = esync->shm_idx;
+        reply->access  = get_handle_access( current->process, req->handle );
+        send_client_fd( current->process, get_unix_fd( esync->fd ), req->handle );
+    }
+    else reply->type = ESYNC_NONE;
+
+    release_object( obj );
+}
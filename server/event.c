@@ -41,22 +41,26 @@ struct event
     struct object  obj;             /* object header */
     int            manual_reset;    /* is it a manual reset event? */
     int            signaled;        /* event has been signaled */
+    struct esync  *esync;           /* shared state for in-process waits */
 };
 
 static void event_dump( struct object *obj, int verbose );
 static struct object_type *event_get_type( struct object *obj );
+static int event_add_queue( struct object *obj, struct wait_queue_entry *entry );
+static void event_remove_queue( struct object *obj, struct wait_queue_entry *entry );
 static int event_signaled( struct object *obj, struct wait_queue_entry *entry );
 static void event_satisfied( struct object *obj, struct wait_queue_entry *entry );
 static unsigned int event_map_access( struct object *obj, unsigned int access );
 static int event_signal( struct object *obj, unsigned int access);
+static void event_destroy( struct object *obj );
 
 static const struct object_ops event_ops =
 {
     sizeof(struct event),      /* size */
     event_dump,                /* dump */
     event_get_type,            /* get_type */
-    add_queue,                 /* add_queue */
-    remove_queue,              /* remove_queue */
+    event_add_queue,           /* add_queue */
+    event_remove_queue,        /* remove_queue */
     event_signaled,            /* signaled */
     event_satisfied,           /* satisfied */
     event_signal,              /* signal */
@@ -69,7 +73,7 @@ static const struct object_ops event_ops =
     default_unlink_name,       /* unlink_name */
     no_open_file,              /* open_file */
     no_close_handle,           /* close_handle */
-    no_destroy                 /* destroy */
+    event_destroy              /* destroy */
 };
 
 
@@ -119,6 +123,10 @@ struct event *create_event( struct object *root, const struct unicode_str *name,
             /* initialize it if it didn't already exist */
             event->manual_reset = manual_reset;
             event->signaled     = initial_state;
+            event->esync        = NULL;
+            if (do_esync())
+                event->esync = create_esync( &event->obj, manual_reset ? ESYNC_MANUAL_EVENT : ESYNC_AUTO_EVENT,
+                                             initial_state, 0 );
         }
     }
     return event;
@@ -129,24 +137,40 @@ struct event *get_event_obj( struct process *process, obj_handle_t handle, unsig
     return (struct event *)get_handle_obj( process, handle, access, &event_ops );
 }
 
+struct esync *get_event_esync( struct object *obj )
+{
+    if (obj->ops != &event_ops) return NULL;
+    return ((struct event *)obj)->esync;
+}
+
+/* With esync, the waiters that are woken up here are the server-side ones. Threads
+ * waiting in-process only poll the eventfd, so they can miss the pulse if the event
+ * is reset before they get scheduled, the same way a waiter handling a kernel APC
+ * can miss it on Windows. */
 void pulse_event( struct event *event )
 {
-    event->signaled = 1;
-    /* wake up all waiters if manual reset, a single one otherwise */
-    wake_up( &event->obj, !event->manual_reset );
-    event->signaled = 0;
+    set_event( event );
+    reset_event( event );
 }
 
 void set_event( struct event *event )
 {
-    event->signaled = 1;
+    if (event->esync) esync_set_event( event->esync );
+    else event->signaled = 1;
     /* wake up all waiters if manual reset, a single one otherwise */
     wake_up( &event->obj, !event->manual_reset );
 }
 
 void reset_event( struct event *event )
 {
-    event->signaled = 0;
+    if (event->esync) esync_reset_event( event->esync );
+    else event->signaled = 0;
+}
+
+static int get_event_state( struct event *event )
+{
+    if (event->esync) return esync_state( event->esync )->value;
+    return event->signaled;
 }
 
 static void event_dump( struct object *obj, int verbose )
@@ -154,7 +178,7 @@ static void event_dump( struct object *obj, int verbose )
     struct event *event = (struct event *)obj;
     assert( obj->ops == &event_ops );
     fprintf( stderr, "Event manual=%d signaled=%d\n",
-             event->manual_reset, event->signaled );
+             event->manual_reset, get_event_state( event ) );
 }
 
 static struct object_type *event_get_type( struct object *obj )
@@ -164,10 +188,27 @@ static struct object_type *event_get_type( struct object *obj )
     return get_object_type( &str );
 }
 
+static int event_add_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct event *event = (struct event *)obj;
+    assert( obj->ops == &event_ops );
+    if (event->esync) return esync_add_queue( event->esync, entry );
+    return add_queue( obj, entry );
+}
+
+static void event_remove_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct event *event = (struct event *)obj;
+    assert( obj->ops == &event_ops );
+    if (event->esync) esync_remove_queue( event->esync, entry );
+    else remove_queue( obj, entry );
+}
+
 static int event_signaled( struct object *obj, struct wait_queue_entry *entry )
 {
     struct event *event = (struct event *)obj;
     assert( obj->ops == &event_ops );
+    if (event->esync) return esync_signaled( event->esync, entry );
     return event->signaled;
 }
 
@@ -175,8 +216,9 @@ static void event_satisfied( struct object *obj, struct wait_queue_entry *entry
 {
     struct event *event = (struct event *)obj;
     assert( obj->ops == &event_ops );
+    if (event->esync) esync_satisfied( event->esync, entry );
     /* Reset if it's an auto-reset event */
-    if (!event->manual_reset) event->signaled = 0;
+    else if (!event->manual_reset) event->signaled = 0;
 }
 
 static unsigned int event_map_access( struct object *obj, unsigned int access )
@@ -202,6 +244,13 @@ static int event_signal( struct object *obj, unsigned int access )
     return 1;
 }
 
+static void event_destroy( struct object *obj )
+{
+    struct event *event = (struct event *)obj;
+    assert( obj->ops == &event_ops );
+    destroy_esync( event->esync );
+}
+
 struct keyed_event *create_keyed_event( struct object *root, const struct unicode_str *name,
                                         unsigned int attr, const struct security_descriptor *sd )
 {
@@ -337,7 +386,7 @@ DECL_HANDLER(query_event)
     if (!(event = get_event_obj( current->process, req->handle, EVENT_QUERY_STATE ))) return;
 
     reply->manual_reset = event->manual_reset;
-    reply->state = event->signaled;
+    reply->state = get_event_state( event );
 
     release_object( event );
 }
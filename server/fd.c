@@ -2530,6 +2530,32 @@ DECL_HANDLER(get_handle_fd)
     }
 }
 
+/* send the unix fd of a newly opened handle to the client so that it can cache it right away */
+enum server_fd_type send_cacheable_fd( struct object *obj, obj_handle_t handle,
+                                       unsigned int *access, unsigned int *options )
+{
+    enum server_fd_type type = FD_TYPE_INVALID;
+    struct fd *fd;
+
+    *access = get_handle_access( current->process, handle );
+    /* don't bother for handles that can't be used for I/O */
+    if (!(*access & (FILE_READ_DATA | FILE_WRITE_DATA | FILE_APPEND_DATA))) return type;
+
+    if (!(fd = get_obj_fd( obj )))
+    {
+        clear_error();
+        return type;
+    }
+    if (fd->cacheable && fd->unix_fd != -1 &&
+        send_client_fd( current->process, fd->unix_fd, handle ) != -1)
+    {
+        type = fd->fd_ops->get_fd_type( fd );
+        *options = fd->options;
+    }
+    release_object( fd );
+    return type;
+}
+
 /* perform a read on a file object */
 DECL_HANDLER(read)
 {
@@ -2642,6 +2668,21 @@ DECL_HANDLER(add_fd_completion)
     }
 }
 
+/* retrieve the completion port associated with an fd */
+DECL_HANDLER(get_fd_completion)
+{
+    struct fd *fd = get_handle_fd_obj( current->process, req->handle, 0 );
+    if (fd)
+    {
+        if (fd->completion)
+        {
+            reply->port = alloc_handle( current->process, fd->completion, IO_COMPLETION_MODIFY_STATE, 0 );
+            reply->ckey = fd->comp_key;
+        }
+        release_object( fd );
+    }
+}
+
 /* set fd completion information */
 DECL_HANDLER(set_fd_completion_mode)
 {
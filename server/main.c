@@ -140,6 +140,8 @@ int main( int argc, char *argv[] )
 
     sock_init();
     open_master_socket();
+    if (do_esync()) esync_init();
+    init_user_shared_state();
 
     if (debug_level) fprintf( stderr, "wineserver: starting (pid=%ld)\n", (long) getpid() );
     init_signals();
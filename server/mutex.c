@@ -43,10 +43,13 @@ struct mutex
     unsigned int   count;           /* recursion count */
     int            abandoned;       /* has it been abandoned? */
     struct list    entry;           /* entry in owner thread mutex list */
+    struct esync  *esync;           /* shared state for in-process waits */
 };
 
 static void mutex_dump( struct object *obj, int verbose );
 static struct object_type *mutex_get_type( struct object *obj );
+static int mutex_add_queue( struct object *obj, struct wait_queue_entry *entry );
+static void mutex_remove_queue( struct object *obj, struct wait_queue_entry *entry );
 static int mutex_signaled( struct object *obj, struct wait_queue_entry *entry );
 static void mutex_satisfied( struct object *obj, struct wait_queue_entry *entry );
 static unsigned int mutex_map_access( struct object *obj, unsigned int access );
@@ -58,8 +61,8 @@ static const struct object_ops mutex_ops =
     sizeof(struct mutex),      /* size */
     mutex_dump,                /* dump */
     mutex_get_type,            /* get_type */
-    add_queue,                 /* add_queue */
-    remove_queue,              /* remove_queue */
+    mutex_add_queue,           /* add_queue */
+    mutex_remove_queue,        /* remove_queue */
     mutex_signaled,            /* signaled */
     mutex_satisfied,           /* satisfied */
     mutex_signal,              /* signal */
@@ -112,7 +115,10 @@ static struct mutex *create_mutex( struct object *root, const struct unicode_str
             mutex->count = 0;
             mutex->owner = NULL;
             mutex->abandoned = 0;
-            if (owned) do_grab( mutex, current );
+            mutex->esync = NULL;
+            if (do_esync())
+                mutex->esync = create_esync( &mutex->obj, ESYNC_MUTEX, owned ? current->id : 0, !!owned );
+            if (owned && !mutex->esync) do_grab( mutex, current );
         }
     }
     return mutex;
@@ -130,13 +136,24 @@ void abandon_mutexes( struct thread *thread )
         mutex->abandoned = 1;
         do_release( mutex );
     }
+    if (do_esync()) esync_abandon_mutexes( thread );
+}
+
+struct esync *get_mutex_esync( struct object *obj )
+{
+    if (obj->ops != &mutex_ops) return NULL;
+    return ((struct mutex *)obj)->esync;
 }
 
 static void mutex_dump( struct object *obj, int verbose )
 {
     struct mutex *mutex = (struct mutex *)obj;
     assert( obj->ops == &mutex_ops );
-    fprintf( stderr, "Mutex count=%u owner=%p\n", mutex->count, mutex->owner );
+    if (mutex->esync)
+        fprintf( stderr, "Mutex count=%u owner=%04x\n", esync_state( mutex->esync )->count,
+                 esync_state( mutex->esync )->value );
+    else
+        fprintf( stderr, "Mutex count=%u owner=%p\n", mutex->count, mutex->owner );
 }
 
 static struct object_type *mutex_get_type( struct object *obj )
@@ -146,10 +163,27 @@ static struct object_type *mutex_get_type( struct object *obj )
     return get_object_type( &str );
 }
 
+static int mutex_add_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct mutex *mutex = (struct mutex *)obj;
+    assert( obj->ops == &mutex_ops );
+    if (mutex->esync) return esync_add_queue( mutex->esync, entry );
+    return add_queue( obj, entry );
+}
+
+static void mutex_remove_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct mutex *mutex = (struct mutex *)obj;
+    assert( obj->ops == &mutex_ops );
+    if (mutex->esync) esync_remove_queue( mutex->esync, entry );
+    else remove_queue( obj, entry );
+}
+
 static int mutex_signaled( struct object *obj, struct wait_queue_entry *entry )
 {
     struct mutex *mutex = (struct mutex *)obj;
     assert( obj->ops == &mutex_ops );
+    if (mutex->esync) return esync_signaled( mutex->esync, entry );
     return (!mutex->count || (mutex->owner == get_wait_queue_thread( entry )));
 }
 
@@ -158,6 +192,11 @@ static void mutex_satisfied( struct object *obj, struct wait_queue_entry *entry
     struct mutex *mutex = (struct mutex *)obj;
     assert( obj->ops == &mutex_ops );
 
+    if (mutex->esync)
+    {
+        esync_satisfied( mutex->esync, entry );
+        return;
+    }
     do_grab( mutex, get_wait_queue_thread( entry ));
     if (mutex->abandoned) make_wait_abandoned( entry );
     mutex->abandoned = 0;
@@ -182,6 +221,12 @@ static int mutex_signal( struct object *obj, unsigned int access )
         set_error( STATUS_ACCESS_DENIED );
         return 0;
     }
+    if (mutex->esync)
+    {
+        if (!esync_release_mutex( mutex->esync, NULL )) return 0;
+        wake_up( &mutex->obj, 0 );
+        return 1;
+    }
     if (!mutex->count || (mutex->owner != current))
     {
         set_error( STATUS_MUTANT_NOT_OWNED );
@@ -196,6 +241,7 @@ static void mutex_destroy( struct object *obj )
     struct mutex *mutex = (struct mutex *)obj;
     assert( obj->ops == &mutex_ops );
 
+    destroy_esync( mutex->esync );
     if (!mutex->count) return;
     mutex->count = 0;
     do_release( mutex );
@@ -242,7 +288,11 @@ DECL_HANDLER(release_mutex)
     if ((mutex = (struct mutex *)get_handle_obj( current->process, req->handle,
                                                  0, &mutex_ops )))
     {
-        if (!mutex->count || (mutex->owner != current)) set_error( STATUS_MUTANT_NOT_OWNED );
+        if (mutex->esync)
+        {
+            if (esync_release_mutex( mutex->esync, &reply->prev_count )) wake_up( &mutex->obj, 0 );
+        }
+        else if (!mutex->count || (mutex->owner != current)) set_error( STATUS_MUTANT_NOT_OWNED );
         else
         {
             reply->prev_count = mutex->count;
@@ -260,9 +310,19 @@ DECL_HANDLER(query_mutex)
     if ((mutex = (struct mutex *)get_handle_obj( current->process, req->handle,
                                                  MUTANT_QUERY_STATE, &mutex_ops )))
     {
-        reply->count = mutex->count;
-        reply->owned = (mutex->owner == current);
-        reply->abandoned = mutex->abandoned;
+        if (mutex->esync)
+        {
+            struct esync_state *state = esync_state( mutex->esync );
+            reply->count = state->count;
+            reply->owned = (state->value == current->id);
+            reply->abandoned = state->abandoned;
+        }
+        else
+        {
+            reply->count = mutex->count;
+            reply->owned = (mutex->owner == current);
+            reply->abandoned = mutex->abandoned;
+        }
 
         release_object( mutex );
     }
@@ -122,6 +122,8 @@ struct wait_queue_entry
     struct list         entry;
     struct object      *obj;
     struct thread_wait *wait;
+    struct esync       *esync;      /* esync object grabbed by the signaled check */
+    int                 esync_abandoned;
 };
 
 extern void *mem_alloc( size_t size );  /* malloc wrapper */
@@ -190,6 +192,34 @@ extern void reset_event( struct event *event );
 
 extern void abandon_mutexes( struct thread *thread );
 
+/* esync functions */
+
+struct esync;
+
+extern int do_esync(void);
+extern void esync_init(void);
+extern struct esync *create_esync( struct object *obj, enum esync_type type, int value, unsigned int count );
+extern void destroy_esync( struct esync *esync );
+extern struct esync_state *esync_state( struct esync *esync );
+extern void esync_wake( struct esync *esync, unsigned int count );
+extern int esync_add_queue( struct esync *esync, struct wait_queue_entry *entry );
+extern void esync_remove_queue( struct esync *esync, struct wait_queue_entry *entry );
+extern int esync_signaled( struct esync *esync, struct wait_queue_entry *entry );
+extern void esync_satisfied( struct esync *esync, struct wait_queue_entry *entry );
+extern void esync_release_grab( struct wait_queue_entry *entry );
+extern void esync_set_event( struct esync *esync );
+extern void esync_reset_event( struct esync *esync );
+extern int esync_release_semaphore( struct esync *esync, unsigned int count, unsigned int *prev );
+extern int esync_release_mutex( struct esync *esync, unsigned int *prev );
+extern void esync_abandon_mutexes( struct thread *thread );
+extern struct esync *get_event_esync( struct object *obj );
+extern struct esync *get_semaphore_esync( struct object *obj );
+extern struct esync *get_mutex_esync( struct object *obj );
+
+/* user shared state functions */
+
+extern void init_user_shared_state(void);
+
 /* serial functions */
 
 int get_serial_async_timeout(struct object *obj, int type, int count);
@@ -22,12 +22,17 @@
 #include "wine/port.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #ifdef HAVE_POLL_H
 # include <poll.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -114,6 +119,7 @@ struct thread_input
     int                    cursor_count;  /* cursor show count */
     struct list            msg_list;      /* list of hardware messages */
     unsigned char          keystate[256]; /* state of each key */
+    unsigned int           shared_idx;    /* index of the state shared with the clients */
 };
 
 struct msg_queue
@@ -147,7 +153,7 @@ struct msg_queue
     struct shm_surface    *surface_flushed; /* currently flushed surface (it's set when get_message
                                              * returns flush message and cleaned on the next
                                              * get_message call) */
-
+    unsigned int           shared_idx;      /* index of the state shared with the clients */
 };
 
 struct hotkey
@@ -234,6 +240,138 @@ static unsigned int last_input_time;
 static void queue_hardware_message( struct desktop *desktop, struct message *msg, int always_queue );
 static void free_message( struct message *msg );
 
+#define USER_SHM_MAX_SLOTS (USER_SHM_SIZE / sizeof(struct user_shared_state))
+
+static struct object *shared_mapping;            /* section holding the shared states */
+static struct user_shared_state *shared_states;  /* server mapping of the section */
+static unsigned int *free_shared_slots;          /* stack of freed slots */
+static unsigned int nb_free_shared_slots;
+static unsigned int next_shared_slot = 1;        /* slot 0 is never used */
+static unsigned int next_shared_id = 1;
+
+/* create the section holding the shared states; clients map it read-only */
+void init_user_shared_state(void)
+{
+    struct fd *fd;
+    void *ptr;
+    int unix_fd;
+
+    if (!(shared_mapping = create_mapping( NULL, NULL, 0, USER_SHM_SIZE, SEC_COMMIT, 0, 0, NULL )))
+    {
+        fprintf( stderr, "wineserver: cannot create user state section: %08x\n", get_error() );
+        return;
+    }
+    make_object_static( shared_mapping );
+    fd = get_obj_fd( shared_mapping );
+    unix_fd = get_unix_fd( fd );
+    release_object( fd );
+    if (unix_fd == -1 ||
+        (ptr = mmap( NULL, USER_SHM_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, unix_fd, 0 )) == MAP_FAILED)
+    {
+        fprintf( stderr, "wineserver: cannot map user state section: %s\n", strerror( errno ));
+        goto error;
+    }
+    if (!(free_shared_slots = mem_alloc( USER_SHM_MAX_SLOTS * sizeof(*free_shared_slots) )))
+    {
+        munmap( ptr, USER_SHM_SIZE );
+        goto error;
+    }
+    shared_states = ptr;
+    return;
+
+error:
+    release_object( shared_mapping );
+    shared_mapping = NULL;
+}
+
+/* allocate a slot in the shared state section; returns 0 if none is available */
+unsigned int alloc_user_shared_state(void)
+{
+    unsigned int idx;
+
+    if (!shared_states) return 0;
+    if (nb_free_shared_slots) idx = free_shared_slots[--nb_free_shared_slots];
+    else if (next_shared_slot < USER_SHM_MAX_SLOTS) idx = next_shared_slot++;
+    else return 0;
+
+    shared_states[idx].id = next_shared_id++;
+    if (!next_shared_id) next_shared_id = 1;
+    return idx;
+}
+
+/* start updating a shared state; clients retry reading it until end_shared_update */
+static struct user_shared_state *begin_shared_update( unsigned int idx )
+{
+    struct user_shared_state *state = &shared_states[idx];
+    interlocked_xchg_add( (LONG *)&state->seq, 1 );
+    return state;
+}
+
+static void end_shared_update( struct user_shared_state *state )
+{
+    interlocked_xchg_add( (LONG *)&state->seq, 1 );
+}
+
+void free_user_shared_state( unsigned int idx )
+{
+    struct user_shared_state *state;
+
+    if (!idx) return;
+    state = begin_shared_update( idx );
+    state->id = 0;
+    memset( &state->u, 0, sizeof(state->u) );
+    end_shared_update( state );
+    free_shared_slots[nb_free_shared_slots++] = idx;
+}
+
+/* publish the desktop state to the clients */
+void update_shared_desktop( struct desktop *desktop )
+{
+    struct user_shared_state *state;
+
+    if (!desktop->shared_idx) return;
+    state = begin_shared_update( desktop->shared_idx );
+    state->u.desktop.cursor_x      = desktop->cursor.x;
+    state->u.desktop.cursor_y      = desktop->cursor.y;
+    state->u.desktop.cursor_change = desktop->cursor.last_change;
+    state->u.desktop.foreground    = desktop->foreground_input ? desktop->foreground_input->active : 0;
+    memcpy( state->u.desktop.keystate, desktop->keystate, sizeof(desktop->keystate) );
+    end_shared_update( state );
+}
+
+/* publish the thread input state to the clients */
+static void update_shared_input( struct thread_input *input )
+{
+    struct user_shared_state *state;
+
+    if (input->shared_idx)
+    {
+        state = begin_shared_update( input->shared_idx );
+        state->u.input.focus   = input->focus;
+        state->u.input.capture = input->capture;
+        state->u.input.active  = input->active;
+        memcpy( state->u.input.keystate, input->keystate, sizeof(input->keystate) );
+        end_shared_update( state );
+    }
+    /* the foreground window is the active window of the foreground input */
+    if (input->desktop->foreground_input == input) update_shared_desktop( input->desktop );
+}
+
+/* publish the message queue state to the clients */
+static void update_shared_queue( struct msg_queue *queue )
+{
+    struct user_shared_state *state;
+
+    if (!queue->shared_idx) return;
+    state = begin_shared_update( queue->shared_idx );
+    state->u.queue.wake_bits     = queue->wake_bits;
+    state->u.queue.changed_bits  = queue->changed_bits;
+    state->u.queue.surface_flush = queue->pending_surface_flush || queue->surface_flushed;
+    state->u.queue.input_idx     = queue->input->shared_idx;
+    state->u.queue.input_id      = queue->input->shared_idx ? shared_states[queue->input->shared_idx].id : 0;
+    end_shared_update( state );
+}
+
 /* set the caret window in a given thread input */
 static void set_caret_window( struct thread_input *input, user_handle_t win )
 {
@@ -266,12 +404,15 @@ static struct thread_input *create_thread_input( struct thread *thread )
         list_init( &input->msg_list );
         set_caret_window( input, 0 );
         memset( input->keystate, 0, sizeof(input->keystate) );
+        input->shared_idx   = 0;
 
         if (!(input->desktop = get_thread_desktop( thread, 0 /* FIXME: access rights */ )))
         {
             release_object( input );
             return NULL;
         }
+        input->shared_idx = alloc_user_shared_state();
+        update_shared_input( input );
     }
     return input;
 }
@@ -308,6 +449,7 @@ static struct msg_queue *create_msg_queue( struct thread *thread, struct thread_
         queue->last_get_msg    = current_time;
         queue->pending_surface_flush = 0;
         queue->surface_flushed = NULL;
+        queue->shared_idx      = alloc_user_shared_state();
         list_init( &queue->send_result );
         list_init( &queue->callback_result );
         list_init( &queue->pending_timers );
@@ -315,6 +457,7 @@ static struct msg_queue *create_msg_queue( struct thread *thread, struct thread_
         for (i = 0; i < NB_MSG_KINDS; i++) list_init( &queue->msg_list[i] );
 
         thread->queue = queue;
+        update_shared_queue( queue );
     }
     if (new_input) release_object( new_input );
     return queue;
@@ -346,6 +489,7 @@ static int assign_thread_input( struct thread *thread, struct thread_input *new_
     }
     queue->input = (struct thread_input *)grab_object( new_input );
     new_input->cursor_count += queue->cursor_count;
+    update_shared_queue( queue );
     return 1;
 }
 
@@ -432,6 +576,7 @@ static void set_foreground_input( struct desktop *desktop, struct thread_input *
     if (desktop->foreground_input == input) return;
     set_clip_rectangle( desktop, NULL, 1 );
     desktop->foreground_input = input;
+    update_shared_desktop( desktop );
 }
 
 /* get the hook table for a given thread */
@@ -462,6 +607,7 @@ static inline void set_queue_bits( struct msg_queue *queue, unsigned int bits )
 {
     queue->wake_bits |= bits;
     queue->changed_bits |= bits;
+    update_shared_queue( queue );
     if (is_signaled( queue )) wake_up( &queue->obj, 0 );
 }
 
@@ -470,6 +616,7 @@ static inline void clear_queue_bits( struct msg_queue *queue, unsigned int bits
 {
     queue->wake_bits &= ~bits;
     queue->changed_bits &= ~bits;
+    update_shared_queue( queue );
 }
 
 /* check whether msg is a keyboard message */
@@ -929,6 +1076,7 @@ static void clear_flushed_surface( struct msg_queue *queue )
         unlock_surface( queue->surface_flushed );
         release_object( queue->surface_flushed );
         queue->surface_flushed = NULL;
+        update_shared_queue( queue );
     }
 }
 
@@ -1025,6 +1173,7 @@ static void msg_queue_destroy( struct object *obj )
     }
     if (queue->timeout) remove_timeout_user( queue->timeout );
     queue->input->cursor_count -= queue->cursor_count;
+    free_user_shared_state( queue->shared_idx );
     release_object( queue->input );
     if (queue->hooks) release_object( queue->hooks );
     if (queue->fd) release_object( queue->fd );
@@ -1047,6 +1196,7 @@ void wake_queue_for_surface( struct process *process )
     {
         if (!thread->queue || list_empty( &thread->queue->obj.wait_queue )) continue;
         thread->queue->pending_surface_flush = 1;
+        update_shared_queue( thread->queue );
         wake_up( &thread->queue->obj, 0 );
         return;
     }
@@ -1064,6 +1214,7 @@ static void thread_input_destroy( struct object *obj )
     struct thread_input *input = (struct thread_input *)obj;
 
     empty_msg_list( &input->msg_list );
+    free_user_shared_state( input->shared_idx );
     if (input->desktop)
     {
         if (input->desktop->foreground_input == input) set_foreground_input( input->desktop, NULL );
@@ -1082,6 +1233,7 @@ static inline void thread_input_cleanup_window( struct msg_queue *queue, user_ha
     if (window == input->menu_owner) input->menu_owner = 0;
     if (window == input->move_size) input->move_size = 0;
     if (window == input->caret) set_caret_window( input, 0 );
+    update_shared_input( input );
 }
 
 /* check if the specified window can be set in the input data of a given queue */
@@ -1137,6 +1289,7 @@ int attach_thread_input( struct thread *thread_from, struct thread *thread_to )
 
     ret = assign_thread_input( thread_from, input );
     if (ret) memset( input->keystate, 0, sizeof(input->keystate) );
+    update_shared_input( input );
     release_object( input );
     return ret;
 }
@@ -1167,7 +1320,9 @@ void detach_thread_input( struct thread *thread_from )
             }
             release_object( thread );
         }
+        update_shared_input( old_input );
         assign_thread_input( thread_from, input );
+        update_shared_input( input );
         release_object( input );
     }
 }
@@ -1401,6 +1556,7 @@ static void release_hardware_message( struct msg_queue *queue, unsigned int hw_i
         if (clr_bit) clear_queue_bits( queue, clr_bit );
 
         update_input_key_state( input->desktop, input->keystate, msg );
+        update_shared_input( input );
         list_remove( &msg->entry );
         free_message( msg );
     }
@@ -1525,7 +1681,11 @@ static void queue_hardware_message( struct desktop *desktop, struct message *msg
 
     if (is_keyboard_msg( msg ))
     {
-        if (queue_hotkey_message( desktop, msg )) return;
+        if (queue_hotkey_message( desktop, msg ))
+        {
+            update_shared_desktop( desktop );
+            return;
+        }
         if (desktop->keystate[VK_MENU] & 0x80) msg->lparam |= KF_ALTDOWN << 16;
         if (msg->wparam == VK_SHIFT || msg->wparam == VK_LSHIFT || msg->wparam == VK_RSHIFT)
             msg->lparam &= ~(KF_EXTENDED << 16);
@@ -1549,6 +1709,7 @@ static void queue_hardware_message( struct desktop *desktop, struct message *msg
         if (desktop->keystate[VK_XBUTTON1] & 0x80) msg->wparam |= MK_XBUTTON1;
         if (desktop->keystate[VK_XBUTTON2] & 0x80) msg->wparam |= MK_XBUTTON2;
     }
+    update_shared_desktop( desktop );
     msg->x = desktop->cursor.x;
     msg->y = desktop->cursor.y;
 
@@ -1562,7 +1723,11 @@ static void queue_hardware_message( struct desktop *desktop, struct message *msg
     win = find_hardware_message_window( desktop, input, msg, &msg_code, &thread );
     if (!win || !thread)
     {
-        if (input) update_input_key_state( input->desktop, input->keystate, msg );
+        if (input)
+        {
+            update_input_key_state( input->desktop, input->keystate, msg );
+            update_shared_input( input );
+        }
         free_message( msg );
         return;
     }
@@ -1953,6 +2118,7 @@ static int get_hardware_message( struct thread *thread, unsigned int hw_id, user
         {
             /* no window at all, remove it */
             update_input_key_state( input->desktop, input->keystate, msg );
+            update_shared_input( input );
             list_remove( &msg->entry );
             free_message( msg );
             continue;
@@ -1969,6 +2135,7 @@ static int get_hardware_message( struct thread *thread, unsigned int hw_id, user
             {
                 /* for another thread input, drop it */
                 update_input_key_state( input->desktop, input->keystate, msg );
+                update_shared_input( input );
                 list_remove( &msg->entry );
                 free_message( msg );
             }
@@ -2270,6 +2437,7 @@ DECL_HANDLER(get_queue_status)
         reply->wake_bits    = queue->wake_bits;
         reply->changed_bits = queue->changed_bits;
         queue->changed_bits &= ~req->clear_bits;
+        update_shared_queue( queue );
     }
     else reply->wake_bits = reply->changed_bits = 0;
 }
@@ -2442,6 +2610,7 @@ DECL_HANDLER(get_message)
             set_reply_data( &bounds, sizeof(bounds) );
             get_message_defaults( queue, &reply->x, &reply->y, &reply->time );
             queue->surface_flushed = surface;
+            update_shared_queue( queue );
             return;
         }
         queue->pending_surface_flush = 0;
@@ -2463,6 +2632,7 @@ DECL_HANDLER(get_message)
     }
     if (filter & QS_INPUT) queue->changed_bits &= ~QS_INPUT;
     if (filter & QS_PAINT) queue->changed_bits &= ~QS_PAINT;
+    update_shared_queue( queue );
 
     /* then check for posted messages */
     if ((filter & QS_POSTMESSAGE) &&
@@ -2892,7 +3062,11 @@ DECL_HANDLER(get_key_state)
         if (req->key >= 0)
         {
             reply->state = desktop->keystate[req->key & 0xff];
-            desktop->keystate[req->key & 0xff] &= ~0x40;
+            if (desktop->keystate[req->key & 0xff] & 0x40)
+            {
+                desktop->keystate[req->key & 0xff] &= ~0x40;
+                update_shared_desktop( desktop );
+            }
         }
         set_reply_data( desktop->keystate, size );
         release_object( desktop );
@@ -2934,15 +3108,21 @@ DECL_HANDLER(set_key_state)
     {
         if (!(desktop = get_thread_desktop( current, 0 ))) return;
         memcpy( desktop->keystate, get_req_data(), size );
+        update_shared_desktop( desktop );
         release_object( desktop );
     }
     else
     {
         if (!(thread = get_thread_from_id( req->tid ))) return;
-        if (thread->queue) memcpy( thread->queue->input->keystate, get_req_data(), size );
+        if (thread->queue)
+        {
+            memcpy( thread->queue->input->keystate, get_req_data(), size );
+            update_shared_input( thread->queue->input );
+        }
         if (req->async && (desktop = get_thread_desktop( thread, 0 )))
         {
             memcpy( desktop->keystate, get_req_data(), size );
+            update_shared_desktop( desktop );
             release_object( desktop );
         }
         release_object( thread );
@@ -2986,6 +3166,7 @@ DECL_HANDLER(set_focus_window)
     {
         reply->previous = queue->input->focus;
         queue->input->focus = get_user_full_handle( req->handle );
+        update_shared_input( queue->input );
     }
 }
 
@@ -3002,6 +3183,7 @@ DECL_HANDLER(set_active_window)
         {
             reply->previous = queue->input->active;
             queue->input->active = get_user_full_handle( req->handle );
+            update_shared_input( queue->input );
         }
         else set_error( STATUS_INVALID_HANDLE );
     }
@@ -3029,6 +3211,7 @@ DECL_HANDLER(set_capture_window)
         input->menu_owner = (req->flags & CAPTURE_MENU) ? input->capture : 0;
         input->move_size = (req->flags & CAPTURE_MOVESIZE) ? input->capture : 0;
         reply->full_handle = input->capture;
+        update_shared_input( input );
     }
 }
 
@@ -3172,3 +3355,28 @@ DECL_HANDLER(update_rawinput_devices)
     e = find_rawinput_device( 1, 6 );
     current->process->rawinput_kbd   = e ? &e->device : NULL;
 }
+
+/* retrieve the indices of the current thread states in the shared memory */
+DECL_HANDLER(get_shared_state)
+{
+    struct desktop *desktop;
+
+    if ((desktop = get_thread_desktop( current, 0 )))
+    {
+        reply->desktop_idx = desktop->shared_idx;
+        release_object( desktop );
+    }
+    else clear_error();
+    reply->queue_idx = current->queue ? current->queue->shared_idx : 0;
+}
+
+/* get a handle to the section holding the shared states */
+DECL_HANDLER(get_user_shared_mapping)
+{
+    if (!shared_mapping)
+    {
+        set_error( STATUS_NOT_SUPPORTED );
+        return;
+    }
+    reply->handle = alloc_handle( current->process, shared_mapping, SECTION_QUERY | SECTION_MAP_READ, 0 );
+}
@@ -35,6 +35,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+# include <sys/mman.h>
+#endif
 #include <unistd.h>
 
 #include "ntstatus.h"
@@ -125,11 +128,16 @@ struct save_branch_info
 {
     struct key  *key;
     const char  *path;
+    char        *bin_path;          /* path of the binary file */
+    file_pos_t   bin_size;          /* size of the valid data in the binary file, 0 if none */
+    file_pos_t   bin_snapshot_size; /* size of the snapshot part of the binary file */
+    int          text_stale;        /* text file is older than the binary file */
 };
 
 #define MAX_SAVE_BRANCH_INFO 3
 static int save_branch_count;
 static struct save_branch_info save_branch_info[MAX_SAVE_BRANCH_INFO];
+static int binary_registry;  /* save in binary format as well */
 
 
 /* information about a file being loaded */
@@ -513,6 +521,17 @@ static void make_dirty( struct key *key )
     }
 }
 
+/* mark a key and all its subkeys as dirty */
+static void make_subtree_dirty( struct key *key )
+{
+    int i;
+
+    if (key->flags & KEY_VOLATILE) return;
+    make_dirty( key );
+    key->flags |= KEY_DIRTY;
+    for (i = 0; i <= key->last_subkey; i++) make_subtree_dirty( key->subkeys[i] );
+}
+
 /* mark a key and all its subkeys as clean (not modified) */
 static void make_clean( struct key *key )
 {
@@ -1709,33 +1728,441 @@ static void load_registry( struct key *key, obj_handle_t handle )
         {
             load_keys( key, NULL, f, -1 );
             fclose( f );
+            /* the keys have not been saved yet, make sure they get into the binary journal */
+            make_subtree_dirty( key );
         }
         else file_set_error();
     }
 }
 
-/* load one of the initial registry files */
-static int load_init_registry_from_file( const char *filename, struct key *key )
+/* binary registry format
+ *
+ * Each branch can be saved in a binary file next to the text file. It contains a
+ * snapshot of the branch followed by journal batches appended by the periodic saves.
+ * The header records the identity of the text file the binary data supersedes, so
+ * that a text file modified behind our back takes precedence.
+ */
+
+#define BIN_REG_MAGIC        0x47455257  /* "WREG" */
+#define BIN_REG_VERSION      1
+#define BIN_BATCH_MAGIC      0x48435442  /* "BTCH" */
+#define BIN_JOURNAL_MIN_SIZE (4 * 1024 * 1024)  /* journal size always allowed before compacting */
+
+#define BIN_KEY_SYMLINK  0x0001  /* key is a symbolic link */
+#define BIN_KEY_SUBKEYS  0x0002  /* record contains the full list of subkeys */
+
+struct bin_reg_header
 {
-    FILE *f;
+    unsigned int   magic;
+    unsigned int   version;
+    unsigned int   prefix_type;
+    unsigned int   text_mtime_nsec;  /* identity of the text file */
+    file_pos_t     text_size;
+    file_pos_t     text_ino;
+    timeout_t      text_mtime;
+};
+
+struct bin_batch_header
+{
+    unsigned int   magic;
+    unsigned int   size;             /* size of the records following the header */
+    unsigned int   checksum;
+    unsigned int   reserved;
+};
+
+/* a key record, followed by the key name, the class, the values and optionally the subkey names */
+struct bin_key_record
+{
+    unsigned int   depth;            /* depth from the branch root, which has depth 0 */
+    unsigned int   flags;
+    timeout_t      modif;
+    unsigned int   namelen;
+    unsigned int   classlen;
+    unsigned int   nb_values;
+    unsigned int   nb_subkeys;       /* only with BIN_KEY_SUBKEYS */
+};
+
+/* a value record, followed by the value name and data */
+struct bin_value_record
+{
+    unsigned int   type;
+    unsigned int   namelen;
+    data_size_t    len;
+};
+
+struct bin_buffer
+{
+    char          *data;
+    size_t         size;
+    size_t         alloc;
+    int            error;
+};
+
+static void bin_write( struct bin_buffer *buf, const void *data, size_t size )
+{
+    if (buf->error || !size) return;
+    if (buf->size + size > buf->alloc)
+    {
+        size_t alloc = max( buf->alloc * 2, buf->size + size + 4096 );
+        char *ptr;
+
+        if (!(ptr = realloc( buf->data, alloc )))
+        {
+            buf->error = 1;
+            return;
+        }
+        buf->data = ptr;
+        buf->alloc = alloc;
+    }
+    memcpy( buf->data + buf->size, data, size );
+    buf->size += size;
+}
+
+static unsigned int bin_checksum( const void *data, size_t size )
+{
+    const unsigned char *ptr = data;
+    unsigned int sum = 0x811c9dc5;
+
+    while (size--) sum = (sum ^ *ptr++) * 0x01000193;
+    return sum;
+}
+
+static void get_text_identity( const struct stat *st, struct bin_reg_header *header )
+{
+    header->text_size  = st->st_size;
+    header->text_ino   = st->st_ino;
+    header->text_mtime = st->st_mtime;
+#ifdef HAVE_STRUCT_STAT_ST_MTIM
+    header->text_mtime_nsec = st->st_mtim.tv_nsec;
+#else
+    header->text_mtime_nsec = 0;
+#endif
+}
 
-    if ((f = fopen( filename, "r" )))
+/* save a key and its subkeys in binary format; in journal mode only dirty keys are saved */
+static void save_binary_key( struct bin_buffer *buf, const struct key *key, unsigned int depth, int journal )
+{
+    struct bin_key_record rec;
+    struct bin_value_record val;
+    int i;
+
+    if (key->flags & KEY_VOLATILE) return;
+    if (journal && !(key->flags & KEY_DIRTY)) return;
+
+    rec.depth      = depth;
+    rec.flags      = journal ? BIN_KEY_SUBKEYS : 0;
+    rec.modif      = key->modif;
+    rec.namelen    = depth ? key->namelen : 0;
+    rec.classlen   = key->class ? key->classlen : 0;
+    rec.nb_values  = key->last_value + 1;
+    rec.nb_subkeys = 0;
+    if (key->flags & KEY_SYMLINK) rec.flags |= BIN_KEY_SYMLINK;
+    if (journal)
+        for (i = 0; i <= key->last_subkey; i++)
+            if (!(key->subkeys[i]->flags & KEY_VOLATILE)) rec.nb_subkeys++;
+
+    bin_write( buf, &rec, sizeof(rec) );
+    bin_write( buf, key->name, rec.namelen );
+    bin_write( buf, key->class, rec.classlen );
+    for (i = 0; i <= key->last_value; i++)
     {
-        load_keys( key, filename, f, 0 );
-        fclose( f );
-        if (get_error() == STATUS_NOT_REGISTRY_FILE)
+        val.type    = key->values[i].type;
+        val.namelen = key->values[i].namelen;
+        val.len     = key->values[i].len;
+        bin_write( buf, &val, sizeof(val) );
+        bin_write( buf, key->values[i].name, val.namelen );
+        bin_write( buf, key->values[i].data, val.len );
+    }
+    if (journal)
+    {
+        for (i = 0; i <= key->last_subkey; i++)
         {
-            fprintf( stderr, "%s is not a valid registry file\n", filename );
-            return 1;
+            unsigned int len = key->subkeys[i]->namelen;
+
+            if (key->subkeys[i]->flags & KEY_VOLATILE) continue;
+            bin_write( buf, &len, sizeof(len) );
+            bin_write( buf, key->subkeys[i]->name, len );
+        }
+    }
+    for (i = 0; i <= key->last_subkey; i++) save_binary_key( buf, key->subkeys[i], depth + 1, journal );
+}
+
+/* save a batch of binary records for a branch */
+static int save_binary_batch( struct bin_buffer *buf, const struct key *key, int journal )
+{
+    struct bin_batch_header batch;
+    size_t pos = buf->size;
+
+    memset( &batch, 0, sizeof(batch) );
+    bin_write( buf, &batch, sizeof(batch) );
+    save_binary_key( buf, key, 0, journal );
+    if (buf->error || buf->size - pos - sizeof(batch) > UINT_MAX) return 0;
+
+    batch.magic    = BIN_BATCH_MAGIC;
+    batch.size     = buf->size - pos - sizeof(batch);
+    batch.checksum = bin_checksum( buf->data + pos + sizeof(batch), batch.size );
+    memcpy( buf->data + pos, &batch, sizeof(batch) );
+    return 1;
+}
+
+struct bin_reader
+{
+    const char    *ptr;
+    const char    *end;
+};
+
+static const void *bin_read( struct bin_reader *reader, size_t size )
+{
+    const void *ret = reader->ptr;
+
+    if ((size_t)(reader->end - reader->ptr) < size) return NULL;
+    reader->ptr += size;
+    return ret;
+}
+
+/* replace the values of a key by the ones from a binary record */
+static int load_binary_values( struct key *key, struct bin_reader *reader, unsigned int count )
+{
+    struct bin_value_record val;
+    struct key_value *value;
+    struct unicode_str name;
+    const void *ptr, *data;
+    int i, index;
+
+    for (i = 0; i <= key->last_value; i++)
+    {
+        free( key->values[i].name );
+        free( key->values[i].data );
+    }
+    key->last_value = -1;
+
+    while (count--)
+    {
+        if (!(ptr = bin_read( reader, sizeof(val) ))) return 0;
+        memcpy( &val, ptr, sizeof(val) );
+        if (!(name.str = bin_read( reader, val.namelen ))) return 0;
+        name.len = val.namelen;
+        if (!(data = bin_read( reader, val.len ))) return 0;
+
+        if (!(value = find_value( key, &name, &index )) && !(value = insert_value( key, &name, index )))
+            return 0;
+        free( value->data );
+        value->data = NULL;
+        if (val.len && !(value->data = memdup( data, val.len ))) return 0;
+        value->type = val.type;
+        value->len  = val.len;
+    }
+    return 1;
+}
+
+/* delete the subkeys of a key that are not in a binary record subkey list */
+static int load_binary_subkeys( struct key *key, struct bin_reader *reader, unsigned int count )
+{
+    const WCHAR *name;
+    const void *ptr;
+    unsigned int len;
+    int i = 0, res;
+
+    /* both lists are sorted in the same order as find_subkey() expects; subkeys that
+     * are listed but not loaded yet are created by the records that follow */
+    while (count--)
+    {
+        if (!(ptr = bin_read( reader, sizeof(len) ))) return 0;
+        memcpy( &len, ptr, sizeof(len) );
+        if (!(name = bin_read( reader, len ))) return 0;
+        while (i <= key->last_subkey)
+        {
+            struct key *subkey = key->subkeys[i];
+
+            res = memicmpW( subkey->name, name, min( subkey->namelen, len ) / sizeof(WCHAR) );
+            if (!res) res = subkey->namelen - len;
+            if (res > 0) break;  /* listed key comes before this one */
+            if (!res)
+            {
+                i++;
+                break;
+            }
+            if (subkey->flags & KEY_VOLATILE) i++;  /* volatile keys are never listed */
+            else free_subkey( key, i );
+        }
+    }
+    while (i <= key->last_subkey)
+    {
+        if (key->subkeys[i]->flags & KEY_VOLATILE) i++;
+        else free_subkey( key, i );
+    }
+    return 1;
+}
+
+/* load a batch of binary records into a branch */
+static int load_binary_batch( struct key *base, const char *data, size_t size )
+{
+    struct bin_reader reader = { data, data + size };
+    struct key **stack = NULL;
+    unsigned int depth = 0, stack_size = 0;
+    int ret = 0;
+
+    while (reader.ptr < reader.end)
+    {
+        struct bin_key_record rec;
+        struct unicode_str name;
+        struct key *key;
+        const void *ptr;
+        int index;
+
+        if (!(ptr = bin_read( &reader, sizeof(rec) ))) goto done;
+        memcpy( &rec, ptr, sizeof(rec) );
+        if (rec.depth > depth) goto done;  /* parent must have been seen already */
+        if (!(name.str = bin_read( &reader, rec.namelen ))) goto done;
+        name.len = rec.namelen;
+
+        if (!rec.depth) key = base;
+        else if (!(key = find_subkey( stack[rec.depth - 1], &name, &index )) &&
+                 !(key = alloc_subkey( stack[rec.depth - 1], &name, index, rec.modif )))
+            goto done;
+
+        if (rec.depth >= stack_size)
+        {
+            struct key **new_stack;
+            stack_size = max( 16, stack_size * 2 );
+            if (!(new_stack = realloc( stack, stack_size * sizeof(*stack) ))) goto done;
+            stack = new_stack;
+        }
+        stack[rec.depth] = key;
+        depth = rec.depth + 1;
+
+        key->modif = rec.modif;
+        if (rec.flags & BIN_KEY_SYMLINK) key->flags |= KEY_SYMLINK;
+        else key->flags &= ~KEY_SYMLINK;
+
+        if (!(ptr = bin_read( &reader, rec.classlen ))) goto done;
+        free( key->class );
+        key->class = NULL;
+        key->classlen = 0;
+        if (rec.classlen)
+        {
+            if (!(key->class = memdup( ptr, rec.classlen ))) goto done;
+            key->classlen = rec.classlen;
         }
+
+        if (!load_binary_values( key, &reader, rec.nb_values )) goto done;
+        if ((rec.flags & BIN_KEY_SUBKEYS) && !load_binary_subkeys( key, &reader, rec.nb_subkeys )) goto done;
     }
+    ret = 1;
+
+done:
+    free( stack );
+    return ret;
+}
+
+/* load a branch from its binary file if it is more recent than the text file */
+static int load_binary_registry( struct save_branch_info *info )
+{
+    struct bin_reg_header header, text_header;
+    struct stat st, text_st;
+    const struct bin_batch_header *batch;
+    file_pos_t pos, size;
+    char *data;
+    int fd, mapped = 0;
+
+    if (!info->bin_path) return 0;
+    if (stat( info->path, &text_st ) == -1) return 0;
+    if ((fd = open( info->bin_path, O_RDONLY )) == -1) return 0;
+    if (fstat( fd, &st ) == -1 || st.st_size < sizeof(header) + sizeof(*batch) ||
+        st.st_size != (size_t)st.st_size)
+    {
+        close( fd );
+        return 0;
+    }
+    size = st.st_size;
+
+#ifdef HAVE_SYS_MMAN_H
+    if ((data = mmap( NULL, size, PROT_READ, MAP_PRIVATE, fd, 0 )) != MAP_FAILED) mapped = 1;
+    else
+#endif
+    if ((data = malloc( size )) && read( fd, data, size ) != size)
+    {
+        free( data );
+        data = NULL;
+    }
+    close( fd );
+    if (!data) return 0;
+
+    memcpy( &header, data, sizeof(header) );
+    get_text_identity( &text_st, &text_header );
+    if (header.magic != BIN_REG_MAGIC || header.version != BIN_REG_VERSION ||
+        header.text_size != text_header.text_size || header.text_ino != text_header.text_ino ||
+        header.text_mtime != text_header.text_mtime ||
+        header.text_mtime_nsec != text_header.text_mtime_nsec)
+        goto done;
+    if (header.prefix_type != PREFIX_UNKNOWN)
+    {
+        if (prefix_type == PREFIX_UNKNOWN) prefix_type = header.prefix_type;
+        else if (header.prefix_type != prefix_type) goto done;
+    }
+
+    for (pos = sizeof(header); pos + sizeof(*batch) <= size; pos += sizeof(*batch) + batch->size)
+    {
+        batch = (const struct bin_batch_header *)(data + pos);
+        if (batch->magic != BIN_BATCH_MAGIC || batch->size > size - pos - sizeof(*batch)) break;
+        if (bin_checksum( batch + 1, batch->size ) != batch->checksum) break;
+        if (!load_binary_batch( info->key, (const char *)(batch + 1), batch->size )) break;
+        if (!info->bin_snapshot_size) info->bin_snapshot_size = pos + sizeof(*batch) + batch->size;
+        else info->text_stale = 1;  /* journal changes are not in the text file */
+        info->bin_size = pos + sizeof(*batch) + batch->size;
+    }
+    /* an incomplete batch at the end will be overwritten by the next append */
+
+    if (debug_level && info->bin_size)
+        fprintf( stderr, "%s: loaded %lu bytes of binary registry data\n",
+                 info->bin_path, (unsigned long)info->bin_size );
+
+done:
+#ifdef HAVE_SYS_MMAN_H
+    if (mapped) munmap( data, size );
+    else
+#endif
+    free( data );
+    if (!info->bin_size) info->bin_snapshot_size = 0;
+    return info->bin_size != 0;
+}
+
+/* load one of the initial registry files */
+static int load_init_registry_from_file( const char *filename, struct key *key )
+{
+    struct save_branch_info *info;
+    FILE *f = NULL;
+    int loaded;
 
     assert( save_branch_count < MAX_SAVE_BRANCH_INFO );
 
-    save_branch_info[save_branch_count].path = filename;
-    save_branch_info[save_branch_count++].key = (struct key *)grab_object( key );
+    info = &save_branch_info[save_branch_count];
+    memset( info, 0, sizeof(*info) );
+    info->path = filename;
+    info->key  = key;
+    if ((info->bin_path = malloc( strlen(filename) + sizeof(".bin") )))
+        sprintf( info->bin_path, "%s.bin", filename );
+
+    if (!(loaded = load_binary_registry( info )))
+    {
+        clear_error();
+        if ((f = fopen( filename, "r" )))
+        {
+            load_keys( key, filename, f, 0 );
+            fclose( f );
+            if (get_error() == STATUS_NOT_REGISTRY_FILE)
+            {
+                fprintf( stderr, "%s is not a valid registry file\n", filename );
+                free( info->bin_path );
+                return 1;
+            }
+        }
+    }
+
+    save_branch_count++;
+    grab_object( key );
     make_object_static( &key->obj );
-    return (f != NULL);
+    return loaded || f != NULL;
 }
 
 static WCHAR *format_user_registry_path( const SID *sid, struct unicode_str *path )
@@ -1807,6 +2234,8 @@ void init_registry(void)
     struct key *key, *hklm, *hkcu;
     char *p;
 
+    if ((p = getenv( "WINEBINREG" ))) binary_registry = atoi( p );
+
     /* switch to the config dir */
 
     if (fchdir( config_dir_fd ) == -1) fatal_error( "chdir to config dir: %s\n", strerror( errno ));
@@ -1917,14 +2346,14 @@ static void save_registry( struct key *key, obj_handle_t handle )
 }
 
 /* save a registry branch to a file */
-static int save_branch( struct key *key, const char *path )
+static int save_branch( struct key *key, const char *path, int force )
 {
     struct stat st;
     char *p, *tmp = NULL;
     int fd, count = 0, ret = 0;
     FILE *f;
 
-    if (!(key->flags & KEY_DIRTY))
+    if (!(key->flags & KEY_DIRTY) && !force)
     {
         if (debug_level > 1) dump_operation( key, NULL, "Not saving clean" );
         return 1;
@@ -1990,6 +2419,170 @@ done:
     return ret;
 }
 
+/* write a buffer to a file at the specified offset */
+static int write_all( int fd, const char *data, size_t size, file_pos_t pos )
+{
+    ssize_t ret;
+
+    while (size)
+    {
+        if ((ret = pwrite( fd, data, size, pos )) == -1)
+        {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        data += ret;
+        size -= ret;
+        pos += ret;
+    }
+    return 1;
+}
+
+/* write a new binary file containing a snapshot of the branch */
+static int write_binary_snapshot( struct save_branch_info *info )
+{
+    struct bin_buffer buf = { NULL };
+    struct bin_reg_header header;
+    struct stat st;
+    char *tmp;
+    int fd, ret = 0;
+
+    if (!info->bin_path || stat( info->path, &st ) == -1) return 0;
+    if (!(tmp = malloc( strlen(info->bin_path) + sizeof(".tmp") ))) return 0;
+    sprintf( tmp, "%s.tmp", info->bin_path );
+
+    memset( &header, 0, sizeof(header) );
+    header.magic       = BIN_REG_MAGIC;
+    header.version     = BIN_REG_VERSION;
+    header.prefix_type = prefix_type;
+    get_text_identity( &st, &header );
+    bin_write( &buf, &header, sizeof(header) );
+    if (!save_binary_batch( &buf, info->key, 0 )) goto done;
+
+    if ((fd = open( tmp, O_CREAT | O_TRUNC | O_WRONLY, 0666 )) == -1) goto done;
+    ret = write_all( fd, buf.data, buf.size, 0 );
+    if (close( fd )) ret = 0;
+    if (ret) ret = !rename( tmp, info->bin_path );
+    if (!ret) unlink( tmp );
+
+    if (ret)
+    {
+        if (debug_level > 1) fprintf( stderr, "%s: saved %lu bytes snapshot\n", info->bin_path, (unsigned long)buf.size );
+        if (info->key->flags & KEY_DIRTY) info->text_stale = 1;
+        make_clean( info->key );
+        info->bin_size = info->bin_snapshot_size = buf.size;
+    }
+
+done:
+    free( buf.data );
+    free( tmp );
+    return ret;
+}
+
+/* append the modified keys of the branch to the binary file */
+static int append_binary_journal( struct save_branch_info *info )
+{
+    struct bin_buffer buf = { NULL };
+    int fd, ret = 0;
+
+    if (!save_binary_batch( &buf, info->key, 1 )) goto done;
+    if ((fd = open( info->bin_path, O_WRONLY )) == -1) goto done;
+    /* overwrite any incomplete batch left at the end of the file */
+    ret = write_all( fd, buf.data, buf.size, info->bin_size ) &&
+          !ftruncate( fd, info->bin_size + buf.size );
+    if (close( fd )) ret = 0;
+
+    if (ret)
+    {
+        if (debug_level > 1) fprintf( stderr, "%s: appended %lu bytes\n", info->bin_path, (unsigned long)buf.size );
+        info->text_stale = 1;
+        make_clean( info->key );
+        info->bin_size += buf.size;
+    }
+
+done:
+    free( buf.data );
+    return ret;
+}
+
+/* update the text file identity in the binary file header after saving the text file */
+static void update_binary_identity( struct save_branch_info *info )
+{
+    struct bin_reg_header header;
+    struct stat st;
+    int fd, ret = 0;
+
+    if (stat( info->path, &st ) != -1 && (fd = open( info->bin_path, O_RDWR )) != -1)
+    {
+        if (pread( fd, &header, sizeof(header), 0 ) == sizeof(header))
+        {
+            get_text_identity( &st, &header );
+            ret = write_all( fd, (const char *)&header, sizeof(header), 0 );
+        }
+        if (close( fd )) ret = 0;
+    }
+    if (!ret)
+    {
+        unlink( info->bin_path );
+        info->bin_size = info->bin_snapshot_size = 0;
+    }
+}
+
+/* save a registry branch in binary format, only updating the text file when flushing */
+static int save_branch_binary( struct save_branch_info *info, int flush )
+{
+    struct key *key = info->key;
+    struct stat st;
+
+    if (info->bin_size && (key->flags & KEY_DIRTY))
+    {
+        /* compact the file once the journal gets larger than the snapshot */
+        if (info->bin_size - info->bin_snapshot_size > max( info->bin_snapshot_size, BIN_JOURNAL_MIN_SIZE ) ||
+            !append_binary_journal( info ))
+            info->bin_size = 0;
+    }
+
+    if (!info->bin_size)
+    {
+        /* the binary file records the identity of the text file, so make sure it exists */
+        if (stat( info->path, &st ) == -1)
+        {
+            if (!save_branch( key, info->path, 1 )) return 0;
+            info->text_stale = 0;
+        }
+        if (!write_binary_snapshot( info ))
+        {
+            if (!save_branch( key, info->path, info->text_stale )) return 0;
+            info->text_stale = 0;
+            return 1;
+        }
+    }
+
+    if (flush && info->text_stale)
+    {
+        if (!save_branch( key, info->path, 1 )) return 0;
+        info->text_stale = 0;
+        update_binary_identity( info );
+    }
+    return 1;
+}
+
+/* save a registry branch in the format selected by the configuration */
+static int save_branch_info_to_disk( struct save_branch_info *info, int flush )
+{
+    if (binary_registry) return save_branch_binary( info, flush );
+
+    if (!save_branch( info->key, info->path, info->text_stale )) return 0;
+    info->text_stale = 0;
+    if (info->bin_size)
+    {
+        /* the binary file is obsolete now */
+        if (info->bin_path) unlink( info->bin_path );
+        info->bin_size = info->bin_snapshot_size = 0;
+    }
+    return 1;
+}
+
 /* periodic saving of the registry */
 static void periodic_save( void *arg )
 {
@@ -1998,7 +2591,7 @@ static void periodic_save( void *arg )
     if (fchdir( config_dir_fd ) == -1) return;
     save_timeout_user = NULL;
     for (i = 0; i < save_branch_count; i++)
-        save_branch( save_branch_info[i].key, save_branch_info[i].path );
+        save_branch_info_to_disk( &save_branch_info[i], 0 );
     if (fchdir( server_dir_fd ) == -1) fatal_error( "chdir to server dir: %s\n", strerror( errno ));
     set_periodic_save_timer();
 }
@@ -2018,7 +2611,7 @@ void flush_registry(void)
     if (fchdir( config_dir_fd ) == -1) return;
     for (i = 0; i < save_branch_count; i++)
     {
-        if (!save_branch( save_branch_info[i].key, save_branch_info[i].path ))
+        if (!save_branch_info_to_disk( &save_branch_info[i], 1 ))
         {
             fprintf( stderr, "wineserver: could not save registry branch to %s",
                      save_branch_info[i].path );
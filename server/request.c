@@ -75,6 +75,10 @@
 #define SCM_RIGHTS 1
 #endif
 
+/* request data buffer sizes; most requests fit in the default size */
+#define DEFAULT_REQ_BUFFER_SIZE  1024
+#define MAX_REQ_BUFFER_SIZE      65536
+
 /* path names for server master Unix socket */
 static const char * const server_socket_name = "socket";   /* name of the socket file */
 static const char * const server_lock_name = "lock";       /* name of the server lock file */
@@ -328,42 +332,85 @@ static void call_req_handler( struct thread *thread )
     current = NULL;
 }
 
+/* make sure the thread request buffer can hold size bytes */
+static int grow_req_buffer( struct thread *thread, data_size_t size )
+{
+    void *ptr;
+
+    if (size <= thread->req_buffer_size) return 1;
+    if (!(ptr = realloc( thread->req_buffer, size ))) return 0;
+    thread->req_buffer = ptr;
+    thread->req_buffer_size = size;
+    return 1;
+}
+
+/* handle a fully read request and release its data */
+static void handle_request( struct thread *thread )
+{
+    thread->req_data = thread->req.request_header.request_size ? thread->req_buffer : NULL;
+    call_req_handler( thread );
+    thread->req_data = NULL;
+
+    /* don't keep a large buffer around after an unusually big request */
+    if (thread->req_buffer_size > MAX_REQ_BUFFER_SIZE)
+    {
+        free( thread->req_buffer );
+        thread->req_buffer = NULL;
+        thread->req_buffer_size = 0;
+    }
+}
+
 /* read a request from a thread */
 void read_request( struct thread *thread )
 {
+    data_size_t size;
     int ret;
 
     if (!thread->req_toread)  /* no pending request */
     {
-        if ((ret = read( get_unix_fd( thread->request_fd ), &thread->req,
-                         sizeof(thread->req) )) != sizeof(thread->req)) goto error;
-        if (!(thread->req_toread = thread->req.request_header.request_size))
+        struct iovec vec[2];
+
+        /* read the request header along with as much of the data as fits in the buffer,
+         * the client doesn't send another request before getting the reply */
+        grow_req_buffer( thread, DEFAULT_REQ_BUFFER_SIZE );
+        vec[0].iov_base = &thread->req;
+        vec[0].iov_len  = sizeof(thread->req);
+        vec[1].iov_base = thread->req_buffer;
+        vec[1].iov_len  = thread->req_buffer_size;
+        if ((ret = readv( get_unix_fd( thread->request_fd ), vec, 2 )) < (int)sizeof(thread->req))
+            goto error;
+        size = thread->req.request_header.request_size;
+        ret -= sizeof(thread->req);
+        if (ret > size)
+        {
+            fatal_protocol_error( thread, "extra data after request %d\n", thread->req.request_header.req );
+            return;
+        }
+        if (!(thread->req_toread = size - ret))
         {
-            /* no data, handle request at once */
-            call_req_handler( thread );
+            /* all the data is there, handle request at once */
+            handle_request( thread );
             return;
         }
-        if (!(thread->req_data = malloc( thread->req_toread )))
+        if (!grow_req_buffer( thread, size ))
         {
             fatal_protocol_error( thread, "no memory for %u bytes request %d\n",
-                                  thread->req_toread, thread->req.request_header.req );
+                                  size, thread->req.request_header.req );
             return;
         }
     }
 
-    /* read the variable sized data */
+    /* read the remaining variable sized data */
     for (;;)
     {
         ret = read( get_unix_fd( thread->request_fd ),
-                    (char *)thread->req_data + thread->req.request_header.request_size
+                    (char *)thread->req_buffer + thread->req.request_header.request_size
                       - thread->req_toread,
                     thread->req_toread );
         if (ret <= 0) break;
         if (!(thread->req_toread -= ret))
         {
-            call_req_handler( thread );
-            free( thread->req_data );
-            thread->req_data = NULL;
+            handle_request( thread );
             return;
         }
     }
@@ -388,6 +388,7 @@ DECL_HANDLER(remove_completion);
 DECL_HANDLER(query_completion);
 DECL_HANDLER(set_completion_info);
 DECL_HANDLER(add_fd_completion);
+DECL_HANDLER(get_fd_completion);
 DECL_HANDLER(set_fd_completion_mode);
 DECL_HANDLER(set_fd_disp_info);
 DECL_HANDLER(set_fd_name_info);
@@ -406,6 +407,9 @@ DECL_HANDLER(process_in_job);
 DECL_HANDLER(set_job_limits);
 DECL_HANDLER(set_job_completion_port);
 DECL_HANDLER(terminate_job);
+DECL_HANDLER(get_esync_fd);
+DECL_HANDLER(get_shared_state);
+DECL_HANDLER(get_user_shared_mapping);
 
 #ifdef WANT_REQUEST_HANDLERS
 
@@ -688,6 +692,7 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_query_completion,
     (req_handler)req_set_completion_info,
     (req_handler)req_add_fd_completion,
+    (req_handler)req_get_fd_completion,
     (req_handler)req_set_fd_completion_mode,
     (req_handler)req_set_fd_disp_info,
     (req_handler)req_set_fd_name_info,
@@ -706,6 +711,9 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_set_job_limits,
     (req_handler)req_set_job_completion_port,
     (req_handler)req_terminate_job,
+    (req_handler)req_get_esync_fd,
+    (req_handler)req_get_shared_state,
+    (req_handler)req_get_user_shared_mapping,
 };
 
 C_ASSERT( sizeof(affinity_t) == 8 );
@@ -1008,7 +1016,10 @@ C_ASSERT( FIELD_OFFSET(struct create_file_request, options) == 24 );
 C_ASSERT( FIELD_OFFSET(struct create_file_request, attrs) == 28 );
 C_ASSERT( sizeof(struct create_file_request) == 32 );
 C_ASSERT( FIELD_OFFSET(struct create_file_reply, handle) == 8 );
-C_ASSERT( sizeof(struct create_file_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct create_file_reply, fd_type) == 12 );
+C_ASSERT( FIELD_OFFSET(struct create_file_reply, fd_access) == 16 );
+C_ASSERT( FIELD_OFFSET(struct create_file_reply, fd_options) == 20 );
+C_ASSERT( sizeof(struct create_file_reply) == 24 );
 C_ASSERT( FIELD_OFFSET(struct open_file_object_request, access) == 12 );
 C_ASSERT( FIELD_OFFSET(struct open_file_object_request, attributes) == 16 );
 C_ASSERT( FIELD_OFFSET(struct open_file_object_request, rootdir) == 20 );
@@ -2351,6 +2362,11 @@ C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, information) == 24 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, status) == 32 );
 C_ASSERT( FIELD_OFFSET(struct add_fd_completion_request, async) == 36 );
 C_ASSERT( sizeof(struct add_fd_completion_request) == 40 );
+C_ASSERT( FIELD_OFFSET(struct get_fd_completion_request, handle) == 12 );
+C_ASSERT( sizeof(struct get_fd_completion_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_fd_completion_reply, port) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_fd_completion_reply, ckey) == 16 );
+C_ASSERT( sizeof(struct get_fd_completion_reply) == 24 );
 C_ASSERT( FIELD_OFFSET(struct set_fd_completion_mode_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_fd_completion_mode_request, flags) == 16 );
 C_ASSERT( sizeof(struct set_fd_completion_mode_request) == 24 );
@@ -2424,6 +2440,19 @@ C_ASSERT( sizeof(struct set_job_completion_port_request) == 32 );
 C_ASSERT( FIELD_OFFSET(struct terminate_job_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct terminate_job_request, status) == 16 );
 C_ASSERT( sizeof(struct terminate_job_request) == 24 );
+C_ASSERT( FIELD_OFFSET(struct get_esync_fd_request, handle) == 12 );
+C_ASSERT( sizeof(struct get_esync_fd_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_esync_fd_reply, type) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_esync_fd_reply, shm_idx) == 12 );
+C_ASSERT( FIELD_OFFSET(struct get_esync_fd_reply, access) == 16 );
+C_ASSERT( sizeof(struct get_esync_fd_reply) == 24 );
+C_ASSERT( sizeof(struct get_shared_state_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_shared_state_reply, desktop_idx) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_shared_state_reply, queue_idx) == 12 );
+C_ASSERT( sizeof(struct get_shared_state_reply) == 16 );
+C_ASSERT( sizeof(struct get_user_shared_mapping_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_user_shared_mapping_reply, handle) == 8 );
+C_ASSERT( sizeof(struct get_user_shared_mapping_reply) == 16 );
 
 #endif  /* WANT_REQUEST_HANDLERS */
 
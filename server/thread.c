@@ -187,6 +187,8 @@ static inline void init_thread_structure( struct thread *thread )
     thread->wait            = NULL;
     thread->error           = 0;
     thread->req_data        = NULL;
+    thread->req_buffer      = NULL;
+    thread->req_buffer_size = 0;
     thread->req_toread      = 0;
     thread->reply_data      = NULL;
     thread->reply_towrite   = 0;
@@ -309,7 +311,7 @@ static void cleanup_thread( struct thread *thread )
 
     clear_apc_queue( &thread->system_apc );
     clear_apc_queue( &thread->user_apc );
-    free( thread->req_data );
+    free( thread->req_buffer );
     free( thread->reply_data );
     if (thread->request_fd) release_object( thread->request_fd );
     if (thread->reply_fd) release_object( thread->reply_fd );
@@ -328,6 +330,8 @@ static void cleanup_thread( struct thread *thread )
         }
     }
     thread->req_data = NULL;
+    thread->req_buffer = NULL;
+    thread->req_buffer_size = 0;
     thread->reply_data = NULL;
     thread->request_fd = NULL;
     thread->reply_fd = NULL;
@@ -665,6 +669,7 @@ static int wait_on( const select_op_t *select_op, unsigned int count, struct obj
     {
         struct object *obj = objects[i];
         entry->wait = wait;
+        entry->esync = NULL;
         if (!obj->ops->add_queue( obj, entry ))
         {
             wait->count = i;
@@ -717,6 +722,9 @@ static int check_wait( struct thread *thread )
         for (i = 0, entry = wait->queues; i < wait->count; i++, entry++)
             not_ok |= !entry->obj->ops->signaled( entry->obj, entry );
         if (!not_ok) return STATUS_WAIT_0;
+        /* give back the esync objects that were grabbed while checking */
+        for (i = 0, entry = wait->queues; i < wait->count; i++, entry++)
+            if (entry->esync) esync_release_grab( entry );
     }
     else
     {
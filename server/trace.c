@@ -1751,6 +1751,9 @@ static void dump_create_file_request( const struct create_file_request *req )
 static void dump_create_file_reply( const struct create_file_reply *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
+    fprintf( stderr, ", fd_type=%d", req->fd_type );
+    fprintf( stderr, ", fd_access=%08x", req->fd_access );
+    fprintf( stderr, ", fd_options=%08x", req->fd_options );
 }
 
 static void dump_open_file_object_request( const struct open_file_object_request *req )
@@ -4414,6 +4417,17 @@ static void dump_add_fd_completion_request( const struct add_fd_completion_reque
     fprintf( stderr, ", async=%d", req->async );
 }
 
+static void dump_get_fd_completion_request( const struct get_fd_completion_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_get_fd_completion_reply( const struct get_fd_completion_reply *req )
+{
+    fprintf( stderr, " port=%04x", req->port );
+    dump_uint64( ", ckey=", &req->ckey );
+}
+
 static void dump_set_fd_completion_mode_request( const struct set_fd_completion_mode_request *req )
 {
     fprintf( stderr, " handle=%04x", req->handle );
@@ -4565,6 +4579,37 @@ static void dump_terminate_job_request( const struct terminate_job_request *req
     fprintf( stderr, ", status=%d", req->status );
 }
 
+static void dump_get_esync_fd_request( const struct get_esync_fd_request *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
+static void dump_get_esync_fd_reply( const struct get_esync_fd_reply *req )
+{
+    fprintf( stderr, " type=%d", req->type );
+    fprintf( stderr, ", shm_idx=%08x", req->shm_idx );
+    fprintf( stderr, ", access=%08x", req->access );
+}
+
+static void dump_get_shared_state_request( const struct get_shared_state_request *req )
+{
+}
+
+static void dump_get_shared_state_reply( const struct get_shared_state_reply *req )
+{
+    fprintf( stderr, " desktop_idx=%08x", req->desktop_idx );
+    fprintf( stderr, ", queue_idx=%08x", req->queue_idx );
+}
+
+static void dump_get_user_shared_mapping_request( const struct get_user_shared_mapping_request *req )
+{
+}
+
+static void dump_get_user_shared_mapping_reply( const struct get_user_shared_mapping_reply *req )
+{
+    fprintf( stderr, " handle=%04x", req->handle );
+}
+
 static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_new_process_request,
     (dump_func)dump_exec_process_request,
@@ -4842,6 +4887,7 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_query_completion_request,
     (dump_func)dump_set_completion_info_request,
     (dump_func)dump_add_fd_completion_request,
+    (dump_func)dump_get_fd_completion_request,
     (dump_func)dump_set_fd_completion_mode_request,
     (dump_func)dump_set_fd_disp_info_request,
     (dump_func)dump_set_fd_name_info_request,
@@ -4860,6 +4906,9 @@ static const dump_func req_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_set_job_limits_request,
     (dump_func)dump_set_job_completion_port_request,
     (dump_func)dump_terminate_job_request,
+    (dump_func)dump_get_esync_fd_request,
+    (dump_func)dump_get_shared_state_request,
+    (dump_func)dump_get_user_shared_mapping_request,
 };
 
 static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
@@ -5139,6 +5188,7 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     (dump_func)dump_query_completion_reply,
     NULL,
     NULL,
+    (dump_func)dump_get_fd_completion_reply,
     NULL,
     NULL,
     NULL,
@@ -5157,6 +5207,9 @@ static const dump_func reply_dumpers[REQ_NB_REQUESTS] = {
     NULL,
     NULL,
     NULL,
+    (dump_func)dump_get_esync_fd_reply,
+    (dump_func)dump_get_shared_state_reply,
+    (dump_func)dump_get_user_shared_mapping_reply,
 };
 
 static const char * const req_names[REQ_NB_REQUESTS] = {
@@ -5436,6 +5489,7 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "query_completion",
     "set_completion_info",
     "add_fd_completion",
+    "get_fd_completion",
     "set_fd_completion_mode",
     "set_fd_disp_info",
     "set_fd_name_info",
@@ -5454,6 +5508,9 @@ static const char * const req_names[REQ_NB_REQUESTS] = {
     "set_job_limits",
     "set_job_completion_port",
     "terminate_job",
+    "get_esync_fd",
+    "get_shared_state",
+    "get_user_shared_mapping",
 };
 
 static const struct
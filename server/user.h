@@ -78,6 +78,7 @@ struct desktop
     unsigned int         users;            /* processes and threads using this desktop */
     struct global_cursor cursor;           /* global cursor information */
     unsigned char        keystate[256];    /* asynchronous key state */
+    unsigned int         shared_idx;       /* index of the state shared with the clients */
 };
 
 /* user handles functions */
@@ -122,6 +123,9 @@ extern void post_win_event( struct thread *thread, unsigned int event,
                             user_handle_t handle );
 extern void free_hotkeys( struct desktop *desktop, user_handle_t window );
 extern void wake_queue_for_surface( struct process *process );
+extern unsigned int alloc_user_shared_state(void);
+extern void free_user_shared_state( unsigned int idx );
+extern void update_shared_desktop( struct desktop *desktop );
 
 /* region functions */
 